@@ -65,7 +65,11 @@ conversion_options& conversion_options::operator=(const conversion_options &co)
 {
     with_options(co.options())
         .with_background(co.background48())
-        .with_background(co.background24());
+        .with_background(co.background24())
+        .with_threads(co.threads())
+        .with_yuv_matrix(co.yuv_matrix())
+        .with_yuv_range(co.yuv_range())
+        .with_dither(co.dither());
 
     return *this;
 }
@@ -105,6 +109,26 @@ sail_rgb24_t conversion_options::background24() const
     return d->conversion_options->background24;
 }
 
+unsigned conversion_options::threads() const
+{
+    return d->conversion_options->threads;
+}
+
+SailYuvMatrix conversion_options::yuv_matrix() const
+{
+    return d->conversion_options->yuv_matrix;
+}
+
+SailYuvRange conversion_options::yuv_range() const
+{
+    return d->conversion_options->yuv_range;
+}
+
+SailDither conversion_options::dither() const
+{
+    return d->conversion_options->dither;
+}
+
 conversion_options& conversion_options::with_options(int options)
 {
     d->conversion_options->options = options;
@@ -123,6 +147,30 @@ conversion_options& conversion_options::with_background(const sail_rgb24_t &rgb2
     return *this;
 }
 
+conversion_options& conversion_options::with_threads(unsigned threads)
+{
+    d->conversion_options->threads = threads;
+    return *this;
+}
+
+conversion_options& conversion_options::with_yuv_matrix(SailYuvMatrix yuv_matrix)
+{
+    d->conversion_options->yuv_matrix = yuv_matrix;
+    return *this;
+}
+
+conversion_options& conversion_options::with_yuv_range(SailYuvRange yuv_range)
+{
+    d->conversion_options->yuv_range = yuv_range;
+    return *this;
+}
+
+conversion_options& conversion_options::with_dither(SailDither dither)
+{
+    d->conversion_options->dither = dither;
+    return *this;
+}
+
 sail_status_t conversion_options::to_sail_conversion_options(sail_conversion_options **conversion_options) const
 {
     SAIL_CHECK_CONVERSION_OPTIONS_PTR(conversion_options);
@@ -133,4 +181,9 @@ sail_status_t conversion_options::to_sail_conversion_options(sail_conversion_opt
     return SAIL_OK;
 }
 
+const sail_conversion_options* conversion_options::sail_conversion_options_c() const
+{
+    return d->conversion_options;
+}
+
 }
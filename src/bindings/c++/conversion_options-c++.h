@@ -30,10 +30,14 @@
     #include "error.h"
     #include "export.h"
     #include "pixel.h"
+
+    #include "manip_common.h"
 #else
     #include <sail-common/error.h>
     #include <sail-common/export.h>
     #include <sail-common/pixel.h>
+
+    #include <sail-manip/manip_common.h>
 #endif
 
 struct sail_conversion_options;
@@ -46,7 +50,9 @@ namespace sail
  */
 class SAIL_EXPORT conversion_options
 {
+    friend class converter;
     friend class image;
+    friend class image_input;
 
 public:
     /*
@@ -94,6 +100,26 @@ public:
      */
     sail_rgb24_t background24() const;
 
+    /*
+     * Returns the number of threads to convert images with. SAIL_THREADS_AUTO means the number of CPU cores.
+     */
+    unsigned threads() const;
+
+    /*
+     * Returns the matrix to convert planar YUV pixel formats with.
+     */
+    SailYuvMatrix yuv_matrix() const;
+
+    /*
+     * Returns the value range of planar YUV pixel formats.
+     */
+    SailYuvRange yuv_range() const;
+
+    /*
+     * Returns the dithering algorithm to convert to 1/2/4-bit grayscale or indexed pixel formats with.
+     */
+    SailDither dither() const;
+
     /*
      * Sets new conversion options.
      */
@@ -109,9 +135,34 @@ public:
      */
     conversion_options& with_background(const sail_rgb24_t &rgb24);
 
+    /*
+     * Sets the number of threads to convert images with. 0 and 1 convert in the calling thread.
+     * SAIL_THREADS_AUTO uses as many threads as there are CPU cores.
+     */
+    conversion_options& with_threads(unsigned threads);
+
+    /*
+     * Sets the matrix to convert planar YUV pixel formats with. SAIL_YUV_MATRIX_BT601 by default.
+     */
+    conversion_options& with_yuv_matrix(SailYuvMatrix yuv_matrix);
+
+    /*
+     * Sets the value range of planar YUV pixel formats. SAIL_YUV_RANGE_FULL by default.
+     */
+    conversion_options& with_yuv_range(SailYuvRange yuv_range);
+
+    /*
+     * Sets the dithering algorithm to convert to 1/2/4-bit grayscale or indexed pixel formats with.
+     * Packing gray levels falls back to SAIL_DITHER_ORDERED for SAIL_DITHER_FLOYD_STEINBERG.
+     * SAIL_DITHER_NONE by default.
+     */
+    conversion_options& with_dither(SailDither dither);
+
 private:
     sail_status_t to_sail_conversion_options(sail_conversion_options **conversion_options) const;
 
+    const sail_conversion_options* sail_conversion_options_c() const;
+
 private:
     class pimpl;
     pimpl *d;
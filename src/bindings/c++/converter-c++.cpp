@@ -0,0 +1,214 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstring>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+#include "sail-c++.h"
+
+namespace sail
+{
+
+class SAIL_HIDDEN converter::pimpl
+{
+public:
+    pimpl()
+        : plan(nullptr)
+        , input_pixel_format(SAIL_PIXEL_FORMAT_UNKNOWN)
+        , output_pixel_format(SAIL_PIXEL_FORMAT_UNKNOWN)
+    {
+    }
+
+    ~pimpl()
+    {
+        sail_destroy_conversion_plan(plan);
+    }
+
+    sail_status_t init(SailPixelFormat input_pixel_format_, const sail::palette *palette,
+                       SailPixelFormat output_pixel_format_, const conversion_options &options)
+    {
+        sail_palette *sail_palette = nullptr;
+        sail_conversion_options *sail_conversion_options = nullptr;
+
+        SAIL_AT_SCOPE_EXIT(
+            sail_destroy_palette(sail_palette);
+            sail_destroy_conversion_options(sail_conversion_options);
+        );
+
+        if (palette != nullptr && palette->is_valid()) {
+            SAIL_TRY(palette->to_sail_palette(&sail_palette));
+        }
+
+        SAIL_TRY(options.to_sail_conversion_options(&sail_conversion_options));
+
+        SAIL_TRY(sail_alloc_conversion_plan(input_pixel_format_, sail_palette, output_pixel_format_, sail_conversion_options, &plan));
+
+        input_pixel_format  = input_pixel_format_;
+        output_pixel_format = output_pixel_format_;
+
+        return SAIL_OK;
+    }
+
+    sail_conversion_plan *plan;
+    SailPixelFormat input_pixel_format;
+    SailPixelFormat output_pixel_format;
+};
+
+converter::converter()
+    : d(new pimpl)
+{
+}
+
+converter::converter(SailPixelFormat input_pixel_format, SailPixelFormat output_pixel_format)
+    : converter(input_pixel_format, output_pixel_format, conversion_options{})
+{
+}
+
+converter::converter(SailPixelFormat input_pixel_format, SailPixelFormat output_pixel_format, const conversion_options &options)
+    : converter()
+{
+    SAIL_TRY_OR_SUPPRESS(d->init(input_pixel_format, nullptr, output_pixel_format, options));
+}
+
+converter::converter(SailPixelFormat input_pixel_format, const sail::palette &palette, SailPixelFormat output_pixel_format,
+                     const conversion_options &options)
+    : converter()
+{
+    SAIL_TRY_OR_SUPPRESS(d->init(input_pixel_format, &palette, output_pixel_format, options));
+}
+
+converter::converter(converter &&c) noexcept
+{
+    d = c.d;
+    c.d = nullptr;
+}
+
+converter& converter::operator=(converter &&c)
+{
+    delete d;
+    d = c.d;
+    c.d = nullptr;
+
+    return *this;
+}
+
+converter::~converter()
+{
+    delete d;
+}
+
+bool converter::is_valid() const
+{
+    return d->plan != nullptr;
+}
+
+SailPixelFormat converter::input_pixel_format() const
+{
+    return d->input_pixel_format;
+}
+
+SailPixelFormat converter::output_pixel_format() const
+{
+    return d->output_pixel_format;
+}
+
+sail_status_t converter::convert(const sail::image &input, sail::image *output) const
+{
+    SAIL_CHECK_CONVERSION_PLAN_PTR(d->plan);
+    SAIL_CHECK_IMAGE_PTR(output);
+
+    if (!input.is_valid()) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    unsigned bytes_per_line;
+    SAIL_TRY(sail_bytes_per_line(input.width(), d->output_pixel_format, &bytes_per_line));
+
+    // Planar pixel formats need more than height * bytes_per_line bytes
+    sail_image sail_image_pixels;
+    std::memset(&sail_image_pixels, 0, sizeof(sail_image_pixels));
+    sail_image_pixels.width          = input.width();
+    sail_image_pixels.height         = input.height();
+    sail_image_pixels.bytes_per_line = output->is_valid() ? output->bytes_per_line() : bytes_per_line;
+    sail_image_pixels.pixel_format   = d->output_pixel_format;
+
+    size_t pixels_size;
+    SAIL_TRY(sail_image_pixels_size(&sail_image_pixels, &pixels_size));
+
+    const bool reuse_pixels = output->is_valid()
+                                && output->width() == input.width()
+                                && output->height() == input.height()
+                                && output->pixel_format() == d->output_pixel_format
+                                && output->bytes_per_line() >= bytes_per_line
+                                && output->pixels_size() >= pixels_size;
+
+    if (!reuse_pixels) {
+        output->with_pixels(nullptr, 0)
+            .with_width(input.width())
+            .with_height(input.height())
+            .with_pixel_format(d->output_pixel_format)
+            .with_bytes_per_line(bytes_per_line);
+
+        sail_image_pixels.bytes_per_line = bytes_per_line;
+        SAIL_TRY(sail_image_pixels_size(&sail_image_pixels, &pixels_size));
+
+        SAIL_TRY(sail_malloc(pixels_size, &sail_image_pixels.pixels));
+        SAIL_TRY_OR_CLEANUP(output->transfer_pixels_pointer(&sail_image_pixels),
+                            /* cleanup */ sail_free(sail_image_pixels.pixels));
+    }
+
+    // Shallow views of the images. The palette is already expanded into the plan.
+    sail_image sail_image_input;
+    std::memset(&sail_image_input, 0, sizeof(sail_image_input));
+    sail_image_input.pixels         = const_cast<void *>(input.pixels());
+    sail_image_input.width          = input.width();
+    sail_image_input.height         = input.height();
+    sail_image_input.bytes_per_line = input.bytes_per_line();
+    sail_image_input.pixel_format   = input.pixel_format();
+
+    sail_image sail_image_output;
+    std::memset(&sail_image_output, 0, sizeof(sail_image_output));
+    sail_image_output.pixels         = output->pixels();
+    sail_image_output.width          = output->width();
+    sail_image_output.height         = output->height();
+    sail_image_output.bytes_per_line = output->bytes_per_line();
+    sail_image_output.pixel_format   = output->pixel_format();
+
+    SAIL_TRY(sail_convert_image_with_plan(&sail_image_input, d->plan, &sail_image_output));
+
+    return SAIL_OK;
+}
+
+image converter::convert(const sail::image &input) const
+{
+    image img;
+    SAIL_TRY_OR_EXECUTE(convert(input, &img),
+                        /* on error */ return image{});
+
+    return img;
+}
+
+}
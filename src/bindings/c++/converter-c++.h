@@ -0,0 +1,147 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_CONVERTER_CPP_H
+#define SAIL_CONVERTER_CPP_H
+
+#ifdef SAIL_BUILD
+    #include "common.h"
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/common.h>
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+struct sail_conversion_plan;
+
+namespace sail
+{
+
+class conversion_options;
+class image;
+class palette;
+
+/*
+ * Reusable image converter. Resolves the conversion path (row kernels, palette lookup tables,
+ * and conversion options) once and converts many images of the same pixel format with it.
+ * Use it to convert animation frames or batches of images.
+ */
+class SAIL_EXPORT converter
+{
+public:
+    /*
+     * Constructs an invalid converter.
+     */
+    converter();
+
+    /*
+     * Constructs a new converter from the input pixel format to the output pixel format.
+     * Use is_valid() to check if the conversion is supported.
+     */
+    converter(SailPixelFormat input_pixel_format, SailPixelFormat output_pixel_format);
+
+    /*
+     * Constructs a new converter from the input pixel format to the output pixel format
+     * with the conversion options. Use is_valid() to check if the conversion is supported.
+     */
+    converter(SailPixelFormat input_pixel_format, SailPixelFormat output_pixel_format, const conversion_options &options);
+
+    /*
+     * Constructs a new converter from the indexed input pixel format to the output pixel format
+     * with the conversion options. The palette is expanded into the converter, so images
+     * converted with it must use the same palette. Use is_valid() to check if the conversion is supported.
+     */
+    converter(SailPixelFormat input_pixel_format, const sail::palette &palette, SailPixelFormat output_pixel_format,
+              const conversion_options &options);
+
+    /*
+     * Disables copying converters.
+     */
+    converter(const converter&) = delete;
+
+    /*
+     * Disables copying converters.
+     */
+    converter& operator=(const converter&) = delete;
+
+    /*
+     * Moves the converter.
+     */
+    converter(converter &&c) noexcept;
+
+    /*
+     * Moves the converter.
+     */
+    converter& operator=(converter &&c);
+
+    /*
+     * Destroys the converter.
+     */
+    ~converter();
+
+    /*
+     * Returns true if the converter was constructed successfully.
+     */
+    bool is_valid() const;
+
+    /*
+     * Returns the input pixel format.
+     */
+    SailPixelFormat input_pixel_format() const;
+
+    /*
+     * Returns the output pixel format.
+     */
+    SailPixelFormat output_pixel_format() const;
+
+    /*
+     * Converts the input image into the output image. The input image must have the input pixel format.
+     *
+     * Reuses the output image pixels (deep copied or shallow) when the output image already has
+     * the output pixel format, the same dimensions as the input image, and enough pixel data.
+     * In that case no memory is allocated. Otherwise, the output image pixels are reallocated.
+     * Other output image properties like meta data are left untouched.
+     *
+     * Returns SAIL_OK on success.
+     */
+    sail_status_t convert(const sail::image &input, sail::image *output) const;
+
+    /*
+     * Converts the input image into a new image. The input image must have the input pixel format.
+     *
+     * Returns an invalid image on error.
+     */
+    image convert(const sail::image &input) const;
+
+private:
+    class pimpl;
+    pimpl *d;
+};
+
+}
+
+#endif
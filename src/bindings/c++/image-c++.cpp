@@ -67,6 +67,26 @@ public:
         shallow_pixels = false;
     }
 
+    // Number of bytes in all the pixel planes
+    unsigned bytes_per_image() const
+    {
+        if (!sail_is_planar(pixel_format)) {
+            return height * bytes_per_line;
+        }
+
+        sail_image sail_img = {};
+        sail_img.width          = width;
+        sail_img.height         = height;
+        sail_img.bytes_per_line = bytes_per_line;
+        sail_img.pixel_format   = pixel_format;
+
+        size_t size;
+        SAIL_TRY_OR_EXECUTE(sail_image_pixels_size(&sail_img, &size),
+                            /* on error */ return 0);
+
+        return static_cast<unsigned>(size);
+    }
+
     unsigned width;
     unsigned height;
     unsigned bytes_per_line;
@@ -300,7 +320,7 @@ image& image::with_meta_data(const std::vector<sail::meta_data> &meta_data)
 
 image& image::with_pixels(const void *pixels)
 {
-    const unsigned bytes_per_image = height() * bytes_per_line();
+    const unsigned bytes_per_image = d->bytes_per_image();
 
     if (bytes_per_image == 0) {
         SAIL_LOG_ERROR("Cannot assign pixels as the image height or bytes_per_line is 0");
@@ -332,7 +352,7 @@ image& image::with_pixels(const void *pixels, unsigned pixels_size)
 
 image& image::with_shallow_pixels(void *pixels)
 {
-    const unsigned bytes_per_image = height() * bytes_per_line();
+    const unsigned bytes_per_image = d->bytes_per_image();
 
     if (bytes_per_image == 0) {
         SAIL_LOG_ERROR("Cannot assign shallow pixels as the image height or bytes_per_line is 0");
@@ -430,7 +450,7 @@ sail_status_t image::convert(SailPixelFormat pixel_format, const conversion_opti
     d->bytes_per_line = sail_image_output->bytes_per_line;
     d->pixel_format   = sail_image_output->pixel_format;
     d->pixels         = sail_image_output->pixels;
-    d->pixels_size    = sail_image_output->height * sail_image_output->bytes_per_line;
+    d->pixels_size    = d->bytes_per_image();
     d->shallow_pixels = false;
 
     sail_image_output->pixels = nullptr;
@@ -617,6 +637,21 @@ sail_status_t image::bytes_per_line(unsigned width, SailPixelFormat pixel_format
     return SAIL_OK;
 }
 
+bool image::is_planar(SailPixelFormat pixel_format)
+{
+    return sail_is_planar(pixel_format);
+}
+
+bool image::is_premultiplied(SailPixelFormat pixel_format)
+{
+    return sail_is_premultiplied(pixel_format);
+}
+
+bool image::is_floating_point(SailPixelFormat pixel_format)
+{
+    return sail_is_floating_point(pixel_format);
+}
+
 bool image::is_indexed(SailPixelFormat pixel_format)
 {
     return sail_is_indexed(pixel_format);
@@ -691,8 +726,23 @@ image::image(const sail_image *sail_image)
         .with_source_image(sail::source_image(sail_image->source_image));
 
     if (sail_image->pixels != nullptr) {
-        SAIL_TRY_OR_EXECUTE(transfer_pixels_pointer(sail_image),
-                            /* on error */ return);
+        // Shared pixels cannot be transferred
+        if (sail_image->pixel_buffer != nullptr) {
+            struct sail_image *sail_image_copy;
+            SAIL_TRY_OR_EXECUTE(sail_copy_image(sail_image, &sail_image_copy),
+                                /* on error */ return);
+
+            with_bytes_per_line(sail_image_copy->bytes_per_line);
+
+            SAIL_TRY_OR_EXECUTE(transfer_pixels_pointer(sail_image_copy),
+                                /* on error */ sail_destroy_image(sail_image_copy); return);
+
+            sail_image_copy->pixels = nullptr;
+            sail_destroy_image(sail_image_copy);
+        } else {
+            SAIL_TRY_OR_EXECUTE(transfer_pixels_pointer(sail_image),
+                                /* on error */ return);
+        }
     }
 }
 
@@ -711,7 +761,7 @@ sail_status_t image::transfer_pixels_pointer(const sail_image *sail_image)
     }
 
     d->pixels      = sail_image->pixels;
-    d->pixels_size = sail_image->height * sail_image->bytes_per_line;
+    d->pixels_size = d->bytes_per_image();
 
     return SAIL_OK;
 }
@@ -61,6 +61,7 @@ class write_features;
  */
 class SAIL_EXPORT image
 {
+    friend class converter;
     friend class image_input;
     friend class image_output;
 
@@ -615,6 +616,21 @@ public:
      */
     static bool is_indexed(SailPixelFormat pixel_format);
 
+    /*
+     * Returns true if the specified pixel format stores its channels in separate planes (I420, NV12, etc.).
+     */
+    static bool is_planar(SailPixelFormat pixel_format);
+
+    /*
+     * Returns true if the specified pixel format stores color components premultiplied by alpha.
+     */
+    static bool is_premultiplied(SailPixelFormat pixel_format);
+
+    /*
+     * Returns true if the specified pixel format stores half or single precision floating point components.
+     */
+    static bool is_floating_point(SailPixelFormat pixel_format);
+
     /*
      * Returns true if the specified pixel format is grayscale.
      */
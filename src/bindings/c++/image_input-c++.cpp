@@ -180,6 +180,7 @@ sail_status_t image_input::start(const std::string_view path, const sail::codec_
     SAIL_TRY(read_options.to_sail_read_options(&sail_read_options));
 
     SAIL_TRY(sail_start_reading_file_with_options(path.data(), codec_info.sail_codec_info_c(), &sail_read_options, &d->state));
+    SAIL_TRY(sail_set_reading_conversion_options(d->state, read_options.conversion_options().sail_conversion_options_c()));
 
     return SAIL_OK;
 }
@@ -210,6 +211,7 @@ sail_status_t image_input::start(const void *buffer, size_t buffer_length, const
     SAIL_TRY(read_options.to_sail_read_options(&sail_read_options));
 
     SAIL_TRY(sail_start_reading_mem_with_options(buffer, buffer_length, nullptr, &sail_read_options, &d->state));
+    SAIL_TRY(sail_set_reading_conversion_options(d->state, read_options.conversion_options().sail_conversion_options_c()));
 
     return SAIL_OK;
 }
@@ -222,6 +224,7 @@ sail_status_t image_input::start(const void *buffer, size_t buffer_length, const
     SAIL_TRY(read_options.to_sail_read_options(&sail_read_options));
 
     SAIL_TRY(sail_start_reading_mem_with_options(buffer, buffer_length, codec_info.sail_codec_info_c(), &sail_read_options, &d->state));
+    SAIL_TRY(sail_set_reading_conversion_options(d->state, read_options.conversion_options().sail_conversion_options_c()));
 
     return SAIL_OK;
 }
@@ -261,6 +264,7 @@ sail_status_t image_input::start(const sail::io &io, const sail::read_options &r
     SAIL_TRY(read_options.to_sail_read_options(&sail_read_options));
 
     SAIL_TRY(sail_start_reading_io_with_options(d->sail_io, nullptr, &sail_read_options, &d->state));
+    SAIL_TRY(sail_set_reading_conversion_options(d->state, read_options.conversion_options().sail_conversion_options_c()));
 
     return SAIL_OK;
 }
@@ -276,6 +280,7 @@ sail_status_t image_input::start(const sail::io &io, const sail::codec_info &cod
     SAIL_TRY(read_options.to_sail_read_options(&sail_read_options));
 
     SAIL_TRY(sail_start_reading_io_with_options(d->sail_io, codec_info.sail_codec_info_c(), &sail_read_options, &d->state));
+    SAIL_TRY(sail_set_reading_conversion_options(d->state, read_options.conversion_options().sail_conversion_options_c()));
 
     return SAIL_OK;
 }
@@ -25,6 +25,7 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <new>
 
 #include "sail-common.h"
 #include "sail.h"
@@ -106,6 +107,54 @@ sail_status_t image_output::write(void *buffer, size_t buffer_length, const sail
     return SAIL_OK;
 }
 
+sail_status_t image_output::write(const sail::codec_info &codec_info, const sail::image &image, arbitrary_data *data) const
+{
+    SAIL_TRY(write(codec_info, image, 0, data));
+
+    return SAIL_OK;
+}
+
+sail_status_t image_output::write(const sail::codec_info &codec_info, const sail::image &image, size_t initial_size, arbitrary_data *data) const
+{
+    SAIL_CHECK_BUFFER_PTR(data);
+
+    data->clear();
+
+    if (!image.is_valid()) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    sail_image *sail_image = nullptr;
+    SAIL_TRY(image.to_sail_image(&sail_image));
+
+    void *buffer = nullptr;
+
+    SAIL_AT_SCOPE_EXIT(
+        sail_image->pixels = nullptr;
+        sail_destroy_image(sail_image);
+        sail_free(buffer);
+    );
+
+    void *state = nullptr;
+    SAIL_TRY(sail_start_writing_growing_mem(initial_size, codec_info.sail_codec_info_c(), &buffer, &state));
+
+    SAIL_TRY_OR_EXECUTE(sail_write_next_frame(state, sail_image),
+                        /* on error */ sail_stop_writing(state); return __sail_error_result);
+
+    size_t written;
+    SAIL_TRY(sail_stop_writing_with_written(state, &written));
+
+    const std::uint8_t *buffer_data = static_cast<const std::uint8_t *>(buffer);
+
+    try {
+        data->assign(buffer_data, buffer_data + written);
+    } catch (const std::bad_alloc &) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_MEMORY_ALLOCATION);
+    }
+
+    return SAIL_OK;
+}
+
 sail_status_t image_output::start(const std::string_view path)
 {
     SAIL_TRY(d->ensure_state_is_null());
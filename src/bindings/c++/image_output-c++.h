@@ -32,9 +32,13 @@
 #ifdef SAIL_BUILD
     #include "error.h"
     #include "export.h"
+
+    #include "arbitrary_data-c++.h"
 #else
     #include <sail-common/error.h>
     #include <sail-common/export.h>
+
+    #include <sail-c++/arbitrary_data-c++.h>
 #endif
 
 namespace sail
@@ -113,6 +117,29 @@ public:
      */
     sail_status_t write(void *buffer, size_t buffer_length, const sail::image &image, size_t *written) const;
 
+    /*
+     * Writes the specified image into the data with the specified codec. The data grows as needed,
+     * so there is no need to guess its size beforehand. The previous contents of the data are discarded.
+     *
+     * If the selected image format doesn't support the image pixel format, an error is returned.
+     * Consider converting the image into a supported image format beforehand.
+     *
+     * Returns SAIL_OK on success.
+     */
+    sail_status_t write(const sail::codec_info &codec_info, const sail::image &image, arbitrary_data *data) const;
+
+    /*
+     * Writes the specified image into the data with the specified codec. The data initially reserves
+     * the specified number of bytes and grows as needed. Pass the approximate size of the encoded image
+     * to avoid reallocations. The previous contents of the data are discarded.
+     *
+     * If the selected image format doesn't support the image pixel format, an error is returned.
+     * Consider converting the image into a supported image format beforehand.
+     *
+     * Returns SAIL_OK on success.
+     */
+    sail_status_t write(const sail::codec_info &codec_info, const sail::image &image, size_t initial_size, arbitrary_data *data) const;
+
     /*
      * Starts writing into the specified image file.
      *
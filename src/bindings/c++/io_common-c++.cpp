@@ -59,6 +59,8 @@ void io::pimpl::empty_sail_io()
     sail_io.flush          = nullptr;
     sail_io.close          = nullptr;
     sail_io.eof            = nullptr;
+    sail_io.map_range      = nullptr;
+    sail_io.release        = nullptr;
 }
 
 io::io()
@@ -166,6 +168,18 @@ io& io::with_eof(sail_io_eof_t eof)
     return *this;
 }
 
+io& io::with_map_range(sail_io_map_range_t map_range)
+{
+    d->sail_io.map_range = map_range;
+    return *this;
+}
+
+io& io::with_release(sail_io_release_t release)
+{
+    d->sail_io.release = release;
+    return *this;
+}
+
 sail_status_t io::is_valid_private() const
 {
     sail_io *sail_io = &d->sail_io;
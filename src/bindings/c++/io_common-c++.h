@@ -89,7 +89,8 @@ public:
      * You MUST use your own unique id for custom I/O classes. For example, you can use sail_hash()
      * to generate a unique id and assign it with with_id().
      *
-     * Well-known I/O ids for file and memory I/O classes: SAIL_FILE_IO_ID and SAIL_MEMORY_IO_ID.
+     * Well-known I/O ids for file, memory, and file descriptor I/O classes: SAIL_FILE_IO_ID, SAIL_MEMORY_IO_ID,
+     * and SAIL_FD_IO_ID.
      */
     uint64_t id() const;
 
@@ -148,6 +149,16 @@ public:
      */
     io& with_eof(sail_io_eof_t eof);
 
+    /*
+     * Sets a new optional zero-copy map range callback. See sail_io_map_range_t.
+     */
+    io& with_map_range(sail_io_map_range_t map_range);
+
+    /*
+     * Sets a new optional release callback. Must be set along with the map range callback.
+     */
+    io& with_release(sail_io_release_t release);
+
 private:
     sail_status_t is_valid_private() const;
 
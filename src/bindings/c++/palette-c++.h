@@ -48,6 +48,7 @@ namespace sail
  */
 class SAIL_EXPORT palette
 {
+    friend class converter;
     friend class image;
 
 public:
@@ -25,6 +25,7 @@
 
 #include "sail-common.h"
 #include "sail.h"
+#include "sail-manip.h"
 #include "sail-c++.h"
 
 namespace sail
@@ -35,9 +36,12 @@ class SAIL_HIDDEN read_options::pimpl
 public:
     pimpl()
         : io_options(0)
+        , output_pixel_format(SAIL_PIXEL_FORMAT_UNKNOWN)
     {}
 
     int io_options;
+    SailPixelFormat output_pixel_format;
+    sail::conversion_options conversion_options;
 };
 
 read_options::read_options()
@@ -54,6 +58,10 @@ read_options::read_options(const sail_read_options *ro)
     }
 
     with_io_options(ro->io_options);
+    with_output_pixel_format(ro->output_pixel_format);
+
+    d->conversion_options.with_yuv_matrix(ro->yuv_matrix)
+                         .with_yuv_range(ro->yuv_range);
 }
 
 read_options::read_options(const read_options &ro)
@@ -64,7 +72,10 @@ read_options::read_options(const read_options &ro)
 
 read_options& read_options::operator=(const read_options &ro)
 {
-    with_io_options(ro.io_options());
+    with_io_options(ro.io_options())
+        .with_output_pixel_format(ro.output_pixel_format())
+        .with_conversion_options(ro.conversion_options());
+
     return *this;
 }
 
@@ -99,11 +110,36 @@ read_options& read_options::with_io_options(int io_options)
     return *this;
 }
 
+SailPixelFormat read_options::output_pixel_format() const
+{
+    return d->output_pixel_format;
+}
+
+const sail::conversion_options& read_options::conversion_options() const
+{
+    return d->conversion_options;
+}
+
+read_options& read_options::with_output_pixel_format(SailPixelFormat output_pixel_format)
+{
+    d->output_pixel_format = output_pixel_format;
+    return *this;
+}
+
+read_options& read_options::with_conversion_options(const sail::conversion_options &conversion_options)
+{
+    d->conversion_options = conversion_options;
+    return *this;
+}
+
 sail_status_t read_options::to_sail_read_options(sail_read_options *read_options) const
 {
     SAIL_CHECK_READ_OPTIONS_PTR(read_options);
 
-    read_options->io_options = d->io_options;
+    read_options->io_options          = d->io_options;
+    read_options->output_pixel_format = d->output_pixel_format;
+    read_options->yuv_matrix          = d->conversion_options.yuv_matrix();
+    read_options->yuv_range           = d->conversion_options.yuv_range();
 
     return SAIL_OK;
 }
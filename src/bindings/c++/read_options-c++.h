@@ -29,11 +29,17 @@
 #include <vector>
 
 #ifdef SAIL_BUILD
+    #include "common.h"
     #include "error.h"
     #include "export.h"
+
+    #include "conversion_options-c++.h"
 #else
+    #include <sail-common/common.h>
     #include <sail-common/error.h>
     #include <sail-common/export.h>
+
+    #include <sail-c++/conversion_options-c++.h>
 #endif
 
 struct sail_read_options;
@@ -90,6 +96,30 @@ public:
      */
     read_options& with_io_options(int io_options);
 
+    /*
+     * Returns the pixel format to convert every frame to while reading. SAIL_PIXEL_FORMAT_UNKNOWN
+     * keeps the pixel format produced by the codec.
+     */
+    SailPixelFormat output_pixel_format() const;
+
+    /*
+     * Returns the conversion options used with the output pixel format.
+     */
+    const sail::conversion_options& conversion_options() const;
+
+    /*
+     * Sets a new pixel format to convert every frame to while reading. Frames are converted
+     * after the codec reads them. SAIL_PIXEL_FORMAT_UNKNOWN disables conversion.
+     */
+    read_options& with_output_pixel_format(SailPixelFormat output_pixel_format);
+
+    /*
+     * Sets new conversion options used with the output pixel format. image_input passes them to
+     * sail_set_reading_conversion_options(). Their YUV matrix and range also select the YUV planes
+     * codecs output directly.
+     */
+    read_options& with_conversion_options(const sail::conversion_options &conversion_options);
+
 private:
     /*
      * Makes a deep copy of the specified read options and stores the pointer for further use.
@@ -35,6 +35,7 @@
     #include "at_scope_exit-c++.h"
     #include "context-c++.h"
     #include "conversion_options-c++.h"
+    #include "converter-c++.h"
     #include "iccp-c++.h"
     #include "image-c++.h"
     #include "image_input-c++.h"
@@ -60,6 +61,7 @@
     #include <sail-c++/at_scope_exit-c++.h>
     #include <sail-c++/context-c++.h>
     #include <sail-c++/conversion_options-c++.h>
+    #include <sail-c++/converter-c++.h>
     #include <sail-c++/iccp-c++.h>
     #include <sail-c++/image-c++.h>
     #include <sail-c++/image_input-c++.h>
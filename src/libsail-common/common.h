@@ -163,6 +163,43 @@ enum SailPixelFormat {
     SAIL_PIXEL_FORMAT_BPP40_YUVA,
     SAIL_PIXEL_FORMAT_BPP48_YUVA,
     SAIL_PIXEL_FORMAT_BPP64_YUVA,
+
+    /*
+     * Planar and semi-planar 8-bit YUV formats. All the planes are stored one after another
+     * in sail_image.pixels, luma first. bytes_per_line is the luma stride. Use sail_image_planes()
+     * to get the individual planes.
+     */
+    SAIL_PIXEL_FORMAT_BPP12_I420,    /* Y, U, V planes, chroma subsampled 2x2 (4:2:0)   */
+    SAIL_PIXEL_FORMAT_BPP12_NV12,    /* Y plane, interleaved UV plane subsampled 2x2    */
+    SAIL_PIXEL_FORMAT_BPP24_YUV444P, /* Y, U, V planes of the same size (4:4:4)          */
+
+    /*
+     * RGBA formats with the color components premultiplied by alpha.
+     */
+    SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED,
+
+    SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED,
+    SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED,
+
+    /*
+     * Floating point formats in native byte order for HDR processing. HALF formats use
+     * IEEE 754 binary16 components, FLOAT formats use IEEE 754 binary32 components.
+     * Components are normalized to [0; 1]. Values outside of this range are allowed
+     * and are clamped when converting to integer formats.
+     */
+    SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF,
+    SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT,
+
+    SAIL_PIXEL_FORMAT_BPP48_RGB_HALF,
+    SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF,
+
+    SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT,
+    SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT,
 };
 
 /* Chroma subsampling. See https://en.wikipedia.org/wiki/Chroma_subsampling */
@@ -182,6 +219,30 @@ enum SailChromaSubsampling {
     SAIL_CHROMA_SUBSAMPLING_444,
 };
 
+/*
+ * RGB <-> YUV matrices used to convert planar YUV pixel formats like I420.
+ */
+enum SailYuvMatrix {
+
+    /* ITU-R BT.601. Used by JPEG and standard definition video. */
+    SAIL_YUV_MATRIX_BT601,
+
+    /* ITU-R BT.709. Used by high definition video. */
+    SAIL_YUV_MATRIX_BT709,
+};
+
+/*
+ * Value ranges of planar YUV pixel formats.
+ */
+enum SailYuvRange {
+
+    /* Y, U, and V use the whole [0; 255] range like JPEG does. */
+    SAIL_YUV_RANGE_FULL,
+
+    /* Y uses [16; 235], U and V use [16; 240] like most video does. */
+    SAIL_YUV_RANGE_LIMITED,
+};
+
 /* Image properties. */
 enum SailImageProperty {
 
@@ -336,13 +397,21 @@ enum SailCodecFeature {
 enum SailIoOption {
 
     /* Instruction to read or write simple image meta data like JPEG comments. */
-    SAIL_IO_OPTION_META_DATA  = 1 << 0,
+    SAIL_IO_OPTION_META_DATA   = 1 << 0,
 
     /* Instruction to write interlaced images. Specifying this option for reading operations has no effect. */
-    SAIL_IO_OPTION_INTERLACED = 1 << 1,
+    SAIL_IO_OPTION_INTERLACED  = 1 << 1,
 
     /* Instruction to read or write embedded ICC profile. */
-    SAIL_IO_OPTION_ICCP       = 1 << 2,
+    SAIL_IO_OPTION_ICCP        = 1 << 2,
+
+    /*
+     * Instruction to rotate and flip every read frame to be displayed correctly. Applies
+     * SAIL_IMAGE_PROPERTY_FLIPPED_VERTICALLY and the EXIF orientation. The EXIF orientation is found
+     * only when SAIL_IO_OPTION_META_DATA is also specified. Specifying this option for writing
+     * operations has no effect.
+     */
+    SAIL_IO_OPTION_AUTO_ORIENT = 1 << 3,
 };
 
 #endif
@@ -23,12 +23,156 @@
     SOFTWARE.
 */
 
+#include "config.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef SAIL_WIN32
+    #include <windows.h>
+#endif
+
 #include "sail-common.h"
 
+/*
+ * Reference-counted pixels shared by images.
+ */
+struct sail_pixel_buffer {
+
+    void *data;
+    size_t size;
+
+#ifdef SAIL_WIN32
+    volatile LONG references;
+#else
+    unsigned long references;
+#endif
+};
+
+static void reference_pixel_buffer(struct sail_pixel_buffer *pixel_buffer) {
+
+#ifdef SAIL_WIN32
+    InterlockedIncrement(&pixel_buffer->references);
+#else
+    __atomic_add_fetch(&pixel_buffer->references, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+/* Returns the number of the references left. */
+static unsigned long dereference_pixel_buffer(struct sail_pixel_buffer *pixel_buffer) {
+
+#ifdef SAIL_WIN32
+    return (unsigned long)InterlockedDecrement(&pixel_buffer->references);
+#else
+    return __atomic_sub_fetch(&pixel_buffer->references, 1, __ATOMIC_ACQ_REL);
+#endif
+}
+
+static unsigned long pixel_buffer_references(struct sail_pixel_buffer *pixel_buffer) {
+
+#ifdef SAIL_WIN32
+    return (unsigned long)InterlockedCompareExchange(&pixel_buffer->references, 0, 0);
+#else
+    return __atomic_load_n(&pixel_buffer->references, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/* Moves the owned image pixels into a new pixel buffer. Does nothing if they're already shared. */
+static sail_status_t adopt_pixels(struct sail_image *image) {
+
+    if (image->pixel_buffer != NULL) {
+        return SAIL_OK;
+    }
+
+    size_t pixels_size;
+    SAIL_TRY(sail_image_pixels_size(image, &pixels_size));
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct sail_pixel_buffer), &ptr));
+    struct sail_pixel_buffer *pixel_buffer = ptr;
+
+    pixel_buffer->data       = image->pixels;
+    pixel_buffer->size       = pixels_size;
+    pixel_buffer->references = 1;
+
+    image->pixel_buffer = pixel_buffer;
+
+    return SAIL_OK;
+}
+
+/* Frees the owned pixels or dereferences the shared ones. */
+static void release_pixels(struct sail_image *image) {
+
+    if (image->pixel_buffer == NULL) {
+        sail_free(image->pixels);
+    } else if (dereference_pixel_buffer(image->pixel_buffer) == 0) {
+        sail_free(image->pixel_buffer->data);
+        sail_free(image->pixel_buffer);
+    }
+
+    image->pixels       = NULL;
+    image->pixel_buffer = NULL;
+    image->view         = false;
+}
+
+/* Allocates a copy of the image pixels. Views get compact rows. */
+static sail_status_t copy_pixels(const struct sail_image *image, void **pixels, unsigned *bytes_per_line) {
+
+    if (!image->view) {
+        size_t pixels_size;
+        SAIL_TRY(sail_image_pixels_size(image, &pixels_size));
+
+        SAIL_TRY(sail_malloc(pixels_size, pixels));
+        memcpy(*pixels, image->pixels, pixels_size);
+
+        *bytes_per_line = image->bytes_per_line;
+
+        return SAIL_OK;
+    }
+
+    unsigned compact_bytes_per_line;
+    SAIL_TRY(sail_bytes_per_line(image->width, image->pixel_format, &compact_bytes_per_line));
+
+    SAIL_TRY(sail_malloc((size_t)image->height * compact_bytes_per_line, pixels));
+
+    for (unsigned row = 0; row < image->height; row++) {
+        memcpy((unsigned char *)*pixels + (size_t)compact_bytes_per_line * row,
+               (const unsigned char *)image->pixels + (size_t)image->bytes_per_line * row,
+               compact_bytes_per_line);
+    }
+
+    *bytes_per_line = compact_bytes_per_line;
+
+    return SAIL_OK;
+}
+
+static sail_status_t check_rectangle(const struct sail_image *image, unsigned x, unsigned y, unsigned width, unsigned height) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+
+    if (sail_is_planar(image->pixel_format)) {
+        SAIL_LOG_ERROR("Planar pixel formats cannot be cropped, but %s is given", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    if (width == 0 || height == 0 || x > image->width || y > image->height
+            || width > image->width - x || height > image->height - y) {
+        SAIL_LOG_ERROR("Rectangle (%u,%u %ux%u) doesn't fit into the image (%ux%u)", x, y, width, height, image->width, image->height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    unsigned bits_per_pixel;
+    SAIL_TRY(sail_bits_per_pixel(image->pixel_format, &bits_per_pixel));
+
+    if (((size_t)x * bits_per_pixel) % 8 != 0) {
+        SAIL_LOG_ERROR("Rectangle of %s image must start on a byte boundary", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_alloc_image(struct sail_image **image) {
 
     SAIL_CHECK_IMAGE_PTR(image);
@@ -50,6 +194,8 @@ sail_status_t sail_alloc_image(struct sail_image **image) {
     (*image)->iccp                    = NULL;
     (*image)->properties              = 0;
     (*image)->source_image            = NULL;
+    (*image)->pixel_buffer            = NULL;
+    (*image)->view                    = false;
 
     return SAIL_OK;
 }
@@ -60,7 +206,7 @@ void sail_destroy_image(struct sail_image *image) {
         return;
     }
 
-    sail_free(image->pixels);
+    release_pixels(image);
 
     sail_destroy_resolution(image->resolution);
     sail_destroy_palette(image->palette);
@@ -81,19 +227,46 @@ sail_status_t sail_copy_image(const struct sail_image *source, struct sail_image
 
     /* Pixels. */
     if (source->pixels != NULL) {
-        const unsigned pixels_size = source->height * source->bytes_per_line;
+        SAIL_TRY_OR_CLEANUP(copy_pixels(source, &image_local->pixels, &image_local->bytes_per_line),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
+    /* Palette. */
+    if (source->palette != NULL) {
+        SAIL_TRY_OR_CLEANUP(sail_copy_palette(source->palette, &image_local->palette),
+                            /* cleanup */ sail_destroy_image(image_local));
+
+    }
+
+    *target = image_local;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_share_image(struct sail_image *source, struct sail_image **target) {
+
+    SAIL_CHECK_IMAGE_PTR(source);
+    SAIL_CHECK_IMAGE_PTR(target);
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(source, &image_local));
 
-        SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
+    /* Pixels. */
+    if (source->pixels != NULL) {
+        SAIL_TRY_OR_CLEANUP(adopt_pixels(source),
                             /* cleanup */ sail_destroy_image(image_local));
 
-        memcpy(image_local->pixels, source->pixels, pixels_size);
+        reference_pixel_buffer(source->pixel_buffer);
+
+        image_local->pixels       = source->pixels;
+        image_local->pixel_buffer = source->pixel_buffer;
+        image_local->view         = source->view;
     }
 
     /* Palette. */
     if (source->palette != NULL) {
         SAIL_TRY_OR_CLEANUP(sail_copy_palette(source->palette, &image_local->palette),
                             /* cleanup */ sail_destroy_image(image_local));
-
     }
 
     *target = image_local;
@@ -101,6 +274,79 @@ sail_status_t sail_copy_image(const struct sail_image *source, struct sail_image
     return SAIL_OK;
 }
 
+sail_status_t sail_image_view(struct sail_image *source,
+                              unsigned x, unsigned y,
+                              unsigned width, unsigned height,
+                              struct sail_image **view) {
+
+    SAIL_TRY(check_rectangle(source, x, y, width, height));
+    SAIL_CHECK_IMAGE_PTR(view);
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_share_image(source, &image_local));
+
+    SAIL_TRY_OR_CLEANUP(sail_crop_image(image_local, x, y, width, height),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    *view = image_local;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_crop_image(struct sail_image *image, unsigned x, unsigned y, unsigned width, unsigned height) {
+
+    SAIL_TRY(check_rectangle(image, x, y, width, height));
+
+    /* Owned pixels cannot be freed by an offset pointer. */
+    SAIL_TRY(adopt_pixels(image));
+
+    unsigned bits_per_pixel;
+    SAIL_TRY(sail_bits_per_pixel(image->pixel_format, &bits_per_pixel));
+
+    image->pixels = (unsigned char *)image->pixels + (size_t)image->bytes_per_line * y + (size_t)x * bits_per_pixel / 8;
+    image->width  = width;
+    image->height = height;
+    image->view   = true;
+
+    return SAIL_OK;
+}
+
+bool sail_is_image_shared(const struct sail_image *image) {
+
+    return image != NULL && image->pixel_buffer != NULL && pixel_buffer_references(image->pixel_buffer) > 1;
+}
+
+sail_status_t sail_make_image_writable(struct sail_image *image) {
+
+    SAIL_CHECK_IMAGE_PTR(image);
+
+    if (!sail_is_image_shared(image)) {
+        return SAIL_OK;
+    }
+
+    void *pixels;
+    unsigned bytes_per_line;
+    SAIL_TRY(copy_pixels(image, &pixels, &bytes_per_line));
+
+    release_pixels(image);
+
+    image->pixels         = pixels;
+    image->bytes_per_line = bytes_per_line;
+
+    return SAIL_OK;
+}
+
+void sail_replace_image_pixels(struct sail_image *image, void *pixels) {
+
+    if (image == NULL) {
+        return;
+    }
+
+    release_pixels(image);
+
+    image->pixels = pixels;
+}
+
 sail_status_t sail_copy_image_skeleton(const struct sail_image *source, struct sail_image **target) {
 
     SAIL_CHECK_IMAGE_PTR(source);
@@ -174,3 +420,83 @@ sail_status_t sail_check_image_valid(const struct sail_image *image)
 
     return SAIL_OK;
 }
+
+sail_status_t sail_image_pixels_size(const struct sail_image *image, size_t *result)
+{
+    SAIL_CHECK_IMAGE_PTR(image);
+    SAIL_CHECK_RESULT_PTR(result);
+
+    struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(image, planes, &planes_count));
+
+    size_t size = 0;
+
+    for (unsigned i = 0; i < planes_count; i++) {
+        size += (size_t)planes[i].height * planes[i].bytes_per_line;
+    }
+
+    *result = size;
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_image_planes(const struct sail_image *image,
+                                struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES],
+                                unsigned *planes_count)
+{
+    SAIL_CHECK_PTR(planes);
+    SAIL_CHECK_RESULT_PTR(planes_count);
+
+    SAIL_TRY(sail_check_image_skeleton_valid(image));
+
+    const unsigned chroma_width  = (image->width + 1) / 2;
+    const unsigned chroma_height = (image->height + 1) / 2;
+    const unsigned chroma_stride = (image->bytes_per_line + 1) / 2;
+
+    planes[0].width          = image->width;
+    planes[0].height         = image->height;
+    planes[0].bytes_per_line = image->bytes_per_line;
+
+    switch (image->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP12_I420: {
+            for (unsigned i = 1; i < 3; i++) {
+                planes[i].width          = chroma_width;
+                planes[i].height         = chroma_height;
+                planes[i].bytes_per_line = chroma_stride;
+            }
+            *planes_count = 3;
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
+            planes[1].width          = chroma_width;
+            planes[1].height         = chroma_height;
+            planes[1].bytes_per_line = chroma_stride * 2;
+            *planes_count = 2;
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP24_YUV444P: {
+            for (unsigned i = 1; i < 3; i++) {
+                planes[i] = planes[0];
+            }
+            *planes_count = 3;
+            break;
+        }
+        default: {
+            *planes_count = 1;
+            break;
+        }
+    }
+
+    unsigned char *pixels = image->pixels;
+
+    for (unsigned i = 0; i < *planes_count; i++) {
+        planes[i].pixels = pixels;
+
+        if (pixels != NULL) {
+            pixels += (size_t)planes[i].height * planes[i].bytes_per_line;
+        }
+    }
+
+    return SAIL_OK;
+}
@@ -27,6 +27,7 @@
 #define SAIL_IMAGE_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef SAIL_BUILD
     #include "error.h"
@@ -43,6 +44,7 @@ extern "C" {
 struct sail_iccp;
 struct sail_meta_data_node;
 struct sail_palette;
+struct sail_pixel_buffer;
 struct sail_resolution;
 struct sail_source_image;
 
@@ -174,10 +176,54 @@ struct sail_image {
      * WRITE: Ignored.
      */
     struct sail_source_image *source_image;
+
+    /*
+     * Reference-counted buffer the pixels point into or NULL if the image owns its pixels.
+     * Set by sail_share_image(), sail_image_view(), and sail_crop_image(). Shared pixels MUST NOT
+     * be modified without calling sail_make_image_writable() first.
+     *
+     * This field is used internally by SAIL. DO NOT alter its value.
+     *
+     * READ:  N/A.
+     * WRITE: N/A.
+     */
+    struct sail_pixel_buffer *pixel_buffer;
+
+    /*
+     * True if the pixels point to a rectangle inside the pixel buffer with the bytes per line
+     * of the parent image. Set by sail_image_view() and sail_crop_image().
+     *
+     * This field is used internally by SAIL. DO NOT alter its value.
+     *
+     * READ:  N/A.
+     * WRITE: N/A.
+     */
+    bool view;
 };
 
 typedef struct sail_image sail_image_t;
 
+/* The maximum number of planes an image could have. See sail_image_planes(). */
+#define SAIL_MAX_IMAGE_PLANES 3
+
+/*
+ * sail_image_plane describes a single plane of an image. It doesn't own its pixels.
+ */
+struct sail_image_plane {
+
+    /* Pointer to the first row of the plane inside sail_image.pixels. */
+    void *pixels;
+
+    /* Plane dimensions in samples. An interleaved UV sample of NV12 counts as one. */
+    unsigned width;
+    unsigned height;
+
+    /* Length of a row of the plane in bytes. */
+    unsigned bytes_per_line;
+};
+
+typedef struct sail_image_plane sail_image_plane_t;
+
 /*
  * Allocates a new image. The assigned image MUST be destroyed later with sail_destroy_image().
  *
@@ -194,10 +240,68 @@ SAIL_EXPORT void sail_destroy_image(struct sail_image *image);
 /*
  * Makes a deep copy of the specified image. The assigned image MUST be destroyed later with sail_destroy_image().
  *
+ * Views get compact rows without the parent padding.
+ *
  * Returns SAIL_OK on success.
  */
 SAIL_EXPORT sail_status_t sail_copy_image(const struct sail_image *source, struct sail_image **target);
 
+/*
+ * Makes a copy of the specified image that shares pixels with the source in O(1). Pixels are copied
+ * on the first write, see sail_make_image_writable(). Other image properties are deep copied.
+ * The assigned image MUST be destroyed later with sail_destroy_image().
+ *
+ * The source pixels are moved into a reference-counted buffer if they're not shared yet. The pixels
+ * pointer is not changed.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_share_image(struct sail_image *source, struct sail_image **target);
+
+/*
+ * Makes an image that points to the rectangle of the source image pixels in O(1). The view has
+ * the source bytes per line and shares pixels with the source just like sail_share_image() does.
+ * The assigned image MUST be destroyed later with sail_destroy_image(). It can outlive the source.
+ *
+ * The rectangle must fit into the source image. Planar pixel formats are not supported. The rectangle
+ * of an indexed image with less than 8 bits per pixel must start on a byte boundary.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_image_view(struct sail_image *source,
+                                          unsigned x, unsigned y,
+                                          unsigned width, unsigned height,
+                                          struct sail_image **view);
+
+/*
+ * Crops the image to the rectangle in place in O(1). The pixels are not moved, the image points
+ * to the rectangle inside them and keeps its bytes per line. The restrictions of sail_image_view() apply.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_crop_image(struct sail_image *image, unsigned x, unsigned y, unsigned width, unsigned height);
+
+/*
+ * Returns true if the image pixels are shared with other images.
+ */
+SAIL_EXPORT bool sail_is_image_shared(const struct sail_image *image);
+
+/*
+ * Makes sure the image pixels are not shared with other images, so they can be modified in place.
+ * Shared pixels are copied. Copied views get compact rows without the parent padding.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_make_image_writable(struct sail_image *image);
+
+/*
+ * Releases the image pixels and takes ownership of the new ones. Owned pixels are freed,
+ * and shared ones are dereferenced. The new pixels may be NULL.
+ *
+ * Use this function instead of freeing sail_image.pixels directly.
+ */
+SAIL_EXPORT void sail_replace_image_pixels(struct sail_image *image, void *pixels);
+
 /*
  * Makes a deep copy of the specified image without its pixels and palette.
  * The assigned image MUST be destroyed later with sail_destroy_image().
@@ -223,6 +327,32 @@ SAIL_EXPORT sail_status_t sail_check_image_skeleton_valid(const struct sail_imag
  */
 SAIL_EXPORT sail_status_t sail_check_image_valid(const struct sail_image *image);
 
+/*
+ * Calculates the number of bytes needed to store all the image pixels including all the planes
+ * of planar pixel formats. The image must have valid height, bytes per line, and pixel format.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_image_pixels_size(const struct sail_image *image, size_t *result);
+
+/*
+ * Splits the image pixels into planes. Packed pixel formats always have one plane that covers
+ * the whole image. Planar pixel formats like I420 have up to SAIL_MAX_IMAGE_PLANES planes
+ * stored one after another in sail_image.pixels:
+ *
+ *   - I420:    Y (width x height), U and V ((width+1)/2 x (height+1)/2), bytes per line (bytes_per_line+1)/2.
+ *   - NV12:    Y (width x height), interleaved UV ((width+1)/2 x (height+1)/2), bytes per line of UV
+ *              is ((bytes_per_line+1)/2)*2.
+ *   - YUV444P: Y, U, and V (width x height), bytes per line bytes_per_line.
+ *
+ * If the image has no pixels yet, the plane pixel pointers are set to NULL.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_image_planes(const struct sail_image *image,
+                                            struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES],
+                                            unsigned *planes_count);
+
 /* extern "C" */
 #ifdef __cplusplus
 }
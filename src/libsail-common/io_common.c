@@ -48,6 +48,8 @@ sail_status_t sail_alloc_io(struct sail_io **io) {
     (*io)->flush          = NULL;
     (*io)->close          = NULL;
     (*io)->eof            = NULL;
+    (*io)->map_range      = NULL;
+    (*io)->release        = NULL;
 
     return SAIL_OK;
 }
@@ -79,7 +81,8 @@ sail_status_t sail_check_io_valid(const struct sail_io *io)
             io->strict_write   == NULL ||
             io->flush          == NULL ||
             io->close          == NULL ||
-            io->eof            == NULL) {
+            io->eof            == NULL ||
+            (io->map_range != NULL && io->release == NULL)) {
         SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_IO);
     }
 
@@ -114,6 +114,26 @@ typedef sail_status_t (*sail_io_close_t)(void *stream);
  */
 typedef sail_status_t (*sail_io_eof_t)(void *stream, bool *result);
 
+/*
+ * Optional. Provides direct read-only access to the data of the underlying I/O object without copying.
+ * Assigns a pointer to the data starting at the specified absolute offset to 'ptr' and the number
+ * of accessible bytes to 'mapped_size'. 'mapped_size' can be smaller than requested near the end
+ * of the data, and 0 when the offset is at or beyond the end. Doesn't change the I/O position.
+ *
+ * The data stays valid until it's released with sail_io_release_t or the I/O object is closed.
+ *
+ * Returns SAIL_OK on success.
+ */
+typedef sail_status_t (*sail_io_map_range_t)(void *stream, size_t offset, size_t size, const void **ptr, size_t *mapped_size);
+
+/*
+ * Optional. Releases the data returned by sail_io_map_range_t. Releasing is a hint:
+ * closing the I/O object releases all the data anyway.
+ *
+ * Returns SAIL_OK on success.
+ */
+typedef sail_status_t (*sail_io_release_t)(void *stream, const void *ptr);
+
 /*
  * Well-known I/O ids used in libsail for file and memory I/O classes.
  *
@@ -122,9 +142,15 @@ typedef sail_status_t (*sail_io_eof_t)(void *stream, bool *result);
  *
  * SAIL_FILE_IO_ID   = sail_hash("sail-file-io-id")
  * SAIL_MEMORY_IO_ID = sail_hash("sail-memory-io-id")
+ * SAIL_FD_IO_ID     = sail_hash("sail-fd-io-id")
+ *
+ * Large files opened for reading are memory-mapped, but still use SAIL_FILE_IO_ID. Such files MUST NOT be
+ * truncated while they're read: reading the truncated part raises SIGBUS on POSIX systems and
+ * EXCEPTION_IN_PAGE_ERROR on Windows instead of returning an error.
  */
 static const uint64_t SAIL_FILE_IO_ID   = UINT64_C(5820790535323209114);
 static const uint64_t SAIL_MEMORY_IO_ID = UINT64_C(11955407548648566675);
+static const uint64_t SAIL_FD_IO_ID     = UINT64_C(3630325080440624196);
 
 /*
  * sail_io represents an input/output abstraction. Use sail_alloc_io_read_file() and brothers to
@@ -191,6 +217,18 @@ struct sail_io {
      * EOF callback.
      */
     sail_io_eof_t eof;
+
+    /*
+     * Optional zero-copy map range callback. NULL if the I/O object cannot provide direct access
+     * to its data. Memory I/O objects and memory-mapped file I/O objects implement it. Codecs use it
+     * when available and fall back to the read callbacks otherwise.
+     */
+    sail_io_map_range_t map_range;
+
+    /*
+     * Optional release callback. Must be set if map_range is set.
+     */
+    sail_io_release_t release;
 };
 
 typedef struct sail_io sail_io_t;
@@ -215,6 +253,7 @@ SAIL_EXPORT void sail_destroy_io(struct sail_io *io);
 
 /*
  * Returns SAIL_OK if the given I/O object has valid callbacks and a non-zero id.
+ * Optional callbacks can be NULL, but map_range requires release.
  *
  * Returns SAIL_OK on success.
  */
@@ -0,0 +1,153 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "sail-common.h"
+
+#define INDEXED        SAIL_PIXEL_FORMAT_PROPERTY_INDEXED
+#define GRAYSCALE      SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE
+#define RGB_FAMILY     SAIL_PIXEL_FORMAT_PROPERTY_RGB_FAMILY
+#define ALPHA          SAIL_PIXEL_FORMAT_PROPERTY_ALPHA
+#define PREMULTIPLIED  SAIL_PIXEL_FORMAT_PROPERTY_PREMULTIPLIED
+#define FLOATING_POINT SAIL_PIXEL_FORMAT_PROPERTY_FLOATING_POINT
+#define PLANAR         SAIL_PIXEL_FORMAT_PROPERTY_PLANAR
+
+/*
+ * Indexed by SailPixelFormat. Pixel formats missing here are unknown and get all zeros.
+ * Columns: bits per pixel, channels, bits per channel, flags.
+ */
+static const struct sail_pixel_format_properties PROPERTIES[] = {
+
+    [SAIL_PIXEL_FORMAT_BPP1]   = {   1, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP2]   = {   2, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP4]   = {   4, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP8]   = {   8, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP16]  = {  16, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP24]  = {  24, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP32]  = {  32, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP48]  = {  48, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP64]  = {  64, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP72]  = {  72, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP96]  = {  96, 0, 0, 0 },
+    [SAIL_PIXEL_FORMAT_BPP128] = { 128, 0, 0, 0 },
+
+    [SAIL_PIXEL_FORMAT_BPP1_INDEXED]  = {  1, 1, 1, INDEXED },
+    [SAIL_PIXEL_FORMAT_BPP2_INDEXED]  = {  2, 1, 2, INDEXED },
+    [SAIL_PIXEL_FORMAT_BPP4_INDEXED]  = {  4, 1, 4, INDEXED },
+    [SAIL_PIXEL_FORMAT_BPP8_INDEXED]  = {  8, 1, 8, INDEXED },
+    [SAIL_PIXEL_FORMAT_BPP16_INDEXED] = { 16, 1, 8, INDEXED },
+
+    [SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE]  = {  1, 1,  1, GRAYSCALE },
+    [SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE]  = {  2, 1,  2, GRAYSCALE },
+    [SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE]  = {  4, 1,  4, GRAYSCALE },
+    [SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE]  = {  8, 1,  8, GRAYSCALE },
+    [SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE] = { 16, 1, 16, GRAYSCALE },
+
+    [SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE_ALPHA]  = {  4, 2,  2, GRAYSCALE | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE_ALPHA]  = {  8, 2,  4, GRAYSCALE | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA] = { 16, 2,  8, GRAYSCALE | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA] = { 32, 2, 16, GRAYSCALE | ALPHA },
+
+    [SAIL_PIXEL_FORMAT_BPP16_RGB555] = { 16, 3, 5, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP16_BGR555] = { 16, 3, 5, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP16_RGB565] = { 16, 3, 5, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP16_BGR565] = { 16, 3, 5, RGB_FAMILY },
+
+    [SAIL_PIXEL_FORMAT_BPP24_RGB] = { 24, 3,  8, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP24_BGR] = { 24, 3,  8, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP48_RGB] = { 48, 3, 16, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP48_BGR] = { 48, 3, 16, RGB_FAMILY },
+
+    [SAIL_PIXEL_FORMAT_BPP32_RGBX] = { 32, 3, 8, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP32_BGRX] = { 32, 3, 8, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP32_XRGB] = { 32, 3, 8, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP32_XBGR] = { 32, 3, 8, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP32_RGBA] = { 32, 4, 8, RGB_FAMILY | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP32_BGRA] = { 32, 4, 8, RGB_FAMILY | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP32_ARGB] = { 32, 4, 8, RGB_FAMILY | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP32_ABGR] = { 32, 4, 8, RGB_FAMILY | ALPHA },
+
+    [SAIL_PIXEL_FORMAT_BPP64_RGBX] = { 64, 3, 16, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP64_BGRX] = { 64, 3, 16, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP64_XRGB] = { 64, 3, 16, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP64_XBGR] = { 64, 3, 16, RGB_FAMILY },
+    [SAIL_PIXEL_FORMAT_BPP64_RGBA] = { 64, 4, 16, RGB_FAMILY | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP64_BGRA] = { 64, 4, 16, RGB_FAMILY | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP64_ARGB] = { 64, 4, 16, RGB_FAMILY | ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP64_ABGR] = { 64, 4, 16, RGB_FAMILY | ALPHA },
+
+    [SAIL_PIXEL_FORMAT_BPP32_CMYK] = { 32, 4,  8, 0 },
+    [SAIL_PIXEL_FORMAT_BPP64_CMYK] = { 64, 4, 16, 0 },
+
+    [SAIL_PIXEL_FORMAT_BPP24_YCBCR] = { 24, 3, 8, 0 },
+    [SAIL_PIXEL_FORMAT_BPP32_YCCK]  = { 32, 4, 8, 0 },
+
+    /* L is 8-bit, a and b are 16-bit in the 40-bit pixel formats. */
+    [SAIL_PIXEL_FORMAT_BPP24_CIE_LAB] = { 24, 3, 8, 0 },
+    [SAIL_PIXEL_FORMAT_BPP40_CIE_LAB] = { 40, 3, 8, 0 },
+    [SAIL_PIXEL_FORMAT_BPP24_CIE_LUV] = { 24, 3, 8, 0 },
+    [SAIL_PIXEL_FORMAT_BPP40_CIE_LUV] = { 40, 3, 8, 0 },
+
+    [SAIL_PIXEL_FORMAT_BPP24_YUV]  = { 24, 3,  8, 0 },
+    [SAIL_PIXEL_FORMAT_BPP30_YUV]  = { 30, 3, 10, 0 },
+    [SAIL_PIXEL_FORMAT_BPP36_YUV]  = { 36, 3, 12, 0 },
+    [SAIL_PIXEL_FORMAT_BPP48_YUV]  = { 48, 3, 16, 0 },
+    [SAIL_PIXEL_FORMAT_BPP32_YUVA] = { 32, 4,  8, ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP40_YUVA] = { 40, 4, 10, ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP48_YUVA] = { 48, 4, 12, ALPHA },
+    [SAIL_PIXEL_FORMAT_BPP64_YUVA] = { 64, 4, 16, ALPHA },
+
+    [SAIL_PIXEL_FORMAT_BPP12_I420]    = { 12, 3, 8, PLANAR },
+    [SAIL_PIXEL_FORMAT_BPP12_NV12]    = { 12, 3, 8, PLANAR },
+    [SAIL_PIXEL_FORMAT_BPP24_YUV444P] = { 24, 3, 8, PLANAR },
+
+    [SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED] = { 32, 4,  8, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED] = { 32, 4,  8, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED] = { 32, 4,  8, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED] = { 32, 4,  8, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED] = { 64, 4, 16, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED] = { 64, 4, 16, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED] = { 64, 4, 16, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+    [SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED] = { 64, 4, 16, RGB_FAMILY | ALPHA | PREMULTIPLIED },
+
+    [SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF]  = {  16, 1, 16, GRAYSCALE | FLOATING_POINT },
+    [SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT] = {  32, 1, 32, GRAYSCALE | FLOATING_POINT },
+    [SAIL_PIXEL_FORMAT_BPP48_RGB_HALF]        = {  48, 3, 16, RGB_FAMILY | FLOATING_POINT },
+    [SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF]       = {  64, 4, 16, RGB_FAMILY | ALPHA | FLOATING_POINT },
+    [SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT]       = {  96, 3, 32, RGB_FAMILY | FLOATING_POINT },
+    [SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT]     = { 128, 4, 32, RGB_FAMILY | ALPHA | FLOATING_POINT },
+};
+
+static const size_t PROPERTIES_LENGTH = sizeof(PROPERTIES) / sizeof(PROPERTIES[0]);
+
+static const struct sail_pixel_format_properties UNKNOWN_PROPERTIES = { 0, 0, 0, 0 };
+
+const struct sail_pixel_format_properties* sail_pixel_format_properties_of(enum SailPixelFormat pixel_format) {
+
+    if ((size_t)pixel_format >= PROPERTIES_LENGTH) {
+        return &UNKNOWN_PROPERTIES;
+    }
+
+    return &PROPERTIES[pixel_format];
+}
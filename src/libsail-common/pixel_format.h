@@ -0,0 +1,109 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PIXEL_FORMAT_H
+#define SAIL_PIXEL_FORMAT_H
+
+#ifdef SAIL_BUILD
+    #include "common.h"
+    #include "export.h"
+#else
+    #include <sail-common/common.h>
+    #include <sail-common/export.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pixel format property flags. See sail_pixel_format_properties.flags.
+ */
+enum SailPixelFormatProperty {
+
+    /* Pixels are palette indexes. */
+    SAIL_PIXEL_FORMAT_PROPERTY_INDEXED        = 1 << 0,
+
+    /* Grayscale, with or without alpha. */
+    SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE      = 1 << 1,
+
+    /* A kind of RGB, packed or not. */
+    SAIL_PIXEL_FORMAT_PROPERTY_RGB_FAMILY     = 1 << 2,
+
+    /* Has an alpha channel. Indexed pixel formats never have this flag as alpha lives in palettes. */
+    SAIL_PIXEL_FORMAT_PROPERTY_ALPHA          = 1 << 3,
+
+    /* Color components are premultiplied by alpha. */
+    SAIL_PIXEL_FORMAT_PROPERTY_PREMULTIPLIED  = 1 << 4,
+
+    /* Components are half or single precision floating point numbers. */
+    SAIL_PIXEL_FORMAT_PROPERTY_FLOATING_POINT = 1 << 5,
+
+    /* Channels are stored in separate planes. */
+    SAIL_PIXEL_FORMAT_PROPERTY_PLANAR         = 1 << 6,
+};
+
+/*
+ * Static properties of a pixel format.
+ */
+struct sail_pixel_format_properties {
+
+    /*
+     * Number of bits per pixel. Planar pixel formats report the average number of bits over all
+     * their planes, e.g. 12 for I420. 0 if the pixel format is unknown.
+     */
+    unsigned bits_per_pixel;
+
+    /*
+     * Number of meaningful channels including alpha. Padding channels like X in RGBX are not counted.
+     * Indexed pixel formats have 1 channel. 0 for pixel formats without a color model like BPP24.
+     */
+    unsigned channels;
+
+    /*
+     * Precision of the narrowest channel in bits, e.g. 5 for RGB565 or 16 for RGBA64.
+     * Indexed pixel formats report their index size limited by 8 as palettes store 8-bit channels.
+     */
+    unsigned bits_per_channel;
+
+    /* Or-ed SailPixelFormatProperty flags. */
+    int flags;
+};
+
+typedef struct sail_pixel_format_properties sail_pixel_format_properties_t;
+
+/*
+ * Returns the static properties of the pixel format. The properties are stored in a compile-time table,
+ * so the function is a single lookup. Never returns NULL. Unknown or invalid pixel formats get
+ * properties with all the fields set to 0.
+ */
+SAIL_EXPORT const struct sail_pixel_format_properties* sail_pixel_format_properties_of(enum SailPixelFormat pixel_format);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,7 +37,10 @@ sail_status_t sail_alloc_read_options(struct sail_read_options **read_options) {
     SAIL_TRY(sail_malloc(sizeof(struct sail_read_options), &ptr));
     *read_options = ptr;
 
-    (*read_options)->io_options = 0;
+    (*read_options)->io_options          = 0;
+    (*read_options)->output_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+    (*read_options)->yuv_matrix          = SAIL_YUV_MATRIX_BT601;
+    (*read_options)->yuv_range           = SAIL_YUV_RANGE_FULL;
 
     return SAIL_OK;
 }
@@ -56,7 +59,10 @@ sail_status_t sail_read_options_from_features(const struct sail_read_features *r
     SAIL_CHECK_READ_FEATURES_PTR(read_features);
     SAIL_CHECK_READ_OPTIONS_PTR(read_options);
 
-    read_options->io_options = 0;
+    read_options->io_options          = 0;
+    read_options->output_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+    read_options->yuv_matrix          = SAIL_YUV_MATRIX_BT601;
+    read_options->yuv_range           = SAIL_YUV_RANGE_FULL;
 
     if (read_features->features & SAIL_CODEC_FEATURE_META_DATA) {
         read_options->io_options |= SAIL_IO_OPTION_META_DATA;
@@ -27,9 +27,11 @@
 #define SAIL_READ_OPTIONS_H
 
 #ifdef SAIL_BUILD
+    #include "common.h"
     #include "error.h"
     #include "export.h"
 #else
+    #include <sail-common/common.h>
     #include <sail-common/error.h>
     #include <sail-common/export.h>
 #endif
@@ -47,6 +49,25 @@ struct sail_read_options {
 
     /* Or-ed I/O manipulation options for reading operations. See SailIoOption. */
     int io_options;
+
+    /*
+     * Pixel format to convert every frame to. SAIL_PIXEL_FORMAT_UNKNOWN keeps the pixel format produced
+     * by the codec. Codecs still decode whole frames, so a frame is converted after the codec reads it.
+     * The frame pixel buffer is allocated large enough for both pixel formats and is converted in place
+     * band by band. Conversions from or to planar pixel formats, and color frames quantized into indexed
+     * pixel formats, need a second frame buffer.
+     * Reading fails with SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT if the codec pixel format cannot be converted.
+     * See sail_can_convert() and sail_set_reading_conversion_options().
+     */
+    enum SailPixelFormat output_pixel_format;
+
+    /*
+     * Matrix and range of planar YUV output pixel formats like I420. Codecs that store YUV natively,
+     * like JPEG, output its planes directly when they match. Defaults to SAIL_YUV_MATRIX_BT601
+     * and SAIL_YUV_RANGE_FULL.
+     */
+    enum SailYuvMatrix yuv_matrix;
+    enum SailYuvRange yuv_range;
 };
 
 typedef struct sail_read_options sail_read_options_t;
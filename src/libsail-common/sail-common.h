@@ -42,6 +42,7 @@
     #include "meta_data_node.h"
     #include "palette.h"
     #include "pixel.h"
+    #include "pixel_format.h"
     #include "read_features.h"
     #include "read_options.h"
     #include "resolution.h"
@@ -63,6 +64,7 @@
     #include <sail-common/meta_data_node.h>
     #include <sail-common/palette.h>
     #include <sail-common/pixel.h>
+    #include <sail-common/pixel_format.h>
     #include <sail-common/read_features.h>
     #include <sail-common/read_options.h>
     #include <sail-common/resolution.h>
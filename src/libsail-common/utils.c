@@ -300,6 +300,29 @@ const char* sail_pixel_format_to_string(enum SailPixelFormat pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP40_YUVA:            return "BPP40-YUVA";
         case SAIL_PIXEL_FORMAT_BPP48_YUVA:            return "BPP48-YUVA";
         case SAIL_PIXEL_FORMAT_BPP64_YUVA:            return "BPP64-YUVA";
+
+        case SAIL_PIXEL_FORMAT_BPP12_I420:            return "BPP12-I420";
+        case SAIL_PIXEL_FORMAT_BPP12_NV12:            return "BPP12-NV12";
+        case SAIL_PIXEL_FORMAT_BPP24_YUV444P:         return "BPP24-YUV444P";
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: return "BPP32-RGBA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: return "BPP32-BGRA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: return "BPP32-ARGB-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: return "BPP32-ABGR-PREMULTIPLIED";
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: return "BPP64-RGBA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: return "BPP64-BGRA-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: return "BPP64-ARGB-PREMULTIPLIED";
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: return "BPP64-ABGR-PREMULTIPLIED";
+
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF:  return "BPP16-GRAYSCALE-HALF";
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT: return "BPP32-GRAYSCALE-FLOAT";
+
+        case SAIL_PIXEL_FORMAT_BPP48_RGB_HALF:        return "BPP48-RGB-HALF";
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF:       return "BPP64-RGBA-HALF";
+
+        case SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT:       return "BPP96-RGB-FLOAT";
+        case SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT:     return "BPP128-RGBA-FLOAT";
     }
 
     return NULL;
@@ -402,6 +425,29 @@ enum SailPixelFormat sail_pixel_format_from_string(const char *str) {
         case UINT64_C(8244605668934919965):  return SAIL_PIXEL_FORMAT_BPP40_YUVA;
         case UINT64_C(8244605669248003109):  return SAIL_PIXEL_FORMAT_BPP48_YUVA;
         case UINT64_C(8244605671674397475):  return SAIL_PIXEL_FORMAT_BPP64_YUVA;
+
+        case UINT64_C(8244605665138174710):  return SAIL_PIXEL_FORMAT_BPP12_I420;
+        case UINT64_C(8244605665138391390):  return SAIL_PIXEL_FORMAT_BPP12_NV12;
+        case UINT64_C(13237269467775537930): return SAIL_PIXEL_FORMAT_BPP24_YUV444P;
+
+        case UINT64_C(5755462582571748834):  return SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED;
+        case UINT64_C(10184454581647182306): return SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED;
+        case UINT64_C(5784931875222153954):  return SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED;
+        case UINT64_C(888213552061228770):   return SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED;
+
+        case UINT64_C(403932174454299175):   return SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED;
+        case UINT64_C(4832924173529732647):  return SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED;
+        case UINT64_C(433401467104704295):   return SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED;
+        case UINT64_C(13983427217653330727): return SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED;
+
+        case UINT64_C(7366675392659974974):  return SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF;
+        case UINT64_C(5929884054559126231):  return SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT;
+
+        case UINT64_C(12558027227981272355): return SAIL_PIXEL_FORMAT_BPP48_RGB_HALF;
+        case UINT64_C(8681486799609175842):  return SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF;
+
+        case UINT64_C(8836176276367984001):  return SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT;
+        case UINT64_C(8069583518561661742):  return SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT;
     }
 
     return SAIL_PIXEL_FORMAT_UNKNOWN;
@@ -633,93 +679,15 @@ sail_status_t sail_bits_per_pixel(enum SailPixelFormat pixel_format, unsigned *r
 
     SAIL_CHECK_RESULT_PTR(result);
 
-    switch (pixel_format) {
-        case SAIL_PIXEL_FORMAT_UNKNOWN:   SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
-
-        case SAIL_PIXEL_FORMAT_BPP1:   *result = 1;   return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP2:   *result = 2;   return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP4:   *result = 4;   return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP8:   *result = 8;   return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP16:  *result = 16;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP24:  *result = 24;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP32:  *result = 32;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP48:  *result = 48;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP64:  *result = 64;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP72:  *result = 72;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP96:  *result = 96;  return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP128: *result = 128; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP1_INDEXED:  *result = 1; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP2_INDEXED:  *result = 2; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP4_INDEXED:  *result = 4; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP8_INDEXED:  *result = 8; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP16_INDEXED: *result = 16; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE:  *result = 1; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE:  *result = 2; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE:  *result = 4; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE:  *result = 8; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE: *result = 16; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE_ALPHA:  *result = 4; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE_ALPHA:  *result = 8; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: *result = 16; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: *result = 32; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP16_RGB555:
-        case SAIL_PIXEL_FORMAT_BPP16_BGR555:
-        case SAIL_PIXEL_FORMAT_BPP16_RGB565:
-        case SAIL_PIXEL_FORMAT_BPP16_BGR565: *result = 16; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP24_RGB:
-        case SAIL_PIXEL_FORMAT_BPP24_BGR: *result = 24; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP48_RGB:
-        case SAIL_PIXEL_FORMAT_BPP48_BGR: *result = 48; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP32_RGBX:
-        case SAIL_PIXEL_FORMAT_BPP32_BGRX:
-        case SAIL_PIXEL_FORMAT_BPP32_XRGB:
-        case SAIL_PIXEL_FORMAT_BPP32_XBGR:
-        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
-        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
-        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
-        case SAIL_PIXEL_FORMAT_BPP32_ABGR: *result = 32; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP64_RGBX:
-        case SAIL_PIXEL_FORMAT_BPP64_BGRX:
-        case SAIL_PIXEL_FORMAT_BPP64_XRGB:
-        case SAIL_PIXEL_FORMAT_BPP64_XBGR:
-        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
-        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
-        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
-        case SAIL_PIXEL_FORMAT_BPP64_ABGR: *result = 64; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP32_CMYK: *result = 32; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP64_CMYK: *result = 64; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP24_YCBCR: *result = 24; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP32_YCCK: *result = 32; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP24_CIE_LAB: *result = 24; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP40_CIE_LAB: *result = 40; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP24_CIE_LUV: *result = 24; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP40_CIE_LUV: *result = 40; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP24_YUV: *result = 24; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP30_YUV: *result = 30; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP36_YUV: *result = 36; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP48_YUV: *result = 48; return SAIL_OK;
-
-        case SAIL_PIXEL_FORMAT_BPP32_YUVA: *result = 32; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP40_YUVA: *result = 40; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP48_YUVA: *result = 48; return SAIL_OK;
-        case SAIL_PIXEL_FORMAT_BPP64_YUVA: *result = 64; return SAIL_OK;
+    const unsigned bits_per_pixel = sail_pixel_format_properties_of(pixel_format)->bits_per_pixel;
+
+    if (bits_per_pixel == 0) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
-    SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    *result = bits_per_pixel;
+
+    return SAIL_OK;
 }
 
 enum SailPixelFormatComparisonPrivate {
@@ -809,87 +777,48 @@ sail_status_t sail_bytes_per_line(unsigned width, enum SailPixelFormat pixel_for
 
     SAIL_CHECK_RESULT_PTR(result);
 
+    /* Planar formats report the stride of the full-resolution luma plane. */
+    if (sail_is_planar(pixel_format)) {
+        *result = width;
+        return SAIL_OK;
+    }
+
     unsigned bits_per_pixel;
     SAIL_TRY(sail_bits_per_pixel(pixel_format, &bits_per_pixel));
 
-    *result = (unsigned)(((double)width * bits_per_pixel + 7) / 8);
+    *result = (unsigned)(((uint64_t)width * bits_per_pixel + 7) / 8);
 
     return SAIL_OK;
 }
 
 bool sail_is_indexed(enum SailPixelFormat pixel_format) {
 
-    switch (pixel_format) {
-        case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP2_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP4_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP8_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP16_INDEXED: {
-            return true;
-        }
-        default: {
-            return false;
-        }
-    }
+    return (sail_pixel_format_properties_of(pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_INDEXED) != 0;
 }
 
 bool sail_is_grayscale(enum SailPixelFormat pixel_format) {
 
-    switch (pixel_format) {
-        case SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE:
-        case SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE:
-        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE:
-        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE:
-        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE:
-        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE_ALPHA:
-        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE_ALPHA:
-        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA:
-        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: {
-            return true;
-        }
-        default: {
-            return false;
-        }
-    }
+    return (sail_pixel_format_properties_of(pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE) != 0;
 }
 
 bool sail_is_rgb_family(enum SailPixelFormat pixel_format) {
 
-    switch (pixel_format) {
-        case SAIL_PIXEL_FORMAT_BPP16_RGB555:
-        case SAIL_PIXEL_FORMAT_BPP16_BGR555:
-        case SAIL_PIXEL_FORMAT_BPP16_RGB565:
-        case SAIL_PIXEL_FORMAT_BPP16_BGR565:
-
-        case SAIL_PIXEL_FORMAT_BPP24_RGB:
-        case SAIL_PIXEL_FORMAT_BPP24_BGR:
-
-        case SAIL_PIXEL_FORMAT_BPP48_RGB:
-        case SAIL_PIXEL_FORMAT_BPP48_BGR:
-
-        case SAIL_PIXEL_FORMAT_BPP32_RGBX:
-        case SAIL_PIXEL_FORMAT_BPP32_BGRX:
-        case SAIL_PIXEL_FORMAT_BPP32_XRGB:
-        case SAIL_PIXEL_FORMAT_BPP32_XBGR:
-        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
-        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
-        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
-        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
-
-        case SAIL_PIXEL_FORMAT_BPP64_RGBX:
-        case SAIL_PIXEL_FORMAT_BPP64_BGRX:
-        case SAIL_PIXEL_FORMAT_BPP64_XRGB:
-        case SAIL_PIXEL_FORMAT_BPP64_XBGR:
-        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
-        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
-        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
-        case SAIL_PIXEL_FORMAT_BPP64_ABGR: {
-            return true;
-        }
-        default: {
-            return false;
-        }
-    }
+    return (sail_pixel_format_properties_of(pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_RGB_FAMILY) != 0;
+}
+
+bool sail_is_planar(enum SailPixelFormat pixel_format) {
+
+    return (sail_pixel_format_properties_of(pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_PLANAR) != 0;
+}
+
+bool sail_is_premultiplied(enum SailPixelFormat pixel_format) {
+
+    return (sail_pixel_format_properties_of(pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_PREMULTIPLIED) != 0;
+}
+
+bool sail_is_floating_point(enum SailPixelFormat pixel_format) {
+
+    return (sail_pixel_format_properties_of(pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_FLOATING_POINT) != 0;
 }
 
 sail_status_t sail_print_errno(const char *format) {
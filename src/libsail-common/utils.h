@@ -258,6 +258,24 @@ SAIL_EXPORT bool sail_is_grayscale(enum SailPixelFormat pixel_format);
  */
 SAIL_EXPORT bool sail_is_rgb_family(enum SailPixelFormat pixel_format);
 
+/*
+ * Returns true if the given pixel format stores its channels in separate planes. E.g. I420, NV12 etc.
+ * Planar images keep all their planes in sail_image.pixels. See sail_image_planes().
+ */
+SAIL_EXPORT bool sail_is_planar(enum SailPixelFormat pixel_format);
+
+/*
+ * Returns true if the color components of the given pixel format are premultiplied by alpha.
+ * E.g. BPP32-RGBA-PREMULTIPLIED.
+ */
+SAIL_EXPORT bool sail_is_premultiplied(enum SailPixelFormat pixel_format);
+
+/*
+ * Returns true if the given pixel format stores its components as half or single precision
+ * floating point numbers. E.g. BPP128-RGBA-FLOAT.
+ */
+SAIL_EXPORT bool sail_is_floating_point(enum SailPixelFormat pixel_format);
+
 /*
  * Prints the recent errno value with SAIL_LOG_ERROR(). The specified format must include '%s'.
  *
@@ -0,0 +1,368 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+/*
+ * Interleaved pixel layout. Gray pixel formats use the same offset for red, green, and blue.
+ */
+struct analysis_layout {
+    unsigned channels;
+    unsigned bytes_per_sample;
+    unsigned r;
+    unsigned g;
+    unsigned b;
+    /* -1 if there is no alpha. */
+    int a;
+};
+
+static bool analysis_layout(enum SailPixelFormat pixel_format, struct analysis_layout *layout) {
+
+#define SAIL_SET_LAYOUT(channels_, bytes_per_sample_, r_, g_, b_, a_) \
+    do {                                                              \
+        layout->channels         = channels_;                         \
+        layout->bytes_per_sample = bytes_per_sample_;                 \
+        layout->r                = r_;                                \
+        layout->g                = g_;                                \
+        layout->b                = b_;                                \
+        layout->a                = a_;                                \
+    } while (0)
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE:        SAIL_SET_LAYOUT(1, 1, 0, 0, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE:       SAIL_SET_LAYOUT(1, 2, 0, 0, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: SAIL_SET_LAYOUT(2, 1, 0, 0, 0,  1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: SAIL_SET_LAYOUT(2, 2, 0, 0, 0,  1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP24_RGB: SAIL_SET_LAYOUT(3, 1, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP24_BGR: SAIL_SET_LAYOUT(3, 1, 2, 1, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP48_RGB: SAIL_SET_LAYOUT(3, 2, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP48_BGR: SAIL_SET_LAYOUT(3, 2, 2, 1, 0, -1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX: SAIL_SET_LAYOUT(4, 1, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX: SAIL_SET_LAYOUT(4, 1, 2, 1, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB: SAIL_SET_LAYOUT(4, 1, 1, 2, 3, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR: SAIL_SET_LAYOUT(4, 1, 3, 2, 1, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_RGBX: SAIL_SET_LAYOUT(4, 2, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_BGRX: SAIL_SET_LAYOUT(4, 2, 2, 1, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_XRGB: SAIL_SET_LAYOUT(4, 2, 1, 2, 3, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_XBGR: SAIL_SET_LAYOUT(4, 2, 3, 2, 1, -1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 1, 0, 1, 2, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 1, 2, 1, 0, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 1, 1, 2, 3, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 1, 3, 2, 1, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 2, 0, 1, 2, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 2, 2, 1, 0, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 2, 1, 2, 3, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 2, 3, 2, 1, 0); return true;
+
+        default: {
+            return false;
+        }
+    }
+
+#undef SAIL_SET_LAYOUT
+}
+
+/*
+ * Distinct pixel values. Open addressing with linear probing.
+ */
+#define COLOR_SET_SIZE 1024
+
+struct color_set {
+    uint64_t colors[COLOR_SET_SIZE];
+    bool used[COLOR_SET_SIZE];
+    unsigned count;
+    /* Set when there are more than SAIL_ANALYSIS_MAX_COLORS colors. */
+    bool overflow;
+};
+
+static void add_color(struct color_set *color_set, uint64_t color) {
+
+    unsigned slot = (unsigned)((color * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - 10));
+
+    while (color_set->used[slot]) {
+        if (color_set->colors[slot] == color) {
+            return;
+        }
+
+        slot = (slot + 1) & (COLOR_SET_SIZE - 1);
+    }
+
+    if (color_set->count == SAIL_ANALYSIS_MAX_COLORS) {
+        color_set->overflow = true;
+        return;
+    }
+
+    color_set->used[slot]   = true;
+    color_set->colors[slot] = color;
+    color_set->count++;
+}
+
+/*
+ * Every property is computed with a branchless loop over the row, so compilers vectorize it.
+ * A property is not checked anymore as soon as it's known to be false.
+ */
+#define DEFINE_ANALYZE_ROW(bits, type)                                                                    \
+static void analyze_row##bits(const type *scan, unsigned width, const struct analysis_layout *layout,     \
+                              struct sail_image_analysis *analysis, struct color_set *color_set) {        \
+                                                                                                          \
+    const unsigned channels = layout->channels;                                                           \
+    const type max = (type)~(type)0;                                                                      \
+                                                                                                          \
+    if (analysis->opaque && layout->a >= 0) {                                                             \
+        const type *alpha = scan + layout->a;                                                             \
+        type all = max;                                                                                   \
+                                                                                                          \
+        for (unsigned column = 0; column < width; column++) {                                             \
+            all &= alpha[column * channels];                                                              \
+        }                                                                                                 \
+                                                                                                          \
+        analysis->opaque = all == max;                                                                    \
+    }                                                                                                     \
+                                                                                                          \
+    if (analysis->grayscale && layout->r != layout->g) {                                                  \
+        unsigned diff = 0;                                                                                \
+                                                                                                          \
+        for (unsigned column = 0; column < width; column++) {                                             \
+            const type *pixel = scan + column * channels;                                                 \
+            diff |= (unsigned)(pixel[layout->r] ^ pixel[layout->g]) | (unsigned)(pixel[layout->r] ^ pixel[layout->b]); \
+        }                                                                                                 \
+                                                                                                          \
+        analysis->grayscale = diff == 0;                                                                  \
+    }                                                                                                     \
+                                                                                                          \
+    if (analysis->fits_8_bits && (bits) == 16) {                                                          \
+        unsigned diff = 0;                                                                                \
+                                                                                                          \
+        for (unsigned column = 0; column < width; column++) {                                             \
+            const type *pixel = scan + column * channels;                                                 \
+            const unsigned a = (layout->a >= 0) ? pixel[layout->a] : 0;                                   \
+                                                                                                          \
+            diff |= ((unsigned)(pixel[layout->r] >> 8) ^ (pixel[layout->r] & 0xFFu))                      \
+                  | ((unsigned)(pixel[layout->g] >> 8) ^ (pixel[layout->g] & 0xFFu))                      \
+                  | ((unsigned)(pixel[layout->b] >> 8) ^ (pixel[layout->b] & 0xFFu))                      \
+                  | ((a >> 8) ^ (a & 0xFFu));                                                             \
+        }                                                                                                 \
+                                                                                                          \
+        analysis->fits_8_bits = diff == 0;                                                                \
+    }                                                                                                     \
+                                                                                                          \
+    if (!color_set->overflow) {                                                                           \
+        uint64_t last_color = 0;                                                                          \
+        bool has_last_color = false;                                                                      \
+                                                                                                          \
+        for (unsigned column = 0; column < width && !color_set->overflow; column++) {                     \
+            const type *pixel = scan + column * channels;                                                 \
+            const uint64_t color = (uint64_t)pixel[layout->r]                                             \
+                                    | ((uint64_t)pixel[layout->g] << 16)                                  \
+                                    | ((uint64_t)pixel[layout->b] << 32)                                  \
+                                    | ((uint64_t)((layout->a >= 0) ? pixel[layout->a] : max) << 48);      \
+                                                                                                          \
+            if (has_last_color && color == last_color) {                                                  \
+                continue;                                                                                 \
+            }                                                                                             \
+                                                                                                          \
+            add_color(color_set, color);                                                                  \
+            last_color = color;                                                                           \
+            has_last_color = true;                                                                        \
+        }                                                                                                 \
+    }                                                                                                     \
+}
+
+DEFINE_ANALYZE_ROW(8,  uint8_t)
+DEFINE_ANALYZE_ROW(16, uint16_t)
+
+static sail_status_t analyze_palette(const struct sail_palette *palette, struct sail_image_analysis *analysis, struct color_set *color_set) {
+
+    for (unsigned i = 0; i < palette->color_count; i++) {
+        sail_rgba32_t rgba32;
+        SAIL_TRY(get_palette_rgba32(palette, i, &rgba32));
+
+        analysis->opaque    = analysis->opaque && rgba32.component4 == 255;
+        analysis->grayscale = analysis->grayscale && rgba32.component1 == rgba32.component2 && rgba32.component1 == rgba32.component3;
+
+        add_color(color_set, (uint64_t)rgba32.component1
+                                | ((uint64_t)rgba32.component2 << 16)
+                                | ((uint64_t)rgba32.component3 << 32)
+                                | ((uint64_t)rgba32.component4 << 48));
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Returns true if the image converted from the input pixel format to the candidate one
+ * keeps all its information according to the analysis.
+ */
+static bool is_lossless(enum SailPixelFormat input_pixel_format, enum SailPixelFormat candidate, const struct sail_image_analysis *analysis) {
+
+    if (candidate == input_pixel_format) {
+        return true;
+    }
+
+    /* Indexed pixel formats are produced with sail_quantize_image(), which drops alpha. */
+    if (sail_is_indexed(candidate)) {
+        unsigned bits_per_pixel;
+
+        if (sail_bits_per_pixel(candidate, &bits_per_pixel) != SAIL_OK) {
+            return false;
+        }
+
+        return sail_can_convert(input_pixel_format, SAIL_PIXEL_FORMAT_BPP24_RGB)
+                && analysis->opaque
+                && analysis->fits_8_bits
+                && analysis->color_count > 0
+                && analysis->color_count <= (1u << bits_per_pixel);
+    }
+
+    struct analysis_layout layout;
+
+    if (!sail_can_convert(input_pixel_format, candidate) || !analysis_layout(candidate, &layout)) {
+        return false;
+    }
+
+    const bool fits = layout.bytes_per_sample == 2 || analysis->fits_8_bits;
+
+    /* Gray candidates. */
+    if (layout.r == layout.g) {
+        return analysis->grayscale && analysis->opaque && fits;
+    }
+
+    /* Candidates with no alpha or an X channel. */
+    if (layout.a < 0) {
+        return analysis->opaque && fits;
+    }
+
+    /* Premultiplying and unpremultiplying translucent pixels loses precision. */
+    if (sail_is_premultiplied(input_pixel_format) != sail_is_premultiplied(candidate)) {
+        return analysis->opaque && fits;
+    }
+
+    return fits;
+}
+
+/*
+ * Public functions.
+ */
+
+bool sail_can_analyze(enum SailPixelFormat pixel_format) {
+
+    struct analysis_layout layout;
+
+    return sail_is_indexed(pixel_format) || analysis_layout(pixel_format, &layout);
+}
+
+sail_status_t sail_analyze_image(const struct sail_image *image, struct sail_image_analysis *analysis) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_PTR(analysis);
+
+    struct analysis_layout layout;
+    const bool indexed = sail_is_indexed(image->pixel_format);
+
+    if (!indexed && !analysis_layout(image->pixel_format, &layout)) {
+        SAIL_LOG_ERROR("Analyzing %s images is not currently supported", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(1, sizeof(struct color_set), &ptr));
+    struct color_set *color_set = ptr;
+
+    analysis->opaque      = true;
+    analysis->grayscale   = true;
+    analysis->fits_8_bits = true;
+
+    if (indexed) {
+        SAIL_TRY_OR_CLEANUP(analyze_palette(image->palette, analysis, color_set),
+                            /* cleanup */ sail_free(color_set));
+    } else {
+
+        for (unsigned row = 0; row < image->height; row++) {
+            const void *scan = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+            if (layout.bytes_per_sample == 1) {
+                analyze_row8(scan, image->width, &layout, analysis, color_set);
+            } else {
+                analyze_row16(scan, image->width, &layout, analysis, color_set);
+            }
+
+            /* Nothing else to learn. */
+            if (!analysis->opaque && !analysis->grayscale && !analysis->fits_8_bits && color_set->overflow) {
+                break;
+            }
+        }
+    }
+
+    analysis->color_count = color_set->overflow ? 0 : color_set->count;
+
+    sail_free(color_set);
+
+    return SAIL_OK;
+}
+
+enum SailPixelFormat sail_narrowest_lossless_pixel_format(enum SailPixelFormat input_pixel_format,
+                                                          const struct sail_image_analysis *analysis,
+                                                          const enum SailPixelFormat pixel_formats[],
+                                                          size_t pixel_formats_length) {
+
+    enum SailPixelFormat best_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+    unsigned best_bits_per_pixel = 0;
+
+    for (size_t i = 0; i < pixel_formats_length; i++) {
+        unsigned bits_per_pixel;
+
+        if (!is_lossless(input_pixel_format, pixel_formats[i], analysis)
+                || sail_bits_per_pixel(pixel_formats[i], &bits_per_pixel) != SAIL_OK) {
+            continue;
+        }
+
+        /* On ties, prefer the input pixel format to avoid conversion. */
+        if (best_pixel_format == SAIL_PIXEL_FORMAT_UNKNOWN
+                || bits_per_pixel < best_bits_per_pixel
+                || (bits_per_pixel == best_bits_per_pixel && pixel_formats[i] == input_pixel_format)) {
+            best_pixel_format = pixel_formats[i];
+            best_bits_per_pixel = bits_per_pixel;
+        }
+    }
+
+    return best_pixel_format;
+}
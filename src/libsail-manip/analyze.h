@@ -0,0 +1,126 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_ANALYZE_H
+#define SAIL_ANALYZE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef SAIL_BUILD
+    #include "common.h"
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/common.h>
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_image;
+
+/*
+ * Maximum number of distinct colors sail_analyze_image() counts.
+ */
+#define SAIL_ANALYSIS_MAX_COLORS 256
+
+/*
+ * Image content properties computed by sail_analyze_image().
+ */
+struct sail_image_analysis {
+
+    /*
+     * True if every pixel has the maximum alpha or the pixel format has no alpha.
+     */
+    bool opaque;
+
+    /*
+     * True if the red, green, and blue components are equal in every pixel.
+     */
+    bool grayscale;
+
+    /*
+     * True if every 16-bit component is an 8-bit value multiplied by 257, so narrowing
+     * to 8 bits is lossless. Always true for 8-bit pixel formats.
+     */
+    bool fits_8_bits;
+
+    /*
+     * Number of distinct pixel values if there are no more than SAIL_ANALYSIS_MAX_COLORS
+     * of them, 0 otherwise. Alpha counts.
+     */
+    unsigned color_count;
+};
+
+typedef struct sail_image_analysis sail_image_analysis_t;
+
+/*
+ * Returns true if sail_analyze_image() supports the pixel format.
+ */
+SAIL_EXPORT bool sail_can_analyze(enum SailPixelFormat pixel_format);
+
+/*
+ * Computes the image content properties in one pass over the pixels. Stops early when
+ * nothing new can be learned. Indexed images are analyzed by their palettes.
+ *
+ * Allowed input pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA
+ *   - SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA
+ *   - 24, 32, 48, and 64-bit RGB, RGBX, and RGBA pixel formats in any channel order,
+ *     including premultiplied ones
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_analyze_image(const struct sail_image *image, struct sail_image_analysis *analysis);
+
+/*
+ * Returns the narrowest pixel format from the list the image can be converted to without losing
+ * information according to the analysis. Indexed pixel formats are returned only for opaque images
+ * that fit 8 bits and have few enough colors. Such images are converted with sail_quantize_image()
+ * which keeps their exact colors.
+ *
+ * Returns SAIL_PIXEL_FORMAT_UNKNOWN if no candidates found at all.
+ */
+SAIL_EXPORT enum SailPixelFormat sail_narrowest_lossless_pixel_format(enum SailPixelFormat input_pixel_format,
+                                                                      const struct sail_image_analysis *analysis,
+                                                                      const enum SailPixelFormat pixel_formats[],
+                                                                      size_t pixel_formats_length);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
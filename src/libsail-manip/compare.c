@@ -0,0 +1,529 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+/*
+ * SSIM windows and constants for samples scaled to 16 bits: (0.01 * 65535)^2 and (0.03 * 65535)^2.
+ */
+#define SSIM_WINDOW 8
+#define SSIM_STEP 4
+#define SSIM_C1 (0.01 * 0.01 * 65535.0 * 65535.0)
+#define SSIM_C2 (0.03 * 0.03 * 65535.0 * 65535.0)
+
+/*
+ * Interleaved pixel layout of the pixel formats read directly. Gray pixel formats use the same
+ * offset for red, green, and blue. Other pixel formats are converted to BPP64_RGBA row by row.
+ */
+struct compare_layout {
+    unsigned channels;
+    unsigned bytes_per_sample;
+    unsigned r;
+    unsigned g;
+    unsigned b;
+    /* -1 if there is no alpha. */
+    int a;
+};
+
+static const struct compare_layout RGBA64_LAYOUT = { 4, 2, 0, 1, 2, 3 };
+
+static bool compare_layout(enum SailPixelFormat pixel_format, struct compare_layout *layout) {
+
+#define SAIL_SET_LAYOUT(channels_, bytes_per_sample_, r_, g_, b_, a_) \
+    do {                                                              \
+        *layout = (struct compare_layout){ channels_, bytes_per_sample_, r_, g_, b_, a_ }; \
+    } while (0)
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE:        SAIL_SET_LAYOUT(1, 1, 0, 0, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE:       SAIL_SET_LAYOUT(1, 2, 0, 0, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: SAIL_SET_LAYOUT(2, 1, 0, 0, 0,  1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: SAIL_SET_LAYOUT(2, 2, 0, 0, 0,  1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP24_RGB: SAIL_SET_LAYOUT(3, 1, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP24_BGR: SAIL_SET_LAYOUT(3, 1, 2, 1, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP48_RGB: SAIL_SET_LAYOUT(3, 2, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP48_BGR: SAIL_SET_LAYOUT(3, 2, 2, 1, 0, -1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX: SAIL_SET_LAYOUT(4, 1, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX: SAIL_SET_LAYOUT(4, 1, 2, 1, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB: SAIL_SET_LAYOUT(4, 1, 1, 2, 3, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR: SAIL_SET_LAYOUT(4, 1, 3, 2, 1, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_RGBX: SAIL_SET_LAYOUT(4, 2, 0, 1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_BGRX: SAIL_SET_LAYOUT(4, 2, 2, 1, 0, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_XRGB: SAIL_SET_LAYOUT(4, 2, 1, 2, 3, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_XBGR: SAIL_SET_LAYOUT(4, 2, 3, 2, 1, -1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: SAIL_SET_LAYOUT(4, 1, 0, 1, 2, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: SAIL_SET_LAYOUT(4, 1, 2, 1, 0, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB: SAIL_SET_LAYOUT(4, 1, 1, 2, 3, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR: SAIL_SET_LAYOUT(4, 1, 3, 2, 1, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA: SAIL_SET_LAYOUT(4, 2, 0, 1, 2, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA: SAIL_SET_LAYOUT(4, 2, 2, 1, 0, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB: SAIL_SET_LAYOUT(4, 2, 1, 2, 3, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR: SAIL_SET_LAYOUT(4, 2, 3, 2, 1, 0); return true;
+
+        default: {
+            return false;
+        }
+    }
+
+#undef SAIL_SET_LAYOUT
+}
+
+static bool has_alpha(enum SailPixelFormat pixel_format, const struct sail_palette *palette) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE_ALPHA:
+        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE_ALPHA:
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA:
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA:
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED:
+
+        case SAIL_PIXEL_FORMAT_BPP32_YUVA:
+        case SAIL_PIXEL_FORMAT_BPP40_YUVA:
+        case SAIL_PIXEL_FORMAT_BPP48_YUVA:
+        case SAIL_PIXEL_FORMAT_BPP64_YUVA:
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF:
+        case SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT: {
+            return true;
+        }
+
+        default: {
+            return sail_is_indexed(pixel_format) && palette != NULL && has_alpha(palette->pixel_format, NULL);
+        }
+    }
+}
+
+/*
+ * Rows of both images are read into common rows of 16-bit samples: gray or red, green, and blue,
+ * followed by alpha if it's compared.
+ */
+struct compare_source {
+    const struct sail_image *image;
+    struct compare_layout layout;
+
+    /* Converts rows to BPP64_RGBA if the pixel format cannot be read directly. */
+    struct sail_conversion_plan *plan;
+};
+
+struct compare_context {
+    struct compare_source sources[2];
+    struct sail_rectangle region;
+
+    bool gray;
+    bool alpha;
+    unsigned channels;
+
+    /* Squared errors and maximum differences of every region row. */
+    uint64_t *row_errors;
+    uint16_t *row_differences;
+
+    /* Luma planes of the region. */
+    uint16_t *luma[2];
+
+    unsigned ssim_window_width;
+    unsigned ssim_window_height;
+    unsigned ssim_columns;
+
+    /* Sums of the SSIM values in every row of windows. */
+    double *ssim_rows;
+};
+
+#define DEFINE_GATHER_ROW(name, type, scale)                                                        \
+static void name(const type *input, const struct compare_layout *layout, unsigned width,            \
+                 bool gray, bool alpha, uint16_t *output) {                                         \
+                                                                                                    \
+    const unsigned channels = layout->channels;                                                     \
+                                                                                                    \
+    for (unsigned column = 0; column < width; column++, input += channels) {                        \
+        if (gray) {                                                                                 \
+            *output++ = (uint16_t)(input[layout->r] * (scale));                                     \
+        } else {                                                                                    \
+            *output++ = (uint16_t)(input[layout->r] * (scale));                                     \
+            *output++ = (uint16_t)(input[layout->g] * (scale));                                     \
+            *output++ = (uint16_t)(input[layout->b] * (scale));                                     \
+        }                                                                                           \
+                                                                                                    \
+        if (alpha) {                                                                                \
+            *output++ = (layout->a < 0) ? 65535 : (uint16_t)(input[layout->a] * (scale));           \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+DEFINE_GATHER_ROW(gather_row8,  uint8_t,  257)
+DEFINE_GATHER_ROW(gather_row16, uint16_t, 1)
+
+/* Reads the region part of the row into the common row. 'rgba64' holds a converted image row. */
+static sail_status_t read_row(const struct compare_context *compare_context, const struct compare_source *source,
+                              unsigned row, uint16_t *rgba64, uint16_t *output) {
+
+    const struct sail_image *image = source->image;
+    const uint8_t *scan = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+    const struct compare_layout *layout = &source->layout;
+
+    if (source->plan != NULL) {
+        struct sail_image row_image;
+        memset(&row_image, 0, sizeof(row_image));
+        row_image.pixels         = (void *)scan;
+        row_image.width          = image->width;
+        row_image.height         = 1;
+        row_image.bytes_per_line = image->bytes_per_line;
+        row_image.pixel_format   = image->pixel_format;
+
+        struct sail_image rgba64_image;
+        memset(&rgba64_image, 0, sizeof(rgba64_image));
+        rgba64_image.pixels         = rgba64;
+        rgba64_image.width          = image->width;
+        rgba64_image.height         = 1;
+        rgba64_image.bytes_per_line = image->width * 8;
+        rgba64_image.pixel_format   = SAIL_PIXEL_FORMAT_BPP64_RGBA;
+
+        SAIL_TRY(sail_convert_image_with_plan(&row_image, source->plan, &rgba64_image));
+
+        scan = (const uint8_t *)rgba64;
+        layout = &RGBA64_LAYOUT;
+    }
+
+    const size_t offset = (size_t)compare_context->region.x * layout->channels * layout->bytes_per_sample;
+
+    if (layout->bytes_per_sample == 1) {
+        gather_row8(scan + offset, layout, compare_context->region.width, compare_context->gray, compare_context->alpha, output);
+    } else {
+        gather_row16((const uint16_t *)(scan + offset), layout, compare_context->region.width,
+                     compare_context->gray, compare_context->alpha, output);
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Branchless loops over the common rows, so compilers vectorize them.
+ */
+static void compare_rows(const uint16_t *row1, const uint16_t *row2, unsigned samples, uint64_t *error, uint16_t *difference) {
+
+    uint64_t sum = 0;
+    uint32_t max = 0;
+
+    for (unsigned s = 0; s < samples; s++) {
+        const int32_t d = (int32_t)row1[s] - (int32_t)row2[s];
+        const uint32_t abs_d = (uint32_t)((d < 0) ? -d : d);
+
+        sum += (uint64_t)abs_d * abs_d;
+        max = (abs_d > max) ? abs_d : max;
+    }
+
+    *error = sum;
+    *difference = (uint16_t)max;
+}
+
+static void luma_row(const uint16_t *row, unsigned width, bool gray, bool alpha, uint16_t *luma) {
+
+    if (gray) {
+        const unsigned step = alpha ? 2 : 1;
+
+        for (unsigned column = 0; column < width; column++) {
+            luma[column] = row[column * step];
+        }
+    } else {
+        const unsigned step = alpha ? 4 : 3;
+
+        for (unsigned column = 0; column < width; column++, row += step) {
+            luma[column] = (uint16_t)rgb_to_gray(row[0], row[1], row[2]);
+        }
+    }
+}
+
+static sail_status_t compare_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct compare_context *compare_context = context;
+    const unsigned width = compare_context->region.width;
+    const unsigned samples = width * compare_context->channels;
+
+    /* Two common rows and a converted row. */
+    const unsigned converted_width = (compare_context->sources[0].image->width > compare_context->sources[1].image->width)
+                                        ? compare_context->sources[0].image->width
+                                        : compare_context->sources[1].image->width;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(uint16_t) * ((size_t)samples * 2 + (size_t)converted_width * 4), &ptr));
+
+    uint16_t *rows_common[2] = { ptr, (uint16_t *)ptr + samples };
+    uint16_t *rgba64 = (uint16_t *)ptr + (size_t)samples * 2;
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        for (unsigned i = 0; i < 2; i++) {
+            SAIL_TRY_OR_CLEANUP(read_row(compare_context, &compare_context->sources[i], compare_context->region.y + row,
+                                         rgba64, rows_common[i]),
+                                /* cleanup */ sail_free(ptr));
+
+            luma_row(rows_common[i], width, compare_context->gray, compare_context->alpha,
+                     compare_context->luma[i] + (size_t)width * row);
+        }
+
+        compare_rows(rows_common[0], rows_common[1], samples,
+                     &compare_context->row_errors[row], &compare_context->row_differences[row]);
+    }
+
+    sail_free(ptr);
+
+    return SAIL_OK;
+}
+
+/*
+ * SSIM. Window sums are built from the column sums of every row of windows.
+ */
+static sail_status_t ssim_band(void *context, unsigned first_window_row, unsigned window_rows) {
+
+    const struct compare_context *compare_context = context;
+    const unsigned width = compare_context->region.width;
+    const unsigned window_width = compare_context->ssim_window_width;
+    const unsigned window_height = compare_context->ssim_window_height;
+    const double n = (double)window_width * window_height;
+
+    /* Sums of x, y, x^2, y^2, and xy of every column. */
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(uint64_t) * width * 5, &ptr));
+
+    uint64_t *sx  = ptr;
+    uint64_t *sy  = sx + width;
+    uint64_t *sxx = sy + width;
+    uint64_t *syy = sxx + width;
+    uint64_t *sxy = syy + width;
+
+    for (unsigned window_row = first_window_row; window_row < first_window_row + window_rows; window_row++) {
+        memset(ptr, 0, sizeof(uint64_t) * width * 5);
+
+        for (unsigned y = window_row * SSIM_STEP; y < window_row * SSIM_STEP + window_height; y++) {
+            const uint16_t *x_row = compare_context->luma[0] + (size_t)width * y;
+            const uint16_t *y_row = compare_context->luma[1] + (size_t)width * y;
+
+            for (unsigned column = 0; column < width; column++) {
+                const uint64_t x = x_row[column];
+                const uint64_t v = y_row[column];
+
+                sx[column]  += x;
+                sy[column]  += v;
+                sxx[column] += x * x;
+                syy[column] += v * v;
+                sxy[column] += x * v;
+            }
+        }
+
+        double ssim_sum = 0;
+
+        for (unsigned window_column = 0; window_column < compare_context->ssim_columns; window_column++) {
+            uint64_t wx = 0, wy = 0, wxx = 0, wyy = 0, wxy = 0;
+
+            for (unsigned column = window_column * SSIM_STEP; column < window_column * SSIM_STEP + window_width; column++) {
+                wx  += sx[column];
+                wy  += sy[column];
+                wxx += sxx[column];
+                wyy += syy[column];
+                wxy += sxy[column];
+            }
+
+            const double mean_x = wx / n;
+            const double mean_y = wy / n;
+            const double variance_x = wxx / n - mean_x * mean_x;
+            const double variance_y = wyy / n - mean_y * mean_y;
+            const double covariance = wxy / n - mean_x * mean_y;
+
+            ssim_sum += ((2 * mean_x * mean_y + SSIM_C1) * (2 * covariance + SSIM_C2))
+                        / ((mean_x * mean_x + mean_y * mean_y + SSIM_C1) * (variance_x + variance_y + SSIM_C2));
+        }
+
+        compare_context->ssim_rows[window_row] = ssim_sum;
+    }
+
+    sail_free(ptr);
+
+    return SAIL_OK;
+}
+
+static sail_status_t init_compare_source(const struct sail_image *image, struct compare_source *source) {
+
+    if (sail_is_planar(image->pixel_format)) {
+        SAIL_LOG_ERROR("Comparing planar %s images is not currently supported", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    source->image = image;
+    source->plan  = NULL;
+
+    if (!compare_layout(image->pixel_format, &source->layout)) {
+        SAIL_TRY(sail_alloc_conversion_plan(image->pixel_format, image->palette, SAIL_PIXEL_FORMAT_BPP64_RGBA,
+                                            NULL /* options */, &source->plan));
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t compare_impl(struct compare_context *compare_context, unsigned threads,
+                                  struct sail_image_comparison *comparison) {
+
+    const struct sail_rectangle *region = &compare_context->region;
+
+    compare_context->ssim_window_width  = (region->width < SSIM_WINDOW) ? region->width : SSIM_WINDOW;
+    compare_context->ssim_window_height = (region->height < SSIM_WINDOW) ? region->height : SSIM_WINDOW;
+    compare_context->ssim_columns       = (region->width - compare_context->ssim_window_width) / SSIM_STEP + 1;
+
+    const unsigned ssim_rows = (region->height - compare_context->ssim_window_height) / SSIM_STEP + 1;
+    const size_t pixels = (size_t)region->width * region->height;
+
+    /* Row errors, row differences, SSIM rows, and luma planes. */
+    void *ptr;
+    SAIL_TRY(sail_malloc((sizeof(uint64_t) + sizeof(uint16_t)) * region->height + sizeof(double) * ssim_rows
+                            + sizeof(uint16_t) * pixels * 2, &ptr));
+
+    compare_context->row_errors      = ptr;
+    compare_context->ssim_rows       = (double *)(compare_context->row_errors + region->height);
+    compare_context->row_differences = (uint16_t *)(compare_context->ssim_rows + ssim_rows);
+    compare_context->luma[0]         = compare_context->row_differences + region->height;
+    compare_context->luma[1]         = compare_context->luma[0] + pixels;
+
+    SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(region->height, (size_t)region->width * compare_context->channels * 2 * 2,
+                                                 threads, compare_band, compare_context),
+                        /* cleanup */ sail_free(ptr));
+
+    SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(ssim_rows, (size_t)region->width * 2 * 2 * SSIM_WINDOW,
+                                                 threads, ssim_band, compare_context),
+                        /* cleanup */ sail_free(ptr));
+
+    /* Reduced in a fixed order, so the results don't depend on the number of threads. */
+    uint64_t error = 0;
+    uint16_t difference = 0;
+
+    for (unsigned row = 0; row < region->height; row++) {
+        error += compare_context->row_errors[row];
+        difference = (compare_context->row_differences[row] > difference) ? compare_context->row_differences[row] : difference;
+    }
+
+    double ssim_sum = 0;
+
+    for (unsigned row = 0; row < ssim_rows; row++) {
+        ssim_sum += compare_context->ssim_rows[row];
+    }
+
+    sail_free(ptr);
+
+    comparison->mse            = (double)error / ((double)pixels * compare_context->channels * 65535.0 * 65535.0);
+    comparison->psnr           = (error == 0) ? INFINITY : 10 * log10(1 / comparison->mse);
+    comparison->ssim           = ssim_sum / ((double)ssim_rows * compare_context->ssim_columns);
+    comparison->max_difference = difference / 65535.0;
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_compare_images(const struct sail_image *image1,
+                                  const struct sail_image *image2,
+                                  struct sail_image_comparison *comparison) {
+
+    SAIL_TRY(sail_compare_images_with_options(image1, image2, NULL /* region */, NULL /* options */, comparison));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_compare_images_with_options(const struct sail_image *image1,
+                                               const struct sail_image *image2,
+                                               const struct sail_rectangle *region,
+                                               const struct sail_conversion_options *options,
+                                               struct sail_image_comparison *comparison) {
+
+    SAIL_TRY(sail_check_image_valid(image1));
+    SAIL_TRY(sail_check_image_valid(image2));
+    SAIL_CHECK_PTR(comparison);
+
+    if (image1->width != image2->width || image1->height != image2->height) {
+        SAIL_LOG_ERROR("Cannot compare %ux%u and %ux%u images", image1->width, image1->height, image2->width, image2->height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    struct compare_context compare_context;
+    memset(&compare_context, 0, sizeof(compare_context));
+
+    if (region == NULL) {
+        compare_context.region = (struct sail_rectangle){ 0, 0, image1->width, image1->height };
+    } else {
+        if (region->width == 0 || region->height == 0
+                || region->x >= image1->width || region->width > image1->width - region->x
+                || region->y >= image1->height || region->height > image1->height - region->y) {
+            SAIL_LOG_ERROR("Region %ux%u at (%u, %u) is outside of the %ux%u images",
+                            region->width, region->height, region->x, region->y, image1->width, image1->height);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+        }
+
+        compare_context.region = *region;
+    }
+
+    compare_context.gray     = sail_is_grayscale(image1->pixel_format) && sail_is_grayscale(image2->pixel_format);
+    compare_context.alpha    = has_alpha(image1->pixel_format, image1->palette) || has_alpha(image2->pixel_format, image2->palette);
+    compare_context.channels = (compare_context.gray ? 1 : 3) + (compare_context.alpha ? 1 : 0);
+
+    SAIL_TRY(init_compare_source(image1, &compare_context.sources[0]));
+    SAIL_TRY_OR_CLEANUP(init_compare_source(image2, &compare_context.sources[1]),
+                        /* cleanup */ sail_destroy_conversion_plan(compare_context.sources[0].plan));
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY_OR_CLEANUP(compare_impl(&compare_context, threads, comparison),
+                        /* cleanup */ sail_destroy_conversion_plan(compare_context.sources[1].plan),
+                                      sail_destroy_conversion_plan(compare_context.sources[0].plan));
+
+    sail_destroy_conversion_plan(compare_context.sources[1].plan);
+    sail_destroy_conversion_plan(compare_context.sources[0].plan);
+
+    return SAIL_OK;
+}
@@ -0,0 +1,117 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_COMPARE_H
+#define SAIL_COMPARE_H
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_conversion_options;
+struct sail_image;
+struct sail_rectangle;
+
+/*
+ * Image quality metrics computed by sail_compare_images().
+ *
+ * Samples are scaled to [0; 1] before comparison, so images with different bit depths
+ * can be compared. Gray images are compared by their gray channel. All other images are
+ * compared by their red, green, and blue channels. The alpha channel is also compared
+ * if any of the images has one.
+ */
+struct sail_image_comparison {
+
+    /*
+     * Mean squared error of the samples. 0 if the images are identical.
+     */
+    double mse;
+
+    /*
+     * Peak signal-to-noise ratio in decibels: 10 * log10(1 / mse). INFINITY if the images
+     * are identical. Values above 40 usually mean visually lossless.
+     */
+    double psnr;
+
+    /*
+     * Mean structural similarity of the luma in the range [-1; 1]. 1 if the images are identical.
+     * Computed over 8x8 windows with a step of 4 pixels. Smaller images use one window.
+     */
+    double ssim;
+
+    /*
+     * Maximum absolute difference of the samples. For example, 1/255 means that 8-bit images
+     * differ by at most 1 in every sample.
+     */
+    double max_difference;
+};
+
+typedef struct sail_image_comparison sail_image_comparison_t;
+
+/*
+ * Compares the images and saves their quality metrics in the comparison. The images must have
+ * the same dimensions but may have different pixel formats. Rows are converted to a common
+ * representation on the fly without converting the whole images.
+ *
+ * Allowed pixel formats: anything sail_can_convert() can convert to SAIL_PIXEL_FORMAT_BPP64_RGBA
+ * except planar pixel formats.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_compare_images(const struct sail_image *image1,
+                                              const struct sail_image *image2,
+                                              struct sail_image_comparison *comparison);
+
+/*
+ * Compares the region of the images and saves their quality metrics in the comparison.
+ * The region (which may be NULL to compare the whole images) must be inside the images.
+ *
+ * Options (which may be NULL) control the number of threads to compare the images with.
+ * Other options are ignored.
+ *
+ * See sail_compare_images() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_compare_images_with_options(const struct sail_image *image1,
+                                                           const struct sail_image *image2,
+                                                           const struct sail_rectangle *region,
+                                                           const struct sail_conversion_options *options,
+                                                           struct sail_image_comparison *comparison);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,382 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+/*
+ * Interleaved pixel layout.
+ */
+struct composite_layout {
+    unsigned channels;
+    unsigned bytes_per_sample;
+    /* -1 if there is no alpha. */
+    int a;
+};
+
+static bool composite_layout(enum SailPixelFormat pixel_format, struct composite_layout *layout) {
+
+#define SAIL_SET_LAYOUT(channels_, bytes_per_sample_, a_) \
+    do {                                                  \
+        layout->channels         = channels_;             \
+        layout->bytes_per_sample = bytes_per_sample_;     \
+        layout->a                = a_;                    \
+    } while (0)
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE:        SAIL_SET_LAYOUT(1, 1, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE:       SAIL_SET_LAYOUT(1, 2, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: SAIL_SET_LAYOUT(2, 1,  1); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: SAIL_SET_LAYOUT(2, 2,  1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:
+        case SAIL_PIXEL_FORMAT_BPP24_BGR: SAIL_SET_LAYOUT(3, 1, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP48_RGB:
+        case SAIL_PIXEL_FORMAT_BPP48_BGR: SAIL_SET_LAYOUT(3, 2, -1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR: SAIL_SET_LAYOUT(4, 1, -1); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP64_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP64_XBGR: SAIL_SET_LAYOUT(4, 2, -1); return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 1, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 1, 0); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 2, 3); return true;
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: SAIL_SET_LAYOUT(4, 2, 0); return true;
+
+        default: {
+            return false;
+        }
+    }
+
+#undef SAIL_SET_LAYOUT
+}
+
+/*
+ * Generic row compositing used when there is no kernel. Opacity is in [0; max].
+ */
+typedef void (*composite_generic_row_t)(const void *src, void *dst, unsigned width, const struct composite_layout *layout, unsigned opacity);
+
+/*
+ * Straight alpha. The source and destination colors are weighted by their contributions
+ * to the output alpha, so the result matches premultiplied compositing.
+ */
+#define DEFINE_STRAIGHT_ROW(name, type, max, wide_type, div_max_round)                                                \
+static void name(const void *src_raw, void *dst_raw, unsigned width, const struct composite_layout *layout,          \
+                 unsigned opacity, bool over) {                                                                       \
+                                                                                                                      \
+    const type *src = src_raw;                                                                                        \
+    type *dst = dst_raw;                                                                                              \
+    const unsigned channels = layout->channels;                                                                       \
+    const unsigned a = (unsigned)layout->a;                                                                           \
+                                                                                                                      \
+    for (unsigned pixel = 0; pixel < width; pixel++, src += channels, dst += channels) {                             \
+        uint32_t src_weight;                                                                                          \
+        uint32_t dst_weight;                                                                                          \
+                                                                                                                      \
+        if (over) {                                                                                                   \
+            const uint32_t src_alpha = div_max_round((uint32_t)src[a] * opacity);                                     \
+            src_weight = src_alpha * (max);                                                                           \
+            dst_weight = (uint32_t)dst[a] * ((max) - src_alpha);                                                      \
+        } else {                                                                                                      \
+            src_weight = (uint32_t)src[a] * opacity;                                                                  \
+            dst_weight = (uint32_t)dst[a] * ((max) - opacity);                                                        \
+        }                                                                                                             \
+                                                                                                                      \
+        const uint32_t weight = src_weight + dst_weight;                                                              \
+                                                                                                                      \
+        if (weight == 0) {                                                                                            \
+            memset(dst, 0, sizeof(type) * channels);                                                                  \
+            continue;                                                                                                 \
+        }                                                                                                             \
+                                                                                                                      \
+        for (unsigned c = 0; c < channels; c++) {                                                                     \
+            if (c != a) {                                                                                             \
+                dst[c] = (type)(((wide_type)src[c] * src_weight + (wide_type)dst[c] * dst_weight + weight / 2) / weight); \
+            }                                                                                                         \
+        }                                                                                                             \
+                                                                                                                      \
+        dst[a] = (type)div_max_round(weight);                                                                         \
+    }                                                                                                                 \
+}
+
+DEFINE_STRAIGHT_ROW(straight8_row,  uint8_t,  255,   uint32_t, div255_round)
+DEFINE_STRAIGHT_ROW(straight16_row, uint16_t, 65535, uint64_t, div65535_round)
+
+static void straight8_source_row(const void *src, void *dst, unsigned width, const struct composite_layout *layout, unsigned opacity) {
+    straight8_row(src, dst, width, layout, opacity, false);
+}
+
+static void straight8_over_row(const void *src, void *dst, unsigned width, const struct composite_layout *layout, unsigned opacity) {
+    straight8_row(src, dst, width, layout, opacity, true);
+}
+
+static void straight16_source_row(const void *src, void *dst, unsigned width, const struct composite_layout *layout, unsigned opacity) {
+    straight16_row(src, dst, width, layout, opacity, false);
+}
+
+static void straight16_over_row(const void *src, void *dst, unsigned width, const struct composite_layout *layout, unsigned opacity) {
+    straight16_row(src, dst, width, layout, opacity, true);
+}
+
+/* 16-bit counterpart of COMPOSITE_KERNEL_LERP8. */
+static void lerp16_row(const void *src_raw, void *dst_raw, unsigned width, const struct composite_layout *layout, unsigned opacity) {
+
+    const uint16_t *src = src_raw;
+    uint16_t *dst = dst_raw;
+    const unsigned count = width * layout->channels;
+    const uint32_t inverse = 65535 - opacity;
+
+    for (unsigned i = 0; i < count; i++) {
+        dst[i] = (uint16_t)div65535_round(src[i] * opacity + dst[i] * inverse);
+    }
+}
+
+/* 16-bit counterpart of COMPOSITE_KERNEL_OVER8_ALPHA_FIRST and COMPOSITE_KERNEL_OVER8_ALPHA_LAST. */
+static void over16_premultiplied_row(const void *src_raw, void *dst_raw, unsigned width, const struct composite_layout *layout, unsigned opacity) {
+
+    const uint16_t *src = src_raw;
+    uint16_t *dst = dst_raw;
+    const unsigned a = (unsigned)layout->a;
+
+    for (unsigned pixel = 0; pixel < width; pixel++, src += 4, dst += 4) {
+        const uint32_t inverse = 65535 - div65535_round(src[a] * opacity);
+
+        for (unsigned c = 0; c < 4; c++) {
+            const uint32_t value = div65535_round(src[c] * opacity) + div65535_round(dst[c] * inverse);
+            dst[c] = (uint16_t)(value > 65535 ? 65535 : value);
+        }
+    }
+}
+
+/*
+ * Compositing context shared by all threads.
+ */
+struct composite_context {
+    const uint8_t *src;
+    unsigned src_bytes_per_line;
+
+    uint8_t *dst;
+    unsigned dst_bytes_per_line;
+
+    unsigned width;
+    size_t bytes_per_row;
+
+    struct composite_layout layout;
+    unsigned opacity;
+
+    /* Exactly one of them is set. NULL both mean copying. */
+    composite_row_t kernel;
+    unsigned kernel_count;
+    composite_generic_row_t generic_row;
+};
+
+static sail_status_t composite_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct composite_context *composite_context = context;
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *src = composite_context->src + (size_t)composite_context->src_bytes_per_line * row;
+        uint8_t *dst = composite_context->dst + (size_t)composite_context->dst_bytes_per_line * row;
+
+        if (composite_context->kernel != NULL) {
+            composite_context->kernel(src, dst, composite_context->kernel_count, composite_context->opacity);
+        } else if (composite_context->generic_row != NULL) {
+            composite_context->generic_row(src, dst, composite_context->width, &composite_context->layout, composite_context->opacity);
+        } else {
+            memmove(dst, src, composite_context->bytes_per_row);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/* Selects the row function. Opacity is in [0; 255] or [0; 65535]. */
+static sail_status_t select_rows(enum SailPixelFormat pixel_format, enum SailComposite composite, struct composite_context *composite_context) {
+
+    struct composite_layout *layout = &composite_context->layout;
+
+    if (!composite_layout(pixel_format, layout)) {
+        SAIL_LOG_ERROR("Compositing %s images is not currently supported", sail_pixel_format_to_string(pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const bool premultiplied = sail_is_premultiplied(pixel_format);
+    const bool lerp = layout->a < 0 || (premultiplied && composite == SAIL_COMPOSITE_SOURCE);
+
+    if (layout->bytes_per_sample == 1) {
+        if (lerp) {
+            composite_context->kernel       = find_composite_kernel(COMPOSITE_KERNEL_LERP8);
+            composite_context->kernel_count = composite_context->width * layout->channels;
+        } else if (premultiplied) {
+            composite_context->kernel       = find_composite_kernel(layout->a == 0 ? COMPOSITE_KERNEL_OVER8_ALPHA_FIRST : COMPOSITE_KERNEL_OVER8_ALPHA_LAST);
+            composite_context->kernel_count = composite_context->width;
+        } else {
+            composite_context->generic_row = (composite == SAIL_COMPOSITE_OVER) ? straight8_over_row : straight8_source_row;
+        }
+    } else {
+        if (lerp) {
+            composite_context->generic_row = lerp16_row;
+        } else if (premultiplied) {
+            composite_context->generic_row = over16_premultiplied_row;
+        } else {
+            composite_context->generic_row = (composite == SAIL_COMPOSITE_OVER) ? straight16_over_row : straight16_source_row;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_composite_image(struct sail_image *destination,
+                                   const struct sail_image *source,
+                                   int x, int y,
+                                   enum SailComposite composite,
+                                   double opacity) {
+
+    SAIL_TRY(sail_composite_image_with_options(destination, source, x, y, composite, opacity, NULL /* clip */, NULL /* options */));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_composite_image_with_options(struct sail_image *destination,
+                                                const struct sail_image *source,
+                                                int x, int y,
+                                                enum SailComposite composite,
+                                                double opacity,
+                                                const struct sail_rectangle *clip,
+                                                const struct sail_conversion_options *options) {
+
+    SAIL_TRY(sail_check_image_valid(destination));
+    SAIL_TRY(sail_check_image_valid(source));
+
+    if (source->pixel_format != destination->pixel_format) {
+        SAIL_LOG_ERROR("Source and destination pixel formats must match, but %s and %s are given",
+                        sail_pixel_format_to_string(source->pixel_format), sail_pixel_format_to_string(destination->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    if (composite != SAIL_COMPOSITE_SOURCE && composite != SAIL_COMPOSITE_OVER) {
+        SAIL_LOG_ERROR("Unknown composite operator %d", composite);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (!(opacity >= 0 && opacity <= 1)) {
+        SAIL_LOG_ERROR("Opacity must be in [0; 1], but %f is given", opacity);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (sail_is_planar(destination->pixel_format)) {
+        SAIL_LOG_ERROR("Planar pixel formats cannot be composited, but %s is given", sail_pixel_format_to_string(destination->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    unsigned bits_per_pixel;
+    SAIL_TRY(sail_bits_per_pixel(destination->pixel_format, &bits_per_pixel));
+
+    if (bits_per_pixel % 8 != 0) {
+        SAIL_LOG_ERROR("Compositing %s images is not currently supported", sail_pixel_format_to_string(destination->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    /* Intersect the destination, the clipping rectangle, and the placed source. */
+    int64_t left   = 0;
+    int64_t top    = 0;
+    int64_t right  = destination->width;
+    int64_t bottom = destination->height;
+
+    if (clip != NULL) {
+        left   = clip->x;
+        top    = clip->y;
+        right  = (int64_t)clip->x + clip->width  < right  ? (int64_t)clip->x + clip->width  : right;
+        bottom = (int64_t)clip->y + clip->height < bottom ? (int64_t)clip->y + clip->height : bottom;
+    }
+
+    left   = x > left ? x : left;
+    top    = y > top  ? y : top;
+    right  = (int64_t)x + source->width  < right  ? (int64_t)x + source->width  : right;
+    bottom = (int64_t)y + source->height < bottom ? (int64_t)y + source->height : bottom;
+
+    if (left >= right || top >= bottom) {
+        return SAIL_OK;
+    }
+
+    const unsigned bytes_per_pixel = bits_per_pixel / 8;
+
+    struct composite_context composite_context;
+    memset(&composite_context, 0, sizeof(composite_context));
+
+    composite_context.width         = (unsigned)(right - left);
+    composite_context.bytes_per_row = (size_t)composite_context.width * bytes_per_pixel;
+
+    /* Opacity 1 with SAIL_COMPOSITE_SOURCE is a plain copy supported for any pixel format. */
+    if (composite != SAIL_COMPOSITE_SOURCE || opacity < 1) {
+        SAIL_TRY(select_rows(destination->pixel_format, composite, &composite_context));
+
+        composite_context.opacity = (unsigned)(opacity * (composite_context.layout.bytes_per_sample == 1 ? 255 : 65535) + 0.5);
+    }
+
+    SAIL_TRY(sail_make_image_writable(destination));
+
+    composite_context.src_bytes_per_line = source->bytes_per_line;
+    composite_context.dst_bytes_per_line = destination->bytes_per_line;
+    composite_context.src = (const uint8_t *)source->pixels
+                                + (size_t)source->bytes_per_line * (size_t)(top - y)
+                                + (size_t)(left - x) * bytes_per_pixel;
+    composite_context.dst = (uint8_t *)destination->pixels
+                                + (size_t)destination->bytes_per_line * (size_t)top
+                                + (size_t)left * bytes_per_pixel;
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY(process_rows_in_parallel((unsigned)(bottom - top), composite_context.bytes_per_row * 2, threads, composite_band, &composite_context));
+
+    return SAIL_OK;
+}
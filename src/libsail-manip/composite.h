@@ -0,0 +1,103 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_COMPOSITE_H
+#define SAIL_COMPOSITE_H
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+
+    #include "manip_common.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/manip_common.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_conversion_options;
+struct sail_image;
+
+/*
+ * Composites the source image onto the destination image in place. The top left source pixel
+ * is placed at (x, y) of the destination image. The coordinates may be negative. The source pixels
+ * outside of the destination image are ignored.
+ *
+ * The source and destination images must have the same pixel format. Convert the source image
+ * with sail_convert_image() first if necessary.
+ *
+ * Opacity in [0; 1] is multiplied by the source alpha. SAIL_COMPOSITE_SOURCE interpolates
+ * between the destination and source pixels with it, so opacity 1 replaces the destination pixels.
+ * Straight alpha is composited as if it was premultiplied.
+ *
+ * Allowed pixel formats:
+ *   - SAIL_COMPOSITE_SOURCE with opacity 1: any pixel format with whole bytes per pixel
+ *     except planar ones
+ *   - BPP16_GRAYSCALE_ALPHA, BPP32_GRAYSCALE_ALPHA
+ *   - 32 and 64-bit RGBA pixel formats in any channel order including premultiplied ones
+ *   - 8 and 16-bit grayscale, 24 and 48-bit RGB, and 32 and 64-bit RGBX pixel formats
+ *     in any channel order. They're treated as opaque.
+ *
+ * 8-bit premultiplied and opaque pixel formats are composited with SIMD kernels when the CPU
+ * supports them.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_composite_image(struct sail_image *destination,
+                                               const struct sail_image *source,
+                                               int x, int y,
+                                               enum SailComposite composite,
+                                               double opacity);
+
+/*
+ * Composites the source image onto the destination image in place. Only the destination pixels
+ * inside the clipping rectangle (which may be NULL) are changed. For example, it could be
+ * the dirty rectangle of an animation frame.
+ *
+ * Options (which may be NULL) control the number of threads. Rows are composited in parallel bands.
+ *
+ * See sail_composite_image() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_composite_image_with_options(struct sail_image *destination,
+                                                            const struct sail_image *source,
+                                                            int x, int y,
+                                                            enum SailComposite composite,
+                                                            double opacity,
+                                                            const struct sail_rectangle *clip,
+                                                            const struct sail_conversion_options *options);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+static void lerp8_row(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {
+
+    const unsigned inverse = 255 - opacity;
+
+    for (unsigned i = 0; i < count; i++) {
+        dst[i] = (uint8_t)div255_round(src[i] * opacity + dst[i] * inverse);
+    }
+}
+
+static inline void over8_row(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity, unsigned a) {
+
+    for (unsigned pixel = 0; pixel < count; pixel++, src += 4, dst += 4) {
+        const unsigned inverse = 255 - div255_round(src[a] * opacity);
+
+        for (unsigned c = 0; c < 4; c++) {
+            const uint32_t value = div255_round(src[c] * opacity) + div255_round(dst[c] * inverse);
+            dst[c] = (uint8_t)(value > 255 ? 255 : value);
+        }
+    }
+}
+
+static void over8_alpha_first_row(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {
+
+    over8_row(src, dst, count, opacity, 0);
+}
+
+static void over8_alpha_last_row(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {
+
+    over8_row(src, dst, count, opacity, 3);
+}
+
+composite_row_t find_composite_kernel_for_cpu(enum CompositeKernel kernel, int cpu_features) {
+
+#ifdef SAIL_MANIP_X86_KERNELS
+    const composite_row_t x86_kernel = x86_composite_kernel(kernel, cpu_features);
+
+    if (x86_kernel != NULL) {
+        return x86_kernel;
+    }
+#else
+    (void)cpu_features;
+#endif
+
+    switch (kernel) {
+        case COMPOSITE_KERNEL_LERP8:              return lerp8_row;
+        case COMPOSITE_KERNEL_OVER8_ALPHA_FIRST:  return over8_alpha_first_row;
+        case COMPOSITE_KERNEL_OVER8_ALPHA_LAST:   return over8_alpha_last_row;
+    }
+
+    return NULL;
+}
+
+composite_row_t find_composite_kernel(enum CompositeKernel kernel) {
+
+    return find_composite_kernel_for_cpu(kernel, detected_cpu_features());
+}
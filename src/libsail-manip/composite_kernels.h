@@ -0,0 +1,83 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_COMPOSITE_KERNELS_H
+#define SAIL_COMPOSITE_KERNELS_H
+
+#include <stdint.h>
+
+#ifdef SAIL_BUILD
+    #include "export.h"
+
+    #include "cpu_features.h"
+#else
+    #include <sail-common/export.h>
+
+    #include <sail-manip/cpu_features.h>
+#endif
+
+/*
+ * Row kernels for 8-bit samples. Opacity is in [0; 255].
+ */
+enum CompositeKernel {
+
+    /*
+     * dst = round((src * opacity + dst * (255 - opacity)) / 255) for every byte.
+     * Composites opaque pixels and premultiplied pixels with SAIL_COMPOSITE_SOURCE.
+     * 'count' is the number of bytes.
+     */
+    COMPOSITE_KERNEL_LERP8,
+
+    /*
+     * Premultiplied SAIL_COMPOSITE_OVER of 4-byte pixels with alpha first or last:
+     *   src' = round(src * opacity / 255)
+     *   dst  = min(src' + round(dst * (255 - alpha') / 255), 255)
+     * 'count' is the number of pixels.
+     */
+    COMPOSITE_KERNEL_OVER8_ALPHA_FIRST,
+    COMPOSITE_KERNEL_OVER8_ALPHA_LAST,
+};
+
+typedef void (*composite_row_t)(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity);
+
+#ifdef SAIL_MANIP_X86_KERNELS
+/*
+ * Returns a SIMD kernel runnable with the Or-ed SailCpuFeature-s or NULL.
+ */
+SAIL_HIDDEN composite_row_t x86_composite_kernel(enum CompositeKernel kernel, int cpu_features);
+#endif
+
+/*
+ * Returns the fastest kernel runnable with the specified Or-ed SailCpuFeature-s.
+ * Passing 0 returns the portable kernel. SIMD kernels produce bit-exact results.
+ */
+SAIL_HIDDEN composite_row_t find_composite_kernel_for_cpu(enum CompositeKernel kernel, int cpu_features);
+
+/*
+ * Returns the fastest kernel for the current CPU.
+ */
+SAIL_HIDDEN composite_row_t find_composite_kernel(enum CompositeKernel kernel);
+
+#endif
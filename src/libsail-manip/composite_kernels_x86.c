@@ -0,0 +1,248 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+#ifdef SAIL_MANIP_X86_KERNELS
+
+#include <immintrin.h>
+
+/*
+ * SSE2 and AVX2 composite kernels. Samples are widened to 16-bit lanes, so every product
+ * fits a lane and the rounded division by 255 matches div255_round() of the portable kernels.
+ * Row tails are composited in zero-filled stack blocks just like in the conversion kernels.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define SAIL_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define SAIL_TARGET(isa)
+#endif
+
+SAIL_TARGET("sse2")
+static inline __m128i div255_round_sse2(__m128i value) {
+
+    value = _mm_add_epi16(value, _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+
+SAIL_TARGET("avx2")
+static inline __m256i div255_round_avx2(__m256i value) {
+
+    value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+
+    return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+}
+
+/*
+ * Lerp.
+ */
+SAIL_TARGET("sse2")
+static inline __m128i lerp8_half_sse2(__m128i src, __m128i dst, __m128i opacity, __m128i inverse) {
+
+    return div255_round_sse2(_mm_add_epi16(_mm_mullo_epi16(src, opacity), _mm_mullo_epi16(dst, inverse)));
+}
+
+SAIL_TARGET("sse2")
+static inline void lerp8_block_sse2(const uint8_t *src, uint8_t *dst, __m128i opacity, __m128i inverse) {
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i s = _mm_loadu_si128((const __m128i *)src);
+    const __m128i d = _mm_loadu_si128((const __m128i *)dst);
+
+    const __m128i low  = lerp8_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), opacity, inverse);
+    const __m128i high = lerp8_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), opacity, inverse);
+
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(low, high));
+}
+
+SAIL_TARGET("sse2")
+static void lerp8_row_sse2(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {
+
+    const __m128i o = _mm_set1_epi16((short)opacity);
+    const __m128i inverse = _mm_set1_epi16((short)(255 - opacity));
+
+    unsigned i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        lerp8_block_sse2(src + i, dst + i, o, inverse);
+    }
+
+    if (i < count) {
+        uint8_t src_block[16] = { 0 };
+        uint8_t dst_block[16] = { 0 };
+
+        memcpy(src_block, src + i, count - i);
+        memcpy(dst_block, dst + i, count - i);
+        lerp8_block_sse2(src_block, dst_block, o, inverse);
+        memcpy(dst + i, dst_block, count - i);
+    }
+}
+
+SAIL_TARGET("avx2")
+static inline __m256i lerp8_half_avx2(__m256i src, __m256i dst, __m256i opacity, __m256i inverse) {
+
+    return div255_round_avx2(_mm256_add_epi16(_mm256_mullo_epi16(src, opacity), _mm256_mullo_epi16(dst, inverse)));
+}
+
+SAIL_TARGET("avx2")
+static void lerp8_row_avx2(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i o = _mm256_set1_epi16((short)opacity);
+    const __m256i inverse = _mm256_set1_epi16((short)(255 - opacity));
+
+    unsigned i = 0;
+
+    /* Unpacking and packing work within 128-bit lanes, so the byte order is kept. */
+    for (; i + 32 <= count; i += 32) {
+        const __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+
+        const __m256i low  = lerp8_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), o, inverse);
+        const __m256i high = lerp8_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), o, inverse);
+
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(low, high));
+    }
+
+    if (i < count) {
+        lerp8_row_sse2(src + i, dst + i, count - i, opacity);
+    }
+}
+
+/*
+ * Premultiplied over. The alpha of every pixel is broadcast to its 4 lanes with PSHUFLW/PSHUFHW.
+ * PACKUSWB saturates the sums just like the portable kernel clamps them.
+ */
+#define DEFINE_OVER8_KERNELS(name, alpha_shuffle)                                                         \
+SAIL_TARGET("sse2")                                                                                       \
+static inline __m128i name##_half_sse2(__m128i src, __m128i dst, __m128i opacity) {                       \
+                                                                                                          \
+    const __m128i src_scaled = div255_round_sse2(_mm_mullo_epi16(src, opacity));                          \
+    const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_scaled, alpha_shuffle), alpha_shuffle); \
+    const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);                                    \
+                                                                                                          \
+    return _mm_add_epi16(src_scaled, div255_round_sse2(_mm_mullo_epi16(dst, inverse)));                   \
+}                                                                                                         \
+                                                                                                          \
+SAIL_TARGET("sse2")                                                                                       \
+static inline void name##_block_sse2(const uint8_t *src, uint8_t *dst, __m128i opacity) {                 \
+                                                                                                          \
+    const __m128i zero = _mm_setzero_si128();                                                             \
+    const __m128i s = _mm_loadu_si128((const __m128i *)src);                                              \
+    const __m128i d = _mm_loadu_si128((const __m128i *)dst);                                              \
+                                                                                                          \
+    const __m128i low  = name##_half_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), opacity); \
+    const __m128i high = name##_half_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), opacity); \
+                                                                                                          \
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(low, high));                                        \
+}                                                                                                         \
+                                                                                                          \
+SAIL_TARGET("sse2")                                                                                       \
+static void name##_row_sse2(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {         \
+                                                                                                          \
+    const __m128i o = _mm_set1_epi16((short)opacity);                                                     \
+                                                                                                          \
+    unsigned pixel = 0;                                                                                   \
+                                                                                                          \
+    for (; pixel + 4 <= count; pixel += 4) {                                                              \
+        name##_block_sse2(src + pixel * 4, dst + pixel * 4, o);                                           \
+    }                                                                                                     \
+                                                                                                          \
+    if (pixel < count) {                                                                                  \
+        uint8_t src_block[16] = { 0 };                                                                    \
+        uint8_t dst_block[16] = { 0 };                                                                    \
+                                                                                                          \
+        memcpy(src_block, src + pixel * 4, (count - pixel) * 4);                                          \
+        memcpy(dst_block, dst + pixel * 4, (count - pixel) * 4);                                          \
+        name##_block_sse2(src_block, dst_block, o);                                                       \
+        memcpy(dst + pixel * 4, dst_block, (count - pixel) * 4);                                          \
+    }                                                                                                     \
+}                                                                                                         \
+                                                                                                          \
+SAIL_TARGET("avx2")                                                                                       \
+static inline __m256i name##_half_avx2(__m256i src, __m256i dst, __m256i opacity) {                       \
+                                                                                                          \
+    const __m256i src_scaled = div255_round_avx2(_mm256_mullo_epi16(src, opacity));                       \
+    const __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src_scaled, alpha_shuffle), alpha_shuffle); \
+    const __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);                              \
+                                                                                                          \
+    return _mm256_add_epi16(src_scaled, div255_round_avx2(_mm256_mullo_epi16(dst, inverse)));             \
+}                                                                                                         \
+                                                                                                          \
+SAIL_TARGET("avx2")                                                                                       \
+static void name##_row_avx2(const uint8_t *src, uint8_t *dst, unsigned count, unsigned opacity) {         \
+                                                                                                          \
+    const __m256i zero = _mm256_setzero_si256();                                                          \
+    const __m256i o = _mm256_set1_epi16((short)opacity);                                                  \
+                                                                                                          \
+    unsigned pixel = 0;                                                                                   \
+                                                                                                          \
+    for (; pixel + 8 <= count; pixel += 8) {                                                              \
+        const __m256i s = _mm256_loadu_si256((const __m256i *)(src + pixel * 4));                         \
+        const __m256i d = _mm256_loadu_si256((const __m256i *)(dst + pixel * 4));                         \
+                                                                                                          \
+        const __m256i low  = name##_half_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), o); \
+        const __m256i high = name##_half_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), o); \
+                                                                                                          \
+        _mm256_storeu_si256((__m256i *)(dst + pixel * 4), _mm256_packus_epi16(low, high));                \
+    }                                                                                                     \
+                                                                                                          \
+    if (pixel < count) {                                                                                  \
+        name##_row_sse2(src + pixel * 4, dst + pixel * 4, count - pixel, opacity);                        \
+    }                                                                                                     \
+}
+
+DEFINE_OVER8_KERNELS(over8_alpha_first, _MM_SHUFFLE(0, 0, 0, 0))
+DEFINE_OVER8_KERNELS(over8_alpha_last,  _MM_SHUFFLE(3, 3, 3, 3))
+
+composite_row_t x86_composite_kernel(enum CompositeKernel kernel, int cpu_features) {
+
+    const bool avx2 = (cpu_features & SAIL_CPU_FEATURE_AVX2) != 0;
+    const bool sse2 = (cpu_features & SAIL_CPU_FEATURE_SSE2) != 0;
+
+    switch (kernel) {
+        case COMPOSITE_KERNEL_LERP8: {
+            return avx2 ? lerp8_row_avx2 : (sse2 ? lerp8_row_sse2 : NULL);
+        }
+        case COMPOSITE_KERNEL_OVER8_ALPHA_FIRST: {
+            return avx2 ? over8_alpha_first_row_avx2 : (sse2 ? over8_alpha_first_row_sse2 : NULL);
+        }
+        case COMPOSITE_KERNEL_OVER8_ALPHA_LAST: {
+            return avx2 ? over8_alpha_last_row_avx2 : (sse2 ? over8_alpha_last_row_sse2 : NULL);
+        }
+    }
+
+    return NULL;
+}
+
+#endif
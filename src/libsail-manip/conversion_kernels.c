@@ -0,0 +1,568 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+/*
+ * Generic row loops. They are always called with constant channel indexes,
+ * so compilers fold them into straight swizzles.
+ */
+
+static inline void rgb24_to_rgb24_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                      int ri, int gi, int bi,
+                                      int ro, int go, int bo) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t r = src[ri];
+        const uint8_t g = src[gi];
+        const uint8_t b = src[bi];
+
+        dst[ro] = r;
+        dst[go] = g;
+        dst[bo] = b;
+
+        src += 3;
+        dst += 3;
+    }
+}
+
+static inline void rgb24_to_rgba32_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                       int ri, int gi, int bi,
+                                       int ro, int go, int bo, int ao) {
+
+    for (unsigned column = 0; column < width; column++) {
+        dst[ro] = src[ri];
+        dst[go] = src[gi];
+        dst[bo] = src[bi];
+        dst[ao] = 255;
+
+        src += 3;
+        dst += 4;
+    }
+}
+
+static inline void rgba32_to_rgb24_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                       int ri, int gi, int bi, int ai,
+                                       int ro, int go, int bo) {
+
+    (void)ai;
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t r = src[ri];
+        const uint8_t g = src[gi];
+        const uint8_t b = src[bi];
+
+        dst[ro] = r;
+        dst[go] = g;
+        dst[bo] = b;
+
+        src += 4;
+        dst += 3;
+    }
+}
+
+static inline void rgba32_to_rgba32_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                        int ri, int gi, int bi, int ai,
+                                        int ro, int go, int bo, int ao) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t r = src[ri];
+        const uint8_t g = src[gi];
+        const uint8_t b = src[bi];
+        const uint8_t a = ai >= 0 ? src[ai] : 255;
+
+        dst[ro] = r;
+        dst[go] = g;
+        dst[bo] = b;
+        dst[ao] = a;
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+/*
+ * Straight alpha -> premultiplied alpha and back. Channels are swizzled in the same pass.
+ */
+static inline void rgba32_to_rgba32_premultiplied_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                                      int ri, int gi, int bi, int ai,
+                                                      int ro, int go, int bo, int ao) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t a = src[ai];
+        const uint8_t r = premultiply8(src[ri], a);
+        const uint8_t g = premultiply8(src[gi], a);
+        const uint8_t b = premultiply8(src[bi], a);
+
+        dst[ro] = r;
+        dst[go] = g;
+        dst[bo] = b;
+        dst[ao] = a;
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+static inline void rgba32_premultiplied_to_rgba32_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                                      int ri, int gi, int bi, int ai,
+                                                      int ro, int go, int bo, int ao) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t a = src[ai];
+        const uint8_t r = unpremultiply8(src[ri], a);
+        const uint8_t g = unpremultiply8(src[gi], a);
+        const uint8_t b = unpremultiply8(src[bi], a);
+
+        dst[ro] = r;
+        dst[go] = g;
+        dst[bo] = b;
+        dst[ao] = a;
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+static inline void gray8_to_rgb24_row(const uint8_t *src, uint8_t *dst, unsigned width) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t value = *src++;
+
+        dst[0] = dst[1] = dst[2] = value;
+        dst += 3;
+    }
+}
+
+static inline void gray8_to_rgba32_row(const uint8_t *src, uint8_t *dst, unsigned width,
+                                       int ro, int go, int bo, int ao) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t value = *src++;
+
+        dst[ro] = dst[go] = dst[bo] = value;
+        dst[ao] = 255;
+        dst += 4;
+    }
+}
+
+/*
+ * 16-bit -> 8-bit narrowing. Integer division by 257 gives the same result
+ * as the (uint8_t)(value / 257.0) truncation used by the generic path.
+ */
+static inline void rgb48_to_rgb24_row(const uint16_t *src, uint8_t *dst, unsigned width,
+                                      int ri, int gi, int bi,
+                                      int ro, int go, int bo) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint16_t r = src[ri];
+        const uint16_t g = src[gi];
+        const uint16_t b = src[bi];
+
+        dst[ro] = (uint8_t)(r / 257);
+        dst[go] = (uint8_t)(g / 257);
+        dst[bo] = (uint8_t)(b / 257);
+
+        src += 3;
+        dst += 3;
+    }
+}
+
+static inline void rgba64_to_rgba32_row(const uint16_t *src, uint8_t *dst, unsigned width,
+                                        int ri, int gi, int bi, int ai,
+                                        int ro, int go, int bo, int ao) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint16_t r = src[ri];
+        const uint16_t g = src[gi];
+        const uint16_t b = src[bi];
+        const uint16_t a = ai >= 0 ? src[ai] : 65535;
+
+        dst[ro] = (uint8_t)(r / 257);
+        dst[go] = (uint8_t)(g / 257);
+        dst[bo] = (uint8_t)(b / 257);
+        dst[ao] = (uint8_t)(a / 257);
+
+        src += 4;
+        dst += 4;
+    }
+}
+
+/*
+ * Kernel instantiation. The extra macro level expands LAYOUT_* into separate arguments.
+ */
+#define DEFINE_KERNEL(name, loop, src_type, ...) DEFINE_KERNEL_EXPANDED(name, loop, src_type, __VA_ARGS__)
+#define DEFINE_KERNEL_EXPANDED(name, loop, src_type, ...)                          \
+static void name(const void *src, void *dst, unsigned width) {                     \
+    loop((const src_type *)src, (uint8_t *)dst, width, __VA_ARGS__);                \
+}
+
+DEFINE_KERNEL(convert_row_rgb24_to_bgr24, rgb24_to_rgb24_row, uint8_t, LAYOUT_RGB, LAYOUT_BGR)
+DEFINE_KERNEL(convert_row_bgr24_to_rgb24, rgb24_to_rgb24_row, uint8_t, LAYOUT_BGR, LAYOUT_RGB)
+
+DEFINE_KERNEL(convert_row_rgb24_to_rgba32, rgb24_to_rgba32_row, uint8_t, LAYOUT_RGB, LAYOUT_RGBA)
+DEFINE_KERNEL(convert_row_rgb24_to_bgra32, rgb24_to_rgba32_row, uint8_t, LAYOUT_RGB, LAYOUT_BGRA)
+DEFINE_KERNEL(convert_row_rgb24_to_argb32, rgb24_to_rgba32_row, uint8_t, LAYOUT_RGB, LAYOUT_ARGB)
+DEFINE_KERNEL(convert_row_rgb24_to_abgr32, rgb24_to_rgba32_row, uint8_t, LAYOUT_RGB, LAYOUT_ABGR)
+DEFINE_KERNEL(convert_row_bgr24_to_rgba32, rgb24_to_rgba32_row, uint8_t, LAYOUT_BGR, LAYOUT_RGBA)
+DEFINE_KERNEL(convert_row_bgr24_to_bgra32, rgb24_to_rgba32_row, uint8_t, LAYOUT_BGR, LAYOUT_BGRA)
+DEFINE_KERNEL(convert_row_bgr24_to_argb32, rgb24_to_rgba32_row, uint8_t, LAYOUT_BGR, LAYOUT_ARGB)
+DEFINE_KERNEL(convert_row_bgr24_to_abgr32, rgb24_to_rgba32_row, uint8_t, LAYOUT_BGR, LAYOUT_ABGR)
+
+#define DEFINE_RGBA32_TO_RGB24_KERNELS(input, layout)                                                    \
+DEFINE_KERNEL(convert_row_##input##_to_rgb24, rgba32_to_rgb24_row, uint8_t, layout, LAYOUT_RGB)         \
+DEFINE_KERNEL(convert_row_##input##_to_bgr24, rgba32_to_rgb24_row, uint8_t, layout, LAYOUT_BGR)
+
+DEFINE_RGBA32_TO_RGB24_KERNELS(rgbx32, LAYOUT_RGBX)
+DEFINE_RGBA32_TO_RGB24_KERNELS(bgrx32, LAYOUT_BGRX)
+DEFINE_RGBA32_TO_RGB24_KERNELS(xrgb32, LAYOUT_XRGB)
+DEFINE_RGBA32_TO_RGB24_KERNELS(xbgr32, LAYOUT_XBGR)
+DEFINE_RGBA32_TO_RGB24_KERNELS(rgba32, LAYOUT_RGBA)
+DEFINE_RGBA32_TO_RGB24_KERNELS(bgra32, LAYOUT_BGRA)
+DEFINE_RGBA32_TO_RGB24_KERNELS(argb32, LAYOUT_ARGB)
+DEFINE_RGBA32_TO_RGB24_KERNELS(abgr32, LAYOUT_ABGR)
+
+#define DEFINE_RGBA32_TO_RGBA32_KERNELS(input, layout)                                                    \
+DEFINE_KERNEL(convert_row_##input##_to_rgba32, rgba32_to_rgba32_row, uint8_t, layout, LAYOUT_RGBA)       \
+DEFINE_KERNEL(convert_row_##input##_to_bgra32, rgba32_to_rgba32_row, uint8_t, layout, LAYOUT_BGRA)       \
+DEFINE_KERNEL(convert_row_##input##_to_argb32, rgba32_to_rgba32_row, uint8_t, layout, LAYOUT_ARGB)       \
+DEFINE_KERNEL(convert_row_##input##_to_abgr32, rgba32_to_rgba32_row, uint8_t, layout, LAYOUT_ABGR)
+
+DEFINE_RGBA32_TO_RGBA32_KERNELS(rgbx32, LAYOUT_RGBX)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(bgrx32, LAYOUT_BGRX)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(xrgb32, LAYOUT_XRGB)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(xbgr32, LAYOUT_XBGR)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(rgba32, LAYOUT_RGBA)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(bgra32, LAYOUT_BGRA)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(argb32, LAYOUT_ARGB)
+DEFINE_RGBA32_TO_RGBA32_KERNELS(abgr32, LAYOUT_ABGR)
+
+#define DEFINE_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(input, layout)                                                                       \
+DEFINE_KERNEL(convert_row_##input##_to_rgba32_premultiplied, rgba32_to_rgba32_premultiplied_row, uint8_t, layout, LAYOUT_RGBA)           \
+DEFINE_KERNEL(convert_row_##input##_to_bgra32_premultiplied, rgba32_to_rgba32_premultiplied_row, uint8_t, layout, LAYOUT_BGRA)           \
+DEFINE_KERNEL(convert_row_##input##_to_argb32_premultiplied, rgba32_to_rgba32_premultiplied_row, uint8_t, layout, LAYOUT_ARGB)           \
+DEFINE_KERNEL(convert_row_##input##_to_abgr32_premultiplied, rgba32_to_rgba32_premultiplied_row, uint8_t, layout, LAYOUT_ABGR)
+
+DEFINE_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(rgba32, LAYOUT_RGBA)
+DEFINE_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(bgra32, LAYOUT_BGRA)
+DEFINE_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(argb32, LAYOUT_ARGB)
+DEFINE_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(abgr32, LAYOUT_ABGR)
+
+#define DEFINE_RGBA32_PREMULTIPLIED_TO_RGBA32_KERNELS(input, layout)                                                                       \
+DEFINE_KERNEL(convert_row_##input##_premultiplied_to_rgba32, rgba32_premultiplied_to_rgba32_row, uint8_t, layout, LAYOUT_RGBA)           \
+DEFINE_KERNEL(convert_row_##input##_premultiplied_to_bgra32, rgba32_premultiplied_to_rgba32_row, uint8_t, layout, LAYOUT_BGRA)           \
+DEFINE_KERNEL(convert_row_##input##_premultiplied_to_argb32, rgba32_premultiplied_to_rgba32_row, uint8_t, layout, LAYOUT_ARGB)           \
+DEFINE_KERNEL(convert_row_##input##_premultiplied_to_abgr32, rgba32_premultiplied_to_rgba32_row, uint8_t, layout, LAYOUT_ABGR)
+
+DEFINE_RGBA32_PREMULTIPLIED_TO_RGBA32_KERNELS(rgba32, LAYOUT_RGBA)
+DEFINE_RGBA32_PREMULTIPLIED_TO_RGBA32_KERNELS(bgra32, LAYOUT_BGRA)
+DEFINE_RGBA32_PREMULTIPLIED_TO_RGBA32_KERNELS(argb32, LAYOUT_ARGB)
+DEFINE_RGBA32_PREMULTIPLIED_TO_RGBA32_KERNELS(abgr32, LAYOUT_ABGR)
+
+static void convert_row_gray8_to_rgb24(const void *src, void *dst, unsigned width) {
+
+    gray8_to_rgb24_row(src, dst, width);
+}
+
+DEFINE_KERNEL(convert_row_gray8_to_rgba32, gray8_to_rgba32_row, uint8_t, LAYOUT_RGBA)
+DEFINE_KERNEL(convert_row_gray8_to_bgra32, gray8_to_rgba32_row, uint8_t, LAYOUT_BGRA)
+DEFINE_KERNEL(convert_row_gray8_to_argb32, gray8_to_rgba32_row, uint8_t, LAYOUT_ARGB)
+DEFINE_KERNEL(convert_row_gray8_to_abgr32, gray8_to_rgba32_row, uint8_t, LAYOUT_ABGR)
+
+static void convert_row_gray16_to_gray8(const void *src, void *dst, unsigned width) {
+
+    const uint16_t *scan_input = src;
+    uint8_t *scan_output = dst;
+
+    for (unsigned column = 0; column < width; column++) {
+        *scan_output++ = (uint8_t)(*scan_input++ / 257);
+    }
+}
+
+DEFINE_KERNEL(convert_row_rgb48_to_rgb24, rgb48_to_rgb24_row, uint16_t, LAYOUT_RGB, LAYOUT_RGB)
+DEFINE_KERNEL(convert_row_rgb48_to_bgr24, rgb48_to_rgb24_row, uint16_t, LAYOUT_RGB, LAYOUT_BGR)
+DEFINE_KERNEL(convert_row_bgr48_to_rgb24, rgb48_to_rgb24_row, uint16_t, LAYOUT_BGR, LAYOUT_RGB)
+DEFINE_KERNEL(convert_row_bgr48_to_bgr24, rgb48_to_rgb24_row, uint16_t, LAYOUT_BGR, LAYOUT_BGR)
+
+#define DEFINE_RGBA64_TO_RGBA32_KERNELS(input, layout)                                                    \
+DEFINE_KERNEL(convert_row_##input##_to_rgba32, rgba64_to_rgba32_row, uint16_t, layout, LAYOUT_RGBA)      \
+DEFINE_KERNEL(convert_row_##input##_to_bgra32, rgba64_to_rgba32_row, uint16_t, layout, LAYOUT_BGRA)      \
+DEFINE_KERNEL(convert_row_##input##_to_argb32, rgba64_to_rgba32_row, uint16_t, layout, LAYOUT_ARGB)      \
+DEFINE_KERNEL(convert_row_##input##_to_abgr32, rgba64_to_rgba32_row, uint16_t, layout, LAYOUT_ABGR)
+
+DEFINE_RGBA64_TO_RGBA32_KERNELS(rgba64, LAYOUT_RGBA)
+DEFINE_RGBA64_TO_RGBA32_KERNELS(bgra64, LAYOUT_BGRA)
+DEFINE_RGBA64_TO_RGBA32_KERNELS(argb64, LAYOUT_ARGB)
+DEFINE_RGBA64_TO_RGBA32_KERNELS(abgr64, LAYOUT_ABGR)
+
+/*
+ * Integer <-> floating point conversions. They don't reorder components, so the same loop
+ * converts gray, RGB, and RGBA rows. Results match the generic path that goes through
+ * 16-bit components.
+ */
+#define DEFINE_COMPONENT_KERNELS(name, src_type, dst_type, convert)                      \
+static inline void name##_row(const src_type *src, dst_type *dst, size_t count) {         \
+    for (size_t i = 0; i < count; i++) {                                                 \
+        dst[i] = convert(src[i]);                                                        \
+    }                                                                                    \
+}                                                                                        \
+static void convert_row_##name##_x1(const void *src, void *dst, unsigned width) {        \
+    name##_row(src, dst, width);                                                         \
+}                                                                                        \
+static void convert_row_##name##_x3(const void *src, void *dst, unsigned width) {        \
+    name##_row(src, dst, (size_t)width * 3);                                             \
+}                                                                                        \
+static void convert_row_##name##_x4(const void *src, void *dst, unsigned width) {        \
+    name##_row(src, dst, (size_t)width * 4);                                             \
+}
+
+static inline uint16_t uint8_to_half(uint8_t value) {
+
+    return float_to_half(uint8_to_float(value));
+}
+
+static inline uint16_t uint16_to_half(uint16_t value) {
+
+    return float_to_half(uint16_to_float(value));
+}
+
+static inline uint8_t half_to_uint8(uint16_t value) {
+
+    return float_to_uint8(half_to_float(value));
+}
+
+static inline uint16_t half_to_uint16(uint16_t value) {
+
+    return float_to_uint16(half_to_float(value));
+}
+
+DEFINE_COMPONENT_KERNELS(uint8_to_half,   uint8_t,  uint16_t, uint8_to_half)
+DEFINE_COMPONENT_KERNELS(uint8_to_float,  uint8_t,  float,    uint8_to_float)
+DEFINE_COMPONENT_KERNELS(uint16_to_half,  uint16_t, uint16_t, uint16_to_half)
+DEFINE_COMPONENT_KERNELS(uint16_to_float, uint16_t, float,    uint16_to_float)
+DEFINE_COMPONENT_KERNELS(half_to_uint8,   uint16_t, uint8_t,  half_to_uint8)
+DEFINE_COMPONENT_KERNELS(half_to_uint16,  uint16_t, uint16_t, half_to_uint16)
+DEFINE_COMPONENT_KERNELS(float_to_uint8,  float,    uint8_t,  float_to_uint8)
+DEFINE_COMPONENT_KERNELS(float_to_uint16, float,    uint16_t, float_to_uint16)
+DEFINE_COMPONENT_KERNELS(half_to_float,   uint16_t, float,    half_to_float)
+DEFINE_COMPONENT_KERNELS(float_to_half,   float,    uint16_t, float_to_half)
+
+/*
+ * Kernel registry.
+ */
+
+#define KERNEL(input, output, options, function) CONVERSION_KERNEL(input, output, options, 0, function)
+
+/* Dropping alpha is the only meaningful option when converting RGBA to RGB without blending. */
+#define KERNELS_RGBA32_TO_RGB24(input, function_prefix, options)                    \
+    KERNEL(input, BPP24_RGB, options, convert_row_##function_prefix##_to_rgb24),    \
+    KERNEL(input, BPP24_BGR, options, convert_row_##function_prefix##_to_bgr24)
+
+#define KERNELS_TO_RGBA32(input, function_prefix)                                          \
+    KERNEL(input, BPP32_RGBA, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_rgba32), \
+    KERNEL(input, BPP32_BGRA, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_bgra32), \
+    KERNEL(input, BPP32_ARGB, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_argb32), \
+    KERNEL(input, BPP32_ABGR, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_abgr32)
+
+#define KERNELS_TO_RGBA32_PREMULTIPLIED(input, function_prefix)                                                         \
+    KERNEL(input, BPP32_RGBA_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_rgba32_premultiplied), \
+    KERNEL(input, BPP32_BGRA_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_bgra32_premultiplied), \
+    KERNEL(input, BPP32_ARGB_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_argb32_premultiplied), \
+    KERNEL(input, BPP32_ABGR_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_abgr32_premultiplied)
+
+/*
+ * Opaque pixels and pixels premultiplied already need a plain swizzle
+ * to become premultiplied: multiplying by 255 doesn't change them.
+ */
+#define KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(input, function_prefix)                                 \
+    KERNEL(input, BPP32_RGBA_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_rgba32), \
+    KERNEL(input, BPP32_BGRA_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_bgra32), \
+    KERNEL(input, BPP32_ARGB_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_argb32), \
+    KERNEL(input, BPP32_ABGR_PREMULTIPLIED, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_abgr32)
+
+/* Gray, RGB, and RGBA pixel formats with the same component type. */
+#define UINT8_FORMATS  BPP8_GRAYSCALE,        BPP24_RGB,       BPP32_RGBA
+#define UINT16_FORMATS BPP16_GRAYSCALE,       BPP48_RGB,       BPP64_RGBA
+#define HALF_FORMATS   BPP16_GRAYSCALE_HALF,  BPP48_RGB_HALF,  BPP64_RGBA_HALF
+#define FLOAT_FORMATS  BPP32_GRAYSCALE_FLOAT, BPP96_RGB_FLOAT, BPP128_RGBA_FLOAT
+
+/* The extra macro level expands *_FORMATS into separate arguments. */
+#define KERNELS_COMPONENTS(input_formats, output_formats, function_prefix) \
+    KERNELS_COMPONENTS_EXPANDED(input_formats, output_formats, function_prefix)
+#define KERNELS_COMPONENTS_EXPANDED(input_gray, input_rgb, input_rgba, output_gray, output_rgb, output_rgba, function_prefix) \
+    KERNEL(input_gray, output_gray, ANY_ALPHA_OPTION, convert_row_##function_prefix##_x1),                                 \
+    KERNEL(input_rgb,  output_rgb,  ANY_ALPHA_OPTION, convert_row_##function_prefix##_x3),                                 \
+    KERNEL(input_rgba, output_rgba, ANY_ALPHA_OPTION, convert_row_##function_prefix##_x4)
+
+static const struct conversion_kernel CONVERSION_KERNELS[] = {
+
+    KERNEL(BPP24_RGB, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_rgb24_to_bgr24),
+    KERNEL(BPP24_BGR, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_bgr24_to_rgb24),
+
+    KERNELS_TO_RGBA32(BPP24_RGB, rgb24),
+    KERNELS_TO_RGBA32(BPP24_BGR, bgr24),
+
+    KERNELS_RGBA32_TO_RGB24(BPP32_RGBX, rgbx32, ANY_ALPHA_OPTION),
+    KERNELS_RGBA32_TO_RGB24(BPP32_BGRX, bgrx32, ANY_ALPHA_OPTION),
+    KERNELS_RGBA32_TO_RGB24(BPP32_XRGB, xrgb32, ANY_ALPHA_OPTION),
+    KERNELS_RGBA32_TO_RGB24(BPP32_XBGR, xbgr32, ANY_ALPHA_OPTION),
+    KERNELS_RGBA32_TO_RGB24(BPP32_RGBA, rgba32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    KERNELS_RGBA32_TO_RGB24(BPP32_BGRA, bgra32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    KERNELS_RGBA32_TO_RGB24(BPP32_ARGB, argb32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    KERNELS_RGBA32_TO_RGB24(BPP32_ABGR, abgr32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+
+    KERNELS_TO_RGBA32(BPP32_RGBX, rgbx32),
+    KERNELS_TO_RGBA32(BPP32_BGRX, bgrx32),
+    KERNELS_TO_RGBA32(BPP32_XRGB, xrgb32),
+    KERNELS_TO_RGBA32(BPP32_XBGR, xbgr32),
+    KERNELS_TO_RGBA32(BPP32_RGBA, rgba32),
+    KERNELS_TO_RGBA32(BPP32_BGRA, bgra32),
+    KERNELS_TO_RGBA32(BPP32_ARGB, argb32),
+    KERNELS_TO_RGBA32(BPP32_ABGR, abgr32),
+
+    KERNEL(BPP8_GRAYSCALE, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_gray8_to_rgb24),
+    KERNEL(BPP8_GRAYSCALE, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_gray8_to_rgb24),
+    KERNELS_TO_RGBA32(BPP8_GRAYSCALE, gray8),
+
+    KERNEL(BPP16_GRAYSCALE, BPP8_GRAYSCALE, ANY_ALPHA_OPTION, convert_row_gray16_to_gray8),
+
+    KERNEL(BPP48_RGB, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_rgb48_to_rgb24),
+    KERNEL(BPP48_RGB, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_rgb48_to_bgr24),
+    KERNEL(BPP48_BGR, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_bgr48_to_rgb24),
+    KERNEL(BPP48_BGR, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_bgr48_to_bgr24),
+
+    KERNELS_TO_RGBA32(BPP64_RGBA, rgba64),
+    KERNELS_TO_RGBA32(BPP64_BGRA, bgra64),
+    KERNELS_TO_RGBA32(BPP64_ARGB, argb64),
+    KERNELS_TO_RGBA32(BPP64_ABGR, abgr64),
+
+    KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_RGBA, rgba32),
+    KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_BGRA, bgra32),
+    KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_ARGB, argb32),
+    KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_ABGR, abgr32),
+
+    KERNELS_TO_RGBA32(BPP32_RGBA_PREMULTIPLIED, rgba32_premultiplied),
+    KERNELS_TO_RGBA32(BPP32_BGRA_PREMULTIPLIED, bgra32_premultiplied),
+    KERNELS_TO_RGBA32(BPP32_ARGB_PREMULTIPLIED, argb32_premultiplied),
+    KERNELS_TO_RGBA32(BPP32_ABGR_PREMULTIPLIED, abgr32_premultiplied),
+
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_RGBA_PREMULTIPLIED, rgba32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_BGRA_PREMULTIPLIED, bgra32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_ARGB_PREMULTIPLIED, argb32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_ABGR_PREMULTIPLIED, abgr32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_RGBX, rgbx32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_BGRX, bgrx32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_XRGB, xrgb32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_XBGR, xbgr32),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP24_RGB, rgb24),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP24_BGR, bgr24),
+    KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP8_GRAYSCALE, gray8),
+
+    KERNELS_COMPONENTS(UINT8_FORMATS,  HALF_FORMATS,   uint8_to_half),
+    KERNELS_COMPONENTS(UINT8_FORMATS,  FLOAT_FORMATS,  uint8_to_float),
+    KERNELS_COMPONENTS(UINT16_FORMATS, HALF_FORMATS,   uint16_to_half),
+    KERNELS_COMPONENTS(UINT16_FORMATS, FLOAT_FORMATS,  uint16_to_float),
+    KERNELS_COMPONENTS(HALF_FORMATS,   UINT8_FORMATS,  half_to_uint8),
+    KERNELS_COMPONENTS(HALF_FORMATS,   UINT16_FORMATS, half_to_uint16),
+    KERNELS_COMPONENTS(FLOAT_FORMATS,  UINT8_FORMATS,  float_to_uint8),
+    KERNELS_COMPONENTS(FLOAT_FORMATS,  UINT16_FORMATS, float_to_uint16),
+    KERNELS_COMPONENTS(HALF_FORMATS,   FLOAT_FORMATS,  half_to_float),
+    KERNELS_COMPONENTS(FLOAT_FORMATS,  HALF_FORMATS,   float_to_half),
+};
+
+static const size_t CONVERSION_KERNELS_LENGTH = sizeof(CONVERSION_KERNELS) / sizeof(CONVERSION_KERNELS[0]);
+
+/* Returns the alpha handling option actually applied by the conversion functions. */
+static int effective_alpha_option(const struct sail_conversion_options *options) {
+
+    if (options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
+        return SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    }
+
+    return SAIL_CONVERSION_OPTION_DROP_ALPHA;
+}
+
+static const struct conversion_kernel* find_in_table(const struct conversion_kernel *kernels, size_t length,
+                                                    enum SailPixelFormat input_pixel_format,
+                                                    enum SailPixelFormat output_pixel_format,
+                                                    int alpha_option,
+                                                    int cpu_features) {
+
+    for (size_t i = 0; i < length; i++) {
+        const struct conversion_kernel *kernel = &kernels[i];
+
+        if (kernel->input_pixel_format == input_pixel_format &&
+                kernel->output_pixel_format == output_pixel_format &&
+                (kernel->options & alpha_option) != 0 &&
+                (kernel->cpu_features & cpu_features) == kernel->cpu_features) {
+            return kernel;
+        }
+    }
+
+    return NULL;
+}
+
+convert_row_t find_conversion_kernel_for_cpu(enum SailPixelFormat input_pixel_format,
+                                             enum SailPixelFormat output_pixel_format,
+                                             const struct sail_conversion_options *options,
+                                             int cpu_features) {
+
+    const int alpha_option = effective_alpha_option(options);
+    const struct conversion_kernel *kernel = NULL;
+
+#ifdef SAIL_MANIP_X86_KERNELS
+    if (kernel == NULL) {
+        size_t length;
+        const struct conversion_kernel *kernels = x86_conversion_kernels(&length);
+        kernel = find_in_table(kernels, length, input_pixel_format, output_pixel_format, alpha_option, cpu_features);
+    }
+#endif
+
+#ifdef SAIL_MANIP_NEON_KERNELS
+    if (kernel == NULL) {
+        size_t length;
+        const struct conversion_kernel *kernels = neon_conversion_kernels(&length);
+        kernel = find_in_table(kernels, length, input_pixel_format, output_pixel_format, alpha_option, cpu_features);
+    }
+#endif
+
+    if (kernel == NULL) {
+        kernel = find_in_table(CONVERSION_KERNELS, CONVERSION_KERNELS_LENGTH, input_pixel_format, output_pixel_format, alpha_option, 0);
+    }
+
+    return kernel == NULL ? NULL : kernel->convert_row;
+}
+
+convert_row_t find_conversion_kernel(enum SailPixelFormat input_pixel_format,
+                                     enum SailPixelFormat output_pixel_format,
+                                     const struct sail_conversion_options *options) {
+
+    return find_conversion_kernel_for_cpu(input_pixel_format, output_pixel_format, options, detected_cpu_features());
+}
@@ -0,0 +1,122 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_CONVERSION_KERNELS_H
+#define SAIL_CONVERSION_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef SAIL_BUILD
+    #include "common.h"
+    #include "export.h"
+
+    #include "cpu_features.h"
+#else
+    #include <sail-common/common.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/cpu_features.h>
+#endif
+
+struct sail_conversion_options;
+
+/*
+ * Channel layouts used to instantiate kernels. Components are listed in the R, G, B, A order.
+ * The alpha index is -1 for formats without alpha.
+ */
+#define LAYOUT_RGB  0, 1, 2
+#define LAYOUT_BGR  2, 1, 0
+
+#define LAYOUT_RGBX 0, 1, 2, -1
+#define LAYOUT_BGRX 2, 1, 0, -1
+#define LAYOUT_XRGB 1, 2, 3, -1
+#define LAYOUT_XBGR 3, 2, 1, -1
+#define LAYOUT_RGBA 0, 1, 2, 3
+#define LAYOUT_BGRA 2, 1, 0, 3
+#define LAYOUT_ARGB 1, 2, 3, 0
+#define LAYOUT_ABGR 3, 2, 1, 0
+
+/* Kernels that don't depend on alpha handling. */
+#define ANY_ALPHA_OPTION (SAIL_CONVERSION_OPTION_DROP_ALPHA | SAIL_CONVERSION_OPTION_BLEND_ALPHA)
+
+/*
+ * Converts a single row of 'width' pixels from the input pixel format into the output pixel format.
+ * The input and output rows may point to the same memory when the output pixel is not larger
+ * than the input pixel. In this case kernels read a whole pixel (or a whole SIMD block)
+ * before writing it.
+ */
+typedef void (*convert_row_t)(const void *src, void *dst, unsigned width);
+
+struct conversion_kernel {
+    enum SailPixelFormat input_pixel_format;
+    enum SailPixelFormat output_pixel_format;
+
+    /* Or-ed SailConversionOption-s the kernel implements. */
+    int options;
+
+    /* Or-ed SailCpuFeature-s the kernel needs. 0 for portable kernels. */
+    int cpu_features;
+
+    convert_row_t convert_row;
+};
+
+#define CONVERSION_KERNEL(input, output, options, cpu_features, function) \
+    { SAIL_PIXEL_FORMAT_##input, SAIL_PIXEL_FORMAT_##output, options, cpu_features, function }
+
+/*
+ * SIMD kernel tables. Every SIMD kernel has a portable counterpart producing
+ * bit-exact results. The tables list the widest instruction sets first.
+ */
+#ifdef SAIL_MANIP_X86_KERNELS
+SAIL_HIDDEN const struct conversion_kernel* x86_conversion_kernels(size_t *length);
+#endif
+
+#ifdef SAIL_MANIP_NEON_KERNELS
+SAIL_HIDDEN const struct conversion_kernel* neon_conversion_kernels(size_t *length);
+#endif
+
+/*
+ * Returns a specialized row conversion kernel for the input and output pixel formats
+ * or NULL if there is no such kernel and the generic per-pixel conversion must be used.
+ * SIMD kernels are preferred when the current CPU supports them.
+ *
+ * Options (which may be NULL) are part of the lookup key. For example, BPP32-RGBA -> BPP24-RGB
+ * has a kernel for SAIL_CONVERSION_OPTION_DROP_ALPHA, but not for SAIL_CONVERSION_OPTION_BLEND_ALPHA.
+ */
+SAIL_HIDDEN convert_row_t find_conversion_kernel(enum SailPixelFormat input_pixel_format,
+                                                 enum SailPixelFormat output_pixel_format,
+                                                 const struct sail_conversion_options *options);
+
+/*
+ * Same as find_conversion_kernel(), but considers only the kernels runnable with the specified
+ * Or-ed SailCpuFeature-s. Passing 0 returns the portable kernel.
+ */
+SAIL_HIDDEN convert_row_t find_conversion_kernel_for_cpu(enum SailPixelFormat input_pixel_format,
+                                                         enum SailPixelFormat output_pixel_format,
+                                                         const struct sail_conversion_options *options,
+                                                         int cpu_features);
+
+#endif
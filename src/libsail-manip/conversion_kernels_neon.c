@@ -0,0 +1,507 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+#ifdef SAIL_MANIP_NEON_KERNELS
+
+#include <arm_neon.h>
+
+/*
+ * NEON row kernels. Structure loads and stores (VLD3/VLD4, VST3/VST4) de-interleave
+ * channels into separate registers, so swizzles are plain register moves.
+ *
+ * Like the x86 kernels, row tails are converted in a zero-filled stack block
+ * with the same SIMD code.
+ */
+
+/* Exact value / 257 for 16-bit lanes: (value - (value >> 8)) >> 8. */
+static inline uint8x8_t narrow16_neon(uint16x8_t value) {
+
+    return vshrn_n_u16(vsubq_u16(value, vshrq_n_u16(value, 8)), 8);
+}
+
+/*
+ * 32-bit -> 32-bit channel swizzles. Sixteen pixels per block.
+ */
+static inline void rgba32_to_rgba32_block_neon(const uint8_t *src, uint8_t *dst,
+                                               int ri, int gi, int bi, int ai,
+                                               int ro, int go, int bo, int ao) {
+
+    const uint8x16x4_t input = vld4q_u8(src);
+    uint8x16x4_t output;
+
+    output.val[ro] = input.val[ri];
+    output.val[go] = input.val[gi];
+    output.val[bo] = input.val[bi];
+    output.val[ao] = ai >= 0 ? input.val[ai] : vdupq_n_u8(255);
+
+    vst4q_u8(dst, output);
+}
+
+static inline void rgba32_to_rgba32_row_neon(const uint8_t *src, uint8_t *dst, unsigned width,
+                                             int ri, int gi, int bi, int ai,
+                                             int ro, int go, int bo, int ao) {
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        rgba32_to_rgba32_block_neon(src + column * 4, dst + column * 4, ri, gi, bi, ai, ro, go, bo, ao);
+    }
+
+    if (column < width) {
+        uint8_t block[64] = { 0 };
+        const size_t size = (size_t)(width - column) * 4;
+
+        memcpy(block, src + column * 4, size);
+        rgba32_to_rgba32_block_neon(block, block, ri, gi, bi, ai, ro, go, bo, ao);
+        memcpy(dst + column * 4, block, size);
+    }
+}
+
+/*
+ * 24-bit -> 32-bit expansion. Sixteen pixels per block.
+ */
+static inline void rgb24_to_rgba32_block_neon(const uint8_t *src, uint8_t *dst,
+                                              int ri, int gi, int bi,
+                                              int ro, int go, int bo, int ao) {
+
+    const uint8x16x3_t input = vld3q_u8(src);
+    uint8x16x4_t output;
+
+    output.val[ro] = input.val[ri];
+    output.val[go] = input.val[gi];
+    output.val[bo] = input.val[bi];
+    output.val[ao] = vdupq_n_u8(255);
+
+    vst4q_u8(dst, output);
+}
+
+static inline void rgb24_to_rgba32_row_neon(const uint8_t *src, uint8_t *dst, unsigned width,
+                                            int ri, int gi, int bi,
+                                            int ro, int go, int bo, int ao) {
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        rgb24_to_rgba32_block_neon(src + column * 3, dst + column * 4, ri, gi, bi, ro, go, bo, ao);
+    }
+
+    if (column < width) {
+        uint8_t block_src[48] = { 0 };
+        uint8_t block_dst[64];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column * 3, (size_t)pixels_in_block * 3);
+        rgb24_to_rgba32_block_neon(block_src, block_dst, ri, gi, bi, ro, go, bo, ao);
+        memcpy(dst + column * 4, block_dst, (size_t)pixels_in_block * 4);
+    }
+}
+
+/*
+ * 32-bit -> 24-bit. Sixteen pixels per block.
+ */
+static inline void rgba32_to_rgb24_block_neon(const uint8_t *src, uint8_t *dst,
+                                              int ri, int gi, int bi,
+                                              int ro, int go, int bo) {
+
+    const uint8x16x4_t input = vld4q_u8(src);
+    uint8x16x3_t output;
+
+    output.val[ro] = input.val[ri];
+    output.val[go] = input.val[gi];
+    output.val[bo] = input.val[bi];
+
+    vst3q_u8(dst, output);
+}
+
+static inline void rgba32_to_rgb24_row_neon(const uint8_t *src, uint8_t *dst, unsigned width,
+                                            int ri, int gi, int bi, int ai,
+                                            int ro, int go, int bo) {
+
+    (void)ai;
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        rgba32_to_rgb24_block_neon(src + column * 4, dst + column * 3, ri, gi, bi, ro, go, bo);
+    }
+
+    if (column < width) {
+        uint8_t block_src[64] = { 0 };
+        uint8_t block_dst[48];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column * 4, (size_t)pixels_in_block * 4);
+        rgba32_to_rgb24_block_neon(block_src, block_dst, ri, gi, bi, ro, go, bo);
+        memcpy(dst + column * 3, block_dst, (size_t)pixels_in_block * 3);
+    }
+}
+
+/*
+ * 24-bit -> 24-bit swizzles. Sixteen pixels per block.
+ */
+static inline void rgb24_to_rgb24_block_neon(const uint8_t *src, uint8_t *dst,
+                                             int ri, int gi, int bi,
+                                             int ro, int go, int bo) {
+
+    const uint8x16x3_t input = vld3q_u8(src);
+    uint8x16x3_t output;
+
+    output.val[ro] = input.val[ri];
+    output.val[go] = input.val[gi];
+    output.val[bo] = input.val[bi];
+
+    vst3q_u8(dst, output);
+}
+
+static inline void rgb24_to_rgb24_row_neon(const uint8_t *src, uint8_t *dst, unsigned width,
+                                           int ri, int gi, int bi,
+                                           int ro, int go, int bo) {
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        rgb24_to_rgb24_block_neon(src + column * 3, dst + column * 3, ri, gi, bi, ro, go, bo);
+    }
+
+    if (column < width) {
+        uint8_t block[48] = { 0 };
+        const size_t size = (size_t)(width - column) * 3;
+
+        memcpy(block, src + column * 3, size);
+        rgb24_to_rgb24_block_neon(block, block, ri, gi, bi, ro, go, bo);
+        memcpy(dst + column * 3, block, size);
+    }
+}
+
+/*
+ * 48-bit -> 24-bit. Eight pixels per block.
+ */
+static inline void rgb48_to_rgb24_block_neon(const uint16_t *src, uint8_t *dst,
+                                             int ri, int gi, int bi,
+                                             int ro, int go, int bo) {
+
+    const uint16x8x3_t input = vld3q_u16(src);
+    uint8x8x3_t output;
+
+    output.val[ro] = narrow16_neon(input.val[ri]);
+    output.val[go] = narrow16_neon(input.val[gi]);
+    output.val[bo] = narrow16_neon(input.val[bi]);
+
+    vst3_u8(dst, output);
+}
+
+static inline void rgb48_to_rgb24_row_neon(const uint16_t *src, uint8_t *dst, unsigned width,
+                                           int ri, int gi, int bi,
+                                           int ro, int go, int bo) {
+
+    unsigned column = 0;
+
+    for (; column + 8 <= width; column += 8) {
+        rgb48_to_rgb24_block_neon(src + column * 3, dst + column * 3, ri, gi, bi, ro, go, bo);
+    }
+
+    if (column < width) {
+        uint16_t block_src[24] = { 0 };
+        uint8_t block_dst[24];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column * 3, (size_t)pixels_in_block * 3 * sizeof(uint16_t));
+        rgb48_to_rgb24_block_neon(block_src, block_dst, ri, gi, bi, ro, go, bo);
+        memcpy(dst + column * 3, block_dst, (size_t)pixels_in_block * 3);
+    }
+}
+
+/*
+ * 64-bit -> 32-bit. Eight pixels per block.
+ */
+static inline void rgba64_to_rgba32_block_neon(const uint16_t *src, uint8_t *dst,
+                                               int ri, int gi, int bi, int ai,
+                                               int ro, int go, int bo, int ao) {
+
+    const uint16x8x4_t input = vld4q_u16(src);
+    uint8x8x4_t output;
+
+    output.val[ro] = narrow16_neon(input.val[ri]);
+    output.val[go] = narrow16_neon(input.val[gi]);
+    output.val[bo] = narrow16_neon(input.val[bi]);
+    output.val[ao] = ai >= 0 ? narrow16_neon(input.val[ai]) : vdup_n_u8(255);
+
+    vst4_u8(dst, output);
+}
+
+static inline void rgba64_to_rgba32_row_neon(const uint16_t *src, uint8_t *dst, unsigned width,
+                                             int ri, int gi, int bi, int ai,
+                                             int ro, int go, int bo, int ao) {
+
+    unsigned column = 0;
+
+    for (; column + 8 <= width; column += 8) {
+        rgba64_to_rgba32_block_neon(src + column * 4, dst + column * 4, ri, gi, bi, ai, ro, go, bo, ao);
+    }
+
+    if (column < width) {
+        uint16_t block_src[32] = { 0 };
+        uint8_t block_dst[32];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column * 4, (size_t)pixels_in_block * 4 * sizeof(uint16_t));
+        rgba64_to_rgba32_block_neon(block_src, block_dst, ri, gi, bi, ai, ro, go, bo, ao);
+        memcpy(dst + column * 4, block_dst, (size_t)pixels_in_block * 4);
+    }
+}
+
+/*
+ * Grayscale -> RGB. Sixteen pixels per block.
+ */
+static inline void gray8_to_rgb24_block_neon(const uint8_t *src, uint8_t *dst) {
+
+    const uint8x16_t value = vld1q_u8(src);
+    uint8x16x3_t output;
+
+    output.val[0] = output.val[1] = output.val[2] = value;
+
+    vst3q_u8(dst, output);
+}
+
+static void gray8_to_rgb24_row_neon(const uint8_t *src, uint8_t *dst, unsigned width) {
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        gray8_to_rgb24_block_neon(src + column, dst + column * 3);
+    }
+
+    if (column < width) {
+        uint8_t block_src[16] = { 0 };
+        uint8_t block_dst[48];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column, pixels_in_block);
+        gray8_to_rgb24_block_neon(block_src, block_dst);
+        memcpy(dst + column * 3, block_dst, (size_t)pixels_in_block * 3);
+    }
+}
+
+static inline void gray8_to_rgba32_block_neon(const uint8_t *src, uint8_t *dst,
+                                              int ro, int go, int bo, int ao) {
+
+    const uint8x16_t value = vld1q_u8(src);
+    uint8x16x4_t output;
+
+    output.val[ro] = output.val[go] = output.val[bo] = value;
+    output.val[ao] = vdupq_n_u8(255);
+
+    vst4q_u8(dst, output);
+}
+
+static inline void gray8_to_rgba32_row_neon(const uint8_t *src, uint8_t *dst, unsigned width,
+                                            int ro, int go, int bo, int ao) {
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        gray8_to_rgba32_block_neon(src + column, dst + column * 4, ro, go, bo, ao);
+    }
+
+    if (column < width) {
+        uint8_t block_src[16] = { 0 };
+        uint8_t block_dst[64];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column, pixels_in_block);
+        gray8_to_rgba32_block_neon(block_src, block_dst, ro, go, bo, ao);
+        memcpy(dst + column * 4, block_dst, (size_t)pixels_in_block * 4);
+    }
+}
+
+/*
+ * 16-bit grayscale -> 8-bit grayscale. Sixteen pixels per block.
+ */
+static inline void gray16_to_gray8_block_neon(const uint16_t *src, uint8_t *dst) {
+
+    vst1q_u8(dst, vcombine_u8(narrow16_neon(vld1q_u16(src)), narrow16_neon(vld1q_u16(src + 8))));
+}
+
+static void convert_row_gray16_to_gray8_neon(const void *src, void *dst, unsigned width) {
+
+    const uint16_t *scan_input = src;
+    uint8_t *scan_output = dst;
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        gray16_to_gray8_block_neon(scan_input + column, scan_output + column);
+    }
+
+    if (column < width) {
+        uint16_t block_src[16] = { 0 };
+        uint8_t block_dst[16];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, scan_input + column, (size_t)pixels_in_block * sizeof(uint16_t));
+        gray16_to_gray8_block_neon(block_src, block_dst);
+        memcpy(scan_output + column, block_dst, pixels_in_block);
+    }
+}
+
+/*
+ * Kernel instantiation. The extra macro level expands LAYOUT_* into separate arguments.
+ */
+#define DEFINE_NEON_KERNEL(name, loop, src_type, ...) DEFINE_NEON_KERNEL_EXPANDED(name, loop, src_type, __VA_ARGS__)
+#define DEFINE_NEON_KERNEL_EXPANDED(name, loop, src_type, ...)                     \
+static void name(const void *src, void *dst, unsigned width) {                     \
+    loop((const src_type *)src, (uint8_t *)dst, width, __VA_ARGS__);                \
+}
+
+DEFINE_NEON_KERNEL(convert_row_rgb24_to_bgr24_neon, rgb24_to_rgb24_row_neon, uint8_t, LAYOUT_RGB, LAYOUT_BGR)
+DEFINE_NEON_KERNEL(convert_row_bgr24_to_rgb24_neon, rgb24_to_rgb24_row_neon, uint8_t, LAYOUT_BGR, LAYOUT_RGB)
+
+#define DEFINE_NEON_TO_RGBA32_KERNELS(input, loop, src_type, layout)                                      \
+DEFINE_NEON_KERNEL(convert_row_##input##_to_rgba32_neon, loop, src_type, layout, LAYOUT_RGBA)             \
+DEFINE_NEON_KERNEL(convert_row_##input##_to_bgra32_neon, loop, src_type, layout, LAYOUT_BGRA)             \
+DEFINE_NEON_KERNEL(convert_row_##input##_to_argb32_neon, loop, src_type, layout, LAYOUT_ARGB)             \
+DEFINE_NEON_KERNEL(convert_row_##input##_to_abgr32_neon, loop, src_type, layout, LAYOUT_ABGR)
+
+DEFINE_NEON_TO_RGBA32_KERNELS(rgb24, rgb24_to_rgba32_row_neon, uint8_t, LAYOUT_RGB)
+DEFINE_NEON_TO_RGBA32_KERNELS(bgr24, rgb24_to_rgba32_row_neon, uint8_t, LAYOUT_BGR)
+
+#define DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(input, layout)                                                       \
+DEFINE_NEON_KERNEL(convert_row_##input##_to_rgb24_neon, rgba32_to_rgb24_row_neon, uint8_t, layout, LAYOUT_RGB)  \
+DEFINE_NEON_KERNEL(convert_row_##input##_to_bgr24_neon, rgba32_to_rgb24_row_neon, uint8_t, layout, LAYOUT_BGR)
+
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(rgbx32, LAYOUT_RGBX)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(bgrx32, LAYOUT_BGRX)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(xrgb32, LAYOUT_XRGB)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(xbgr32, LAYOUT_XBGR)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(rgba32, LAYOUT_RGBA)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(bgra32, LAYOUT_BGRA)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(argb32, LAYOUT_ARGB)
+DEFINE_NEON_RGBA32_TO_RGB24_KERNELS(abgr32, LAYOUT_ABGR)
+
+DEFINE_NEON_TO_RGBA32_KERNELS(rgbx32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_RGBX)
+DEFINE_NEON_TO_RGBA32_KERNELS(bgrx32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_BGRX)
+DEFINE_NEON_TO_RGBA32_KERNELS(xrgb32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_XRGB)
+DEFINE_NEON_TO_RGBA32_KERNELS(xbgr32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_XBGR)
+DEFINE_NEON_TO_RGBA32_KERNELS(rgba32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_RGBA)
+DEFINE_NEON_TO_RGBA32_KERNELS(bgra32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_BGRA)
+DEFINE_NEON_TO_RGBA32_KERNELS(argb32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_ARGB)
+DEFINE_NEON_TO_RGBA32_KERNELS(abgr32, rgba32_to_rgba32_row_neon, uint8_t, LAYOUT_ABGR)
+
+static void convert_row_gray8_to_rgb24_neon(const void *src, void *dst, unsigned width) {
+
+    gray8_to_rgb24_row_neon(src, dst, width);
+}
+
+DEFINE_NEON_KERNEL(convert_row_gray8_to_rgba32_neon, gray8_to_rgba32_row_neon, uint8_t, LAYOUT_RGBA)
+DEFINE_NEON_KERNEL(convert_row_gray8_to_bgra32_neon, gray8_to_rgba32_row_neon, uint8_t, LAYOUT_BGRA)
+DEFINE_NEON_KERNEL(convert_row_gray8_to_argb32_neon, gray8_to_rgba32_row_neon, uint8_t, LAYOUT_ARGB)
+DEFINE_NEON_KERNEL(convert_row_gray8_to_abgr32_neon, gray8_to_rgba32_row_neon, uint8_t, LAYOUT_ABGR)
+
+DEFINE_NEON_KERNEL(convert_row_rgb48_to_rgb24_neon, rgb48_to_rgb24_row_neon, uint16_t, LAYOUT_RGB, LAYOUT_RGB)
+DEFINE_NEON_KERNEL(convert_row_rgb48_to_bgr24_neon, rgb48_to_rgb24_row_neon, uint16_t, LAYOUT_RGB, LAYOUT_BGR)
+DEFINE_NEON_KERNEL(convert_row_bgr48_to_rgb24_neon, rgb48_to_rgb24_row_neon, uint16_t, LAYOUT_BGR, LAYOUT_RGB)
+DEFINE_NEON_KERNEL(convert_row_bgr48_to_bgr24_neon, rgb48_to_rgb24_row_neon, uint16_t, LAYOUT_BGR, LAYOUT_BGR)
+
+DEFINE_NEON_TO_RGBA32_KERNELS(rgba64, rgba64_to_rgba32_row_neon, uint16_t, LAYOUT_RGBA)
+DEFINE_NEON_TO_RGBA32_KERNELS(bgra64, rgba64_to_rgba32_row_neon, uint16_t, LAYOUT_BGRA)
+DEFINE_NEON_TO_RGBA32_KERNELS(argb64, rgba64_to_rgba32_row_neon, uint16_t, LAYOUT_ARGB)
+DEFINE_NEON_TO_RGBA32_KERNELS(abgr64, rgba64_to_rgba32_row_neon, uint16_t, LAYOUT_ABGR)
+
+/*
+ * Kernel registry.
+ */
+
+#define NEON_KERNEL(input, output, options, function) \
+    CONVERSION_KERNEL(input, output, options, SAIL_CPU_FEATURE_NEON, function##_neon)
+
+#define NEON_KERNELS_RGBA32_TO_RGB24(input, function_prefix, options)                    \
+    NEON_KERNEL(input, BPP24_RGB, options, convert_row_##function_prefix##_to_rgb24),    \
+    NEON_KERNEL(input, BPP24_BGR, options, convert_row_##function_prefix##_to_bgr24)
+
+#define NEON_KERNELS_TO_RGBA32(input, function_prefix)                                          \
+    NEON_KERNEL(input, BPP32_RGBA, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_rgba32), \
+    NEON_KERNEL(input, BPP32_BGRA, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_bgra32), \
+    NEON_KERNEL(input, BPP32_ARGB, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_argb32), \
+    NEON_KERNEL(input, BPP32_ABGR, ANY_ALPHA_OPTION, convert_row_##function_prefix##_to_abgr32)
+
+static const struct conversion_kernel NEON_CONVERSION_KERNELS[] = {
+
+    NEON_KERNEL(BPP24_RGB, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_rgb24_to_bgr24),
+    NEON_KERNEL(BPP24_BGR, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_bgr24_to_rgb24),
+
+    NEON_KERNELS_TO_RGBA32(BPP24_RGB, rgb24),
+    NEON_KERNELS_TO_RGBA32(BPP24_BGR, bgr24),
+
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_RGBX, rgbx32, ANY_ALPHA_OPTION),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_BGRX, bgrx32, ANY_ALPHA_OPTION),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_XRGB, xrgb32, ANY_ALPHA_OPTION),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_XBGR, xbgr32, ANY_ALPHA_OPTION),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_RGBA, rgba32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_BGRA, bgra32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_ARGB, argb32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    NEON_KERNELS_RGBA32_TO_RGB24(BPP32_ABGR, abgr32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+
+    NEON_KERNELS_TO_RGBA32(BPP32_RGBX, rgbx32),
+    NEON_KERNELS_TO_RGBA32(BPP32_BGRX, bgrx32),
+    NEON_KERNELS_TO_RGBA32(BPP32_XRGB, xrgb32),
+    NEON_KERNELS_TO_RGBA32(BPP32_XBGR, xbgr32),
+    NEON_KERNELS_TO_RGBA32(BPP32_RGBA, rgba32),
+    NEON_KERNELS_TO_RGBA32(BPP32_BGRA, bgra32),
+    NEON_KERNELS_TO_RGBA32(BPP32_ARGB, argb32),
+    NEON_KERNELS_TO_RGBA32(BPP32_ABGR, abgr32),
+
+    NEON_KERNEL(BPP8_GRAYSCALE, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_gray8_to_rgb24),
+    NEON_KERNEL(BPP8_GRAYSCALE, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_gray8_to_rgb24),
+    NEON_KERNELS_TO_RGBA32(BPP8_GRAYSCALE, gray8),
+
+    NEON_KERNEL(BPP16_GRAYSCALE, BPP8_GRAYSCALE, ANY_ALPHA_OPTION, convert_row_gray16_to_gray8),
+
+    NEON_KERNEL(BPP48_RGB, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_rgb48_to_rgb24),
+    NEON_KERNEL(BPP48_RGB, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_rgb48_to_bgr24),
+    NEON_KERNEL(BPP48_BGR, BPP24_RGB, ANY_ALPHA_OPTION, convert_row_bgr48_to_rgb24),
+    NEON_KERNEL(BPP48_BGR, BPP24_BGR, ANY_ALPHA_OPTION, convert_row_bgr48_to_bgr24),
+
+    NEON_KERNELS_TO_RGBA32(BPP64_RGBA, rgba64),
+    NEON_KERNELS_TO_RGBA32(BPP64_BGRA, bgra64),
+    NEON_KERNELS_TO_RGBA32(BPP64_ARGB, argb64),
+    NEON_KERNELS_TO_RGBA32(BPP64_ABGR, abgr64),
+};
+
+const struct conversion_kernel* neon_conversion_kernels(size_t *length) {
+
+    *length = sizeof(NEON_CONVERSION_KERNELS) / sizeof(NEON_CONVERSION_KERNELS[0]);
+
+    return NEON_CONVERSION_KERNELS;
+}
+
+#endif
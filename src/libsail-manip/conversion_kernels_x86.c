@@ -0,0 +1,1074 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+#ifdef SAIL_MANIP_X86_KERNELS
+
+#include <immintrin.h>
+
+/*
+ * SSE2, SSSE3, AVX2, and F16C row kernels. Every function is compiled for its own instruction set
+ * and selected at runtime, so the library itself is still built for the baseline CPU.
+ *
+ * Row tails shorter than a SIMD block are copied into a zero-filled stack block,
+ * converted with the same SIMD code, and copied back. This way the rows never read or write
+ * past their ends, and the SIMD code path is the only one to verify against the portable kernels.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+    #define SAIL_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define SAIL_TARGET(isa)
+#endif
+
+#define SHUFFLE_ZERO 0x80
+
+/*
+ * Builds a PSHUFB mask to move 'pixels' pixels starting from the input pixel 'input_offset'
+ * between channel layouts. Output channels missing in the input are zeroed by the mask
+ * and set to 255 in 'alpha' to be or-ed with the shuffled pixels.
+ */
+static void build_shuffle(uint8_t mask[16], uint8_t alpha[16], unsigned pixels, unsigned input_offset,
+                          unsigned input_bpp, int ri, int gi, int bi, int ai,
+                          unsigned output_bpp, int ro, int go, int bo, int ao) {
+
+    const int input_indexes[4]  = { ri, gi, bi, ai };
+    const int output_indexes[4] = { ro, go, bo, ao };
+
+    memset(mask, SHUFFLE_ZERO, 16);
+    memset(alpha, 0, 16);
+
+    for (unsigned pixel = 0; pixel < pixels; pixel++) {
+        for (unsigned channel = 0; channel < 4; channel++) {
+            if (output_indexes[channel] < 0) {
+                continue;
+            }
+
+            const unsigned output_index = pixel * output_bpp + (unsigned)output_indexes[channel];
+
+            if (input_indexes[channel] >= 0) {
+                mask[output_index] = (uint8_t)((input_offset + pixel) * input_bpp + (unsigned)input_indexes[channel]);
+            } else {
+                alpha[output_index] = 255;
+            }
+        }
+    }
+}
+
+static inline __m128i load_mask(const uint8_t mask[16]) {
+
+    return _mm_loadu_si128((const __m128i *)mask);
+}
+
+/*
+ * Exact value / 257 for 16-bit lanes: (value - (value >> 8)) >> 8.
+ * Matches the integer division used by the portable kernels.
+ */
+SAIL_TARGET("sse2")
+static inline __m128i narrow16_sse2(__m128i low, __m128i high) {
+
+    low  = _mm_srli_epi16(_mm_sub_epi16(low,  _mm_srli_epi16(low,  8)), 8);
+    high = _mm_srli_epi16(_mm_sub_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+    return _mm_packus_epi16(low, high);
+}
+
+SAIL_TARGET("avx2")
+static inline __m256i narrow16_avx2(__m256i low, __m256i high) {
+
+    low  = _mm256_srli_epi16(_mm256_sub_epi16(low,  _mm256_srli_epi16(low,  8)), 8);
+    high = _mm256_srli_epi16(_mm256_sub_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+
+    /* PACKUSWB works within 128-bit lanes. Restore the element order. */
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/*
+ * 16-bit -> 8-bit narrowing of 'count' elements without reordering.
+ */
+SAIL_TARGET("sse2")
+static void narrow16_row_sse2(const uint16_t *src, uint8_t *dst, size_t count) {
+
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        const __m128i low  = _mm_loadu_si128((const __m128i *)(src + i));
+        const __m128i high = _mm_loadu_si128((const __m128i *)(src + i + 8));
+
+        _mm_storeu_si128((__m128i *)(dst + i), narrow16_sse2(low, high));
+    }
+
+    if (i < count) {
+        uint16_t block_src[16] = { 0 };
+        uint8_t block_dst[16];
+
+        memcpy(block_src, src + i, (count - i) * sizeof(uint16_t));
+
+        const __m128i low  = _mm_loadu_si128((const __m128i *)block_src);
+        const __m128i high = _mm_loadu_si128((const __m128i *)(block_src + 8));
+        _mm_storeu_si128((__m128i *)block_dst, narrow16_sse2(low, high));
+
+        memcpy(dst + i, block_dst, count - i);
+    }
+}
+
+SAIL_TARGET("avx2")
+static void narrow16_row_avx2(const uint16_t *src, uint8_t *dst, size_t count) {
+
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        const __m256i low  = _mm256_loadu_si256((const __m256i *)(src + i));
+        const __m256i high = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+
+        _mm256_storeu_si256((__m256i *)(dst + i), narrow16_avx2(low, high));
+    }
+
+    narrow16_row_sse2(src + i, dst + i, count - i);
+}
+
+/*
+ * 32-bit -> 32-bit channel swizzles. Four pixels per SSSE3 block, eight pixels per AVX2 block.
+ */
+SAIL_TARGET("ssse3")
+static inline void rgba32_to_rgba32_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width,
+                                              int ri, int gi, int bi, int ai,
+                                              int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 4, ri, gi, bi, ai, 4, ro, go, bo, ao);
+
+    const __m128i mask  = load_mask(mask_bytes);
+    const __m128i alpha = load_mask(alpha_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 4 <= width; column += 4) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + column * 4));
+
+        _mm_storeu_si128((__m128i *)(dst + column * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha));
+    }
+
+    if (column < width) {
+        uint8_t block[16] = { 0 };
+        const size_t size = (size_t)(width - column) * 4;
+
+        memcpy(block, src + column * 4, size);
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)block);
+        _mm_storeu_si128((__m128i *)block, _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha));
+        memcpy(dst + column * 4, block, size);
+    }
+}
+
+SAIL_TARGET("avx2")
+static inline void rgba32_to_rgba32_row_avx2(const uint8_t *src, uint8_t *dst, unsigned width,
+                                             int ri, int gi, int bi, int ai,
+                                             int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 4, ri, gi, bi, ai, 4, ro, go, bo, ao);
+
+    const __m256i mask  = _mm256_broadcastsi128_si256(load_mask(mask_bytes));
+    const __m256i alpha = _mm256_broadcastsi128_si256(load_mask(alpha_bytes));
+
+    unsigned column = 0;
+
+    for (; column + 8 <= width; column += 8) {
+        const __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + column * 4));
+
+        _mm256_storeu_si256((__m256i *)(dst + column * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, mask), alpha));
+    }
+
+    rgba32_to_rgba32_row_ssse3(src + column * 4, dst + column * 4, width - column, ri, gi, bi, ai, ro, go, bo, ao);
+}
+
+/*
+ * Straight alpha -> premultiplied alpha. The pixels are swizzled into the output layout,
+ * and the alpha of every pixel is spread into its color channels to build the multipliers.
+ * Alpha itself is multiplied by 255. The products are divided by 255 with rounding
+ * exactly as div255_round() does: (x + 128 + ((x + 128) >> 8)) >> 8.
+ */
+static void build_premultiply_shuffle(uint8_t mask[16], uint8_t alpha[16], int ai, int ro, int go, int bo, int ao) {
+
+    memset(mask, SHUFFLE_ZERO, 16);
+    memset(alpha, 0, 16);
+
+    for (unsigned pixel = 0; pixel < 4; pixel++) {
+        const uint8_t input_alpha = (uint8_t)(pixel * 4 + (unsigned)ai);
+
+        mask[pixel * 4 + (unsigned)ro] = input_alpha;
+        mask[pixel * 4 + (unsigned)go] = input_alpha;
+        mask[pixel * 4 + (unsigned)bo] = input_alpha;
+        alpha[pixel * 4 + (unsigned)ao] = 255;
+    }
+}
+
+SAIL_TARGET("ssse3")
+static inline __m128i div255_round_ssse3(__m128i value) {
+
+    value = _mm_add_epi16(value, _mm_set1_epi16(128));
+
+    return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+
+SAIL_TARGET("ssse3")
+static inline __m128i premultiply_block_ssse3(__m128i pixels, __m128i mask, __m128i alpha_mask, __m128i alpha) {
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i swizzled = _mm_shuffle_epi8(pixels, mask);
+    const __m128i multipliers = _mm_or_si128(_mm_shuffle_epi8(pixels, alpha_mask), alpha);
+
+    const __m128i low  = _mm_mullo_epi16(_mm_unpacklo_epi8(swizzled, zero), _mm_unpacklo_epi8(multipliers, zero));
+    const __m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(swizzled, zero), _mm_unpackhi_epi8(multipliers, zero));
+
+    return _mm_packus_epi16(div255_round_ssse3(low), div255_round_ssse3(high));
+}
+
+SAIL_TARGET("ssse3")
+static inline void rgba32_to_rgba32_premultiplied_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width,
+                                                            int ri, int gi, int bi, int ai,
+                                                            int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t unused[16];
+    build_shuffle(mask_bytes, unused, 4, 0, 4, ri, gi, bi, ai, 4, ro, go, bo, ao);
+
+    uint8_t alpha_mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_premultiply_shuffle(alpha_mask_bytes, alpha_bytes, ai, ro, go, bo, ao);
+
+    const __m128i mask       = load_mask(mask_bytes);
+    const __m128i alpha_mask = load_mask(alpha_mask_bytes);
+    const __m128i alpha      = load_mask(alpha_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 4 <= width; column += 4) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + column * 4));
+
+        _mm_storeu_si128((__m128i *)(dst + column * 4), premultiply_block_ssse3(pixels, mask, alpha_mask, alpha));
+    }
+
+    if (column < width) {
+        uint8_t block[16] = { 0 };
+        const size_t size = (size_t)(width - column) * 4;
+
+        memcpy(block, src + column * 4, size);
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)block);
+        _mm_storeu_si128((__m128i *)block, premultiply_block_ssse3(pixels, mask, alpha_mask, alpha));
+        memcpy(dst + column * 4, block, size);
+    }
+}
+
+SAIL_TARGET("avx2")
+static inline __m256i div255_round_avx2(__m256i value) {
+
+    value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+
+    return _mm256_srli_epi16(_mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+}
+
+SAIL_TARGET("avx2")
+static inline void rgba32_to_rgba32_premultiplied_row_avx2(const uint8_t *src, uint8_t *dst, unsigned width,
+                                                           int ri, int gi, int bi, int ai,
+                                                           int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t unused[16];
+    build_shuffle(mask_bytes, unused, 4, 0, 4, ri, gi, bi, ai, 4, ro, go, bo, ao);
+
+    uint8_t alpha_mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_premultiply_shuffle(alpha_mask_bytes, alpha_bytes, ai, ro, go, bo, ao);
+
+    const __m256i mask       = _mm256_broadcastsi128_si256(load_mask(mask_bytes));
+    const __m256i alpha_mask = _mm256_broadcastsi128_si256(load_mask(alpha_mask_bytes));
+    const __m256i alpha      = _mm256_broadcastsi128_si256(load_mask(alpha_bytes));
+    const __m256i zero       = _mm256_setzero_si256();
+
+    unsigned column = 0;
+
+    /* Unpacking and packing work within 128-bit lanes, so the element order is preserved. */
+    for (; column + 8 <= width; column += 8) {
+        const __m256i pixels = _mm256_loadu_si256((const __m256i *)(src + column * 4));
+        const __m256i swizzled = _mm256_shuffle_epi8(pixels, mask);
+        const __m256i multipliers = _mm256_or_si256(_mm256_shuffle_epi8(pixels, alpha_mask), alpha);
+
+        const __m256i low  = _mm256_mullo_epi16(_mm256_unpacklo_epi8(swizzled, zero), _mm256_unpacklo_epi8(multipliers, zero));
+        const __m256i high = _mm256_mullo_epi16(_mm256_unpackhi_epi8(swizzled, zero), _mm256_unpackhi_epi8(multipliers, zero));
+
+        _mm256_storeu_si256((__m256i *)(dst + column * 4), _mm256_packus_epi16(div255_round_avx2(low), div255_round_avx2(high)));
+    }
+
+    rgba32_to_rgba32_premultiplied_row_ssse3(src + column * 4, dst + column * 4, width - column, ri, gi, bi, ai, ro, go, bo, ao);
+}
+
+/*
+ * 24-bit -> 32-bit expansion. A 16-byte load covers four RGB pixels plus four spare bytes,
+ * so the main loop stops while the spare bytes are still inside the row.
+ */
+SAIL_TARGET("ssse3")
+static inline void rgb24_to_rgba32_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width,
+                                             int ri, int gi, int bi,
+                                             int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 3, ri, gi, bi, -1, 4, ro, go, bo, ao);
+
+    const __m128i mask  = load_mask(mask_bytes);
+    const __m128i alpha = load_mask(alpha_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 6 <= width; column += 4) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + column * 3));
+
+        _mm_storeu_si128((__m128i *)(dst + column * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha));
+    }
+
+    while (column < width) {
+        uint8_t block[16] = { 0 };
+        const unsigned pixels_in_block = (width - column < 4) ? width - column : 4;
+
+        memcpy(block, src + column * 3, (size_t)pixels_in_block * 3);
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)block);
+        _mm_storeu_si128((__m128i *)block, _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha));
+        memcpy(dst + column * 4, block, (size_t)pixels_in_block * 4);
+
+        column += pixels_in_block;
+    }
+}
+
+SAIL_TARGET("avx2")
+static inline void rgb24_to_rgba32_row_avx2(const uint8_t *src, uint8_t *dst, unsigned width,
+                                            int ri, int gi, int bi,
+                                            int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 3, ri, gi, bi, -1, 4, ro, go, bo, ao);
+
+    const __m256i mask  = _mm256_broadcastsi128_si256(load_mask(mask_bytes));
+    const __m256i alpha = _mm256_broadcastsi128_si256(load_mask(alpha_bytes));
+
+    unsigned column = 0;
+
+    /* Every 128-bit lane gets its own four pixels. */
+    for (; column + 10 <= width; column += 8) {
+        const __m128i low  = _mm_loadu_si128((const __m128i *)(src + column * 3));
+        const __m128i high = _mm_loadu_si128((const __m128i *)(src + column * 3 + 12));
+        const __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+
+        _mm256_storeu_si256((__m256i *)(dst + column * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, mask), alpha));
+    }
+
+    rgb24_to_rgba32_row_ssse3(src + column * 3, dst + column * 4, width - column, ri, gi, bi, ro, go, bo, ao);
+}
+
+/*
+ * 32-bit -> 24-bit. Four pixels per block are packed into the low 12 bytes
+ * and stored with 8-byte and 4-byte stores not to touch the next pixels.
+ */
+SAIL_TARGET("ssse3")
+static inline void store12_ssse3(uint8_t *dst, __m128i value) {
+
+    const uint32_t last = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(value, 8));
+
+    _mm_storel_epi64((__m128i *)dst, value);
+    memcpy(dst + 8, &last, sizeof(last));
+}
+
+SAIL_TARGET("ssse3")
+static inline void rgba32_to_rgb24_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width,
+                                             int ri, int gi, int bi, int ai,
+                                             int ro, int go, int bo) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 4, ri, gi, bi, ai, 3, ro, go, bo, -1);
+
+    const __m128i mask = load_mask(mask_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 4 <= width; column += 4) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + column * 4));
+
+        store12_ssse3(dst + column * 3, _mm_shuffle_epi8(pixels, mask));
+    }
+
+    if (column < width) {
+        uint8_t block[16] = { 0 };
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block, src + column * 4, (size_t)pixels_in_block * 4);
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)block);
+        _mm_storeu_si128((__m128i *)block, _mm_shuffle_epi8(pixels, mask));
+        memcpy(dst + column * 3, block, (size_t)pixels_in_block * 3);
+    }
+}
+
+/*
+ * 24-bit -> 24-bit swizzles. Five pixels per block. The 16th byte belongs to the next pixel,
+ * so it's passed through unchanged and rewritten by the next block.
+ */
+SAIL_TARGET("ssse3")
+static inline void rgb24_to_rgb24_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width,
+                                            int ri, int gi, int bi,
+                                            int ro, int go, int bo) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 5, 0, 3, ri, gi, bi, -1, 3, ro, go, bo, -1);
+    mask_bytes[15] = 15;
+
+    const __m128i mask = load_mask(mask_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 6 <= width; column += 5) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)(src + column * 3));
+
+        _mm_storeu_si128((__m128i *)(dst + column * 3), _mm_shuffle_epi8(pixels, mask));
+    }
+
+    if (column < width) {
+        uint8_t block[16] = { 0 };
+        const size_t size = (size_t)(width - column) * 3;
+
+        memcpy(block, src + column * 3, size);
+        const __m128i pixels = _mm_loadu_si128((const __m128i *)block);
+        _mm_storeu_si128((__m128i *)block, _mm_shuffle_epi8(pixels, mask));
+        memcpy(dst + column * 3, block, size);
+    }
+}
+
+/*
+ * 48-bit -> 24-bit swizzles. Same as above, but the block is narrowed first.
+ */
+SAIL_TARGET("ssse3")
+static inline void rgb48_to_rgb24_row_ssse3(const uint16_t *src, uint8_t *dst, unsigned width,
+                                            int ri, int gi, int bi,
+                                            int ro, int go, int bo) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 5, 0, 3, ri, gi, bi, -1, 3, ro, go, bo, -1);
+    mask_bytes[15] = 15;
+
+    const __m128i mask = load_mask(mask_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 6 <= width; column += 5) {
+        const __m128i low  = _mm_loadu_si128((const __m128i *)(src + column * 3));
+        const __m128i high = _mm_loadu_si128((const __m128i *)(src + column * 3 + 8));
+
+        _mm_storeu_si128((__m128i *)(dst + column * 3), _mm_shuffle_epi8(narrow16_sse2(low, high), mask));
+    }
+
+    if (column < width) {
+        uint16_t block_src[16] = { 0 };
+        uint8_t block_dst[16];
+        const size_t elements = (size_t)(width - column) * 3;
+
+        memcpy(block_src, src + column * 3, elements * sizeof(uint16_t));
+        const __m128i low  = _mm_loadu_si128((const __m128i *)block_src);
+        const __m128i high = _mm_loadu_si128((const __m128i *)(block_src + 8));
+        _mm_storeu_si128((__m128i *)block_dst, _mm_shuffle_epi8(narrow16_sse2(low, high), mask));
+        memcpy(dst + column * 3, block_dst, elements);
+    }
+}
+
+/*
+ * 64-bit -> 32-bit. Narrowing followed by a 32-bit swizzle.
+ */
+SAIL_TARGET("ssse3")
+static inline void rgba64_to_rgba32_row_ssse3(const uint16_t *src, uint8_t *dst, unsigned width,
+                                              int ri, int gi, int bi, int ai,
+                                              int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 4, ri, gi, bi, ai, 4, ro, go, bo, ao);
+
+    const __m128i mask  = load_mask(mask_bytes);
+    const __m128i alpha = load_mask(alpha_bytes);
+
+    unsigned column = 0;
+
+    for (; column + 4 <= width; column += 4) {
+        const __m128i low  = _mm_loadu_si128((const __m128i *)(src + column * 4));
+        const __m128i high = _mm_loadu_si128((const __m128i *)(src + column * 4 + 8));
+        const __m128i pixels = narrow16_sse2(low, high);
+
+        _mm_storeu_si128((__m128i *)(dst + column * 4), _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha));
+    }
+
+    if (column < width) {
+        uint16_t block_src[16] = { 0 };
+        uint8_t block_dst[16];
+        const size_t elements = (size_t)(width - column) * 4;
+
+        memcpy(block_src, src + column * 4, elements * sizeof(uint16_t));
+        const __m128i low  = _mm_loadu_si128((const __m128i *)block_src);
+        const __m128i high = _mm_loadu_si128((const __m128i *)(block_src + 8));
+        const __m128i pixels = narrow16_sse2(low, high);
+        _mm_storeu_si128((__m128i *)block_dst, _mm_or_si128(_mm_shuffle_epi8(pixels, mask), alpha));
+        memcpy(dst + column * 4, block_dst, elements);
+    }
+}
+
+SAIL_TARGET("avx2")
+static inline void rgba64_to_rgba32_row_avx2(const uint16_t *src, uint8_t *dst, unsigned width,
+                                             int ri, int gi, int bi, int ai,
+                                             int ro, int go, int bo, int ao) {
+
+    uint8_t mask_bytes[16];
+    uint8_t alpha_bytes[16];
+    build_shuffle(mask_bytes, alpha_bytes, 4, 0, 4, ri, gi, bi, ai, 4, ro, go, bo, ao);
+
+    const __m256i mask  = _mm256_broadcastsi128_si256(load_mask(mask_bytes));
+    const __m256i alpha = _mm256_broadcastsi128_si256(load_mask(alpha_bytes));
+
+    unsigned column = 0;
+
+    for (; column + 8 <= width; column += 8) {
+        const __m256i low  = _mm256_loadu_si256((const __m256i *)(src + column * 4));
+        const __m256i high = _mm256_loadu_si256((const __m256i *)(src + column * 4 + 16));
+        const __m256i pixels = narrow16_avx2(low, high);
+
+        _mm256_storeu_si256((__m256i *)(dst + column * 4), _mm256_or_si256(_mm256_shuffle_epi8(pixels, mask), alpha));
+    }
+
+    rgba64_to_rgba32_row_ssse3(src + column * 4, dst + column * 4, width - column, ri, gi, bi, ai, ro, go, bo, ao);
+}
+
+/*
+ * Grayscale -> RGB. Sixteen pixels per block.
+ */
+SAIL_TARGET("ssse3")
+static inline void gray8_to_rgb24_block_ssse3(const uint8_t *src, uint8_t *dst, const __m128i masks[3]) {
+
+    const __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+
+    _mm_storeu_si128((__m128i *)dst,        _mm_shuffle_epi8(pixels, masks[0]));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_shuffle_epi8(pixels, masks[1]));
+    _mm_storeu_si128((__m128i *)(dst + 32), _mm_shuffle_epi8(pixels, masks[2]));
+}
+
+SAIL_TARGET("ssse3")
+static void gray8_to_rgb24_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width) {
+
+    __m128i masks[3];
+
+    for (unsigned i = 0; i < 3; i++) {
+        uint8_t mask_bytes[16];
+
+        for (unsigned j = 0; j < 16; j++) {
+            mask_bytes[j] = (uint8_t)((i * 16 + j) / 3);
+        }
+
+        masks[i] = load_mask(mask_bytes);
+    }
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        gray8_to_rgb24_block_ssse3(src + column, dst + column * 3, masks);
+    }
+
+    if (column < width) {
+        uint8_t block_src[16] = { 0 };
+        uint8_t block_dst[48];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column, pixels_in_block);
+        gray8_to_rgb24_block_ssse3(block_src, block_dst, masks);
+        memcpy(dst + column * 3, block_dst, (size_t)pixels_in_block * 3);
+    }
+}
+
+SAIL_TARGET("ssse3")
+static inline void gray8_to_rgba32_block_ssse3(const uint8_t *src, uint8_t *dst, const __m128i masks[4], __m128i alpha) {
+
+    const __m128i pixels = _mm_loadu_si128((const __m128i *)src);
+
+    for (unsigned i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i *)(dst + i * 16), _mm_or_si128(_mm_shuffle_epi8(pixels, masks[i]), alpha));
+    }
+}
+
+SAIL_TARGET("ssse3")
+static inline void gray8_to_rgba32_row_ssse3(const uint8_t *src, uint8_t *dst, unsigned width,
+                                             int ro, int go, int bo, int ao) {
+
+    __m128i masks[4];
+    __m128i alpha = _mm_setzero_si128();
+
+    for (unsigned i = 0; i < 4; i++) {
+        uint8_t mask_bytes[16];
+        uint8_t alpha_bytes[16];
+
+        build_shuffle(mask_bytes, alpha_bytes, 4, i * 4, 1, 0, 0, 0, -1, 4, ro, go, bo, ao);
+
+        masks[i] = load_mask(mask_bytes);
+        alpha = load_mask(alpha_bytes);
+    }
+
+    unsigned column = 0;
+
+    for (; column + 16 <= width; column += 16) {
+        gray8_to_rgba32_block_ssse3(src + column, dst + column * 4, masks, alpha);
+    }
+
+    if (column < width) {
+        uint8_t block_src[16] = { 0 };
+        uint8_t block_dst[64];
+        const unsigned pixels_in_block = width - column;
+
+        memcpy(block_src, src + column, pixels_in_block);
+        gray8_to_rgba32_block_ssse3(block_src, block_dst, masks, alpha);
+        memcpy(dst + column * 4, block_dst, (size_t)pixels_in_block * 4);
+    }
+}
+
+/*
+ * Integer <-> floating point conversions. Eight components per block. Components are not
+ * reordered, so the same loop converts gray, RGB, and RGBA rows.
+ *
+ * Floats are clamped with MAXPS first, so NaN gives 0 like in float_to_uint16().
+ * Halfs are converted with F16C that rounds exactly like float_to_half() and half_to_float().
+ */
+SAIL_TARGET("avx2")
+static inline __m256 uint8_to_float_avx2(const uint8_t *src) {
+
+    const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src)));
+
+    return _mm256_div_ps(values, _mm256_set1_ps(255.0f));
+}
+
+SAIL_TARGET("avx2")
+static inline __m256 uint16_to_float_avx2(const uint16_t *src) {
+
+    const __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)src)));
+
+    return _mm256_div_ps(values, _mm256_set1_ps(65535.0f));
+}
+
+SAIL_TARGET("avx2")
+static inline __m128i float_to_uint16_avx2(__m256 values) {
+
+    values = _mm256_max_ps(values, _mm256_setzero_ps());
+    values = _mm256_min_ps(values, _mm256_set1_ps(1.0f));
+    values = _mm256_add_ps(_mm256_mul_ps(values, _mm256_set1_ps(65535.0f)), _mm256_set1_ps(0.5f));
+
+    const __m256i integers = _mm256_cvttps_epi32(values);
+
+    return _mm_packus_epi32(_mm256_castsi256_si128(integers), _mm256_extracti128_si256(integers, 1));
+}
+
+SAIL_TARGET("avx2")
+static inline __m128i float_to_uint8_avx2(__m256 values) {
+
+    __m128i values16 = float_to_uint16_avx2(values);
+    values16 = _mm_srli_epi16(_mm_sub_epi16(values16, _mm_srli_epi16(values16, 8)), 8);
+
+    return _mm_packus_epi16(values16, values16);
+}
+
+SAIL_TARGET("avx2")
+static inline void uint8_to_float_block_avx2(const uint8_t *src, float *dst) {
+
+    _mm256_storeu_ps(dst, uint8_to_float_avx2(src));
+}
+
+SAIL_TARGET("avx2")
+static inline void uint16_to_float_block_avx2(const uint16_t *src, float *dst) {
+
+    _mm256_storeu_ps(dst, uint16_to_float_avx2(src));
+}
+
+SAIL_TARGET("avx2")
+static inline void float_to_uint8_block_avx2(const float *src, uint8_t *dst) {
+
+    _mm_storel_epi64((__m128i *)dst, float_to_uint8_avx2(_mm256_loadu_ps(src)));
+}
+
+SAIL_TARGET("avx2")
+static inline void float_to_uint16_block_avx2(const float *src, uint16_t *dst) {
+
+    _mm_storeu_si128((__m128i *)dst, float_to_uint16_avx2(_mm256_loadu_ps(src)));
+}
+
+SAIL_TARGET("avx2,f16c")
+static inline void uint8_to_half_block_f16c(const uint8_t *src, uint16_t *dst) {
+
+    _mm_storeu_si128((__m128i *)dst, _mm256_cvtps_ph(uint8_to_float_avx2(src), _MM_FROUND_TO_NEAREST_INT));
+}
+
+SAIL_TARGET("avx2,f16c")
+static inline void uint16_to_half_block_f16c(const uint16_t *src, uint16_t *dst) {
+
+    _mm_storeu_si128((__m128i *)dst, _mm256_cvtps_ph(uint16_to_float_avx2(src), _MM_FROUND_TO_NEAREST_INT));
+}
+
+SAIL_TARGET("avx2,f16c")
+static inline void half_to_uint8_block_f16c(const uint16_t *src, uint8_t *dst) {
+
+    _mm_storel_epi64((__m128i *)dst, float_to_uint8_avx2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)src))));
+}
+
+SAIL_TARGET("avx2,f16c")
+static inline void half_to_uint16_block_f16c(const uint16_t *src, uint16_t *dst) {
+
+    _mm_storeu_si128((__m128i *)dst, float_to_uint16_avx2(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)src))));
+}
+
+SAIL_TARGET("avx2,f16c")
+static inline void half_to_float_block_f16c(const uint16_t *src, float *dst) {
+
+    _mm256_storeu_ps(dst, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)src)));
+}
+
+SAIL_TARGET("avx2,f16c")
+static inline void float_to_half_block_f16c(const float *src, uint16_t *dst) {
+
+    _mm_storeu_si128((__m128i *)dst, _mm256_cvtps_ph(_mm256_loadu_ps(src), _MM_FROUND_TO_NEAREST_INT));
+}
+
+/*
+ * Row loops and kernels over the blocks above. A whole block is loaded before it is stored,
+ * so in-place conversions to smaller components are safe.
+ */
+#define DEFINE_X86_COMPONENT_KERNELS(name, isa, target, src_type, dst_type)                     \
+SAIL_TARGET(target)                                                                            \
+static void name##_row_##isa(const src_type *src, dst_type *dst, size_t count) {              \
+    size_t i = 0;                                                                              \
+    for (; i + 8 <= count; i += 8) {                                                           \
+        name##_block_##isa(src + i, dst + i);                                                  \
+    }                                                                                          \
+    if (i < count) {                                                                           \
+        src_type block_src[8] = { 0 };                                                         \
+        dst_type block_dst[8];                                                                 \
+        memcpy(block_src, src + i, (count - i) * sizeof(src_type));                            \
+        name##_block_##isa(block_src, block_dst);                                              \
+        memcpy(dst + i, block_dst, (count - i) * sizeof(dst_type));                            \
+    }                                                                                          \
+}                                                                                              \
+SAIL_TARGET(target)                                                                            \
+static void convert_row_##name##_x1_##isa(const void *src, void *dst, unsigned width) {       \
+    name##_row_##isa(src, dst, width);                                                         \
+}                                                                                              \
+SAIL_TARGET(target)                                                                            \
+static void convert_row_##name##_x3_##isa(const void *src, void *dst, unsigned width) {       \
+    name##_row_##isa(src, dst, (size_t)width * 3);                                             \
+}                                                                                              \
+SAIL_TARGET(target)                                                                            \
+static void convert_row_##name##_x4_##isa(const void *src, void *dst, unsigned width) {       \
+    name##_row_##isa(src, dst, (size_t)width * 4);                                             \
+}
+
+DEFINE_X86_COMPONENT_KERNELS(uint8_to_float,  avx2, "avx2",      uint8_t,  float)
+DEFINE_X86_COMPONENT_KERNELS(uint16_to_float, avx2, "avx2",      uint16_t, float)
+DEFINE_X86_COMPONENT_KERNELS(float_to_uint8,  avx2, "avx2",      float,    uint8_t)
+DEFINE_X86_COMPONENT_KERNELS(float_to_uint16, avx2, "avx2",      float,    uint16_t)
+DEFINE_X86_COMPONENT_KERNELS(uint8_to_half,   f16c, "avx2,f16c", uint8_t,  uint16_t)
+DEFINE_X86_COMPONENT_KERNELS(uint16_to_half,  f16c, "avx2,f16c", uint16_t, uint16_t)
+DEFINE_X86_COMPONENT_KERNELS(half_to_uint8,   f16c, "avx2,f16c", uint16_t, uint8_t)
+DEFINE_X86_COMPONENT_KERNELS(half_to_uint16,  f16c, "avx2,f16c", uint16_t, uint16_t)
+DEFINE_X86_COMPONENT_KERNELS(half_to_float,   f16c, "avx2,f16c", uint16_t, float)
+DEFINE_X86_COMPONENT_KERNELS(float_to_half,   f16c, "avx2,f16c", float,    uint16_t)
+
+/*
+ * Kernel instantiation. The extra macro level expands LAYOUT_* into separate arguments.
+ */
+#define DEFINE_X86_KERNEL(name, isa, loop, src_type, ...) DEFINE_X86_KERNEL_EXPANDED(name, isa, loop, src_type, __VA_ARGS__)
+#define DEFINE_X86_KERNEL_EXPANDED(name, isa, loop, src_type, ...)                 \
+SAIL_TARGET(isa)                                                                    \
+static void name(const void *src, void *dst, unsigned width) {                      \
+    loop((const src_type *)src, (uint8_t *)dst, width, __VA_ARGS__);                 \
+}
+
+#define DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, input, layout)                                                                   \
+DEFINE_X86_KERNEL(convert_row_##input##_to_rgba32_##isa, #isa, rgba32_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_RGBA)          \
+DEFINE_X86_KERNEL(convert_row_##input##_to_bgra32_##isa, #isa, rgba32_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_BGRA)          \
+DEFINE_X86_KERNEL(convert_row_##input##_to_argb32_##isa, #isa, rgba32_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_ARGB)          \
+DEFINE_X86_KERNEL(convert_row_##input##_to_abgr32_##isa, #isa, rgba32_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_ABGR)
+
+#define DEFINE_X86_ALL_RGBA32_TO_RGBA32_KERNELS(isa)          \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, rgbx32, LAYOUT_RGBX) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, bgrx32, LAYOUT_BGRX) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, xrgb32, LAYOUT_XRGB) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, xbgr32, LAYOUT_XBGR) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, rgba32, LAYOUT_RGBA) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, bgra32, LAYOUT_BGRA) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, argb32, LAYOUT_ARGB) \
+DEFINE_X86_RGBA32_TO_RGBA32_KERNELS(isa, abgr32, LAYOUT_ABGR)
+
+DEFINE_X86_ALL_RGBA32_TO_RGBA32_KERNELS(ssse3)
+DEFINE_X86_ALL_RGBA32_TO_RGBA32_KERNELS(avx2)
+
+#define DEFINE_X86_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(isa, input, layout)                                                                                      \
+DEFINE_X86_KERNEL(convert_row_##input##_to_rgba32_premultiplied_##isa, #isa, rgba32_to_rgba32_premultiplied_row_##isa, uint8_t, layout, LAYOUT_RGBA)     \
+DEFINE_X86_KERNEL(convert_row_##input##_to_bgra32_premultiplied_##isa, #isa, rgba32_to_rgba32_premultiplied_row_##isa, uint8_t, layout, LAYOUT_BGRA)     \
+DEFINE_X86_KERNEL(convert_row_##input##_to_argb32_premultiplied_##isa, #isa, rgba32_to_rgba32_premultiplied_row_##isa, uint8_t, layout, LAYOUT_ARGB)     \
+DEFINE_X86_KERNEL(convert_row_##input##_to_abgr32_premultiplied_##isa, #isa, rgba32_to_rgba32_premultiplied_row_##isa, uint8_t, layout, LAYOUT_ABGR)
+
+#define DEFINE_X86_ALL_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(isa)          \
+DEFINE_X86_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(isa, rgba32, LAYOUT_RGBA) \
+DEFINE_X86_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(isa, bgra32, LAYOUT_BGRA) \
+DEFINE_X86_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(isa, argb32, LAYOUT_ARGB) \
+DEFINE_X86_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(isa, abgr32, LAYOUT_ABGR)
+
+DEFINE_X86_ALL_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(ssse3)
+DEFINE_X86_ALL_RGBA32_TO_RGBA32_PREMULTIPLIED_KERNELS(avx2)
+
+#define DEFINE_X86_RGB24_TO_RGBA32_KERNELS(isa, input, layout)                                                                    \
+DEFINE_X86_KERNEL(convert_row_##input##_to_rgba32_##isa, #isa, rgb24_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_RGBA)           \
+DEFINE_X86_KERNEL(convert_row_##input##_to_bgra32_##isa, #isa, rgb24_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_BGRA)           \
+DEFINE_X86_KERNEL(convert_row_##input##_to_argb32_##isa, #isa, rgb24_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_ARGB)           \
+DEFINE_X86_KERNEL(convert_row_##input##_to_abgr32_##isa, #isa, rgb24_to_rgba32_row_##isa, uint8_t, layout, LAYOUT_ABGR)
+
+DEFINE_X86_RGB24_TO_RGBA32_KERNELS(ssse3, rgb24, LAYOUT_RGB)
+DEFINE_X86_RGB24_TO_RGBA32_KERNELS(ssse3, bgr24, LAYOUT_BGR)
+DEFINE_X86_RGB24_TO_RGBA32_KERNELS(avx2,  rgb24, LAYOUT_RGB)
+DEFINE_X86_RGB24_TO_RGBA32_KERNELS(avx2,  bgr24, LAYOUT_BGR)
+
+#define DEFINE_X86_RGBA32_TO_RGB24_KERNELS(input, layout)                                                                       \
+DEFINE_X86_KERNEL(convert_row_##input##_to_rgb24_ssse3, "ssse3", rgba32_to_rgb24_row_ssse3, uint8_t, layout, LAYOUT_RGB)        \
+DEFINE_X86_KERNEL(convert_row_##input##_to_bgr24_ssse3, "ssse3", rgba32_to_rgb24_row_ssse3, uint8_t, layout, LAYOUT_BGR)
+
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(rgbx32, LAYOUT_RGBX)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(bgrx32, LAYOUT_BGRX)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(xrgb32, LAYOUT_XRGB)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(xbgr32, LAYOUT_XBGR)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(rgba32, LAYOUT_RGBA)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(bgra32, LAYOUT_BGRA)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(argb32, LAYOUT_ARGB)
+DEFINE_X86_RGBA32_TO_RGB24_KERNELS(abgr32, LAYOUT_ABGR)
+
+DEFINE_X86_KERNEL(convert_row_rgb24_to_bgr24_ssse3, "ssse3", rgb24_to_rgb24_row_ssse3, uint8_t, LAYOUT_RGB, LAYOUT_BGR)
+DEFINE_X86_KERNEL(convert_row_bgr24_to_rgb24_ssse3, "ssse3", rgb24_to_rgb24_row_ssse3, uint8_t, LAYOUT_BGR, LAYOUT_RGB)
+
+DEFINE_X86_KERNEL(convert_row_rgb48_to_bgr24_ssse3, "ssse3", rgb48_to_rgb24_row_ssse3, uint16_t, LAYOUT_RGB, LAYOUT_BGR)
+DEFINE_X86_KERNEL(convert_row_bgr48_to_rgb24_ssse3, "ssse3", rgb48_to_rgb24_row_ssse3, uint16_t, LAYOUT_BGR, LAYOUT_RGB)
+
+#define DEFINE_X86_RGBA64_TO_RGBA32_KERNELS(isa, input, layout)                                                                   \
+DEFINE_X86_KERNEL(convert_row_##input##_to_rgba32_##isa, #isa, rgba64_to_rgba32_row_##isa, uint16_t, layout, LAYOUT_RGBA)         \
+DEFINE_X86_KERNEL(convert_row_##input##_to_bgra32_##isa, #isa, rgba64_to_rgba32_row_##isa, uint16_t, layout, LAYOUT_BGRA)         \
+DEFINE_X86_KERNEL(convert_row_##input##_to_argb32_##isa, #isa, rgba64_to_rgba32_row_##isa, uint16_t, layout, LAYOUT_ARGB)         \
+DEFINE_X86_KERNEL(convert_row_##input##_to_abgr32_##isa, #isa, rgba64_to_rgba32_row_##isa, uint16_t, layout, LAYOUT_ABGR)
+
+#define DEFINE_X86_ALL_RGBA64_TO_RGBA32_KERNELS(isa)          \
+DEFINE_X86_RGBA64_TO_RGBA32_KERNELS(isa, rgba64, LAYOUT_RGBA) \
+DEFINE_X86_RGBA64_TO_RGBA32_KERNELS(isa, bgra64, LAYOUT_BGRA) \
+DEFINE_X86_RGBA64_TO_RGBA32_KERNELS(isa, argb64, LAYOUT_ARGB) \
+DEFINE_X86_RGBA64_TO_RGBA32_KERNELS(isa, abgr64, LAYOUT_ABGR)
+
+DEFINE_X86_ALL_RGBA64_TO_RGBA32_KERNELS(ssse3)
+DEFINE_X86_ALL_RGBA64_TO_RGBA32_KERNELS(avx2)
+
+SAIL_TARGET("ssse3")
+static void convert_row_gray8_to_rgb24_ssse3(const void *src, void *dst, unsigned width) {
+
+    gray8_to_rgb24_row_ssse3(src, dst, width);
+}
+
+DEFINE_X86_KERNEL(convert_row_gray8_to_rgba32_ssse3, "ssse3", gray8_to_rgba32_row_ssse3, uint8_t, LAYOUT_RGBA)
+DEFINE_X86_KERNEL(convert_row_gray8_to_bgra32_ssse3, "ssse3", gray8_to_rgba32_row_ssse3, uint8_t, LAYOUT_BGRA)
+DEFINE_X86_KERNEL(convert_row_gray8_to_argb32_ssse3, "ssse3", gray8_to_rgba32_row_ssse3, uint8_t, LAYOUT_ARGB)
+DEFINE_X86_KERNEL(convert_row_gray8_to_abgr32_ssse3, "ssse3", gray8_to_rgba32_row_ssse3, uint8_t, LAYOUT_ABGR)
+
+/* Narrowing without reordering doesn't depend on the number of channels. */
+#define DEFINE_X86_NARROW16_KERNEL(name, isa, channels)                       \
+SAIL_TARGET(#isa)                                                              \
+static void name##_##isa(const void *src, void *dst, unsigned width) {        \
+    narrow16_row_##isa(src, dst, (size_t)width * channels);                    \
+}
+
+DEFINE_X86_NARROW16_KERNEL(convert_row_gray16_to_gray8, sse2, 1)
+DEFINE_X86_NARROW16_KERNEL(convert_row_gray16_to_gray8, avx2, 1)
+DEFINE_X86_NARROW16_KERNEL(convert_row_rgb48_to_rgb24,  sse2, 3)
+DEFINE_X86_NARROW16_KERNEL(convert_row_rgb48_to_rgb24,  avx2, 3)
+
+/*
+ * Kernel registry. F16C and AVX2 kernels go first to win over SSSE3 and SSE2 ones.
+ */
+
+#define FEATURES_sse2  SAIL_CPU_FEATURE_SSE2
+#define FEATURES_ssse3 (SAIL_CPU_FEATURE_SSE2 | SAIL_CPU_FEATURE_SSSE3)
+#define FEATURES_avx2  (SAIL_CPU_FEATURE_SSE2 | SAIL_CPU_FEATURE_SSSE3 | SAIL_CPU_FEATURE_AVX2)
+#define FEATURES_f16c  (FEATURES_avx2 | SAIL_CPU_FEATURE_F16C)
+
+#define X86_KERNEL(input, output, options, isa, function) \
+    CONVERSION_KERNEL(input, output, options, FEATURES_##isa, function##_##isa)
+
+#define X86_KERNELS_RGBA32_TO_RGB24(input, function_prefix, options)                             \
+    X86_KERNEL(input, BPP24_RGB, options, ssse3, convert_row_##function_prefix##_to_rgb24),        \
+    X86_KERNEL(input, BPP24_BGR, options, ssse3, convert_row_##function_prefix##_to_bgr24)
+
+#define X86_KERNELS_TO_RGBA32(input, function_prefix, isa)                                            \
+    X86_KERNEL(input, BPP32_RGBA, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_rgba32),    \
+    X86_KERNEL(input, BPP32_BGRA, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_bgra32),    \
+    X86_KERNEL(input, BPP32_ARGB, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_argb32),    \
+    X86_KERNEL(input, BPP32_ABGR, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_abgr32)
+
+#define X86_KERNELS_32BIT_TO_RGBA32(isa)                 \
+    X86_KERNELS_TO_RGBA32(BPP32_RGBX, rgbx32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_BGRX, bgrx32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_XRGB, xrgb32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_XBGR, xbgr32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_RGBA, rgba32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_BGRA, bgra32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_ARGB, argb32, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP32_ABGR, abgr32, isa)
+
+#define X86_KERNELS_64BIT_TO_RGBA32(isa)                 \
+    X86_KERNELS_TO_RGBA32(BPP64_RGBA, rgba64, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP64_BGRA, bgra64, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP64_ARGB, argb64, isa),       \
+    X86_KERNELS_TO_RGBA32(BPP64_ABGR, abgr64, isa)
+
+#define X86_KERNELS_TO_RGBA32_PREMULTIPLIED(input, function_prefix, isa)                                                       \
+    X86_KERNEL(input, BPP32_RGBA_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_rgba32_premultiplied), \
+    X86_KERNEL(input, BPP32_BGRA_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_bgra32_premultiplied), \
+    X86_KERNEL(input, BPP32_ARGB_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_argb32_premultiplied), \
+    X86_KERNEL(input, BPP32_ABGR_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_abgr32_premultiplied)
+
+/* Plain swizzles, see KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED in conversion_kernels.c. */
+#define X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(input, function_prefix, isa)                                      \
+    X86_KERNEL(input, BPP32_RGBA_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_rgba32),    \
+    X86_KERNEL(input, BPP32_BGRA_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_bgra32),    \
+    X86_KERNEL(input, BPP32_ARGB_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_argb32),    \
+    X86_KERNEL(input, BPP32_ABGR_PREMULTIPLIED, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_to_abgr32)
+
+#define X86_KERNELS_PREMULTIPLIED(isa)                                              \
+    X86_KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_RGBA, rgba32, isa),                    \
+    X86_KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_BGRA, bgra32, isa),                    \
+    X86_KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_ARGB, argb32, isa),                    \
+    X86_KERNELS_TO_RGBA32_PREMULTIPLIED(BPP32_ABGR, abgr32, isa),                    \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_RGBA_PREMULTIPLIED, rgba32, isa), \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_BGRA_PREMULTIPLIED, bgra32, isa), \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_ARGB_PREMULTIPLIED, argb32, isa), \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_ABGR_PREMULTIPLIED, abgr32, isa), \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_RGBX, rgbx32, isa),            \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_BGRX, bgrx32, isa),            \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_XRGB, xrgb32, isa),            \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP32_XBGR, xbgr32, isa),            \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP24_RGB, rgb24, isa),              \
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP24_BGR, bgr24, isa)
+
+/* Gray, RGB, and RGBA pixel formats with the same component type. */
+#define UINT8_FORMATS  BPP8_GRAYSCALE,        BPP24_RGB,       BPP32_RGBA
+#define UINT16_FORMATS BPP16_GRAYSCALE,       BPP48_RGB,       BPP64_RGBA
+#define HALF_FORMATS   BPP16_GRAYSCALE_HALF,  BPP48_RGB_HALF,  BPP64_RGBA_HALF
+#define FLOAT_FORMATS  BPP32_GRAYSCALE_FLOAT, BPP96_RGB_FLOAT, BPP128_RGBA_FLOAT
+
+#define X86_KERNELS_COMPONENTS(input_formats, output_formats, isa, function_prefix) \
+    X86_KERNELS_COMPONENTS_EXPANDED(input_formats, output_formats, isa, function_prefix)
+#define X86_KERNELS_COMPONENTS_EXPANDED(input_gray, input_rgb, input_rgba, output_gray, output_rgb, output_rgba, isa, function_prefix) \
+    X86_KERNEL(input_gray, output_gray, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_x1),                                 \
+    X86_KERNEL(input_rgb,  output_rgb,  ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_x3),                                 \
+    X86_KERNEL(input_rgba, output_rgba, ANY_ALPHA_OPTION, isa, convert_row_##function_prefix##_x4)
+
+static const struct conversion_kernel X86_CONVERSION_KERNELS[] = {
+
+    /* F16C. */
+    X86_KERNELS_COMPONENTS(UINT8_FORMATS,  HALF_FORMATS,   f16c, uint8_to_half),
+    X86_KERNELS_COMPONENTS(UINT16_FORMATS, HALF_FORMATS,   f16c, uint16_to_half),
+    X86_KERNELS_COMPONENTS(HALF_FORMATS,   UINT8_FORMATS,  f16c, half_to_uint8),
+    X86_KERNELS_COMPONENTS(HALF_FORMATS,   UINT16_FORMATS, f16c, half_to_uint16),
+    X86_KERNELS_COMPONENTS(HALF_FORMATS,   FLOAT_FORMATS,  f16c, half_to_float),
+    X86_KERNELS_COMPONENTS(FLOAT_FORMATS,  HALF_FORMATS,   f16c, float_to_half),
+
+    /* AVX2. */
+    X86_KERNELS_COMPONENTS(UINT8_FORMATS,  FLOAT_FORMATS,  avx2, uint8_to_float),
+    X86_KERNELS_COMPONENTS(UINT16_FORMATS, FLOAT_FORMATS,  avx2, uint16_to_float),
+    X86_KERNELS_COMPONENTS(FLOAT_FORMATS,  UINT8_FORMATS,  avx2, float_to_uint8),
+    X86_KERNELS_COMPONENTS(FLOAT_FORMATS,  UINT16_FORMATS, avx2, float_to_uint16),
+
+    X86_KERNELS_TO_RGBA32(BPP24_RGB, rgb24, avx2),
+    X86_KERNELS_TO_RGBA32(BPP24_BGR, bgr24, avx2),
+    X86_KERNELS_32BIT_TO_RGBA32(avx2),
+    X86_KERNELS_64BIT_TO_RGBA32(avx2),
+    X86_KERNELS_PREMULTIPLIED(avx2),
+
+    X86_KERNEL(BPP16_GRAYSCALE, BPP8_GRAYSCALE, ANY_ALPHA_OPTION, avx2, convert_row_gray16_to_gray8),
+    X86_KERNEL(BPP48_RGB,       BPP24_RGB,      ANY_ALPHA_OPTION, avx2, convert_row_rgb48_to_rgb24),
+    X86_KERNEL(BPP48_BGR,       BPP24_BGR,      ANY_ALPHA_OPTION, avx2, convert_row_rgb48_to_rgb24),
+
+    /* SSSE3. */
+    X86_KERNEL(BPP24_RGB, BPP24_BGR, ANY_ALPHA_OPTION, ssse3, convert_row_rgb24_to_bgr24),
+    X86_KERNEL(BPP24_BGR, BPP24_RGB, ANY_ALPHA_OPTION, ssse3, convert_row_bgr24_to_rgb24),
+
+    X86_KERNELS_TO_RGBA32(BPP24_RGB, rgb24, ssse3),
+    X86_KERNELS_TO_RGBA32(BPP24_BGR, bgr24, ssse3),
+
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_RGBX, rgbx32, ANY_ALPHA_OPTION),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_BGRX, bgrx32, ANY_ALPHA_OPTION),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_XRGB, xrgb32, ANY_ALPHA_OPTION),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_XBGR, xbgr32, ANY_ALPHA_OPTION),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_RGBA, rgba32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_BGRA, bgra32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_ARGB, argb32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+    X86_KERNELS_RGBA32_TO_RGB24(BPP32_ABGR, abgr32, SAIL_CONVERSION_OPTION_DROP_ALPHA),
+
+    X86_KERNELS_32BIT_TO_RGBA32(ssse3),
+
+    X86_KERNEL(BPP8_GRAYSCALE, BPP24_RGB, ANY_ALPHA_OPTION, ssse3, convert_row_gray8_to_rgb24),
+    X86_KERNEL(BPP8_GRAYSCALE, BPP24_BGR, ANY_ALPHA_OPTION, ssse3, convert_row_gray8_to_rgb24),
+    X86_KERNELS_TO_RGBA32(BPP8_GRAYSCALE, gray8, ssse3),
+
+    X86_KERNEL(BPP48_RGB, BPP24_BGR, ANY_ALPHA_OPTION, ssse3, convert_row_rgb48_to_bgr24),
+    X86_KERNEL(BPP48_BGR, BPP24_RGB, ANY_ALPHA_OPTION, ssse3, convert_row_bgr48_to_rgb24),
+
+    X86_KERNELS_64BIT_TO_RGBA32(ssse3),
+    X86_KERNELS_PREMULTIPLIED(ssse3),
+    X86_KERNELS_SWIZZLE_TO_RGBA32_PREMULTIPLIED(BPP8_GRAYSCALE, gray8, ssse3),
+
+    /* SSE2. */
+    X86_KERNEL(BPP16_GRAYSCALE, BPP8_GRAYSCALE, ANY_ALPHA_OPTION, sse2, convert_row_gray16_to_gray8),
+    X86_KERNEL(BPP48_RGB,       BPP24_RGB,      ANY_ALPHA_OPTION, sse2, convert_row_rgb48_to_rgb24),
+    X86_KERNEL(BPP48_BGR,       BPP24_BGR,      ANY_ALPHA_OPTION, sse2, convert_row_rgb48_to_rgb24),
+};
+
+const struct conversion_kernel* x86_conversion_kernels(size_t *length) {
+
+    *length = sizeof(X86_CONVERSION_KERNELS) / sizeof(X86_CONVERSION_KERNELS[0]);
+
+    return X86_CONVERSION_KERNELS;
+}
+
+#endif
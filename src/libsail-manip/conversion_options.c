@@ -36,6 +36,10 @@ sail_status_t sail_alloc_conversion_options(struct sail_conversion_options **opt
     (*options)->options      = SAIL_CONVERSION_OPTION_DROP_ALPHA;
     (*options)->background48 = (sail_rgb48_t){ 0, 0, 0 };
     (*options)->background24 = (sail_rgb24_t){ 0, 0, 0 };
+    (*options)->threads      = 1;
+    (*options)->yuv_matrix   = SAIL_YUV_MATRIX_BT601;
+    (*options)->yuv_range    = SAIL_YUV_RANGE_FULL;
+    (*options)->dither       = SAIL_DITHER_NONE;
 
     return SAIL_OK;
 }
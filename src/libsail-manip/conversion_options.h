@@ -44,6 +44,11 @@
 extern "C" {
 #endif
 
+/*
+ * Value of sail_conversion_options.threads to convert images with as many threads as there are CPU cores.
+ */
+#define SAIL_THREADS_AUTO ((unsigned)-1)
+
 /*
  * Options to control image conversion behavior.
  */
@@ -65,6 +70,35 @@ struct sail_conversion_options {
      * when options has SAIL_CONVERSION_OPTION_BLEND_ALPHA.
      */
     sail_rgb24_t background24;
+
+    /*
+     * Number of threads to convert images with. The image is split into row bands converted
+     * concurrently. 0 and 1 convert in the calling thread. SAIL_THREADS_AUTO uses as many threads
+     * as there are CPU cores.
+     * Small images are always converted in the calling thread.
+     *
+     * Also applies to sail_update_image_with_options() and to frames converted while reading.
+     * See sail_set_reading_conversion_options().
+     */
+    unsigned threads;
+
+    /*
+     * Matrix and range to convert planar YUV pixel formats like I420 with.
+     * Defaults to SAIL_YUV_MATRIX_BT601 and SAIL_YUV_RANGE_FULL used by JPEG.
+     */
+    enum SailYuvMatrix yuv_matrix;
+    enum SailYuvRange yuv_range;
+
+    /*
+     * How to dither when converting to pixel formats with fewer colors:
+     *   - 1/2/4-bit grayscale pixel formats, and grayscale images to 1/2/4-bit indexed pixel formats:
+     *     SAIL_DITHER_NONE picks the nearest gray level, SAIL_DITHER_ORDERED adds an 8x8 Bayer matrix pattern.
+     *     Rows are converted independently, so SAIL_DITHER_FLOYD_STEINBERG falls back to SAIL_DITHER_ORDERED.
+     *   - Color and indexed images to indexed pixel formats: the images are quantized with this dithering,
+     *     see sail_quantize_image_with_options().
+     * Defaults to SAIL_DITHER_NONE.
+     */
+    enum SailDither dither;
 };
 
 typedef struct sail_conversion_options sail_conversion_options_t;
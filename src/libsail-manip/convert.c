@@ -28,6 +28,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sail-common.h"
 
@@ -114,6 +115,115 @@ static void pixel_consumer_rgba64_kind(const struct output_context *output_conte
     }
 }
 
+static void pixel_consumer_rgba32_premultiplied_kind(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    uint8_t *scan = (uint8_t *)output_context->image->pixels + output_context->image->bytes_per_line * row + column * 4;
+
+    if (rgba32 != NULL) {
+        fill_rgba32_premultiplied_pixel_from_uint8_values(rgba32, scan, output_context->r, output_context->g, output_context->b, output_context->a);
+    } else {
+        fill_rgba32_premultiplied_pixel_from_uint16_values(rgba64, scan, output_context->r, output_context->g, output_context->b, output_context->a);
+    }
+}
+
+static void pixel_consumer_rgba64_premultiplied_kind(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    uint16_t *scan = (uint16_t *)((uint8_t *)output_context->image->pixels + output_context->image->bytes_per_line * row + column * 8);
+
+    if (rgba32 != NULL) {
+        fill_rgba64_premultiplied_pixel_from_uint8_values(rgba32, scan, output_context->r, output_context->g, output_context->b, output_context->a);
+    } else {
+        fill_rgba64_premultiplied_pixel_from_uint16_values(rgba64, scan, output_context->r, output_context->g, output_context->b, output_context->a);
+    }
+}
+
+/* Stores normalized components as halfs or floats. */
+static inline void store_floating_point_components(uint8_t *scan, bool half, const float *values, unsigned count) {
+
+    if (half) {
+        for (unsigned i = 0; i < count; i++) {
+            *((uint16_t *)scan + i) = float_to_half(values[i]);
+        }
+    } else {
+        memcpy(scan, values, count * sizeof(float));
+    }
+}
+
+static inline void consume_gray_floating_point(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64, bool half) {
+
+    uint8_t *scan = (uint8_t *)output_context->image->pixels + output_context->image->bytes_per_line * row + column * (half ? 2 : 4);
+    uint16_t gray16;
+
+    if (rgba32 != NULL) {
+        fill_gray16_pixel_from_uint8_values(rgba32, &gray16, output_context->options);
+    } else {
+        fill_gray16_pixel_from_uint16_values(rgba64, &gray16, output_context->options);
+    }
+
+    const float value = uint16_to_float(gray16);
+    store_floating_point_components(scan, half, &value, 1);
+}
+
+static inline void consume_rgb_floating_point(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64, bool half) {
+
+    uint8_t *scan = (uint8_t *)output_context->image->pixels + output_context->image->bytes_per_line * row + column * (half ? 6 : 12);
+    uint16_t rgb48[3];
+
+    if (rgba32 != NULL) {
+        fill_rgb48_pixel_from_uint8_values(rgba32, rgb48, 0, 1, 2, output_context->options);
+    } else {
+        fill_rgb48_pixel_from_uint16_values(rgba64, rgb48, 0, 1, 2, output_context->options);
+    }
+
+    const float values[3] = { uint16_to_float(rgb48[0]), uint16_to_float(rgb48[1]), uint16_to_float(rgb48[2]) };
+    store_floating_point_components(scan, half, values, 3);
+}
+
+static inline void consume_rgba_floating_point(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64, bool half) {
+
+    uint8_t *scan = (uint8_t *)output_context->image->pixels + output_context->image->bytes_per_line * row + column * (half ? 8 : 16);
+
+    if (rgba32 != NULL) {
+        const float values[4] = { uint8_to_float(rgba32->component1), uint8_to_float(rgba32->component2),
+                                  uint8_to_float(rgba32->component3), uint8_to_float(rgba32->component4) };
+        store_floating_point_components(scan, half, values, 4);
+    } else {
+        const float values[4] = { uint16_to_float(rgba64->component1), uint16_to_float(rgba64->component2),
+                                  uint16_to_float(rgba64->component3), uint16_to_float(rgba64->component4) };
+        store_floating_point_components(scan, half, values, 4);
+    }
+}
+
+static void pixel_consumer_gray_half(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    consume_gray_floating_point(output_context, row, column, rgba32, rgba64, true);
+}
+
+static void pixel_consumer_gray_float(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    consume_gray_floating_point(output_context, row, column, rgba32, rgba64, false);
+}
+
+static void pixel_consumer_rgb_half(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    consume_rgb_floating_point(output_context, row, column, rgba32, rgba64, true);
+}
+
+static void pixel_consumer_rgb_float(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    consume_rgb_floating_point(output_context, row, column, rgba32, rgba64, false);
+}
+
+static void pixel_consumer_rgba_half(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    consume_rgba_floating_point(output_context, row, column, rgba32, rgba64, true);
+}
+
+static void pixel_consumer_rgba_float(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
+
+    consume_rgba_floating_point(output_context, row, column, rgba32, rgba64, false);
+}
+
 static void pixel_consumer_ycbcr(const struct output_context *output_context, unsigned row, unsigned column, const sail_rgba32_t *rgba32, const sail_rgba64_t *rgba64) {
 
     uint8_t *scan = (uint8_t *)output_context->image->pixels + output_context->image->bytes_per_line * row + column * 3;
@@ -155,6 +265,23 @@ static bool verify_and_construct_rgba_indexes_silent(enum SailPixelFormat output
         case SAIL_PIXEL_FORMAT_BPP64_ARGB: { *pixel_consumer = pixel_consumer_rgba64_kind; *r = 1; *g = 2; *b = 3; *a = 0;  break; }
         case SAIL_PIXEL_FORMAT_BPP64_ABGR: { *pixel_consumer = pixel_consumer_rgba64_kind; *r = 3; *g = 2; *b = 1; *a = 0;  break; }
 
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 0; *g = 1; *b = 2; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 2; *g = 1; *b = 0; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 1; *g = 2; *b = 3; *a = 0; break; }
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba32_premultiplied_kind; *r = 3; *g = 2; *b = 1; *a = 0; break; }
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 0; *g = 1; *b = 2; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 2; *g = 1; *b = 0; *a = 3; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 1; *g = 2; *b = 3; *a = 0; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: { *pixel_consumer = pixel_consumer_rgba64_premultiplied_kind; *r = 3; *g = 2; *b = 1; *a = 0; break; }
+
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF:  { *pixel_consumer = pixel_consumer_gray_half;  *r = *g = *b = *a = -1; /* unused. */ break; }
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT: { *pixel_consumer = pixel_consumer_gray_float; *r = *g = *b = *a = -1; /* unused. */ break; }
+        case SAIL_PIXEL_FORMAT_BPP48_RGB_HALF:        { *pixel_consumer = pixel_consumer_rgb_half;   *r = 0; *g = 1; *b = 2; *a = -1; break; }
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF:       { *pixel_consumer = pixel_consumer_rgba_half;  *r = 0; *g = 1; *b = 2; *a = 3;  break; }
+        case SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT:       { *pixel_consumer = pixel_consumer_rgb_float;  *r = 0; *g = 1; *b = 2; *a = -1; break; }
+        case SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT:     { *pixel_consumer = pixel_consumer_rgba_float; *r = 0; *g = 1; *b = 2; *a = 3;  break; }
+
         case SAIL_PIXEL_FORMAT_BPP24_YCBCR: { *pixel_consumer = pixel_consumer_ycbcr; *r = *g = *b = *a = -1; /* unused. */ break; }
 
         default: {
@@ -175,132 +302,6 @@ static sail_status_t verify_and_construct_rgba_indexes_verbose(enum SailPixelFor
     }
 }
 
-static sail_status_t convert_from_bpp1_indexed_or_grayscale(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
-
-    const bool is_indexed = image->pixel_format == SAIL_PIXEL_FORMAT_BPP1_INDEXED;
-    sail_rgba32_t rgba32;
-
-    for (unsigned row = 0; row < image->height; row++) {
-        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
-
-        for (unsigned column = 0; column < image->width;) {
-            unsigned bit_shift = 7;
-            unsigned bit_mask = 1 << 7;
-            const uint8_t byte = *scan_input++;
-
-            while (bit_mask > 0 && column < image->width) {
-                const uint8_t index = (byte & bit_mask) >> bit_shift;
-
-                if (is_indexed) {
-                    SAIL_TRY(get_palette_rgba32(image->palette, index, &rgba32));
-                } else {
-                    spread_gray8_to_rgba32(index == 0 ? 0 : 255, &rgba32);
-                }
-
-                pixel_consumer(output_context, row, column, &rgba32, NULL);
-
-                bit_shift--;
-                bit_mask >>= 1;
-                column++;
-            }
-        }
-    }
-
-    return SAIL_OK;
-}
-
-static sail_status_t convert_from_bpp2_indexed_or_grayscale(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
-
-    const bool is_indexed = image->pixel_format == SAIL_PIXEL_FORMAT_BPP2_INDEXED;
-    sail_rgba32_t rgba32;
-
-    for (unsigned row = 0; row < image->height; row++) {
-        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
-
-        for (unsigned column = 0; column < image->width;) {
-            unsigned bit_shift = 6;
-            unsigned bit_mask = 3 << 6; /* 11000000 */
-            const uint8_t byte = *scan_input++;
-
-            while (bit_mask > 0 && column < image->width) {
-                const uint8_t index = (byte & bit_mask) >> bit_shift;
-
-                if (is_indexed) {
-                    SAIL_TRY(get_palette_rgba32(image->palette, index, &rgba32));
-                } else {
-                    spread_gray8_to_rgba32(index * 85, &rgba32);
-                }
-
-                pixel_consumer(output_context, row, column, &rgba32, NULL);
-
-                bit_shift -= 2;
-                bit_mask >>= 2;
-                column++;
-            }
-        }
-    }
-
-    return SAIL_OK;
-}
-
-static sail_status_t convert_from_bpp4_indexed_or_grayscale(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
-
-    const bool is_indexed = image->pixel_format == SAIL_PIXEL_FORMAT_BPP4_INDEXED;
-    sail_rgba32_t rgba32;
-
-    for (unsigned row = 0; row < image->height; row++) {
-        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
-
-        for (unsigned column = 0; column < image->width;) {
-            unsigned bit_shift = 4;
-            unsigned bit_mask = 15 << 4; /* 11110000 */
-            const uint8_t byte = *scan_input++;
-
-            while (bit_mask > 0 && column < image->width) {
-                const uint8_t index = (byte & bit_mask) >> bit_shift;
-
-                if (is_indexed) {
-                    SAIL_TRY(get_palette_rgba32(image->palette, index, &rgba32));
-                } else {
-                    spread_gray8_to_rgba32(index * 17, &rgba32);
-                }
-
-                pixel_consumer(output_context, row, column, &rgba32, NULL);
-
-                bit_shift -= 4;
-                bit_mask >>= 4;
-                column++;
-            }
-        }
-    }
-
-    return SAIL_OK;
-}
-
-static sail_status_t convert_from_bpp8_indexed_or_grayscale(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
-
-    const bool is_indexed = image->pixel_format == SAIL_PIXEL_FORMAT_BPP8_INDEXED;
-    sail_rgba32_t rgba32;
-
-    for (unsigned row = 0; row < image->height; row++) {
-        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
-
-        for (unsigned column = 0; column < image->width; column++) {
-            const uint8_t index = *scan_input++;
-
-            if (is_indexed) {
-                SAIL_TRY(get_palette_rgba32(image->palette, index, &rgba32));
-            } else {
-                spread_gray8_to_rgba32(index, &rgba32);
-            }
-
-            pixel_consumer(output_context, row, column, &rgba32, NULL);
-        }
-    }
-
-    return SAIL_OK;
-}
-
 static sail_status_t convert_from_bpp16_grayscale(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
 
     sail_rgba64_t rgba64;
@@ -482,6 +483,166 @@ static sail_status_t convert_from_bpp64_rgba_kind(const struct sail_image *image
     return SAIL_OK;
 }
 
+static sail_status_t convert_from_bpp32_rgba_premultiplied_kind(const struct sail_image *image, int ri, int gi, int bi, int ai, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            const uint8_t a = *(scan_input+ai);
+            const sail_rgba32_t rgba32 = { unpremultiply8(*(scan_input+ri), a), unpremultiply8(*(scan_input+gi), a), unpremultiply8(*(scan_input+bi), a), a };
+
+            pixel_consumer(output_context, row, column, &rgba32, NULL);
+            scan_input += 4;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t convert_from_bpp64_rgba_premultiplied_kind(const struct sail_image *image, int ri, int gi, int bi, int ai, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint16_t *scan_input = (uint16_t *)((uint8_t *)image->pixels + image->bytes_per_line * row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            const uint16_t a = *(scan_input+ai);
+            const sail_rgba64_t rgba64 = { unpremultiply16(*(scan_input+ri), a), unpremultiply16(*(scan_input+gi), a), unpremultiply16(*(scan_input+bi), a), a };
+
+            pixel_consumer(output_context, row, column, NULL, &rgba64);
+            scan_input += 4;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/* Returns the number of components of a floating point pixel format and whether they are halfs. */
+static bool floating_point_layout_of(enum SailPixelFormat pixel_format, unsigned *channels, bool *half) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF:  { *channels = 1; *half = true;  return true; }
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT: { *channels = 1; *half = false; return true; }
+        case SAIL_PIXEL_FORMAT_BPP48_RGB_HALF:        { *channels = 3; *half = true;  return true; }
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF:       { *channels = 4; *half = true;  return true; }
+        case SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT:       { *channels = 3; *half = false; return true; }
+        case SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT:     { *channels = 4; *half = false; return true; }
+
+        default: {
+            return false;
+        }
+    }
+}
+
+static inline float load_floating_point_component(const uint8_t *scan, bool half, unsigned index) {
+
+    return half ? half_to_float(*((const uint16_t *)scan + index)) : *((const float *)scan + index);
+}
+
+/* Loads a gray, RGB, or RGBA pixel as RGBA. */
+static inline void load_floating_point_pixel(const uint8_t *scan, unsigned channels, bool half, float rgba[4]) {
+
+    if (channels == 1) {
+        rgba[0] = rgba[1] = rgba[2] = load_floating_point_component(scan, half, 0);
+        rgba[3] = 1;
+    } else {
+        rgba[0] = load_floating_point_component(scan, half, 0);
+        rgba[1] = load_floating_point_component(scan, half, 1);
+        rgba[2] = load_floating_point_component(scan, half, 2);
+        rgba[3] = (channels == 4) ? load_floating_point_component(scan, half, 3) : 1;
+    }
+}
+
+/* Clamps floating point components to 16 bits. */
+static sail_status_t convert_from_floating_point(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
+
+    unsigned channels = 0;
+    bool half = false;
+
+    if (!floating_point_layout_of(image->pixel_format, &channels, &half)) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const unsigned bytes_per_pixel = channels * (half ? 2 : 4);
+    float rgba[4];
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            load_floating_point_pixel(scan_input, channels, half, rgba);
+
+            const sail_rgba64_t rgba64 = { float_to_uint16(rgba[0]), float_to_uint16(rgba[1]), float_to_uint16(rgba[2]), float_to_uint16(rgba[3]) };
+
+            pixel_consumer(output_context, row, column, NULL, &rgba64);
+            scan_input += bytes_per_pixel;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Converts between floating point pixel formats without clamping, so values outside of [0; 1]
+ * survive. Alpha is dropped or blended with background48 like in the other conversions.
+ */
+static sail_status_t convert_floating_point_rows(const struct sail_image *image, struct sail_image *image_output, const struct sail_conversion_options *options) {
+
+    unsigned input_channels = 0, output_channels = 0;
+    bool input_half = false, output_half = false;
+
+    if (!floating_point_layout_of(image->pixel_format, &input_channels, &input_half) ||
+            !floating_point_layout_of(image_output->pixel_format, &output_channels, &output_half)) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const unsigned input_bytes_per_pixel = input_channels * (input_half ? 2 : 4);
+    const unsigned output_bytes_per_pixel = output_channels * (output_half ? 2 : 4);
+    const bool blend_alpha = options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA);
+
+    float background[3] = { 0, 0, 0 };
+
+    if (blend_alpha) {
+        background[0] = uint16_to_float(options->background48.component1);
+        background[1] = uint16_to_float(options->background48.component2);
+        background[2] = uint16_to_float(options->background48.component3);
+    }
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + image_output->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            float rgba[4];
+            load_floating_point_pixel(scan_input, input_channels, input_half, rgba);
+
+            if (output_channels == 4) {
+                store_floating_point_components(scan_output, output_half, rgba, 4);
+            } else {
+                if (blend_alpha && rgba[3] < 1) {
+                    for (unsigned i = 0; i < 3; i++) {
+                        rgba[i] = rgba[i] * rgba[3] + background[i] * (1 - rgba[3]);
+                    }
+                }
+
+                if (output_channels == 3) {
+                    store_floating_point_components(scan_output, output_half, rgba, 3);
+                } else {
+                    /* Gray pixels are opaque and stay as is. */
+                    const float gray = (input_channels == 1) ? rgba[0]
+                                        : (rgba[0] * R_TO_GRAY_WEIGHT + rgba[1] * G_TO_GRAY_WEIGHT + rgba[2] * B_TO_GRAY_WEIGHT) / 65536.0f;
+                    store_floating_point_components(scan_output, output_half, &gray, 1);
+                }
+            }
+
+            scan_input += input_bytes_per_pixel;
+            scan_output += output_bytes_per_pixel;
+        }
+    }
+
+    return SAIL_OK;
+}
+
 static sail_status_t convert_from_bpp32_cmyk(const struct sail_image *image, pixel_consumer_t pixel_consumer, const struct output_context *output_context) {
 
     sail_rgba32_t rgba32;
@@ -536,47 +697,252 @@ static sail_status_t convert_from_bpp32_ycck(const struct sail_image *image, pix
     return SAIL_OK;
 }
 
-static sail_status_t conversion_impl(
-    const struct sail_image *image,
-    struct sail_image *image_output,
-    pixel_consumer_t pixel_consumer,
-    int r, /* Index of RED component. */
-    int g, /* Index of GREEN component. */
-    int b, /* Index of BLUE component. */
-    int a, /* Index of ALPHA component. */
-    const struct sail_conversion_options *options) {
+static void convert_rows(const struct sail_image *image, struct sail_image *image_output, convert_row_t convert_row) {
 
-    const struct output_context output_context = { image_output, r, g, b, a, options };
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + image_output->bytes_per_line * row;
 
-    /* After adding a new input pixel format, also update the switch in sail_can_convert(). */
-    switch (image->pixel_format) {
+        convert_row(scan_input, scan_output, image->width);
+    }
+}
+
+/* Returns the number of bits per index of pixel formats converted with palette LUTs or 0. */
+static unsigned palette_lut_bits_per_index(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE: {
-            SAIL_TRY(convert_from_bpp1_indexed_or_grayscale(image, pixel_consumer, &output_context));
-            break;
-        }
+        case SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE: return 1;
         case SAIL_PIXEL_FORMAT_BPP2_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE: {
-            SAIL_TRY(convert_from_bpp2_indexed_or_grayscale(image, pixel_consumer, &output_context));
-            break;
-        }
+        case SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE: return 2;
         case SAIL_PIXEL_FORMAT_BPP4_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE: {
-            SAIL_TRY(convert_from_bpp4_indexed_or_grayscale(image, pixel_consumer, &output_context));
-            break;
-        }
+        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE: return 4;
         case SAIL_PIXEL_FORMAT_BPP8_INDEXED:
-        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE: {
-            SAIL_TRY(convert_from_bpp8_indexed_or_grayscale(image, pixel_consumer, &output_context));
-            break;
-        }
-        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE: {
-            SAIL_TRY(convert_from_bpp16_grayscale(image, pixel_consumer, &output_context));
-            break;
-        }
-        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: {
-            SAIL_TRY(convert_from_bpp16_grayscale_alpha(image, pixel_consumer, &output_context));
-            break;
+        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE: return 8;
+
+        default: return 0;
+    }
+}
+
+/* Returns the number of bits per index of pixel formats packed with pack LUTs or 0. */
+static unsigned pack_lut_bits_per_index(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE: return 1;
+        case SAIL_PIXEL_FORMAT_BPP2_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE: return 2;
+        case SAIL_PIXEL_FORMAT_BPP4_INDEXED:
+        case SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE: return 4;
+
+        default: return 0;
+    }
+}
+
+/*
+ * Returns true if the conversion quantizes the input colors into a palette built from the whole image.
+ * Only grayscale pixels are packed into 1/2/4-bit indexed pixel formats with a palette of gray levels.
+ */
+static bool conversion_quantizes(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format) {
+
+    if (!sail_is_indexed(output_pixel_format)) {
+        return false;
+    }
+
+    return pack_lut_bits_per_index(output_pixel_format) == 0
+            || !(sail_pixel_format_properties_of(input_pixel_format)->flags & SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE);
+}
+
+/*
+ * Quantizes the image and copies the indexes back into its pixels. The rows keep their bytes per line.
+ */
+static sail_status_t update_image_by_quantizing(struct sail_image *image,
+                                                enum SailPixelFormat output_pixel_format,
+                                                const struct sail_conversion_options *options) {
+
+    struct sail_image *image_quantized;
+    SAIL_TRY(sail_quantize_image_with_options(image, output_pixel_format, 0 /* max colors */,
+                                              (options == NULL) ? SAIL_DITHER_NONE : options->dither,
+                                              options, &image_quantized));
+
+    for (unsigned row = 0; row < image->height; row++) {
+        memcpy((uint8_t *)image->pixels + (size_t)image->bytes_per_line * row,
+               (uint8_t *)image_quantized->pixels + (size_t)image_quantized->bytes_per_line * row,
+               image_quantized->bytes_per_line);
+    }
+
+    image->pixel_format = output_pixel_format;
+
+    sail_destroy_palette(image->palette);
+    image->palette = image_quantized->palette;
+    image_quantized->palette = NULL;
+
+    sail_destroy_image(image_quantized);
+
+    return SAIL_OK;
+}
+
+/*
+ * Allocates a palette of evenly spaced gray levels from black to white for 1/2/4-bit indexed pixel formats.
+ * The levels match the levels of 1/2/4-bit grayscale pixel formats.
+ */
+static sail_status_t alloc_gray_palette(enum SailPixelFormat pixel_format, struct sail_palette **palette) {
+
+    const unsigned color_count = 1U << pack_lut_bits_per_index(pixel_format);
+
+    struct sail_palette *palette_local;
+    SAIL_TRY(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, color_count, &palette_local));
+
+    uint8_t *data = palette_local->data;
+
+    for (unsigned index = 0; index < color_count; index++) {
+        const uint8_t level = (uint8_t)(index * (255 / (color_count - 1)));
+
+        *data++ = level;
+        *data++ = level;
+        *data++ = level;
+    }
+
+    *palette = palette_local;
+
+    return SAIL_OK;
+}
+
+/*
+ * Expands every palette entry (or grayscale level) into an output pixel with the same pixel consumer
+ * the generic path uses, so LUT conversions give exactly the same results.
+ */
+static sail_status_t build_palette_lut(enum SailPixelFormat input_pixel_format,
+                                       const struct sail_palette *palette,
+                                       enum SailPixelFormat output_pixel_format,
+                                       pixel_consumer_t pixel_consumer,
+                                       int r, int g, int b, int a,
+                                       const struct sail_conversion_options *options,
+                                       struct palette_lut *palette_lut) {
+
+    const unsigned bits_per_index = palette_lut_bits_per_index(input_pixel_format);
+    const unsigned max_colors = 1U << bits_per_index;
+    const bool is_indexed = sail_is_indexed(input_pixel_format);
+
+    if (is_indexed) {
+        SAIL_CHECK_PALETTE_PTR(palette);
+    }
+
+    unsigned bits_per_pixel;
+    SAIL_TRY(sail_bits_per_pixel(output_pixel_format, &bits_per_pixel));
+
+    const unsigned color_count = is_indexed ? palette->color_count : max_colors;
+    init_palette_lut(palette_lut, bits_per_index, bits_per_pixel / 8, color_count);
+
+    /* Single-row image of all the LUT pixels for the pixel consumer. */
+    struct sail_image lut_image;
+    memset(&lut_image, 0, sizeof(lut_image));
+    lut_image.pixels         = palette_lut->pixels;
+    lut_image.width          = max_colors;
+    lut_image.height         = 1;
+    lut_image.bytes_per_line = max_colors * palette_lut->bytes_per_pixel;
+    lut_image.pixel_format   = output_pixel_format;
+
+    const struct output_context output_context = { &lut_image, r, g, b, a, options };
+    sail_rgba32_t rgba32;
+
+    for (unsigned index = 0; index < max_colors && index < color_count; index++) {
+        if (is_indexed) {
+            SAIL_TRY(get_palette_rgba32(palette, index, &rgba32));
+        } else {
+            spread_gray8_to_rgba32((uint8_t)(index * (255 / (max_colors - 1))), &rgba32);
+        }
+
+        pixel_consumer(&output_context, 0, index, &rgba32, NULL);
+    }
+
+    return SAIL_OK;
+}
+
+/* The indexes MUST be validated with validate_palette_lut_rows() first. */
+static void convert_palette_lut_rows(const struct sail_image *image, struct sail_image *image_output, const struct palette_lut *palette_lut) {
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + image_output->bytes_per_line * row;
+
+        convert_palette_lut_row(palette_lut, scan_input, scan_output, image->width);
+    }
+}
+
+/*
+ * Everything needed to convert pixels that doesn't depend on the pixels themselves.
+ * Allocated on the heap by sail_alloc_conversion_plan() or on the stack by one-shot conversions.
+ */
+struct sail_conversion_plan {
+    enum SailPixelFormat input_pixel_format;
+    enum SailPixelFormat output_pixel_format;
+
+    /* Fast path: convert whole rows with a specialized kernel. */
+    convert_row_t convert_row;
+
+    /* Indexed path: convert 1/2/4/8-bit indexed or grayscale pixels with a palette LUT. */
+    struct palette_lut *palette_lut;
+
+    /* Floating point path: convert between floating point pixel formats without clamping. */
+    bool floating_point;
+
+    /*
+     * Low-bit path: threshold or dither 8-bit gray levels and pack them into 1/2/4-bit grayscale or indexed
+     * pixels with the pack LUT. Other input pixel formats are converted to BPP8-GRAYSCALE row by row
+     * with the intermediate plan first.
+     */
+    struct pack_lut *pack_lut;
+
+    /* Generic path: convert every pixel to RGBA32/RGBA64 and pass it to the pixel consumer. */
+    pixel_consumer_t pixel_consumer;
+    int r; /* Index of RED component. */
+    int g; /* Index of GREEN component. */
+    int b; /* Index of BLUE component. */
+    int a; /* Index of ALPHA component. */
+
+    /*
+     * Planar path: convert planar YUV from or to 8-bit RGB pixels described by rgb8_layout.
+     * Other pixel formats are converted from or to the intermediate pixel format row by row
+     * with the intermediate plan.
+     */
+    bool planar;
+    struct yuv_coefficients yuv_coefficients;
+    struct rgb8_layout rgb8_layout;
+    enum SailPixelFormat intermediate_pixel_format;
+    struct sail_conversion_plan *intermediate_plan;
+
+    /* Points to options_storage in allocated plans. May be NULL. */
+    const struct sail_conversion_options *options;
+    struct sail_conversion_options options_storage;
+};
+
+struct conversion_context {
+    const struct sail_conversion_plan *plan;
+    const struct sail_image *image;
+    struct sail_image *image_output;
+};
+
+static sail_status_t convert_generic(const struct sail_image *image,
+                                     struct sail_image *image_output,
+                                     pixel_consumer_t pixel_consumer,
+                                     int r, int g, int b, int a,
+                                     const struct sail_conversion_options *options) {
+
+    const struct output_context output_context = { image_output, r, g, b, a, options };
+
+    /*
+     * After adding a new input pixel format, also update the switch in sail_can_convert().
+     * 1/2/4/8-bit indexed and grayscale images are converted with palette LUTs.
+     */
+    switch (image->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE: {
+            SAIL_TRY(convert_from_bpp16_grayscale(image, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: {
+            SAIL_TRY(convert_from_bpp16_grayscale_alpha(image, pixel_consumer, &output_context));
+            break;
         }
         case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: {
             SAIL_TRY(convert_from_bpp32_grayscale_alpha(image, pixel_consumer, &output_context));
@@ -678,6 +1044,47 @@ static sail_status_t conversion_impl(
             SAIL_TRY(convert_from_bpp64_rgba_kind(image, 3, 2, 1, 0, pixel_consumer, &output_context));
             break;
         }
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_rgba_premultiplied_kind(image, 0, 1, 2, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_rgba_premultiplied_kind(image, 2, 1, 0, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_rgba_premultiplied_kind(image, 1, 2, 3, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp32_rgba_premultiplied_kind(image, 3, 2, 1, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_rgba_premultiplied_kind(image, 0, 1, 2, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_rgba_premultiplied_kind(image, 2, 1, 0, 3, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_rgba_premultiplied_kind(image, 1, 2, 3, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: {
+            SAIL_TRY(convert_from_bpp64_rgba_premultiplied_kind(image, 3, 2, 1, 0, pixel_consumer, &output_context));
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF:
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT:
+        case SAIL_PIXEL_FORMAT_BPP48_RGB_HALF:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF:
+        case SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT:
+        case SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT: {
+            SAIL_TRY(convert_from_floating_point(image, pixel_consumer, &output_context));
+            break;
+        }
         case SAIL_PIXEL_FORMAT_BPP32_CMYK: {
             SAIL_TRY(convert_from_bpp32_cmyk(image, pixel_consumer, &output_context));
             break;
@@ -699,6 +1106,367 @@ static sail_status_t conversion_impl(
     return SAIL_OK;
 }
 
+/* Converts the rows [first_row; first_row + rows). Runs in multiple threads. */
+static sail_status_t convert_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct conversion_context *conversion_context = context;
+    const struct sail_conversion_plan *plan = conversion_context->plan;
+
+    /* Shallow views of the band. They share pixels and palettes with the original images. */
+    struct sail_image image_band = *conversion_context->image;
+    image_band.pixels = (uint8_t *)image_band.pixels + (size_t)image_band.bytes_per_line * first_row;
+    image_band.height = rows;
+
+    struct sail_image image_output_band = *conversion_context->image_output;
+    image_output_band.pixels = (uint8_t *)image_output_band.pixels + (size_t)image_output_band.bytes_per_line * first_row;
+    image_output_band.height = rows;
+
+    if (plan->convert_row != NULL) {
+        convert_rows(&image_band, &image_output_band, plan->convert_row);
+        return SAIL_OK;
+    }
+
+    if (plan->palette_lut != NULL) {
+        convert_palette_lut_rows(&image_band, &image_output_band, plan->palette_lut);
+        return SAIL_OK;
+    }
+
+    if (plan->floating_point) {
+        SAIL_TRY(convert_floating_point_rows(&image_band, &image_output_band, plan->options));
+        return SAIL_OK;
+    }
+
+    SAIL_TRY(convert_generic(&image_band,
+                             &image_output_band,
+                             plan->pixel_consumer,
+                             plan->r,
+                             plan->g,
+                             plan->b,
+                             plan->a,
+                             plan->options));
+
+    return SAIL_OK;
+}
+
+/* Converts the row pairs [first_pair; first_pair + pairs) from or to a planar pixel format. Runs in multiple threads. */
+static sail_status_t convert_planar_band(void *context, unsigned first_pair, unsigned pairs) {
+
+    const struct conversion_context *conversion_context = context;
+    const struct sail_conversion_plan *plan = conversion_context->plan;
+    const struct sail_image *image = conversion_context->image;
+
+    const bool input_planar = sail_is_planar(image->pixel_format);
+    const struct sail_image *planar_image = input_planar ? image : conversion_context->image_output;
+    const struct sail_image *rgb_image = input_planar ? conversion_context->image_output : image;
+
+    struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(planar_image, planes, &planes_count));
+
+    /* Two rows of intermediate pixels. */
+    uint8_t *intermediate = NULL;
+    const unsigned intermediate_bytes_per_line = image->width * plan->rgb8_layout.bytes_per_pixel;
+
+    if (plan->intermediate_plan != NULL) {
+        void *ptr;
+        SAIL_TRY(sail_malloc((size_t)intermediate_bytes_per_line * 2, &ptr));
+        intermediate = ptr;
+    }
+
+    for (unsigned pair = first_pair; pair < first_pair + pairs; pair++) {
+        struct planar_rows rows;
+        planar_rows_of(planar_image->pixel_format, planes, pair, &rows);
+
+        /* Shallow views of the row pair. */
+        struct sail_image rgb_band = *rgb_image;
+        rgb_band.pixels = (uint8_t *)rgb_band.pixels + (size_t)rgb_band.bytes_per_line * pair * 2;
+        rgb_band.height = rows.rows;
+
+        struct sail_image intermediate_band = rgb_band;
+        intermediate_band.pixels         = intermediate;
+        intermediate_band.bytes_per_line = intermediate_bytes_per_line;
+        intermediate_band.pixel_format   = plan->intermediate_pixel_format;
+        intermediate_band.palette        = NULL;
+
+        const struct sail_image *rgb8_band = (intermediate == NULL) ? &rgb_band : &intermediate_band;
+        uint8_t *rgb8_rows[2] = {
+            rgb8_band->pixels,
+            (uint8_t *)rgb8_band->pixels + ((rows.rows == 2) ? rgb8_band->bytes_per_line : 0)
+        };
+
+        if (input_planar) {
+            planar_to_rgb8_rows(&rows, image->width, &plan->yuv_coefficients, &plan->rgb8_layout, rgb8_rows);
+
+            if (intermediate != NULL) {
+                const struct conversion_context intermediate_context = { plan->intermediate_plan, &intermediate_band, &rgb_band };
+                SAIL_TRY_OR_CLEANUP(convert_band((void *)&intermediate_context, 0, rows.rows),
+                                    /* cleanup */ sail_free(intermediate));
+            }
+        } else {
+            if (intermediate != NULL) {
+                const struct conversion_context intermediate_context = { plan->intermediate_plan, &rgb_band, &intermediate_band };
+                SAIL_TRY_OR_CLEANUP(convert_band((void *)&intermediate_context, 0, rows.rows),
+                                    /* cleanup */ sail_free(intermediate));
+            }
+
+            const uint8_t *const input_rows[2] = { rgb8_rows[0], rgb8_rows[1] };
+            rgb8_to_planar_rows(input_rows, &plan->rgb8_layout, image->width, &plan->yuv_coefficients, &rows);
+        }
+    }
+
+    sail_free(intermediate);
+
+    return SAIL_OK;
+}
+
+/* Converts the rows [first_row; first_row + rows) to a 1/2/4-bit pixel format. Runs in multiple threads. */
+static sail_status_t convert_pack_lut_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct conversion_context *conversion_context = context;
+    const struct sail_conversion_plan *plan = conversion_context->plan;
+    const struct sail_image *image = conversion_context->image;
+    const struct sail_image *image_output = conversion_context->image_output;
+
+    /* One row of intermediate gray pixels. */
+    uint8_t *gray8 = NULL;
+
+    if (plan->intermediate_plan != NULL) {
+        void *ptr;
+        SAIL_TRY(sail_malloc(image->width, &ptr));
+        gray8 = ptr;
+    }
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+
+        if (gray8 != NULL) {
+            /* Shallow views of the row. */
+            struct sail_image row_image = *image;
+            row_image.pixels = (void *)scan_input;
+            row_image.height = 1;
+
+            struct sail_image gray8_image = row_image;
+            gray8_image.pixels         = gray8;
+            gray8_image.bytes_per_line = image->width;
+            gray8_image.pixel_format   = SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE;
+            gray8_image.palette        = NULL;
+
+            const struct conversion_context intermediate_context = { plan->intermediate_plan, &row_image, &gray8_image };
+            SAIL_TRY_OR_CLEANUP(convert_band((void *)&intermediate_context, 0, 1),
+                                /* cleanup */ sail_free(gray8));
+
+            scan_input = gray8;
+        }
+
+        pack_gray8_row(plan->pack_lut, scan_input, scan_output, image->width, row);
+    }
+
+    sail_free(gray8);
+
+    return SAIL_OK;
+}
+
+/*
+ * Resolves the conversion path to a 1/2/4-bit grayscale or indexed pixel format. Input pixel formats
+ * other than BPP8-GRAYSCALE are converted to it first.
+ */
+static sail_status_t init_pack_lut_conversion_plan(const struct sail_palette *palette, struct sail_conversion_plan *plan) {
+
+    /* Planar rows are converted in pairs, so they cannot be converted to gray row by row. */
+    if (sail_is_planar(plan->input_pixel_format)) {
+        SAIL_LOG_ERROR("Conversion from %s to %s is not currently supported",
+                        sail_pixel_format_to_string(plan->input_pixel_format), sail_pixel_format_to_string(plan->output_pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const struct sail_conversion_options *options = plan->options;
+    const enum SailDither dither = (options == NULL) ? SAIL_DITHER_NONE : options->dither;
+
+    /* Rows are converted independently, so the error cannot be diffused to the next row. */
+    if (dither == SAIL_DITHER_FLOYD_STEINBERG) {
+        SAIL_LOG_DEBUG("Conversion to %s falls back to ordered dithering", sail_pixel_format_to_string(plan->output_pixel_format));
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct pack_lut), &ptr));
+    plan->pack_lut = ptr;
+
+    init_pack_lut(plan->pack_lut, pack_lut_bits_per_index(plan->output_pixel_format), dither != SAIL_DITHER_NONE);
+
+    if (plan->input_pixel_format != SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_conversion_plan(plan->input_pixel_format, palette, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+                                                       options, &plan->intermediate_plan),
+                            /* cleanup */ sail_free(plan->pack_lut),
+                                          plan->pack_lut = NULL);
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Resolves the conversion path from or to a planar pixel format. Planar pixel formats are converted
+ * from and to 8-bit RGB directly. Other pixel formats go through BPP32-RGBA, or through BPP24-RGB
+ * when alpha must be blended.
+ */
+static sail_status_t init_planar_conversion_plan(const struct sail_palette *palette, struct sail_conversion_plan *plan) {
+
+    const bool input_planar = sail_is_planar(plan->input_pixel_format);
+
+    if (input_planar == sail_is_planar(plan->output_pixel_format)) {
+        SAIL_LOG_ERROR("Conversion from %s to %s is not currently supported",
+                        sail_pixel_format_to_string(plan->input_pixel_format), sail_pixel_format_to_string(plan->output_pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    const struct sail_conversion_options *options = plan->options;
+
+    init_yuv_coefficients((options == NULL) ? SAIL_YUV_MATRIX_BT601 : options->yuv_matrix,
+                          (options == NULL) ? SAIL_YUV_RANGE_FULL : options->yuv_range,
+                          &plan->yuv_coefficients);
+
+    const enum SailPixelFormat rgb_pixel_format = input_planar ? plan->output_pixel_format : plan->input_pixel_format;
+    const bool blend_alpha = !input_planar && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA);
+
+    if (rgb8_layout_of(rgb_pixel_format, &plan->rgb8_layout) && !(blend_alpha && plan->rgb8_layout.alpha)) {
+        return SAIL_OK;
+    }
+
+    plan->intermediate_pixel_format = blend_alpha ? SAIL_PIXEL_FORMAT_BPP24_RGB : SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    rgb8_layout_of(plan->intermediate_pixel_format, &plan->rgb8_layout);
+
+    if (input_planar) {
+        SAIL_TRY(sail_alloc_conversion_plan(plan->intermediate_pixel_format, NULL, plan->output_pixel_format,
+                                            options, &plan->intermediate_plan));
+    } else {
+        SAIL_TRY(sail_alloc_conversion_plan(plan->input_pixel_format, palette, plan->intermediate_pixel_format,
+                                            options, &plan->intermediate_plan));
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Resolves the conversion path. The palette is used only if the input pixel format is indexed.
+ * The options are not copied and must outlive the plan. The plan MUST be destroyed later with destroy_conversion_plan_contents().
+ */
+static sail_status_t init_conversion_plan(enum SailPixelFormat input_pixel_format,
+                                          const struct sail_palette *palette,
+                                          enum SailPixelFormat output_pixel_format,
+                                          const struct sail_conversion_options *options,
+                                          struct sail_conversion_plan *plan) {
+
+    /* options_storage is left as is as the options may point to it. */
+    plan->input_pixel_format  = input_pixel_format;
+    plan->output_pixel_format = output_pixel_format;
+    plan->convert_row         = NULL;
+    plan->palette_lut         = NULL;
+    plan->floating_point      = false;
+    plan->pack_lut            = NULL;
+    plan->planar              = false;
+    plan->intermediate_plan   = NULL;
+    plan->options             = options;
+
+    if (pack_lut_bits_per_index(output_pixel_format) > 0) {
+        SAIL_TRY(init_pack_lut_conversion_plan(palette, plan));
+        return SAIL_OK;
+    }
+
+    if (sail_is_planar(input_pixel_format) || sail_is_planar(output_pixel_format)) {
+        plan->planar = true;
+        SAIL_TRY(init_planar_conversion_plan(palette, plan));
+        return SAIL_OK;
+    }
+
+    SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &plan->pixel_consumer, &plan->r, &plan->g, &plan->b, &plan->a));
+
+    plan->convert_row = find_conversion_kernel(input_pixel_format, output_pixel_format, options);
+
+    plan->floating_point = plan->convert_row == NULL &&
+                            sail_is_floating_point(input_pixel_format) && sail_is_floating_point(output_pixel_format);
+
+    if (plan->convert_row == NULL && palette_lut_bits_per_index(input_pixel_format) > 0) {
+        void *ptr;
+        SAIL_TRY(sail_malloc(sizeof(struct palette_lut), &ptr));
+        plan->palette_lut = ptr;
+
+        SAIL_TRY_OR_CLEANUP(build_palette_lut(input_pixel_format, palette, output_pixel_format,
+                                              plan->pixel_consumer, plan->r, plan->g, plan->b, plan->a, options,
+                                              plan->palette_lut),
+                            /* cleanup */ sail_free(plan->palette_lut),
+                                          plan->palette_lut = NULL);
+    }
+
+    return SAIL_OK;
+}
+
+static void destroy_conversion_plan_contents(struct sail_conversion_plan *plan) {
+
+    sail_free(plan->palette_lut);
+    plan->palette_lut = NULL;
+
+    sail_free(plan->pack_lut);
+    plan->pack_lut = NULL;
+
+    sail_destroy_conversion_plan(plan->intermediate_plan);
+    plan->intermediate_plan = NULL;
+}
+
+/*
+ * Validates the indexes of all the input rows converted with a palette LUT directly or through
+ * the intermediate plan. Bands are converted concurrently, so a broken image must be rejected
+ * before any band is converted. Otherwise, it could be left half converted in place.
+ */
+static sail_status_t validate_palette_lut_rows(const struct sail_image *image, const struct sail_conversion_plan *plan) {
+
+    const struct palette_lut *palette_lut = plan->palette_lut;
+
+    if (palette_lut == NULL && plan->intermediate_plan != NULL) {
+        palette_lut = plan->intermediate_plan->palette_lut;
+    }
+
+    if (palette_lut == NULL) {
+        return SAIL_OK;
+    }
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        SAIL_TRY(validate_palette_lut_row(palette_lut, scan_input, image->width));
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t conversion_impl(const struct sail_image *image,
+                                     struct sail_image *image_output,
+                                     const struct sail_conversion_plan *plan) {
+
+    const struct conversion_context conversion_context = { plan, image, image_output };
+    const unsigned threads = (plan->options == NULL) ? 1 : plan->options->threads;
+
+    SAIL_TRY(validate_palette_lut_rows(image, plan));
+
+    /* Rows of planar pixel formats with subsampled chroma depend on each other, so bands consist of row pairs. */
+    if (plan->planar) {
+        const size_t bytes_per_pair = 2 * ((size_t)image->bytes_per_line + image_output->bytes_per_line);
+
+        SAIL_TRY(process_rows_in_parallel((image->height + 1) / 2, bytes_per_pair, threads, convert_planar_band, (void *)&conversion_context));
+
+        return SAIL_OK;
+    }
+
+    /* Every output row depends on the same input row only, so bands are converted independently. */
+    const size_t bytes_per_row = (image == image_output) ? image->bytes_per_line
+                                    : (size_t)image->bytes_per_line + image_output->bytes_per_line;
+
+    SAIL_TRY(process_rows_in_parallel(image->height, bytes_per_row, threads,
+                                      (plan->pack_lut != NULL) ? convert_pack_lut_band : convert_band,
+                                      (void *)&conversion_context));
+
+    return SAIL_OK;
+}
+
 /*
  * Public functions.
  */
@@ -720,24 +1488,46 @@ sail_status_t sail_convert_image_with_options(const struct sail_image *image,
     SAIL_TRY(sail_check_image_valid(image));
     SAIL_CHECK_IMAGE_PTR(image_output);
 
-    int r, g, b, a;
-    pixel_consumer_t pixel_consumer;
-    SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &pixel_consumer, &r, &g, &b, &a));
+    if (conversion_quantizes(image->pixel_format, output_pixel_format)) {
+        SAIL_TRY(sail_quantize_image_with_options(image, output_pixel_format, 0 /* max colors */,
+                                                  (options == NULL) ? SAIL_DITHER_NONE : options->dither,
+                                                  options, image_output));
+        return SAIL_OK;
+    }
+
+    struct sail_conversion_plan plan;
+    SAIL_TRY(init_conversion_plan(image->pixel_format, image->palette, output_pixel_format, options, &plan));
 
     struct sail_image *image_local;
-    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+    SAIL_TRY_OR_CLEANUP(sail_copy_image_skeleton(image, &image_local),
+                        /* cleanup */ destroy_conversion_plan_contents(&plan));
 
     image_local->pixel_format = output_pixel_format;
 
     SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line),
-                        /* cleanup */ sail_destroy_image(image_local));
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      destroy_conversion_plan_contents(&plan));
+
+    size_t pixels_size;
+    SAIL_TRY_OR_CLEANUP(sail_image_pixels_size(image_local, &pixels_size),
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      destroy_conversion_plan_contents(&plan));
 
-    const unsigned pixels_size = image_local->height * image_local->bytes_per_line;
     SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
-                        /* cleanup */ sail_destroy_image(image_local));
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      destroy_conversion_plan_contents(&plan));
 
-    SAIL_TRY_OR_CLEANUP(conversion_impl(image, image_local, pixel_consumer, r, g, b, a, options),
-                        /* cleanup */ sail_destroy_image(image_local));
+    if (sail_is_indexed(output_pixel_format)) {
+        SAIL_TRY_OR_CLEANUP(alloc_gray_palette(output_pixel_format, &image_local->palette),
+                            /* cleanup */ sail_destroy_image(image_local),
+                                          destroy_conversion_plan_contents(&plan));
+    }
+
+    SAIL_TRY_OR_CLEANUP(conversion_impl(image, image_local, &plan),
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      destroy_conversion_plan_contents(&plan));
+
+    destroy_conversion_plan_contents(&plan);
 
     *image_output = image_local;
 
@@ -757,9 +1547,17 @@ sail_status_t sail_update_image_with_options(struct sail_image *image,
 
     SAIL_TRY(sail_check_image_valid(image));
 
-    int r, g, b, a;
-    pixel_consumer_t pixel_consumer;
-    SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &pixel_consumer, &r, &g, &b, &a));
+    if (sail_is_planar(image->pixel_format) || sail_is_planar(output_pixel_format)) {
+        SAIL_LOG_ERROR("Updating from %s to %s cannot be done as planar pixel formats cannot be converted in place",
+                        sail_pixel_format_to_string(image->pixel_format), sail_pixel_format_to_string(output_pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    if (!conversion_quantizes(image->pixel_format, output_pixel_format) && pack_lut_bits_per_index(output_pixel_format) == 0) {
+        int r, g, b, a;
+        pixel_consumer_t pixel_consumer;
+        SAIL_TRY(verify_and_construct_rgba_indexes_verbose(output_pixel_format, &pixel_consumer, &r, &g, &b, &a));
+    }
 
     if (image->pixel_format == output_pixel_format) {
         return SAIL_OK;
@@ -774,16 +1572,170 @@ sail_status_t sail_update_image_with_options(struct sail_image *image,
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
     }
 
-    SAIL_TRY(conversion_impl(image, image, pixel_consumer, r, g, b, a, options));
+    SAIL_TRY(sail_make_image_writable(image));
+
+    if (conversion_quantizes(image->pixel_format, output_pixel_format)) {
+        SAIL_TRY(update_image_by_quantizing(image, output_pixel_format, options));
+        return SAIL_OK;
+    }
+
+    struct sail_conversion_plan plan;
+    SAIL_TRY(init_conversion_plan(image->pixel_format, image->palette, output_pixel_format, options, &plan));
+
+    struct sail_palette *palette = NULL;
+
+    if (sail_is_indexed(output_pixel_format)) {
+        SAIL_TRY_OR_CLEANUP(alloc_gray_palette(output_pixel_format, &palette),
+                            /* cleanup */ destroy_conversion_plan_contents(&plan));
+    }
+
+    SAIL_TRY_OR_CLEANUP(conversion_impl(image, image, &plan),
+                        /* cleanup */ sail_destroy_palette(palette),
+                                      destroy_conversion_plan_contents(&plan));
+
+    destroy_conversion_plan_contents(&plan);
 
     image->pixel_format = output_pixel_format;
 
+    /* The input palette is expanded into the plan, so it can be replaced only now. */
+    if (palette != NULL) {
+        sail_destroy_palette(image->palette);
+        image->palette = palette;
+    }
+
     return SAIL_OK;
 }
 
+sail_status_t sail_alloc_conversion_plan(enum SailPixelFormat input_pixel_format,
+                                         const struct sail_palette *palette,
+                                         enum SailPixelFormat output_pixel_format,
+                                         const struct sail_conversion_options *options,
+                                         struct sail_conversion_plan **plan) {
+
+    SAIL_CHECK_CONVERSION_PLAN_PTR(plan);
+
+    if (!sail_can_convert(input_pixel_format, output_pixel_format)) {
+        SAIL_LOG_ERROR("Conversion from %s to %s is not currently supported",
+                        sail_pixel_format_to_string(input_pixel_format), sail_pixel_format_to_string(output_pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    if (conversion_quantizes(input_pixel_format, output_pixel_format)) {
+        SAIL_LOG_ERROR("Conversion from %s to %s quantizes whole images and cannot be planned",
+                        sail_pixel_format_to_string(input_pixel_format), sail_pixel_format_to_string(output_pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct sail_conversion_plan), &ptr));
+    struct sail_conversion_plan *plan_local = ptr;
+
+    if (options != NULL) {
+        plan_local->options_storage = *options;
+    }
+
+    SAIL_TRY_OR_CLEANUP(init_conversion_plan(input_pixel_format, palette, output_pixel_format,
+                                             (options == NULL) ? NULL : &plan_local->options_storage,
+                                             plan_local),
+                        /* cleanup */ sail_free(plan_local));
+
+    *plan = plan_local;
+
+    return SAIL_OK;
+}
+
+void sail_destroy_conversion_plan(struct sail_conversion_plan *plan) {
+
+    if (plan == NULL) {
+        return;
+    }
+
+    destroy_conversion_plan_contents(plan);
+    sail_free(plan);
+}
+
+sail_status_t sail_convert_image_with_plan(const struct sail_image *image,
+                                           const struct sail_conversion_plan *plan,
+                                           struct sail_image *image_output) {
+
+    /* The palette is already expanded into the plan. */
+    SAIL_TRY(sail_check_image_skeleton_valid(image));
+    SAIL_CHECK_PIXELS_PTR(image->pixels);
+    SAIL_CHECK_CONVERSION_PLAN_PTR(plan);
+    SAIL_TRY(sail_check_image_skeleton_valid(image_output));
+    SAIL_CHECK_PIXELS_PTR(image_output->pixels);
+
+    if (image->pixel_format != plan->input_pixel_format || image_output->pixel_format != plan->output_pixel_format) {
+        SAIL_LOG_ERROR("The conversion plan converts %s to %s, but %s to %s is requested",
+                        sail_pixel_format_to_string(plan->input_pixel_format), sail_pixel_format_to_string(plan->output_pixel_format),
+                        sail_pixel_format_to_string(image->pixel_format), sail_pixel_format_to_string(image_output->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_PIXEL_FORMAT);
+    }
+
+    if (image->width != image_output->width || image->height != image_output->height) {
+        SAIL_LOG_ERROR("The output image dimensions %ux%u don't match the input image dimensions %ux%u",
+                        image_output->width, image_output->height, image->width, image->height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    unsigned bytes_per_line;
+    SAIL_TRY(sail_bytes_per_line(image_output->width, image_output->pixel_format, &bytes_per_line));
+
+    if (image_output->bytes_per_line < bytes_per_line) {
+        SAIL_LOG_ERROR("The output image bytes per line %u is less than %u", image_output->bytes_per_line, bytes_per_line);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_BYTES_PER_LINE);
+    }
+
+    SAIL_TRY(conversion_impl(image, image_output, plan));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_alloc_conversion_palette(enum SailPixelFormat pixel_format, struct sail_palette **palette) {
+
+    SAIL_CHECK_PALETTE_PTR(palette);
+
+    if (!sail_is_indexed(pixel_format) || pack_lut_bits_per_index(pixel_format) == 0) {
+        SAIL_LOG_ERROR("Conversions don't produce palettes for %s", sail_pixel_format_to_string(pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    SAIL_TRY(alloc_gray_palette(pixel_format, palette));
+
+    return SAIL_OK;
+}
+
+bool sail_can_convert_with_plan(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format) {
+
+    return sail_can_convert(input_pixel_format, output_pixel_format) && !conversion_quantizes(input_pixel_format, output_pixel_format);
+}
+
 bool sail_can_convert(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format) {
 
-    /* After adding a new input pixel format, also update the switch in conversion_impl(). */
+    /* Color and indexed pixel formats are quantized through BPP24-RGB. */
+    if (conversion_quantizes(input_pixel_format, output_pixel_format)) {
+        return sail_can_convert(input_pixel_format, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    }
+
+    /* 1/2/4-bit pixel formats are packed from BPP8-GRAYSCALE. */
+    if (pack_lut_bits_per_index(output_pixel_format) > 0) {
+        return !sail_is_planar(input_pixel_format) && sail_can_convert(input_pixel_format, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+    }
+
+    /* Planar pixel formats are converted from and to 8-bit RGB directly or through BPP32-RGBA. */
+    if (sail_is_planar(input_pixel_format) || sail_is_planar(output_pixel_format)) {
+        struct rgb8_layout layout;
+
+        if (sail_is_planar(input_pixel_format) == sail_is_planar(output_pixel_format)) {
+            return false;
+        } else if (sail_is_planar(input_pixel_format)) {
+            return rgb8_layout_of(output_pixel_format, &layout) || sail_can_convert(SAIL_PIXEL_FORMAT_BPP32_RGBA, output_pixel_format);
+        } else {
+            return rgb8_layout_of(input_pixel_format, &layout) || sail_can_convert(input_pixel_format, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+        }
+    }
+
+    /* After adding a new input pixel format, also update the switch in convert_generic(). */
     switch (input_pixel_format) {
         case SAIL_PIXEL_FORMAT_BPP1_INDEXED:
         case SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE:
@@ -820,6 +1772,20 @@ bool sail_can_convert(enum SailPixelFormat input_pixel_format, enum SailPixelFor
         case SAIL_PIXEL_FORMAT_BPP64_BGRA:
         case SAIL_PIXEL_FORMAT_BPP64_ARGB:
         case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF:
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT:
+        case SAIL_PIXEL_FORMAT_BPP48_RGB_HALF:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF:
+        case SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT:
+        case SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT:
         case SAIL_PIXEL_FORMAT_BPP32_CMYK:
         case SAIL_PIXEL_FORMAT_BPP24_YCBCR: {
             int r, g, b, a;
@@ -832,77 +1798,53 @@ bool sail_can_convert(enum SailPixelFormat input_pixel_format, enum SailPixelFor
     }
 }
 
-/* Sorted by priority. */
-static const enum SailPixelFormat GRAYSCALE_CANDIDATES[] = {
-
-    /* After adding a new output pixel format, also update this list. */
-    SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
-    SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE,
-
-    SAIL_PIXEL_FORMAT_BPP24_YCBCR,
-
-    SAIL_PIXEL_FORMAT_BPP24_RGB,
-    SAIL_PIXEL_FORMAT_BPP24_BGR,
-
-    SAIL_PIXEL_FORMAT_BPP48_RGB,
-    SAIL_PIXEL_FORMAT_BPP48_BGR,
-
-    SAIL_PIXEL_FORMAT_BPP32_RGBA,
-    SAIL_PIXEL_FORMAT_BPP32_BGRA,
-    SAIL_PIXEL_FORMAT_BPP32_ARGB,
-    SAIL_PIXEL_FORMAT_BPP32_ABGR,
-    SAIL_PIXEL_FORMAT_BPP32_RGBX,
-    SAIL_PIXEL_FORMAT_BPP32_BGRX,
-    SAIL_PIXEL_FORMAT_BPP32_XRGB,
-    SAIL_PIXEL_FORMAT_BPP32_XBGR,
-
-    SAIL_PIXEL_FORMAT_BPP64_RGBA,
-    SAIL_PIXEL_FORMAT_BPP64_BGRA,
-    SAIL_PIXEL_FORMAT_BPP64_ARGB,
-    SAIL_PIXEL_FORMAT_BPP64_ABGR,
-    SAIL_PIXEL_FORMAT_BPP64_RGBX,
-    SAIL_PIXEL_FORMAT_BPP64_BGRX,
-    SAIL_PIXEL_FORMAT_BPP64_XRGB,
-    SAIL_PIXEL_FORMAT_BPP64_XBGR,
-};
-
-static const size_t GRAYSCALE_CANDIDATES_LENGTH = sizeof(GRAYSCALE_CANDIDATES) / sizeof(GRAYSCALE_CANDIDATES[0]);
-
-/* Sorted by priority. */
-static const enum SailPixelFormat INDEXED_OR_FULL_COLOR_CANDIDATES[] = {
-
-    /* After adding a new output pixel format, also update this list. */
-    SAIL_PIXEL_FORMAT_BPP24_YCBCR,
-
-    SAIL_PIXEL_FORMAT_BPP24_RGB,
-    SAIL_PIXEL_FORMAT_BPP24_BGR,
+/*
+ * Returns the cost of converting pixels from the input pixel format into the output pixel format.
+ * Lower is better, 0 is only possible for identical pixel formats. The cost is derived from
+ * the two pixel format properties and compares, from the most to the least significant bits:
+ *
+ *   - dropping colors, i.e. converting color pixels to grayscale
+ *   - dropping alpha
+ *   - losing channel precision, including quantizing full color pixels into a palette
+ *   - premultiplying alpha
+ *   - switching to a color model other than RGB or grayscale, e.g. YCbCr
+ *   - the output pixel size, so the narrowest of otherwise equal pixel formats wins
+ */
+static unsigned conversion_cost(const struct sail_pixel_format_properties *input_properties,
+                                const struct sail_pixel_format_properties *output_properties) {
 
-    SAIL_PIXEL_FORMAT_BPP48_RGB,
-    SAIL_PIXEL_FORMAT_BPP48_BGR,
+    const int input_flags = input_properties->flags;
+    const int output_flags = output_properties->flags;
 
-    SAIL_PIXEL_FORMAT_BPP32_RGBA,
-    SAIL_PIXEL_FORMAT_BPP32_BGRA,
-    SAIL_PIXEL_FORMAT_BPP32_ARGB,
-    SAIL_PIXEL_FORMAT_BPP32_ABGR,
-    SAIL_PIXEL_FORMAT_BPP32_RGBX,
-    SAIL_PIXEL_FORMAT_BPP32_BGRX,
-    SAIL_PIXEL_FORMAT_BPP32_XRGB,
-    SAIL_PIXEL_FORMAT_BPP32_XBGR,
+    const unsigned color_loss = !(input_flags & SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE)
+                                    && (output_flags & SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE);
+    const unsigned alpha_loss = (input_flags & SAIL_PIXEL_FORMAT_PROPERTY_ALPHA)
+                                    && !(output_flags & SAIL_PIXEL_FORMAT_PROPERTY_ALPHA);
 
-    SAIL_PIXEL_FORMAT_BPP64_RGBA,
-    SAIL_PIXEL_FORMAT_BPP64_BGRA,
-    SAIL_PIXEL_FORMAT_BPP64_ARGB,
-    SAIL_PIXEL_FORMAT_BPP64_ABGR,
-    SAIL_PIXEL_FORMAT_BPP64_RGBX,
-    SAIL_PIXEL_FORMAT_BPP64_BGRX,
-    SAIL_PIXEL_FORMAT_BPP64_XRGB,
-    SAIL_PIXEL_FORMAT_BPP64_XBGR,
+    unsigned precision_loss = input_properties->bits_per_channel > output_properties->bits_per_channel
+                                ? input_properties->bits_per_channel - output_properties->bits_per_channel
+                                : 0;
 
-    SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
-    SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE,
-};
+    /* Palettes cannot hold all the colors of full color images. */
+    if ((output_flags & SAIL_PIXEL_FORMAT_PROPERTY_INDEXED)
+            && !(input_flags & (SAIL_PIXEL_FORMAT_PROPERTY_INDEXED | SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE))) {
+        precision_loss++;
+    }
 
-static const size_t INDEXED_OR_FULL_COLOR_CANDIDATES_LENGTH = sizeof(INDEXED_OR_FULL_COLOR_CANDIDATES) / sizeof(INDEXED_OR_FULL_COLOR_CANDIDATES[0]);
+    const unsigned premultiplication = (output_flags & SAIL_PIXEL_FORMAT_PROPERTY_PREMULTIPLIED)
+                                        && !(input_flags & SAIL_PIXEL_FORMAT_PROPERTY_PREMULTIPLIED);
+    const unsigned model_change = !(output_flags & (SAIL_PIXEL_FORMAT_PROPERTY_RGB_FAMILY
+                                                    | SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE
+                                                    | SAIL_PIXEL_FORMAT_PROPERTY_INDEXED));
+
+    /* Bits per pixel fit 10 bits, precision loss fits 6 bits. */
+    return (color_loss << 19)
+            | (alpha_loss << 18)
+            | (precision_loss << 12)
+            | (premultiplication << 11)
+            | (model_change << 10)
+            | output_properties->bits_per_pixel;
+}
 
 enum SailPixelFormat sail_closest_pixel_format(enum SailPixelFormat input_pixel_format,
                                                const enum SailPixelFormat pixel_formats[],
@@ -912,36 +1854,35 @@ enum SailPixelFormat sail_closest_pixel_format(enum SailPixelFormat input_pixel_
         return SAIL_PIXEL_FORMAT_UNKNOWN;
     }
 
-    const enum SailPixelFormat *candidates;
-    size_t candidates_length;
+    const struct sail_pixel_format_properties *input_properties = sail_pixel_format_properties_of(input_pixel_format);
 
-    if (sail_is_grayscale(input_pixel_format)) {
-        candidates = GRAYSCALE_CANDIDATES;
-        candidates_length = GRAYSCALE_CANDIDATES_LENGTH;
-    } else {
-        candidates = INDEXED_OR_FULL_COLOR_CANDIDATES;
-        candidates_length = INDEXED_OR_FULL_COLOR_CANDIDATES_LENGTH;
-    }
+    enum SailPixelFormat best_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+    unsigned best_cost = UINT_MAX;
 
-    size_t best_index_candidate = UINT_MAX;
-    size_t best_index_result = 0;
-    bool found = false;
-
-    /* O(n^2) (sic!). */
+    /* O(n). Ties are resolved in favor of the pixel format listed first. */
     for (size_t i = 0; i < pixel_formats_length; i++) {
-        for (size_t k = 0; k < candidates_length; k++) {
-            if (pixel_formats[i] == candidates[k]) {
-                if (k < best_index_candidate) {
-                    best_index_candidate = k;
-                    best_index_result = i;
-                    found = true;
-                    break;
-                }
-            }
+        const enum SailPixelFormat pixel_format = pixel_formats[i];
+
+        if (pixel_format == input_pixel_format) {
+            return pixel_format;
+        }
+
+        const struct sail_pixel_format_properties *output_properties = sail_pixel_format_properties_of(pixel_format);
+
+        /* Planar pixel formats are picked only when the input pixel format is the same. */
+        if ((output_properties->flags & SAIL_PIXEL_FORMAT_PROPERTY_PLANAR) || !sail_can_convert(input_pixel_format, pixel_format)) {
+            continue;
+        }
+
+        const unsigned cost = conversion_cost(input_properties, output_properties);
+
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_pixel_format = pixel_format;
         }
     }
 
-    return found ? pixel_formats[best_index_result] : SAIL_PIXEL_FORMAT_UNKNOWN;
+    return best_pixel_format;
 }
 
 enum SailPixelFormat sail_closest_pixel_format_from_write_features(enum SailPixelFormat input_pixel_format, const struct sail_write_features *write_features) {
@@ -967,7 +1908,22 @@ sail_status_t sail_convert_image_for_saving_with_options(const struct sail_image
     SAIL_CHECK_WRITE_FEATURES_PTR(write_features);
     SAIL_CHECK_IMAGE_PTR(image_output);
 
-    enum SailPixelFormat best_pixel_format = sail_closest_pixel_format_from_write_features(image->pixel_format, write_features);
+    enum SailPixelFormat best_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+
+    if (options != NULL && (options->options & SAIL_CONVERSION_OPTION_NARROWEST_LOSSLESS) && sail_can_analyze(image->pixel_format)) {
+        struct sail_image_analysis analysis;
+        SAIL_TRY(sail_analyze_image(image, &analysis));
+
+        best_pixel_format = sail_narrowest_lossless_pixel_format(image->pixel_format,
+                                                                 &analysis,
+                                                                 write_features->output_pixel_formats,
+                                                                 write_features->output_pixel_formats_length);
+    }
+
+    /* No lossless pixel format or no analysis requested. */
+    if (best_pixel_format == SAIL_PIXEL_FORMAT_UNKNOWN) {
+        best_pixel_format = sail_closest_pixel_format_from_write_features(image->pixel_format, write_features);
+    }
 
     if (best_pixel_format == SAIL_PIXEL_FORMAT_UNKNOWN) {
         SAIL_LOG_ERROR("Failed to find the best output format for saving %s image", sail_pixel_format_to_string(image->pixel_format));
@@ -976,6 +1932,11 @@ sail_status_t sail_convert_image_for_saving_with_options(const struct sail_image
 
     if (best_pixel_format == image->pixel_format) {
         SAIL_TRY(sail_copy_image(image, image_output));
+    } else if (sail_is_indexed(best_pixel_format)) {
+        /* Images with few colors are palettized exactly. Other images keep their colors as close as possible. */
+        SAIL_TRY(sail_quantize_image_with_options(image, best_pixel_format, 0,
+                                                  (options == NULL) ? SAIL_DITHER_NONE : options->dither,
+                                                  options, image_output));
     } else {
         SAIL_TRY(sail_convert_image_with_options(image, best_pixel_format, options, image_output));
     }
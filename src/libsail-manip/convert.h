@@ -43,7 +43,9 @@ extern "C" {
 #endif
 
 struct sail_conversion_options;
+struct sail_conversion_plan;
 struct sail_image;
+struct sail_palette;
 struct sail_write_features;
 
 /*
@@ -54,9 +56,10 @@ struct sail_write_features;
  * when converting RGBA pixels to RGB. If you need to control this behavior,
  * use sail_convert_image_with_options().
  *
- * The conversion procedure may be slow. It converts every pixel into the BPP32-RGBA or
- * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
- * instructions (like AVX or SSE) are used.
+ * Common conversions (like BPP24-BGR -> BPP32-RGBA, BPP32-RGBA -> BPP32-BGRA, or 16-bit -> 8-bit)
+ * are done row by row with specialized kernels. The kernels use SSE2, SSSE3, AVX2, or NEON when the CPU
+ * supports them. Other conversions may be slow. They convert every pixel
+ * into the BPP32-RGBA or BPP64-RGBA formats first, and only then to the requested output format.
  *
  * The image ICC profile is not involved in the conversion procedure.
  *
@@ -67,9 +70,17 @@ struct sail_write_features;
  *   - Anything except LUV and LAB
  *
  * Allowed output pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE
  *
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_RGB
  *   - SAIL_PIXEL_FORMAT_BPP24_BGR
  *
@@ -94,8 +105,28 @@ struct sail_write_features;
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP48_RGB_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP12_I420
+ *   - SAIL_PIXEL_FORMAT_BPP12_NV12
+ *   - SAIL_PIXEL_FORMAT_BPP24_YUV444P
+ *
  * Returns SAIL_OK on success.
  */
 SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
@@ -108,9 +139,35 @@ SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
  *
  * Options (which may be NULL) control the conversion behavior.
  *
- * The conversion procedure may be slow. It converts every pixel into the BPP32-RGBA or
- * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
- * instructions (like AVX or SSE) are used.
+ * Common conversions (like BPP24-BGR -> BPP32-RGBA, BPP32-RGBA -> BPP32-BGRA, or 16-bit -> 8-bit)
+ * are done row by row with specialized kernels. The kernels use SSE2, SSSE3, AVX2, or NEON when the CPU
+ * supports them. Other conversions may be slow. They convert every pixel
+ * into the BPP32-RGBA or BPP64-RGBA formats first, and only then to the requested output format.
+ *
+ * Planar YUV pixel formats (like I420) are converted from and to 8-bit RGB with SSE2 when available,
+ * and from and to other pixel formats through BPP32-RGBA. options->yuv_matrix and options->yuv_range
+ * select the YUV flavor. Subsampled chroma is averaged over 2x2 blocks when converting to YUV,
+ * and replicated when converting from YUV.
+ *
+ * Premultiplied alpha pixel formats (like BPP32-RGBA-PREMULTIPLIED) are premultiplied and unpremultiplied
+ * in the same pass as the channels are reordered. Premultiplying rounds to the nearest integer: round(c*a/255).
+ * Unpremultiplying rounds to the nearest integer too: round(c*255/a). Color components of fully transparent
+ * pixels become 0. 8-bit premultiplication uses SSSE3 or AVX2 when the CPU supports them.
+ *
+ * Floating point pixel formats (like BPP128-RGBA-FLOAT) hold components normalized to [0; 1].
+ * Converting them to integer pixel formats clamps the components to this range, NaN becomes 0.
+ * Conversions between floating point pixel formats keep values outside of [0; 1]. Gray, RGB, and RGBA
+ * pixels are converted from and to 8-bit and 16-bit RGB(A) and gray with AVX2 and F16C when the CPU supports them.
+ *
+ * 1/2/4-bit grayscale pixel formats are produced from 8-bit grayscale. Other pixel formats are converted
+ * to BPP8-GRAYSCALE row by row first. The gray levels are thresholded to the nearest output level
+ * or dithered with an 8x8 Bayer matrix, see options->dither, and packed 8 pixels at a time with lookup tables.
+ * Floyd-Steinberg dithering falls back to the Bayer matrix as rows are converted independently.
+ * Grayscale images are converted to 1/2/4-bit indexed pixel formats the same way and get a palette
+ * of evenly spaced gray levels from black to white. Planar pixel formats cannot be converted to them.
+ *
+ * Other images are converted to indexed pixel formats with sail_quantize_image_with_options(), so they keep
+ * their colors as close as possible. options->dither selects the quantization dithering.
  *
  * The image ICC profile (if any) is not involved into the conversion procedure.
  *
@@ -121,9 +178,17 @@ SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
  *   - Anything except LUV and LAB
  *
  * Allowed output pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE
  *
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_RGB
  *   - SAIL_PIXEL_FORMAT_BPP24_BGR
  *
@@ -148,8 +213,28 @@ SAIL_EXPORT sail_status_t sail_convert_image(const struct sail_image *image,
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP48_RGB_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP12_I420
+ *   - SAIL_PIXEL_FORMAT_BPP12_NV12
+ *   - SAIL_PIXEL_FORMAT_BPP24_YUV444P
+ *
  * Returns SAIL_OK on success.
  */
 SAIL_EXPORT sail_status_t sail_convert_image_with_options(const struct sail_image *image,
@@ -168,21 +253,32 @@ SAIL_EXPORT sail_status_t sail_convert_image_with_options(const struct sail_imag
  * Doesn't reallocate pixels. For example, when updating 100x100 BPP32-RGBA image
  * to BPP24-RGB, the resulting pixel data will have 10'000 unused bytes at the end.
  *
- * The updating procedure may be slow. It converts every pixel into the BPP32-RGBA or
- * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
- * instructions (like AVX or SSE) are used.
+ * Common conversions (like BPP32-RGBA -> BPP32-BGRA, or 16-bit -> 8-bit) are done row by row
+ * with specialized kernels. The kernels use SSE2, SSSE3, AVX2, or NEON when the CPU supports them.
+ * Other conversions may be slow. They convert every pixel into the BPP32-RGBA
+ * or BPP64-RGBA formats first, and only then to the requested output format.
  *
  * The image ICC profile (if any) is not involved into the conversion procedure.
  *
- * The image gets updated pixel format and bytes per line. Other properties stay as is.
+ * The image gets updated pixel format and bytes per line. Grayscale images updated to 1/2/4-bit indexed
+ * pixel formats also get a palette of evenly spaced gray levels. Other images updated to indexed pixel formats
+ * are quantized into a temporary image first, and get its palette. Other properties stay as is.
  *
  * Allowed input pixel formats:
- *   - Anything that produces equal or smaller image except LUV and LAB which are not supported
+ *   - Anything that produces equal or smaller image except LUV, LAB, and planar pixel formats which are not supported
  *
  * Allowed output pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE
  *
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_RGB
  *   - SAIL_PIXEL_FORMAT_BPP24_BGR
  *
@@ -207,6 +303,22 @@ SAIL_EXPORT sail_status_t sail_convert_image_with_options(const struct sail_imag
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP48_RGB_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
  * Returns SAIL_OK on success.
@@ -222,21 +334,32 @@ SAIL_EXPORT sail_status_t sail_update_image(struct sail_image *image, enum SailP
  * Doesn't reallocate pixels. For example, when updating 100x100 BPP32-RGBA image
  * to BPP24-RGB, the resulting pixel data will have 10'000 unused bytes at the end.
  *
- * The updating procedure may be slow. It converts every pixel into the BPP32-RGBA or
- * BPP64-RGBA formats first, and only then to the requested output format. No platform-specific
- * instructions (like AVX or SSE) are used.
+ * Common conversions (like BPP32-RGBA -> BPP32-BGRA, or 16-bit -> 8-bit) are done row by row
+ * with specialized kernels. The kernels use SSE2, SSSE3, AVX2, or NEON when the CPU supports them.
+ * Other conversions may be slow. They convert every pixel into the BPP32-RGBA
+ * or BPP64-RGBA formats first, and only then to the requested output format.
  *
  * The image ICC profile (if any) is not involved into the conversion procedure.
  *
- * The image gets updated pixel format and bytes per line. Other properties stay as is.
+ * The image gets updated pixel format and bytes per line. Grayscale images updated to 1/2/4-bit indexed
+ * pixel formats also get a palette of evenly spaced gray levels. Other images updated to indexed pixel formats
+ * are quantized into a temporary image first, and get its palette. Other properties stay as is.
  *
  * Allowed input pixel formats:
- *   - Anything that produces equal or smaller image except LUV and LAB which are not supported
+ *   - Anything that produces equal or smaller image except LUV, LAB, and planar pixel formats which are not supported
  *
  * Allowed output pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
  *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE
  *
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_RGB
  *   - SAIL_PIXEL_FORMAT_BPP24_BGR
  *
@@ -261,6 +384,22 @@ SAIL_EXPORT sail_status_t sail_update_image(struct sail_image *image, enum SailP
  *   - SAIL_PIXEL_FORMAT_BPP64_ARGB
  *   - SAIL_PIXEL_FORMAT_BPP64_ABGR
  *
+ *   - SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED
+ *   - SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED
+ *
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP48_RGB_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF
+ *   - SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT
+ *   - SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT
+ *
  *   - SAIL_PIXEL_FORMAT_BPP24_YCBCR
  *
  * Returns SAIL_OK on success.
@@ -269,15 +408,90 @@ SAIL_EXPORT sail_status_t sail_update_image_with_options(struct sail_image *imag
                                                          enum SailPixelFormat output_pixel_format,
                                                          const struct sail_conversion_options *options);
 
+/*
+ * Allocates a new conversion plan to convert images from the input pixel format to the output
+ * pixel format many times. The plan resolves everything that doesn't depend on the pixels once:
+ * the row kernel, palette lookup tables, and the conversion options. Use it to convert animation
+ * frames or batches of images of the same pixel format. The plan MUST be destroyed later
+ * with sail_destroy_conversion_plan().
+ *
+ * The palette must be specified if the input pixel format is indexed. It's expanded into
+ * the plan, so the palette may be destroyed after the plan is allocated. Images converted
+ * with the plan must use the same palette. Their palettes are not checked.
+ *
+ * Options (which may be NULL) are copied into the plan.
+ *
+ * Allowed input and output pixel formats are the same as in sail_convert_image_with_options(),
+ * except for conversions that quantize whole images into indexed pixel formats, see sail_can_convert_with_plan().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_conversion_plan(enum SailPixelFormat input_pixel_format,
+                                                     const struct sail_palette *palette,
+                                                     enum SailPixelFormat output_pixel_format,
+                                                     const struct sail_conversion_options *options,
+                                                     struct sail_conversion_plan **plan);
+
+/*
+ * Destroys the specified conversion plan and all its internal allocated memory buffers.
+ * The plan MUST NOT be used anymore after calling this function. Does nothing if the plan is NULL.
+ */
+SAIL_EXPORT void sail_destroy_conversion_plan(struct sail_conversion_plan *plan);
+
+/*
+ * Converts the input image with the plan and saves the result in the output image allocated
+ * by the caller. Doesn't allocate memory except two intermediate rows per band when converting
+ * planar pixel formats from or to pixel formats other than 8-bit RGB, and one BPP8-GRAYSCALE row per band
+ * when converting pixel formats other than BPP8-GRAYSCALE to 1/2/4-bit pixel formats. If the plan options request multiple threads,
+ * they are started for every call.
+ *
+ * The input image must have the plan input pixel format. The output image must have the plan
+ * output pixel format, the same dimensions as the input image, enough bytes per line, and
+ * allocated pixels that don't overlap the input pixels. Only the output pixels are updated.
+ * Other output image properties like the palette or meta data are left untouched. 1/2/4-bit indexed
+ * output pixels are packed from grayscale input pixels and index evenly spaced gray levels from black to white. Use sail_alloc_conversion_palette()
+ * to allocate their palette.
+ *
+ * The plan is not modified, so it can be used from multiple threads simultaneously.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_convert_image_with_plan(const struct sail_image *image,
+                                                       const struct sail_conversion_plan *plan,
+                                                       struct sail_image *image_output);
+
+/*
+ * Allocates the palette of evenly spaced gray levels from black to white that the conversion
+ * and updating functions attach to 1/2/4-bit indexed output images converted from grayscale images,
+ * and that conversion plans produce indexes into. The palette MUST be destroyed
+ * later with sail_destroy_palette().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_conversion_palette(enum SailPixelFormat pixel_format, struct sail_palette **palette);
+
 /*
  * Returns true if the conversion or updating functions can convert or update from the input
  * pixel format to the output pixel format.
  */
 SAIL_EXPORT bool sail_can_convert(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format);
 
+/*
+ * Returns true if a conversion plan can convert from the input pixel format to the output pixel format.
+ * Unlike sail_can_convert(), returns false for conversions that quantize color or indexed images
+ * into indexed pixel formats as they build the palette from the whole image.
+ */
+SAIL_EXPORT bool sail_can_convert_with_plan(enum SailPixelFormat input_pixel_format, enum SailPixelFormat output_pixel_format);
+
 /*
  * Returns the closest pixel format to the input pixel format from the list.
  *
+ * The input pixel format itself is always the best choice. Otherwise, only pixel formats
+ * the input can be converted into with sail_can_convert() are considered, planar pixel formats excluded.
+ * They are ranked by what the conversion loses, from the worst to the least important: colors, alpha,
+ * channel precision, premultiplied alpha, the RGB or grayscale color model, and, finally, by the output
+ * pixel size. Ties are resolved in favor of the pixel format listed first.
+ *
  * This function can be used to find the best pixel format to save an image into.
  *
  * Returns SAIL_PIXEL_FORMAT_UNKNOWN if no candidates found at all.
@@ -310,7 +524,9 @@ SAIL_EXPORT sail_status_t sail_convert_image_for_saving(const struct sail_image
  * Converts the image to be suitable for saving in the output format described by the write features
  * (from the appropriate codec info).
  *
- * Options (which may be NULL) control the conversion behavior.
+ * Options (which may be NULL) control the conversion behavior. With SAIL_CONVERSION_OPTION_NARROWEST_LOSSLESS,
+ * the image is analyzed first and converted to the narrowest pixel format that keeps all its information,
+ * see sail_narrowest_lossless_pixel_format().
  *
  * Returns SAIL_OK on success.
  */
@@ -0,0 +1,841 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-manip.h"
+
+/*
+ * Kernel weights are stored in fixed point with 14 fractional bits like the scaling weights.
+ */
+#define WEIGHT_BITS 14
+#define WEIGHT_ONE (1 << WEIGHT_BITS)
+#define WEIGHT_HALF (1 << (WEIGHT_BITS - 1))
+
+#define MAX_KERNEL_SIZE 2001
+#define MAX_KERNEL_RADIUS (MAX_KERNEL_SIZE / 2)
+
+/* Keeps the sums of 8-bit samples multiplied by the weights in int32. */
+#define MAX_KERNEL_MAGNITUDE 64.0
+
+#define MAX_GAUSSIAN_SIGMA 333.0
+#define MAX_UNSHARP_AMOUNT 16.0
+
+/*
+ * Number of samples filtered at once. Keeps the sums in L1 while the kernel taps are added.
+ */
+#define TILE_SAMPLES 2048
+
+/*
+ * Kernels.
+ */
+
+struct convolution_kernel {
+    /* Fixed-point weights. NULL for box filters that average 'size' pixels. */
+    int32_t *weights;
+    unsigned size;
+    unsigned radius;
+};
+
+static void destroy_convolution_kernel(struct convolution_kernel *kernel) {
+
+    sail_free(kernel->weights);
+    kernel->weights = NULL;
+}
+
+static sail_status_t make_convolution_kernel(const double *coefficients, unsigned size, struct convolution_kernel *kernel) {
+
+    SAIL_CHECK_PTR(coefficients);
+
+    if (size % 2 == 0 || size > MAX_KERNEL_SIZE) {
+        SAIL_LOG_ERROR("Kernel size must be odd and not greater than %u, but it's %u", MAX_KERNEL_SIZE, size);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    double sum = 0;
+    double magnitude = 0;
+
+    for (unsigned i = 0; i < size; i++) {
+        sum += coefficients[i];
+        magnitude += fabs(coefficients[i]);
+    }
+
+    /* Also catches NaNs and infinities. */
+    if (!(magnitude <= MAX_KERNEL_MAGNITUDE)) {
+        SAIL_LOG_ERROR("Sum of the absolute kernel coefficients must not exceed %.0f", MAX_KERNEL_MAGNITUDE);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(int32_t) * size, &ptr));
+    int32_t *weights = ptr;
+
+    int64_t fixed_sum = 0;
+
+    for (unsigned i = 0; i < size; i++) {
+        weights[i] = (int32_t)lround(coefficients[i] * WEIGHT_ONE);
+        fixed_sum += weights[i];
+    }
+
+    /* Rounding errors go to the center weight, so the fixed-point kernel has the same sum. */
+    weights[size / 2] += (int32_t)(llround(sum * WEIGHT_ONE) - fixed_sum);
+
+    kernel->weights = weights;
+    kernel->size    = size;
+    kernel->radius  = size / 2;
+
+    return SAIL_OK;
+}
+
+static sail_status_t make_gaussian_kernel(double sigma, struct convolution_kernel *kernel) {
+
+    if (!(sigma > 0 && sigma <= MAX_GAUSSIAN_SIGMA)) {
+        SAIL_LOG_ERROR("Gaussian sigma must be in the range (0; %.0f]", MAX_GAUSSIAN_SIGMA);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    const unsigned radius = (unsigned)ceil(3 * sigma);
+    const unsigned size = radius * 2 + 1;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(double) * size, &ptr));
+    double *coefficients = ptr;
+
+    double sum = 0;
+
+    for (unsigned i = 0; i < size; i++) {
+        const double x = (double)i - radius;
+        coefficients[i] = exp(-x * x / (2 * sigma * sigma));
+        sum += coefficients[i];
+    }
+
+    for (unsigned i = 0; i < size; i++) {
+        coefficients[i] /= sum;
+    }
+
+    SAIL_TRY_OR_CLEANUP(make_convolution_kernel(coefficients, size, kernel),
+                        /* cleanup */ sail_free(coefficients));
+
+    sail_free(coefficients);
+
+    return SAIL_OK;
+}
+
+static sail_status_t make_box_kernel(unsigned radius, struct convolution_kernel *kernel) {
+
+    if (radius > MAX_KERNEL_RADIUS) {
+        SAIL_LOG_ERROR("Box filter radius must not exceed %u", MAX_KERNEL_RADIUS);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    kernel->weights = NULL;
+    kernel->size    = radius * 2 + 1;
+    kernel->radius  = radius;
+
+    return SAIL_OK;
+}
+
+/*
+ * Edges.
+ */
+
+/* Maps an index outside of [0; size) to an index inside. Returns -1 for zeros. */
+static int64_t map_index(int64_t index, unsigned size, enum SailEdgeMode edge_mode) {
+
+    if (index >= 0 && index < size) {
+        return index;
+    }
+
+    switch (edge_mode) {
+        case SAIL_EDGE_MODE_CLAMP: {
+            return (index < 0) ? 0 : size - 1;
+        }
+        case SAIL_EDGE_MODE_MIRROR: {
+            if (size == 1) {
+                return 0;
+            }
+
+            const int64_t period = 2 * (int64_t)size - 2;
+            int64_t mapped = index % period;
+
+            if (mapped < 0) {
+                mapped += period;
+            }
+
+            return (mapped < size) ? mapped : period - mapped;
+        }
+        case SAIL_EDGE_MODE_WRAP: {
+            int64_t mapped = index % size;
+
+            return (mapped < 0) ? mapped + size : mapped;
+        }
+        default: {
+            return -1;
+        }
+    }
+}
+
+static void pad_pixel(const uint8_t *input, uint8_t *output, int64_t index, unsigned width, size_t pixel_size,
+                      enum SailEdgeMode edge_mode) {
+
+    const int64_t mapped = map_index(index, width, edge_mode);
+
+    if (mapped < 0) {
+        memset(output, 0, pixel_size);
+    } else {
+        memcpy(output, input + (size_t)mapped * pixel_size, pixel_size);
+    }
+}
+
+/* Copies the row with 'radius' pixels of the edges on both sides. */
+static void pad_row(const uint8_t *input, uint8_t *padded, unsigned width, unsigned radius, size_t pixel_size,
+                    enum SailEdgeMode edge_mode) {
+
+    memcpy(padded + radius * pixel_size, input, width * pixel_size);
+
+    for (unsigned i = 0; i < radius; i++) {
+        pad_pixel(input, padded + i * pixel_size, (int64_t)i - radius, width, pixel_size, edge_mode);
+        pad_pixel(input, padded + ((size_t)radius + width + i) * pixel_size, (int64_t)width + i, width, pixel_size, edge_mode);
+    }
+}
+
+/*
+ * Filtering. Accumulators start from a half to round to the nearest. Negative weights
+ * may produce values out of range, so they're clamped.
+ */
+
+static inline uint8_t clamp8(int32_t value) {
+
+    return (value < 0) ? 0 : (value >> WEIGHT_BITS) > 255 ? 255 : (uint8_t)(value >> WEIGHT_BITS);
+}
+
+static inline uint16_t clamp16(int64_t value) {
+
+    return (value < 0) ? 0 : (value >> WEIGHT_BITS) > 65535 ? 65535 : (uint16_t)(value >> WEIGHT_BITS);
+}
+
+/*
+ * Adds the tap rows multiplied by their weights sample by sample, so the inner loops are vectorized
+ * by compilers. The horizontal pass passes the same padded row shifted by one pixel per tap.
+ * NULL taps are zeros.
+ */
+static void convolve_samples8(const uint8_t *const *taps, const int32_t *weights, unsigned count,
+                              uint8_t *output, unsigned samples, int32_t *sums) {
+
+    for (unsigned tile = 0; tile < samples; tile += TILE_SAMPLES) {
+        const unsigned tile_samples = (samples - tile < TILE_SAMPLES) ? samples - tile : TILE_SAMPLES;
+
+        for (unsigned s = 0; s < tile_samples; s++) {
+            sums[s] = WEIGHT_HALF;
+        }
+
+        for (unsigned i = 0; i < count; i++) {
+            if (taps[i] == NULL) {
+                continue;
+            }
+
+            const int32_t weight = weights[i];
+            const uint8_t *input = taps[i] + tile;
+
+            for (unsigned s = 0; s < tile_samples; s++) {
+                sums[s] += weight * input[s];
+            }
+        }
+
+        for (unsigned s = 0; s < tile_samples; s++) {
+            output[tile + s] = clamp8(sums[s]);
+        }
+    }
+}
+
+static void convolve_samples16(const uint8_t *const *taps, const int32_t *weights, unsigned count,
+                               uint16_t *output, unsigned samples, int64_t *sums) {
+
+    for (unsigned tile = 0; tile < samples; tile += TILE_SAMPLES) {
+        const unsigned tile_samples = (samples - tile < TILE_SAMPLES) ? samples - tile : TILE_SAMPLES;
+
+        for (unsigned s = 0; s < tile_samples; s++) {
+            sums[s] = WEIGHT_HALF;
+        }
+
+        for (unsigned i = 0; i < count; i++) {
+            if (taps[i] == NULL) {
+                continue;
+            }
+
+            const int64_t weight = weights[i];
+            const uint16_t *input = (const uint16_t *)taps[i] + tile;
+
+            for (unsigned s = 0; s < tile_samples; s++) {
+                sums[s] += weight * input[s];
+            }
+        }
+
+        for (unsigned s = 0; s < tile_samples; s++) {
+            output[tile + s] = clamp16(sums[s]);
+        }
+    }
+}
+
+static void convolve_samples(const uint8_t *const *taps, const int32_t *weights, unsigned count,
+                             void *output, unsigned samples, void *sums, unsigned bytes_per_sample) {
+
+    if (bytes_per_sample == 1) {
+        convolve_samples8(taps, weights, count, output, samples, sums);
+    } else {
+        convolve_samples16(taps, weights, count, output, samples, sums);
+    }
+}
+
+/*
+ * Box filters slide a window over the pixels: every step adds the entering pixel to the sums
+ * and subtracts the leaving one. The sums fit uint32 as the window has up to 2001 pixels.
+ */
+#define DEFINE_BOX_ROW(name, type)                                                                  \
+static void name(const type *padded, type *output, unsigned width, unsigned channels, unsigned size) { \
+                                                                                                    \
+    uint32_t sums[4] = { 0, 0, 0, 0 };                                                              \
+                                                                                                    \
+    for (unsigned i = 0; i < size; i++) {                                                           \
+        for (unsigned c = 0; c < channels; c++) {                                                   \
+            sums[c] += padded[i * channels + c];                                                    \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    for (unsigned column = 0; column < width; column++) {                                           \
+        const type *leaving = padded + (size_t)column * channels;                                   \
+        const type *entering = leaving + (size_t)size * channels;                                   \
+                                                                                                    \
+        for (unsigned c = 0; c < channels; c++) {                                                   \
+            *output++ = (type)((sums[c] + size / 2) / size);                                        \
+        }                                                                                           \
+                                                                                                    \
+        if (column + 1 < width) {                                                                   \
+            for (unsigned c = 0; c < channels; c++) {                                               \
+                sums[c] = sums[c] + entering[c] - leaving[c];                                       \
+            }                                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+}
+
+DEFINE_BOX_ROW(box_row8,  uint8_t)
+DEFINE_BOX_ROW(box_row16, uint16_t)
+
+/* Adds (sign > 0) or subtracts a row from the column sums. NULL rows are zeros. */
+static void accumulate_row(const uint8_t *row, uint32_t *sums, unsigned samples, unsigned bytes_per_sample, int sign) {
+
+    if (row == NULL) {
+        return;
+    }
+
+    if (bytes_per_sample == 1) {
+        if (sign > 0) {
+            for (unsigned s = 0; s < samples; s++) {
+                sums[s] += row[s];
+            }
+        } else {
+            for (unsigned s = 0; s < samples; s++) {
+                sums[s] -= row[s];
+            }
+        }
+    } else {
+        const uint16_t *row16 = (const uint16_t *)row;
+
+        if (sign > 0) {
+            for (unsigned s = 0; s < samples; s++) {
+                sums[s] += row16[s];
+            }
+        } else {
+            for (unsigned s = 0; s < samples; s++) {
+                sums[s] -= row16[s];
+            }
+        }
+    }
+}
+
+static void average_row(const uint32_t *sums, void *output, unsigned samples, unsigned bytes_per_sample, unsigned size) {
+
+    if (bytes_per_sample == 1) {
+        uint8_t *output8 = output;
+
+        for (unsigned s = 0; s < samples; s++) {
+            output8[s] = (uint8_t)((sums[s] + size / 2) / size);
+        }
+    } else {
+        uint16_t *output16 = output;
+
+        for (unsigned s = 0; s < samples; s++) {
+            output16[s] = (uint16_t)((sums[s] + size / 2) / size);
+        }
+    }
+}
+
+/*
+ * Convolution.
+ */
+
+struct convolve_context {
+    const struct sail_image *image;
+    struct sail_image *image_output;
+    struct sample_layout layout;
+    enum SailEdgeMode edge_mode;
+
+    struct convolution_kernel horizontal;
+    struct convolution_kernel vertical;
+
+    /* Horizontally filtered rows with unpacked samples. */
+    uint8_t *intermediate;
+    size_t intermediate_stride;
+};
+
+static const uint8_t* intermediate_row(const struct convolve_context *convolve_context, int64_t row) {
+
+    const int64_t mapped = map_index(row, convolve_context->image->height, convolve_context->edge_mode);
+
+    return (mapped < 0) ? NULL : convolve_context->intermediate + convolve_context->intermediate_stride * (size_t)mapped;
+}
+
+static sail_status_t convolve_band_horizontal(void *context, unsigned first_row, unsigned rows) {
+
+    const struct convolve_context *convolve_context = context;
+    const struct sail_image *image = convolve_context->image;
+    const struct sample_layout *layout = &convolve_context->layout;
+    const struct convolution_kernel *kernel = &convolve_context->horizontal;
+    const bool packed = layout->packed_bits[0] > 0;
+
+    const unsigned samples = image->width * layout->channels;
+    const size_t pixel_size = (size_t)layout->channels * layout->bytes_per_sample;
+
+    /* Sums, taps, the padded row, and the unpacked row. */
+    const size_t sums_size = sizeof(int64_t) * TILE_SAMPLES;
+    const size_t taps_size = sizeof(uint8_t *) * kernel->size;
+    const size_t padded_size = ((size_t)image->width + kernel->radius * 2) * pixel_size;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sums_size + taps_size + padded_size + (packed ? samples : 0), &ptr));
+
+    void *sums = ptr;
+    const uint8_t **taps = (const uint8_t **)((uint8_t *)ptr + sums_size);
+    uint8_t *padded = (uint8_t *)ptr + sums_size + taps_size;
+    uint8_t *unpacked = padded + padded_size;
+
+    for (unsigned i = 0; i < kernel->size; i++) {
+        taps[i] = padded + i * pixel_size;
+    }
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *scan_input = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+        uint8_t *scan_output = convolve_context->intermediate + convolve_context->intermediate_stride * row;
+
+        if (packed) {
+            unpack_packed_row((const uint16_t *)scan_input, unpacked, image->width, layout->packed_bits);
+            scan_input = unpacked;
+        }
+
+        pad_row(scan_input, padded, image->width, kernel->radius, pixel_size, convolve_context->edge_mode);
+
+        if (kernel->weights == NULL) {
+            if (layout->bytes_per_sample == 1) {
+                box_row8(padded, scan_output, image->width, layout->channels, kernel->size);
+            } else {
+                box_row16((const uint16_t *)padded, (uint16_t *)scan_output, image->width, layout->channels, kernel->size);
+            }
+        } else {
+            convolve_samples(taps, kernel->weights, kernel->size, scan_output, samples, sums, layout->bytes_per_sample);
+        }
+    }
+
+    sail_free(ptr);
+
+    return SAIL_OK;
+}
+
+static sail_status_t convolve_band_vertical(void *context, unsigned first_row, unsigned rows) {
+
+    const struct convolve_context *convolve_context = context;
+    const struct sail_image *image_output = convolve_context->image_output;
+    const struct sample_layout *layout = &convolve_context->layout;
+    const struct convolution_kernel *kernel = &convolve_context->vertical;
+    const bool packed = layout->packed_bits[0] > 0;
+    const bool box = kernel->weights == NULL;
+
+    const unsigned samples = image_output->width * layout->channels;
+
+    /* Sums, taps, and the unpacked row. Box filters keep the sums of whole rows. */
+    const size_t sums_size = box ? sizeof(uint32_t) * samples : sizeof(int64_t) * TILE_SAMPLES;
+    const size_t taps_size = box ? 0 : sizeof(uint8_t *) * kernel->size;
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sums_size + taps_size + (packed ? samples : 0), &ptr));
+
+    void *sums = ptr;
+    const uint8_t **taps = (const uint8_t **)((uint8_t *)ptr + sums_size);
+    uint8_t *unpacked = (uint8_t *)ptr + sums_size + taps_size;
+
+    if (box) {
+        memset(sums, 0, sums_size);
+
+        for (unsigned i = 0; i < kernel->size; i++) {
+            accumulate_row(intermediate_row(convolve_context, (int64_t)first_row + i - kernel->radius),
+                           sums, samples, layout->bytes_per_sample, 1);
+        }
+    }
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+        void *output = packed ? unpacked : scan_output;
+
+        if (box) {
+            average_row(sums, output, samples, layout->bytes_per_sample, kernel->size);
+
+            if (row + 1 < first_row + rows) {
+                accumulate_row(intermediate_row(convolve_context, (int64_t)row + kernel->radius + 1),
+                               sums, samples, layout->bytes_per_sample, 1);
+                accumulate_row(intermediate_row(convolve_context, (int64_t)row - kernel->radius),
+                               sums, samples, layout->bytes_per_sample, -1);
+            }
+        } else {
+            for (unsigned i = 0; i < kernel->size; i++) {
+                taps[i] = intermediate_row(convolve_context, (int64_t)row + i - kernel->radius);
+            }
+
+            convolve_samples(taps, kernel->weights, kernel->size, output, samples, sums, layout->bytes_per_sample);
+        }
+
+        if (packed) {
+            pack_packed_row(unpacked, (uint16_t *)scan_output, image_output->width, layout->packed_bits);
+        }
+    }
+
+    sail_free(ptr);
+
+    return SAIL_OK;
+}
+
+static sail_status_t check_convolution_input(const struct sail_image *image, enum SailEdgeMode edge_mode,
+                                             struct sail_image **image_output, struct sample_layout *layout) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_IMAGE_PTR(image_output);
+
+    if (!sample_layout(image->pixel_format, layout)) {
+        SAIL_LOG_ERROR("Filtering %s images is not currently supported", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    switch (edge_mode) {
+        case SAIL_EDGE_MODE_CLAMP:
+        case SAIL_EDGE_MODE_MIRROR:
+        case SAIL_EDGE_MODE_WRAP:
+        case SAIL_EDGE_MODE_ZERO: {
+            return SAIL_OK;
+        }
+        default: {
+            SAIL_LOG_ERROR("Unknown edge mode %d", edge_mode);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+    }
+}
+
+static sail_status_t convolve_impl(const struct sail_image *image, const struct sample_layout *layout,
+                                   const struct convolution_kernel *horizontal, const struct convolution_kernel *vertical,
+                                   enum SailEdgeMode edge_mode, unsigned threads, struct sail_image **image_output) {
+
+    struct convolve_context convolve_context;
+    memset(&convolve_context, 0, sizeof(convolve_context));
+
+    convolve_context.image      = image;
+    convolve_context.layout     = *layout;
+    convolve_context.edge_mode  = edge_mode;
+    convolve_context.horizontal = *horizontal;
+    convolve_context.vertical   = *vertical;
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+
+    SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc((size_t)image_local->bytes_per_line * image_local->height, &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    convolve_context.image_output        = image_local;
+    convolve_context.intermediate_stride = (size_t)image->width * layout->channels * layout->bytes_per_sample;
+
+    void *intermediate;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(convolve_context.intermediate_stride * image->height, &intermediate),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    convolve_context.intermediate = intermediate;
+
+    SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(image->height, image->bytes_per_line + convolve_context.intermediate_stride,
+                                                 threads, convolve_band_horizontal, &convolve_context),
+                        /* cleanup */ sail_free(intermediate),
+                                      sail_destroy_image(image_local));
+
+    const unsigned vertical_rows_read = (vertical->weights == NULL) ? 2 : vertical->size;
+
+    SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(image->height,
+                                                 image_local->bytes_per_line + convolve_context.intermediate_stride * vertical_rows_read,
+                                                 threads, convolve_band_vertical, &convolve_context),
+                        /* cleanup */ sail_free(intermediate),
+                                      sail_destroy_image(image_local));
+
+    sail_free(intermediate);
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
+
+/*
+ * Unsharp mask.
+ */
+
+struct unsharp_context {
+    const struct sail_image *image;
+    struct sail_image *image_output;
+    struct sample_layout layout;
+
+    /* Fixed-point amount. */
+    int64_t amount;
+};
+
+static void unsharp_samples8(const uint8_t *input, uint8_t *blurred, unsigned samples, int32_t amount) {
+
+    for (unsigned s = 0; s < samples; s++) {
+        blurred[s] = clamp8(input[s] * (WEIGHT_ONE + amount) - blurred[s] * amount + WEIGHT_HALF);
+    }
+}
+
+static void unsharp_samples16(const uint16_t *input, uint16_t *blurred, unsigned samples, int64_t amount) {
+
+    for (unsigned s = 0; s < samples; s++) {
+        blurred[s] = clamp16(input[s] * (WEIGHT_ONE + amount) - blurred[s] * amount + WEIGHT_HALF);
+    }
+}
+
+/* Replaces the blurred output pixels with the sharpened ones. */
+static sail_status_t unsharp_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct unsharp_context *unsharp_context = context;
+    const struct sail_image *image = unsharp_context->image;
+    const struct sail_image *image_output = unsharp_context->image_output;
+    const struct sample_layout *layout = &unsharp_context->layout;
+    const bool packed = layout->packed_bits[0] > 0;
+
+    const unsigned samples = image->width * layout->channels;
+
+    uint8_t *unpacked = NULL;
+
+    if (packed) {
+        void *ptr;
+        SAIL_TRY(sail_malloc((size_t)samples * 2, &ptr));
+        unpacked = ptr;
+    }
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *scan_input = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+
+        if (packed) {
+            unpack_packed_row((const uint16_t *)scan_input, unpacked, image->width, layout->packed_bits);
+            unpack_packed_row((const uint16_t *)scan_output, unpacked + samples, image->width, layout->packed_bits);
+            unsharp_samples8(unpacked, unpacked + samples, samples, (int32_t)unsharp_context->amount);
+            pack_packed_row(unpacked + samples, (uint16_t *)scan_output, image->width, layout->packed_bits);
+        } else if (layout->bytes_per_sample == 1) {
+            unsharp_samples8(scan_input, scan_output, samples, (int32_t)unsharp_context->amount);
+        } else {
+            unsharp_samples16((const uint16_t *)scan_input, (uint16_t *)scan_output, samples, unsharp_context->amount);
+        }
+    }
+
+    sail_free(unpacked);
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_convolve_image(const struct sail_image *image,
+                                  const double *horizontal_kernel,
+                                  unsigned horizontal_size,
+                                  const double *vertical_kernel,
+                                  unsigned vertical_size,
+                                  struct sail_image **image_output) {
+
+    SAIL_TRY(sail_convolve_image_with_options(image, horizontal_kernel, horizontal_size, vertical_kernel, vertical_size,
+                                              SAIL_EDGE_MODE_CLAMP, NULL /* options */, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_convolve_image_with_options(const struct sail_image *image,
+                                               const double *horizontal_kernel,
+                                               unsigned horizontal_size,
+                                               const double *vertical_kernel,
+                                               unsigned vertical_size,
+                                               enum SailEdgeMode edge_mode,
+                                               const struct sail_conversion_options *options,
+                                               struct sail_image **image_output) {
+
+    struct sample_layout layout;
+    SAIL_TRY(check_convolution_input(image, edge_mode, image_output, &layout));
+
+    struct convolution_kernel horizontal;
+    SAIL_TRY(make_convolution_kernel(horizontal_kernel, horizontal_size, &horizontal));
+
+    struct convolution_kernel vertical;
+    SAIL_TRY_OR_CLEANUP(make_convolution_kernel(vertical_kernel, vertical_size, &vertical),
+                        /* cleanup */ destroy_convolution_kernel(&horizontal));
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY_OR_CLEANUP(convolve_impl(image, &layout, &horizontal, &vertical, edge_mode, threads, image_output),
+                        /* cleanup */ destroy_convolution_kernel(&vertical),
+                                      destroy_convolution_kernel(&horizontal));
+
+    destroy_convolution_kernel(&vertical);
+    destroy_convolution_kernel(&horizontal);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_gaussian_blur_image(const struct sail_image *image,
+                                       double sigma,
+                                       struct sail_image **image_output) {
+
+    SAIL_TRY(sail_gaussian_blur_image_with_options(image, sigma, SAIL_EDGE_MODE_CLAMP, NULL /* options */, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_gaussian_blur_image_with_options(const struct sail_image *image,
+                                                    double sigma,
+                                                    enum SailEdgeMode edge_mode,
+                                                    const struct sail_conversion_options *options,
+                                                    struct sail_image **image_output) {
+
+    struct sample_layout layout;
+    SAIL_TRY(check_convolution_input(image, edge_mode, image_output, &layout));
+
+    struct convolution_kernel kernel;
+    SAIL_TRY(make_gaussian_kernel(sigma, &kernel));
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY_OR_CLEANUP(convolve_impl(image, &layout, &kernel, &kernel, edge_mode, threads, image_output),
+                        /* cleanup */ destroy_convolution_kernel(&kernel));
+
+    destroy_convolution_kernel(&kernel);
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_box_blur_image(const struct sail_image *image,
+                                  unsigned radius,
+                                  struct sail_image **image_output) {
+
+    SAIL_TRY(sail_box_blur_image_with_options(image, radius, SAIL_EDGE_MODE_CLAMP, NULL /* options */, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_box_blur_image_with_options(const struct sail_image *image,
+                                               unsigned radius,
+                                               enum SailEdgeMode edge_mode,
+                                               const struct sail_conversion_options *options,
+                                               struct sail_image **image_output) {
+
+    struct sample_layout layout;
+    SAIL_TRY(check_convolution_input(image, edge_mode, image_output, &layout));
+
+    struct convolution_kernel kernel;
+    SAIL_TRY(make_box_kernel(radius, &kernel));
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY(convolve_impl(image, &layout, &kernel, &kernel, edge_mode, threads, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_unsharp_mask_image(const struct sail_image *image,
+                                      double sigma,
+                                      double amount,
+                                      struct sail_image **image_output) {
+
+    SAIL_TRY(sail_unsharp_mask_image_with_options(image, sigma, amount, SAIL_EDGE_MODE_CLAMP, NULL /* options */, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_unsharp_mask_image_with_options(const struct sail_image *image,
+                                                   double sigma,
+                                                   double amount,
+                                                   enum SailEdgeMode edge_mode,
+                                                   const struct sail_conversion_options *options,
+                                                   struct sail_image **image_output) {
+
+    struct sample_layout layout;
+    SAIL_TRY(check_convolution_input(image, edge_mode, image_output, &layout));
+
+    if (!(amount >= 0 && amount <= MAX_UNSHARP_AMOUNT)) {
+        SAIL_LOG_ERROR("Unsharp mask amount must be in the range [0; %.0f]", MAX_UNSHARP_AMOUNT);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct convolution_kernel kernel;
+    SAIL_TRY(make_gaussian_kernel(sigma, &kernel));
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    struct sail_image *image_local;
+    SAIL_TRY_OR_CLEANUP(convolve_impl(image, &layout, &kernel, &kernel, edge_mode, threads, &image_local),
+                        /* cleanup */ destroy_convolution_kernel(&kernel));
+
+    destroy_convolution_kernel(&kernel);
+
+    struct unsharp_context unsharp_context = {
+        .image        = image,
+        .image_output = image_local,
+        .layout       = layout,
+        .amount       = llround(amount * WEIGHT_ONE),
+    };
+
+    SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(image->height, image->bytes_per_line + image_local->bytes_per_line * 2,
+                                                 threads, unsharp_band, &unsharp_context),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
@@ -0,0 +1,184 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_CONVOLVE_H
+#define SAIL_CONVOLVE_H
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+
+    #include "manip_common.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/manip_common.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_conversion_options;
+struct sail_image;
+
+/*
+ * Convolves the input image with a separable kernel and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * The image is filtered in two passes: horizontal and vertical. Kernels must have odd sizes
+ * up to 2001 and are centered on the filtered pixel. The kernel coefficients are converted to fixed
+ * point once, and the sum of their absolute values must not exceed 64. Kernels summing up to 1
+ * keep flat areas exactly flat. The results are rounded to the nearest and clamped.
+ *
+ * Pixels are filtered in their own pixel format without converting them to another one.
+ * All channels including alpha are filtered independently, so images with straight alpha
+ * may get halos around transparent pixels. Premultiply them first to avoid that.
+ *
+ * Allowed pixel formats: the same as in sail_scale_image().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_convolve_image(const struct sail_image *image,
+                                              const double *horizontal_kernel,
+                                              unsigned horizontal_size,
+                                              const double *vertical_kernel,
+                                              unsigned vertical_size,
+                                              struct sail_image **image_output);
+
+/*
+ * Convolves the input image with a separable kernel and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * The edge mode defines the pixels outside of the image. Options (which may be NULL) control
+ * the number of threads to filter the image with. Other options are ignored.
+ *
+ * See sail_convolve_image() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_convolve_image_with_options(const struct sail_image *image,
+                                                           const double *horizontal_kernel,
+                                                           unsigned horizontal_size,
+                                                           const double *vertical_kernel,
+                                                           unsigned vertical_size,
+                                                           enum SailEdgeMode edge_mode,
+                                                           const struct sail_conversion_options *options,
+                                                           struct sail_image **image_output);
+
+/*
+ * Blurs the input image with a Gaussian kernel and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * The kernel radius is 3 * sigma rounded up. Sigma must be positive and not greater than 333.
+ * Uses SAIL_EDGE_MODE_CLAMP. See sail_convolve_image() for the list of allowed pixel formats.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_gaussian_blur_image(const struct sail_image *image,
+                                                   double sigma,
+                                                   struct sail_image **image_output);
+
+/*
+ * Blurs the input image with a Gaussian kernel and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * See sail_gaussian_blur_image() and sail_convolve_image_with_options() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_gaussian_blur_image_with_options(const struct sail_image *image,
+                                                                double sigma,
+                                                                enum SailEdgeMode edge_mode,
+                                                                const struct sail_conversion_options *options,
+                                                                struct sail_image **image_output);
+
+/*
+ * Averages every pixel with its neighbors in a (2 * radius + 1)^2 square and saves the result
+ * in the output image. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * The filter uses sliding window sums, so its speed doesn't depend on the radius.
+ * Applying it 3 times approximates a Gaussian blur. Uses SAIL_EDGE_MODE_CLAMP.
+ * See sail_convolve_image() for the list of allowed pixel formats.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_box_blur_image(const struct sail_image *image,
+                                              unsigned radius,
+                                              struct sail_image **image_output);
+
+/*
+ * Averages every pixel with its neighbors in a (2 * radius + 1)^2 square and saves the result
+ * in the output image. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * See sail_box_blur_image() and sail_convolve_image_with_options() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_box_blur_image_with_options(const struct sail_image *image,
+                                                           unsigned radius,
+                                                           enum SailEdgeMode edge_mode,
+                                                           const struct sail_conversion_options *options,
+                                                           struct sail_image **image_output);
+
+/*
+ * Sharpens the input image with an unsharp mask and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * Formula:
+ *   output_pixel = input_pixel + amount * (input_pixel - gaussian_blurred_pixel)
+ *
+ * Amount must be in the range [0; 16]. Typical values are 0.5-2 with sigma 0.5-2.
+ * Uses SAIL_EDGE_MODE_CLAMP. See sail_convolve_image() for the list of allowed pixel formats.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_unsharp_mask_image(const struct sail_image *image,
+                                                  double sigma,
+                                                  double amount,
+                                                  struct sail_image **image_output);
+
+/*
+ * Sharpens the input image with an unsharp mask and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * See sail_unsharp_mask_image() and sail_convolve_image_with_options() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_unsharp_mask_image_with_options(const struct sail_image *image,
+                                                               double sigma,
+                                                               double amount,
+                                                               enum SailEdgeMode edge_mode,
+                                                               const struct sail_conversion_options *options,
+                                                               struct sail_image **image_output);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
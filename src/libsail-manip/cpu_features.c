@@ -0,0 +1,129 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "config.h"
+
+#include <stdbool.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+#if defined(SAIL_MANIP_X86_KERNELS) && defined(_MSC_VER) && !defined(__clang__)
+    #include <immintrin.h>
+    #include <intrin.h>
+#endif
+
+#if defined(SAIL_MANIP_NEON_KERNELS) && defined(__linux__)
+    #include <sys/auxv.h>
+    #include <asm/hwcap.h>
+#endif
+
+#if defined(SAIL_MANIP_X86_KERNELS)
+static int detect_x86_features(void) {
+
+    int features = 0;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+
+    if (info[3] & (1 << 26)) {
+        features |= SAIL_CPU_FEATURE_SSE2;
+    }
+    if (info[2] & (1 << 9)) {
+        features |= SAIL_CPU_FEATURE_SSSE3;
+    }
+
+    /* AVX2 also needs the OS to save YMM registers. */
+    const bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+
+    /* F16C works on YMM registers too. */
+    if (os_saves_ymm && (info[2] & (1 << 29))) {
+        features |= SAIL_CPU_FEATURE_F16C;
+    }
+
+    if (max_leaf >= 7 && os_saves_ymm) {
+        __cpuidex(info, 7, 0);
+
+        if (info[1] & (1 << 5)) {
+            features |= SAIL_CPU_FEATURE_AVX2;
+        }
+    }
+#else
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse2")) {
+        features |= SAIL_CPU_FEATURE_SSE2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        features |= SAIL_CPU_FEATURE_SSSE3;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        features |= SAIL_CPU_FEATURE_AVX2;
+    }
+    if (__builtin_cpu_supports("f16c")) {
+        features |= SAIL_CPU_FEATURE_F16C;
+    }
+#endif
+
+    return features;
+}
+#endif
+
+#if defined(SAIL_MANIP_NEON_KERNELS)
+static int detect_arm_features(void) {
+
+#if defined(__linux__) && defined(__aarch64__)
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) ? SAIL_CPU_FEATURE_NEON : 0;
+#elif defined(__linux__) && defined(__arm__)
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) ? SAIL_CPU_FEATURE_NEON : 0;
+#else
+    /* NEON is mandatory on AArch64, and 32-bit builds reach here only when compiled for NEON. */
+    return SAIL_CPU_FEATURE_NEON;
+#endif
+}
+#endif
+
+int detected_cpu_features(void) {
+
+    SAIL_THREAD_LOCAL static bool detected = false;
+    SAIL_THREAD_LOCAL static int features = 0;
+
+    if (!detected) {
+#if defined(SAIL_MANIP_X86_KERNELS)
+        features = detect_x86_features();
+#elif defined(SAIL_MANIP_NEON_KERNELS)
+        features = detect_arm_features();
+#endif
+        detected = true;
+    }
+
+    return features;
+}
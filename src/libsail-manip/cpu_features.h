@@ -0,0 +1,60 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_CPU_FEATURES_H
+#define SAIL_CPU_FEATURES_H
+
+#ifdef SAIL_BUILD
+    #include "export.h"
+#else
+    #include <sail-common/export.h>
+#endif
+
+/* Architectures with SIMD conversion kernels. */
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define SAIL_MANIP_X86_KERNELS
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #define SAIL_MANIP_NEON_KERNELS
+#endif
+
+/* CPU features SIMD kernels may depend on. */
+enum SailCpuFeature {
+
+    SAIL_CPU_FEATURE_SSE2  = 1 << 0,
+    SAIL_CPU_FEATURE_SSSE3 = 1 << 1,
+    SAIL_CPU_FEATURE_AVX2  = 1 << 2,
+    SAIL_CPU_FEATURE_NEON  = 1 << 3,
+    SAIL_CPU_FEATURE_F16C  = 1 << 4,
+};
+
+/*
+ * Returns the Or-ed SailCpuFeature-s supported by the current CPU and OS.
+ * The features are detected once per thread with CPUID on x86 and HWCAP on ARM.
+ */
+SAIL_HIDDEN int detected_cpu_features(void);
+
+#endif
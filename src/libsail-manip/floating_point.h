@@ -0,0 +1,167 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_FLOATING_POINT_H
+#define SAIL_FLOATING_POINT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "manip_utils.h"
+
+/*
+ * Half and single precision floating point math. Floating point components are normalized
+ * to [0; 1]. Converting them to integers clamps them to this range, NaN gives 0.
+ *
+ * The half <-> float conversions below are bit-exact with the x86 F16C instructions, so
+ * vectorized kernels and the portable code produce the same results.
+ */
+
+/*
+ * Converts a single precision float to an IEEE 754 binary16 value with round-to-nearest-even.
+ * NaNs are kept quiet, overflows give infinity.
+ */
+static inline uint16_t float_to_half(float value) {
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint16_t sign     = (uint16_t)((bits >> 16) & 0x8000);
+    const int      exponent = (int)((bits >> 23) & 0xFF);
+    uint32_t       mantissa = bits & 0x7FFFFF;
+
+    /* Infinity or NaN. */
+    if (exponent == 0xFF) {
+        return (uint16_t)(sign | 0x7C00 | (mantissa != 0 ? 0x200 | (mantissa >> 13) : 0));
+    }
+
+    const int half_exponent = exponent - 127 + 15;
+
+    /* Overflow. */
+    if (half_exponent >= 31) {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    /* Subnormal or zero. */
+    if (half_exponent <= 0) {
+        if (half_exponent < -10) {
+            return sign;
+        }
+
+        mantissa |= 0x800000;
+
+        const unsigned shift     = (unsigned)(14 - half_exponent);
+        uint32_t       half      = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway   = 1u << (shift - 1);
+
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            half++;
+        }
+
+        return (uint16_t)(sign | half);
+    }
+
+    /* Normal. Rounding may carry into the exponent which is still correct. */
+    uint32_t half = ((uint32_t)half_exponent << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFF;
+
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+
+    return (uint16_t)(sign | half);
+}
+
+/*
+ * Converts an IEEE 754 binary16 value to a single precision float. The conversion is exact.
+ * Signaling NaNs become quiet.
+ */
+static inline float half_to_float(uint16_t half) {
+
+    const uint32_t sign     = (uint32_t)(half & 0x8000) << 16;
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t       mantissa = half & 0x3FF;
+    uint32_t       bits;
+
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13) | (mantissa != 0 ? 0x400000 : 0);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        /* Subnormal. Normalize it. */
+        uint32_t float_exponent = 113;
+
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            float_exponent--;
+        }
+
+        bits = sign | (float_exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+/*
+ * Converts a normalized float to a 16-bit component: round(clamp(v, 0, 1) * 65535). NaN gives 0.
+ */
+static inline uint16_t float_to_uint16(float value) {
+
+    if (!(value > 0.0f)) {
+        return 0;
+    }
+    if (value >= 1.0f) {
+        return 65535;
+    }
+
+    return (uint16_t)(value * 65535.0f + 0.5f);
+}
+
+/*
+ * Converts a normalized float to an 8-bit component. It goes through 16 bits exactly like
+ * all the other 16-bit -> 8-bit conversions.
+ */
+static inline uint8_t float_to_uint8(float value) {
+
+    return narrow16_to8(float_to_uint16(value));
+}
+
+static inline float uint8_to_float(uint8_t value) {
+
+    return value / 255.0f;
+}
+
+static inline float uint16_to_float(uint16_t value) {
+
+    return value / 65535.0f;
+}
+
+#endif
@@ -49,6 +49,142 @@ enum SailConversionOption {
      *   output_pixel = opacity * input_pixel + (1 - opacity) * background
      */
     SAIL_CONVERSION_OPTION_BLEND_ALPHA = 1 << 1,
+
+    /*
+     * Analyze the image in sail_convert_image_for_saving_with_options() and pick the narrowest
+     * pixel format supported by the codec that keeps all the image information. For example,
+     * an RGBA image with opaque gray pixels is saved as BPP8_GRAYSCALE. See sail_analyze_image().
+     * Falls back to the closest pixel format if the input pixel format cannot be analyzed.
+     */
+    SAIL_CONVERSION_OPTION_NARROWEST_LOSSLESS = 1 << 2,
+};
+
+/*
+ * Scaling algorithms ordered from the fastest to the slowest.
+ */
+enum SailScaling {
+
+    /*
+     * Averages all the input pixels covered by an output pixel. Good and fast for downscaling.
+     */
+    SAIL_SCALING_BOX,
+
+    /*
+     * Triangle filter. Takes 2 input pixels per dimension when upscaling.
+     */
+    SAIL_SCALING_BILINEAR,
+
+    /*
+     * Catmull-Rom cubic filter. Takes 4 input pixels per dimension when upscaling.
+     */
+    SAIL_SCALING_BICUBIC,
+
+    /*
+     * Windowed sinc filter. Takes 6 input pixels per dimension when upscaling. The sharpest one.
+     */
+    SAIL_SCALING_LANCZOS3,
+};
+
+/*
+ * How convolution filters sample pixels outside of the image.
+ */
+enum SailEdgeMode {
+
+    /* Repeats the edge pixels. */
+    SAIL_EDGE_MODE_CLAMP,
+
+    /* Reflects the image at the edge pixels without repeating them: 2 1 | 0 1 2 ... */
+    SAIL_EDGE_MODE_MIRROR,
+
+    /* Tiles the image. */
+    SAIL_EDGE_MODE_WRAP,
+
+    /* Treats the outside pixels as zeros, i.e. transparent black. */
+    SAIL_EDGE_MODE_ZERO,
+};
+
+/*
+ * Dithering algorithms to quantize images with.
+ */
+enum SailDither {
+
+    /* Maps every pixel to the nearest palette color. */
+    SAIL_DITHER_NONE,
+
+    /* Adds an 8x8 Bayer matrix pattern before mapping. Doesn't produce artifacts in animations. */
+    SAIL_DITHER_ORDERED,
+
+    /* Diffuses the mapping error to the neighbor pixels. The best quality, but sequential. */
+    SAIL_DITHER_FLOYD_STEINBERG,
+};
+
+/*
+ * Porter-Duff operators to composite images with.
+ */
+enum SailComposite {
+
+    /* Replaces the destination pixels with the source ones. */
+    SAIL_COMPOSITE_SOURCE,
+
+    /* Draws the source pixels over the destination ones respecting the source alpha. */
+    SAIL_COMPOSITE_OVER,
+};
+
+/*
+ * Rectangle in pixels.
+ */
+struct sail_rectangle {
+
+    unsigned x;
+    unsigned y;
+    unsigned width;
+    unsigned height;
+};
+
+typedef struct sail_rectangle sail_rectangle_t;
+
+/*
+ * Flip directions. Can be or-ed.
+ */
+enum SailFlip {
+
+    /* Mirrors every row. */
+    SAIL_FLIP_HORIZONTALLY = 1 << 0,
+
+    /* Mirrors every column. */
+    SAIL_FLIP_VERTICALLY   = 1 << 1,
+};
+
+/*
+ * Clockwise rotation angles.
+ */
+enum SailRotation {
+
+    SAIL_ROTATION_90,
+    SAIL_ROTATION_180,
+    SAIL_ROTATION_270,
+};
+
+/*
+ * Image orientations. The values match the EXIF Orientation tag. Every orientation
+ * names the transformation to apply to the stored pixels to display them correctly.
+ */
+enum SailOrientation {
+
+    /* The pixels are stored as they are displayed. */
+    SAIL_ORIENTATION_NORMAL          = 1,
+
+    SAIL_ORIENTATION_FLIP_HORIZONTAL = 2,
+    SAIL_ORIENTATION_ROTATE_180      = 3,
+    SAIL_ORIENTATION_FLIP_VERTICAL   = 4,
+
+    /* Mirrors the pixels along the top-left to bottom-right diagonal. */
+    SAIL_ORIENTATION_TRANSPOSE       = 5,
+    SAIL_ORIENTATION_ROTATE_90       = 6,
+
+    /* Mirrors the pixels along the top-right to bottom-left diagonal. */
+    SAIL_ORIENTATION_TRANSVERSE      = 7,
+    SAIL_ORIENTATION_ROTATE_270      = 8,
 };
 
 #endif
@@ -23,12 +23,31 @@
     SOFTWARE.
 */
 
+#include <string.h>
+
 #include "sail-manip.h"
 
-/* https://en.wikipedia.org/wiki/Grayscale */
-static const double R_TO_GRAY_COEFFICIENT = 0.299;
-static const double G_TO_GRAY_COEFFICIENT = 0.587;
-static const double B_TO_GRAY_COEFFICIENT = 0.114;
+/*
+ * Blending and grayscale math is done in fixed point, see manip_utils.h. Blended and
+ * grayscale components are rounded to the nearest integer. 16-bit components are narrowed
+ * to 8 bits with floor(value / 257).
+ */
+
+const uint8_t BAYER8[8][8] = {
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+static inline bool blend_alpha(const struct sail_conversion_options *options) {
+
+    return options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA);
+}
 
 sail_status_t get_palette_rgba32(const struct sail_palette *palette, unsigned index, sail_rgba32_t *rgba32) {
 
@@ -73,7 +92,7 @@ void spread_gray8_to_rgba32(uint8_t value, sail_rgba32_t *rgba32) {
 
 void spread_gray16_to_rgba32(uint16_t value, sail_rgba32_t *rgba32) {
 
-    rgba32->component1 = rgba32->component2 = rgba32->component3 = (uint8_t)(value / 257.0);
+    rgba32->component1 = rgba32->component2 = rgba32->component3 = narrow16_to8(value);
     rgba32->component4 = 255;
 }
 
@@ -89,250 +108,327 @@ void spread_gray16_to_rgba64(uint16_t value, sail_rgba64_t *rgba64) {
     rgba64->component4 = 65535;
 }
 
-void fill_gray8_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, const struct sail_conversion_options *options) {
+/* Blends the 8-bit pixel with the 24-bit background if needed and returns its RGB components. */
+static inline void rgba32_to_rgb24(const sail_rgba32_t *rgba32, sail_rgb24_t *rgb24, const struct sail_conversion_options *options) {
 
-    sail_rgb24_t rgb24;
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        rgb24->component1 = blend8(rgba32->component1, options->background24.component1, rgba32->component4);
+        rgb24->component2 = blend8(rgba32->component2, options->background24.component2, rgba32->component4);
+        rgb24->component3 = blend8(rgba32->component3, options->background24.component3, rgba32->component4);
+    } else {
+        rgb24->component1 = rgba32->component1;
+        rgb24->component2 = rgba32->component2;
+        rgb24->component3 = rgba32->component3;
+    }
+}
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
+/* Blends the 16-bit pixel with the 48-bit background if needed and returns its RGB components. */
+static inline void rgba64_to_rgb48(const sail_rgba64_t *rgba64, sail_rgb48_t *rgb48, const struct sail_conversion_options *options) {
 
-        rgb24.component1 = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        rgb24.component2 = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        rgb24.component3 = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
+    if (rgba64->component4 < 65535 && blend_alpha(options)) {
+        rgb48->component1 = blend16(rgba64->component1, options->background48.component1, rgba64->component4);
+        rgb48->component2 = blend16(rgba64->component2, options->background48.component2, rgba64->component4);
+        rgb48->component3 = blend16(rgba64->component3, options->background48.component3, rgba64->component4);
     } else {
-        rgb24.component1 = rgba32->component1;
-        rgb24.component2 = rgba32->component2;
-        rgb24.component3 = rgba32->component3;
+        rgb48->component1 = rgba64->component1;
+        rgb48->component2 = rgba64->component2;
+        rgb48->component3 = rgba64->component3;
     }
+}
 
-    *scan = (uint8_t)((R_TO_GRAY_COEFFICIENT * rgb24.component1) + (G_TO_GRAY_COEFFICIENT * rgb24.component2) + (B_TO_GRAY_COEFFICIENT * rgb24.component3));
+/* Blends the 8-bit pixel with the 48-bit background if needed and returns its RGB components widened to 16 bits. */
+static inline void rgba32_to_rgb48(const sail_rgba32_t *rgba32, sail_rgb48_t *rgb48, const struct sail_conversion_options *options) {
+
+    if (rgba32->component4 < 255 && blend_alpha(options)) {
+        rgb48->component1 = blend8_to16(rgba32->component1, options->background48.component1, rgba32->component4);
+        rgb48->component2 = blend8_to16(rgba32->component2, options->background48.component2, rgba32->component4);
+        rgb48->component3 = blend8_to16(rgba32->component3, options->background48.component3, rgba32->component4);
+    } else {
+        rgb48->component1 = rgba32->component1 * 257;
+        rgb48->component2 = rgba32->component2 * 257;
+        rgb48->component3 = rgba32->component3 * 257;
+    }
 }
 
-void fill_gray8_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, const struct sail_conversion_options *options) {
+/* Blends the 16-bit pixel with the 48-bit background if needed and returns its RGB components narrowed to 8 bits. */
+static inline void rgba64_to_rgb24(const sail_rgba64_t *rgba64, sail_rgb24_t *rgb24, const struct sail_conversion_options *options) {
+
+    sail_rgb48_t rgb48;
+    rgba64_to_rgb48(rgba64, &rgb48, options);
+
+    rgb24->component1 = narrow16_to8(rgb48.component1);
+    rgb24->component2 = narrow16_to8(rgb48.component2);
+    rgb24->component3 = narrow16_to8(rgb48.component3);
+}
+
+void fill_gray8_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, const struct sail_conversion_options *options) {
 
     sail_rgb24_t rgb24;
+    rgba32_to_rgb24(rgba32, &rgb24, options);
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
+    *scan = (uint8_t)rgb_to_gray(rgb24.component1, rgb24.component2, rgb24.component3);
+}
 
-        rgb24.component1 = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        rgb24.component2 = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        rgb24.component3 = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
-    } else {
-        rgb24.component1 = (uint8_t)(rgba64->component1 / 257.0);
-        rgb24.component2 = (uint8_t)(rgba64->component2 / 257.0);
-        rgb24.component3 = (uint8_t)(rgba64->component3 / 257.0);
-    }
+void fill_gray8_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, const struct sail_conversion_options *options) {
+
+    sail_rgb24_t rgb24;
+    rgba64_to_rgb24(rgba64, &rgb24, options);
 
-    *scan = (uint8_t)((R_TO_GRAY_COEFFICIENT * rgb24.component1) + (G_TO_GRAY_COEFFICIENT * rgb24.component2) + (B_TO_GRAY_COEFFICIENT * rgb24.component3));
+    *scan = (uint8_t)rgb_to_gray(rgb24.component1, rgb24.component2, rgb24.component3);
 }
 
 void fill_gray16_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, const struct sail_conversion_options *options) {
 
     sail_rgb48_t rgb48;
+    rgba32_to_rgb48(rgba32, &rgb48, options);
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        rgb48.component1 = (uint16_t)(opacity * (rgba32->component1 * 257) + (1 - opacity) * options->background48.component1);
-        rgb48.component2 = (uint16_t)(opacity * (rgba32->component2 * 257) + (1 - opacity) * options->background48.component2);
-        rgb48.component3 = (uint16_t)(opacity * (rgba32->component3 * 257) + (1 - opacity) * options->background48.component3);
-    } else {
-        rgb48.component1 = rgba32->component1 * 257;
-        rgb48.component2 = rgba32->component2 * 257;
-        rgb48.component3 = rgba32->component3 * 257;
-    }
-
-    *scan = (uint16_t)((R_TO_GRAY_COEFFICIENT * rgb48.component1) + (G_TO_GRAY_COEFFICIENT * rgb48.component2) + (B_TO_GRAY_COEFFICIENT * rgb48.component3));
+    *scan = (uint16_t)rgb_to_gray(rgb48.component1, rgb48.component2, rgb48.component3);
 }
 
 void fill_gray16_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, const struct sail_conversion_options *options) {
 
     sail_rgb48_t rgb48;
+    rgba64_to_rgb48(rgba64, &rgb48, options);
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        rgb48.component1 = (uint16_t)(opacity * rgba64->component1 + (1 - opacity) * options->background48.component1);
-        rgb48.component2 = (uint16_t)(opacity * rgba64->component2 + (1 - opacity) * options->background48.component2);
-        rgb48.component3 = (uint16_t)(opacity * rgba64->component3 + (1 - opacity) * options->background48.component3);
-    } else {
-        rgb48.component1 = rgba64->component1;
-        rgb48.component2 = rgba64->component2;
-        rgb48.component3 = rgba64->component3;
-    }
-
-    *scan = (uint16_t)((R_TO_GRAY_COEFFICIENT * rgb48.component1) + (G_TO_GRAY_COEFFICIENT * rgb48.component2) + (B_TO_GRAY_COEFFICIENT * rgb48.component3));
+    *scan = (uint16_t)rgb_to_gray(rgb48.component1, rgb48.component2, rgb48.component3);
 }
 
 void fill_rgb24_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
+    sail_rgb24_t rgb24;
+    rgba32_to_rgb24(rgba32, &rgb24, options);
 
-        *(scan+r) = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        *(scan+g) = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        *(scan+b) = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
-    } else {
-        *(scan+r) = rgba32->component1;
-        *(scan+g) = rgba32->component2;
-        *(scan+b) = rgba32->component3;
-    }
+    *(scan+r) = rgb24.component1;
+    *(scan+g) = rgb24.component2;
+    *(scan+b) = rgb24.component3;
 }
 
 void fill_rgb24_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
+    sail_rgb24_t rgb24;
+    rgba64_to_rgb24(rgba64, &rgb24, options);
 
-        *(scan+r) = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        *(scan+g) = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        *(scan+b) = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
-    } else {
-        *(scan+r) = (uint8_t)(rgba64->component1 / 257.0);
-        *(scan+g) = (uint8_t)(rgba64->component2 / 257.0);
-        *(scan+b) = (uint8_t)(rgba64->component3 / 257.0);
-    }
+    *(scan+r) = rgb24.component1;
+    *(scan+g) = rgb24.component2;
+    *(scan+b) = rgb24.component3;
 }
 
 void fill_rgb48_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
+    sail_rgb48_t rgb48;
+    rgba32_to_rgb48(rgba32, &rgb48, options);
 
-        *(scan+r) = (uint16_t)(opacity * (rgba32->component1 * 257) + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * (rgba32->component2 * 257) + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * (rgba32->component3 * 257) + (1 - opacity) * options->background48.component3);
-    } else {
-        *(scan+r) = rgba32->component1 * 257;
-        *(scan+g) = rgba32->component2 * 257;
-        *(scan+b) = rgba32->component3 * 257;
-    }
+    *(scan+r) = rgb48.component1;
+    *(scan+g) = rgb48.component2;
+    *(scan+b) = rgb48.component3;
 }
 
 void fill_rgb48_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, const struct sail_conversion_options *options) {
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
+    sail_rgb48_t rgb48;
+    rgba64_to_rgb48(rgba64, &rgb48, options);
 
-        *(scan+r) = (uint16_t)(opacity * rgba64->component1 + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * rgba64->component2 + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * rgba64->component3 + (1 - opacity) * options->background48.component3);
-    } else {
-        *(scan+r) = rgba64->component1;
-        *(scan+g) = rgba64->component2;
-        *(scan+b) = rgba64->component3;
-    }
+    *(scan+r) = rgb48.component1;
+    *(scan+g) = rgb48.component2;
+    *(scan+b) = rgb48.component3;
 }
 
 void fill_rgba32_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        *(scan+r) = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        *(scan+g) = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        *(scan+b) = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
-    } else {
+    if (a >= 0) {
         *(scan+r) = rgba32->component1;
         *(scan+g) = rgba32->component2;
         *(scan+b) = rgba32->component3;
-    }
-
-    if (a >= 0) {
         *(scan+a) = rgba32->component4;
+    } else {
+        fill_rgb24_pixel_from_uint8_values(rgba32, scan, r, g, b, options);
     }
 }
 
 void fill_rgba32_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        *(scan+r) = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        *(scan+g) = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        *(scan+b) = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
-    } else {
-        *(scan+r) = (uint8_t)(rgba64->component1 / 257.0);
-        *(scan+g) = (uint8_t)(rgba64->component2 / 257.0);
-        *(scan+b) = (uint8_t)(rgba64->component3 / 257.0);
-    }
-
     if (a >= 0) {
-        *(scan+a) = (uint8_t)(rgba64->component4 / 257.0);
+        *(scan+r) = narrow16_to8(rgba64->component1);
+        *(scan+g) = narrow16_to8(rgba64->component2);
+        *(scan+b) = narrow16_to8(rgba64->component3);
+        *(scan+a) = narrow16_to8(rgba64->component4);
+    } else {
+        fill_rgb24_pixel_from_uint16_values(rgba64, scan, r, g, b, options);
     }
 }
 
 void fill_rgba64_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
-
-        *(scan+r) = (uint16_t)(opacity * (rgba32->component1 * 257) + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * (rgba32->component2 * 257) + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * (rgba32->component3 * 257) + (1 - opacity) * options->background48.component3);
-    } else {
+    if (a >= 0) {
         *(scan+r) = rgba32->component1 * 257;
         *(scan+g) = rgba32->component2 * 257;
         *(scan+b) = rgba32->component3 * 257;
-    }
-
-    if (a >= 0) {
         *(scan+a) = rgba32->component4 * 257;
+    } else {
+        fill_rgb48_pixel_from_uint8_values(rgba32, scan, r, g, b, options);
     }
 }
 
 void fill_rgba64_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options) {
 
-    if (a < 0 && rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
-
-        *(scan+r) = (uint16_t)(opacity * rgba64->component1 + (1 - opacity) * options->background48.component1);
-        *(scan+g) = (uint16_t)(opacity * rgba64->component2 + (1 - opacity) * options->background48.component2);
-        *(scan+b) = (uint16_t)(opacity * rgba64->component3 + (1 - opacity) * options->background48.component3);
-    } else {
+    if (a >= 0) {
         *(scan+r) = rgba64->component1;
         *(scan+g) = rgba64->component2;
         *(scan+b) = rgba64->component3;
-    }
-
-    if (a >= 0) {
         *(scan+a) = rgba64->component4;
+    } else {
+        fill_rgb48_pixel_from_uint16_values(rgba64, scan, r, g, b, options);
     }
 }
 
-void fill_ycbcr_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, const struct sail_conversion_options *options) {
+void fill_rgba32_premultiplied_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, int r, int g, int b, int a) {
 
-    sail_rgba32_t rgba32_no_alpha;
+    *(scan+r) = premultiply8(rgba32->component1, rgba32->component4);
+    *(scan+g) = premultiply8(rgba32->component2, rgba32->component4);
+    *(scan+b) = premultiply8(rgba32->component3, rgba32->component4);
+    *(scan+a) = rgba32->component4;
+}
 
-    if (rgba32->component4 < 255 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba32->component4 / 255.0;
+void fill_rgba32_premultiplied_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, int r, int g, int b, int a) {
 
-        rgba32_no_alpha.component1 = (uint8_t)(opacity * rgba32->component1 + (1 - opacity) * options->background24.component1);
-        rgba32_no_alpha.component2 = (uint8_t)(opacity * rgba32->component2 + (1 - opacity) * options->background24.component2);
-        rgba32_no_alpha.component3 = (uint8_t)(opacity * rgba32->component3 + (1 - opacity) * options->background24.component3);
-    } else {
-        rgba32_no_alpha = *rgba32;
-    }
+    const sail_rgba32_t rgba32 = {
+        narrow16_to8(rgba64->component1),
+        narrow16_to8(rgba64->component2),
+        narrow16_to8(rgba64->component3),
+        narrow16_to8(rgba64->component4)
+    };
+
+    fill_rgba32_premultiplied_pixel_from_uint8_values(&rgba32, scan, r, g, b, a);
+}
+
+void fill_rgba64_premultiplied_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, int r, int g, int b, int a) {
+
+    const sail_rgba64_t rgba64 = {
+        rgba32->component1 * 257,
+        rgba32->component2 * 257,
+        rgba32->component3 * 257,
+        rgba32->component4 * 257
+    };
+
+    fill_rgba64_premultiplied_pixel_from_uint16_values(&rgba64, scan, r, g, b, a);
+}
+
+void fill_rgba64_premultiplied_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, int a) {
+
+    *(scan+r) = premultiply16(rgba64->component1, rgba64->component4);
+    *(scan+g) = premultiply16(rgba64->component2, rgba64->component4);
+    *(scan+b) = premultiply16(rgba64->component3, rgba64->component4);
+    *(scan+a) = rgba64->component4;
+}
+
+void fill_ycbcr_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, const struct sail_conversion_options *options) {
+
+    sail_rgb24_t rgb24;
+    rgba32_to_rgb24(rgba32, &rgb24, options);
 
+    const sail_rgba32_t rgba32_no_alpha = { rgb24.component1, rgb24.component2, rgb24.component3, rgba32->component4 };
     convert_rgba32_to_ycbcr24(&rgba32_no_alpha, scan+0, scan+1, scan+2);
 }
 
 void fill_ycbcr_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, const struct sail_conversion_options *options) {
 
-    sail_rgba32_t rgba32_no_alpha;
+    sail_rgb24_t rgb24;
+    rgba64_to_rgb24(rgba64, &rgb24, options);
 
-    if (rgba64->component4 < 65535 && options != NULL && (options->options & SAIL_CONVERSION_OPTION_BLEND_ALPHA)) {
-        const double opacity = rgba64->component4 / 65535.0;
+    const sail_rgba32_t rgba32_no_alpha = { rgb24.component1, rgb24.component2, rgb24.component3, 255 };
+    convert_rgba32_to_ycbcr24(&rgba32_no_alpha, scan+0, scan+1, scan+2);
+}
 
-        rgba32_no_alpha.component1 = (uint8_t)((opacity * rgba64->component1 + (1 - opacity) * options->background48.component1) / 257.0);
-        rgba32_no_alpha.component2 = (uint8_t)((opacity * rgba64->component2 + (1 - opacity) * options->background48.component2) / 257.0);
-        rgba32_no_alpha.component3 = (uint8_t)((opacity * rgba64->component3 + (1 - opacity) * options->background48.component3) / 257.0);
-    } else {
-        rgba32_no_alpha.component1 = (uint8_t)(rgba64->component1 / 257.0);
-        rgba32_no_alpha.component2 = (uint8_t)(rgba64->component2 / 257.0);
-        rgba32_no_alpha.component3 = (uint8_t)(rgba64->component3 / 257.0);
+bool sample_layout(enum SailPixelFormat pixel_format, struct sample_layout *layout) {
+
+    memset(layout, 0, sizeof(*layout));
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE:        layout->channels = 1; layout->bytes_per_sample = 1; return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE:       layout->channels = 1; layout->bytes_per_sample = 2; return true;
+        case SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA: layout->channels = 2; layout->bytes_per_sample = 1; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA: layout->channels = 2; layout->bytes_per_sample = 2; return true;
+
+        case SAIL_PIXEL_FORMAT_BPP16_RGB555:
+        case SAIL_PIXEL_FORMAT_BPP16_BGR555: {
+            *layout = (struct sample_layout){ 3, 1, { 5, 5, 5 } };
+            return true;
+        }
+        case SAIL_PIXEL_FORMAT_BPP16_RGB565:
+        case SAIL_PIXEL_FORMAT_BPP16_BGR565: {
+            *layout = (struct sample_layout){ 3, 1, { 5, 6, 5 } };
+            return true;
+        }
+
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:
+        case SAIL_PIXEL_FORMAT_BPP24_BGR: layout->channels = 3; layout->bytes_per_sample = 1; return true;
+
+        case SAIL_PIXEL_FORMAT_BPP48_RGB:
+        case SAIL_PIXEL_FORMAT_BPP48_BGR: layout->channels = 3; layout->bytes_per_sample = 2; return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: layout->channels = 4; layout->bytes_per_sample = 1; return true;
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBX:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRX:
+        case SAIL_PIXEL_FORMAT_BPP64_XRGB:
+        case SAIL_PIXEL_FORMAT_BPP64_XBGR:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR:
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED:
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: layout->channels = 4; layout->bytes_per_sample = 2; return true;
+
+        default: {
+            return false;
+        }
     }
+}
 
-    convert_rgba32_to_ycbcr24(&rgba32_no_alpha, scan+0, scan+1, scan+2);
+void unpack_packed_row(const uint16_t *input, uint8_t *output, unsigned width, const unsigned packed_bits[3]) {
+
+    const unsigned shift1 = packed_bits[0];
+    const unsigned shift2 = packed_bits[0] + packed_bits[1];
+    const unsigned mask0 = (1U << packed_bits[0]) - 1;
+    const unsigned mask1 = (1U << packed_bits[1]) - 1;
+    const unsigned mask2 = (1U << packed_bits[2]) - 1;
+
+    for (unsigned column = 0; column < width; column++) {
+        const unsigned value = *input++;
+
+        *output++ = (uint8_t)(value & mask0);
+        *output++ = (uint8_t)((value >> shift1) & mask1);
+        *output++ = (uint8_t)((value >> shift2) & mask2);
+    }
+}
+
+/* Clamps the samples as they may overshoot the channel range. */
+void pack_packed_row(const uint8_t *input, uint16_t *output, unsigned width, const unsigned packed_bits[3]) {
+
+    const unsigned shift1 = packed_bits[0];
+    const unsigned shift2 = packed_bits[0] + packed_bits[1];
+    const unsigned max0 = (1U << packed_bits[0]) - 1;
+    const unsigned max1 = (1U << packed_bits[1]) - 1;
+    const unsigned max2 = (1U << packed_bits[2]) - 1;
+
+    for (unsigned column = 0; column < width; column++, input += 3) {
+        const unsigned c0 = (input[0] > max0) ? max0 : input[0];
+        const unsigned c1 = (input[1] > max1) ? max1 : input[1];
+        const unsigned c2 = (input[2] > max2) ? max2 : input[2];
+
+        *output++ = (uint16_t)(c0 | (c1 << shift1) | (c2 << shift2));
+    }
 }
@@ -26,6 +26,7 @@
 #ifndef SAIL_MANIP_UTILS_H
 #define SAIL_MANIP_UTILS_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "error.h"
@@ -34,6 +35,113 @@
 struct sail_conversion_options;
 struct sail_palette;
 
+/*
+ * Fixed-point color math. All the functions below use integers only, so loops over them
+ * can be vectorized by compilers.
+ */
+
+/*
+ * BT.601 luma weights in 16.16 fixed point: 0.299, 0.587, and 0.114 rounded to the nearest
+ * 1/65536. They sum up to exactly 65536, so white is mapped to white.
+ */
+#define R_TO_GRAY_WEIGHT 19595
+#define G_TO_GRAY_WEIGHT 38470
+#define B_TO_GRAY_WEIGHT 7471
+
+/*
+ * Returns round(value / 255) for value in [0; 65535] without a division.
+ */
+static inline uint32_t div255_round(uint32_t value) {
+
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+/*
+ * Returns round(value / 65535) for value in [0; 65535 * 65535].
+ */
+static inline uint32_t div65535_round(uint32_t value) {
+
+    return (value + 32767) / 65535;
+}
+
+/*
+ * Returns floor(value / 257) without a division. This is the 16-bit -> 8-bit narrowing
+ * used by all conversions.
+ */
+static inline uint8_t narrow16_to8(uint16_t value) {
+
+    return (uint8_t)((value - (value >> 8)) >> 8);
+}
+
+/*
+ * Blends an 8-bit color component with an 8-bit background: round((c*a + bg*(255-a)) / 255).
+ */
+static inline uint8_t blend8(uint8_t c, uint8_t bg, uint8_t a) {
+
+    return (uint8_t)div255_round((uint32_t)c * a + (uint32_t)bg * (255 - a));
+}
+
+/*
+ * Blends a 16-bit color component with a 16-bit background: round((c*a + bg*(65535-a)) / 65535).
+ */
+static inline uint16_t blend16(uint16_t c, uint16_t bg, uint16_t a) {
+
+    return (uint16_t)div65535_round((uint32_t)c * a + (uint32_t)bg * (65535 - a));
+}
+
+/*
+ * Blends an 8-bit color component widened to 16 bits with a 16-bit background and an 8-bit alpha:
+ * round((c*257*a + bg*(255-a)) / 255).
+ */
+static inline uint16_t blend8_to16(uint8_t c, uint16_t bg, uint8_t a) {
+
+    return (uint16_t)(((uint32_t)c * 257 * a + (uint32_t)bg * (255 - a) + 127) / 255);
+}
+
+/*
+ * Returns the rounded luma of 8-bit or 16-bit RGB components.
+ */
+static inline uint32_t rgb_to_gray(uint32_t r, uint32_t g, uint32_t b) {
+
+    return (r * R_TO_GRAY_WEIGHT + g * G_TO_GRAY_WEIGHT + b * B_TO_GRAY_WEIGHT + 32768) >> 16;
+}
+
+/*
+ * 8x8 Bayer matrix with values in [0; 63] for ordered dithering.
+ */
+SAIL_HIDDEN extern const uint8_t BAYER8[8][8];
+
+/*
+ * Interleaved samples of the pixel formats that can be filtered sample by sample,
+ * i.e. scaled or convolved.
+ */
+struct sample_layout {
+    unsigned channels;
+
+    /* 1 or 2. */
+    unsigned bytes_per_sample;
+
+    /*
+     * Bit widths of the 3 channels packed into 16-bit pixels, starting from the least significant bits.
+     * Zeros for not packed pixels. Packed channels are unpacked into 8-bit samples with their
+     * original precision, i.e. in the range [0; 31] or [0; 63].
+     */
+    unsigned packed_bits[3];
+};
+
+/*
+ * Returns true and fills the layout if the pixel format consists of 8-bit or 16-bit interleaved
+ * samples or of packed 16-bit RGB555/RGB565 pixels.
+ */
+SAIL_HIDDEN bool sample_layout(enum SailPixelFormat pixel_format, struct sample_layout *layout);
+
+/* Unpacks 16-bit packed pixels into 8-bit samples. */
+SAIL_HIDDEN void unpack_packed_row(const uint16_t *input, uint8_t *output, unsigned width, const unsigned packed_bits[3]);
+
+/* Packs 8-bit samples into 16-bit pixels. */
+SAIL_HIDDEN void pack_packed_row(const uint8_t *input, uint16_t *output, unsigned width, const unsigned packed_bits[3]);
+
 SAIL_HIDDEN sail_status_t get_palette_rgba32(const struct sail_palette *palette, unsigned index, sail_rgba32_t *rgba32);
 
 SAIL_HIDDEN void spread_gray8_to_rgba32(uint8_t value, sail_rgba32_t *rgba32);
@@ -68,6 +176,14 @@ SAIL_HIDDEN void fill_rgba64_pixel_from_uint8_values(const sail_rgba32_t *rgba32
 
 SAIL_HIDDEN void fill_rgba64_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, int a, const struct sail_conversion_options *options);
 
+SAIL_HIDDEN void fill_rgba32_premultiplied_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, int r, int g, int b, int a);
+
+SAIL_HIDDEN void fill_rgba32_premultiplied_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, int r, int g, int b, int a);
+
+SAIL_HIDDEN void fill_rgba64_premultiplied_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint16_t *scan, int r, int g, int b, int a);
+
+SAIL_HIDDEN void fill_rgba64_premultiplied_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint16_t *scan, int r, int g, int b, int a);
+
 SAIL_HIDDEN void fill_ycbcr_pixel_from_uint8_values(const sail_rgba32_t *rgba32, uint8_t *scan, const struct sail_conversion_options *options);
 
 SAIL_HIDDEN void fill_ycbcr_pixel_from_uint16_values(const sail_rgba64_t *rgba64, uint8_t *scan, const struct sail_conversion_options *options);
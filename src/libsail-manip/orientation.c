@@ -0,0 +1,619 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-manip.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SAIL_TRANSPOSE_SSE2
+#endif
+
+/*
+ * Transpositions walk the image in square tiles, so both the input rows and the output rows
+ * of a tile stay in the L1 cache. 32x32 tiles of 4-byte pixels take 4 KiB per image.
+ */
+#define TILE_SIZE 32
+
+/* The EXIF Orientation tag. */
+#define EXIF_ORIENTATION_TAG 0x0112
+#define EXIF_TYPE_SHORT 3
+
+/*
+ * Private functions.
+ */
+
+static sail_status_t whole_bytes_per_pixel(enum SailPixelFormat pixel_format, unsigned *bytes_per_pixel) {
+
+    unsigned bits_per_pixel;
+    SAIL_TRY(sail_bits_per_pixel(pixel_format, &bits_per_pixel));
+
+    if (bits_per_pixel < 8 || bits_per_pixel % 8 != 0 || sail_is_planar(pixel_format)) {
+        SAIL_LOG_ERROR("Only packed pixel formats with whole bytes per pixel can be flipped horizontally or rotated, but %s is given",
+                        sail_pixel_format_to_string(pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    *bytes_per_pixel = bits_per_pixel / 8;
+
+    return SAIL_OK;
+}
+
+/*
+ * Every orientation is a transposition (or nothing) followed by or-ed SailFlip-s.
+ */
+static sail_status_t decompose_orientation(enum SailOrientation orientation, bool *transpose, int *flip) {
+
+    switch (orientation) {
+        case SAIL_ORIENTATION_NORMAL:          *transpose = false; *flip = 0; break;
+        case SAIL_ORIENTATION_FLIP_HORIZONTAL: *transpose = false; *flip = SAIL_FLIP_HORIZONTALLY; break;
+        case SAIL_ORIENTATION_ROTATE_180:      *transpose = false; *flip = SAIL_FLIP_HORIZONTALLY | SAIL_FLIP_VERTICALLY; break;
+        case SAIL_ORIENTATION_FLIP_VERTICAL:   *transpose = false; *flip = SAIL_FLIP_VERTICALLY; break;
+        case SAIL_ORIENTATION_TRANSPOSE:       *transpose = true;  *flip = 0; break;
+        case SAIL_ORIENTATION_ROTATE_90:       *transpose = true;  *flip = SAIL_FLIP_HORIZONTALLY; break;
+        case SAIL_ORIENTATION_TRANSVERSE:      *transpose = true;  *flip = SAIL_FLIP_HORIZONTALLY | SAIL_FLIP_VERTICALLY; break;
+        case SAIL_ORIENTATION_ROTATE_270:      *transpose = true;  *flip = SAIL_FLIP_VERTICALLY; break;
+
+        default: {
+            SAIL_LOG_ERROR("Unknown orientation %d", orientation);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * The functions below take the pixel size as an argument. They're inlined into callers
+ * with constant pixel sizes, so the compiler generates a specialized loop for every size.
+ */
+
+static inline void swap_pixels(uint8_t *pixel1, uint8_t *pixel2, unsigned bytes_per_pixel) {
+
+    for (unsigned i = 0; i < bytes_per_pixel; i++) {
+        const uint8_t tmp = pixel1[i];
+        pixel1[i] = pixel2[i];
+        pixel2[i] = tmp;
+    }
+}
+
+static inline void flip_rows_horizontally_impl(uint8_t *pixels, size_t bytes_per_line, unsigned width, unsigned height,
+                                               unsigned bytes_per_pixel) {
+
+    for (unsigned row = 0; row < height; row++) {
+        uint8_t *left = pixels + bytes_per_line * row;
+        uint8_t *right = left + (size_t)(width - 1) * bytes_per_pixel;
+
+        for (; left < right; left += bytes_per_pixel, right -= bytes_per_pixel) {
+            swap_pixels(left, right, bytes_per_pixel);
+        }
+    }
+}
+
+static void flip_rows_horizontally(uint8_t *pixels, size_t bytes_per_line, unsigned width, unsigned height,
+                                   unsigned bytes_per_pixel) {
+
+    switch (bytes_per_pixel) {
+        case 1:  flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, 1); break;
+        case 2:  flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, 2); break;
+        case 3:  flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, 3); break;
+        case 4:  flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, 4); break;
+        case 6:  flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, 6); break;
+        case 8:  flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, 8); break;
+        default: flip_rows_horizontally_impl(pixels, bytes_per_line, width, height, bytes_per_pixel); break;
+    }
+}
+
+static void flip_rows_vertically(uint8_t *pixels, size_t bytes_per_line, unsigned height) {
+
+    uint8_t chunk[1024];
+
+    for (unsigned row = 0; row < height / 2; row++) {
+        uint8_t *top = pixels + bytes_per_line * row;
+        uint8_t *bottom = pixels + bytes_per_line * (height - 1 - row);
+
+        for (size_t offset = 0; offset < bytes_per_line; offset += sizeof(chunk)) {
+            const size_t length = (bytes_per_line - offset < sizeof(chunk)) ? bytes_per_line - offset : sizeof(chunk);
+
+            memcpy(chunk, top + offset, length);
+            memcpy(top + offset, bottom + offset, length);
+            memcpy(bottom + offset, chunk, length);
+        }
+    }
+}
+
+/*
+ * Out-of-place transposition with optional flips. The output pixel (row, column) is taken from
+ * the input address origin + column * input_row_step + row * input_column_step. Negative steps
+ * flip the output.
+ */
+struct transpose_geometry {
+    const uint8_t *origin;
+    ptrdiff_t input_row_step;
+    ptrdiff_t input_column_step;
+
+    uint8_t *output;
+    size_t output_bytes_per_line;
+    unsigned output_width;
+    unsigned output_height;
+};
+
+#ifdef SAIL_TRANSPOSE_SSE2
+/* Transposes a block of 4x4 4-byte pixels in registers. */
+static inline void transpose_block4x4_sse2(const struct transpose_geometry *geometry, unsigned row, unsigned column) {
+
+    const uint8_t *input = geometry->origin + (ptrdiff_t)column * geometry->input_row_step + (ptrdiff_t)row * geometry->input_column_step;
+    const bool reversed = geometry->input_column_step < 0;
+
+    if (reversed) {
+        input += 3 * geometry->input_column_step;
+    }
+
+    __m128i r[4];
+
+    for (int i = 0; i < 4; i++) {
+        r[i] = _mm_loadu_si128((const __m128i *)(const void *)(input + i * geometry->input_row_step));
+
+        if (reversed) {
+            r[i] = _mm_shuffle_epi32(r[i], _MM_SHUFFLE(0, 1, 2, 3));
+        }
+    }
+
+    const __m128i t0 = _mm_unpacklo_epi32(r[0], r[1]);
+    const __m128i t1 = _mm_unpacklo_epi32(r[2], r[3]);
+    const __m128i t2 = _mm_unpackhi_epi32(r[0], r[1]);
+    const __m128i t3 = _mm_unpackhi_epi32(r[2], r[3]);
+
+    uint8_t *output = geometry->output + geometry->output_bytes_per_line * row + (size_t)column * 4;
+
+    _mm_storeu_si128((__m128i *)(void *)(output),                                         _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)(void *)(output + geometry->output_bytes_per_line),       _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128((__m128i *)(void *)(output + geometry->output_bytes_per_line * 2),   _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128((__m128i *)(void *)(output + geometry->output_bytes_per_line * 3),   _mm_unpackhi_epi64(t2, t3));
+}
+#endif
+
+static inline void transpose_pixels(const struct transpose_geometry *geometry,
+                                    unsigned first_row, unsigned last_row, unsigned first_column, unsigned last_column,
+                                    unsigned bytes_per_pixel) {
+
+    for (unsigned row = first_row; row < last_row; row++) {
+        const uint8_t *input = geometry->origin + (ptrdiff_t)first_column * geometry->input_row_step
+                                + (ptrdiff_t)row * geometry->input_column_step;
+        uint8_t *output = geometry->output + geometry->output_bytes_per_line * row + (size_t)first_column * bytes_per_pixel;
+
+        for (unsigned column = first_column; column < last_column; column++) {
+            memcpy(output, input, bytes_per_pixel);
+
+            input += geometry->input_row_step;
+            output += bytes_per_pixel;
+        }
+    }
+}
+
+static inline void transpose_tiles_impl(const struct transpose_geometry *geometry, unsigned bytes_per_pixel) {
+
+    for (unsigned tile_row = 0; tile_row < geometry->output_height; tile_row += TILE_SIZE) {
+        const unsigned last_row = (geometry->output_height - tile_row < TILE_SIZE) ? geometry->output_height : tile_row + TILE_SIZE;
+
+        for (unsigned tile_column = 0; tile_column < geometry->output_width; tile_column += TILE_SIZE) {
+            const unsigned last_column = (geometry->output_width - tile_column < TILE_SIZE) ? geometry->output_width : tile_column + TILE_SIZE;
+
+            unsigned row = tile_row;
+
+#ifdef SAIL_TRANSPOSE_SSE2
+            if (bytes_per_pixel == 4) {
+                for (; row + 4 <= last_row; row += 4) {
+                    unsigned column = tile_column;
+
+                    for (; column + 4 <= last_column; column += 4) {
+                        transpose_block4x4_sse2(geometry, row, column);
+                    }
+
+                    transpose_pixels(geometry, row, row + 4, column, last_column, 4);
+                }
+            }
+#endif
+
+            transpose_pixels(geometry, row, last_row, tile_column, last_column, bytes_per_pixel);
+        }
+    }
+}
+
+static void transpose_tiles(const struct transpose_geometry *geometry, unsigned bytes_per_pixel) {
+
+    switch (bytes_per_pixel) {
+        case 1:  transpose_tiles_impl(geometry, 1); break;
+        case 2:  transpose_tiles_impl(geometry, 2); break;
+        case 3:  transpose_tiles_impl(geometry, 3); break;
+        case 4:  transpose_tiles_impl(geometry, 4); break;
+        case 6:  transpose_tiles_impl(geometry, 6); break;
+        case 8:  transpose_tiles_impl(geometry, 8); break;
+        default: transpose_tiles_impl(geometry, bytes_per_pixel); break;
+    }
+}
+
+/* In-place transposition of a square image. Swaps mirrored tiles, and pixels inside the diagonal tiles. */
+static inline void transpose_square_in_place_impl(uint8_t *pixels, size_t bytes_per_line, unsigned size,
+                                                  unsigned bytes_per_pixel) {
+
+    for (unsigned tile_row = 0; tile_row < size; tile_row += TILE_SIZE) {
+        const unsigned last_row = (size - tile_row < TILE_SIZE) ? size : tile_row + TILE_SIZE;
+
+        for (unsigned tile_column = tile_row; tile_column < size; tile_column += TILE_SIZE) {
+            const unsigned last_column = (size - tile_column < TILE_SIZE) ? size : tile_column + TILE_SIZE;
+
+            for (unsigned row = tile_row; row < last_row; row++) {
+                const unsigned first_column = (tile_column == tile_row) ? row + 1 : tile_column;
+
+                for (unsigned column = first_column; column < last_column; column++) {
+                    swap_pixels(pixels + bytes_per_line * row + (size_t)column * bytes_per_pixel,
+                                pixels + bytes_per_line * column + (size_t)row * bytes_per_pixel,
+                                bytes_per_pixel);
+                }
+            }
+        }
+    }
+}
+
+static void transpose_square_in_place(uint8_t *pixels, size_t bytes_per_line, unsigned size, unsigned bytes_per_pixel) {
+
+    switch (bytes_per_pixel) {
+        case 1:  transpose_square_in_place_impl(pixels, bytes_per_line, size, 1); break;
+        case 2:  transpose_square_in_place_impl(pixels, bytes_per_line, size, 2); break;
+        case 3:  transpose_square_in_place_impl(pixels, bytes_per_line, size, 3); break;
+        case 4:  transpose_square_in_place_impl(pixels, bytes_per_line, size, 4); break;
+        case 6:  transpose_square_in_place_impl(pixels, bytes_per_line, size, 6); break;
+        case 8:  transpose_square_in_place_impl(pixels, bytes_per_line, size, 8); break;
+        default: transpose_square_in_place_impl(pixels, bytes_per_line, size, bytes_per_pixel); break;
+    }
+}
+
+static void swap_resolution(struct sail_image *image) {
+
+    if (image->resolution != NULL) {
+        const double x = image->resolution->x;
+        image->resolution->x = image->resolution->y;
+        image->resolution->y = x;
+    }
+}
+
+/*
+ * Transposes the image, then flips it, in a single pass into the output pixels. The output image
+ * must have swapped dimensions.
+ */
+static void transpose_and_flip(const struct sail_image *image, int flip, unsigned bytes_per_pixel, struct sail_image *image_output) {
+
+    const bool flip_horizontally = flip & SAIL_FLIP_HORIZONTALLY;
+    const bool flip_vertically   = flip & SAIL_FLIP_VERTICALLY;
+
+    /* Horizontal flips of the output reverse the input rows, and vertical flips reverse the input columns. */
+    struct transpose_geometry geometry;
+    geometry.origin = (const uint8_t *)image->pixels
+                        + (flip_horizontally ? (size_t)image->bytes_per_line * (image->height - 1) : 0)
+                        + (flip_vertically ? (size_t)(image->width - 1) * bytes_per_pixel : 0);
+    geometry.input_row_step        = flip_horizontally ? -(ptrdiff_t)image->bytes_per_line : (ptrdiff_t)image->bytes_per_line;
+    geometry.input_column_step     = flip_vertically ? -(ptrdiff_t)bytes_per_pixel : (ptrdiff_t)bytes_per_pixel;
+    geometry.output                = image_output->pixels;
+    geometry.output_bytes_per_line = image_output->bytes_per_line;
+    geometry.output_width          = image_output->width;
+    geometry.output_height         = image_output->height;
+
+    transpose_tiles(&geometry, bytes_per_pixel);
+}
+
+static sail_status_t alloc_transposed_and_flipped(const struct sail_image *image, int flip, struct sail_image **image_output) {
+
+    unsigned bytes_per_pixel;
+    SAIL_TRY(whole_bytes_per_pixel(image->pixel_format, &bytes_per_pixel));
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+
+    image_local->width  = image->height;
+    image_local->height = image->width;
+    swap_resolution(image_local);
+
+    SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    const size_t pixels_size = (size_t)image_local->height * image_local->bytes_per_line;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    transpose_and_flip(image, flip, bytes_per_pixel, image_local);
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
+
+static sail_status_t orient_impl(struct sail_image *image, bool transpose, int flip) {
+
+    if (!transpose) {
+        SAIL_TRY(sail_flip_image(image, flip));
+        return SAIL_OK;
+    }
+
+    unsigned bytes_per_pixel;
+    SAIL_TRY(whole_bytes_per_pixel(image->pixel_format, &bytes_per_pixel));
+
+    if (image->width == image->height) {
+        SAIL_TRY(sail_make_image_writable(image));
+
+        transpose_square_in_place(image->pixels, image->bytes_per_line, image->width, bytes_per_pixel);
+        swap_resolution(image);
+        SAIL_TRY(sail_flip_image(image, flip));
+        return SAIL_OK;
+    }
+
+    struct sail_image image_output = *image;
+    image_output.width  = image->height;
+    image_output.height = image->width;
+
+    SAIL_TRY(sail_bytes_per_line(image_output.width, image_output.pixel_format, &image_output.bytes_per_line));
+
+    const size_t pixels_size = (size_t)image_output.height * image_output.bytes_per_line;
+    SAIL_TRY(sail_malloc(pixels_size, &image_output.pixels));
+
+    transpose_and_flip(image, flip, bytes_per_pixel, &image_output);
+
+    sail_replace_image_pixels(image, image_output.pixels);
+
+    image->width          = image_output.width;
+    image->height         = image_output.height;
+    image->bytes_per_line = image_output.bytes_per_line;
+    swap_resolution(image);
+
+    return SAIL_OK;
+}
+
+static inline unsigned read_exif16(const uint8_t *data, bool big_endian) {
+
+    return big_endian ? ((unsigned)data[0] << 8) | data[1] : ((unsigned)data[1] << 8) | data[0];
+}
+
+static inline uint32_t read_exif32(const uint8_t *data, bool big_endian) {
+
+    return big_endian ? ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3]
+                      : ((uint32_t)data[3] << 24) | ((uint32_t)data[2] << 16) | ((uint32_t)data[1] << 8) | data[0];
+}
+
+/*
+ * Finds the Orientation tag value in the first IFD of the binary EXIF data. The data may start
+ * with the "Exif\0\0" JPEG APP1 header.
+ *
+ * Returns a pointer to the 16-bit tag value or NULL if it's not found.
+ */
+static uint8_t* find_exif_orientation(uint8_t *data, size_t length, bool *big_endian) {
+
+    if (length >= 6 && memcmp(data, "Exif\0\0", 6) == 0) {
+        data += 6;
+        length -= 6;
+    }
+
+    if (length < 8) {
+        return NULL;
+    }
+
+    if (memcmp(data, "II*\0", 4) == 0) {
+        *big_endian = false;
+    } else if (memcmp(data, "MM\0*", 4) == 0) {
+        *big_endian = true;
+    } else {
+        return NULL;
+    }
+
+    const uint32_t ifd_offset = read_exif32(data + 4, *big_endian);
+
+    if (ifd_offset > length - 2) {
+        return NULL;
+    }
+
+    const unsigned entries = read_exif16(data + ifd_offset, *big_endian);
+
+    for (unsigned i = 0; i < entries; i++) {
+        const size_t entry_offset = (size_t)ifd_offset + 2 + (size_t)i * 12;
+
+        if (entry_offset + 12 > length) {
+            return NULL;
+        }
+
+        const uint8_t *entry = data + entry_offset;
+
+        if (read_exif16(entry, *big_endian) == EXIF_ORIENTATION_TAG) {
+            return (read_exif16(entry + 2, *big_endian) == EXIF_TYPE_SHORT) ? data + entry_offset + 8 : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_flip_image(struct sail_image *image, int flip) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+
+    if (flip & (SAIL_FLIP_HORIZONTALLY | SAIL_FLIP_VERTICALLY)) {
+        SAIL_TRY(sail_make_image_writable(image));
+    }
+
+    if (flip & SAIL_FLIP_HORIZONTALLY) {
+        unsigned bytes_per_pixel;
+        SAIL_TRY(whole_bytes_per_pixel(image->pixel_format, &bytes_per_pixel));
+
+        flip_rows_horizontally(image->pixels, image->bytes_per_line, image->width, image->height, bytes_per_pixel);
+    }
+
+    if (flip & SAIL_FLIP_VERTICALLY) {
+        if (sail_is_planar(image->pixel_format)) {
+            SAIL_LOG_ERROR("Planar pixel formats cannot be flipped vertically, but %s is given",
+                            sail_pixel_format_to_string(image->pixel_format));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+
+        flip_rows_vertically(image->pixels, image->bytes_per_line, image->height);
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_rotate_image(const struct sail_image *image,
+                                enum SailRotation rotation,
+                                struct sail_image **image_output) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_IMAGE_PTR(image_output);
+
+    switch (rotation) {
+        case SAIL_ROTATION_90: {
+            SAIL_TRY(alloc_transposed_and_flipped(image, SAIL_FLIP_HORIZONTALLY, image_output));
+            break;
+        }
+        case SAIL_ROTATION_180: {
+            unsigned bytes_per_pixel;
+            SAIL_TRY(whole_bytes_per_pixel(image->pixel_format, &bytes_per_pixel));
+
+            struct sail_image *image_local;
+            SAIL_TRY(sail_copy_image(image, &image_local));
+
+            SAIL_TRY_OR_CLEANUP(sail_flip_image(image_local, SAIL_FLIP_HORIZONTALLY | SAIL_FLIP_VERTICALLY),
+                                /* cleanup */ sail_destroy_image(image_local));
+
+            *image_output = image_local;
+            break;
+        }
+        case SAIL_ROTATION_270: {
+            SAIL_TRY(alloc_transposed_and_flipped(image, SAIL_FLIP_VERTICALLY, image_output));
+            break;
+        }
+        default: {
+            SAIL_LOG_ERROR("Unknown rotation %d", rotation);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_transpose_image(const struct sail_image *image, struct sail_image **image_output) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_IMAGE_PTR(image_output);
+
+    SAIL_TRY(alloc_transposed_and_flipped(image, 0, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_orient_image(struct sail_image *image, enum SailOrientation orientation) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+
+    bool transpose;
+    int flip;
+    SAIL_TRY(decompose_orientation(orientation, &transpose, &flip));
+
+    SAIL_TRY(orient_impl(image, transpose, flip));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_orientation_from_meta_data(const struct sail_meta_data_node *meta_data_node,
+                                              enum SailOrientation *orientation) {
+
+    SAIL_CHECK_PTR(orientation);
+
+    *orientation = SAIL_ORIENTATION_NORMAL;
+
+    for (; meta_data_node != NULL; meta_data_node = meta_data_node->next) {
+        if (meta_data_node->key != SAIL_META_DATA_EXIF || meta_data_node->value_type != SAIL_META_DATA_TYPE_DATA) {
+            continue;
+        }
+
+        bool big_endian;
+        const uint8_t *value = find_exif_orientation(meta_data_node->value, meta_data_node->value_length, &big_endian);
+
+        if (value != NULL) {
+            const unsigned exif_orientation = read_exif16(value, big_endian);
+
+            if (exif_orientation >= SAIL_ORIENTATION_NORMAL && exif_orientation <= SAIL_ORIENTATION_ROTATE_270) {
+                *orientation = (enum SailOrientation)exif_orientation;
+            }
+
+            break;
+        }
+    }
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_auto_orient_image(struct sail_image *image) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+
+    enum SailOrientation orientation;
+    SAIL_TRY(sail_orientation_from_meta_data(image->meta_data_node, &orientation));
+
+    bool transpose;
+    int flip;
+    SAIL_TRY(decompose_orientation(orientation, &transpose, &flip));
+
+    /*
+     * The vertically flipped rows are flipped back before the EXIF orientation. Flipping the input
+     * rows vertically is the same as flipping the transposed output horizontally.
+     */
+    if (image->properties & SAIL_IMAGE_PROPERTY_FLIPPED_VERTICALLY) {
+        flip ^= transpose ? SAIL_FLIP_HORIZONTALLY : SAIL_FLIP_VERTICALLY;
+    }
+
+    SAIL_TRY(orient_impl(image, transpose, flip));
+
+    image->properties &= ~SAIL_IMAGE_PROPERTY_FLIPPED_VERTICALLY;
+
+    /* Reset the EXIF orientation, so the image is not oriented again when it's saved and loaded. */
+    for (struct sail_meta_data_node *meta_data_node = image->meta_data_node; meta_data_node != NULL; meta_data_node = meta_data_node->next) {
+        if (meta_data_node->key != SAIL_META_DATA_EXIF || meta_data_node->value_type != SAIL_META_DATA_TYPE_DATA) {
+            continue;
+        }
+
+        bool big_endian;
+        uint8_t *value = find_exif_orientation(meta_data_node->value, meta_data_node->value_length, &big_endian);
+
+        if (value != NULL) {
+            value[0] = big_endian ? 0 : SAIL_ORIENTATION_NORMAL;
+            value[1] = big_endian ? SAIL_ORIENTATION_NORMAL : 0;
+        }
+    }
+
+    return SAIL_OK;
+}
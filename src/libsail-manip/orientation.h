@@ -0,0 +1,128 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_ORIENTATION_H
+#define SAIL_ORIENTATION_H
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+
+    #include "manip_common.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/manip_common.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_image;
+struct sail_meta_data_node;
+
+/*
+ * Flips the image in place. Flip is an or-ed SailFlip.
+ *
+ * Vertical flipping supports any pixel format. Horizontal flipping supports pixel formats
+ * with at least 8 bits per pixel.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_flip_image(struct sail_image *image, int flip);
+
+/*
+ * Rotates the input image clockwise and saves the result in the output image.
+ * The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * 90 and 270 degrees rotations are done in cache-sized tiles in a single pass. The resulting image
+ * gets swapped dimensions and resolution, and updated bytes per line. Other properties are copied from
+ * the original image.
+ *
+ * Allowed pixel formats:
+ *   - Anything with at least 8 bits per pixel
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_rotate_image(const struct sail_image *image,
+                                            enum SailRotation rotation,
+                                            struct sail_image **image_output);
+
+/*
+ * Mirrors the input image along the top-left to bottom-right diagonal and saves the result
+ * in the output image. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * The transposition is done in cache-sized tiles. The resulting image gets swapped dimensions
+ * and resolution, and updated bytes per line. Other properties are copied from the original image.
+ *
+ * Allowed pixel formats:
+ *   - Anything with at least 8 bits per pixel
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_transpose_image(const struct sail_image *image, struct sail_image **image_output);
+
+/*
+ * Transforms the image pixels stored in the orientation to be displayed correctly.
+ *
+ * Flips and 180 degrees rotations are done in place. Transpositions and 90/270 degrees
+ * rotations are done in place for square images. For other images, a new pixel buffer
+ * is allocated, and the old one is freed. The image gets swapped dimensions and resolution,
+ * and updated bytes per line.
+ *
+ * Allowed pixel formats:
+ *   - Anything for SAIL_ORIENTATION_NORMAL and SAIL_ORIENTATION_FLIP_VERTICAL
+ *   - Anything with at least 8 bits per pixel for the other orientations
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_orient_image(struct sail_image *image, enum SailOrientation orientation);
+
+/*
+ * Finds the orientation in the binary EXIF meta data (SAIL_META_DATA_EXIF) of the meta data chain.
+ * Assigns SAIL_ORIENTATION_NORMAL if the chain has no EXIF orientation.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_orientation_from_meta_data(const struct sail_meta_data_node *meta_data_node,
+                                                          enum SailOrientation *orientation);
+
+/*
+ * Orients the image to be displayed correctly. Applies SAIL_IMAGE_PROPERTY_FLIPPED_VERTICALLY
+ * and the EXIF orientation in a single transformation with sail_orient_image(). Then removes
+ * the property, and resets the EXIF orientation to normal, so the image is never oriented twice.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_auto_orient_image(struct sail_image *image);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
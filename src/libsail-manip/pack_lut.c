@@ -0,0 +1,106 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+void init_pack_lut(struct pack_lut *lut, unsigned bits_per_index, bool dither) {
+
+    const unsigned indexes_per_byte = 8 / bits_per_index;
+    const unsigned max_index = (1U << bits_per_index) - 1;
+
+    lut->bits_per_index = bits_per_index;
+    lut->rows           = dither ? 8 : 1;
+
+    for (unsigned row = 0; row < lut->rows; row++) {
+        for (unsigned column = 0; column < 8; column++) {
+            const unsigned shift = 8 - bits_per_index * (column % indexes_per_byte + 1);
+
+            for (unsigned value = 0; value < 256; value++) {
+                unsigned index;
+
+                if (dither) {
+                    /* floor(value * max_index / 255 + (threshold + 0.5) / 64). Black and white are never dithered. */
+                    index = (value * max_index * 128 + (2 * BAYER8[row][column] + 1) * 255) / (255 * 128);
+                } else {
+                    index = (value * max_index + 127) / 255;
+                }
+
+                lut->shifted[row][column][value] = (uint8_t)(index << shift);
+            }
+        }
+    }
+}
+
+/*
+ * Called with constant bits_per_index, so compilers unroll the inner loops.
+ */
+static inline void pack_row(const uint8_t (*tables)[256], const uint8_t *src, uint8_t *dst, unsigned width, unsigned bits_per_index) {
+
+    const unsigned indexes_per_byte = 8 / bits_per_index;
+    unsigned column = 0;
+
+    /* 8 pixels fill 1, 2, or 4 whole output bytes. */
+    for (; column + 8 <= width; column += 8) {
+        for (unsigned i = 0; i < bits_per_index; i++) {
+            const uint8_t *pixels = src + column + i * indexes_per_byte;
+            uint8_t byte = 0;
+
+            for (unsigned k = 0; k < indexes_per_byte; k++) {
+                byte |= tables[i * indexes_per_byte + k][pixels[k]];
+            }
+
+            *dst++ = byte;
+        }
+    }
+
+    if (column < width) {
+        /* Accumulate locally as the output may overlap the input. */
+        uint8_t bytes[4] = { 0, 0, 0, 0 };
+        const unsigned rest = width - column;
+
+        for (unsigned i = 0; i < rest; i++) {
+            bytes[i / indexes_per_byte] |= tables[i][src[column + i]];
+        }
+
+        memcpy(dst, bytes, (rest + indexes_per_byte - 1) / indexes_per_byte);
+    }
+}
+
+void pack_gray8_row(const struct pack_lut *lut, const uint8_t *src, uint8_t *dst, unsigned width, unsigned row) {
+
+    const uint8_t (*tables)[256] = lut->shifted[(lut->rows == 1) ? 0 : row % 8];
+
+    switch (lut->bits_per_index) {
+        case 1: pack_row(tables, src, dst, width, 1); break;
+        case 2: pack_row(tables, src, dst, width, 2); break;
+        case 4: pack_row(tables, src, dst, width, 4); break;
+    }
+}
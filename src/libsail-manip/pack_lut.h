@@ -0,0 +1,65 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PACK_LUT_H
+#define SAIL_PACK_LUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "export.h"
+
+/*
+ * Lookup table to pack 8-bit gray levels into 1/2/4-bit grayscale or indexed pixels, most
+ * significant bits first. Every possible gray level is quantized once per conversion and shifted
+ * into its bit position in the output byte, so packing 8 pixels takes 8 table lookups and ORs.
+ */
+struct pack_lut {
+    /* 1, 2, or 4. */
+    unsigned bits_per_index;
+
+    /* 1 if the gray levels are thresholded, 8 if they are dithered with the 8x8 Bayer matrix. */
+    unsigned rows;
+
+    /*
+     * Shifted indexes for every Bayer matrix row, column modulo 8, and gray level. Columns modulo 8
+     * also define the bit positions as 8 pixels always fill whole output bytes.
+     */
+    uint8_t shifted[8][8][256];
+};
+
+/*
+ * Initializes the LUT. Thresholding maps every gray level to the nearest of the 2^bits_per_index
+ * evenly spaced levels from black to white, ordered dithering adds an 8x8 Bayer matrix pattern first.
+ */
+SAIL_HIDDEN void init_pack_lut(struct pack_lut *lut, unsigned bits_per_index, bool dither);
+
+/*
+ * Packs the 8-bit gray row with the specified index in the image. Padding bits in the last
+ * output byte are zeroed. The output may overlap the input if it doesn't start after it.
+ */
+SAIL_HIDDEN void pack_gray8_row(const struct pack_lut *lut, const uint8_t *src, uint8_t *dst, unsigned width, unsigned row);
+
+#endif
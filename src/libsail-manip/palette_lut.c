@@ -0,0 +1,150 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+void init_palette_lut(struct palette_lut *lut, unsigned bits_per_index, unsigned bytes_per_pixel, unsigned color_count) {
+
+    const unsigned indexes_per_byte = 8 / bits_per_index;
+    const unsigned index_mask = (1U << bits_per_index) - 1;
+
+    lut->bytes_per_pixel = bytes_per_pixel;
+    lut->bits_per_index  = bits_per_index;
+    lut->color_count     = color_count;
+
+    memset(lut->pixels, 0, sizeof(lut->pixels));
+
+    for (unsigned byte = 0; byte < 256; byte++) {
+        uint8_t max_index = 0;
+
+        for (unsigned i = 0; i < indexes_per_byte; i++) {
+            const uint8_t index = (uint8_t)((byte >> (8 - bits_per_index * (i + 1))) & index_mask);
+
+            lut->unpacked[byte][i] = index;
+
+            if (index > max_index) {
+                max_index = index;
+            }
+        }
+
+        lut->max_index[byte] = max_index;
+    }
+}
+
+sail_status_t validate_palette_lut_row(const struct palette_lut *lut, const uint8_t *src, unsigned width) {
+
+    /* All possible indexes are in range. */
+    if (lut->color_count >= (1U << lut->bits_per_index)) {
+        return SAIL_OK;
+    }
+
+    const unsigned indexes_per_byte = 8 / lut->bits_per_index;
+    const unsigned full_bytes = width / indexes_per_byte;
+    const unsigned rest = width % indexes_per_byte;
+
+    uint8_t max_index = 0;
+
+    for (unsigned i = 0; i < full_bytes; i++) {
+        const uint8_t index = lut->max_index[src[i]];
+
+        if (index > max_index) {
+            max_index = index;
+        }
+    }
+
+    /* Ignore padding bits in the last byte. */
+    for (unsigned i = 0; i < rest; i++) {
+        const uint8_t index = lut->unpacked[src[full_bytes]][i];
+
+        if (index > max_index) {
+            max_index = index;
+        }
+    }
+
+    if (max_index >= lut->color_count) {
+        SAIL_LOG_ERROR("Palette index %u is out of range [0; %u)", max_index, lut->color_count);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_BROKEN_IMAGE);
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Called with constant bytes_per_pixel, so compilers turn memcpy() into plain loads and stores.
+ */
+static inline void gather_row(const struct palette_lut *lut, const uint8_t *src, uint8_t *dst, unsigned width, size_t bytes_per_pixel) {
+
+    if (lut->bits_per_index == 8) {
+        for (unsigned column = 0; column < width; column++) {
+            memcpy(dst, lut->pixels + src[column] * bytes_per_pixel, bytes_per_pixel);
+            dst += bytes_per_pixel;
+        }
+
+        return;
+    }
+
+    const unsigned indexes_per_byte = 8 / lut->bits_per_index;
+    unsigned column = 0;
+
+    /* Unpack all indexes of an input byte at once. */
+    for (; column + indexes_per_byte <= width; column += indexes_per_byte) {
+        const uint8_t *indexes = lut->unpacked[*src++];
+
+        for (unsigned i = 0; i < indexes_per_byte; i++) {
+            memcpy(dst, lut->pixels + indexes[i] * bytes_per_pixel, bytes_per_pixel);
+            dst += bytes_per_pixel;
+        }
+    }
+
+    if (column < width) {
+        const uint8_t *indexes = lut->unpacked[*src];
+
+        for (unsigned i = 0; column < width; i++, column++) {
+            memcpy(dst, lut->pixels + indexes[i] * bytes_per_pixel, bytes_per_pixel);
+            dst += bytes_per_pixel;
+        }
+    }
+}
+
+void convert_palette_lut_row(const struct palette_lut *lut, const uint8_t *src, uint8_t *dst, unsigned width) {
+
+    switch (lut->bytes_per_pixel) {
+        case 1: gather_row(lut, src, dst, width, 1); break;
+        case 2: gather_row(lut, src, dst, width, 2); break;
+        case 3: gather_row(lut, src, dst, width, 3); break;
+        case 4: gather_row(lut, src, dst, width, 4); break;
+        case 6: gather_row(lut, src, dst, width, 6); break;
+        case 8: gather_row(lut, src, dst, width, 8); break;
+        case 12: gather_row(lut, src, dst, width, 12); break;
+        case 16: gather_row(lut, src, dst, width, 16); break;
+        default: gather_row(lut, src, dst, width, lut->bytes_per_pixel); break;
+    }
+}
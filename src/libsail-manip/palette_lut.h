@@ -0,0 +1,76 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PALETTE_LUT_H
+#define SAIL_PALETTE_LUT_H
+
+#include <stdint.h>
+
+#include "error.h"
+#include "export.h"
+
+/* The largest output pixel is BPP128-RGBA-FLOAT. */
+#define PALETTE_LUT_MAX_BYTES_PER_PIXEL 16
+
+/*
+ * Lookup table to convert 1/2/4/8-bit indexed or grayscale pixels. Every possible index is expanded
+ * once per conversion into a ready output pixel in the output pixel format and channel order,
+ * so converting a pixel is a table lookup.
+ */
+struct palette_lut {
+    /* Output pixels for every index. */
+    uint8_t pixels[256 * PALETTE_LUT_MAX_BYTES_PER_PIXEL];
+    unsigned bytes_per_pixel;
+
+    /* 1, 2, 4, or 8. */
+    unsigned bits_per_index;
+
+    /* Indexes greater or equal than this are out of range. */
+    unsigned color_count;
+
+    /* Indexes packed into every possible input byte, most significant bits first. Used for 1/2/4 bits. */
+    uint8_t unpacked[256][8];
+
+    /* The largest index packed into every possible input byte. */
+    uint8_t max_index[256];
+};
+
+/*
+ * Initializes the index tables of the LUT. Output pixels must be filled by the caller.
+ */
+SAIL_HIDDEN void init_palette_lut(struct palette_lut *lut, unsigned bits_per_index, unsigned bytes_per_pixel, unsigned color_count);
+
+/*
+ * Checks that all indexes in the input row are less than color_count.
+ * Returns SAIL_ERROR_BROKEN_IMAGE otherwise.
+ */
+SAIL_HIDDEN sail_status_t validate_palette_lut_row(const struct palette_lut *lut, const uint8_t *src, unsigned width);
+
+/*
+ * Converts a validated input row into output pixels.
+ */
+SAIL_HIDDEN void convert_palette_lut_row(const struct palette_lut *lut, const uint8_t *src, uint8_t *dst, unsigned width);
+
+#endif
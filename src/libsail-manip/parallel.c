@@ -0,0 +1,190 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef SAIL_WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+/* Band size to keep input and output rows of a band in L2 cache. */
+static const size_t BAND_SIZE = 256 * 1024;
+
+struct worker {
+    process_rows_t process_rows;
+    void *context;
+
+    unsigned height;
+    unsigned rows_per_band;
+    unsigned bands;
+
+    /* The worker processes bands index, index + step, index + 2 * step, etc. */
+    unsigned index;
+    unsigned step;
+
+    sail_status_t status;
+};
+
+static void run_worker(struct worker *worker) {
+
+    worker->status = SAIL_OK;
+
+    for (unsigned band = worker->index; band < worker->bands; band += worker->step) {
+        const unsigned first_row = band * worker->rows_per_band;
+        const unsigned rows = (worker->height - first_row < worker->rows_per_band) ? worker->height - first_row : worker->rows_per_band;
+
+        const sail_status_t status = worker->process_rows(worker->context, first_row, rows);
+
+        if (status != SAIL_OK) {
+            worker->status = status;
+            return;
+        }
+    }
+}
+
+#ifdef SAIL_WIN32
+typedef HANDLE thread_t;
+
+static DWORD WINAPI thread_routine(LPVOID arg) {
+
+    run_worker(arg);
+    return 0;
+}
+
+static bool start_thread(thread_t *thread, struct worker *worker) {
+
+    *thread = CreateThread(NULL, 0, thread_routine, worker, 0, NULL);
+    return *thread != NULL;
+}
+
+static void join_thread(thread_t thread) {
+
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+#else
+typedef pthread_t thread_t;
+
+static void* thread_routine(void *arg) {
+
+    run_worker(arg);
+    return NULL;
+}
+
+static bool start_thread(thread_t *thread, struct worker *worker) {
+
+    return pthread_create(thread, NULL, thread_routine, worker) == 0;
+}
+
+static void join_thread(thread_t thread) {
+
+    pthread_join(thread, NULL);
+}
+#endif
+
+unsigned cpu_cores(void) {
+
+#ifdef SAIL_WIN32
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+
+    return system_info.dwNumberOfProcessors > 0 ? (unsigned)system_info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cores > 0 ? (unsigned)cores : 1;
+#else
+    return 1;
+#endif
+}
+
+sail_status_t process_rows_in_parallel(unsigned height, size_t bytes_per_row, unsigned threads,
+                                       process_rows_t process_rows, void *context) {
+
+    if (threads == SAIL_THREADS_AUTO) {
+        threads = cpu_cores();
+    }
+
+    const size_t rows_per_band = (bytes_per_row == 0 || bytes_per_row >= BAND_SIZE) ? 1 : BAND_SIZE / bytes_per_row;
+    const unsigned bands = (unsigned)((height + rows_per_band - 1) / rows_per_band);
+
+    if (threads > bands) {
+        threads = bands;
+    }
+    if (threads > SAIL_MAX_THREADS) {
+        threads = SAIL_MAX_THREADS;
+    }
+
+    if (threads <= 1) {
+        SAIL_TRY(process_rows(context, 0, height));
+        return SAIL_OK;
+    }
+
+    struct worker workers[SAIL_MAX_THREADS];
+    thread_t thread_handles[SAIL_MAX_THREADS];
+    bool started[SAIL_MAX_THREADS];
+
+    for (unsigned i = 0; i < threads; i++) {
+        workers[i].process_rows  = process_rows;
+        workers[i].context       = context;
+        workers[i].height        = height;
+        workers[i].rows_per_band = (unsigned)rows_per_band;
+        workers[i].bands         = bands;
+        workers[i].index         = i;
+        workers[i].step          = threads;
+        workers[i].status        = SAIL_OK;
+    }
+
+    /* Worker #0 runs in the calling thread. */
+    for (unsigned i = 1; i < threads; i++) {
+        started[i] = start_thread(&thread_handles[i], &workers[i]);
+    }
+
+    run_worker(&workers[0]);
+
+    for (unsigned i = 1; i < threads; i++) {
+        if (started[i]) {
+            join_thread(thread_handles[i]);
+        } else {
+            run_worker(&workers[i]);
+        }
+    }
+
+    for (unsigned i = 0; i < threads; i++) {
+        SAIL_TRY(workers[i].status);
+    }
+
+    return SAIL_OK;
+}
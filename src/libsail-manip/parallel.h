@@ -0,0 +1,69 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PARALLEL_H
+#define SAIL_PARALLEL_H
+
+#include <stddef.h>
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+/*
+ * Hard limit for the number of threads libsail-manip and libsail start at once.
+ */
+#define SAIL_MAX_THREADS 64
+
+/*
+ * Processes 'rows' rows starting from 'first_row'. Called concurrently from multiple threads
+ * for non-overlapping row ranges.
+ */
+typedef sail_status_t (*process_rows_t)(void *context, unsigned first_row, unsigned rows);
+
+/*
+ * Returns the number of online CPU cores or 1 if it's unknown.
+ */
+SAIL_HIDDEN unsigned cpu_cores(void);
+
+/*
+ * Splits 'height' rows into cache-sized bands and processes them with up to 'threads' threads
+ * including the calling thread. 'bytes_per_row' is the number of bytes read and written per row,
+ * and it's used to size the bands. 'threads' equal to 0 or 1 means the calling thread only,
+ * and SAIL_THREADS_AUTO means the number of CPU cores.
+ *
+ * Small images are processed in the calling thread. If a thread cannot be started,
+ * its bands are processed in the calling thread.
+ *
+ * Returns SAIL_OK on success or the first error returned by process_rows().
+ */
+SAIL_HIDDEN sail_status_t process_rows_in_parallel(unsigned height, size_t bytes_per_row, unsigned threads,
+                                                   process_rows_t process_rows, void *context);
+
+#endif
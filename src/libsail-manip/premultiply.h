@@ -0,0 +1,88 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_PREMULTIPLY_H
+#define SAIL_PREMULTIPLY_H
+
+#include <stdint.h>
+
+#include "export.h"
+
+#include "manip_utils.h"
+
+/*
+ * Premultiplied alpha math. Premultiplying and unpremultiplying round to the nearest integer,
+ * so premultiplying an unpremultiplied component gives the original component back.
+ */
+
+/*
+ * Premultiplies an 8-bit color component by an 8-bit alpha: round(c*a / 255).
+ */
+static inline uint8_t premultiply8(uint8_t c, uint8_t a) {
+
+    return (uint8_t)div255_round((uint32_t)c * a);
+}
+
+/*
+ * Premultiplies a 16-bit color component by a 16-bit alpha: round(c*a / 65535).
+ */
+static inline uint16_t premultiply16(uint16_t c, uint16_t a) {
+
+    return (uint16_t)div65535_round((uint32_t)c * a);
+}
+
+/*
+ * ceil(255 * 65536 / a) for every 8-bit alpha and 0 for zero alpha. Multiplying by these reciprocals
+ * gives exactly round(c*255 / a) for all c <= a.
+ */
+SAIL_HIDDEN extern const uint32_t UNPREMULTIPLY8_RECIPROCALS[256];
+
+/*
+ * Restores an 8-bit color component premultiplied by an 8-bit alpha: round(c*255 / a).
+ * Components greater than alpha are clamped to 255. Zero alpha gives 0.
+ */
+static inline uint8_t unpremultiply8(uint8_t c, uint8_t a) {
+
+    const uint32_t value = ((uint32_t)c * UNPREMULTIPLY8_RECIPROCALS[a] + 32768) >> 16;
+
+    return (value > 255) ? 255 : (uint8_t)value;
+}
+
+/*
+ * Restores a 16-bit color component premultiplied by a 16-bit alpha: round(c*65535 / a).
+ * Components greater than alpha are clamped to 65535. Zero alpha gives 0.
+ */
+static inline uint16_t unpremultiply16(uint16_t c, uint16_t a) {
+
+    if (a == 0) {
+        return 0;
+    }
+
+    const uint32_t value = ((uint32_t)c * 65535 + a / 2) / a;
+
+    return (value > 65535) ? 65535 : (uint16_t)value;
+}
+
+#endif
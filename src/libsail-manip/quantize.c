@@ -0,0 +1,765 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-manip.h"
+
+/*
+ * Color histogram. Bins hold 5 bits per channel.
+ */
+#define HISTOGRAM_BITS 5
+#define HISTOGRAM_SIZE (1 << (HISTOGRAM_BITS * 3))
+
+struct histogram_bin {
+    uint64_t count;
+    uint64_t sum[3];
+};
+
+/*
+ * Distinct colors of the image. Tracked until there are more than max_colors of them.
+ * Open addressing with linear probing.
+ */
+#define COLOR_SET_SIZE 1024
+
+struct color_set {
+    /* 0 in empty slots, 0xFF000000 | RGB in used ones. */
+    uint32_t colors[COLOR_SET_SIZE];
+    uint8_t indexes[COLOR_SET_SIZE];
+    unsigned count;
+};
+
+/*
+ * Inverse color map. Maps colors with 6 bits per channel to the nearest palette indexes.
+ */
+#define INVERSE_BITS 6
+#define INVERSE_SIZE (1 << (INVERSE_BITS * 3))
+
+/* Median cut input: a non-empty histogram bin. */
+struct cut_bin {
+    uint64_t count;
+    uint64_t sum[3];
+    uint8_t color[3];
+};
+
+/* Median cut box: a range of bins sorted along some axis. */
+struct cut_box {
+    unsigned first;
+    unsigned length;
+    uint64_t count;
+    unsigned axis;
+    unsigned range;
+};
+
+/* k-d tree node. Children are -1 if they don't exist. */
+struct kd_node {
+    uint8_t color[3];
+    uint8_t index;
+    unsigned axis;
+    int left;
+    int right;
+};
+
+struct quantize_context {
+    /* BPP24-RGB image. */
+    const struct sail_image *image;
+    struct sail_image *image_output;
+    unsigned bits_per_index;
+    enum SailDither dither;
+    int dither_spread;
+
+    struct histogram_bin *histogram;
+    struct color_set *color_set;
+    bool exact;
+
+    /* Palette colors, 3 bytes per color. */
+    uint8_t *palette;
+    unsigned color_count;
+
+    struct kd_node *kd_tree;
+    int kd_root;
+    uint8_t *inverse;
+};
+
+static void destroy_quantize_context(struct quantize_context *quantize_context) {
+
+    sail_free(quantize_context->histogram);
+    sail_free(quantize_context->color_set);
+    sail_free(quantize_context->kd_tree);
+    sail_free(quantize_context->inverse);
+}
+
+static inline uint8_t clamp8(int value) {
+
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline uint32_t pack_color(const uint8_t *pixel) {
+
+    return 0xFF000000u | ((uint32_t)pixel[0] << 16) | ((uint32_t)pixel[1] << 8) | pixel[2];
+}
+
+static inline unsigned color_set_slot(const struct color_set *color_set, uint32_t color) {
+
+    unsigned slot = (color * 2654435761u) >> (32 - 10);
+
+    while (color_set->colors[slot] != 0 && color_set->colors[slot] != color) {
+        slot = (slot + 1) & (COLOR_SET_SIZE - 1);
+    }
+
+    return slot;
+}
+
+static inline unsigned inverse_index(unsigned r, unsigned g, unsigned b) {
+
+    const unsigned shift = 8 - INVERSE_BITS;
+
+    return ((r >> shift) << (INVERSE_BITS * 2)) | ((g >> shift) << INVERSE_BITS) | (b >> shift);
+}
+
+/* Indexes are packed starting from the most significant bits. */
+static inline void store_index(uint8_t *scan, unsigned column, unsigned bits_per_index, uint8_t index) {
+
+    if (bits_per_index == 8) {
+        scan[column] = index;
+        return;
+    }
+
+    const unsigned indexes_per_byte = 8 / bits_per_index;
+    const unsigned shift = 8 - bits_per_index * (column % indexes_per_byte + 1);
+
+    scan[column / indexes_per_byte] |= (uint8_t)(index << shift);
+}
+
+/*
+ * Histogram and distinct colors.
+ */
+
+static void build_histogram(struct quantize_context *quantize_context, unsigned max_colors) {
+
+    const struct sail_image *image = quantize_context->image;
+    struct histogram_bin *histogram = quantize_context->histogram;
+    struct color_set *color_set = quantize_context->color_set;
+
+    uint32_t last_color = 0;
+    quantize_context->exact = true;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++, scan += 3) {
+            struct histogram_bin *bin = &histogram[((unsigned)(scan[0] >> 3) << 10) | ((unsigned)(scan[1] >> 3) << 5) | (scan[2] >> 3)];
+
+            bin->count++;
+            bin->sum[0] += scan[0];
+            bin->sum[1] += scan[1];
+            bin->sum[2] += scan[2];
+
+            if (!quantize_context->exact) {
+                continue;
+            }
+
+            const uint32_t color = pack_color(scan);
+
+            if (color == last_color) {
+                continue;
+            }
+
+            last_color = color;
+
+            const unsigned slot = color_set_slot(color_set, color);
+
+            if (color_set->colors[slot] == 0) {
+                if (color_set->count == max_colors) {
+                    quantize_context->exact = false;
+                } else {
+                    color_set->colors[slot]  = color;
+                    color_set->indexes[slot] = (uint8_t)color_set->count++;
+                }
+            }
+        }
+    }
+}
+
+static void build_exact_palette(struct quantize_context *quantize_context) {
+
+    const struct color_set *color_set = quantize_context->color_set;
+
+    for (unsigned slot = 0; slot < COLOR_SET_SIZE; slot++) {
+        if (color_set->colors[slot] != 0) {
+            uint8_t *entry = quantize_context->palette + color_set->indexes[slot] * 3;
+
+            entry[0] = (uint8_t)(color_set->colors[slot] >> 16);
+            entry[1] = (uint8_t)(color_set->colors[slot] >> 8);
+            entry[2] = (uint8_t)color_set->colors[slot];
+        }
+    }
+}
+
+/*
+ * Median cut.
+ */
+
+#define DEFINE_COMPARE_CUT_BINS(axis)                                         \
+static int compare_cut_bins##axis(const void *a, const void *b) {             \
+                                                                              \
+    return (int)((const struct cut_bin *)a)->color[axis]                      \
+                - (int)((const struct cut_bin *)b)->color[axis];              \
+}
+
+DEFINE_COMPARE_CUT_BINS(0)
+DEFINE_COMPARE_CUT_BINS(1)
+DEFINE_COMPARE_CUT_BINS(2)
+
+static void update_cut_box(const struct cut_bin *bins, struct cut_box *box) {
+
+    unsigned min[3] = { 255, 255, 255 };
+    unsigned max[3] = { 0, 0, 0 };
+
+    for (unsigned i = box->first; i < box->first + box->length; i++) {
+        for (unsigned c = 0; c < 3; c++) {
+            if (bins[i].color[c] < min[c]) {
+                min[c] = bins[i].color[c];
+            }
+            if (bins[i].color[c] > max[c]) {
+                max[c] = bins[i].color[c];
+            }
+        }
+    }
+
+    box->axis = 0;
+
+    for (unsigned c = 1; c < 3; c++) {
+        if (max[c] - min[c] > max[box->axis] - min[box->axis]) {
+            box->axis = c;
+        }
+    }
+
+    box->range = max[box->axis] - min[box->axis];
+}
+
+/*
+ * Splits the boxes with the most pixels times the longest side at their weighted medians
+ * until there are max_colors boxes or nothing to split.
+ */
+static unsigned median_cut(struct cut_bin *bins, unsigned bins_count, unsigned max_colors, struct cut_box *boxes) {
+
+    static int (* const COMPARE_CUT_BINS[3])(const void *, const void *) = {
+        compare_cut_bins0, compare_cut_bins1, compare_cut_bins2
+    };
+
+    boxes[0].first  = 0;
+    boxes[0].length = bins_count;
+    boxes[0].count  = 0;
+
+    for (unsigned i = 0; i < bins_count; i++) {
+        boxes[0].count += bins[i].count;
+    }
+
+    update_cut_box(bins, &boxes[0]);
+
+    unsigned boxes_count = 1;
+
+    while (boxes_count < max_colors) {
+        struct cut_box *box = NULL;
+        uint64_t best_score = 0;
+
+        for (unsigned i = 0; i < boxes_count; i++) {
+            const uint64_t score = boxes[i].count * boxes[i].range;
+
+            if (boxes[i].length > 1 && score > best_score) {
+                best_score = score;
+                box = &boxes[i];
+            }
+        }
+
+        if (box == NULL) {
+            break;
+        }
+
+        qsort(bins + box->first, box->length, sizeof(struct cut_bin), COMPARE_CUT_BINS[box->axis]);
+
+        /* Left half gets [1; length - 1] bins. */
+        uint64_t left_count = bins[box->first].count;
+        unsigned split = 1;
+
+        while (split < box->length - 1 && left_count * 2 < box->count) {
+            left_count += bins[box->first + split].count;
+            split++;
+        }
+
+        struct cut_box *new_box = &boxes[boxes_count++];
+
+        new_box->first  = box->first + split;
+        new_box->length = box->length - split;
+        new_box->count  = box->count - left_count;
+
+        box->length = split;
+        box->count  = left_count;
+
+        update_cut_box(bins, box);
+        update_cut_box(bins, new_box);
+    }
+
+    return boxes_count;
+}
+
+static sail_status_t build_median_cut_palette(struct quantize_context *quantize_context, unsigned max_colors) {
+
+    unsigned bins_count = 0;
+
+    for (unsigned i = 0; i < HISTOGRAM_SIZE; i++) {
+        if (quantize_context->histogram[i].count > 0) {
+            bins_count++;
+        }
+    }
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct cut_bin) * bins_count + sizeof(struct cut_box) * max_colors, &ptr));
+
+    struct cut_bin *bins = ptr;
+    struct cut_box *boxes = (struct cut_box *)(bins + bins_count);
+
+    for (unsigned i = 0, bin = 0; i < HISTOGRAM_SIZE; i++) {
+        const struct histogram_bin *histogram_bin = &quantize_context->histogram[i];
+
+        if (histogram_bin->count > 0) {
+            bins[bin].count    = histogram_bin->count;
+            bins[bin].sum[0]   = histogram_bin->sum[0];
+            bins[bin].sum[1]   = histogram_bin->sum[1];
+            bins[bin].sum[2]   = histogram_bin->sum[2];
+            bins[bin].color[0] = (uint8_t)(i >> (HISTOGRAM_BITS * 2));
+            bins[bin].color[1] = (uint8_t)((i >> HISTOGRAM_BITS) & ((1 << HISTOGRAM_BITS) - 1));
+            bins[bin].color[2] = (uint8_t)(i & ((1 << HISTOGRAM_BITS) - 1));
+            bin++;
+        }
+    }
+
+    const unsigned boxes_count = median_cut(bins, bins_count, max_colors, boxes);
+
+    /* Every palette color is the mean of the pixels in its box. */
+    for (unsigned i = 0; i < boxes_count; i++) {
+        uint64_t sum[3] = { 0, 0, 0 };
+
+        for (unsigned bin = boxes[i].first; bin < boxes[i].first + boxes[i].length; bin++) {
+            sum[0] += bins[bin].sum[0];
+            sum[1] += bins[bin].sum[1];
+            sum[2] += bins[bin].sum[2];
+        }
+
+        for (unsigned c = 0; c < 3; c++) {
+            quantize_context->palette[i * 3 + c] = (uint8_t)((sum[c] + boxes[i].count / 2) / boxes[i].count);
+        }
+    }
+
+    quantize_context->color_count = boxes_count;
+
+    sail_free(ptr);
+
+    return SAIL_OK;
+}
+
+/*
+ * k-d tree and inverse color map.
+ */
+
+static int build_kd_tree(struct kd_node *nodes, unsigned *nodes_count, uint8_t *indexes, unsigned count, const uint8_t *palette) {
+
+    if (count == 0) {
+        return -1;
+    }
+
+    /* Split along the widest axis. */
+    unsigned min[3] = { 255, 255, 255 };
+    unsigned max[3] = { 0, 0, 0 };
+
+    for (unsigned i = 0; i < count; i++) {
+        for (unsigned c = 0; c < 3; c++) {
+            const unsigned value = palette[indexes[i] * 3 + c];
+
+            if (value < min[c]) {
+                min[c] = value;
+            }
+            if (value > max[c]) {
+                max[c] = value;
+            }
+        }
+    }
+
+    unsigned axis = 0;
+
+    for (unsigned c = 1; c < 3; c++) {
+        if (max[c] - min[c] > max[axis] - min[axis]) {
+            axis = c;
+        }
+    }
+
+    /* Insertion sort. There are no more than 256 colors. */
+    for (unsigned i = 1; i < count; i++) {
+        const uint8_t index = indexes[i];
+        unsigned j = i;
+
+        while (j > 0 && palette[indexes[j - 1] * 3 + axis] > palette[index * 3 + axis]) {
+            indexes[j] = indexes[j - 1];
+            j--;
+        }
+
+        indexes[j] = index;
+    }
+
+    const unsigned median = count / 2;
+    const int node_index = (int)(*nodes_count)++;
+    struct kd_node *node = &nodes[node_index];
+
+    node->index    = indexes[median];
+    node->color[0] = palette[node->index * 3 + 0];
+    node->color[1] = palette[node->index * 3 + 1];
+    node->color[2] = palette[node->index * 3 + 2];
+    node->axis     = axis;
+
+    const int left = build_kd_tree(nodes, nodes_count, indexes, median, palette);
+    const int right = build_kd_tree(nodes, nodes_count, indexes + median + 1, count - median - 1, palette);
+
+    nodes[node_index].left  = left;
+    nodes[node_index].right = right;
+
+    return node_index;
+}
+
+static void find_nearest(const struct kd_node *nodes, int node_index, const int color[3], int *best_distance, uint8_t *best_index) {
+
+    if (node_index < 0) {
+        return;
+    }
+
+    const struct kd_node *node = &nodes[node_index];
+
+    const int d0 = color[0] - node->color[0];
+    const int d1 = color[1] - node->color[1];
+    const int d2 = color[2] - node->color[2];
+    const int distance = d0 * d0 + d1 * d1 + d2 * d2;
+
+    if (distance < *best_distance) {
+        *best_distance = distance;
+        *best_index = node->index;
+    }
+
+    const int axis_distance = color[node->axis] - node->color[node->axis];
+
+    find_nearest(nodes, axis_distance < 0 ? node->left : node->right, color, best_distance, best_index);
+
+    if (axis_distance * axis_distance < *best_distance) {
+        find_nearest(nodes, axis_distance < 0 ? node->right : node->left, color, best_distance, best_index);
+    }
+}
+
+/* Fills the inverse color map for the red values [first_row; first_row + rows). */
+static sail_status_t build_inverse_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct quantize_context *quantize_context = context;
+    const unsigned shift = 8 - INVERSE_BITS;
+    const int center = 1 << (shift - 1);
+
+    for (unsigned r = first_row; r < first_row + rows; r++) {
+        for (unsigned g = 0; g < (1 << INVERSE_BITS); g++) {
+            for (unsigned b = 0; b < (1 << INVERSE_BITS); b++) {
+                const int color[3] = { (int)(r << shift) + center, (int)(g << shift) + center, (int)(b << shift) + center };
+                int best_distance = 3 * 256 * 256;
+                uint8_t best_index = 0;
+
+                find_nearest(quantize_context->kd_tree, quantize_context->kd_root, color, &best_distance, &best_index);
+
+                quantize_context->inverse[(r << (INVERSE_BITS * 2)) | (g << INVERSE_BITS) | b] = best_index;
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t build_inverse_map(struct quantize_context *quantize_context, unsigned threads) {
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct kd_node) * quantize_context->color_count, &ptr));
+    quantize_context->kd_tree = ptr;
+
+    uint8_t indexes[256];
+
+    for (unsigned i = 0; i < quantize_context->color_count; i++) {
+        indexes[i] = (uint8_t)i;
+    }
+
+    unsigned nodes_count = 0;
+    quantize_context->kd_root = build_kd_tree(quantize_context->kd_tree, &nodes_count, indexes,
+                                              quantize_context->color_count, quantize_context->palette);
+
+    SAIL_TRY(sail_malloc(INVERSE_SIZE, &ptr));
+    quantize_context->inverse = ptr;
+
+    /* The work is compute bound, so every red value is a separate band. */
+    SAIL_TRY(process_rows_in_parallel(1 << INVERSE_BITS, 0 /* bytes per row */, threads, build_inverse_band, quantize_context));
+
+    return SAIL_OK;
+}
+
+/*
+ * Mapping.
+ */
+
+static sail_status_t map_band(void *context, unsigned first_row, unsigned rows) {
+
+    const struct quantize_context *quantize_context = context;
+    const struct sail_image *image = quantize_context->image;
+    const struct sail_image *image_output = quantize_context->image_output;
+    const bool ordered = quantize_context->dither == SAIL_DITHER_ORDERED;
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *scan_input = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+
+        memset(scan_output, 0, image_output->bytes_per_line);
+
+        for (unsigned column = 0; column < image->width; column++, scan_input += 3) {
+            uint8_t index;
+
+            if (quantize_context->exact) {
+                const struct color_set *color_set = quantize_context->color_set;
+                index = color_set->indexes[color_set_slot(color_set, pack_color(scan_input))];
+            } else if (ordered) {
+                const int offset = ((int)BAYER8[row & 7][column & 7] * 2 - 63) * quantize_context->dither_spread / 128;
+
+                index = quantize_context->inverse[inverse_index(clamp8(scan_input[0] + offset),
+                                                                clamp8(scan_input[1] + offset),
+                                                                clamp8(scan_input[2] + offset))];
+            } else {
+                index = quantize_context->inverse[inverse_index(scan_input[0], scan_input[1], scan_input[2])];
+            }
+
+            store_index(scan_output, column, quantize_context->bits_per_index, index);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Serpentine Floyd-Steinberg. Errors are kept in 1/16 units.
+ */
+static sail_status_t map_floyd_steinberg(const struct quantize_context *quantize_context) {
+
+    const struct sail_image *image = quantize_context->image;
+    const struct sail_image *image_output = quantize_context->image_output;
+    const size_t errors_length = ((size_t)image->width + 2) * 3;
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(errors_length * 2, sizeof(int), &ptr));
+
+    int *current = ptr;
+    int *next = current + errors_length;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan_input = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+        const bool reverse = (row & 1) != 0;
+        const int direction = reverse ? -1 : 1;
+
+        memset(scan_output, 0, image_output->bytes_per_line);
+        memset(next, 0, errors_length * sizeof(int));
+
+        for (unsigned i = 0; i < image->width; i++) {
+            const unsigned column = reverse ? image->width - 1 - i : i;
+            const uint8_t *pixel = scan_input + column * 3;
+
+            /* Errors of the column are at (column + 1) * 3. */
+            int *error = current + (column + 1) * 3;
+            int *error_next = next + (column + 1) * 3;
+            uint8_t value[3];
+
+            for (unsigned c = 0; c < 3; c++) {
+                value[c] = clamp8(pixel[c] + (error[c] + (error[c] >= 0 ? 8 : -8)) / 16);
+            }
+
+            const uint8_t index = quantize_context->inverse[inverse_index(value[0], value[1], value[2])];
+            store_index(scan_output, column, quantize_context->bits_per_index, index);
+
+            for (int c = 0; c < 3; c++) {
+                const int diff = value[c] - quantize_context->palette[index * 3 + c];
+
+                error[direction * 3 + c]       += diff * 7;
+                error_next[-direction * 3 + c] += diff * 3;
+                error_next[c]                  += diff * 5;
+                error_next[direction * 3 + c]  += diff;
+            }
+        }
+
+        int *temp = current;
+        current = next;
+        next = temp;
+    }
+
+    sail_free(ptr);
+
+    return SAIL_OK;
+}
+
+static sail_status_t quantize_impl(struct quantize_context *quantize_context, unsigned max_colors, unsigned threads) {
+
+    void *ptr;
+    SAIL_TRY(sail_calloc(HISTOGRAM_SIZE, sizeof(struct histogram_bin), &ptr));
+    quantize_context->histogram = ptr;
+
+    SAIL_TRY(sail_calloc(1, sizeof(struct color_set), &ptr));
+    quantize_context->color_set = ptr;
+
+    build_histogram(quantize_context, max_colors);
+
+    if (quantize_context->exact) {
+        quantize_context->color_count = quantize_context->color_set->count;
+        build_exact_palette(quantize_context);
+    } else {
+        SAIL_TRY(build_median_cut_palette(quantize_context, max_colors));
+        SAIL_TRY(build_inverse_map(quantize_context, threads));
+    }
+
+    quantize_context->dither_spread = (int)lround(255.0 / cbrt((double)quantize_context->color_count));
+
+    if (!quantize_context->exact && quantize_context->dither == SAIL_DITHER_FLOYD_STEINBERG) {
+        SAIL_TRY(map_floyd_steinberg(quantize_context));
+    } else {
+        SAIL_TRY(process_rows_in_parallel(quantize_context->image->height,
+                                          quantize_context->image->bytes_per_line + quantize_context->image_output->bytes_per_line,
+                                          threads, map_band, quantize_context));
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_quantize_image(const struct sail_image *image,
+                                  enum SailPixelFormat output_pixel_format,
+                                  unsigned max_colors,
+                                  enum SailDither dither,
+                                  struct sail_image **image_output) {
+
+    SAIL_TRY(sail_quantize_image_with_options(image, output_pixel_format, max_colors, dither, NULL /* options */, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_quantize_image_with_options(const struct sail_image *image,
+                                               enum SailPixelFormat output_pixel_format,
+                                               unsigned max_colors,
+                                               enum SailDither dither,
+                                               const struct sail_conversion_options *options,
+                                               struct sail_image **image_output) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_IMAGE_PTR(image_output);
+
+    unsigned bits_per_index;
+
+    switch (output_pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP1_INDEXED: bits_per_index = 1; break;
+        case SAIL_PIXEL_FORMAT_BPP2_INDEXED: bits_per_index = 2; break;
+        case SAIL_PIXEL_FORMAT_BPP4_INDEXED: bits_per_index = 4; break;
+        case SAIL_PIXEL_FORMAT_BPP8_INDEXED: bits_per_index = 8; break;
+
+        default: {
+            SAIL_LOG_ERROR("Quantizing to %s is not supported", sail_pixel_format_to_string(output_pixel_format));
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+    }
+
+    if (max_colors == 0) {
+        max_colors = 1u << bits_per_index;
+    } else if (max_colors > (1u << bits_per_index)) {
+        SAIL_LOG_ERROR("%s cannot index %u colors", sail_pixel_format_to_string(output_pixel_format), max_colors);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    if (dither != SAIL_DITHER_NONE && dither != SAIL_DITHER_ORDERED && dither != SAIL_DITHER_FLOYD_STEINBERG) {
+        SAIL_LOG_ERROR("Unknown dithering algorithm %d", (int)dither);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    /* Quantize BPP24-RGB pixels. */
+    struct sail_image *image_rgb = NULL;
+
+    if (image->pixel_format != SAIL_PIXEL_FORMAT_BPP24_RGB) {
+        SAIL_TRY(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options, &image_rgb));
+    }
+
+    struct sail_image *image_local;
+    SAIL_TRY_OR_CLEANUP(sail_copy_image_skeleton(image, &image_local),
+                        /* cleanup */ sail_destroy_image(image_rgb));
+
+    image_local->pixel_format = output_pixel_format;
+
+    SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line),
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      sail_destroy_image(image_rgb));
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc((size_t)image_local->bytes_per_line * image_local->height, &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      sail_destroy_image(image_rgb));
+
+    SAIL_TRY_OR_CLEANUP(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, max_colors, &image_local->palette),
+                        /* cleanup */ sail_destroy_image(image_local),
+                                      sail_destroy_image(image_rgb));
+
+    struct quantize_context quantize_context;
+    memset(&quantize_context, 0, sizeof(quantize_context));
+
+    quantize_context.image          = (image_rgb == NULL) ? image : image_rgb;
+    quantize_context.image_output   = image_local;
+    quantize_context.bits_per_index = bits_per_index;
+    quantize_context.dither         = dither;
+    quantize_context.palette        = image_local->palette->data;
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY_OR_CLEANUP(quantize_impl(&quantize_context, max_colors, threads),
+                        /* cleanup */ destroy_quantize_context(&quantize_context),
+                                      sail_destroy_image(image_local),
+                                      sail_destroy_image(image_rgb));
+
+    image_local->palette->color_count = quantize_context.color_count;
+
+    destroy_quantize_context(&quantize_context);
+    sail_destroy_image(image_rgb);
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
@@ -0,0 +1,106 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_QUANTIZE_H
+#define SAIL_QUANTIZE_H
+
+#ifdef SAIL_BUILD
+    #include "common.h"
+    #include "error.h"
+    #include "export.h"
+
+    #include "manip_common.h"
+#else
+    #include <sail-common/common.h>
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/manip_common.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_conversion_options;
+struct sail_image;
+
+/*
+ * Reduces the number of colors of the input image and saves the result as an indexed image
+ * with a BPP24-RGB palette. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * The input image is converted to BPP24-RGB first, so its pixel format must be convertible
+ * with sail_convert_image(). Alpha is dropped.
+ *
+ * If the image has no more than max_colors distinct colors, the palette holds exactly them
+ * and the image is converted losslessly. Otherwise, the palette is built with median cut over
+ * a histogram of the image colors. Pixels are mapped to the nearest palette colors through
+ * an inverse color map built with a k-d tree and dithered with the algorithm.
+ *
+ * Allowed output pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP1_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP2_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP4_INDEXED
+ *   - SAIL_PIXEL_FORMAT_BPP8_INDEXED
+ *
+ * max_colors must not exceed the number of colors the output pixel format can index.
+ * 0 means that number.
+ *
+ * The resulting image gets the new pixel format, bytes per line, and palette. Other properties
+ * are copied from the original image. The palette may have less than max_colors colors.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_quantize_image(const struct sail_image *image,
+                                              enum SailPixelFormat output_pixel_format,
+                                              unsigned max_colors,
+                                              enum SailDither dither,
+                                              struct sail_image **image_output);
+
+/*
+ * Reduces the number of colors of the input image and saves the result as an indexed image
+ * with a BPP24-RGB palette. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * Options (which may be NULL) control how alpha is dropped or blended while converting the input
+ * image to BPP24-RGB and the number of threads. Pixels are mapped to the palette in parallel
+ * row bands unless SAIL_DITHER_FLOYD_STEINBERG is used.
+ *
+ * See sail_quantize_image() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_quantize_image_with_options(const struct sail_image *image,
+                                                           enum SailPixelFormat output_pixel_format,
+                                                           unsigned max_colors,
+                                                           enum SailDither dither,
+                                                           const struct sail_conversion_options *options,
+                                                           struct sail_image **image_output);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -31,19 +31,42 @@
 #ifdef SAIL_BUILD
     #include "sail-common.h"
 
+    #include "analyze.h"
     #include "cmyk.h"
+    #include "compare.h"
+    #include "composite.h"
+    #include "composite_kernels.h"
+    #include "conversion_kernels.h"
     #include "conversion_options.h"
     #include "convert.h"
+    #include "convolve.h"
+    #include "cpu_features.h"
+    #include "floating_point.h"
     #include "manip_common.h"
     #include "manip_utils.h"
+    #include "orientation.h"
+    #include "pack_lut.h"
+    #include "palette_lut.h"
+    #include "parallel.h"
+    #include "premultiply.h"
+    #include "quantize.h"
+    #include "scale.h"
     #include "ycbcr.h"
     #include "ycck.h"
+    #include "yuv_planar.h"
 #else
     #include <sail-common/sail-common.h>
 
+    #include <sail-manip/analyze.h>
+    #include <sail-manip/compare.h>
+    #include <sail-manip/composite.h>
     #include <sail-manip/conversion_options.h>
     #include <sail-manip/convert.h>
+    #include <sail-manip/convolve.h>
     #include <sail-manip/manip_common.h>
+    #include <sail-manip/orientation.h>
+    #include <sail-manip/quantize.h>
+    #include <sail-manip/scale.h>
 #endif
 
 #endif
@@ -0,0 +1,557 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-manip.h"
+
+/*
+ * Filter weights are stored in fixed point with 14 fractional bits. Weights of every output
+ * pixel sum up to exactly 1 << 14, so flat areas stay exactly flat.
+ */
+#define WEIGHT_BITS 14
+#define WEIGHT_ONE (1 << WEIGHT_BITS)
+#define WEIGHT_HALF (1 << (WEIGHT_BITS - 1))
+
+/*
+ * Filters.
+ */
+
+static const double PI = 3.14159265358979323846;
+
+static double box_filter(double x) {
+
+    return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+}
+
+static double bilinear_filter(double x) {
+
+    x = fabs(x);
+
+    return (x < 1.0) ? 1.0 - x : 0.0;
+}
+
+/* Catmull-Rom spline, a = -0.5. */
+static double bicubic_filter(double x) {
+
+    const double a = -0.5;
+
+    x = fabs(x);
+
+    if (x < 1.0) {
+        return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    } else if (x < 2.0) {
+        return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+    }
+
+    return 0.0;
+}
+
+static double sinc(double x) {
+
+    if (x == 0.0) {
+        return 1.0;
+    }
+
+    x *= PI;
+
+    return sin(x) / x;
+}
+
+static double lanczos3_filter(double x) {
+
+    return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+struct scale_filter {
+    double (*function)(double x);
+    double support;
+};
+
+static sail_status_t scale_filter(enum SailScaling algorithm, struct scale_filter *filter) {
+
+    switch (algorithm) {
+        case SAIL_SCALING_BOX:      *filter = (struct scale_filter){ box_filter,      0.5 }; break;
+        case SAIL_SCALING_BILINEAR: *filter = (struct scale_filter){ bilinear_filter, 1.0 }; break;
+        case SAIL_SCALING_BICUBIC:  *filter = (struct scale_filter){ bicubic_filter,  2.0 }; break;
+        case SAIL_SCALING_LANCZOS3: *filter = (struct scale_filter){ lanczos3_filter, 3.0 }; break;
+
+        default: {
+            SAIL_LOG_ERROR("Unknown scaling algorithm %d", (int)algorithm);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Precomputed filter weights for every output column or row.
+ */
+struct scale_weights {
+    /* First input pixel of every output pixel. */
+    unsigned *first;
+
+    /* Number of input pixels of every output pixel. */
+    unsigned *count;
+
+    /* max_count weights of every output pixel. */
+    int32_t *weights;
+    unsigned max_count;
+};
+
+static void destroy_scale_weights(struct scale_weights *scale_weights) {
+
+    sail_free(scale_weights->first);
+    sail_free(scale_weights->count);
+    sail_free(scale_weights->weights);
+}
+
+static sail_status_t compute_scale_weights(unsigned input_size, unsigned output_size, const struct scale_filter *filter,
+                                           struct scale_weights *scale_weights) {
+
+    /* Stretch the filter when downscaling so every input pixel contributes. */
+    const double scale = (double)input_size / output_size;
+    const double filter_scale = (scale > 1.0) ? scale : 1.0;
+    const double support = filter->support * filter_scale;
+
+    memset(scale_weights, 0, sizeof(*scale_weights));
+    scale_weights->max_count = (unsigned)ceil(support) * 2 + 1;
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(unsigned) * output_size, &ptr),
+                        /* cleanup */ destroy_scale_weights(scale_weights));
+    scale_weights->first = ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(unsigned) * output_size, &ptr),
+                        /* cleanup */ destroy_scale_weights(scale_weights));
+    scale_weights->count = ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(int32_t) * output_size * scale_weights->max_count, &ptr),
+                        /* cleanup */ destroy_scale_weights(scale_weights));
+    scale_weights->weights = ptr;
+
+    double *weights_double;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(double) * scale_weights->max_count, &ptr),
+                        /* cleanup */ destroy_scale_weights(scale_weights));
+    weights_double = ptr;
+
+    for (unsigned output = 0; output < output_size; output++) {
+        const double center = (output + 0.5) * scale;
+
+        long first = (long)floor(center - support + 0.5);
+        long last  = (long)floor(center + support + 0.5);
+
+        if (first < 0) {
+            first = 0;
+        }
+        if (last > (long)input_size) {
+            last = input_size;
+        }
+        if (last - first > (long)scale_weights->max_count) {
+            last = first + scale_weights->max_count;
+        }
+
+        double sum = 0;
+        unsigned count = (unsigned)(last - first);
+
+        for (unsigned i = 0; i < count; i++) {
+            weights_double[i] = filter->function((first + i - center + 0.5) / filter_scale);
+            sum += weights_double[i];
+        }
+
+        int32_t *weights = scale_weights->weights + (size_t)output * scale_weights->max_count;
+        int32_t fixed_sum = 0;
+        unsigned max_index = 0;
+
+        for (unsigned i = 0; i < count; i++) {
+            weights[i] = (sum != 0) ? (int32_t)lround(weights_double[i] / sum * WEIGHT_ONE) : 0;
+            fixed_sum += weights[i];
+
+            if (weights[i] > weights[max_index]) {
+                max_index = i;
+            }
+        }
+
+        /* Put the rounding error into the largest weight. */
+        weights[max_index] += WEIGHT_ONE - fixed_sum;
+
+        /* Skip zero weights at the edges. */
+        unsigned skip = 0;
+        while (skip + 1 < count && weights[skip] == 0) {
+            skip++;
+        }
+        while (count > skip + 1 && weights[count - 1] == 0) {
+            count--;
+        }
+        if (skip > 0) {
+            memmove(weights, weights + skip, sizeof(int32_t) * (count - skip));
+        }
+
+        scale_weights->first[output] = (unsigned)first + skip;
+        scale_weights->count[output] = count - skip;
+    }
+
+    sail_free(weights_double);
+
+    return SAIL_OK;
+}
+
+/*
+ * Filtering. Accumulators start from a half to round to the nearest. Negative lobes
+ * of bicubic and Lanczos filters may produce values out of range, so they're clamped.
+ */
+
+static inline uint8_t clamp8(int32_t value) {
+
+    return (value < 0) ? 0 : (value >> WEIGHT_BITS) > 255 ? 255 : (uint8_t)(value >> WEIGHT_BITS);
+}
+
+static inline uint16_t clamp16(int64_t value) {
+
+    return (value < 0) ? 0 : (value >> WEIGHT_BITS) > 65535 ? 65535 : (uint16_t)(value >> WEIGHT_BITS);
+}
+
+/* Horizontal pass of one row. Inlined with a constant number of channels. */
+static inline void filter_row_horizontal8(const uint8_t *input, uint8_t *output, unsigned width,
+                                          const struct scale_weights *scale_weights, const unsigned channels) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint8_t *pixel = input + (size_t)scale_weights->first[column] * channels;
+        const int32_t *weights = scale_weights->weights + (size_t)column * scale_weights->max_count;
+        const unsigned count = scale_weights->count[column];
+
+        int32_t sum[4] = { WEIGHT_HALF, WEIGHT_HALF, WEIGHT_HALF, WEIGHT_HALF };
+
+        for (unsigned i = 0; i < count; i++, pixel += channels) {
+            for (unsigned c = 0; c < channels; c++) {
+                sum[c] += weights[i] * pixel[c];
+            }
+        }
+
+        for (unsigned c = 0; c < channels; c++) {
+            *output++ = clamp8(sum[c]);
+        }
+    }
+}
+
+static inline void filter_row_horizontal16(const uint16_t *input, uint16_t *output, unsigned width,
+                                           const struct scale_weights *scale_weights, const unsigned channels) {
+
+    for (unsigned column = 0; column < width; column++) {
+        const uint16_t *pixel = input + (size_t)scale_weights->first[column] * channels;
+        const int32_t *weights = scale_weights->weights + (size_t)column * scale_weights->max_count;
+        const unsigned count = scale_weights->count[column];
+
+        int64_t sum[4] = { WEIGHT_HALF, WEIGHT_HALF, WEIGHT_HALF, WEIGHT_HALF };
+
+        for (unsigned i = 0; i < count; i++, pixel += channels) {
+            for (unsigned c = 0; c < channels; c++) {
+                sum[c] += (int64_t)weights[i] * pixel[c];
+            }
+        }
+
+        for (unsigned c = 0; c < channels; c++) {
+            *output++ = clamp16(sum[c]);
+        }
+    }
+}
+
+static void filter_row_horizontal(const void *input, void *output, unsigned width,
+                                  const struct scale_weights *scale_weights, const struct sample_layout *layout) {
+
+    if (layout->bytes_per_sample == 1) {
+        switch (layout->channels) {
+            case 1: filter_row_horizontal8(input, output, width, scale_weights, 1); break;
+            case 2: filter_row_horizontal8(input, output, width, scale_weights, 2); break;
+            case 3: filter_row_horizontal8(input, output, width, scale_weights, 3); break;
+            case 4: filter_row_horizontal8(input, output, width, scale_weights, 4); break;
+        }
+    } else {
+        switch (layout->channels) {
+            case 1: filter_row_horizontal16(input, output, width, scale_weights, 1); break;
+            case 2: filter_row_horizontal16(input, output, width, scale_weights, 2); break;
+            case 3: filter_row_horizontal16(input, output, width, scale_weights, 3); break;
+            case 4: filter_row_horizontal16(input, output, width, scale_weights, 4); break;
+        }
+    }
+}
+
+/*
+ * Vertical pass of one row. Every input row is multiplied by its weight and added to the sums
+ * sample by sample, so the inner loops are vectorized by compilers.
+ */
+static void filter_row_vertical8(const uint8_t *input, size_t input_stride, uint8_t *output, unsigned samples,
+                                 const int32_t *weights, unsigned count, int32_t *sums) {
+
+    for (unsigned s = 0; s < samples; s++) {
+        sums[s] = WEIGHT_HALF;
+    }
+
+    for (unsigned i = 0; i < count; i++, input += input_stride) {
+        const int32_t weight = weights[i];
+
+        for (unsigned s = 0; s < samples; s++) {
+            sums[s] += weight * input[s];
+        }
+    }
+
+    for (unsigned s = 0; s < samples; s++) {
+        output[s] = clamp8(sums[s]);
+    }
+}
+
+static void filter_row_vertical16(const uint8_t *input, size_t input_stride, uint16_t *output, unsigned samples,
+                                  const int32_t *weights, unsigned count, int64_t *sums) {
+
+    for (unsigned s = 0; s < samples; s++) {
+        sums[s] = WEIGHT_HALF;
+    }
+
+    for (unsigned i = 0; i < count; i++, input += input_stride) {
+        const int64_t weight = weights[i];
+        const uint16_t *input16 = (const uint16_t *)input;
+
+        for (unsigned s = 0; s < samples; s++) {
+            sums[s] += weight * input16[s];
+        }
+    }
+
+    for (unsigned s = 0; s < samples; s++) {
+        output[s] = clamp16(sums[s]);
+    }
+}
+
+/*
+ * Scaling.
+ */
+
+struct scale_context {
+    const struct sail_image *image;
+    struct sail_image *image_output;
+    struct sample_layout layout;
+
+    struct scale_weights horizontal;
+    struct scale_weights vertical;
+
+    /*
+     * Horizontally scaled input rows [first_row; first_row + rows) with unpacked samples.
+     * Points to the input pixels when the horizontal pass is skipped.
+     */
+    const uint8_t *intermediate;
+    size_t intermediate_stride;
+    unsigned intermediate_first_row;
+};
+
+static sail_status_t scale_band_horizontal(void *context, unsigned first_row, unsigned rows) {
+
+    const struct scale_context *scale_context = context;
+    const struct sail_image *image = scale_context->image;
+    const struct sample_layout *layout = &scale_context->layout;
+    const bool packed = layout->packed_bits[0] > 0;
+
+    uint8_t *unpacked = NULL;
+
+    if (packed) {
+        void *ptr;
+        SAIL_TRY(sail_malloc((size_t)image->width * 3, &ptr));
+        unpacked = ptr;
+    }
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * (scale_context->intermediate_first_row + row);
+        uint8_t *scan_output = (uint8_t *)scale_context->intermediate + scale_context->intermediate_stride * row;
+
+        if (packed) {
+            unpack_packed_row((const uint16_t *)scan_input, unpacked, image->width, layout->packed_bits);
+            scan_input = unpacked;
+        }
+
+        filter_row_horizontal(scan_input, scan_output, scale_context->image_output->width, &scale_context->horizontal, layout);
+    }
+
+    sail_free(unpacked);
+
+    return SAIL_OK;
+}
+
+static sail_status_t scale_band_vertical(void *context, unsigned first_row, unsigned rows) {
+
+    const struct scale_context *scale_context = context;
+    const struct sail_image *image_output = scale_context->image_output;
+    const struct sample_layout *layout = &scale_context->layout;
+    const struct scale_weights *vertical = &scale_context->vertical;
+    const bool packed = layout->packed_bits[0] > 0;
+
+    const unsigned samples = image_output->width * layout->channels;
+    const size_t sum_size = (layout->bytes_per_sample == 1) ? sizeof(int32_t) : sizeof(int64_t);
+
+    void *sums;
+    SAIL_TRY(sail_malloc(sum_size * samples + (packed ? samples : 0), &sums));
+
+    uint8_t *unpacked = (uint8_t *)sums + sum_size * samples;
+
+    for (unsigned row = first_row; row < first_row + rows; row++) {
+        const uint8_t *scan_input = scale_context->intermediate
+                                        + scale_context->intermediate_stride * (vertical->first[row] - scale_context->intermediate_first_row);
+        uint8_t *scan_output = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+        const int32_t *weights = vertical->weights + (size_t)row * vertical->max_count;
+
+        if (layout->bytes_per_sample == 1) {
+            filter_row_vertical8(scan_input, scale_context->intermediate_stride, packed ? unpacked : scan_output,
+                                 samples, weights, vertical->count[row], sums);
+        } else {
+            filter_row_vertical16(scan_input, scale_context->intermediate_stride, (uint16_t *)scan_output,
+                                  samples, weights, vertical->count[row], sums);
+        }
+
+        if (packed) {
+            pack_packed_row(unpacked, (uint16_t *)scan_output, image_output->width, layout->packed_bits);
+        }
+    }
+
+    sail_free(sums);
+
+    return SAIL_OK;
+}
+
+static sail_status_t scale_impl(const struct sail_image *image, struct sail_image *image_output,
+                                const struct sample_layout *layout, const struct scale_filter *filter, unsigned threads) {
+
+    struct scale_context scale_context;
+    memset(&scale_context, 0, sizeof(scale_context));
+
+    scale_context.image        = image;
+    scale_context.image_output = image_output;
+    scale_context.layout       = *layout;
+
+    SAIL_TRY(compute_scale_weights(image->height, image_output->height, filter, &scale_context.vertical));
+
+    /* Only the input rows used by the vertical pass are scaled horizontally. */
+    const unsigned last_output_row = image_output->height - 1;
+    const unsigned first_row = scale_context.vertical.first[0];
+    const unsigned rows = scale_context.vertical.first[last_output_row] + scale_context.vertical.count[last_output_row] - first_row;
+
+    void *intermediate = NULL;
+
+    if (image->width == image_output->width && layout->packed_bits[0] == 0) {
+        scale_context.intermediate        = image->pixels;
+        scale_context.intermediate_stride = image->bytes_per_line;
+    } else {
+        SAIL_TRY_OR_CLEANUP(compute_scale_weights(image->width, image_output->width, filter, &scale_context.horizontal),
+                            /* cleanup */ destroy_scale_weights(&scale_context.vertical));
+
+        scale_context.intermediate_stride    = (size_t)image_output->width * layout->channels * layout->bytes_per_sample;
+        scale_context.intermediate_first_row = first_row;
+
+        SAIL_TRY_OR_CLEANUP(sail_malloc(scale_context.intermediate_stride * rows, &intermediate),
+                            /* cleanup */ destroy_scale_weights(&scale_context.horizontal),
+                                          destroy_scale_weights(&scale_context.vertical));
+
+        scale_context.intermediate = intermediate;
+
+        SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(rows, image->bytes_per_line + scale_context.intermediate_stride, threads,
+                                                     scale_band_horizontal, &scale_context),
+                            /* cleanup */ sail_free(intermediate),
+                                          destroy_scale_weights(&scale_context.horizontal),
+                                          destroy_scale_weights(&scale_context.vertical));
+    }
+
+    SAIL_TRY_OR_CLEANUP(process_rows_in_parallel(image_output->height,
+                                                 image_output->bytes_per_line + scale_context.intermediate_stride * scale_context.vertical.max_count,
+                                                 threads, scale_band_vertical, &scale_context),
+                        /* cleanup */ sail_free(intermediate),
+                                      destroy_scale_weights(&scale_context.horizontal),
+                                      destroy_scale_weights(&scale_context.vertical));
+
+    sail_free(intermediate);
+    destroy_scale_weights(&scale_context.horizontal);
+    destroy_scale_weights(&scale_context.vertical);
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_scale_image(const struct sail_image *image,
+                               unsigned width,
+                               unsigned height,
+                               enum SailScaling algorithm,
+                               struct sail_image **image_output) {
+
+    SAIL_TRY(sail_scale_image_with_options(image, width, height, algorithm, NULL /* options */, image_output));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_scale_image_with_options(const struct sail_image *image,
+                                            unsigned width,
+                                            unsigned height,
+                                            enum SailScaling algorithm,
+                                            const struct sail_conversion_options *options,
+                                            struct sail_image **image_output) {
+
+    SAIL_TRY(sail_check_image_valid(image));
+    SAIL_CHECK_IMAGE_PTR(image_output);
+
+    if (width == 0 || height == 0) {
+        SAIL_LOG_ERROR("Cannot scale to %ux%u", width, height);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    }
+
+    struct sample_layout layout;
+    if (!sample_layout(image->pixel_format, &layout)) {
+        SAIL_LOG_ERROR("Scaling %s images is not currently supported", sail_pixel_format_to_string(image->pixel_format));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    }
+
+    struct scale_filter filter;
+    SAIL_TRY(scale_filter(algorithm, &filter));
+
+    struct sail_image *image_local;
+    SAIL_TRY(sail_copy_image_skeleton(image, &image_local));
+
+    image_local->width  = width;
+    image_local->height = height;
+
+    SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    const size_t pixels_size = (size_t)image_local->height * image_local->bytes_per_line;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    const unsigned threads = (options == NULL) ? 1 : options->threads;
+
+    SAIL_TRY_OR_CLEANUP(scale_impl(image, image_local, &layout, &filter, threads),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    *image_output = image_local;
+
+    return SAIL_OK;
+}
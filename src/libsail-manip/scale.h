@@ -0,0 +1,97 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_SCALE_H
+#define SAIL_SCALE_H
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+
+    #include "manip_common.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/manip_common.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_conversion_options;
+struct sail_image;
+
+/*
+ * Scales the input image to the new dimensions with the algorithm and saves the result
+ * in the output image. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * Scaling is done in two separable passes: horizontal and vertical. Filter weights are computed
+ * once per output column and row. Pixels are filtered in fixed point in their own pixel format
+ * without converting them to another one. All channels including alpha are filtered independently.
+ *
+ * The resulting image gets updated dimensions and bytes per line. Other properties are copied from
+ * the original image.
+ *
+ * Allowed pixel formats:
+ *   - SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE
+ *   - SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_ALPHA
+ *   - SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA
+ *   - Anything sail_is_rgb_family() returns true for
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_scale_image(const struct sail_image *image,
+                                           unsigned width,
+                                           unsigned height,
+                                           enum SailScaling algorithm,
+                                           struct sail_image **image_output);
+
+/*
+ * Scales the input image to the new dimensions with the algorithm and saves the result
+ * in the output image. The output image MUST be destroyed later with sail_destroy_image().
+ *
+ * Options (which may be NULL) control the number of threads to scale the image with.
+ * Other options are ignored.
+ *
+ * See sail_scale_image() for details.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_scale_image_with_options(const struct sail_image *image,
+                                                        unsigned width,
+                                                        unsigned height,
+                                                        enum SailScaling algorithm,
+                                                        const struct sail_conversion_options *options,
+                                                        struct sail_image **image_output);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,376 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-manip.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define SAIL_YUV_SSE2
+#endif
+
+/*
+ * RGB -> YUV:
+ *
+ *   Y = Kr * R + Kg * G + Kb * B
+ *   U = (B - Y) / (2 * (1 - Kb)) + 128
+ *   V = (R - Y) / (2 * (1 - Kr)) + 128
+ *
+ * Limited range additionally scales Y by 219/255 and adds 16, and scales U and V by 224/255.
+ * YUV -> RGB is the inverse. The SSE2 code paths use the same fixed-point formulas as the portable ones,
+ * so the results are bit-exact.
+ */
+#define RGB_TO_YUV_BITS 14
+#define YUV_TO_RGB_BITS 13
+
+void init_yuv_coefficients(enum SailYuvMatrix matrix, enum SailYuvRange range, struct yuv_coefficients *coefficients) {
+
+    const double kr = (matrix == SAIL_YUV_MATRIX_BT709) ? 0.2126 : 0.299;
+    const double kb = (matrix == SAIL_YUV_MATRIX_BT709) ? 0.0722 : 0.114;
+    const double kg = 1 - kr - kb;
+
+    const bool limited = (range == SAIL_YUV_RANGE_LIMITED);
+    const double y_range = limited ? 219.0 / 255 : 1;
+    const double chroma_range = limited ? 224.0 / 255 : 1;
+
+    const double forward = 1 << RGB_TO_YUV_BITS;
+
+    /* Fix up the green coefficients so the rows sum up exactly and gray stays gray. */
+    coefficients->yr = (int16_t)lround(kr * y_range * forward);
+    coefficients->yb = (int16_t)lround(kb * y_range * forward);
+    coefficients->yg = (int16_t)(lround(y_range * forward) - coefficients->yr - coefficients->yb);
+
+    coefficients->ur = (int16_t)lround(-kr / (2 * (1 - kb)) * chroma_range * forward);
+    coefficients->ub = (int16_t)lround(0.5 * chroma_range * forward);
+    coefficients->ug = (int16_t)(-coefficients->ur - coefficients->ub);
+
+    coefficients->vr = (int16_t)lround(0.5 * chroma_range * forward);
+    coefficients->vb = (int16_t)lround(-kb / (2 * (1 - kr)) * chroma_range * forward);
+    coefficients->vg = (int16_t)(-coefficients->vr - coefficients->vb);
+
+    coefficients->y_offset      = ((limited ? 16 : 0) << RGB_TO_YUV_BITS) + (1 << (RGB_TO_YUV_BITS - 1));
+    coefficients->chroma_offset = (128 << RGB_TO_YUV_BITS) + (1 << (RGB_TO_YUV_BITS - 1));
+
+    const double inverse = 1 << YUV_TO_RGB_BITS;
+
+    coefficients->y_bias  = limited ? 16 : 0;
+    coefficients->y_scale = (int16_t)lround(inverse / y_range);
+    coefficients->rv      = (int16_t)lround(2 * (1 - kr) / chroma_range * inverse);
+    coefficients->gu      = (int16_t)lround(-2 * kb * (1 - kb) / kg / chroma_range * inverse);
+    coefficients->gv      = (int16_t)lround(-2 * kr * (1 - kr) / kg / chroma_range * inverse);
+    coefficients->bu      = (int16_t)lround(2 * (1 - kb) / chroma_range * inverse);
+}
+
+bool rgb8_layout_of(enum SailPixelFormat pixel_format, struct rgb8_layout *layout) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP24_RGB:  *layout = (struct rgb8_layout){ 3, 0, 1, 2, -1, false }; return true;
+        case SAIL_PIXEL_FORMAT_BPP24_BGR:  *layout = (struct rgb8_layout){ 3, 2, 1, 0, -1, false }; return true;
+
+        case SAIL_PIXEL_FORMAT_BPP32_RGBX: *layout = (struct rgb8_layout){ 4, 0, 1, 2,  3, false }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRX: *layout = (struct rgb8_layout){ 4, 2, 1, 0,  3, false }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_XRGB: *layout = (struct rgb8_layout){ 4, 1, 2, 3,  0, false }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_XBGR: *layout = (struct rgb8_layout){ 4, 3, 2, 1,  0, false }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA: *layout = (struct rgb8_layout){ 4, 0, 1, 2,  3, true  }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA: *layout = (struct rgb8_layout){ 4, 2, 1, 0,  3, true  }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB: *layout = (struct rgb8_layout){ 4, 1, 2, 3,  0, true  }; return true;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR: *layout = (struct rgb8_layout){ 4, 3, 2, 1,  0, true  }; return true;
+
+        default: {
+            return false;
+        }
+    }
+}
+
+void planar_rows_of(enum SailPixelFormat pixel_format, const struct sail_image_plane *planes,
+                    unsigned pair, struct planar_rows *rows) {
+
+    const unsigned row = pair * 2;
+
+    rows->rows = (planes[0].height - row >= 2) ? 2 : 1;
+
+    rows->y[0] = (uint8_t *)planes[0].pixels + (size_t)planes[0].bytes_per_line * row;
+    rows->y[1] = (rows->rows == 2) ? rows->y[0] + planes[0].bytes_per_line : rows->y[0];
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP12_I420: {
+            rows->subsampled  = true;
+            rows->chroma_step = 1;
+            rows->u[0] = rows->u[1] = (uint8_t *)planes[1].pixels + (size_t)planes[1].bytes_per_line * pair;
+            rows->v[0] = rows->v[1] = (uint8_t *)planes[2].pixels + (size_t)planes[2].bytes_per_line * pair;
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
+            rows->subsampled  = true;
+            rows->chroma_step = 2;
+            rows->u[0] = rows->u[1] = (uint8_t *)planes[1].pixels + (size_t)planes[1].bytes_per_line * pair;
+            rows->v[0] = rows->v[1] = rows->u[0] + 1;
+            break;
+        }
+        default: {
+            rows->subsampled  = false;
+            rows->chroma_step = 1;
+            rows->u[0] = (uint8_t *)planes[1].pixels + (size_t)planes[1].bytes_per_line * row;
+            rows->v[0] = (uint8_t *)planes[2].pixels + (size_t)planes[2].bytes_per_line * row;
+            rows->u[1] = (rows->rows == 2) ? rows->u[0] + planes[1].bytes_per_line : rows->u[0];
+            rows->v[1] = (rows->rows == 2) ? rows->v[0] + planes[2].bytes_per_line : rows->v[0];
+            break;
+        }
+    }
+}
+
+/* Shifts the fixed-point value right and clamps it to [0; 255]. */
+static inline uint8_t clamp_fixed(int32_t value, int bits) {
+
+    if (value < 0) {
+        return 0;
+    }
+
+    value >>= bits;
+
+    return (value > 255) ? 255 : (uint8_t)value;
+}
+
+#ifdef SAIL_YUV_SSE2
+/* Sums the adjacent 32-bit lanes of PMADDWD results: [a0, b0, a1, b1], [a2, b2, a3, b3] -> [a0+b0, ..., a3+b3]. */
+static inline __m128i sum_pairs_sse2(__m128i m0, __m128i m1) {
+
+    const __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(m0), _mm_castsi128_ps(m1), _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 odd  = _mm_shuffle_ps(_mm_castsi128_ps(m0), _mm_castsi128_ps(m1), _MM_SHUFFLE(3, 1, 3, 1));
+
+    return _mm_add_epi32(_mm_castps_si128(even), _mm_castps_si128(odd));
+}
+
+/* Returns the number of processed pixels. */
+static unsigned rgba32_dot_row_sse2(const uint8_t *rgba, const struct rgb8_layout *layout, unsigned width,
+                                    int16_t cr, int16_t cg, int16_t cb, int32_t offset, uint8_t *output) {
+
+    int16_t c[4] = { 0, 0, 0, 0 };
+    c[layout->r] = cr;
+    c[layout->g] = cg;
+    c[layout->b] = cb;
+
+    const __m128i coefficients = _mm_setr_epi16(c[0], c[1], c[2], c[3], c[0], c[1], c[2], c[3]);
+    const __m128i offsets = _mm_set1_epi32(offset);
+    const __m128i zero = _mm_setzero_si128();
+
+    unsigned x = 0;
+
+    for (; x + 8 <= width; x += 8) {
+        const __m128i p0 = _mm_loadu_si128((const __m128i *)(const void *)(rgba + (size_t)x * 4));
+        const __m128i p1 = _mm_loadu_si128((const __m128i *)(const void *)(rgba + (size_t)x * 4 + 16));
+
+        __m128i s0 = sum_pairs_sse2(_mm_madd_epi16(_mm_unpacklo_epi8(p0, zero), coefficients),
+                                    _mm_madd_epi16(_mm_unpackhi_epi8(p0, zero), coefficients));
+        __m128i s1 = sum_pairs_sse2(_mm_madd_epi16(_mm_unpacklo_epi8(p1, zero), coefficients),
+                                    _mm_madd_epi16(_mm_unpackhi_epi8(p1, zero), coefficients));
+
+        s0 = _mm_srai_epi32(_mm_add_epi32(s0, offsets), RGB_TO_YUV_BITS);
+        s1 = _mm_srai_epi32(_mm_add_epi32(s1, offsets), RGB_TO_YUV_BITS);
+
+        const __m128i words = _mm_packs_epi32(s0, s1);
+        _mm_storel_epi64((__m128i *)(void *)(output + x), _mm_packus_epi16(words, words));
+    }
+
+    return x;
+}
+#endif
+
+/* output[x] = Cr * R + Cg * G + Cb * B + offset for every pixel of the row. */
+static void rgb8_dot_row(const uint8_t *rgb, const struct rgb8_layout *layout, unsigned width,
+                         int16_t cr, int16_t cg, int16_t cb, int32_t offset, uint8_t *output) {
+
+    unsigned x = 0;
+
+#ifdef SAIL_YUV_SSE2
+    if (layout->bytes_per_pixel == 4) {
+        x = rgba32_dot_row_sse2(rgb, layout, width, cr, cg, cb, offset, output);
+    }
+#endif
+
+    for (; x < width; x++) {
+        const uint8_t *pixel = rgb + (size_t)x * layout->bytes_per_pixel;
+        output[x] = clamp_fixed(cr * pixel[layout->r] + cg * pixel[layout->g] + cb * pixel[layout->b] + offset, RGB_TO_YUV_BITS);
+    }
+}
+
+void rgb8_to_planar_rows(const uint8_t *const rgb[2], const struct rgb8_layout *layout, unsigned width,
+                         const struct yuv_coefficients *coefficients, const struct planar_rows *rows) {
+
+    const struct yuv_coefficients *c = coefficients;
+
+    for (unsigned row = 0; row < rows->rows; row++) {
+        rgb8_dot_row(rgb[row], layout, width, c->yr, c->yg, c->yb, c->y_offset, rows->y[row]);
+    }
+
+    if (!rows->subsampled) {
+        for (unsigned row = 0; row < rows->rows; row++) {
+            rgb8_dot_row(rgb[row], layout, width, c->ur, c->ug, c->ub, c->chroma_offset, rows->u[row]);
+            rgb8_dot_row(rgb[row], layout, width, c->vr, c->vg, c->vb, c->chroma_offset, rows->v[row]);
+        }
+        return;
+    }
+
+    /* Average 2x2 blocks. The last row and column are replicated for odd dimensions. */
+    const uint8_t *rgb0 = rgb[0];
+    const uint8_t *rgb1 = (rows->rows == 2) ? rgb[1] : rgb[0];
+    const unsigned bytes_per_pixel = layout->bytes_per_pixel;
+
+    for (unsigned x = 0; x < width; x += 2) {
+        const uint8_t *p00 = rgb0 + (size_t)x * bytes_per_pixel;
+        const uint8_t *p10 = rgb1 + (size_t)x * bytes_per_pixel;
+        const uint8_t *p01 = (x + 1 < width) ? p00 + bytes_per_pixel : p00;
+        const uint8_t *p11 = (x + 1 < width) ? p10 + bytes_per_pixel : p10;
+
+        const int r = (p00[layout->r] + p01[layout->r] + p10[layout->r] + p11[layout->r] + 2) >> 2;
+        const int g = (p00[layout->g] + p01[layout->g] + p10[layout->g] + p11[layout->g] + 2) >> 2;
+        const int b = (p00[layout->b] + p01[layout->b] + p10[layout->b] + p11[layout->b] + 2) >> 2;
+
+        const size_t chroma = (size_t)(x / 2) * rows->chroma_step;
+
+        rows->u[0][chroma] = clamp_fixed(c->ur * r + c->ug * g + c->ub * b + c->chroma_offset, RGB_TO_YUV_BITS);
+        rows->v[0][chroma] = clamp_fixed(c->vr * r + c->vg * g + c->vb * b + c->chroma_offset, RGB_TO_YUV_BITS);
+    }
+}
+
+#ifdef SAIL_YUV_SSE2
+/* Interleaves four vectors of 4 32-bit channel values into 4 pixels of 4 bytes. */
+static inline __m128i interleave_rgba32_sse2(const __m128i slots[4]) {
+
+    /* [s0 x4, s2 x4, s1 x4, s3 x4] -> [s0 s2 ...] -> [s0 s1 s2 s3, ...] */
+    const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(slots[0], slots[2]), _mm_packs_epi32(slots[1], slots[3]));
+    const __m128i pairs = _mm_unpacklo_epi8(bytes, _mm_srli_si128(bytes, 8));
+
+    return _mm_unpacklo_epi16(pairs, _mm_srli_si128(pairs, 8));
+}
+
+/* Returns the number of processed pixels. */
+static unsigned planar_row_to_rgba32_sse2(const uint8_t *y, const uint8_t *u, const uint8_t *v, bool subsampled, unsigned chroma_step,
+                                          unsigned width, const struct yuv_coefficients *c, const struct rgb8_layout *layout, uint8_t *rgba) {
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i y_bias = _mm_set1_epi16(c->y_bias);
+    const __m128i chroma_bias = _mm_set1_epi16(128);
+    const __m128i rounding = _mm_set1_epi32(1 << (YUV_TO_RGB_BITS - 1));
+    const __m128i alpha = _mm_set1_epi32(255);
+
+    const __m128i y_rv = _mm_setr_epi16(c->y_scale, c->rv, c->y_scale, c->rv, c->y_scale, c->rv, c->y_scale, c->rv);
+    const __m128i y_gu = _mm_setr_epi16(c->y_scale, c->gu, c->y_scale, c->gu, c->y_scale, c->gu, c->y_scale, c->gu);
+    const __m128i y_bu = _mm_setr_epi16(c->y_scale, c->bu, c->y_scale, c->bu, c->y_scale, c->bu, c->y_scale, c->bu);
+    const __m128i gv_0 = _mm_setr_epi16(c->gv, 0, c->gv, 0, c->gv, 0, c->gv, 0);
+
+    unsigned x = 0;
+
+    for (; x + 8 <= width; x += 8) {
+        const __m128i luma = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(const void *)(y + x)), zero), y_bias);
+
+        __m128i cb, cr;
+
+        if (!subsampled) {
+            cb = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(const void *)(u + x)), zero);
+            cr = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(const void *)(v + x)), zero);
+        } else if (chroma_step == 1) {
+            int32_t u4, v4;
+            memcpy(&u4, u + x / 2, sizeof(u4));
+            memcpy(&v4, v + x / 2, sizeof(v4));
+            cb = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+            cr = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+            cb = _mm_unpacklo_epi16(cb, cb);
+            cr = _mm_unpacklo_epi16(cr, cr);
+        } else {
+            /* NV12: [u0 v0 u1 v1 u2 v2 u3 v3] as 32-bit lanes. */
+            const __m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(const void *)(u + x)), zero);
+            cb = _mm_and_si128(uv, _mm_set1_epi32(0xFFFF));
+            cr = _mm_srli_epi32(uv, 16);
+            cb = _mm_or_si128(cb, _mm_slli_epi32(cb, 16));
+            cr = _mm_or_si128(cr, _mm_slli_epi32(cr, 16));
+        }
+
+        cb = _mm_sub_epi16(cb, chroma_bias);
+        cr = _mm_sub_epi16(cr, chroma_bias);
+
+        for (int half = 0; half < 2; half++) {
+            const __m128i luma_cr = half ? _mm_unpackhi_epi16(luma, cr) : _mm_unpacklo_epi16(luma, cr);
+            const __m128i luma_cb = half ? _mm_unpackhi_epi16(luma, cb) : _mm_unpacklo_epi16(luma, cb);
+            const __m128i cr_0    = half ? _mm_unpackhi_epi16(cr, zero) : _mm_unpacklo_epi16(cr, zero);
+
+            __m128i slots[4];
+            slots[layout->r] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(luma_cr, y_rv), rounding), YUV_TO_RGB_BITS);
+            slots[layout->g] = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(luma_cb, y_gu),
+                                                                          _mm_madd_epi16(cr_0, gv_0)), rounding), YUV_TO_RGB_BITS);
+            slots[layout->b] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(luma_cb, y_bu), rounding), YUV_TO_RGB_BITS);
+            slots[layout->a] = alpha;
+
+            _mm_storeu_si128((__m128i *)(void *)(rgba + (size_t)(x + half * 4) * 4), interleave_rgba32_sse2(slots));
+        }
+    }
+
+    return x;
+}
+#endif
+
+static void planar_row_to_rgb8(const uint8_t *y, const uint8_t *u, const uint8_t *v, bool subsampled, unsigned chroma_step,
+                               unsigned width, const struct yuv_coefficients *c, const struct rgb8_layout *layout, uint8_t *rgb) {
+
+    unsigned x = 0;
+
+#ifdef SAIL_YUV_SSE2
+    if (layout->bytes_per_pixel == 4) {
+        x = planar_row_to_rgba32_sse2(y, u, v, subsampled, chroma_step, width, c, layout, rgb);
+    }
+#endif
+
+    for (; x < width; x++) {
+        const size_t chroma = (size_t)(subsampled ? x / 2 : x) * chroma_step;
+
+        const int32_t luma = c->y_scale * (y[x] - c->y_bias) + (1 << (YUV_TO_RGB_BITS - 1));
+        const int cb = u[chroma] - 128;
+        const int cr = v[chroma] - 128;
+
+        uint8_t *pixel = rgb + (size_t)x * layout->bytes_per_pixel;
+
+        pixel[layout->r] = clamp_fixed(luma + c->rv * cr, YUV_TO_RGB_BITS);
+        pixel[layout->g] = clamp_fixed(luma + c->gu * cb + c->gv * cr, YUV_TO_RGB_BITS);
+        pixel[layout->b] = clamp_fixed(luma + c->bu * cb, YUV_TO_RGB_BITS);
+
+        if (layout->a >= 0) {
+            pixel[layout->a] = 255;
+        }
+    }
+}
+
+void planar_to_rgb8_rows(const struct planar_rows *rows, unsigned width, const struct yuv_coefficients *coefficients,
+                         const struct rgb8_layout *layout, uint8_t *const rgb[2]) {
+
+    for (unsigned row = 0; row < rows->rows; row++) {
+        planar_row_to_rgb8(rows->y[row], rows->u[row], rows->v[row], rows->subsampled, rows->chroma_step,
+                           width, coefficients, layout, rgb[row]);
+    }
+}
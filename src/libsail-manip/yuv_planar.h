@@ -0,0 +1,114 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_YUV_PLANAR_H
+#define SAIL_YUV_PLANAR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef SAIL_BUILD
+    #include "common.h"
+    #include "export.h"
+
+    #include "manip_common.h"
+#else
+    #include <sail-common/common.h>
+    #include <sail-common/export.h>
+
+    #include <sail-manip/manip_common.h>
+#endif
+
+struct sail_image_plane;
+
+/*
+ * Fixed-point RGB <-> YUV coefficients. RGB -> YUV coefficients have 14 fractional bits,
+ * YUV -> RGB coefficients have 13 fractional bits, so all of them fit into int16_t
+ * and could be multiplied with PMADDWD.
+ */
+struct yuv_coefficients {
+    /* RGB -> YUV. The offsets include the rounding and the Y/chroma bias. */
+    int16_t yr, yg, yb;
+    int16_t ur, ug, ub;
+    int16_t vr, vg, vb;
+    int32_t y_offset;
+    int32_t chroma_offset;
+
+    /* YUV -> RGB. */
+    int16_t y_bias;
+    int16_t y_scale;
+    int16_t rv, gu, gv, bu;
+};
+
+SAIL_HIDDEN void init_yuv_coefficients(enum SailYuvMatrix matrix, enum SailYuvRange range, struct yuv_coefficients *coefficients);
+
+/*
+ * Byte layout of the 8-bit RGB pixel formats planar YUV is converted from and to directly.
+ * 'a' is the index of the alpha or padding byte or -1. Output alpha and padding bytes are set to 255.
+ */
+struct rgb8_layout {
+    unsigned bytes_per_pixel;
+    int r, g, b, a;
+    bool alpha;
+};
+
+/*
+ * Returns true and fills the layout if the pixel format is BPP24-RGB, BPP24-BGR, or one of the BPP32 RGBA kinds.
+ */
+SAIL_HIDDEN bool rgb8_layout_of(enum SailPixelFormat pixel_format, struct rgb8_layout *layout);
+
+/*
+ * A pair of luma rows and their chroma samples. Formats with 2x2 chroma subsampling point u[0] and u[1]
+ * (v[0] and v[1]) to the same chroma row. NV12 sets v to u + 1 and chroma_step to 2.
+ */
+struct planar_rows {
+    unsigned rows; /* 1 or 2. */
+    bool subsampled;
+    unsigned chroma_step;
+    uint8_t *y[2];
+    uint8_t *u[2];
+    uint8_t *v[2];
+};
+
+/*
+ * Fills the rows of the row pair 'pair' (the image rows 2*pair and 2*pair+1) from the planes
+ * returned by sail_image_planes().
+ */
+SAIL_HIDDEN void planar_rows_of(enum SailPixelFormat pixel_format, const struct sail_image_plane *planes,
+                                unsigned pair, struct planar_rows *rows);
+
+/*
+ * Converts rows->rows rows of 8-bit RGB pixels into the planar rows. Subsampled chroma is averaged over 2x2 blocks.
+ */
+SAIL_HIDDEN void rgb8_to_planar_rows(const uint8_t *const rgb[2], const struct rgb8_layout *layout, unsigned width,
+                                     const struct yuv_coefficients *coefficients, const struct planar_rows *rows);
+
+/*
+ * Converts the planar rows into rows->rows rows of 8-bit RGB pixels. Subsampled chroma is replicated.
+ */
+SAIL_HIDDEN void planar_to_rgb8_rows(const struct planar_rows *rows, unsigned width, const struct yuv_coefficients *coefficients,
+                                     const struct rgb8_layout *layout, uint8_t *const rgb[2]);
+
+#endif
@@ -0,0 +1,439 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "config.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef SAIL_WIN32
+    #include <io.h>
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+    #include <sys/types.h>
+    #include <unistd.h>
+#endif
+
+#include "sail-common.h"
+#include "sail.h"
+
+struct fd_io_stream {
+
+    /* Not owned. Shared with the clones. */
+    int fd;
+
+    /* Current stream position of this I/O object only. Can be beyond the end like with fseek(). */
+    size_t pos;
+};
+
+/*
+ * Private functions.
+ */
+
+#ifdef SAIL_WIN32
+/* Windows has no pread() and pwrite(), but reads and writes at explicit offsets with OVERLAPPED. */
+static sail_status_t positional_read(int fd, void *buf, size_t size, size_t offset, size_t *read_size) {
+
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    const DWORD chunk = size > MAXDWORD ? MAXDWORD : (DWORD)size;
+
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset     = (DWORD)((uint64_t)offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+
+    DWORD bytes_read;
+
+    if (!ReadFile(handle, buf, chunk, &bytes_read, &overlapped)) {
+        if (GetLastError() == ERROR_HANDLE_EOF) {
+            *read_size = 0;
+            return SAIL_OK;
+        }
+
+        SAIL_LOG_ERROR("Failed to read from the file descriptor. Error: 0x%X", GetLastError());
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    *read_size = bytes_read;
+
+    return SAIL_OK;
+}
+
+static sail_status_t positional_write(int fd, const void *buf, size_t size, size_t offset, size_t *written_size) {
+
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    const DWORD chunk = size > MAXDWORD ? MAXDWORD : (DWORD)size;
+
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+    overlapped.Offset     = (DWORD)((uint64_t)offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+
+    DWORD bytes_written;
+
+    if (!WriteFile(handle, buf, chunk, &bytes_written, &overlapped)) {
+        SAIL_LOG_ERROR("Failed to write into the file descriptor. Error: 0x%X", GetLastError());
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    *written_size = bytes_written;
+
+    return SAIL_OK;
+}
+
+static sail_status_t file_size(int fd, size_t *size) {
+
+    HANDLE handle = (HANDLE)_get_osfhandle(fd);
+    LARGE_INTEGER file_size;
+
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &file_size)) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    *size = (size_t)file_size.QuadPart;
+
+    return SAIL_OK;
+}
+#else
+static sail_status_t positional_read(int fd, void *buf, size_t size, size_t offset, size_t *read_size) {
+
+    if ((off_t)offset < 0) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    ssize_t result;
+
+    do {
+        result = pread(fd, buf, size, (off_t)offset);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0) {
+        sail_print_errno("Failed to read from the file descriptor: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    *read_size = (size_t)result;
+
+    return SAIL_OK;
+}
+
+static sail_status_t positional_write(int fd, const void *buf, size_t size, size_t offset, size_t *written_size) {
+
+    if ((off_t)offset < 0) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    ssize_t result;
+
+    do {
+        result = pwrite(fd, buf, size, (off_t)offset);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0) {
+        sail_print_errno("Failed to write into the file descriptor: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    *written_size = (size_t)result;
+
+    return SAIL_OK;
+}
+
+static sail_status_t file_size(int fd, size_t *size) {
+
+    struct stat attrs;
+
+    if (fstat(fd, &attrs) != 0) {
+        sail_print_errno("Failed to get the file size: %s");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    *size = (size_t)attrs.st_size;
+
+    return SAIL_OK;
+}
+#endif
+
+static sail_status_t io_fd_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_BUFFER_PTR(buf);
+    SAIL_CHECK_RESULT_PTR(read_size);
+
+    struct fd_io_stream *fd_io_stream = (struct fd_io_stream *)stream;
+
+    /* Positional reads may return less than requested before the end. Behave like fread(). */
+    size_t total_read_size = 0;
+
+    while (total_read_size < size_to_read) {
+        size_t chunk_read_size;
+        SAIL_TRY(positional_read(fd_io_stream->fd,
+                                 (char *)buf + total_read_size,
+                                 size_to_read - total_read_size,
+                                 fd_io_stream->pos + total_read_size,
+                                 &chunk_read_size));
+
+        if (chunk_read_size == 0) {
+            break;
+        }
+
+        total_read_size += chunk_read_size;
+    }
+
+    fd_io_stream->pos += total_read_size;
+    *read_size = total_read_size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_strict_read(void *stream, void *buf, size_t size_to_read) {
+
+    size_t read_size;
+
+    SAIL_TRY(io_fd_tolerant_read(stream, buf, size_to_read, &read_size));
+
+    if (read_size != size_to_read) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_seek(void *stream, long offset, int whence) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    struct fd_io_stream *fd_io_stream = (struct fd_io_stream *)stream;
+
+    size_t base;
+
+    switch (whence) {
+        case SEEK_SET: base = 0;                 break;
+        case SEEK_CUR: base = fd_io_stream->pos; break;
+
+        case SEEK_END: {
+            SAIL_TRY(file_size(fd_io_stream->fd, &base));
+            break;
+        }
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    /* Modular arithmetic gives the magnitude of negative offsets without overflowing on LONG_MIN. */
+    const size_t magnitude = offset < 0 ? (size_t)0 - (size_t)offset : (size_t)offset;
+
+    if (offset < 0 && magnitude > base) {
+        SAIL_LOG_ERROR("Failed to seek before the beginning of the file");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    fd_io_stream->pos = offset < 0 ? base - magnitude : base + magnitude;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_tell(void *stream, size_t *offset) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_PTR(offset);
+
+    const struct fd_io_stream *fd_io_stream = (const struct fd_io_stream *)stream;
+
+    *offset = fd_io_stream->pos;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_tolerant_write(void *stream, const void *buf, size_t size_to_write, size_t *written_size) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_BUFFER_PTR(buf);
+    SAIL_CHECK_RESULT_PTR(written_size);
+
+    struct fd_io_stream *fd_io_stream = (struct fd_io_stream *)stream;
+
+    size_t total_written_size = 0;
+
+    while (total_written_size < size_to_write) {
+        size_t chunk_written_size;
+        SAIL_TRY(positional_write(fd_io_stream->fd,
+                                  (const char *)buf + total_written_size,
+                                  size_to_write - total_written_size,
+                                  fd_io_stream->pos + total_written_size,
+                                  &chunk_written_size));
+
+        if (chunk_written_size == 0) {
+            break;
+        }
+
+        total_written_size += chunk_written_size;
+    }
+
+    fd_io_stream->pos += total_written_size;
+    *written_size = total_written_size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_strict_write(void *stream, const void *buf, size_t size_to_write) {
+
+    size_t written_size;
+
+    SAIL_TRY(io_fd_tolerant_write(stream, buf, size_to_write, &written_size));
+
+    if (written_size != size_to_write) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_flush(void *stream) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    /* Nothing is buffered. */
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_close(void *stream) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    /* The file descriptor is owned by the caller. */
+    sail_free(stream);
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_fd_eof(void *stream, bool *result) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_RESULT_PTR(result);
+
+    const struct fd_io_stream *fd_io_stream = (const struct fd_io_stream *)stream;
+
+    size_t size;
+    SAIL_TRY(file_size(fd_io_stream->fd, &size));
+
+    *result = fd_io_stream->pos >= size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t alloc_io_fd(int fd, size_t pos, bool writable, struct sail_io **io) {
+
+    SAIL_CHECK_IO_PTR(io);
+
+    if (fd < 0) {
+        SAIL_LOG_ERROR("Invalid file descriptor %d", fd);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_ARGUMENT);
+    }
+
+    struct sail_io *io_local;
+    SAIL_TRY(sail_alloc_io(&io_local));
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct fd_io_stream), &ptr),
+                        /* cleanup */ sail_destroy_io(io_local));
+    struct fd_io_stream *fd_io_stream = ptr;
+
+    fd_io_stream->fd  = fd;
+    fd_io_stream->pos = pos;
+
+    io_local->id             = SAIL_FD_IO_ID;
+    io_local->stream         = fd_io_stream;
+    io_local->tolerant_read  = io_fd_tolerant_read;
+    io_local->strict_read    = io_fd_strict_read;
+    io_local->seek           = io_fd_seek;
+    io_local->tell           = io_fd_tell;
+    io_local->tolerant_write = writable ? io_fd_tolerant_write : io_noop_tolerant_write;
+    io_local->strict_write   = writable ? io_fd_strict_write   : io_noop_strict_write;
+    io_local->flush          = writable ? io_fd_flush          : io_noop_flush;
+    io_local->close          = io_fd_close;
+    io_local->eof            = io_fd_eof;
+
+    *io = io_local;
+
+    return SAIL_OK;
+}
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_alloc_io_read_fd(int fd, struct sail_io **io) {
+
+    SAIL_LOG_DEBUG("Opening file descriptor %d for reading", fd);
+
+    SAIL_TRY(alloc_io_fd(fd, 0, false /* writable */, io));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_alloc_io_write_fd(int fd, struct sail_io **io) {
+
+    SAIL_LOG_DEBUG("Opening file descriptor %d for writing", fd);
+
+    SAIL_TRY(alloc_io_fd(fd, 0, true /* writable */, io));
+
+    return SAIL_OK;
+}
+
+sail_status_t sail_clone_io_fd(const struct sail_io *io, struct sail_io **io_clone) {
+
+    SAIL_CHECK_IO_PTR(io);
+    SAIL_CHECK_IO_PTR(io_clone);
+
+    if (io->id != SAIL_FD_IO_ID || io->close != io_fd_close) {
+        SAIL_LOG_ERROR("Only file descriptor I/O objects can be cloned");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_INVALID_IO);
+    }
+
+    const struct fd_io_stream *fd_io_stream = (const struct fd_io_stream *)io->stream;
+
+    SAIL_TRY(alloc_io_fd(fd_io_stream->fd,
+                         fd_io_stream->pos,
+                         io->tolerant_write == io_fd_tolerant_write,
+                         io_clone));
+
+    return SAIL_OK;
+}
@@ -0,0 +1,93 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_IO_FD_H
+#define SAIL_IO_FD_H
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sail_io;
+
+/*
+ * File descriptor I/O. Reads and writes with pread() and pwrite() at the position of the I/O
+ * object instead of the shared position of the file descriptor. Multiple I/O objects over the same
+ * file descriptor can be used from different threads at the same time. For example, to decode
+ * different frames of the same file in parallel.
+ *
+ * The file descriptor is not closed when the I/O object is destroyed. It MUST remain open
+ * until all the I/O objects using it are destroyed.
+ */
+
+/*
+ * Allocates a new I/O object for reading from the specified file descriptor starting at offset 0.
+ * The file descriptor MUST be opened for reading and MUST support positional reads, i.e. refer
+ * to a regular file. The assigned I/O object MUST be destroyed later with sail_destroy_io().
+ *
+ * Typical usage: sail_alloc_io_read_fd() ->
+ *                sail_start_reading_io() ->
+ *                sail_read_next_frame()  ->
+ *                sail_stop_reading()     ->
+ *                sail_destroy_io().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_io_read_fd(int fd, struct sail_io **io);
+
+/*
+ * Allocates a new I/O object for writing into the specified file descriptor starting at offset 0.
+ * The file descriptor MUST be opened for writing and MUST support positional writes, i.e. refer
+ * to a regular file. The assigned I/O object MUST be destroyed later with sail_destroy_io().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_alloc_io_write_fd(int fd, struct sail_io **io);
+
+/*
+ * Allocates a new I/O object over the same file descriptor as the specified file descriptor
+ * I/O object. The new I/O object starts at the same position, but then moves independently.
+ * No system calls are made. The assigned I/O object MUST be destroyed later with sail_destroy_io().
+ *
+ * Returns SAIL_OK on success.
+ * Returns SAIL_ERROR_INVALID_IO if the I/O object was not allocated with sail_alloc_io_read_fd()
+ * or sail_alloc_io_write_fd().
+ */
+SAIL_EXPORT sail_status_t sail_clone_io_fd(const struct sail_io *io, struct sail_io **io_clone);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -168,31 +168,40 @@ static sail_status_t io_file_eof(void *stream, bool *result) {
     return SAIL_OK;
 }
 
-static sail_status_t alloc_io_file(const char *path, const char *mode, struct sail_io **io) {
+static sail_status_t open_file(const char *path, const char *mode, FILE **fptr) {
 
     SAIL_CHECK_PATH_PTR(path);
     SAIL_CHECK_STRING_PTR(mode);
-    SAIL_CHECK_IO_PTR(io);
+    SAIL_CHECK_PTR(fptr);
 
     SAIL_LOG_DEBUG("Opening file '%s' in '%s' mode", path, mode);
 
     /* Try to open the file first */
-    FILE *fptr;
+    FILE *fptr_local;
 
 #ifdef SAIL_WIN32
-    fptr = _fsopen(path, mode, _SH_DENYWR);
+    fptr_local = _fsopen(path, mode, _SH_DENYWR);
 #else
     /* Fallback to a regular fopen() */
-    fptr = fopen(path, mode);
+    fptr_local = fopen(path, mode);
 #endif
 
-    if (fptr == NULL) {
+    if (fptr_local == NULL) {
         sail_print_errno("Failed to open the specified file: %s");
         SAIL_LOG_AND_RETURN(SAIL_ERROR_OPEN_FILE);
     }
 
-    SAIL_TRY_OR_CLEANUP(sail_alloc_io(io),
-                        /* cleanup */ fclose(fptr));
+    *fptr = fptr_local;
+
+    return SAIL_OK;
+}
+
+/* Allocates a new I/O object for the opened file. The caller closes the file on error. */
+static sail_status_t alloc_io_file(FILE *fptr, struct sail_io **io) {
+
+    SAIL_CHECK_IO_PTR(io);
+
+    SAIL_TRY(sail_alloc_io(io));
 
     (*io)->id     = SAIL_FILE_IO_ID;
     (*io)->stream = fptr;
@@ -206,7 +215,19 @@ static sail_status_t alloc_io_file(const char *path, const char *mode, struct sa
 
 sail_status_t alloc_io_read_file(const char *path, struct sail_io **io) {
 
-    SAIL_TRY(alloc_io_file(path, "rb", io));
+    SAIL_CHECK_IO_PTR(io);
+
+    FILE *fptr;
+    SAIL_TRY(open_file(path, "rb", &fptr));
+
+    /* Map large files into memory to read them without copying through stdio buffers. The mapping keeps the file open. */
+    if (alloc_io_read_mmap(fptr, SAIL_MMAP_IO_MIN_FILE_SIZE, io) == SAIL_OK) {
+        fclose(fptr);
+        return SAIL_OK;
+    }
+
+    SAIL_TRY_OR_CLEANUP(alloc_io_file(fptr, io),
+                        /* cleanup */ fclose(fptr));
 
     (*io)->tolerant_read  = io_file_tolerant_read;
     (*io)->strict_read    = io_file_strict_read;
@@ -223,7 +244,13 @@ sail_status_t alloc_io_read_file(const char *path, struct sail_io **io) {
 
 sail_status_t alloc_io_write_file(const char *path, struct sail_io **io) {
 
-    SAIL_TRY(alloc_io_file(path, "w+b", io));
+    SAIL_CHECK_IO_PTR(io);
+
+    FILE *fptr;
+    SAIL_TRY(open_file(path, "w+b", &fptr));
+
+    SAIL_TRY_OR_CLEANUP(alloc_io_file(fptr, io),
+                        /* cleanup */ fclose(fptr));
 
     (*io)->tolerant_read  = io_file_tolerant_read;
     (*io)->strict_read    = io_file_strict_read;
@@ -38,6 +38,8 @@ struct sail_io;
 
 /*
  * Opens the specified image file for reading and allocates a new I/O object for it.
+ * Files of SAIL_MMAP_IO_MIN_FILE_SIZE bytes and larger are memory-mapped with alloc_io_read_mmap().
+ * The file is opened once, and smaller files and files that cannot be mapped are read from it through stdio.
  * The assigned I/O object MUST be destroyed later with sail_destroy_io().
  *
  * Returns SAIL_OK on success.
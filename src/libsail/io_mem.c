@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -68,6 +69,21 @@ struct mem_io_write_stream {
     void *buffer;
 };
 
+/*
+ * Growing write streams share the layout of the write streams, so the read functions
+ * and the functions working with the buffer info only are reused.
+ */
+struct mem_io_growing_write_stream {
+    struct mem_io_buffer_info mem_io_buffer_info;
+    void *buffer;
+
+    /* Where to hand the buffer over to the caller when the stream is closed. */
+    void **buffer_target;
+};
+
+/* Used when no initial size is specified. */
+static const size_t GROWING_MEM_IO_DEFAULT_SIZE = 16 * 1024;
+
 /*
  * Private functions.
  */
@@ -211,6 +227,137 @@ static sail_status_t io_mem_strict_write(void *stream, const void *buf, size_t s
     return SAIL_OK;
 }
 
+/*
+ * Grows the buffer geometrically so it holds at least the specified number of bytes.
+ */
+static sail_status_t growing_mem_reserve(struct mem_io_growing_write_stream *mem_io_growing_write_stream, size_t size) {
+
+    struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_growing_write_stream->mem_io_buffer_info;
+
+    if (size <= mem_io_buffer_info->length) {
+        return SAIL_OK;
+    }
+
+    size_t new_length = mem_io_buffer_info->length;
+
+    while (new_length < size) {
+        new_length = (new_length > SIZE_MAX / 2) ? size : new_length * 2;
+    }
+
+    SAIL_TRY(sail_realloc(new_length, &mem_io_growing_write_stream->buffer));
+    mem_io_buffer_info->length = new_length;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growing_mem_seek(void *stream, long offset, int whence) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    struct mem_io_growing_write_stream *mem_io_growing_write_stream = (struct mem_io_growing_write_stream *)stream;
+    struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_growing_write_stream->mem_io_buffer_info;
+
+    size_t base;
+
+    switch (whence) {
+        case SEEK_SET: base = 0;                                     break;
+        case SEEK_CUR: base = mem_io_buffer_info->pos;               break;
+        case SEEK_END: base = mem_io_buffer_info->accessible_length; break;
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    /* Modular arithmetic gives the magnitude of negative offsets without overflowing on LONG_MIN. */
+    const size_t magnitude = offset < 0 ? (size_t)0 - (size_t)offset : (size_t)offset;
+
+    if (offset < 0 && magnitude > base) {
+        SAIL_LOG_ERROR("Failed to seek before the beginning of the buffer");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    /* Like with files, seeking past the end doesn't change the data until something is written there. */
+    mem_io_buffer_info->pos = offset < 0 ? base - magnitude : base + magnitude;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growing_mem_tolerant_write(void *stream, const void *buf, size_t size_to_write, size_t *written_size) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_BUFFER_PTR(buf);
+    SAIL_CHECK_RESULT_PTR(written_size);
+
+    struct mem_io_growing_write_stream *mem_io_growing_write_stream = (struct mem_io_growing_write_stream *)stream;
+    struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_growing_write_stream->mem_io_buffer_info;
+
+    *written_size = 0;
+
+    if (size_to_write > SIZE_MAX - mem_io_buffer_info->pos) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    SAIL_TRY(growing_mem_reserve(mem_io_growing_write_stream, mem_io_buffer_info->pos + size_to_write));
+
+    char *buffer = mem_io_growing_write_stream->buffer;
+
+    /* Fill the gap left by seeking past the end. */
+    if (mem_io_buffer_info->pos > mem_io_buffer_info->accessible_length) {
+        memset(buffer + mem_io_buffer_info->accessible_length, 0, mem_io_buffer_info->pos - mem_io_buffer_info->accessible_length);
+    }
+
+    memcpy(buffer + mem_io_buffer_info->pos, buf, size_to_write);
+    mem_io_buffer_info->pos += size_to_write;
+
+    *written_size = size_to_write;
+
+    if (mem_io_buffer_info->pos > mem_io_buffer_info->accessible_length) {
+        mem_io_buffer_info->accessible_length = mem_io_buffer_info->pos;
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growing_mem_strict_write(void *stream, const void *buf, size_t size_to_write) {
+
+    size_t written_size;
+
+    SAIL_TRY(io_growing_mem_tolerant_write(stream, buf, size_to_write, &written_size));
+
+    if (written_size != size_to_write) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_WRITE_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_growing_mem_close(void *stream) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    struct mem_io_growing_write_stream *mem_io_growing_write_stream = (struct mem_io_growing_write_stream *)stream;
+    const struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_growing_write_stream->mem_io_buffer_info;
+
+    /* Give the unused capacity back. Shrinking is not essential, so ignore errors. */
+    if (mem_io_buffer_info->accessible_length == 0) {
+        sail_free(mem_io_growing_write_stream->buffer);
+        mem_io_growing_write_stream->buffer = NULL;
+    } else if (mem_io_buffer_info->accessible_length < mem_io_buffer_info->length) {
+        void *buffer = mem_io_growing_write_stream->buffer;
+
+        if (sail_realloc(mem_io_buffer_info->accessible_length, &buffer) == SAIL_OK) {
+            mem_io_growing_write_stream->buffer = buffer;
+        }
+    }
+
+    *mem_io_growing_write_stream->buffer_target = mem_io_growing_write_stream->buffer;
+
+    sail_free(mem_io_growing_write_stream);
+
+    return SAIL_OK;
+}
+
 static sail_status_t io_mem_flush(void *stream) {
 
     SAIL_CHECK_STREAM_PTR(stream);
@@ -239,6 +386,39 @@ static sail_status_t io_mem_eof(void *stream, bool *result) {
     return SAIL_OK;
 }
 
+static sail_status_t io_mem_map_range(void *stream, size_t offset, size_t size, const void **ptr, size_t *mapped_size) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_PTR(ptr);
+    SAIL_CHECK_RESULT_PTR(mapped_size);
+
+    const struct mem_io_read_stream *mem_io_read_stream = (const struct mem_io_read_stream *)stream;
+    const struct mem_io_buffer_info *mem_io_buffer_info = &mem_io_read_stream->mem_io_buffer_info;
+
+    if (offset >= mem_io_buffer_info->accessible_length) {
+        *ptr = NULL;
+        *mapped_size = 0;
+        return SAIL_OK;
+    }
+
+    const size_t available = mem_io_buffer_info->accessible_length - offset;
+
+    *ptr = (const char *)mem_io_read_stream->buffer + offset;
+    *mapped_size = size > available ? available : size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mem_release(void *stream, const void *ptr) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    (void)ptr;
+
+    /* The caller owns the buffer. */
+
+    return SAIL_OK;
+}
+
 /*
  * Public functions.
  */
@@ -274,6 +454,8 @@ sail_status_t alloc_io_read_mem(const void *buffer, size_t length, struct sail_i
     io_local->flush          = io_noop_flush;
     io_local->close          = io_mem_close;
     io_local->eof            = io_mem_eof;
+    io_local->map_range      = io_mem_map_range;
+    io_local->release        = io_mem_release;
 
     *io = io_local;
 
@@ -316,3 +498,51 @@ sail_status_t alloc_io_write_mem(void *buffer, size_t length, struct sail_io **i
 
     return SAIL_OK;
 }
+
+sail_status_t alloc_io_write_growing_mem(size_t initial_size, void **buffer, struct sail_io **io) {
+
+    SAIL_CHECK_BUFFER_PTR(buffer);
+    SAIL_CHECK_IO_PTR(io);
+
+    *buffer = NULL;
+
+    if (initial_size == 0) {
+        initial_size = GROWING_MEM_IO_DEFAULT_SIZE;
+    }
+
+    SAIL_LOG_DEBUG("Opening growing memory buffer of initial size %lu for writing", (unsigned long)initial_size);
+
+    struct sail_io *io_local;
+    SAIL_TRY(sail_alloc_io(&io_local));
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct mem_io_growing_write_stream), &ptr),
+                        /* cleanup */ sail_destroy_io(io_local));
+    struct mem_io_growing_write_stream *mem_io_growing_write_stream = ptr;
+
+    SAIL_TRY_OR_CLEANUP(sail_malloc(initial_size, &ptr),
+                        /* cleanup */ sail_free(mem_io_growing_write_stream),
+                                      sail_destroy_io(io_local));
+
+    mem_io_growing_write_stream->mem_io_buffer_info.length            = initial_size;
+    mem_io_growing_write_stream->mem_io_buffer_info.accessible_length = 0;
+    mem_io_growing_write_stream->mem_io_buffer_info.pos               = 0;
+    mem_io_growing_write_stream->buffer                               = ptr;
+    mem_io_growing_write_stream->buffer_target                        = buffer;
+
+    io_local->id             = SAIL_MEMORY_IO_ID;
+    io_local->stream         = mem_io_growing_write_stream;
+    io_local->tolerant_read  = io_mem_tolerant_read;
+    io_local->strict_read    = io_mem_strict_read;
+    io_local->seek           = io_growing_mem_seek;
+    io_local->tell           = io_mem_tell;
+    io_local->tolerant_write = io_growing_mem_tolerant_write;
+    io_local->strict_write   = io_growing_mem_strict_write;
+    io_local->flush          = io_mem_flush;
+    io_local->close          = io_growing_mem_close;
+    io_local->eof            = io_mem_eof;
+
+    *io = io_local;
+
+    return SAIL_OK;
+}
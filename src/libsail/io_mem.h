@@ -54,4 +54,17 @@ SAIL_HIDDEN sail_status_t alloc_io_read_mem(const void *buffer, size_t length, s
  */
 SAIL_HIDDEN sail_status_t alloc_io_write_mem(void *buffer, size_t length, struct sail_io **io);
 
+/*
+ * Allocates a new memory buffer of the specified initial size for writing and a new I/O object for it.
+ * The buffer grows geometrically as needed. Zero initial size means a reasonable default.
+ * The assigned I/O object MUST be destroyed later with sail_destroy_io().
+ *
+ * When the I/O object is closed, the buffer is shrunk to the number of bytes written and assigned
+ * to the 'buffer' argument, so it MUST remain valid until then. The caller becomes the owner
+ * of the buffer and MUST free it with sail_free(). NULL is assigned if nothing was written.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t alloc_io_write_growing_mem(size_t initial_size, void **buffer, struct sail_io **io);
+
 #endif
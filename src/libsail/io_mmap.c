@@ -0,0 +1,328 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef SAIL_WIN32
+    /* _get_osfhandle() */
+    #include <io.h>
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include "sail-common.h"
+#include "sail.h"
+
+struct mmap_io_stream {
+
+    const unsigned char *data;
+    size_t length;
+
+    /* Current stream position. Can be beyond the end like with fseek(). */
+    size_t pos;
+
+#ifdef SAIL_WIN32
+    HANDLE mapping;
+#endif
+};
+
+/*
+ * Private functions.
+ */
+
+static sail_status_t io_mmap_tolerant_read(void *stream, void *buf, size_t size_to_read, size_t *read_size) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_BUFFER_PTR(buf);
+    SAIL_CHECK_RESULT_PTR(read_size);
+
+    struct mmap_io_stream *mmap_io_stream = (struct mmap_io_stream *)stream;
+
+    /* Behave like fread(): reading at the end is not an error. */
+    if (mmap_io_stream->pos >= mmap_io_stream->length) {
+        *read_size = 0;
+        return SAIL_OK;
+    }
+
+    const size_t available = mmap_io_stream->length - mmap_io_stream->pos;
+    const size_t actual_size_to_read = size_to_read > available ? available : size_to_read;
+
+    memcpy(buf, mmap_io_stream->data + mmap_io_stream->pos, actual_size_to_read);
+    mmap_io_stream->pos += actual_size_to_read;
+
+    *read_size = actual_size_to_read;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mmap_strict_read(void *stream, void *buf, size_t size_to_read) {
+
+    size_t read_size;
+
+    SAIL_TRY(io_mmap_tolerant_read(stream, buf, size_to_read, &read_size));
+
+    if (read_size != size_to_read) {
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mmap_seek(void *stream, long offset, int whence) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    struct mmap_io_stream *mmap_io_stream = (struct mmap_io_stream *)stream;
+
+    size_t base;
+
+    switch (whence) {
+        case SEEK_SET: base = 0;                      break;
+        case SEEK_CUR: base = mmap_io_stream->pos;    break;
+        case SEEK_END: base = mmap_io_stream->length; break;
+
+        default: {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_SEEK_WHENCE);
+        }
+    }
+
+    /* Modular arithmetic gives the magnitude of negative offsets without overflowing on LONG_MIN. */
+    const size_t magnitude = offset < 0 ? (size_t)0 - (size_t)offset : (size_t)offset;
+
+    if (offset < 0 && magnitude > base) {
+        SAIL_LOG_ERROR("Failed to seek before the beginning of the file");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_SEEK_IO);
+    }
+
+    mmap_io_stream->pos = offset < 0 ? base - magnitude : base + magnitude;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mmap_tell(void *stream, size_t *offset) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_PTR(offset);
+
+    const struct mmap_io_stream *mmap_io_stream = (const struct mmap_io_stream *)stream;
+
+    *offset = mmap_io_stream->pos;
+
+    return SAIL_OK;
+}
+
+static bool unmap_file(const struct mmap_io_stream *mmap_io_stream) {
+
+#ifdef SAIL_WIN32
+    const bool unmapped = UnmapViewOfFile(mmap_io_stream->data);
+    return CloseHandle(mmap_io_stream->mapping) && unmapped;
+#else
+    return munmap((void *)mmap_io_stream->data, mmap_io_stream->length) == 0;
+#endif
+}
+
+static sail_status_t io_mmap_close(void *stream) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+
+    struct mmap_io_stream *mmap_io_stream = (struct mmap_io_stream *)stream;
+
+    const bool unmapped = unmap_file(mmap_io_stream);
+    sail_free(mmap_io_stream);
+
+    if (!unmapped) {
+        SAIL_LOG_ERROR("Failed to unmap the file");
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_CLOSE_IO);
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mmap_eof(void *stream, bool *result) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_RESULT_PTR(result);
+
+    const struct mmap_io_stream *mmap_io_stream = (const struct mmap_io_stream *)stream;
+
+    *result = mmap_io_stream->pos >= mmap_io_stream->length;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mmap_map_range(void *stream, size_t offset, size_t size, const void **ptr, size_t *mapped_size) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    SAIL_CHECK_PTR(ptr);
+    SAIL_CHECK_RESULT_PTR(mapped_size);
+
+    const struct mmap_io_stream *mmap_io_stream = (const struct mmap_io_stream *)stream;
+
+    if (offset >= mmap_io_stream->length) {
+        *ptr = NULL;
+        *mapped_size = 0;
+        return SAIL_OK;
+    }
+
+    const size_t available = mmap_io_stream->length - offset;
+
+    *ptr = mmap_io_stream->data + offset;
+    *mapped_size = size > available ? available : size;
+
+    return SAIL_OK;
+}
+
+static sail_status_t io_mmap_release(void *stream, const void *ptr) {
+
+    SAIL_CHECK_STREAM_PTR(stream);
+    (void)ptr;
+
+    /* The whole file stays mapped until closing. */
+
+    return SAIL_OK;
+}
+
+#ifdef SAIL_WIN32
+static sail_status_t map_file(FILE *fptr, size_t min_size, struct mmap_io_stream *mmap_io_stream) {
+
+    HANDLE file = (HANDLE)_get_osfhandle(_fileno(fptr));
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < (LONGLONG)min_size
+            || file_size.QuadPart == 0 || (unsigned long long)file_size.QuadPart > SIZE_MAX) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    /* The mapping keeps the file open. */
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mapping == NULL) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == NULL) {
+        CloseHandle(mapping);
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    mmap_io_stream->data    = data;
+    mmap_io_stream->length  = (size_t)file_size.QuadPart;
+    mmap_io_stream->mapping = mapping;
+
+    return SAIL_OK;
+}
+#else
+static sail_status_t map_file(FILE *fptr, size_t min_size, struct mmap_io_stream *mmap_io_stream) {
+
+    const int fd = fileno(fptr);
+
+    if (fd < 0) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    struct stat attrs;
+
+    if (fstat(fd, &attrs) != 0 || !S_ISREG(attrs.st_mode) || attrs.st_size <= 0
+            || (size_t)attrs.st_size < min_size || (unsigned long long)attrs.st_size > SIZE_MAX) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    const size_t length = (size_t)attrs.st_size;
+
+    /* The mapping keeps the file open. */
+    void *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (data == MAP_FAILED) {
+        return SAIL_ERROR_OPEN_FILE;
+    }
+
+    /* Hints only, failures are harmless. Codecs mostly read forward, and start reading immediately. */
+    posix_madvise(data, length, POSIX_MADV_SEQUENTIAL);
+    posix_madvise(data, length, POSIX_MADV_WILLNEED);
+
+    mmap_io_stream->data   = data;
+    mmap_io_stream->length = length;
+
+    return SAIL_OK;
+}
+#endif
+
+/*
+ * Public functions.
+ */
+
+sail_status_t alloc_io_read_mmap(FILE *fptr, size_t min_size, struct sail_io **io) {
+
+    SAIL_CHECK_PTR(fptr);
+    SAIL_CHECK_IO_PTR(io);
+
+    void *ptr;
+    SAIL_TRY(sail_malloc(sizeof(struct mmap_io_stream), &ptr));
+    struct mmap_io_stream *mmap_io_stream = ptr;
+
+    mmap_io_stream->pos = 0;
+
+    SAIL_TRY_OR_CLEANUP(map_file(fptr, min_size, mmap_io_stream),
+                        /* cleanup */ sail_free(mmap_io_stream));
+
+    SAIL_LOG_DEBUG("Reading file of size %lu through memory mapping", (unsigned long)mmap_io_stream->length);
+
+    struct sail_io *io_local;
+    SAIL_TRY_OR_CLEANUP(sail_alloc_io(&io_local),
+                        /* cleanup */ io_mmap_close(mmap_io_stream));
+
+    io_local->id             = SAIL_FILE_IO_ID;
+    io_local->stream         = mmap_io_stream;
+    io_local->tolerant_read  = io_mmap_tolerant_read;
+    io_local->strict_read    = io_mmap_strict_read;
+    io_local->seek           = io_mmap_seek;
+    io_local->tell           = io_mmap_tell;
+    io_local->tolerant_write = io_noop_tolerant_write;
+    io_local->strict_write   = io_noop_strict_write;
+    io_local->flush          = io_noop_flush;
+    io_local->close          = io_mmap_close;
+    io_local->eof            = io_mmap_eof;
+    io_local->map_range      = io_mmap_map_range;
+    io_local->release        = io_mmap_release;
+
+    *io = io_local;
+
+    return SAIL_OK;
+}
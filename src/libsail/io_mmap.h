@@ -0,0 +1,64 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_IO_MMAP_H
+#define SAIL_IO_MMAP_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+struct sail_io;
+
+/*
+ * Files of this size and larger are memory-mapped for reading. Smaller files are read
+ * through stdio as mapping them costs more than copying.
+ */
+#define SAIL_MMAP_IO_MIN_FILE_SIZE (64 * 1024)
+
+/*
+ * Memory-maps the image file opened for reading and allocates a new I/O object for it.
+ * Codecs read directly from the page cache without copying data through stdio buffers.
+ * The mapping keeps its own reference to the file, so the caller still closes the file.
+ * The assigned I/O object MUST be destroyed later with sail_destroy_io().
+ *
+ * Fails without logging errors when the file is smaller than min_size bytes or cannot be mapped,
+ * so callers can read the opened file through stdio instead.
+ *
+ * The file MUST NOT be truncated while the I/O object is alive. Reading the truncated part of the mapping
+ * raises SIGBUS on POSIX systems and EXCEPTION_IN_PAGE_ERROR on Windows instead of returning an error.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_HIDDEN sail_status_t alloc_io_read_mmap(FILE *fptr, size_t min_size, struct sail_io **io);
+
+#endif
@@ -0,0 +1,940 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include "config.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef SAIL_WIN32
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef SAIL_HAVE_IO_URING
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+#endif
+
+#include "sail-common.h"
+#include "sail-manip.h"
+#include "sail.h"
+
+static const unsigned DEFAULT_QUEUE_DEPTH = 32;
+static const size_t DEFAULT_MAX_IN_FLIGHT_BYTES = 64 * 1024 * 1024;
+
+/* io_uring supports deeper queues, but deeper queues give nothing. */
+static const unsigned MAX_QUEUE_DEPTH = 4096;
+
+#ifndef SAIL_WIN32
+
+/*
+ * State shared by all the loading methods.
+ */
+struct load_context {
+
+    const char * const *paths;
+    size_t paths_length;
+
+    unsigned queue_depth;
+    size_t max_in_flight_bytes;
+
+    sail_load_file_callback_t callback;
+    void *user_data;
+
+    /* Set when the callback returns an error. */
+    bool stop;
+    sail_status_t status;
+};
+
+/*
+ * Passes the loaded file to the callback unless loading is stopped.
+ */
+static void deliver(struct load_context *load_context, size_t index, sail_status_t status, const void *buffer, size_t buffer_length) {
+
+    if (load_context->stop) {
+        return;
+    }
+
+    const sail_status_t callback_status = load_context->callback(index, status, buffer, buffer_length, load_context->user_data);
+
+    if (callback_status != SAIL_OK) {
+        load_context->stop   = true;
+        load_context->status = callback_status;
+    }
+}
+
+static sail_status_t open_file(const char *path, int *fd, size_t *size) {
+
+    const int fd_local = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd_local < 0) {
+        SAIL_LOG_ERROR("Failed to open '%s': %s", path, strerror(errno));
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_OPEN_FILE);
+    }
+
+    struct stat attrs;
+
+    if (fstat(fd_local, &attrs) != 0 || !S_ISREG(attrs.st_mode) || (unsigned long long)attrs.st_size > SIZE_MAX) {
+        SAIL_LOG_ERROR("'%s' is not a regular file", path);
+        close(fd_local);
+        SAIL_LOG_AND_RETURN(SAIL_ERROR_OPEN_FILE);
+    }
+
+    *fd   = fd_local;
+    *size = (size_t)attrs.st_size;
+
+    return SAIL_OK;
+}
+
+/*
+ * Reads the whole file with pread(). The buffer MUST be able to hold 'size' bytes.
+ */
+static sail_status_t pread_file(int fd, void *buffer, size_t size) {
+
+    size_t done = 0;
+
+    while (done < size) {
+        const ssize_t result = pread(fd, (char *)buffer + done, size - done, (off_t)done);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            sail_print_errno("Failed to read the file: %s");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_FILE);
+        }
+
+        /* The file has been truncated in the meantime. */
+        if (result == 0) {
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_FILE);
+        }
+
+        done += (size_t)result;
+    }
+
+    return SAIL_OK;
+}
+
+static sail_status_t load_file(const char *path, void **buffer, size_t *size) {
+
+    int fd;
+    size_t size_local;
+    SAIL_TRY(open_file(path, &fd, &size_local));
+
+    void *ptr;
+    /* sail_malloc() doesn't accept zero sizes. */
+    SAIL_TRY_OR_CLEANUP(sail_malloc(size_local > 0 ? size_local : 1, &ptr),
+                        /* cleanup */ close(fd));
+
+    SAIL_TRY_OR_CLEANUP(pread_file(fd, ptr, size_local),
+                        /* cleanup */ close(fd),
+                                      sail_free(ptr));
+
+    close(fd);
+
+    *buffer = ptr;
+    *size   = size_local;
+
+    return SAIL_OK;
+}
+
+/*
+ * Thread pool.
+ */
+
+struct loaded_file {
+
+    size_t index;
+    sail_status_t status;
+    void *buffer;
+    size_t size;
+
+    struct loaded_file *next;
+};
+
+struct pool {
+
+    struct load_context *load_context;
+
+    pthread_mutex_t mutex;
+
+    /* Signaled when a file is loaded, a worker finishes, or in-flight bytes are freed. */
+    pthread_cond_t cond;
+
+    /* The index of the next file to load. */
+    size_t next;
+
+    size_t in_flight_bytes;
+
+    /* Loaded files not yet passed to the callback. */
+    struct loaded_file *loaded_first;
+    struct loaded_file *loaded_last;
+
+    unsigned running_workers;
+
+    /* Set when the callback stops loading or a worker fails to allocate memory. */
+    bool stop;
+    sail_status_t status;
+};
+
+static void push_loaded_file(struct pool *pool, struct loaded_file *loaded_file) {
+
+    loaded_file->next = NULL;
+
+    if (pool->loaded_last == NULL) {
+        pool->loaded_first = loaded_file;
+    } else {
+        pool->loaded_last->next = loaded_file;
+    }
+
+    pool->loaded_last = loaded_file;
+}
+
+static void* pool_worker(void *arg) {
+
+    struct pool *pool = arg;
+    const struct load_context *load_context = pool->load_context;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (!pool->stop && pool->next < load_context->paths_length) {
+        const size_t index = pool->next++;
+        pthread_mutex_unlock(&pool->mutex);
+
+        void *ptr;
+        sail_status_t status = sail_malloc(sizeof(struct loaded_file), &ptr);
+
+        if (status != SAIL_OK) {
+            pthread_mutex_lock(&pool->mutex);
+            pool->stop   = true;
+            pool->status = status;
+            break;
+        }
+
+        struct loaded_file *loaded_file = ptr;
+        loaded_file->index  = index;
+        loaded_file->buffer = NULL;
+        loaded_file->size   = 0;
+
+        int fd;
+        size_t size = 0;
+        status = open_file(load_context->paths[index], &fd, &size);
+
+        pthread_mutex_lock(&pool->mutex);
+
+        if (status == SAIL_OK) {
+            /* Wait for other files to be consumed if the limit is exceeded. */
+            while (!pool->stop && pool->in_flight_bytes > 0 && pool->in_flight_bytes + size > load_context->max_in_flight_bytes) {
+                pthread_cond_wait(&pool->cond, &pool->mutex);
+            }
+
+            if (pool->stop) {
+                close(fd);
+                sail_free(loaded_file);
+                break;
+            }
+
+            pool->in_flight_bytes += size;
+            pthread_mutex_unlock(&pool->mutex);
+
+            status = sail_malloc(size > 0 ? size : 1, &loaded_file->buffer);
+
+            if (status == SAIL_OK) {
+                status = pread_file(fd, loaded_file->buffer, size);
+            }
+
+            close(fd);
+
+            /* Failed files don't hold memory, but in-flight bytes are returned by the consumer. */
+            if (status != SAIL_OK) {
+                sail_free(loaded_file->buffer);
+                loaded_file->buffer = NULL;
+            }
+
+            loaded_file->size = size;
+
+            pthread_mutex_lock(&pool->mutex);
+        }
+
+        loaded_file->status = status;
+        push_loaded_file(pool, loaded_file);
+        pthread_cond_broadcast(&pool->cond);
+    }
+
+    pool->running_workers--;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static void consume_loaded_files(struct pool *pool) {
+
+    struct load_context *load_context = pool->load_context;
+
+    pthread_mutex_lock(&pool->mutex);
+
+    for (;;) {
+        while (pool->loaded_first == NULL && pool->running_workers > 0) {
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+        }
+
+        struct loaded_file *loaded_file = pool->loaded_first;
+
+        if (loaded_file == NULL) {
+            break;
+        }
+
+        pool->loaded_first = loaded_file->next;
+
+        if (pool->loaded_first == NULL) {
+            pool->loaded_last = NULL;
+        }
+
+        pthread_mutex_unlock(&pool->mutex);
+
+        deliver(load_context,
+                loaded_file->index,
+                loaded_file->status,
+                loaded_file->status == SAIL_OK ? loaded_file->buffer : NULL,
+                loaded_file->status == SAIL_OK ? loaded_file->size : 0);
+
+        const size_t size = loaded_file->size;
+        sail_free(loaded_file->buffer);
+        sail_free(loaded_file);
+
+        pthread_mutex_lock(&pool->mutex);
+
+        pool->in_flight_bytes -= size;
+        pool->stop = pool->stop || load_context->stop;
+        pthread_cond_broadcast(&pool->cond);
+    }
+
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static void load_files_sequentially(struct load_context *load_context) {
+
+    for (size_t i = 0; i < load_context->paths_length && !load_context->stop; i++) {
+        void *buffer = NULL;
+        size_t size = 0;
+
+        const sail_status_t status = load_file(load_context->paths[i], &buffer, &size);
+
+        deliver(load_context, i, status, buffer, size);
+        sail_free(buffer);
+    }
+}
+
+static sail_status_t load_files_with_thread_pool(struct load_context *load_context) {
+
+    unsigned threads = load_context->queue_depth;
+
+    if (threads > load_context->paths_length) {
+        threads = (unsigned)load_context->paths_length;
+    }
+    if (threads > SAIL_MAX_THREADS) {
+        threads = SAIL_MAX_THREADS;
+    }
+
+    if (threads <= 1) {
+        load_files_sequentially(load_context);
+        return SAIL_OK;
+    }
+
+    struct pool pool;
+    pool.load_context    = load_context;
+    pool.next            = 0;
+    pool.in_flight_bytes = 0;
+    pool.loaded_first    = NULL;
+    pool.loaded_last     = NULL;
+    pool.running_workers = 0;
+    pool.stop            = false;
+    pool.status          = SAIL_OK;
+
+    if (pthread_mutex_init(&pool.mutex, NULL) != 0) {
+        load_files_sequentially(load_context);
+        return SAIL_OK;
+    }
+
+    if (pthread_cond_init(&pool.cond, NULL) != 0) {
+        pthread_mutex_destroy(&pool.mutex);
+        load_files_sequentially(load_context);
+        return SAIL_OK;
+    }
+
+    pthread_t thread_handles[SAIL_MAX_THREADS];
+    unsigned started = 0;
+
+    pthread_mutex_lock(&pool.mutex);
+
+    for (unsigned i = 0; i < threads; i++) {
+        if (pthread_create(&thread_handles[started], NULL, pool_worker, &pool) == 0) {
+            started++;
+        }
+    }
+
+    pool.running_workers = started;
+    pthread_mutex_unlock(&pool.mutex);
+
+    consume_loaded_files(&pool);
+
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(thread_handles[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool.cond);
+    pthread_mutex_destroy(&pool.mutex);
+
+    if (started == 0) {
+        load_files_sequentially(load_context);
+    } else if (pool.status != SAIL_OK && !load_context->stop) {
+        SAIL_LOG_AND_RETURN(pool.status);
+    }
+
+    return SAIL_OK;
+}
+
+#ifdef SAIL_HAVE_IO_URING
+
+/*
+ * io_uring. liburing is not required, the rings are set up with raw system calls.
+ */
+
+/* user_data of cancellation requests. Reads use slot indexes. */
+static const uint64_t CANCEL_USER_DATA = UINT64_MAX;
+
+struct uring {
+
+    int fd;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    void *cq_ring;
+    size_t cq_ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    /* Queued submission entries not yet consumed by the kernel. */
+    unsigned to_submit;
+};
+
+struct uring_slot {
+
+    bool busy;
+
+    size_t index;
+    int fd;
+    void *buffer;
+    size_t size;
+
+    /* The number of bytes read so far. */
+    size_t done;
+
+    struct iovec iovec;
+};
+
+static void uring_destroy(struct uring *uring) {
+
+    munmap(uring->sqes, uring->sqes_size);
+
+    if (uring->cq_ring != uring->sq_ring) {
+        munmap(uring->cq_ring, uring->cq_ring_size);
+    }
+
+    munmap(uring->sq_ring, uring->sq_ring_size);
+    close(uring->fd);
+}
+
+/*
+ * Fails without logging errors when io_uring is not available, for example, when the kernel is older than 5.1
+ * or io_uring is disabled, so the caller can fall back to the thread pool.
+ */
+static sail_status_t uring_init(unsigned entries, struct uring *uring) {
+
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    const int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+
+    if (fd < 0) {
+        return SAIL_ERROR_NOT_IMPLEMENTED;
+    }
+
+    uring->fd           = fd;
+    uring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    uring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    uring->sqes_size    = params.sq_entries * sizeof(struct io_uring_sqe);
+    uring->to_submit    = 0;
+
+    /* Both rings can be mapped at once since Linux 5.4. */
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+    if (single_mmap && uring->cq_ring_size > uring->sq_ring_size) {
+        uring->sq_ring_size = uring->cq_ring_size;
+    }
+
+    uring->sq_ring = mmap(NULL, uring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_SQ_RING);
+
+    if (uring->sq_ring == MAP_FAILED) {
+        close(fd);
+        return SAIL_ERROR_NOT_IMPLEMENTED;
+    }
+
+    if (single_mmap) {
+        uring->cq_ring = uring->sq_ring;
+    } else {
+        uring->cq_ring = mmap(NULL, uring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_CQ_RING);
+
+        if (uring->cq_ring == MAP_FAILED) {
+            munmap(uring->sq_ring, uring->sq_ring_size);
+            close(fd);
+            return SAIL_ERROR_NOT_IMPLEMENTED;
+        }
+    }
+
+    uring->sqes = mmap(NULL, uring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, IORING_OFF_SQES);
+
+    if (uring->sqes == MAP_FAILED) {
+        if (!single_mmap) {
+            munmap(uring->cq_ring, uring->cq_ring_size);
+        }
+        munmap(uring->sq_ring, uring->sq_ring_size);
+        close(fd);
+        return SAIL_ERROR_NOT_IMPLEMENTED;
+    }
+
+    unsigned char *sq_ring = uring->sq_ring;
+    unsigned char *cq_ring = uring->cq_ring;
+
+    uring->sq_tail  = (unsigned *)(sq_ring + params.sq_off.tail);
+    uring->sq_mask  = (unsigned *)(sq_ring + params.sq_off.ring_mask);
+    uring->sq_array = (unsigned *)(sq_ring + params.sq_off.array);
+
+    uring->cq_head = (unsigned *)(cq_ring + params.cq_off.head);
+    uring->cq_tail = (unsigned *)(cq_ring + params.cq_off.tail);
+    uring->cq_mask = (unsigned *)(cq_ring + params.cq_off.ring_mask);
+    uring->cqes    = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+
+    return SAIL_OK;
+}
+
+/*
+ * Queues reading the rest of the file into the slot. The submission queue never overflows
+ * as it has at least as many entries as there are slots, and every slot has one read in flight at most.
+ */
+static void uring_queue_read(struct uring *uring, struct uring_slot *slot, unsigned slot_index) {
+
+    /* Only this thread writes the tail. */
+    const unsigned tail = *uring->sq_tail;
+    const unsigned entry_index = tail & *uring->sq_mask;
+
+    slot->iovec.iov_base = (char *)slot->buffer + slot->done;
+    slot->iovec.iov_len  = slot->size - slot->done;
+
+    struct io_uring_sqe *sqe = &uring->sqes[entry_index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode    = IORING_OP_READV;
+    sqe->fd        = slot->fd;
+    sqe->addr      = (uint64_t)(uintptr_t)&slot->iovec;
+    sqe->len       = 1;
+    sqe->off       = slot->done;
+    sqe->user_data = slot_index;
+
+    uring->sq_array[entry_index] = entry_index;
+
+    /* Publish the entry to the kernel. */
+    __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    uring->to_submit++;
+}
+
+/*
+ * Submits the queued reads and waits for at least one of them to complete.
+ */
+static sail_status_t uring_submit_and_wait(struct uring *uring) {
+
+    for (;;) {
+        const int result = (int)syscall(__NR_io_uring_enter, uring->fd, uring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if (result >= 0) {
+            uring->to_submit -= (unsigned)result;
+            return SAIL_OK;
+        }
+
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            sail_print_errno("Failed to submit reads to io_uring: %s");
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_READ_FILE);
+        }
+    }
+}
+
+/*
+ * Finishes the slot: passes its file to the callback and frees its resources.
+ */
+static void uring_finish_slot(struct load_context *load_context, struct uring_slot *slot, sail_status_t status,
+                              size_t *in_flight_bytes, unsigned *active_slots) {
+
+    close(slot->fd);
+
+    deliver(load_context, slot->index, status, status == SAIL_OK ? slot->buffer : NULL, status == SAIL_OK ? slot->size : 0);
+
+    sail_free(slot->buffer);
+    slot->buffer = NULL;
+    slot->busy   = false;
+
+    *in_flight_bytes -= slot->size;
+    (*active_slots)--;
+}
+
+/*
+ * Cancels the reads of the busy slots and waits until the kernel completes all of them,
+ * so it doesn't write into their buffers anymore. Closing the ring doesn't wait for the reads
+ * already passed to kernel workers. Every busy slot has exactly one read queued or in flight.
+ *
+ * Returns false if the ring fails, so the reads may still be in flight.
+ */
+static bool uring_cancel_slots(struct uring *uring, struct uring_slot *slots, unsigned slots_length) {
+
+    unsigned reads_in_flight = 0;
+
+    for (unsigned i = 0; i < slots_length; i++) {
+        if (!slots[i].busy) {
+            continue;
+        }
+
+        /* The ring has room for a cancellation request per read. */
+        const unsigned tail = *uring->sq_tail;
+        const unsigned entry_index = tail & *uring->sq_mask;
+
+        struct io_uring_sqe *sqe = &uring->sqes[entry_index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->fd        = -1;
+        sqe->addr      = i;
+        sqe->user_data = CANCEL_USER_DATA;
+
+        uring->sq_array[entry_index] = entry_index;
+        __atomic_store_n(uring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        uring->to_submit++;
+        reads_in_flight++;
+    }
+
+    /*
+     * Kernels older than 5.5 fail the cancellation requests, and cancelled reads
+     * may complete anyway. Either way, every read posts a completion.
+     */
+    while (reads_in_flight > 0) {
+        const int result = (int)syscall(__NR_io_uring_enter, uring->fd, uring->to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+
+        if (result < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+
+            sail_print_errno("Failed to cancel io_uring reads: %s");
+            return false;
+        }
+
+        uring->to_submit = ((unsigned)result > uring->to_submit) ? 0 : uring->to_submit - (unsigned)result;
+
+        unsigned head = *uring->cq_head;
+        const unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++) {
+            if (uring->cqes[head & *uring->cq_mask].user_data != CANCEL_USER_DATA) {
+                reads_in_flight--;
+            }
+        }
+
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    return true;
+}
+
+/*
+ * Cancels the reads of the busy slots, closes their files, and frees their buffers and the slots themselves.
+ * If the reads cannot be cancelled, the buffers and the slots are leaked as the kernel may still write into them.
+ */
+static void uring_destroy_slots(struct uring *uring, struct uring_slot *slots, unsigned slots_length) {
+
+    const bool cancelled = uring_cancel_slots(uring, slots, slots_length);
+
+    for (unsigned i = 0; i < slots_length; i++) {
+        if (slots[i].busy) {
+            close(slots[i].fd);
+
+            if (cancelled) {
+                sail_free(slots[i].buffer);
+            }
+        }
+    }
+
+    if (cancelled) {
+        sail_free(slots);
+    } else {
+        SAIL_LOG_ERROR("Leaking the buffers of io_uring reads that may still be in flight");
+    }
+}
+
+static sail_status_t load_files_with_uring(struct load_context *load_context, struct uring *uring, struct uring_slot *slots) {
+
+    size_t next = 0;
+    size_t in_flight_bytes = 0;
+    unsigned active_slots = 0;
+
+    /* A file opened but waiting for in-flight bytes to be freed. */
+    bool pending = false;
+    size_t pending_index = 0;
+    int pending_fd = -1;
+    size_t pending_size = 0;
+
+    for (;;) {
+        /* Fill free slots. */
+        while (!load_context->stop && active_slots < load_context->queue_depth) {
+            if (!pending) {
+                if (next == load_context->paths_length) {
+                    break;
+                }
+
+                const size_t index = next++;
+                const sail_status_t status = open_file(load_context->paths[index], &pending_fd, &pending_size);
+
+                if (status != SAIL_OK) {
+                    deliver(load_context, index, status, NULL, 0);
+                    continue;
+                }
+
+                pending       = true;
+                pending_index = index;
+            }
+
+            if (in_flight_bytes > 0 && in_flight_bytes + pending_size > load_context->max_in_flight_bytes) {
+                break;
+            }
+
+            void *buffer = NULL;
+            const sail_status_t status = sail_malloc(pending_size > 0 ? pending_size : 1, &buffer);
+
+            /* Empty files need no reads. */
+            if (status != SAIL_OK || pending_size == 0) {
+                close(pending_fd);
+                deliver(load_context, pending_index, status, buffer, 0);
+                sail_free(buffer);
+                pending = false;
+                continue;
+            }
+
+            unsigned slot_index = 0;
+            while (slots[slot_index].busy) {
+                slot_index++;
+            }
+
+            struct uring_slot *slot = &slots[slot_index];
+            slot->busy   = true;
+            slot->index  = pending_index;
+            slot->fd     = pending_fd;
+            slot->buffer = buffer;
+            slot->size   = pending_size;
+            slot->done   = 0;
+
+            uring_queue_read(uring, slot, slot_index);
+
+            in_flight_bytes += pending_size;
+            active_slots++;
+            pending = false;
+        }
+
+        if (pending && load_context->stop) {
+            close(pending_fd);
+            pending = false;
+        }
+
+        if (active_slots == 0) {
+            break;
+        }
+
+        const sail_status_t status = uring_submit_and_wait(uring);
+
+        if (status != SAIL_OK) {
+            if (pending) {
+                close(pending_fd);
+            }
+
+            return status;
+        }
+
+        /* Reap completions. Only this thread writes the head. */
+        unsigned head = *uring->cq_head;
+        const unsigned tail = __atomic_load_n(uring->cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; head++) {
+            const struct io_uring_cqe *cqe = &uring->cqes[head & *uring->cq_mask];
+            struct uring_slot *slot = &slots[cqe->user_data];
+            const int result = cqe->res;
+
+            if (result == -EINTR || result == -EAGAIN) {
+                uring_queue_read(uring, slot, (unsigned)cqe->user_data);
+            } else if (result < 0) {
+                SAIL_LOG_ERROR("Failed to read '%s': %s", load_context->paths[slot->index], strerror(-result));
+                uring_finish_slot(load_context, slot, SAIL_ERROR_READ_FILE, &in_flight_bytes, &active_slots);
+            } else if (result == 0) {
+                /* The file has been truncated in the meantime. */
+                SAIL_LOG_ERROR("Failed to read '%s': unexpected end of file", load_context->paths[slot->index]);
+                uring_finish_slot(load_context, slot, SAIL_ERROR_READ_FILE, &in_flight_bytes, &active_slots);
+            } else {
+                slot->done += (size_t)result;
+
+                if (slot->done < slot->size) {
+                    uring_queue_read(uring, slot, (unsigned)cqe->user_data);
+                } else {
+                    uring_finish_slot(load_context, slot, SAIL_OK, &in_flight_bytes, &active_slots);
+                }
+            }
+        }
+
+        __atomic_store_n(uring->cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    return SAIL_OK;
+}
+
+/*
+ * Returns SAIL_ERROR_NOT_IMPLEMENTED without logging errors when io_uring is not available.
+ */
+static sail_status_t load_files_with_io_uring(struct load_context *load_context) {
+
+    /* Room for a read and its cancellation request per slot. */
+    struct uring uring;
+    SAIL_TRY(uring_init(load_context->queue_depth * 2, &uring));
+
+    SAIL_LOG_DEBUG("Loading %lu file(s) with io_uring, queue depth: %u", (unsigned long)load_context->paths_length, load_context->queue_depth);
+
+    void *ptr;
+    SAIL_TRY_OR_CLEANUP(sail_malloc(sizeof(struct uring_slot) * load_context->queue_depth, &ptr),
+                        /* cleanup */ uring_destroy(&uring));
+    struct uring_slot *slots = ptr;
+
+    for (unsigned i = 0; i < load_context->queue_depth; i++) {
+        slots[i].busy = false;
+    }
+
+    SAIL_TRY_OR_CLEANUP(load_files_with_uring(load_context, &uring, slots),
+                        /* cleanup */ uring_destroy_slots(&uring, slots, load_context->queue_depth),
+                                      uring_destroy(&uring));
+
+    sail_free(slots);
+    uring_destroy(&uring);
+
+    return SAIL_OK;
+}
+
+#endif /* SAIL_HAVE_IO_URING */
+
+#endif /* SAIL_WIN32 */
+
+/*
+ * Public functions.
+ */
+
+sail_status_t sail_load_files(const char * const *paths, size_t paths_length,
+                              const struct sail_load_files_options *options,
+                              sail_load_file_callback_t callback, void *user_data) {
+
+    SAIL_CHECK_PTR(paths);
+    SAIL_CHECK_PTR(callback);
+
+#ifdef SAIL_WIN32
+    (void)paths_length;
+    (void)options;
+    (void)user_data;
+
+    SAIL_LOG_AND_RETURN(SAIL_ERROR_NOT_IMPLEMENTED);
+#else
+    for (size_t i = 0; i < paths_length; i++) {
+        SAIL_CHECK_PATH_PTR(paths[i]);
+    }
+
+    struct load_context load_context;
+    load_context.paths               = paths;
+    load_context.paths_length        = paths_length;
+    load_context.queue_depth         = (options == NULL || options->queue_depth == 0) ? DEFAULT_QUEUE_DEPTH : options->queue_depth;
+    load_context.max_in_flight_bytes = (options == NULL || options->max_in_flight_bytes == 0) ? DEFAULT_MAX_IN_FLIGHT_BYTES : options->max_in_flight_bytes;
+    load_context.callback            = callback;
+    load_context.user_data           = user_data;
+    load_context.stop                = false;
+    load_context.status              = SAIL_OK;
+
+    if (load_context.queue_depth > MAX_QUEUE_DEPTH) {
+        load_context.queue_depth = MAX_QUEUE_DEPTH;
+    }
+
+    if (paths_length == 0) {
+        return SAIL_OK;
+    }
+
+#ifdef SAIL_HAVE_IO_URING
+    const bool use_io_uring = options == NULL || (options->options & SAIL_LOAD_FILES_OPTION_NO_IO_URING) == 0;
+
+    if (use_io_uring) {
+        const sail_status_t status = load_files_with_io_uring(&load_context);
+
+        if (status == SAIL_OK) {
+            SAIL_TRY(load_context.status);
+            return SAIL_OK;
+        } else if (status != SAIL_ERROR_NOT_IMPLEMENTED) {
+            return status;
+        }
+
+        SAIL_LOG_DEBUG("io_uring is not available, falling back to threads");
+    }
+#endif
+
+    SAIL_TRY(load_files_with_thread_pool(&load_context));
+    SAIL_TRY(load_context.status);
+
+    return SAIL_OK;
+#endif
+}
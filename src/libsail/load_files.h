@@ -0,0 +1,108 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_LOAD_FILES_H
+#define SAIL_LOAD_FILES_H
+
+#include <stddef.h>
+
+#ifdef SAIL_BUILD
+    #include "error.h"
+    #include "export.h"
+#else
+    #include <sail-common/error.h>
+    #include <sail-common/export.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Options to load files with sail_load_files().
+ */
+enum SailLoadFilesOption {
+
+    /* Read with the thread pool even if io_uring is available. */
+    SAIL_LOAD_FILES_OPTION_NO_IO_URING = 1 << 0,
+};
+
+/*
+ * Options to load files with sail_load_files(). Zero-initialized options mean defaults.
+ */
+struct sail_load_files_options {
+
+    /*
+     * The maximum number of files read at the same time. This is the io_uring queue depth,
+     * or the number of threads when io_uring is not available. 0 means 32.
+     */
+    unsigned queue_depth;
+
+    /*
+     * The maximum number of bytes of files being read or loaded but not yet passed to the callback.
+     * Files larger than this limit are still loaded one at a time. 0 means 64 MiB.
+     */
+    size_t max_in_flight_bytes;
+
+    /* Or-ed SailLoadFilesOption values. */
+    int options;
+};
+
+typedef struct sail_load_files_options sail_load_files_options_t;
+
+/*
+ * Called by sail_load_files() for every file. 'index' is the index of the file in the list of paths.
+ * 'status' is SAIL_OK if the file contents are loaded into 'buffer'. Otherwise, 'status' is the error
+ * and 'buffer' is NULL. The buffer is valid until the callback returns. Pass it to sail_read_mem()
+ * or sail_start_reading_mem() to decode the file.
+ *
+ * Returning an error stops loading. No more files are passed to the callback.
+ */
+typedef sail_status_t (*sail_load_file_callback_t)(size_t index, sail_status_t status,
+                                                    const void *buffer, size_t buffer_length, void *user_data);
+
+/*
+ * Loads the specified files into memory and passes them to the callback one by one in the calling thread
+ * in the order they are loaded, which is not necessarily the order of the paths. Reads are issued
+ * with io_uring on Linux. If io_uring is not available, the files are read with a pool of threads.
+ * Pass NULL options to use defaults.
+ *
+ * Loading is not implemented on Windows.
+ *
+ * Typical usage: This is a standalone function that could be called at any time.
+ *
+ * Returns SAIL_OK on success.
+ * Returns the error returned by the callback if it stops loading.
+ */
+SAIL_EXPORT sail_status_t sail_load_files(const char * const *paths, size_t paths_length,
+                                          const struct sail_load_files_options *options,
+                                          sail_load_file_callback_t callback, void *user_data);
+
+/* extern "C" */
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -39,9 +39,12 @@
     #include "context.h"
     #include "context_private.h"
     #include "ini.h"
+    #include "io_fd.h"
     #include "io_file.h"
     #include "io_mem.h"
+    #include "io_mmap.h"
     #include "io_noop.h"
+    #include "load_files.h"
     #include "sail_advanced.h"
     #include "sail_deep_diver.h"
     #include "sail_junior.h"
@@ -55,6 +58,8 @@
     #include <sail/codec_info.h>
     #include <sail/codec_info_node.h>
     #include <sail/context.h>
+    #include <sail/io_fd.h>
+    #include <sail/load_files.h>
     #include <sail/sail_advanced.h>
     #include <sail/sail_deep_diver.h>
     #include <sail/sail_junior.h>
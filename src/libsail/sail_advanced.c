@@ -28,6 +28,7 @@
 #include <stdlib.h>
 
 #include "sail-common.h"
+#include "sail-manip.h"
 #include "sail.h"
 
 sail_status_t sail_probe_io(struct sail_io *io, struct sail_image **image, const struct sail_codec_info **codec_info) {
@@ -116,8 +117,37 @@ sail_status_t sail_read_next_frame(void *state, struct sail_image **image) {
         interlaced_passes = 1;
     }
 
-    /* Allocate pixels. */
-    const unsigned pixels_size = image_local->height * image_local->bytes_per_line;
+    /*
+     * Convert in the same pixel buffer after reading the frame when requested. The buffer is large enough
+     * for both the codec and the requested pixel formats.
+     */
+    const bool convert = state_of_mind->output_pixel_format != SAIL_PIXEL_FORMAT_UNKNOWN
+                            && state_of_mind->output_pixel_format != image_local->pixel_format;
+    unsigned output_bytes_per_line = image_local->bytes_per_line;
+
+    if (convert) {
+        if (!sail_can_convert(image_local->pixel_format, state_of_mind->output_pixel_format)) {
+            SAIL_LOG_ERROR("Reading cannot convert %s to %s",
+                            sail_pixel_format_to_string(image_local->pixel_format),
+                            sail_pixel_format_to_string(state_of_mind->output_pixel_format));
+            sail_destroy_image(image_local);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        }
+
+        SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, state_of_mind->output_pixel_format, &output_bytes_per_line),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
+    /* Allocate pixels. Planar pixel formats are converted into a separate buffer. */
+    size_t pixels_size;
+    SAIL_TRY_OR_CLEANUP(sail_image_pixels_size(image_local, &pixels_size),
+                        /* cleanup */ sail_destroy_image(image_local));
+
+    if (convert && !sail_is_planar(image_local->pixel_format) && !sail_is_planar(state_of_mind->output_pixel_format)) {
+        const size_t output_pixels_size = (size_t)image_local->height * output_bytes_per_line;
+        pixels_size = (output_pixels_size > pixels_size) ? output_pixels_size : pixels_size;
+    }
+
     SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_local->pixels),
                         /* cleanup */ sail_destroy_image(image_local));
 
@@ -128,6 +158,19 @@ sail_status_t sail_read_next_frame(void *state, struct sail_image **image) {
                             /* cleanup */ sail_destroy_image(image_local));
     }
 
+    if (convert) {
+        SAIL_TRY_OR_CLEANUP(convert_frame_in_place(image_local,
+                                                   state_of_mind->output_pixel_format,
+                                                   output_bytes_per_line,
+                                                   state_of_mind->conversion_options),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
+    if (state_of_mind->auto_orient) {
+        SAIL_TRY_OR_CLEANUP(sail_auto_orient_image(image_local),
+                            /* cleanup */ sail_destroy_image(image_local));
+    }
+
     *image = image_local;
 
     return SAIL_OK;
@@ -170,17 +213,15 @@ sail_status_t sail_start_writing_mem(void *buffer, size_t buffer_length, const s
     return SAIL_OK;
 }
 
-sail_status_t sail_write_next_frame(void *state, const struct sail_image *image) {
+sail_status_t sail_start_writing_growing_mem(size_t initial_size, const struct sail_codec_info *codec_info,
+                                            void **buffer, void **state) {
 
-    SAIL_CHECK_STATE_PTR(state);
-    SAIL_CHECK_IMAGE_PTR(image);
+    SAIL_TRY(sail_start_writing_growing_mem_with_options(initial_size, codec_info, NULL, buffer, state));
 
-    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+    return SAIL_OK;
+}
 
-    SAIL_TRY(sail_check_io_valid(state_of_mind->io));
-    SAIL_CHECK_STATE_PTR(state_of_mind->state);
-    SAIL_CHECK_CODEC_INFO_PTR(state_of_mind->codec_info);
-    SAIL_CHECK_CODEC_PTR(state_of_mind->codec);
+static sail_status_t write_next_frame(struct hidden_state *state_of_mind, const struct sail_image *image) {
 
     /* Check if we actually able to write the requested pixel format. */
     SAIL_TRY(allowed_write_output_pixel_format(state_of_mind->codec_info->write_features,
@@ -214,6 +255,30 @@ sail_status_t sail_write_next_frame(void *state, const struct sail_image *image)
     return SAIL_OK;
 }
 
+sail_status_t sail_write_next_frame(void *state, const struct sail_image *image) {
+
+    SAIL_CHECK_STATE_PTR(state);
+    SAIL_CHECK_IMAGE_PTR(image);
+
+    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+
+    SAIL_TRY(sail_check_io_valid(state_of_mind->io));
+    SAIL_CHECK_STATE_PTR(state_of_mind->state);
+    SAIL_CHECK_CODEC_INFO_PTR(state_of_mind->codec_info);
+    SAIL_CHECK_CODEC_PTR(state_of_mind->codec);
+
+    /* Premultiplied alpha is written as straight alpha if the codec supports only the latter. */
+    struct sail_image *image_unpremultiplied;
+    SAIL_TRY(unpremultiply_for_writing(state_of_mind->codec_info->write_features, image, &image_unpremultiplied));
+
+    SAIL_TRY_OR_CLEANUP(write_next_frame(state_of_mind, image_unpremultiplied == NULL ? image : image_unpremultiplied),
+                        /* cleanup */ sail_destroy_image(image_unpremultiplied));
+
+    sail_destroy_image(image_unpremultiplied);
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_stop_writing(void *state) {
 
     SAIL_TRY(stop_writing(state, NULL));
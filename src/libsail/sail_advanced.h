@@ -109,6 +109,10 @@ SAIL_EXPORT sail_status_t sail_start_reading_mem(const void *buffer, size_t buff
  * Continues reading the file started by sail_start_reading_file() and brothers. The assigned image
  * MUST be destroyed later with sail_image_destroy().
  *
+ * If the read options passed to sail_start_reading_file_with_options() and brothers request
+ * an output pixel format, the frame is converted to it after the codec reads it. See sail_read_options.
+ * If they have SAIL_IO_OPTION_AUTO_ORIENT, the frame is then oriented with sail_auto_orient_image().
+ *
  * Returns SAIL_OK on success.
  * Returns SAIL_ERROR_NO_MORE_FRAMES when no more frames are available.
  */
@@ -163,13 +167,40 @@ SAIL_EXPORT sail_status_t sail_start_writing_file(const char *path, const struct
 SAIL_EXPORT sail_status_t sail_start_writing_mem(void *buffer, size_t buffer_length,
                                                 const struct sail_codec_info *codec_info, void **state);
 
+/*
+ * Starts writing into a memory buffer allocated by SAIL. The buffer grows as needed, so there is
+ * no need to guess its size beforehand. Pass a non-zero initial size if you know the approximate
+ * size of the encoded image to avoid reallocations.
+ *
+ * When writing is stopped with sail_stop_writing() or sail_stop_writing_with_written(),
+ * the buffer is assigned to the 'buffer' argument. It's assigned even if writing fails.
+ * The caller becomes the owner of the buffer and MUST free it with sail_free().
+ * NULL is assigned if nothing was written. The 'buffer' argument MUST remain valid until then.
+ *
+ * Typical usage: sail_codec_info_from_extension()  ->
+ *                sail_start_writing_growing_mem()  ->
+ *                sail_write_next_frame()           ->
+ *                sail_stop_writing_with_written()  ->
+ *                sail_free(buffer).
+ *
+ * STATE explanation: Passes the address of a local void* pointer. SAIL will store an internal state
+ * in it and destroy it in sail_stop_writing. States must be used per image. DO NOT use the same state
+ * to start writing multiple images at the same time.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_start_writing_growing_mem(size_t initial_size, const struct sail_codec_info *codec_info,
+                                                        void **buffer, void **state);
+
 /*
  * Continues writing started by sail_start_writing_file() and brothers. Writes the specified
  * image into the underlying I/O target.
  *
  * If the selected image format doesn't support the image pixel format, an error is returned.
  * Consider converting the image into a supported image format beforehand with functions
- * from sail-manip.
+ * from sail-manip. The only exception is premultiplied alpha. Images with premultiplied alpha
+ * (like BPP32-RGBA-PREMULTIPLIED) are unpremultiplied into a temporary image automatically
+ * if the image format supports the straight alpha counterpart (like BPP32-RGBA).
  *
  * Returns SAIL_OK on success.
  */
@@ -28,6 +28,7 @@
 #include <stdlib.h>
 
 #include "sail-common.h"
+#include "sail-manip.h"
 #include "sail.h"
 
 sail_status_t sail_start_reading_file_with_options(const char *path, const struct sail_codec_info *codec_info,
@@ -73,6 +74,27 @@ sail_status_t sail_start_reading_mem_with_options(const void *buffer, size_t buf
     return SAIL_OK;
 }
 
+sail_status_t sail_set_reading_conversion_options(void *state, const struct sail_conversion_options *conversion_options) {
+
+    SAIL_CHECK_STATE_PTR(state);
+    SAIL_CHECK_CONVERSION_OPTIONS_PTR(conversion_options);
+
+    struct hidden_state *state_of_mind = (struct hidden_state *)state;
+
+    if (state_of_mind->conversion_options == NULL) {
+        SAIL_TRY(sail_alloc_conversion_options(&state_of_mind->conversion_options));
+    }
+
+    const enum SailYuvMatrix yuv_matrix = state_of_mind->conversion_options->yuv_matrix;
+    const enum SailYuvRange yuv_range   = state_of_mind->conversion_options->yuv_range;
+
+    *state_of_mind->conversion_options            = *conversion_options;
+    state_of_mind->conversion_options->yuv_matrix = yuv_matrix;
+    state_of_mind->conversion_options->yuv_range  = yuv_range;
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_start_writing_file_with_options(const char *path, const struct sail_codec_info *codec_info,
                                                   const struct sail_write_options *write_options, void **state) {
 
@@ -110,6 +132,22 @@ sail_status_t sail_start_writing_mem_with_options(void *buffer, size_t buffer_le
     return SAIL_OK;
 }
 
+sail_status_t sail_start_writing_growing_mem_with_options(size_t initial_size,
+                                                         const struct sail_codec_info *codec_info,
+                                                         const struct sail_write_options *write_options,
+                                                         void **buffer, void **state) {
+    SAIL_CHECK_BUFFER_PTR(buffer);
+    SAIL_CHECK_CODEC_INFO_PTR(codec_info);
+
+    struct sail_io *io;
+    SAIL_TRY(alloc_io_write_growing_mem(initial_size, buffer, &io));
+
+    /* The I/O object will be destroyed in this function. */
+    SAIL_TRY(start_writing_io_with_options(io, true, codec_info, write_options, state));
+
+    return SAIL_OK;
+}
+
 sail_status_t sail_stop_writing_with_written(void *state, size_t *written) {
 
     SAIL_TRY(stop_writing(state, written));
@@ -42,6 +42,7 @@ extern "C" {
 
 struct sail_io;
 struct sail_codec_info;
+struct sail_conversion_options;
 struct sail_read_options;
 struct sail_write_options;
 
@@ -91,6 +92,22 @@ SAIL_EXPORT sail_status_t sail_start_reading_mem_with_options(const void *buffer
                                                              const struct sail_codec_info *codec_info,
                                                              const struct sail_read_options *read_options, void **state);
 
+/*
+ * Sets the conversion options used to convert every next frame to the output pixel format requested
+ * in the read options. Has no effect if no output pixel format is requested. The options are copied
+ * into the state, so the pointer doesn't have to outlive this call. The YUV matrix and range of the options
+ * are ignored. The ones from the read options are used instead, as codecs may already output them.
+ * Reading starts with default conversion options. See sail_convert_image_with_options().
+ *
+ * Typical usage: sail_start_reading_file_with_options()  ->
+ *                sail_set_reading_conversion_options()   ->
+ *                sail_read_next_frame()                  ->
+ *                sail_stop_reading().
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_set_reading_conversion_options(void *state, const struct sail_conversion_options *conversion_options);
+
 /*
  * Starts writing the specified image file with the specified write options. Pass codec info if you would like
  * to start writing with a specific codec. If not, just pass NULL. If you do not need specific write options,
@@ -138,6 +155,29 @@ SAIL_EXPORT sail_status_t sail_start_writing_mem_with_options(void *buffer, size
                                                              const struct sail_codec_info *codec_info,
                                                              const struct sail_write_options *write_options, void **state);
 
+/*
+ * Starts writing into a memory buffer allocated by SAIL with the specified write options.
+ * If you do not need specific write options, just pass NULL. Codec-specific defaults will be used
+ * in this case. See sail_start_writing_growing_mem() for the buffer ownership rules.
+ *
+ * The write options are deep copied.
+ *
+ * Typical usage: sail_codec_info_from_extension()               ->
+ *                sail_start_writing_growing_mem_with_options()  ->
+ *                sail_write_next_frame()                        ->
+ *                sail_stop_writing_with_written()               ->
+ *                sail_free(buffer).
+ *
+ * STATE explanation: Passes the address of a local void* pointer. SAIL will store an internal state
+ * in it and destroy it in sail_stop_writing. States must be used per image. DO NOT use the same state
+ * to start writing multiple images at the same time.
+ *
+ * Returns SAIL_OK on success.
+ */
+SAIL_EXPORT sail_status_t sail_start_writing_growing_mem_with_options(size_t initial_size,
+                                                                     const struct sail_codec_info *codec_info,
+                                                                     const struct sail_write_options *write_options,
+                                                                     void **buffer, void **state);
 
 /*
  * Stops writing started by sail_start_writing_file() and brothers. Closes the underlying I/O target.
@@ -25,11 +25,16 @@
 
 #include "config.h"
 
+#include <stdint.h>
 #include <string.h>
 
 #include "sail-common.h"
+#include "sail-manip.h"
 #include "sail.h"
 
+/* Size of the scratch buffer to copy input bands into when converting frames in place. */
+static const size_t SCRATCH_SIZE = 2 * 1024 * 1024;
+
 /*
  * Private functions.
  */
@@ -108,6 +113,7 @@ void destroy_hidden_state(struct hidden_state *state) {
     }
 
     sail_destroy_write_options(state->write_options);
+    sail_destroy_conversion_options(state->conversion_options);
 
     /* This state must be freed and zeroed by codecs. We free it just in case to avoid memory leaks. */
     sail_free(state->state);
@@ -115,6 +121,128 @@ void destroy_hidden_state(struct hidden_state *state) {
     sail_free(state);
 }
 
+sail_status_t convert_frame_in_place(struct sail_image *image,
+                                     enum SailPixelFormat output_pixel_format,
+                                     unsigned output_bytes_per_line,
+                                     const struct sail_conversion_options *options) {
+
+    SAIL_CHECK_IMAGE_PTR(image);
+
+    /* Quantizing builds the palette from the whole frame, so the frame is converted into a new one. */
+    if (!sail_can_convert_with_plan(image->pixel_format, output_pixel_format)) {
+        struct sail_image *image_output;
+        SAIL_TRY(sail_convert_image_with_options(image, output_pixel_format, options, &image_output));
+
+        sail_replace_image_pixels(image, image_output->pixels);
+        image_output->pixels = NULL;
+
+        image->pixel_format   = output_pixel_format;
+        image->bytes_per_line = image_output->bytes_per_line;
+
+        sail_destroy_palette(image->palette);
+        image->palette = image_output->palette;
+        image_output->palette = NULL;
+
+        sail_destroy_image(image_output);
+
+        return SAIL_OK;
+    }
+
+    struct sail_conversion_plan *plan;
+    SAIL_TRY(sail_alloc_conversion_plan(image->pixel_format, image->palette, output_pixel_format, options, &plan));
+
+    /* The input palette is expanded into the plan, so it's replaced only after converting. */
+    struct sail_palette *palette = NULL;
+
+    if (sail_is_indexed(output_pixel_format)) {
+        SAIL_TRY_OR_CLEANUP(sail_alloc_conversion_palette(output_pixel_format, &palette),
+                            /* cleanup */ sail_destroy_conversion_plan(plan));
+    }
+
+    if (sail_is_planar(image->pixel_format) || sail_is_planar(output_pixel_format)) {
+        struct sail_image image_output = *image;
+        image_output.pixel_format   = output_pixel_format;
+        image_output.bytes_per_line = output_bytes_per_line;
+
+        size_t pixels_size;
+        SAIL_TRY_OR_CLEANUP(sail_image_pixels_size(&image_output, &pixels_size),
+                            /* cleanup */ sail_destroy_conversion_plan(plan));
+        SAIL_TRY_OR_CLEANUP(sail_malloc(pixels_size, &image_output.pixels),
+                            /* cleanup */ sail_destroy_conversion_plan(plan));
+
+        SAIL_TRY_OR_CLEANUP(sail_convert_image_with_plan(image, plan, &image_output),
+                            /* cleanup */ sail_free(image_output.pixels),
+                                          sail_destroy_conversion_plan(plan));
+
+        sail_destroy_conversion_plan(plan);
+
+        sail_replace_image_pixels(image, image_output.pixels);
+        image->pixel_format   = output_pixel_format;
+        image->bytes_per_line = output_bytes_per_line;
+
+        /* Planar pixel formats are never indexed. */
+        sail_destroy_palette(image->palette);
+        image->palette = NULL;
+
+        return SAIL_OK;
+    }
+
+    /*
+     * Bands start at multiples of 8 rows, so ordered dithering patterns continue across them.
+     * Every band is converted in a single call, so the plan options may convert it with multiple threads.
+     */
+    const size_t scratch_rows = (SCRATCH_SIZE / image->bytes_per_line) / 8 * 8;
+    const unsigned rows_per_band = (scratch_rows == 0) ? 8 : (scratch_rows < image->height ? (unsigned)scratch_rows : image->height);
+    const unsigned bands = (image->height + rows_per_band - 1) / rows_per_band;
+
+    void *scratch;
+    SAIL_TRY_OR_CLEANUP(sail_malloc((size_t)image->bytes_per_line * rows_per_band, &scratch),
+                        /* cleanup */ sail_destroy_palette(palette),
+                                      sail_destroy_conversion_plan(plan));
+
+    /* Shallow band views. The input band is always copied into the scratch buffer as the output band may overlap it. */
+    struct sail_image input_band = *image;
+    input_band.pixels = scratch;
+
+    struct sail_image output_band = *image;
+    output_band.pixel_format   = output_pixel_format;
+    output_band.bytes_per_line = output_bytes_per_line;
+
+    /*
+     * Shrinking rows are converted from top to bottom, and growing rows from bottom to top.
+     * This way an output band overwrites only the input rows that are already copied or converted.
+     */
+    const bool grows = output_bytes_per_line > image->bytes_per_line;
+
+    for (unsigned i = 0; i < bands; i++) {
+        const unsigned band = grows ? bands - 1 - i : i;
+        const unsigned first_row = band * rows_per_band;
+        const unsigned rows = (image->height - first_row < rows_per_band) ? image->height - first_row : rows_per_band;
+
+        memcpy(scratch, (uint8_t *)image->pixels + (size_t)image->bytes_per_line * first_row, (size_t)image->bytes_per_line * rows);
+
+        input_band.height  = rows;
+        output_band.height = rows;
+        output_band.pixels = (uint8_t *)image->pixels + (size_t)output_bytes_per_line * first_row;
+
+        SAIL_TRY_OR_CLEANUP(sail_convert_image_with_plan(&input_band, plan, &output_band),
+                            /* cleanup */ sail_free(scratch),
+                                          sail_destroy_palette(palette),
+                                          sail_destroy_conversion_plan(plan));
+    }
+
+    sail_free(scratch);
+    sail_destroy_conversion_plan(plan);
+
+    image->pixel_format   = output_pixel_format;
+    image->bytes_per_line = output_bytes_per_line;
+
+    sail_destroy_palette(image->palette);
+    image->palette = palette;
+
+    return SAIL_OK;
+}
+
 sail_status_t stop_writing(void *state, size_t *written) {
 
     if (written != NULL) {
@@ -149,20 +277,76 @@ sail_status_t stop_writing(void *state, size_t *written) {
     return SAIL_OK;
 }
 
-sail_status_t allowed_write_output_pixel_format(const struct sail_write_features *write_features, enum SailPixelFormat pixel_format) {
-
-    SAIL_CHECK_WRITE_FEATURES_PTR(write_features);
+static bool is_write_output_pixel_format_supported(const struct sail_write_features *write_features, enum SailPixelFormat pixel_format) {
 
     for (unsigned i = 0; i < write_features->output_pixel_formats_length; i++) {
         if (write_features->output_pixel_formats[i] == pixel_format) {
-            return SAIL_OK;
+            return true;
         }
     }
 
+    return false;
+}
+
+sail_status_t allowed_write_output_pixel_format(const struct sail_write_features *write_features, enum SailPixelFormat pixel_format) {
+
+    SAIL_CHECK_WRITE_FEATURES_PTR(write_features);
+
+    if (is_write_output_pixel_format_supported(write_features, pixel_format)) {
+        return SAIL_OK;
+    }
+
     print_unsupported_write_pixel_format(pixel_format);
     SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
 }
 
+static enum SailPixelFormat straight_alpha_pixel_format(enum SailPixelFormat pixel_format) {
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP32_RGBA;
+        case SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP32_BGRA;
+        case SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP32_ARGB;
+        case SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP32_ABGR;
+
+        case SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP64_RGBA;
+        case SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP64_BGRA;
+        case SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP64_ARGB;
+        case SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED: return SAIL_PIXEL_FORMAT_BPP64_ABGR;
+
+        default: return SAIL_PIXEL_FORMAT_UNKNOWN;
+    }
+}
+
+sail_status_t unpremultiply_for_writing(const struct sail_write_features *write_features,
+                                        const struct sail_image *image,
+                                        struct sail_image **image_output) {
+
+    SAIL_CHECK_WRITE_FEATURES_PTR(write_features);
+    SAIL_CHECK_IMAGE_PTR(image);
+    SAIL_CHECK_IMAGE_PTR(image_output);
+
+    *image_output = NULL;
+
+    if (!sail_is_premultiplied(image->pixel_format) ||
+            is_write_output_pixel_format_supported(write_features, image->pixel_format)) {
+        return SAIL_OK;
+    }
+
+    const enum SailPixelFormat straight_pixel_format = straight_alpha_pixel_format(image->pixel_format);
+
+    if (!is_write_output_pixel_format_supported(write_features, straight_pixel_format)) {
+        return SAIL_OK;
+    }
+
+    SAIL_LOG_DEBUG("Unpremultiplying alpha to write %s as %s",
+                   sail_pixel_format_to_string(image->pixel_format),
+                   sail_pixel_format_to_string(straight_pixel_format));
+
+    SAIL_TRY(sail_convert_image(image, straight_pixel_format, image_output));
+
+    return SAIL_OK;
+}
+
 sail_status_t alloc_string_node(struct sail_string_node **string_node) {
 
     SAIL_CHECK_STRING_NODE_PTR(string_node);
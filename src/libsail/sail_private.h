@@ -41,6 +41,8 @@
 
 struct sail_codec_info;
 struct sail_codec;
+struct sail_conversion_options;
+struct sail_image;
 struct sail_string_node;
 struct sail_write_features;
 
@@ -55,6 +57,18 @@ struct hidden_state {
      */
     struct sail_write_options *write_options;
 
+    /*
+     * Read operations save the requested output pixel format and own the conversion options
+     * to convert every frame right after reading it. SAIL_PIXEL_FORMAT_UNKNOWN disables conversion.
+     * The YUV matrix and range of the conversion options are always taken from the read options.
+     * NULL conversion options mean the default ones.
+     */
+    enum SailPixelFormat output_pixel_format;
+    struct sail_conversion_options *conversion_options;
+
+    /* Read operations save if every frame must be rotated and flipped to be displayed correctly. */
+    bool auto_orient;
+
     /* Local state passed to codec reading and writing functions. */
     void *state;
 
@@ -68,10 +82,38 @@ SAIL_HIDDEN sail_status_t load_codec_by_codec_info(const struct sail_codec_info
 
 SAIL_HIDDEN void destroy_hidden_state(struct hidden_state *state);
 
+/*
+ * Converts the image pixels to the output pixel format band by band. The pixel buffer MUST be large enough
+ * to hold image->height rows of output_bytes_per_line bytes. Only a single band of a few megabytes
+ * is allocated temporarily. Bands are converted with as many threads as the options request.
+ *
+ * Planar pixel formats cannot be converted row by row, so the whole frame is converted into
+ * a new pixel buffer that replaces the existing one. So are color and indexed frames quantized
+ * into indexed pixel formats as their palette is built from the whole frame.
+ *
+ * Grayscale frames converted to 1/2/4-bit indexed pixel formats get a palette of evenly spaced gray levels.
+ * Quantized frames get the quantized palette. The input palette is destroyed.
+ */
+SAIL_HIDDEN sail_status_t convert_frame_in_place(struct sail_image *image,
+                                                 enum SailPixelFormat output_pixel_format,
+                                                 unsigned output_bytes_per_line,
+                                                 const struct sail_conversion_options *options);
+
 SAIL_HIDDEN sail_status_t stop_writing(void *state, size_t *written);
 
 SAIL_HIDDEN sail_status_t allowed_write_output_pixel_format(const struct sail_write_features *write_features, enum SailPixelFormat pixel_format);
 
+/*
+ * Codecs know nothing about premultiplied alpha. If the codec cannot write the premultiplied pixel format
+ * of the image, but can write its straight alpha counterpart, unpremultiplies the image into a new image
+ * and saves it in the output image. Otherwise, sets the output image to NULL.
+ *
+ * The output image MUST be destroyed later with sail_destroy_image().
+ */
+SAIL_HIDDEN sail_status_t unpremultiply_for_writing(const struct sail_write_features *write_features,
+                                                    const struct sail_image *image,
+                                                    struct sail_image **image_output);
+
 SAIL_HIDDEN sail_status_t alloc_string_node(struct sail_string_node **string_node);
 
 SAIL_HIDDEN void destroy_string_node(struct sail_string_node *string_node);
@@ -28,6 +28,7 @@
 #include <stdlib.h>
 
 #include "sail-common.h"
+#include "sail-manip.h"
 #include "sail.h"
 
 /*
@@ -77,12 +78,15 @@ sail_status_t start_reading_io_with_options(struct sail_io *io, bool own_io,
                         /* cleanup */ if (own_io) sail_destroy_io(io));
     struct hidden_state *state_of_mind = ptr;
 
-    state_of_mind->io            = io;
-    state_of_mind->own_io        = own_io;
-    state_of_mind->write_options = NULL;
-    state_of_mind->state         = NULL;
-    state_of_mind->codec_info   = codec_info;
-    state_of_mind->codec        = NULL;
+    state_of_mind->io                  = io;
+    state_of_mind->own_io              = own_io;
+    state_of_mind->write_options       = NULL;
+    state_of_mind->output_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+    state_of_mind->conversion_options  = NULL;
+    state_of_mind->auto_orient         = false;
+    state_of_mind->state               = NULL;
+    state_of_mind->codec_info          = codec_info;
+    state_of_mind->codec               = NULL;
 
     SAIL_TRY_OR_CLEANUP(load_codec_by_codec_info(state_of_mind->codec_info, &state_of_mind->codec),
                         /* cleanup */ destroy_hidden_state(state_of_mind));
@@ -98,6 +102,17 @@ sail_status_t start_reading_io_with_options(struct sail_io *io, bool own_io,
                                           destroy_hidden_state(state_of_mind));
         sail_destroy_read_options(read_options_local);
     } else {
+        /* Save the conversion request to apply it to every frame. */
+        state_of_mind->output_pixel_format = read_options->output_pixel_format;
+        state_of_mind->auto_orient         = read_options->io_options & SAIL_IO_OPTION_AUTO_ORIENT;
+
+        SAIL_TRY_OR_CLEANUP(sail_alloc_conversion_options(&state_of_mind->conversion_options),
+                            /* cleanup */ destroy_hidden_state(state_of_mind));
+
+        /* Planar frames are converted with the same matrix and range the codec is asked to output. */
+        state_of_mind->conversion_options->yuv_matrix = read_options->yuv_matrix;
+        state_of_mind->conversion_options->yuv_range  = read_options->yuv_range;
+
         SAIL_TRY_OR_CLEANUP(state_of_mind->codec->v5->read_init(state_of_mind->io, read_options, &state_of_mind->state),
                             /* cleanup */ state_of_mind->codec->v5->read_finish(&state_of_mind->state, state_of_mind->io),
                                           destroy_hidden_state(state_of_mind));
@@ -131,12 +146,15 @@ sail_status_t start_writing_io_with_options(struct sail_io *io, bool own_io,
                         /* cleanup */ if (own_io) sail_destroy_io(io));
     struct hidden_state *state_of_mind = ptr;
 
-    state_of_mind->io            = io;
-    state_of_mind->own_io        = own_io;
-    state_of_mind->write_options = NULL;
-    state_of_mind->state         = NULL;
-    state_of_mind->codec_info    = codec_info;
-    state_of_mind->codec         = NULL;
+    state_of_mind->io                  = io;
+    state_of_mind->own_io              = own_io;
+    state_of_mind->write_options       = NULL;
+    state_of_mind->output_pixel_format = SAIL_PIXEL_FORMAT_UNKNOWN;
+    state_of_mind->conversion_options  = NULL;
+    state_of_mind->auto_orient         = false;
+    state_of_mind->state               = NULL;
+    state_of_mind->codec_info          = codec_info;
+    state_of_mind->codec               = NULL;
 
     SAIL_TRY_OR_CLEANUP(load_codec_by_codec_info(state_of_mind->codec_info, &state_of_mind->codec),
                         /* cleanup */ destroy_hidden_state(state_of_mind));
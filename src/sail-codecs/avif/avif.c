@@ -131,6 +131,8 @@ SAIL_EXPORT sail_status_t sail_codec_read_init_v5_avif(struct sail_io *io, const
     /* Initialize AVIF. */
     avif_state->avif_context.io = io;
     avif_state->avif_io->data = &avif_state->avif_context;
+    /* Mapped data outlives reads, so libavif doesn't need to copy it. */
+    avif_state->avif_io->persistent = (io->map_range != NULL) ? AVIF_TRUE : AVIF_FALSE;
 
     avifResult avif_result = avifDecoderParse(avif_state->avif_decoder);
 
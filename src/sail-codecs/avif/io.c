@@ -39,6 +39,21 @@ avifResult avif_private_read_proc(struct avifIO *io, uint32_t read_flags, uint64
     SAIL_LOG_TRACE("AVIF: Read at offset %ld size %lu", (long)offset, (unsigned long)size);
 
     struct sail_avif_context *avif_context = (struct sail_avif_context *)io->data;
+
+    /* Zero-copy path. The data stays valid until the I/O object is closed, so the avifIO is persistent. */
+    if (avif_context->io->map_range != NULL) {
+        const void *ptr;
+        size_t size_mapped;
+        SAIL_TRY_OR_EXECUTE(avif_context->io->map_range(avif_context->io->stream, (size_t)offset, size, &ptr, &size_mapped),
+                            /* on error */ return AVIF_RESULT_IO_ERROR);
+        out->data = ptr;
+        out->size = size_mapped;
+
+        SAIL_LOG_TRACE("AVIF: Actually mapped: %lu", (unsigned long)size_mapped);
+
+        return AVIF_RESULT_OK;
+    }
+
     SAIL_TRY_OR_EXECUTE(avif_context->io->seek(avif_context->io->stream, (long)offset, SEEK_SET),
                         /* on error */ return AVIF_RESULT_IO_ERROR);
 
@@ -23,6 +23,7 @@
     SOFTWARE.
 */
 
+#include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -394,6 +395,50 @@ SAIL_EXPORT sail_status_t sail_codec_read_seek_next_pass_v5_bmp(void *state, str
     return SAIL_OK;
 }
 
+/*
+ * Copies uncompressed scan lines straight from the data mapped with sail_io.map_range.
+ * Sets 'done' to false if the data cannot be mapped entirely, so the caller falls back to reading.
+ */
+static sail_status_t read_uncompressed_mapped(const struct bmp_state *bmp_state, struct sail_io *io, struct sail_image *image, bool *done) {
+
+    *done = false;
+
+    size_t offset;
+    SAIL_TRY(io->tell(io->stream, &offset));
+
+    const size_t stride = (size_t)bmp_state->bytes_in_row + bmp_state->pad_bytes;
+    const size_t size = stride * image->height;
+    /* Pad bytes of the last scan line may be missing. */
+    const size_t min_size = size - bmp_state->pad_bytes;
+
+    if (size > LONG_MAX) {
+        return SAIL_OK;
+    }
+
+    const void *ptr;
+    size_t mapped_size;
+    SAIL_TRY(io->map_range(io->stream, offset, size, &ptr, &mapped_size));
+
+    if (mapped_size < min_size) {
+        SAIL_TRY(io->release(io->stream, ptr));
+        return SAIL_OK;
+    }
+
+    for (unsigned i = 0; i < image->height; i++) {
+        const unsigned row = bmp_state->flipped ? (image->height - 1 - i) : i;
+        memcpy((unsigned char *)image->pixels + (size_t)image->bytes_per_line * row,
+                (const unsigned char *)ptr + stride * i,
+                bmp_state->bytes_in_row);
+    }
+
+    SAIL_TRY(io->release(io->stream, ptr));
+    SAIL_TRY(io->seek(io->stream, (long)(mapped_size < size ? mapped_size : size), SEEK_CUR));
+
+    *done = true;
+
+    return SAIL_OK;
+}
+
 SAIL_EXPORT sail_status_t sail_codec_read_frame_v5_bmp(void *state, struct sail_io *io, struct sail_image *image) {
 
     SAIL_CHECK_STATE_PTR(state);
@@ -402,6 +447,19 @@ SAIL_EXPORT sail_status_t sail_codec_read_frame_v5_bmp(void *state, struct sail_
 
     struct bmp_state *bmp_state = (struct bmp_state *)state;
 
+    const bool rle = bmp_state->version >= SAIL_BMP_V3
+                        && (bmp_state->v3.compression == SAIL_BI_RLE4 || bmp_state->v3.compression == SAIL_BI_RLE8);
+
+    /* Copy scan lines directly from the I/O data instead of reading them one by one when possible. */
+    if (!rle && io->map_range != NULL) {
+        bool done;
+        SAIL_TRY(read_uncompressed_mapped(bmp_state, io, image, &done));
+
+        if (done) {
+            return SAIL_OK;
+        }
+    }
+
     /* RLE-encoded images don't need to skip pad bytes. */
     bool skip_pad_bytes = true;
 
@@ -32,6 +32,10 @@
 
 #include "helpers.h"
 
+/* APP1 markers with EXIF data start with this header. */
+static const char EXIF_HEADER[] = "Exif\0";
+#define EXIF_HEADER_LENGTH 6
+
 void jpeg_private_my_output_message(j_common_ptr cinfo) {
     char buffer[JMSG_LENGTH_MAX];
 
@@ -96,6 +100,90 @@ J_COLOR_SPACE jpeg_private_pixel_format_to_color_space(enum SailPixelFormat pixe
     }
 }
 
+bool jpeg_private_raw_data_supported(const struct jpeg_decompress_struct *decompress_context, enum SailPixelFormat pixel_format) {
+
+    if (decompress_context->jpeg_color_space != JCS_YCbCr || decompress_context->num_components != 3) {
+        return false;
+    }
+
+    /* The chroma components must be subsampled exactly like the planar pixel format expects. */
+    unsigned luma_factor;
+
+    switch (pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP12_I420:    luma_factor = 2; break;
+        case SAIL_PIXEL_FORMAT_BPP24_YUV444P: luma_factor = 1; break;
+
+        default: {
+            return false;
+        }
+    }
+
+    const jpeg_component_info *components = decompress_context->comp_info;
+
+    return components[0].h_samp_factor == (int)luma_factor && components[0].v_samp_factor == (int)luma_factor
+            && components[1].h_samp_factor == 1 && components[1].v_samp_factor == 1
+            && components[2].h_samp_factor == 1 && components[2].v_samp_factor == 1;
+}
+
+size_t jpeg_private_raw_data_buffer_size(const struct jpeg_decompress_struct *decompress_context) {
+
+    size_t size = 0;
+
+    for (int i = 0; i < decompress_context->num_components; i++) {
+        const jpeg_component_info *component = &decompress_context->comp_info[i];
+        size += (size_t)component->width_in_blocks * DCTSIZE * component->v_samp_factor * DCTSIZE;
+    }
+
+    return size;
+}
+
+sail_status_t jpeg_private_read_raw_data(struct jpeg_decompress_struct *decompress_context, JSAMPLE *buffer, struct sail_image *image) {
+
+    struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES];
+    unsigned planes_count;
+    SAIL_TRY(sail_image_planes(image, planes, &planes_count));
+
+    /*
+     * libjpeg outputs whole blocks. They are wider and taller than the planes, so every iMCU row
+     * is decoded into the buffer and then cropped into the planes.
+     */
+    JSAMPROW rows[3][2 * DCTSIZE];
+    JSAMPARRAY components[3];
+
+    for (int i = 0; i < 3; i++) {
+        const jpeg_component_info *component = &decompress_context->comp_info[i];
+        const size_t row_length = (size_t)component->width_in_blocks * DCTSIZE;
+
+        for (int row = 0; row < component->v_samp_factor * DCTSIZE; row++) {
+            rows[i][row] = buffer;
+            buffer += row_length;
+        }
+
+        components[i] = rows[i];
+    }
+
+    const unsigned max_lines = (unsigned)decompress_context->max_v_samp_factor * DCTSIZE;
+
+    for (unsigned line = 0; line < image->height; line += max_lines) {
+        /* libjpeg returns fewer lines only when the source is suspended, which SAIL I/O never does. */
+        if (jpeg_read_raw_data(decompress_context, components, max_lines) != max_lines) {
+            SAIL_LOG_ERROR("JPEG: Failed to read an iMCU row at line %u", line);
+            SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            const unsigned component_lines = (unsigned)decompress_context->comp_info[i].v_samp_factor * DCTSIZE;
+            const unsigned first_row = line / max_lines * component_lines;
+
+            for (unsigned row = 0; row < component_lines && first_row + row < planes[i].height; row++) {
+                memcpy((uint8_t *)planes[i].pixels + (size_t)planes[i].bytes_per_line * (first_row + row), rows[i][row], planes[i].width);
+            }
+        }
+    }
+
+    return SAIL_OK;
+}
+
 sail_status_t jpeg_private_fetch_meta_data(struct jpeg_decompress_struct *decompress_context, struct sail_meta_data_node **last_meta_data_node) {
 
     SAIL_CHECK_META_DATA_NODE_PTR(last_meta_data_node);
@@ -118,6 +206,17 @@ sail_status_t jpeg_private_fetch_meta_data(struct jpeg_decompress_struct *decomp
             memcpy(meta_data_node->value, it->data, meta_data_node->value_length - 1);
             *((char *)meta_data_node->value + meta_data_node->value_length - 1) = '\0';
 
+            *last_meta_data_node = meta_data_node;
+            last_meta_data_node = &meta_data_node->next;
+        } else if (it->marker == JPEG_APP0 + 1 && it->data_length > EXIF_HEADER_LENGTH && memcmp(it->data, EXIF_HEADER, EXIF_HEADER_LENGTH) == 0) {
+            /* Save raw EXIF without the APP1 header like other codecs do. */
+            struct sail_meta_data_node *meta_data_node;
+
+            SAIL_TRY(sail_alloc_meta_data_node_from_known_data(SAIL_META_DATA_EXIF,
+                                                               it->data + EXIF_HEADER_LENGTH,
+                                                               it->data_length - EXIF_HEADER_LENGTH,
+                                                               &meta_data_node));
+
             *last_meta_data_node = meta_data_node;
             last_meta_data_node = &meta_data_node->next;
         }
@@ -136,6 +235,15 @@ sail_status_t jpeg_private_write_meta_data(struct jpeg_compress_struct *compress
                                 JPEG_COM,
                                 (JOCTET *)meta_data_node->value,
                                 (unsigned)meta_data_node->value_length - 1);
+        } else if (meta_data_node->key == SAIL_META_DATA_EXIF && meta_data_node->value_length <= 65533 - EXIF_HEADER_LENGTH) {
+            jpeg_write_m_header(compress_context, JPEG_APP0 + 1, (unsigned)(EXIF_HEADER_LENGTH + meta_data_node->value_length));
+
+            for (size_t i = 0; i < EXIF_HEADER_LENGTH; i++) {
+                jpeg_write_m_byte(compress_context, EXIF_HEADER[i]);
+            }
+            for (size_t i = 0; i < meta_data_node->value_length; i++) {
+                jpeg_write_m_byte(compress_context, ((const JOCTET *)meta_data_node->value)[i]);
+            }
         } else {
             SAIL_LOG_WARNING("JPEG: Ignoring unsupported binary key '%s'", sail_meta_data_to_string(meta_data_node->key));
         }
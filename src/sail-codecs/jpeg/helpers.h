@@ -35,6 +35,7 @@
 #include "common.h"
 #include "export.h"
 
+struct sail_image;
 struct sail_meta_data_node;
 struct sail_resolution;
 
@@ -51,6 +52,12 @@ SAIL_HIDDEN enum SailPixelFormat jpeg_private_color_space_to_pixel_format(J_COLO
 
 SAIL_HIDDEN J_COLOR_SPACE jpeg_private_pixel_format_to_color_space(enum SailPixelFormat pixel_format);
 
+SAIL_HIDDEN bool jpeg_private_raw_data_supported(const struct jpeg_decompress_struct *decompress_context, enum SailPixelFormat pixel_format);
+
+SAIL_HIDDEN size_t jpeg_private_raw_data_buffer_size(const struct jpeg_decompress_struct *decompress_context);
+
+SAIL_HIDDEN sail_status_t jpeg_private_read_raw_data(struct jpeg_decompress_struct *decompress_context, JSAMPLE *buffer, struct sail_image *image);
+
 SAIL_HIDDEN sail_status_t jpeg_private_fetch_meta_data(struct jpeg_decompress_struct *decompress_context, struct sail_meta_data_node **last_meta_data_node);
 
 SAIL_HIDDEN sail_status_t jpeg_private_write_meta_data(struct jpeg_compress_struct *compress_context, const struct sail_meta_data_node *meta_data_node);
@@ -23,6 +23,8 @@
     SOFTWARE.
 */
 
+#include <limits.h>
+
 #include <jerror.h>
 
 #include "sail-common.h"
@@ -50,6 +52,30 @@ static void init_source(j_decompress_ptr cinfo)
     src->start_of_file = TRUE;
 }
 
+/*
+ * SAIL: Maps the rest of the stream into memory when the I/O object supports it, so libjpeg
+ * reads the data in place without copying it into the input buffer.
+ */
+static sail_status_t map_rest_of_stream(struct sail_jpeg_source_mgr *src, size_t *nbytes)
+{
+    struct sail_io *io = src->io;
+
+    size_t offset;
+    SAIL_TRY(io->tell(io->stream, &offset));
+
+    const void *ptr;
+    SAIL_TRY(io->map_range(io->stream, offset, LONG_MAX, &ptr, nbytes));
+
+    if (*nbytes > 0) {
+        /* Keep the I/O position consistent with the consumed data. */
+        SAIL_TRY_OR_CLEANUP(io->seek(io->stream, (long)*nbytes, SEEK_CUR),
+                            /* cleanup */ io->release(io->stream, ptr));
+        src->mapped = ptr;
+    }
+
+    return SAIL_OK;
+}
+
 /*
  * Fill the input buffer --- called whenever buffer is emptied.
  *
@@ -85,9 +111,20 @@ static void init_source(j_decompress_ptr cinfo)
 static boolean fill_input_buffer(j_decompress_ptr cinfo)
 {
     struct sail_jpeg_source_mgr *src = (struct sail_jpeg_source_mgr *)cinfo->src;
-    size_t nbytes;
-
-    sail_status_t err = src->io->tolerant_read(src->io->stream, src->buffer, INPUT_BUF_SIZE, &nbytes);
+    size_t nbytes = 0;
+    sail_status_t err = SAIL_OK;
+
+    if (src->mapped != NULL) {
+        /* The whole stream has been consumed already. */
+    } else if (src->io->map_range != NULL && map_rest_of_stream(src, &nbytes) == SAIL_OK && nbytes > 0) {
+        src->pub.next_input_byte = src->mapped;
+        src->pub.bytes_in_buffer = nbytes;
+        src->start_of_file = FALSE;
+
+        return TRUE;
+    } else {
+        err = src->io->tolerant_read(src->io->stream, src->buffer, INPUT_BUF_SIZE, &nbytes);
+    }
 
     if (err != SAIL_OK || nbytes == 0) {
         if (src->start_of_file)     /* Treat empty input file as fatal error */
@@ -158,8 +195,12 @@ static void skip_input_data(j_decompress_ptr cinfo, long num_bytes)
  */
 static void term_source(j_decompress_ptr cinfo)
 {
-    /* no work necessary here */
-    (void)cinfo;
+    struct sail_jpeg_source_mgr *src = (struct sail_jpeg_source_mgr *)cinfo->src;
+
+    if (src->mapped != NULL) {
+        SAIL_TRY_OR_SUPPRESS(src->io->release(src->io->stream, src->mapped));
+        src->mapped = NULL;
+    }
 }
 
 /*
@@ -202,6 +243,7 @@ void jpeg_private_sail_io_src(j_decompress_ptr cinfo, struct sail_io *io) {
     src->pub.resync_to_restart = jpeg_resync_to_restart; /* use default method */
     src->pub.term_source       = term_source;
     src->io                    = io;
+    src->mapped                = NULL;
     src->pub.bytes_in_buffer   = 0;    /* forces fill_input_buffer on first read */
     src->pub.next_input_byte   = NULL; /* until buffer loaded */
 }
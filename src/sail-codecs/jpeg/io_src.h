@@ -43,6 +43,7 @@ struct sail_jpeg_source_mgr {
     struct sail_io *io;           /* source stream */
     JOCTET *buffer;               /* start of buffer */
     boolean start_of_file;        /* have we gotten any data yet? */
+    const JOCTET *mapped;         /* rest of the stream mapped with sail_io.map_range, or NULL */
 };
 
 SAIL_HIDDEN void jpeg_private_sail_io_src(j_decompress_ptr cinfo, struct sail_io *io);
@@ -59,6 +59,9 @@ struct jpeg_state {
     bool frame_read;
     bool frame_written;
     bool started_compress;
+
+    /* Decoded iMCU rows when reading planar YUV with jpeg_read_raw_data(). */
+    JSAMPLE *raw_data_buffer;
 };
 
 static sail_status_t alloc_jpeg_state(struct jpeg_state **jpeg_state) {
@@ -75,6 +78,7 @@ static sail_status_t alloc_jpeg_state(struct jpeg_state **jpeg_state) {
     (*jpeg_state)->frame_read         = false;
     (*jpeg_state)->frame_written      = false;
     (*jpeg_state)->started_compress   = false;
+    (*jpeg_state)->raw_data_buffer    = NULL;
 
     return SAIL_OK;
 }
@@ -87,6 +91,7 @@ static void destroy_jpeg_state(struct jpeg_state *jpeg_state) {
 
     sail_free(jpeg_state->decompress_context);
     sail_free(jpeg_state->compress_context);
+    sail_free(jpeg_state->raw_data_buffer);
 
     sail_destroy_read_options(jpeg_state->read_options);
     sail_destroy_write_options(jpeg_state->write_options);
@@ -136,6 +141,7 @@ SAIL_EXPORT sail_status_t sail_codec_read_init_v5_jpeg(struct sail_io *io, const
 
     if (jpeg_state->read_options->io_options & SAIL_IO_OPTION_META_DATA) {
         jpeg_save_markers(jpeg_state->decompress_context, JPEG_COM, 0xffff);
+        jpeg_save_markers(jpeg_state->decompress_context, JPEG_APP0 + 1, 0xffff);
     }
     if (jpeg_state->read_options->io_options & SAIL_IO_OPTION_ICCP) {
         jpeg_save_markers(jpeg_state->decompress_context, JPEG_APP0 + 2, 0xFFFF);
@@ -153,6 +159,17 @@ SAIL_EXPORT sail_status_t sail_codec_read_init_v5_jpeg(struct sail_io *io, const
     /* We don't want colormapped output. */
     jpeg_state->decompress_context->quantize_colors = false;
 
+    /*
+     * Output I420 or YUV444P planes without color conversion and upsampling when they're requested
+     * and match the JPEG sampling. JPEG uses full range BT.601, so other requested matrices or ranges
+     * disable this path.
+     */
+    if (read_options->yuv_matrix == SAIL_YUV_MATRIX_BT601 && read_options->yuv_range == SAIL_YUV_RANGE_FULL
+            && jpeg_private_raw_data_supported(jpeg_state->decompress_context, read_options->output_pixel_format)) {
+        jpeg_state->decompress_context->out_color_space = JCS_YCbCr;
+        jpeg_state->decompress_context->raw_data_out = true;
+    }
+
     /* Launch decompression! */
     jpeg_start_decompress(jpeg_state->decompress_context);
 
@@ -188,7 +205,9 @@ SAIL_EXPORT sail_status_t sail_codec_read_seek_next_frame_v5_jpeg(void *state, s
     image_local->width                      = jpeg_state->decompress_context->output_width;
     image_local->height                     = jpeg_state->decompress_context->output_height;
     image_local->source_image->pixel_format = jpeg_private_color_space_to_pixel_format(jpeg_state->decompress_context->jpeg_color_space);
-    image_local->pixel_format               = jpeg_private_color_space_to_pixel_format(jpeg_state->decompress_context->out_color_space);
+    image_local->pixel_format               = jpeg_state->decompress_context->raw_data_out
+                                                ? jpeg_state->read_options->output_pixel_format
+                                                : jpeg_private_color_space_to_pixel_format(jpeg_state->decompress_context->out_color_space);
 
     SAIL_TRY_OR_CLEANUP(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line),
                         /* cleanup */ sail_destroy_image(image_local));
@@ -237,11 +256,22 @@ SAIL_EXPORT sail_status_t sail_codec_read_frame_v5_jpeg(void *state, struct sail
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+    if (jpeg_state->decompress_context->raw_data_out && jpeg_state->raw_data_buffer == NULL) {
+        void *ptr;
+        SAIL_TRY(sail_malloc(jpeg_private_raw_data_buffer_size(jpeg_state->decompress_context), &ptr));
+        jpeg_state->raw_data_buffer = ptr;
+    }
+
     if (setjmp(jpeg_state->error_context.setjmp_buffer) != 0) {
         jpeg_state->libjpeg_error = true;
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNDERLYING_CODEC);
     }
 
+    if (jpeg_state->decompress_context->raw_data_out) {
+        SAIL_TRY(jpeg_private_read_raw_data(jpeg_state->decompress_context, jpeg_state->raw_data_buffer, image));
+        return SAIL_OK;
+    }
+
     for (unsigned row = 0; row < image->height; row++) {
         unsigned char *scanline = (unsigned char *)image->pixels + row * image->bytes_per_line;
 
@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include "sail-common.h"
+#include "sail-manip.h"
 
 #include "helpers.h"
 
@@ -420,36 +421,32 @@ sail_status_t png_private_blend_over(void *dst_raw, unsigned dst_offset, const v
     SAIL_CHECK_PTR(src_raw);
     SAIL_CHECK_PTR(dst_raw);
 
-    if (bytes_per_pixel == 4) {
-        const uint8_t *src = src_raw;
-        uint8_t *dst = (uint8_t *)dst_raw + dst_offset * bytes_per_pixel;
-
-        while (width--) {
-            const double src_a = *(src+3) / 255.0;
-            const double dst_a = *(dst+3) / 255.0;
+    enum SailPixelFormat pixel_format;
 
-            *dst = (uint8_t)(src_a * (*src) + (1-src_a) * dst_a * (*dst)); src++; dst++;
-            *dst = (uint8_t)(src_a * (*src) + (1-src_a) * dst_a * (*dst)); src++; dst++;
-            *dst = (uint8_t)(src_a * (*src) + (1-src_a) * dst_a * (*dst)); src++; dst++;
-            *dst = (uint8_t)((src_a + (1-src_a) * dst_a) * 255);           src++; dst++;
-        }
+    if (bytes_per_pixel == 4) {
+        pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA;
     } else if (bytes_per_pixel == 8) {
-        const uint16_t *src = src_raw;
-        uint16_t *dst = (uint16_t *)((uint8_t *)dst_raw + dst_offset * bytes_per_pixel);
-
-        while (width--) {
-            const double src_a = *(src+3) / 65535.0;
-            const double dst_a = *(dst+3) / 65535.0;
-
-            *dst = (uint16_t)(src_a * (*src) + (1-src_a) * dst_a * (*dst)); src++; dst++;
-            *dst = (uint16_t)(src_a * (*src) + (1-src_a) * dst_a * (*dst)); src++; dst++;
-            *dst = (uint16_t)(src_a * (*src) + (1-src_a) * dst_a * (*dst)); src++; dst++;
-            *dst = (uint16_t)((src_a + (1-src_a) * dst_a) * 65535);         src++; dst++;
-        }
+        pixel_format = SAIL_PIXEL_FORMAT_BPP64_RGBA;
     } else {
         SAIL_LOG_AND_RETURN(SAIL_ERROR_UNSUPPORTED_BIT_DEPTH);
     }
 
+    /* Shallow one-row images. */
+    struct sail_image src;
+    memset(&src, 0, sizeof(src));
+    src.pixels         = (void *)src_raw;
+    src.width          = width;
+    src.height         = 1;
+    src.bytes_per_line = width * bytes_per_pixel;
+    src.pixel_format   = pixel_format;
+
+    struct sail_image dst = src;
+    dst.pixels         = dst_raw;
+    dst.width          = dst_offset + width;
+    dst.bytes_per_line = dst.width * bytes_per_pixel;
+
+    SAIL_TRY(sail_composite_image(&dst, &src, (int)dst_offset, 0, SAIL_COMPOSITE_OVER, 1));
+
     return SAIL_OK;
 }
 
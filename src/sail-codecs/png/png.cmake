@@ -18,6 +18,10 @@ macro(sail_find_dependencies)
 endmacro()
 
 macro(sail_codec_post_add)
+    # APNG frames are composited with libsail-manip
+    #
+    target_link_libraries(${TARGET} PRIVATE sail-manip)
+
     # Check for APNG features
     #
     cmake_push_check_state(RESET)
@@ -0,0 +1,102 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstring>
+
+#include "sail-c++.h"
+
+#include "munit.h"
+
+static MunitResult test_write_data(const MunitParameter params[], void *user_data)
+{
+    (void)params;
+    (void)user_data;
+
+    // Large enough to grow the data multiple times
+    const unsigned width = 301;
+    const unsigned height = 203;
+
+    sail::arbitrary_data pixels(static_cast<size_t>(width) * height * 3);
+
+    for (size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = static_cast<std::uint8_t>(i * 7 + i / 1000);
+    }
+
+    const sail::image image(pixels.data(), SAIL_PIXEL_FORMAT_BPP24_RGB, width, height);
+    munit_assert(image.is_valid());
+
+    const sail::codec_info codec_info = sail::codec_info::from_extension("png");
+    munit_assert(codec_info.is_valid());
+
+    const size_t initial_sizes[] = { 0, 1, 1024 * 1024 };
+
+    for (size_t initial_size : initial_sizes) {
+        sail::image_output image_output;
+
+        // Previous contents are discarded
+        sail::arbitrary_data data(17, 0xFF);
+        munit_assert(image_output.write(codec_info, image, initial_size, &data) == SAIL_OK);
+        munit_assert(!data.empty());
+
+        sail::image_input image_input;
+        const sail::image image_read = image_input.read(data.data(), data.size());
+        munit_assert(image_read.is_valid());
+        munit_assert(image_read.width() == width);
+        munit_assert(image_read.height() == height);
+
+        const sail::image image_rgb = image_read.convert_to(SAIL_PIXEL_FORMAT_BPP24_RGB);
+        munit_assert(image_rgb.is_valid());
+
+        for (unsigned row = 0; row < height; row++) {
+            munit_assert_memory_equal(static_cast<size_t>(width) * 3,
+                                      static_cast<const std::uint8_t *>(image_rgb.pixels()) + static_cast<size_t>(image_rgb.bytes_per_line()) * row,
+                                      pixels.data() + static_cast<size_t>(width) * 3 * row);
+        }
+    }
+
+    sail::arbitrary_data data;
+    munit_assert(sail::image_output().write(codec_info, image, &data) == SAIL_OK);
+    munit_assert(!data.empty());
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/write-data", test_write_data, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/bindings/c++/image-output",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
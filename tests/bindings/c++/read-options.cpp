@@ -0,0 +1,152 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <cstring>
+
+#include "sail-c++.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+static sail::conversion_options dithering_conversion_options()
+{
+    return sail::conversion_options()
+            .with_options(SAIL_CONVERSION_OPTION_BLEND_ALPHA)
+            .with_background(sail_rgb24_t{ 1, 2, 3 })
+            .with_threads(3)
+            .with_yuv_range(SAIL_YUV_RANGE_LIMITED)
+            .with_dither(SAIL_DITHER_ORDERED);
+}
+
+static void assert_dithering_conversion_options(const sail::conversion_options &conversion_options)
+{
+    munit_assert(conversion_options.options() == SAIL_CONVERSION_OPTION_BLEND_ALPHA);
+    munit_assert(conversion_options.background24().component1 == 1);
+    munit_assert(conversion_options.background24().component2 == 2);
+    munit_assert(conversion_options.background24().component3 == 3);
+    munit_assert(conversion_options.threads() == 3);
+    munit_assert(conversion_options.yuv_range() == SAIL_YUV_RANGE_LIMITED);
+    munit_assert(conversion_options.dither() == SAIL_DITHER_ORDERED);
+}
+
+static MunitResult test_copy(const MunitParameter params[], void *user_data)
+{
+    (void)params;
+    (void)user_data;
+
+    sail::read_options read_options;
+    read_options.with_output_pixel_format(SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE)
+                .with_conversion_options(dithering_conversion_options());
+
+    const sail::read_options read_options_copy(read_options);
+    munit_assert(read_options_copy.output_pixel_format() == SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE);
+    assert_dithering_conversion_options(read_options_copy.conversion_options());
+
+    sail::read_options read_options_assigned;
+    read_options_assigned = read_options;
+    assert_dithering_conversion_options(read_options_assigned.conversion_options());
+
+    const sail::read_options read_options_moved(std::move(read_options));
+    assert_dithering_conversion_options(read_options_moved.conversion_options());
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_from_read_features(const MunitParameter params[], void *user_data)
+{
+    (void)params;
+    (void)user_data;
+
+    const sail::codec_info codec_info = sail::codec_info::from_extension("png");
+    munit_assert(codec_info.is_valid());
+
+    sail::read_options read_options;
+    munit_assert(codec_info.read_features().to_read_options(&read_options) == SAIL_OK);
+    munit_assert(read_options.output_pixel_format() == SAIL_PIXEL_FORMAT_UNKNOWN);
+    munit_assert(read_options.conversion_options().dither() == SAIL_DITHER_NONE);
+
+    read_options.with_conversion_options(dithering_conversion_options());
+    assert_dithering_conversion_options(sail::read_options(read_options).conversion_options());
+
+    return MUNIT_OK;
+}
+
+/* The conversion options reach libsail and convert every frame while reading. */
+static MunitResult test_read_dithered(const MunitParameter params[], void *user_data)
+{
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    const sail::conversion_options conversion_options = dithering_conversion_options();
+
+    sail::image_input image_input;
+    const sail::image image_native = image_input.read(path);
+    munit_assert(image_native.is_valid());
+
+    const sail::image image_expected = image_native.convert_to(SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, conversion_options);
+    munit_assert(image_expected.is_valid());
+
+    sail::read_options read_options;
+    read_options.with_output_pixel_format(SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE)
+                .with_conversion_options(conversion_options);
+
+    sail::image image;
+    munit_assert(image_input.start(path, sail::codec_info::from_path(path), read_options) == SAIL_OK);
+    munit_assert(image_input.next_frame(&image) == SAIL_OK);
+    munit_assert(image_input.stop() == SAIL_OK);
+
+    munit_assert(image.pixel_format() == SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE);
+    munit_assert(image.pixels_size() == image_expected.pixels_size());
+    munit_assert_memory_equal(image.pixels_size(), image.pixels(), image_expected.pixels());
+
+    return MUNIT_OK;
+}
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"path", (char **)SAIL_TEST_IMAGES },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/copy",               test_copy,               NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/from-read-features", test_from_read_features, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/read-dithered",      test_read_dithered,      NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/bindings/c++/read-options",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,229 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+/* BPP24-RGB image with every byte set to its offset modulo 251. */
+static struct sail_image* alloc_rgb24_image(unsigned width, unsigned height) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    const size_t pixels_size = (size_t)image->bytes_per_line * height;
+
+    for (size_t i = 0; i < pixels_size; i++) {
+        ((uint8_t *)image->pixels)[i] = (uint8_t)(i % 251);
+    }
+
+    return image;
+}
+
+static const uint8_t* pixel_at(const struct sail_image *image, unsigned x, unsigned y) {
+
+    return (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * y + x * 3;
+}
+
+static MunitResult test_share(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgb24_image(13, 7);
+    void *pixels = image->pixels;
+
+    munit_assert_false(sail_is_image_shared(image));
+
+    struct sail_image *image_shared = NULL;
+    munit_assert(sail_share_image(image, &image_shared) == SAIL_OK);
+
+    /* No pixels are moved or copied. */
+    munit_assert_ptr_equal(image->pixels, pixels);
+    munit_assert_ptr_equal(image_shared->pixels, pixels);
+    munit_assert_true(sail_is_image_shared(image));
+    munit_assert_true(sail_is_image_shared(image_shared));
+
+    /* Copy on write. */
+    munit_assert(sail_make_image_writable(image_shared) == SAIL_OK);
+    munit_assert_ptr_not_equal(image_shared->pixels, pixels);
+    munit_assert_uint(image_shared->bytes_per_line, ==, image->bytes_per_line);
+    munit_assert_memory_equal((size_t)image->bytes_per_line * image->height, image_shared->pixels, image->pixels);
+    munit_assert_false(sail_is_image_shared(image));
+    munit_assert_false(sail_is_image_shared(image_shared));
+
+    /* The last reference is writable as is. */
+    munit_assert(sail_make_image_writable(image) == SAIL_OK);
+    munit_assert_ptr_equal(image->pixels, pixels);
+
+    sail_destroy_image(image_shared);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_view(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgb24_image(13, 7);
+
+    struct sail_image *view = NULL;
+    munit_assert(sail_image_view(image, 3, 2, 5, 4, &view) == SAIL_OK);
+
+    munit_assert_uint(view->width, ==, 5);
+    munit_assert_uint(view->height, ==, 4);
+    munit_assert_uint(view->bytes_per_line, ==, image->bytes_per_line);
+    munit_assert_ptr_equal(view->pixels, pixel_at(image, 3, 2));
+    munit_assert_true(sail_is_image_shared(view));
+
+    /* The view outlives the parent. */
+    struct sail_image *image_copy = NULL;
+    munit_assert(sail_copy_image(image, &image_copy) == SAIL_OK);
+    sail_destroy_image(image);
+
+    munit_assert_false(sail_is_image_shared(view));
+
+    /* Deep copies of views are compact. */
+    struct sail_image *view_copy = NULL;
+    munit_assert(sail_copy_image(view, &view_copy) == SAIL_OK);
+    munit_assert_uint(view_copy->bytes_per_line, ==, 15);
+
+    for (unsigned row = 0; row < view->height; row++) {
+        munit_assert_memory_equal(15, pixel_at(view, 0, row), pixel_at(image_copy, 3, 2 + row));
+        munit_assert_memory_equal(15, pixel_at(view_copy, 0, row), pixel_at(image_copy, 3, 2 + row));
+    }
+
+    /* Views of views. */
+    struct sail_image *view2 = NULL;
+    munit_assert(sail_image_view(view, 1, 1, 2, 2, &view2) == SAIL_OK);
+    munit_assert_ptr_equal(view2->pixels, pixel_at(view, 1, 1));
+
+    munit_assert(sail_make_image_writable(view2) == SAIL_OK);
+    munit_assert_uint(view2->bytes_per_line, ==, 6);
+    munit_assert_memory_equal(6, pixel_at(view2, 0, 1), pixel_at(image_copy, 4, 4));
+
+    sail_destroy_image(view2);
+    sail_destroy_image(view_copy);
+    sail_destroy_image(view);
+    sail_destroy_image(image_copy);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_crop(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgb24_image(13, 7);
+
+    struct sail_image *image_copy = NULL;
+    munit_assert(sail_copy_image(image, &image_copy) == SAIL_OK);
+
+    const unsigned bytes_per_line = image->bytes_per_line;
+    const uint8_t *pixels = image->pixels;
+
+    munit_assert(sail_crop_image(image, 4, 1, 9, 6) == SAIL_OK);
+    munit_assert_uint(image->width, ==, 9);
+    munit_assert_uint(image->height, ==, 6);
+    munit_assert_uint(image->bytes_per_line, ==, bytes_per_line);
+    munit_assert_ptr_equal(image->pixels, pixels + bytes_per_line + 4 * 3);
+    munit_assert_memory_equal(27, pixel_at(image, 0, 5), pixel_at(image_copy, 4, 6));
+
+    /* Crops that only narrow the image get compact rows too. */
+    munit_assert(sail_crop_image(image, 0, 0, 5, 6) == SAIL_OK);
+    munit_assert_ptr_equal(image->pixels, pixels + bytes_per_line + 4 * 3);
+
+    struct sail_image *crop_copy = NULL;
+    munit_assert(sail_copy_image(image, &crop_copy) == SAIL_OK);
+    munit_assert_uint(crop_copy->bytes_per_line, ==, 15);
+    munit_assert_memory_equal(15, pixel_at(crop_copy, 0, 5), pixel_at(image_copy, 4, 6));
+    sail_destroy_image(crop_copy);
+
+    struct sail_image *image_narrow = alloc_rgb24_image(13, 7);
+    struct sail_image *view = NULL;
+    munit_assert(sail_image_view(image_narrow, 0, 0, 5, 7, &view) == SAIL_OK);
+    munit_assert_ptr_equal(view->pixels, image_narrow->pixels);
+    munit_assert(sail_make_image_writable(view) == SAIL_OK);
+    munit_assert_uint(view->bytes_per_line, ==, 15);
+    sail_destroy_image(view);
+    sail_destroy_image(image_narrow);
+
+    sail_destroy_image(image_copy);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_invalid_rectangles(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_rgb24_image(13, 7);
+    struct sail_image *view = NULL;
+
+    munit_assert(sail_image_view(image, 0, 0, 0, 1, &view) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_image_view(image, 10, 0, 4, 1, &view) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_image_view(image, 0, 8, 1, 1, &view) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_crop_image(image, 0, 0, 14, 7) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert_null(view);
+
+    /* Indexed rectangles must start on a byte boundary. */
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP4_INDEXED;
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 16, &image->palette) == SAIL_OK);
+
+    munit_assert(sail_image_view(image, 1, 0, 2, 2, &view) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_image_view(image, 2, 0, 2, 2, &view) == SAIL_OK);
+    munit_assert_not_null(view->palette);
+
+    sail_destroy_image(view);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/share", test_share, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/view", test_view, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/crop", test_crop, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/invalid-rectangles", test_invalid_rectangles, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/image",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -133,6 +133,21 @@ static MunitResult test_pixel_format_to_string(const MunitParameter params[], vo
     munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_ARGB), "BPP64-ARGB");
     munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_ABGR), "BPP64-ABGR");
 
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED), "BPP32-RGBA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED), "BPP32-BGRA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED), "BPP32-ARGB-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED), "BPP32-ABGR-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED), "BPP64-RGBA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED), "BPP64-BGRA-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED), "BPP64-ARGB-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED), "BPP64-ABGR-PREMULTIPLIED");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF), "BPP16-GRAYSCALE-HALF");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT), "BPP32-GRAYSCALE-FLOAT");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP48_RGB_HALF), "BPP48-RGB-HALF");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF), "BPP64-RGBA-HALF");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT), "BPP96-RGB-FLOAT");
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT), "BPP128-RGBA-FLOAT");
+
     munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP32_CMYK), "BPP32-CMYK");
     munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP64_CMYK), "BPP64-CMYK");
 
@@ -227,6 +242,21 @@ static MunitResult test_pixel_format_from_string(const MunitParameter params[],
     munit_assert(sail_pixel_format_from_string("BPP64-ARGB") == SAIL_PIXEL_FORMAT_BPP64_ARGB);
     munit_assert(sail_pixel_format_from_string("BPP64-ABGR") == SAIL_PIXEL_FORMAT_BPP64_ABGR);
 
+    munit_assert(sail_pixel_format_from_string("BPP32-RGBA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP32-BGRA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP32-ARGB-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP32-ABGR-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-RGBA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-BGRA-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_BGRA_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-ARGB-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_ARGB_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP64-ABGR-PREMULTIPLIED") == SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED);
+    munit_assert(sail_pixel_format_from_string("BPP16-GRAYSCALE-HALF") == SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE_HALF);
+    munit_assert(sail_pixel_format_from_string("BPP32-GRAYSCALE-FLOAT") == SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT);
+    munit_assert(sail_pixel_format_from_string("BPP48-RGB-HALF") == SAIL_PIXEL_FORMAT_BPP48_RGB_HALF);
+    munit_assert(sail_pixel_format_from_string("BPP64-RGBA-HALF") == SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF);
+    munit_assert(sail_pixel_format_from_string("BPP96-RGB-FLOAT") == SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT);
+    munit_assert(sail_pixel_format_from_string("BPP128-RGBA-FLOAT") == SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT);
+
     munit_assert(sail_pixel_format_from_string("BPP32-CMYK") == SAIL_PIXEL_FORMAT_BPP32_CMYK);
     munit_assert(sail_pixel_format_from_string("BPP64-CMYK") == SAIL_PIXEL_FORMAT_BPP64_CMYK);
 
@@ -256,6 +286,61 @@ static MunitResult test_pixel_format_from_string(const MunitParameter params[],
 /*
  * Image properties.
  */
+static MunitResult test_pixel_format_properties(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Every known pixel format has a table row consistent with the predicates. */
+    for (int pixel_format = SAIL_PIXEL_FORMAT_BPP1; pixel_format <= SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT; pixel_format++) {
+        const struct sail_pixel_format_properties *properties = sail_pixel_format_properties_of(pixel_format);
+
+        munit_assert_not_null(properties);
+        munit_assert_uint(properties->bits_per_pixel, >, 0);
+        munit_assert_uint(properties->bits_per_channel, <=, properties->bits_per_pixel);
+
+        unsigned bits_per_pixel;
+        munit_assert(sail_bits_per_pixel(pixel_format, &bits_per_pixel) == SAIL_OK);
+        munit_assert_uint(bits_per_pixel, ==, properties->bits_per_pixel);
+
+        munit_assert(sail_is_indexed(pixel_format) == ((properties->flags & SAIL_PIXEL_FORMAT_PROPERTY_INDEXED) != 0));
+        munit_assert(!(sail_is_indexed(pixel_format) && sail_is_grayscale(pixel_format)));
+        munit_assert(!(sail_is_rgb_family(pixel_format) && sail_is_grayscale(pixel_format)));
+    }
+
+    const struct sail_pixel_format_properties *properties = sail_pixel_format_properties_of(SAIL_PIXEL_FORMAT_BPP16_RGB565);
+    munit_assert_uint(properties->bits_per_pixel, ==, 16);
+    munit_assert_uint(properties->channels, ==, 3);
+    munit_assert_uint(properties->bits_per_channel, ==, 5);
+    munit_assert_int(properties->flags, ==, SAIL_PIXEL_FORMAT_PROPERTY_RGB_FAMILY);
+
+    properties = sail_pixel_format_properties_of(SAIL_PIXEL_FORMAT_BPP64_XRGB);
+    munit_assert_uint(properties->channels, ==, 3);
+    munit_assert_uint(properties->bits_per_channel, ==, 16);
+    munit_assert_false(properties->flags & SAIL_PIXEL_FORMAT_PROPERTY_ALPHA);
+
+    properties = sail_pixel_format_properties_of(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE_ALPHA);
+    munit_assert_uint(properties->channels, ==, 2);
+    munit_assert_uint(properties->bits_per_channel, ==, 4);
+    munit_assert_int(properties->flags, ==, SAIL_PIXEL_FORMAT_PROPERTY_GRAYSCALE | SAIL_PIXEL_FORMAT_PROPERTY_ALPHA);
+
+    properties = sail_pixel_format_properties_of(SAIL_PIXEL_FORMAT_BPP12_I420);
+    munit_assert_uint(properties->bits_per_pixel, ==, 12);
+    munit_assert_true(properties->flags & SAIL_PIXEL_FORMAT_PROPERTY_PLANAR);
+
+    /* Unknown and invalid pixel formats. */
+    properties = sail_pixel_format_properties_of(SAIL_PIXEL_FORMAT_UNKNOWN);
+    munit_assert_uint(properties->bits_per_pixel, ==, 0);
+    munit_assert_int(properties->flags, ==, 0);
+
+    properties = sail_pixel_format_properties_of((enum SailPixelFormat)(SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT + 1));
+    munit_assert_uint(properties->bits_per_pixel, ==, 0);
+
+    unsigned bits_per_pixel;
+    munit_assert(sail_bits_per_pixel(SAIL_PIXEL_FORMAT_UNKNOWN, &bits_per_pixel) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    return MUNIT_OK;
+}
+
 static MunitResult test_image_property_to_string(const MunitParameter params[], void *user_data) {
     (void)params;
     (void)user_data;
@@ -494,6 +579,7 @@ static MunitTest test_suite_tests[] = {
 
     { (char *)"/pixel-format-to-string",   test_pixel_format_to_string,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/pixel-format-from-string", test_pixel_format_from_string,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/pixel-format-properties",  test_pixel_format_properties,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 
     { (char *)"/image-property-to-string",   test_image_property_to_string,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/image-property-from-string", test_image_property_from_string, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
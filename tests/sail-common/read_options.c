@@ -35,6 +35,9 @@ static MunitResult test_alloc_options(const MunitParameter params[], void *user_
     munit_assert(sail_alloc_read_options(&read_options) == SAIL_OK);
     munit_assert_not_null(read_options);
     munit_assert(read_options->io_options == 0);
+    munit_assert(read_options->output_pixel_format == SAIL_PIXEL_FORMAT_UNKNOWN);
+    munit_assert(read_options->yuv_matrix == SAIL_YUV_MATRIX_BT601);
+    munit_assert(read_options->yuv_range == SAIL_YUV_RANGE_FULL);
 
     sail_destroy_read_options(read_options);
 
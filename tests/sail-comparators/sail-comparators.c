@@ -145,7 +145,7 @@ sail_status_t sail_compare_source_images(const struct sail_source_image *source_
     return SAIL_OK;
 }
 
-sail_status_t sail_compare_images(const struct sail_image *image1, const struct sail_image *image2) {
+sail_status_t sail_compare_images_equal(const struct sail_image *image1, const struct sail_image *image2) {
 
     munit_assert_not_null(image1);
     munit_assert_not_null(image2);
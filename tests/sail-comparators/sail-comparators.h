@@ -41,6 +41,6 @@ SAIL_EXPORT sail_status_t sail_compare_iccps(const struct sail_iccp *iccp1, cons
 
 SAIL_EXPORT sail_status_t sail_compare_source_images(const struct sail_source_image *source_image1, const struct sail_source_image *source_image2);
 
-SAIL_EXPORT sail_status_t sail_compare_images(const struct sail_image *image1, const struct sail_image *image2);
+SAIL_EXPORT sail_status_t sail_compare_images_equal(const struct sail_image *image1, const struct sail_image *image2);
 
 #endif
@@ -0,0 +1,301 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+/* BPP32-RGBA image with the specified colors repeated. */
+static struct sail_image* alloc_rgba32_image(unsigned width, unsigned height, const uint8_t (*colors)[4], unsigned color_count) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    for (unsigned row = 0; row < height; row++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < width; column++) {
+            memcpy(scan + column * 4, colors[(row * 7 + column) % color_count], 4);
+        }
+    }
+
+    return image;
+}
+
+/* BPP64-RGBA image with the value of (row, column) in every component except alpha. */
+static struct sail_image* alloc_rgba64_image(unsigned width, unsigned height, uint16_t (*value)(unsigned, unsigned, unsigned)) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+
+    for (unsigned row = 0; row < height; row++) {
+        uint16_t *scan = (uint16_t *)((uint8_t *)image->pixels + (size_t)image->bytes_per_line * row);
+
+        for (unsigned column = 0; column < width; column++) {
+            for (unsigned c = 0; c < 3; c++) {
+                scan[column * 4 + c] = value(row, column, c);
+            }
+
+            scan[column * 4 + 3] = 65535;
+        }
+    }
+
+    return image;
+}
+
+static uint16_t gray_wide(unsigned row, unsigned column, unsigned c) {
+    (void)c;
+    return (uint16_t)(((row * 64 + column) & 0xFF) * 257);
+}
+
+static uint16_t gray_deep(unsigned row, unsigned column, unsigned c) {
+    (void)c;
+    return (uint16_t)(row * 1000 + column);
+}
+
+static uint16_t color_wide(unsigned row, unsigned column, unsigned c) {
+    return (uint16_t)(((row + column * c) & 0xFF) * 257);
+}
+
+static MunitResult test_properties(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const uint8_t OPAQUE_GRAY[][4] = {
+        { 0,   0,   0,   255 },
+        { 128, 128, 128, 255 },
+        { 255, 255, 255, 255 },
+    };
+
+    static const uint8_t TRANSLUCENT_COLOR[][4] = {
+        { 0,   0,   0,   255 },
+        { 10,  20,  30,  255 },
+        { 10,  20,  30,  254 },
+        { 255, 0,   0,   255 },
+    };
+
+    struct sail_image_analysis analysis;
+
+    struct sail_image *image = alloc_rgba32_image(37, 11, OPAQUE_GRAY, 3);
+    munit_assert(sail_analyze_image(image, &analysis) == SAIL_OK);
+    munit_assert_true(analysis.opaque);
+    munit_assert_true(analysis.grayscale);
+    munit_assert_true(analysis.fits_8_bits);
+    munit_assert_uint(analysis.color_count, ==, 3);
+    sail_destroy_image(image);
+
+    image = alloc_rgba32_image(37, 11, TRANSLUCENT_COLOR, 4);
+    munit_assert(sail_analyze_image(image, &analysis) == SAIL_OK);
+    munit_assert_false(analysis.opaque);
+    munit_assert_false(analysis.grayscale);
+    munit_assert_true(analysis.fits_8_bits);
+    munit_assert_uint(analysis.color_count, ==, 4);
+    sail_destroy_image(image);
+
+    /* 16-bit components. */
+    image = alloc_rgba64_image(64, 8, gray_wide);
+    munit_assert(sail_analyze_image(image, &analysis) == SAIL_OK);
+    munit_assert_true(analysis.opaque);
+    munit_assert_true(analysis.grayscale);
+    munit_assert_true(analysis.fits_8_bits);
+    munit_assert_uint(analysis.color_count, ==, 256);
+    sail_destroy_image(image);
+
+    image = alloc_rgba64_image(64, 8, gray_deep);
+    munit_assert(sail_analyze_image(image, &analysis) == SAIL_OK);
+    munit_assert_true(analysis.grayscale);
+    munit_assert_false(analysis.fits_8_bits);
+    munit_assert_uint(analysis.color_count, ==, 0);
+    sail_destroy_image(image);
+
+    image = alloc_rgba64_image(64, 8, color_wide);
+    munit_assert(sail_analyze_image(image, &analysis) == SAIL_OK);
+    munit_assert_false(analysis.grayscale);
+    munit_assert_true(analysis.fits_8_bits);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_indexed(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_image(16, 4, SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    memset(image->pixels, 0, (size_t)image->bytes_per_line * image->height);
+
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 2, &image->palette) == SAIL_OK);
+    uint8_t *palette = image->palette->data;
+    palette[0] = 0;   palette[1] = 0;   palette[2] = 0;
+    palette[3] = 200; palette[4] = 200; palette[5] = 200;
+
+    struct sail_image_analysis analysis;
+    munit_assert(sail_analyze_image(image, &analysis) == SAIL_OK);
+    munit_assert_true(analysis.opaque);
+    munit_assert_true(analysis.grayscale);
+    munit_assert_true(analysis.fits_8_bits);
+    munit_assert_uint(analysis.color_count, ==, 2);
+
+    munit_assert_true(sail_can_analyze(SAIL_PIXEL_FORMAT_BPP8_INDEXED));
+    munit_assert_false(sail_can_analyze(SAIL_PIXEL_FORMAT_BPP24_YCBCR));
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_narrowest(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const enum SailPixelFormat PIXEL_FORMATS[] = {
+        SAIL_PIXEL_FORMAT_BPP64_RGBA,
+        SAIL_PIXEL_FORMAT_BPP32_RGBA,
+        SAIL_PIXEL_FORMAT_BPP48_RGB,
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+        SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP4_INDEXED,
+        SAIL_PIXEL_FORMAT_BPP8_INDEXED,
+    };
+
+    static const size_t PIXEL_FORMATS_LENGTH = sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]);
+
+    static const struct {
+        struct sail_image_analysis analysis;
+        enum SailPixelFormat input_pixel_format;
+        enum SailPixelFormat expected_pixel_format;
+    } CASES[] = {
+        { { true,  true,  true,  0  }, SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE  },
+        { { true,  true,  false, 0  }, SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE },
+        { { true,  false, true,  0  }, SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP24_RGB       },
+        { { true,  false, false, 0  }, SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP48_RGB       },
+        { { false, false, true,  0  }, SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP32_RGBA      },
+        { { false, false, false, 0  }, SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP64_RGBA      },
+        { { true,  false, true,  16 }, SAIL_PIXEL_FORMAT_BPP32_RGBA, SAIL_PIXEL_FORMAT_BPP4_INDEXED    },
+        { { true,  false, true,  17 }, SAIL_PIXEL_FORMAT_BPP32_RGBA, SAIL_PIXEL_FORMAT_BPP8_INDEXED    },
+        { { true,  true,  true,  17 }, SAIL_PIXEL_FORMAT_BPP32_RGBA, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE  },
+        { { false, false, true,  4  }, SAIL_PIXEL_FORMAT_BPP32_RGBA, SAIL_PIXEL_FORMAT_BPP32_RGBA      },
+    };
+
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+        munit_assert_int(sail_narrowest_lossless_pixel_format(CASES[i].input_pixel_format,
+                                                              &CASES[i].analysis,
+                                                              PIXEL_FORMATS,
+                                                              PIXEL_FORMATS_LENGTH), ==, CASES[i].expected_pixel_format);
+    }
+
+    /* Translucent premultiplied pixels are not unpremultiplied. */
+    static const enum SailPixelFormat STRAIGHT_PIXEL_FORMATS[] = {
+        SAIL_PIXEL_FORMAT_BPP32_RGBA,
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+    };
+    const struct sail_image_analysis translucent = { false, false, true, 0 };
+
+    munit_assert_int(sail_narrowest_lossless_pixel_format(SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED,
+                                                          &translucent,
+                                                          STRAIGHT_PIXEL_FORMATS,
+                                                          2), ==, SAIL_PIXEL_FORMAT_UNKNOWN);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_for_saving(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const uint8_t COLORS[][4] = {
+        { 0,   0,   0,   255 },
+        { 10,  20,  30,  255 },
+        { 255, 0,   0,   255 },
+        { 1,   2,   3,   255 },
+        { 2,   2,   3,   255 },
+    };
+
+    enum SailPixelFormat pixel_formats[] = {
+        SAIL_PIXEL_FORMAT_BPP32_RGBA,
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+        SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP8_INDEXED,
+    };
+
+    struct sail_write_features write_features;
+    memset(&write_features, 0, sizeof(write_features));
+    write_features.output_pixel_formats        = pixel_formats;
+    write_features.output_pixel_formats_length = sizeof(pixel_formats) / sizeof(pixel_formats[0]);
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    struct sail_image *image = alloc_rgba32_image(37, 11, COLORS, 5);
+    struct sail_image *image_output = NULL;
+
+    /* Without the option, the closest pixel format is picked. */
+    munit_assert(sail_convert_image_for_saving_with_options(image, &write_features, options, &image_output) == SAIL_OK);
+    munit_assert(image_output->pixel_format == sail_closest_pixel_format_from_write_features(image->pixel_format, &write_features));
+    sail_destroy_image(image_output);
+
+    options->options = SAIL_CONVERSION_OPTION_NARROWEST_LOSSLESS;
+    munit_assert(sail_convert_image_for_saving_with_options(image, &write_features, options, &image_output) == SAIL_OK);
+    munit_assert(image_output->pixel_format == SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    munit_assert_uint(image_output->palette->color_count, ==, 5);
+
+    /* Converting back restores the pixels. */
+    struct sail_image *image_rgba = NULL;
+    munit_assert(sail_convert_image(image_output, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_rgba) == SAIL_OK);
+    munit_assert_memory_equal((size_t)image->bytes_per_line * image->height, image_rgba->pixels, image->pixels);
+
+    sail_destroy_image(image_rgba);
+    sail_destroy_image(image_output);
+    sail_destroy_image(image);
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/properties", test_properties, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/indexed", test_indexed, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/narrowest", test_narrowest, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/for-saving", test_for_saving, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/analyze",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -54,6 +54,20 @@ static MunitResult test_best_conversion_grayscale(const MunitParameter params[],
         const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP1_INDEXED, SAIL_PIXEL_FORMAT_BPP2_INDEXED };
         const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
 
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP2_INDEXED);
+    }
+
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP1_INDEXED, SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE);
+    }
+
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP12_I420 };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
         munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_UNKNOWN);
     }
 
@@ -115,6 +129,60 @@ static MunitResult test_best_conversion_rgb(const MunitParameter params[], void
         munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP24_RGB, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
     }
 
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, SAIL_PIXEL_FORMAT_BPP4_INDEXED };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP24_RGB, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP4_INDEXED);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_best_conversion_lossless(const MunitParameter params[], void *user_data) {
+
+    (void)params;
+    (void)user_data;
+
+    /* The input pixel format itself always wins. */
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP8_INDEXED };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP8_INDEXED, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    }
+
+    /* Keep alpha. */
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP64_RGBA };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP32_RGBA, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+    }
+
+    /* Keep precision. */
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP64_RGBA };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP48_RGB, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+    }
+
+    /* Do not premultiply or switch to another color model when not needed. */
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED, SAIL_PIXEL_FORMAT_BPP32_BGRA };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP32_RGBA, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+    }
+
+    {
+        const enum SailPixelFormat output_pixel_formats[] = { SAIL_PIXEL_FORMAT_BPP24_YCBCR, SAIL_PIXEL_FORMAT_BPP24_BGR };
+        const size_t output_pixel_formats_length = sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]);
+
+        munit_assert_int(sail_closest_pixel_format(SAIL_PIXEL_FORMAT_BPP24_RGB, output_pixel_formats, output_pixel_formats_length), ==, SAIL_PIXEL_FORMAT_BPP24_BGR);
+    }
+
     return MUNIT_OK;
 }
 
@@ -122,6 +190,7 @@ static MunitTest test_suite_tests[] = {
     { (char *)"/grayscale", test_best_conversion_grayscale, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/indexed", test_best_conversion_indexed, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
     { (char *)"/rgb", test_best_conversion_rgb, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/lossless", test_best_conversion_lossless, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
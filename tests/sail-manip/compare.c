@@ -0,0 +1,339 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static void assert_identical(const struct sail_image_comparison *comparison) {
+
+    munit_assert_double(comparison->mse, ==, 0);
+    munit_assert(isinf(comparison->psnr));
+    munit_assert_double_equal(comparison->ssim, 1, 12);
+    munit_assert_double(comparison->max_difference, ==, 0);
+}
+
+/* Reference SSIM of two 8-bit gray images. */
+static double reference_ssim(const struct sail_image *image1, const struct sail_image *image2) {
+
+    const unsigned window_width = (image1->width < 8) ? image1->width : 8;
+    const unsigned window_height = (image1->height < 8) ? image1->height : 8;
+    const double c1 = pow(0.01 * 255, 2);
+    const double c2 = pow(0.03 * 255, 2);
+
+    double sum = 0;
+    unsigned windows = 0;
+
+    for (unsigned y0 = 0; y0 + window_height <= image1->height; y0 += 4) {
+        for (unsigned x0 = 0; x0 + window_width <= image1->width; x0 += 4) {
+            double mean_x = 0, mean_y = 0;
+
+            for (unsigned y = y0; y < y0 + window_height; y++) {
+                for (unsigned x = x0; x < x0 + window_width; x++) {
+                    mean_x += ((uint8_t *)image1->pixels)[image1->bytes_per_line * y + x];
+                    mean_y += ((uint8_t *)image2->pixels)[image2->bytes_per_line * y + x];
+                }
+            }
+
+            const double n = (double)window_width * window_height;
+            mean_x /= n;
+            mean_y /= n;
+
+            double variance_x = 0, variance_y = 0, covariance = 0;
+
+            for (unsigned y = y0; y < y0 + window_height; y++) {
+                for (unsigned x = x0; x < x0 + window_width; x++) {
+                    const double dx = ((uint8_t *)image1->pixels)[image1->bytes_per_line * y + x] - mean_x;
+                    const double dy = ((uint8_t *)image2->pixels)[image2->bytes_per_line * y + x] - mean_y;
+
+                    variance_x += dx * dx;
+                    variance_y += dy * dy;
+                    covariance += dx * dy;
+                }
+            }
+
+            variance_x /= n;
+            variance_y /= n;
+            covariance /= n;
+
+            sum += ((2 * mean_x * mean_y + c1) * (2 * covariance + c2))
+                    / ((mean_x * mean_x + mean_y * mean_y + c1) * (variance_x + variance_y + c2));
+            windows++;
+        }
+    }
+
+    return sum / windows;
+}
+
+static MunitResult test_identical(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const enum SailPixelFormat PIXEL_FORMATS[] = {
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+        SAIL_PIXEL_FORMAT_BPP32_BGRX,
+        SAIL_PIXEL_FORMAT_BPP32_ABGR,
+        SAIL_PIXEL_FORMAT_BPP48_BGR,
+        SAIL_PIXEL_FORMAT_BPP64_RGBA,
+        SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT,
+    };
+
+    struct sail_image *image = sail_test_alloc_random_image(45, 27, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    struct sail_image_comparison comparison;
+    munit_assert(sail_compare_images(image, image, &comparison) == SAIL_OK);
+    assert_identical(&comparison);
+
+    /* Lossless conversions don't change the metrics. */
+    for (size_t i = 0; i < sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]); i++) {
+        struct sail_image *converted;
+        munit_assert(sail_convert_image(image, PIXEL_FORMATS[i], &converted) == SAIL_OK);
+
+        munit_assert(sail_compare_images(image, converted, &comparison) == SAIL_OK);
+        assert_identical(&comparison);
+
+        munit_assert(sail_compare_images(converted, image, &comparison) == SAIL_OK);
+        assert_identical(&comparison);
+
+        sail_destroy_image(converted);
+    }
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_known_error(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image1 = sail_test_alloc_random_image(64, 32, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+    for (size_t i = 0; i < (size_t)image1->bytes_per_line * image1->height; i++) {
+        ((uint8_t *)image1->pixels)[i] &= 0x7F;
+    }
+
+    struct sail_image *image2;
+    munit_assert(sail_copy_image(image1, &image2) == SAIL_OK);
+
+    /* 3 pixels differ by 1, 2, and 5. */
+    ((uint8_t *)image2->pixels)[0] += 1;
+    ((uint8_t *)image2->pixels)[100] += 2;
+    ((uint8_t *)image2->pixels)[2000] += 5;
+
+    struct sail_image_comparison comparison;
+    munit_assert(sail_compare_images(image1, image2, &comparison) == SAIL_OK);
+
+    const double mse = (1.0 + 4.0 + 25.0) / (64.0 * 32.0 * 255.0 * 255.0);
+    munit_assert_double_equal(comparison.mse, mse, 12);
+    munit_assert_double_equal(comparison.psnr, 10 * log10(1 / mse), 9);
+    munit_assert_double_equal(comparison.max_difference, 5 / 255.0, 12);
+    munit_assert_double(comparison.ssim, <, 1);
+    munit_assert_double(comparison.ssim, >, 0.99);
+
+    /* 16-bit samples are compared at the same scale. */
+    struct sail_image *image16;
+    munit_assert(sail_convert_image(image2, SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, &image16) == SAIL_OK);
+
+    struct sail_image_comparison comparison16;
+    munit_assert(sail_compare_images(image1, image16, &comparison16) == SAIL_OK);
+    munit_assert_double_equal(comparison16.mse, comparison.mse, 12);
+    munit_assert_double_equal(comparison16.max_difference, comparison.max_difference, 12);
+    munit_assert_double_equal(comparison16.ssim, comparison.ssim, 12);
+
+    sail_destroy_image(image16);
+    sail_destroy_image(image2);
+    sail_destroy_image(image1);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_ssim(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const unsigned SIZES[][2] = { { 61, 37 }, { 8, 8 }, { 5, 3 }, { 12, 1 } };
+
+    for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); i++) {
+        struct sail_image *image1 = sail_test_alloc_random_image(SIZES[i][0], SIZES[i][1], SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+        struct sail_image *image2;
+        munit_assert(sail_copy_image(image1, &image2) == SAIL_OK);
+
+        for (size_t p = 0; p < (size_t)image2->bytes_per_line * image2->height; p++) {
+            uint8_t *sample = (uint8_t *)image2->pixels + p;
+            *sample = (uint8_t)(*sample / 2 + munit_rand_int_range(0, 60));
+        }
+
+        struct sail_image_comparison comparison;
+        munit_assert(sail_compare_images(image1, image2, &comparison) == SAIL_OK);
+        munit_assert_double_equal(comparison.ssim, reference_ssim(image1, image2), 9);
+
+        sail_destroy_image(image2);
+        sail_destroy_image(image1);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_alpha(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *rgb = sail_test_alloc_random_image(16, 16, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    struct sail_image *rgba;
+    munit_assert(sail_convert_image(rgb, SAIL_PIXEL_FORMAT_BPP32_RGBA, &rgba) == SAIL_OK);
+
+    struct sail_image_comparison comparison;
+    munit_assert(sail_compare_images(rgb, rgba, &comparison) == SAIL_OK);
+    assert_identical(&comparison);
+
+    /* Opaque pixel formats have the maximum alpha. */
+    ((uint8_t *)rgba->pixels)[3] = 0;
+
+    munit_assert(sail_compare_images(rgb, rgba, &comparison) == SAIL_OK);
+    munit_assert_double(comparison.max_difference, ==, 1);
+    munit_assert_double_equal(comparison.mse, 1 / (16.0 * 16.0 * 4.0), 12);
+    munit_assert_double_equal(comparison.ssim, 1, 12);
+
+    sail_destroy_image(rgba);
+    sail_destroy_image(rgb);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_region(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image1 = sail_test_alloc_random_image(40, 30, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+
+    struct sail_image *image2;
+    munit_assert(sail_copy_image(image1, &image2) == SAIL_OK);
+
+    /* Pixel (20, 10) differs. */
+    uint8_t *pixel = (uint8_t *)image2->pixels + image2->bytes_per_line * 10 + 20 * 4;
+    pixel[0] ^= 0x10;
+
+    const struct sail_rectangle outside = { 21, 0, 19, 30 };
+    const struct sail_rectangle inside = { 20, 10, 1, 1 };
+
+    struct sail_image_comparison comparison;
+    munit_assert(sail_compare_images_with_options(image1, image2, &outside, NULL, &comparison) == SAIL_OK);
+    assert_identical(&comparison);
+
+    munit_assert(sail_compare_images_with_options(image1, image2, &inside, NULL, &comparison) == SAIL_OK);
+    munit_assert_double_equal(comparison.max_difference, 16 / 255.0, 12);
+    munit_assert_double_equal(comparison.mse, 16.0 * 16.0 / (4 * 255.0 * 255.0), 12);
+
+    sail_destroy_image(image2);
+    sail_destroy_image(image1);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image1 = sail_test_alloc_random_image(611, 433, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+    struct sail_image *image2 = sail_test_alloc_random_image(611, 433, SAIL_PIXEL_FORMAT_BPP16_RGB565);
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    struct sail_image_comparison comparison1;
+    struct sail_image_comparison comparison4;
+
+    options->threads = 1;
+    munit_assert(sail_compare_images_with_options(image1, image2, NULL, options, &comparison1) == SAIL_OK);
+
+    options->threads = 4;
+    munit_assert(sail_compare_images_with_options(image1, image2, NULL, options, &comparison4) == SAIL_OK);
+
+    munit_assert_memory_equal(sizeof(comparison1), &comparison1, &comparison4);
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image2);
+    sail_destroy_image(image1);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_invalid_arguments(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image1 = sail_test_alloc_random_image(8, 8, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    struct sail_image *image2 = sail_test_alloc_random_image(8, 9, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    struct sail_image_comparison comparison;
+    munit_assert(sail_compare_images(image1, image2, &comparison) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_compare_images(image1, image1, NULL) == SAIL_ERROR_NULL_PTR);
+
+    const struct sail_rectangle outside = { 4, 4, 5, 1 };
+    munit_assert(sail_compare_images_with_options(image1, image1, &outside, NULL, &comparison) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+
+    const struct sail_rectangle empty = { 0, 0, 0, 1 };
+    munit_assert(sail_compare_images_with_options(image1, image1, &empty, NULL, &comparison) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+
+    sail_destroy_image(image2);
+    sail_destroy_image(image1);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/identical", test_identical, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/known-error", test_known_error, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/ssim", test_ssim, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/alpha", test_alpha, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/region", test_region, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads", test_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/invalid-arguments", test_invalid_arguments, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/compare",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,380 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+/*
+ * The composite kernels are private, so this test is compiled together with the kernel sources
+ * to verify the SIMD kernels against their portable counterparts.
+ */
+
+static const int SIMD_FEATURE_SETS[] = {
+    SAIL_CPU_FEATURE_SSE2,
+    SAIL_CPU_FEATURE_SSE2 | SAIL_CPU_FEATURE_SSSE3 | SAIL_CPU_FEATURE_AVX2,
+};
+
+static uint8_t* pixel_at(const struct sail_image *image, unsigned x, unsigned y, unsigned bytes_per_pixel) {
+
+    return (uint8_t *)image->pixels + (size_t)image->bytes_per_line * y + (size_t)x * bytes_per_pixel;
+}
+
+static MunitResult test_opaque(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *destination = sail_test_alloc_random_image(37, 11, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    struct sail_image *source      = sail_test_alloc_random_image(37, 11, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    struct sail_image *expected;
+    munit_assert(sail_copy_image(destination, &expected) == SAIL_OK);
+
+    const size_t pixels_size = (size_t)destination->bytes_per_line * destination->height;
+
+    for (size_t i = 0; i < pixels_size; i++) {
+        uint8_t *dst = (uint8_t *)expected->pixels + i;
+        *dst = (uint8_t)((((uint8_t *)source->pixels)[i] * 128 + *dst * 127 + 127) / 255);
+    }
+
+    munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_OVER, 128 / 255.0) == SAIL_OK);
+    munit_assert_memory_equal(pixels_size, destination->pixels, expected->pixels);
+
+    /* Opacity 1 replaces pixels. */
+    munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_SOURCE, 1) == SAIL_OK);
+    munit_assert_memory_equal(pixels_size, destination->pixels, source->pixels);
+
+    sail_destroy_image(expected);
+    sail_destroy_image(source);
+    sail_destroy_image(destination);
+
+    return MUNIT_OK;
+}
+
+static unsigned sample_at(const struct sail_image *image, unsigned x, unsigned y, unsigned c) {
+
+    if (image->pixel_format == SAIL_PIXEL_FORMAT_BPP64_RGBA) {
+        return ((const uint16_t *)pixel_at(image, x, y, 8))[c];
+    } else {
+        return pixel_at(image, x, y, 4)[c];
+    }
+}
+
+static void set_sample_at(struct sail_image *image, unsigned x, unsigned y, unsigned c, unsigned value) {
+
+    if (image->pixel_format == SAIL_PIXEL_FORMAT_BPP64_RGBA) {
+        ((uint16_t *)pixel_at(image, x, y, 8))[c] = (uint16_t)value;
+    } else {
+        pixel_at(image, x, y, 4)[c] = (uint8_t)value;
+    }
+}
+
+static MunitResult test_straight_alpha(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const enum SailPixelFormat PIXEL_FORMATS[] = {
+        SAIL_PIXEL_FORMAT_BPP32_RGBA,
+        SAIL_PIXEL_FORMAT_BPP64_RGBA,
+    };
+
+    for (size_t f = 0; f < sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]); f++) {
+        const uint64_t max = (PIXEL_FORMATS[f] == SAIL_PIXEL_FORMAT_BPP64_RGBA) ? 65535 : 255;
+
+        struct sail_image *destination = sail_test_alloc_random_image(64, 3, PIXEL_FORMATS[f]);
+        struct sail_image *source      = sail_test_alloc_random_image(64, 3, PIXEL_FORMATS[f]);
+
+        /* Rows: a transparent source, an opaque source, an opaque destination. */
+        for (unsigned column = 0; column < 64; column++) {
+            set_sample_at(source, column, 0, 3, 0);
+            set_sample_at(destination, column, 0, 3, sample_at(destination, column, 0, 3) | 1);
+            set_sample_at(source, column, 1, 3, (unsigned)max);
+            set_sample_at(destination, column, 2, 3, (unsigned)max);
+        }
+
+        struct sail_image *original;
+        munit_assert(sail_copy_image(destination, &original) == SAIL_OK);
+
+        munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_OVER, 1) == SAIL_OK);
+
+        for (unsigned column = 0; column < 64; column++) {
+            const uint64_t a = sample_at(source, column, 2, 3);
+
+            for (unsigned c = 0; c < 4; c++) {
+                munit_assert_uint(sample_at(destination, column, 0, c), ==, sample_at(original, column, 0, c));
+                munit_assert_uint(sample_at(destination, column, 1, c), ==, sample_at(source, column, 1, c));
+
+                /* Over an opaque destination: round((src * a + dst * (max - a)) / max). */
+                const uint64_t expected = (c == 3)
+                    ? max
+                    : (sample_at(source, column, 2, c) * a + sample_at(original, column, 2, c) * (max - a) + max / 2) / max;
+                munit_assert_uint(sample_at(destination, column, 2, c), ==, expected);
+            }
+        }
+
+        sail_destroy_image(original);
+        sail_destroy_image(source);
+        sail_destroy_image(destination);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_premultiplied(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Straight and premultiplied compositing produce the same colors. */
+    struct sail_image *destination = sail_test_alloc_random_image(33, 5, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+    struct sail_image *source      = sail_test_alloc_random_image(33, 5, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+
+    struct sail_image *destination_premultiplied;
+    struct sail_image *source_premultiplied;
+    munit_assert(sail_convert_image(destination, SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED, &destination_premultiplied) == SAIL_OK);
+    munit_assert(sail_convert_image(source, SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED, &source_premultiplied) == SAIL_OK);
+
+    munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_OVER, 0.75) == SAIL_OK);
+    munit_assert(sail_composite_image(destination_premultiplied, source_premultiplied, 0, 0, SAIL_COMPOSITE_OVER, 0.75) == SAIL_OK);
+
+    struct sail_image *result;
+    munit_assert(sail_convert_image(destination_premultiplied, SAIL_PIXEL_FORMAT_BPP64_RGBA, &result) == SAIL_OK);
+
+    for (unsigned row = 0; row < destination->height; row++) {
+        for (unsigned column = 0; column < destination->width; column++) {
+            const uint16_t *expected = (const uint16_t *)pixel_at(destination, column, row, 8);
+            const uint16_t *actual   = (const uint16_t *)pixel_at(result, column, row, 8);
+
+            munit_assert_int(abs(actual[3] - expected[3]), <=, 1);
+
+            /* Unpremultiplying faint pixels amplifies the rounding errors. */
+            if (expected[3] >= 1024) {
+                for (unsigned c = 0; c < 3; c++) {
+                    munit_assert_int(abs(actual[c] - expected[c]), <=, 3 * 65535 / expected[3] + 2);
+                }
+            }
+        }
+    }
+
+    sail_destroy_image(result);
+    sail_destroy_image(source_premultiplied);
+    sail_destroy_image(destination_premultiplied);
+    sail_destroy_image(source);
+    sail_destroy_image(destination);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_clip(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *destination = sail_test_alloc_random_image(20, 10, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+    struct sail_image *source      = sail_test_alloc_random_image(8, 8, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    struct sail_image *original;
+    munit_assert(sail_copy_image(destination, &original) == SAIL_OK);
+
+    /* The source covers (-3,-2)-(5,6), the clip covers (2,1)-(12,11). */
+    const struct sail_rectangle clip = { 2, 1, 10, 10 };
+    munit_assert(sail_composite_image_with_options(destination, source, -3, -2, SAIL_COMPOSITE_SOURCE, 1, &clip, NULL) == SAIL_OK);
+
+    for (unsigned row = 0; row < destination->height; row++) {
+        for (unsigned column = 0; column < destination->width; column++) {
+            const bool inside = column >= 2 && column < 5 && row >= 1 && row < 6;
+            const uint8_t *expected = inside ? pixel_at(source, column + 3, row + 2, 4) : pixel_at(original, column, row, 4);
+
+            munit_assert_memory_equal(4, pixel_at(destination, column, row, 4), expected);
+        }
+    }
+
+    /* Nothing to composite. */
+    munit_assert(sail_composite_image(destination, source, 20, 0, SAIL_COMPOSITE_OVER, 1) == SAIL_OK);
+    munit_assert(sail_composite_image(destination, source, -8, 0, SAIL_COMPOSITE_OVER, 1) == SAIL_OK);
+
+    sail_destroy_image(original);
+    sail_destroy_image(source);
+    sail_destroy_image(destination);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *destination1 = sail_test_alloc_random_image(301, 257, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+    struct sail_image *source       = sail_test_alloc_random_image(301, 257, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+
+    struct sail_image *destination4;
+    munit_assert(sail_copy_image(destination1, &destination4) == SAIL_OK);
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    options->threads = 1;
+    munit_assert(sail_composite_image_with_options(destination1, source, 3, -5, SAIL_COMPOSITE_OVER, 0.5, NULL, options) == SAIL_OK);
+
+    options->threads = 4;
+    munit_assert(sail_composite_image_with_options(destination4, source, 3, -5, SAIL_COMPOSITE_OVER, 0.5, NULL, options) == SAIL_OK);
+
+    munit_assert_memory_equal((size_t)destination1->bytes_per_line * destination1->height, destination1->pixels, destination4->pixels);
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(destination4);
+    sail_destroy_image(source);
+    sail_destroy_image(destination1);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_shared_destination(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *destination = sail_test_alloc_random_image(16, 16, SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    struct sail_image *source      = sail_test_alloc_random_image(4, 4, SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 256, &destination->palette) == SAIL_OK);
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 256, &source->palette) == SAIL_OK);
+
+    struct sail_image *shared;
+    munit_assert(sail_share_image(destination, &shared) == SAIL_OK);
+
+    struct sail_image *original;
+    munit_assert(sail_copy_image(destination, &original) == SAIL_OK);
+
+    /* Indexed images can be copied. */
+    munit_assert(sail_composite_image(destination, source, 1, 1, SAIL_COMPOSITE_SOURCE, 1) == SAIL_OK);
+    munit_assert_memory_equal(4, pixel_at(destination, 1, 2, 1), pixel_at(source, 0, 1, 1));
+
+    /* Copy on write. */
+    munit_assert_memory_equal((size_t)shared->bytes_per_line * shared->height, shared->pixels, original->pixels);
+
+    munit_assert(sail_composite_image(destination, source, 1, 1, SAIL_COMPOSITE_OVER, 1) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    sail_destroy_image(original);
+    sail_destroy_image(shared);
+    sail_destroy_image(source);
+    sail_destroy_image(destination);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_invalid_arguments(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *destination = sail_test_alloc_random_image(4, 4, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+    struct sail_image *source      = sail_test_alloc_random_image(4, 4, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+
+    munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_OVER, 1) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    source->pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_OVER, 1.5) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_composite_image(destination, source, 0, 0, SAIL_COMPOSITE_OVER, -0.5) == SAIL_ERROR_INVALID_ARGUMENT);
+
+    sail_destroy_image(source);
+    sail_destroy_image(destination);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_simd_kernels_bit_exact(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const enum CompositeKernel KERNELS[] = {
+        COMPOSITE_KERNEL_LERP8,
+        COMPOSITE_KERNEL_OVER8_ALPHA_FIRST,
+        COMPOSITE_KERNEL_OVER8_ALPHA_LAST,
+    };
+
+    static const unsigned OPACITIES[] = { 0, 1, 127, 128, 254, 255 };
+
+    uint8_t src[4 * 67];
+    uint8_t dst_simd[4 * 67];
+    uint8_t dst_portable[4 * 67];
+
+    for (size_t f = 0; f < sizeof(SIMD_FEATURE_SETS) / sizeof(SIMD_FEATURE_SETS[0]); f++) {
+        if ((detected_cpu_features() & SIMD_FEATURE_SETS[f]) != SIMD_FEATURE_SETS[f]) {
+            continue;
+        }
+
+        for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+            const composite_row_t simd_kernel     = find_composite_kernel_for_cpu(KERNELS[k], SIMD_FEATURE_SETS[f]);
+            const composite_row_t portable_kernel = find_composite_kernel_for_cpu(KERNELS[k], 0);
+
+            const unsigned bytes_per_unit = (KERNELS[k] == COMPOSITE_KERNEL_LERP8) ? 1 : 4;
+
+            for (size_t o = 0; o < sizeof(OPACITIES) / sizeof(OPACITIES[0]); o++) {
+                for (unsigned count = 1; count <= sizeof(src) / bytes_per_unit; count += 7) {
+                    for (size_t i = 0; i < sizeof(src); i++) {
+                        src[i] = (uint8_t)munit_rand_uint32();
+                        dst_simd[i] = dst_portable[i] = (uint8_t)munit_rand_uint32();
+                    }
+
+                    simd_kernel(src, dst_simd, count, OPACITIES[o]);
+                    portable_kernel(src, dst_portable, count, OPACITIES[o]);
+
+                    /* The bytes past the row are untouched too. */
+                    munit_assert_memory_equal(sizeof(src), dst_simd, dst_portable);
+                }
+            }
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/opaque", test_opaque, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/straight-alpha", test_straight_alpha, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/premultiplied", test_premultiplied, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/clip", test_clip, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads", test_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/shared-destination", test_shared_destination, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/invalid-arguments", test_invalid_arguments, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/simd-kernels-bit-exact", test_simd_kernels_bit_exact, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/composite",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
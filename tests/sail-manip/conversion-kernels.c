@@ -0,0 +1,196 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "munit.h"
+
+/*
+ * The SIMD kernels are private, so this test is compiled together with the kernel sources
+ * and verifies every SIMD kernel supported by the current CPU against its portable counterpart.
+ */
+
+static const int SIMD_FEATURE_SETS[] = {
+    SAIL_CPU_FEATURE_SSE2,
+    SAIL_CPU_FEATURE_SSE2 | SAIL_CPU_FEATURE_SSSE3,
+    SAIL_CPU_FEATURE_SSE2 | SAIL_CPU_FEATURE_SSSE3 | SAIL_CPU_FEATURE_AVX2,
+    SAIL_CPU_FEATURE_SSE2 | SAIL_CPU_FEATURE_SSSE3 | SAIL_CPU_FEATURE_AVX2 | SAIL_CPU_FEATURE_F16C,
+    SAIL_CPU_FEATURE_NEON,
+};
+
+static const unsigned WIDTHS[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 257 };
+
+static unsigned bytes_per_pixel(enum SailPixelFormat pixel_format) {
+
+    unsigned bits_per_pixel;
+    munit_assert(sail_bits_per_pixel(pixel_format, &bits_per_pixel) == SAIL_OK);
+
+    return bits_per_pixel / 8;
+}
+
+static void assert_kernels_equal(convert_row_t simd_kernel, convert_row_t portable_kernel,
+                                 unsigned input_bytes_per_pixel, unsigned output_bytes_per_pixel) {
+
+    for (size_t i = 0; i < sizeof(WIDTHS) / sizeof(WIDTHS[0]); i++) {
+        const unsigned width = WIDTHS[i];
+        const size_t input_size = (size_t)width * input_bytes_per_pixel;
+        const size_t output_size = (size_t)width * output_bytes_per_pixel;
+
+        /* One guard byte after the output row catches overruns. */
+        uint8_t *input = malloc(input_size);
+        uint8_t *expected = malloc(output_size + 1);
+        uint8_t *actual = malloc(output_size + 1);
+
+        munit_rand_memory(input_size, input);
+        memset(expected, 0xAB, output_size + 1);
+        memset(actual, 0xAB, output_size + 1);
+
+        portable_kernel(input, expected, width);
+        simd_kernel(input, actual, width);
+
+        munit_assert_memory_equal(output_size + 1, actual, expected);
+
+        /* In-place conversion as done by sail_update_image(). */
+        if (output_bytes_per_pixel <= input_bytes_per_pixel) {
+            uint8_t *in_place = malloc(input_size);
+            memcpy(in_place, input, input_size);
+
+            simd_kernel(in_place, in_place, width);
+
+            munit_assert_memory_equal(output_size, in_place, expected);
+            free(in_place);
+        }
+
+        free(actual);
+        free(expected);
+        free(input);
+    }
+}
+
+static MunitResult test_simd_kernels_bit_exact(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_conversion_options options = { 0 };
+    const int alpha_options[] = { SAIL_CONVERSION_OPTION_DROP_ALPHA, SAIL_CONVERSION_OPTION_BLEND_ALPHA };
+
+    unsigned simd_kernels_tested = 0;
+
+    for (size_t f = 0; f < sizeof(SIMD_FEATURE_SETS) / sizeof(SIMD_FEATURE_SETS[0]); f++) {
+        const int features = SIMD_FEATURE_SETS[f];
+
+        if ((detected_cpu_features() & features) != features) {
+            continue;
+        }
+
+        for (int input = SAIL_PIXEL_FORMAT_UNKNOWN; input <= SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT; input++) {
+            for (int output = SAIL_PIXEL_FORMAT_UNKNOWN; output <= SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT; output++) {
+                for (size_t a = 0; a < sizeof(alpha_options) / sizeof(alpha_options[0]); a++) {
+                    options.options = alpha_options[a];
+
+                    const convert_row_t simd_kernel = find_conversion_kernel_for_cpu(input, output, &options, features);
+                    const convert_row_t portable_kernel = find_conversion_kernel_for_cpu(input, output, &options, 0);
+
+                    if (simd_kernel == portable_kernel) {
+                        continue;
+                    }
+
+                    munit_assert_not_null(portable_kernel);
+
+                    assert_kernels_equal(simd_kernel, portable_kernel, bytes_per_pixel(input), bytes_per_pixel(output));
+                    simd_kernels_tested++;
+                }
+            }
+        }
+    }
+
+    if (simd_kernels_tested == 0) {
+        return MUNIT_SKIP;
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_narrowing_boundaries(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* All 16-bit values through every available BPP16-GRAYSCALE -> BPP8-GRAYSCALE kernel. */
+    uint16_t *input = malloc(65536 * sizeof(uint16_t));
+    uint8_t *output = malloc(65536);
+
+    for (unsigned i = 0; i < 65536; i++) {
+        input[i] = (uint16_t)i;
+    }
+
+    for (size_t f = 0; f < sizeof(SIMD_FEATURE_SETS) / sizeof(SIMD_FEATURE_SETS[0]) + 1; f++) {
+        const int features = f == 0 ? 0 : SIMD_FEATURE_SETS[f - 1];
+
+        if ((detected_cpu_features() & features) != features) {
+            continue;
+        }
+
+        const convert_row_t kernel = find_conversion_kernel_for_cpu(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE,
+                                                                    SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+                                                                    NULL,
+                                                                    features);
+        munit_assert_not_null(kernel);
+
+        kernel(input, output, 65536);
+
+        for (unsigned i = 0; i < 65536; i++) {
+            munit_assert_uint8(output[i], ==, (uint8_t)(i / 257.0));
+        }
+    }
+
+    free(output);
+    free(input);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/simd-bit-exact", test_simd_kernels_bit_exact, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/narrowing-boundaries", test_narrowing_boundaries, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/conversion-kernels",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
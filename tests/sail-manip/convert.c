@@ -0,0 +1,750 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static void assert_conversion(enum SailPixelFormat input_pixel_format, const void *input,
+                              enum SailPixelFormat output_pixel_format, const void *expected,
+                              const struct sail_conversion_options *options) {
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(2, 2, input_pixel_format, input);
+
+    struct sail_image *image_output = NULL;
+    munit_assert(sail_convert_image_with_options(image, output_pixel_format, options, &image_output) == SAIL_OK);
+    munit_assert(image_output->pixel_format == output_pixel_format);
+
+    munit_assert_memory_equal(image_output->bytes_per_line * image_output->height, image_output->pixels, expected);
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image);
+}
+
+static MunitResult test_rgb24_to_rgba32(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t bgr24[] = { 1, 2, 3,  4, 5, 6,  7, 8, 9,  10, 11, 12 };
+
+    {
+        const uint8_t rgba32[] = { 3, 2, 1, 255,  6, 5, 4, 255,  9, 8, 7, 255,  12, 11, 10, 255 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP24_BGR, bgr24, SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32, NULL);
+    }
+
+    {
+        const uint8_t argb32[] = { 255, 1, 2, 3,  255, 4, 5, 6,  255, 7, 8, 9,  255, 10, 11, 12 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP24_RGB, bgr24, SAIL_PIXEL_FORMAT_BPP32_ARGB, argb32, NULL);
+    }
+
+    {
+        const uint8_t rgb24[] = { 3, 2, 1,  6, 5, 4,  9, 8, 7,  12, 11, 10 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP24_BGR, bgr24, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rgba32_swizzle(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t rgba32[] = { 1, 2, 3, 4,  5, 6, 7, 8,  9, 10, 11, 12,  13, 14, 15, 16 };
+
+    {
+        const uint8_t bgra32[] = { 3, 2, 1, 4,  7, 6, 5, 8,  11, 10, 9, 12,  15, 14, 13, 16 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32, SAIL_PIXEL_FORMAT_BPP32_BGRA, bgra32, NULL);
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP32_BGRA, bgra32, SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32, NULL);
+    }
+
+    {
+        /* X is replaced with an opaque alpha. */
+        const uint8_t abgr32[] = { 255, 3, 2, 1,  255, 7, 6, 5,  255, 11, 10, 9,  255, 15, 14, 13 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP32_RGBX, rgba32, SAIL_PIXEL_FORMAT_BPP32_ABGR, abgr32, NULL);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rgba32_to_rgb24(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t rgba32[] = { 10, 20, 30, 255,  10, 20, 30, 0,  100, 100, 100, 255,  200, 0, 200, 0 };
+
+    {
+        const uint8_t rgb24[] = { 10, 20, 30,  10, 20, 30,  100, 100, 100,  200, 0, 200 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+    }
+
+    {
+        struct sail_conversion_options *options = NULL;
+        munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+        options->options      = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+        options->background24 = (sail_rgb24_t){ 1, 2, 3 };
+
+        /* Transparent pixels are replaced with the background. */
+        const uint8_t bgr24[] = { 30, 20, 10,  3, 2, 1,  100, 100, 100,  3, 2, 1 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32, SAIL_PIXEL_FORMAT_BPP24_BGR, bgr24, options);
+
+        sail_destroy_conversion_options(options);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_gray8_to_rgb(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t gray8[] = { 0, 1, 128, 255 };
+
+    {
+        const uint8_t rgb24[] = { 0, 0, 0,  1, 1, 1,  128, 128, 128,  255, 255, 255 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+    }
+
+    {
+        const uint8_t bgra32[] = { 0, 0, 0, 255,  1, 1, 1, 255,  128, 128, 128, 255,  255, 255, 255, 255 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8, SAIL_PIXEL_FORMAT_BPP32_BGRA, bgra32, NULL);
+    }
+
+    return MUNIT_OK;
+}
+
+static struct sail_image* alloc_indexed_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format, const void *pixels,
+                                              enum SailPixelFormat palette_pixel_format, const void *palette_data, unsigned color_count) {
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(width, height, pixel_format, pixels);
+    munit_assert(sail_alloc_palette_from_data(palette_pixel_format, palette_data, color_count, &image->palette) == SAIL_OK);
+
+    return image;
+}
+
+static void assert_indexed_conversion(struct sail_image *image, enum SailPixelFormat output_pixel_format, const void *expected,
+                                      const struct sail_conversion_options *options) {
+
+    struct sail_image *image_output = NULL;
+    munit_assert(sail_convert_image_with_options(image, output_pixel_format, options, &image_output) == SAIL_OK);
+
+    for (unsigned row = 0; row < image_output->height; row++) {
+        const unsigned row_length = image_output->bytes_per_line;
+
+        munit_assert_memory_equal(row_length,
+                                  (uint8_t *)image_output->pixels + row * row_length,
+                                  (const uint8_t *)expected + row * row_length);
+    }
+
+    sail_destroy_image(image_output);
+}
+
+static MunitResult test_indexed(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t palette_rgb24[] = { 10, 20, 30,  40, 50, 60,  70, 80, 90 };
+
+    {
+        /* 3 pixels per row. The last nibble of every row is padding and must be ignored. */
+        const uint8_t bpp4[] = { 0x01, 0x2F,  0x21, 0x0F };
+        struct sail_image *image = alloc_indexed_image(3, 2, SAIL_PIXEL_FORMAT_BPP4_INDEXED, bpp4,
+                                                       SAIL_PIXEL_FORMAT_BPP24_RGB, palette_rgb24, 3);
+
+        const uint8_t bgra32[] = { 30, 20, 10, 255,  60, 50, 40, 255,  90, 80, 70, 255,
+                                   90, 80, 70, 255,  60, 50, 40, 255,  30, 20, 10, 255 };
+        assert_indexed_conversion(image, SAIL_PIXEL_FORMAT_BPP32_BGRA, bgra32, NULL);
+
+        const uint8_t rgb24[] = { 10, 20, 30,  40, 50, 60,  70, 80, 90,
+                                  70, 80, 90,  40, 50, 60,  10, 20, 30 };
+        assert_indexed_conversion(image, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+
+        sail_destroy_image(image);
+    }
+
+    {
+        /* 10 pixels per row span two bytes. */
+        const uint8_t bpp1[] = { 0xA5, 0x80 };
+        struct sail_image *image = alloc_indexed_image(10, 1, SAIL_PIXEL_FORMAT_BPP1_INDEXED, bpp1,
+                                                       SAIL_PIXEL_FORMAT_BPP24_RGB, palette_rgb24, 2);
+
+        const uint8_t rgb24[] = { 40, 50, 60,  10, 20, 30,  40, 50, 60,  10, 20, 30,  10, 20, 30,
+                                  40, 50, 60,  10, 20, 30,  40, 50, 60,  40, 50, 60,  10, 20, 30 };
+        assert_indexed_conversion(image, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+
+        sail_destroy_image(image);
+    }
+
+    {
+        /* Grayscale levels are spread to the full 8-bit range. */
+        const uint8_t bpp2[] = { 0x1B };
+        struct sail_image *image = sail_test_alloc_image_from_pixels(4, 1, SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE, bpp2);
+
+        const uint8_t rgb24[] = { 0, 0, 0,  85, 85, 85,  170, 170, 170,  255, 255, 255 };
+        assert_indexed_conversion(image, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+
+        sail_destroy_image(image);
+    }
+
+    {
+        /* RGBA palettes are blended with the background. */
+        const uint8_t palette_rgba32[] = { 10, 20, 30, 255,  40, 50, 60, 0 };
+        const uint8_t bpp8[] = { 1, 0, 0, 1 };
+        struct sail_image *image = alloc_indexed_image(2, 2, SAIL_PIXEL_FORMAT_BPP8_INDEXED, bpp8,
+                                                       SAIL_PIXEL_FORMAT_BPP32_RGBA, palette_rgba32, 2);
+
+        struct sail_conversion_options *options = NULL;
+        munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+        options->options      = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+        options->background24 = (sail_rgb24_t){ 1, 2, 3 };
+
+        const uint8_t rgb24[] = { 1, 2, 3,  10, 20, 30,  10, 20, 30,  1, 2, 3 };
+        assert_indexed_conversion(image, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, options);
+
+        sail_destroy_conversion_options(options);
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_indexed_out_of_range(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t palette_rgb24[] = { 10, 20, 30,  40, 50, 60,  70, 80, 90 };
+    struct sail_image *image_output = NULL;
+
+    {
+        const uint8_t bpp8[] = { 0, 1, 2, 3 };
+        struct sail_image *image = alloc_indexed_image(2, 2, SAIL_PIXEL_FORMAT_BPP8_INDEXED, bpp8,
+                                                       SAIL_PIXEL_FORMAT_BPP24_RGB, palette_rgb24, 3);
+
+        munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_output) == SAIL_ERROR_BROKEN_IMAGE);
+        munit_assert_null(image_output);
+
+        sail_destroy_image(image);
+    }
+
+    {
+        const uint8_t bpp2[] = { 0x03 };
+        struct sail_image *image = alloc_indexed_image(4, 1, SAIL_PIXEL_FORMAT_BPP2_INDEXED, bpp2,
+                                                       SAIL_PIXEL_FORMAT_BPP24_RGB, palette_rgb24, 3);
+
+        munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP24_BGR, &image_output) == SAIL_ERROR_BROKEN_IMAGE);
+        munit_assert_null(image_output);
+
+        sail_destroy_image(image);
+    }
+
+    /* Broken images converted in place with multiple threads stay untouched. */
+    {
+        const unsigned width = 1000;
+        const unsigned height = 700;
+
+        uint8_t *bpp8 = malloc((size_t)width * height);
+
+        for (size_t i = 0; i < (size_t)width * height; i++) {
+            bpp8[i] = (uint8_t)(i % 3);
+        }
+
+        bpp8[(size_t)width * height - 1] = 3;
+
+        struct sail_image *image = alloc_indexed_image(width, height, SAIL_PIXEL_FORMAT_BPP8_INDEXED, bpp8,
+                                                       SAIL_PIXEL_FORMAT_BPP24_RGB, palette_rgb24, 3);
+
+        struct sail_conversion_options *options = NULL;
+        munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+        options->threads = 4;
+
+        munit_assert(sail_update_image_with_options(image, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, options) == SAIL_ERROR_BROKEN_IMAGE);
+        munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+        munit_assert_memory_equal((size_t)width * height, image->pixels, bpp8);
+
+        sail_destroy_conversion_options(options);
+        sail_destroy_image(image);
+        free(bpp8);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_plan(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    {
+        struct sail_conversion_options *options = NULL;
+        munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+        options->options      = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+        options->background24 = (sail_rgb24_t){ 1, 2, 3 };
+
+        struct sail_conversion_plan *plan = NULL;
+        munit_assert(sail_alloc_conversion_plan(SAIL_PIXEL_FORMAT_BPP32_RGBA, NULL, SAIL_PIXEL_FORMAT_BPP24_BGR, options, &plan) == SAIL_OK);
+
+        /* The options are copied into the plan. */
+        sail_destroy_conversion_options(options);
+
+        const uint8_t rgba32[] = { 10, 20, 30, 255,  10, 20, 30, 0,  100, 100, 100, 255,  200, 0, 200, 0 };
+        const uint8_t bgr24[] = { 30, 20, 10,  3, 2, 1,  100, 100, 100,  3, 2, 1 };
+
+        struct sail_image *image = sail_test_alloc_image_from_pixels(2, 2, SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32);
+        struct sail_image *image_output = sail_test_alloc_image_from_pixels(2, 2, SAIL_PIXEL_FORMAT_BPP24_BGR, bgr24);
+
+        /* The same output image is reused for every frame. */
+        for (int frame = 0; frame < 3; frame++) {
+            memset(image_output->pixels, 0, image_output->bytes_per_line * image_output->height);
+
+            munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_OK);
+            munit_assert_memory_equal(sizeof(bgr24), image_output->pixels, bgr24);
+        }
+
+        /* Mismatched pixel formats and dimensions. */
+        image_output->pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;
+        munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_ERROR_INVALID_PIXEL_FORMAT);
+        image_output->pixel_format = SAIL_PIXEL_FORMAT_BPP24_BGR;
+
+        image_output->height = 1;
+        munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+        image_output->height = 2;
+
+        image_output->bytes_per_line = 5;
+        munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_ERROR_INCORRECT_BYTES_PER_LINE);
+
+        sail_destroy_image(image_output);
+        sail_destroy_image(image);
+        sail_destroy_conversion_plan(plan);
+    }
+
+    {
+        /* The palette is expanded into the plan, so indexed images don't need it. */
+        const uint8_t palette_rgb24[] = { 10, 20, 30,  40, 50, 60 };
+
+        struct sail_palette *palette = NULL;
+        munit_assert(sail_alloc_palette_from_data(SAIL_PIXEL_FORMAT_BPP24_RGB, palette_rgb24, 2, &palette) == SAIL_OK);
+
+        struct sail_conversion_plan *plan = NULL;
+        munit_assert(sail_alloc_conversion_plan(SAIL_PIXEL_FORMAT_BPP8_INDEXED, NULL, SAIL_PIXEL_FORMAT_BPP32_RGBA, NULL, &plan) == SAIL_ERROR_PALETTE_NULL_PTR);
+        munit_assert(sail_alloc_conversion_plan(SAIL_PIXEL_FORMAT_BPP8_INDEXED, palette, SAIL_PIXEL_FORMAT_BPP32_RGBA, NULL, &plan) == SAIL_OK);
+
+        sail_destroy_palette(palette);
+
+        const uint8_t bpp8[] = { 1, 0, 0, 1 };
+        const uint8_t rgba32[] = { 40, 50, 60, 255,  10, 20, 30, 255,  10, 20, 30, 255,  40, 50, 60, 255 };
+
+        struct sail_image *image = sail_test_alloc_image_from_pixels(2, 2, SAIL_PIXEL_FORMAT_BPP8_INDEXED, bpp8);
+        struct sail_image *image_output = sail_test_alloc_image_from_pixels(2, 2, SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32);
+        memset(image_output->pixels, 0, sizeof(rgba32));
+
+        munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_OK);
+        munit_assert_memory_equal(sizeof(rgba32), image_output->pixels, rgba32);
+
+        /* Out of range indexes are still detected. */
+        ((uint8_t *)image->pixels)[3] = 2;
+        munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_ERROR_BROKEN_IMAGE);
+
+        sail_destroy_image(image_output);
+        sail_destroy_image(image);
+        sail_destroy_conversion_plan(plan);
+    }
+
+    {
+        struct sail_conversion_plan *plan = NULL;
+        munit_assert(sail_alloc_conversion_plan(SAIL_PIXEL_FORMAT_BPP32_RGBA, NULL, SAIL_PIXEL_FORMAT_BPP32_CMYK, NULL, &plan) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+        munit_assert_null(plan);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_16bit_to_8bit(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    {
+        const uint16_t gray16[] = { 0, 256, 257, 65535 };
+        const uint8_t gray8[] = { 0, 0, 1, 255 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, gray16, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8, NULL);
+    }
+
+    {
+        const uint16_t bgr48[] = { 0, 257, 514,  65535, 65534, 65280,  771, 1028, 1285,  256, 0, 65535 };
+        const uint8_t rgb24[] = { 2, 1, 0,  254, 254, 255,  5, 4, 3,  255, 0, 0 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP48_BGR, bgr48, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24, NULL);
+    }
+
+    {
+        const uint16_t rgba64[] = { 0, 257, 514, 65535,  65535, 65534, 65280, 0,  771, 1028, 1285, 1542,  256, 0, 65535, 32768 };
+        const uint8_t bgra32[] = { 2, 1, 0, 255,  254, 254, 255, 0,  5, 4, 3, 6,  255, 0, 0, 127 };
+        assert_conversion(SAIL_PIXEL_FORMAT_BPP64_RGBA, rgba64, SAIL_PIXEL_FORMAT_BPP32_BGRA, bgra32, NULL);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_update_in_place(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t rgba32[] = { 1, 2, 3, 4,  5, 6, 7, 8,  9, 10, 11, 12,  13, 14, 15, 16 };
+    const uint8_t bgr24[] = { 3, 2, 1,  7, 6, 5,  11, 10, 9,  15, 14, 13 };
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(4, 1, SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32);
+
+    munit_assert(sail_update_image(image, SAIL_PIXEL_FORMAT_BPP24_BGR) == SAIL_OK);
+    munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP24_BGR);
+    munit_assert_memory_equal(sizeof(bgr24), image->pixels, bgr24);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Large enough to be split into multiple bands. */
+    const unsigned width = 1000;
+    const unsigned height = 700;
+
+    uint8_t *rgba32 = malloc((size_t)width * height * 4);
+    munit_rand_memory((size_t)width * height * 4, rgba32);
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(width, height, SAIL_PIXEL_FORMAT_BPP32_RGBA, rgba32);
+    free(rgba32);
+
+    struct sail_conversion_options *options = NULL;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options      = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    options->background24 = (sail_rgb24_t){ 1, 2, 3 };
+    options->dither       = SAIL_DITHER_ORDERED;
+
+    /* Specialized kernel, generic, and low-bit conversions. */
+    const enum SailPixelFormat output_pixel_formats[] = {
+        SAIL_PIXEL_FORMAT_BPP32_BGRA,
+        SAIL_PIXEL_FORMAT_BPP24_RGB,
+        SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP4_INDEXED,
+    };
+    const unsigned threads[] = { 0, 2, 7, SAIL_THREADS_AUTO };
+
+    for (size_t i = 0; i < sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]); i++) {
+        struct sail_image *expected = NULL;
+        options->threads = 1;
+        munit_assert(sail_convert_image_with_options(image, output_pixel_formats[i], options, &expected) == SAIL_OK);
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            struct sail_image *actual = NULL;
+            options->threads = threads[t];
+            munit_assert(sail_convert_image_with_options(image, output_pixel_formats[i], options, &actual) == SAIL_OK);
+
+            munit_assert_memory_equal((size_t)expected->bytes_per_line * height, actual->pixels, expected->pixels);
+
+            /* In place. */
+            struct sail_image *updated = NULL;
+            munit_assert(sail_copy_image(image, &updated) == SAIL_OK);
+            munit_assert(sail_update_image_with_options(updated, output_pixel_formats[i], options) == SAIL_OK);
+
+            for (unsigned row = 0; row < height; row++) {
+                munit_assert_memory_equal(expected->bytes_per_line,
+                                          (uint8_t *)updated->pixels + (size_t)updated->bytes_per_line * row,
+                                          (uint8_t *)expected->pixels + (size_t)expected->bytes_per_line * row);
+            }
+
+            sail_destroy_image(updated);
+            sail_destroy_image(actual);
+        }
+
+        sail_destroy_image(expected);
+    }
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_low_bit_threshold(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* 10 pixels to test full and partial output bytes. */
+    const uint8_t gray8[] = { 0, 42, 43, 127, 128, 212, 213, 255, 255, 0 };
+
+    const uint8_t gray1[] = { 0x0F, 0x80 };
+    const uint8_t gray2[] = { 0x05, 0xAF, 0xC0 };
+    const uint8_t gray4[] = { 0x02, 0x37, 0x8C, 0xDF, 0xF0 };
+
+    const enum SailPixelFormat output_pixel_formats[] = {
+        SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP2_GRAYSCALE,
+        SAIL_PIXEL_FORMAT_BPP4_GRAYSCALE,
+    };
+    const uint8_t *expected[] = { gray1, gray2, gray4 };
+    const size_t expected_sizes[] = { sizeof(gray1), sizeof(gray2), sizeof(gray4) };
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(10, 1, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8);
+
+    for (size_t i = 0; i < sizeof(output_pixel_formats) / sizeof(output_pixel_formats[0]); i++) {
+        munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, output_pixel_formats[i]));
+
+        struct sail_image *image_output = NULL;
+        munit_assert(sail_convert_image(image, output_pixel_formats[i], &image_output) == SAIL_OK);
+        munit_assert(image_output->pixel_format == output_pixel_formats[i]);
+        munit_assert(image_output->bytes_per_line == expected_sizes[i]);
+        munit_assert_null(image_output->palette);
+        munit_assert_memory_equal(expected_sizes[i], image_output->pixels, expected[i]);
+
+        sail_destroy_image(image_output);
+    }
+
+    sail_destroy_image(image);
+
+    /* Planar pixel formats are not supported. */
+    munit_assert(!sail_can_convert(SAIL_PIXEL_FORMAT_BPP12_I420, SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_low_bit_ordered_dither(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_conversion_options *options = NULL;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->dither = SAIL_DITHER_ORDERED;
+
+    /* The share of white pixels in a dithered 8x8 block matches the gray level. */
+    const uint8_t levels[]      = { 0, 64, 128, 192, 255 };
+    const unsigned white_bits[] = { 0, 16,  32,  48,  64 };
+
+    uint8_t gray8[64];
+
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        memset(gray8, levels[i], sizeof(gray8));
+        struct sail_image *image = sail_test_alloc_image_from_pixels(8, 8, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8);
+
+        struct sail_image *image_output = NULL;
+        munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, options, &image_output) == SAIL_OK);
+        munit_assert(image_output->bytes_per_line == 1);
+
+        unsigned bits = 0;
+
+        for (unsigned row = 0; row < 8; row++) {
+            for (uint8_t byte = ((uint8_t *)image_output->pixels)[row]; byte != 0; byte &= (uint8_t)(byte - 1)) {
+                bits++;
+            }
+        }
+
+        munit_assert_uint(bits, ==, white_bits[i]);
+
+        sail_destroy_image(image_output);
+        sail_destroy_image(image);
+    }
+
+    /* Rows are converted independently, so Floyd-Steinberg falls back to ordered dithering. */
+    memset(gray8, 128, sizeof(gray8));
+    struct sail_image *image = sail_test_alloc_image_from_pixels(8, 8, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8);
+    struct sail_image *image_ordered = NULL;
+    struct sail_image *image_output = NULL;
+
+    options->dither = SAIL_DITHER_ORDERED;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, options, &image_ordered) == SAIL_OK);
+
+    options->dither = SAIL_DITHER_FLOYD_STEINBERG;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, options, &image_output) == SAIL_OK);
+    munit_assert_memory_equal(8, image_output->pixels, image_ordered->pixels);
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_ordered);
+    sail_destroy_image(image);
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_low_bit_indexed(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Grayscale images are packed. */
+    const uint8_t gray8_input[] = { 0, 90, 160, 255, 20 };
+    const uint8_t indexes[] = { 0x1B, 0x00 };
+    const uint8_t gray8[] = { 0, 85, 170, 255, 0 };
+    const uint8_t palette[] = { 0, 0, 0,  85, 85, 85,  170, 170, 170,  255, 255, 255 };
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(5, 1, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8_input);
+
+    struct sail_image *image_output = NULL;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP2_INDEXED, &image_output) == SAIL_OK);
+    munit_assert(image_output->pixel_format == SAIL_PIXEL_FORMAT_BPP2_INDEXED);
+    munit_assert_memory_equal(sizeof(indexes), image_output->pixels, indexes);
+
+    /* Evenly spaced gray levels. */
+    munit_assert_not_null(image_output->palette);
+    munit_assert(image_output->palette->pixel_format == SAIL_PIXEL_FORMAT_BPP24_RGB);
+    munit_assert_uint(image_output->palette->color_count, ==, 4);
+    munit_assert_memory_equal(sizeof(palette), image_output->palette->data, palette);
+
+    /* Back to gray. */
+    struct sail_image *image_gray = NULL;
+    munit_assert(sail_convert_image(image_output, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, &image_gray) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(gray8), image_gray->pixels, gray8);
+    sail_destroy_image(image_gray);
+
+    /* Plan. */
+    struct sail_conversion_plan *plan = NULL;
+    munit_assert(sail_alloc_conversion_plan(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, NULL, SAIL_PIXEL_FORMAT_BPP2_INDEXED, NULL, &plan) == SAIL_OK);
+
+    memset(image_output->pixels, 0xFF, image_output->bytes_per_line);
+    munit_assert(sail_convert_image_with_plan(image, plan, image_output) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(indexes), image_output->pixels, indexes);
+
+    sail_destroy_conversion_plan(plan);
+    sail_destroy_image(image_output);
+
+    /* In place. The palette is replaced. */
+    munit_assert(sail_update_image(image, SAIL_PIXEL_FORMAT_BPP2_INDEXED) == SAIL_OK);
+    munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP2_INDEXED);
+    munit_assert_memory_equal(sizeof(indexes), image->pixels, indexes);
+    munit_assert_not_null(image->palette);
+    munit_assert_memory_equal(sizeof(palette), image->palette->data, palette);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+/* Every output pixel must have the color of the input pixel. */
+static void assert_same_colors(const struct sail_image *image, const struct sail_image *image_output) {
+
+    struct sail_image *image_rgb24 = NULL;
+    struct sail_image *image_output_rgb24 = NULL;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP24_RGB, &image_rgb24) == SAIL_OK);
+    munit_assert(sail_convert_image(image_output, SAIL_PIXEL_FORMAT_BPP24_RGB, &image_output_rgb24) == SAIL_OK);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        munit_assert_memory_equal((size_t)image->width * 3,
+                                  (uint8_t *)image_output_rgb24->pixels + (size_t)image_output_rgb24->bytes_per_line * row,
+                                  (uint8_t *)image_rgb24->pixels + (size_t)image_rgb24->bytes_per_line * row);
+    }
+
+    sail_destroy_image(image_output_rgb24);
+    sail_destroy_image(image_rgb24);
+}
+
+static MunitResult test_quantized_indexed(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Color images keep their colors. */
+    const uint8_t rgb24[] = { 255, 0, 0,  0, 255, 0,  0, 0, 255,  255, 0, 0,  200, 100, 50 };
+
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP4_INDEXED));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP8_INDEXED));
+    munit_assert(!sail_can_convert_with_plan(SAIL_PIXEL_FORMAT_BPP24_RGB, SAIL_PIXEL_FORMAT_BPP4_INDEXED));
+    munit_assert(sail_can_convert_with_plan(SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, SAIL_PIXEL_FORMAT_BPP4_INDEXED));
+
+    struct sail_image *image = sail_test_alloc_image_from_pixels(5, 1, SAIL_PIXEL_FORMAT_BPP24_RGB, rgb24);
+
+    struct sail_image *image_output = NULL;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP4_INDEXED, &image_output) == SAIL_OK);
+    munit_assert(image_output->pixel_format == SAIL_PIXEL_FORMAT_BPP4_INDEXED);
+    munit_assert_not_null(image_output->palette);
+    munit_assert(image_output->palette->pixel_format == SAIL_PIXEL_FORMAT_BPP24_RGB);
+    munit_assert_uint(image_output->palette->color_count, ==, 4);
+    assert_same_colors(image, image_output);
+
+    /* Indexed images keep their palette colors. */
+    struct sail_image *image_indexed = NULL;
+    munit_assert(sail_convert_image(image_output, SAIL_PIXEL_FORMAT_BPP8_INDEXED, &image_indexed) == SAIL_OK);
+    munit_assert(image_indexed->pixel_format == SAIL_PIXEL_FORMAT_BPP8_INDEXED);
+    munit_assert_uint(image_indexed->palette->color_count, ==, 4);
+    assert_same_colors(image, image_indexed);
+    sail_destroy_image(image_indexed);
+    sail_destroy_image(image_output);
+
+    /* Quantizing needs the whole image. */
+    struct sail_conversion_plan *plan = NULL;
+    munit_assert(sail_alloc_conversion_plan(SAIL_PIXEL_FORMAT_BPP24_RGB, NULL, SAIL_PIXEL_FORMAT_BPP4_INDEXED, NULL, &plan)
+                    == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert_null(plan);
+
+    /* In place. */
+    struct sail_image *image_updated = NULL;
+    munit_assert(sail_copy_image(image, &image_updated) == SAIL_OK);
+    munit_assert(sail_update_image(image_updated, SAIL_PIXEL_FORMAT_BPP2_INDEXED) == SAIL_OK);
+    munit_assert(image_updated->pixel_format == SAIL_PIXEL_FORMAT_BPP2_INDEXED);
+    munit_assert_uint(image_updated->palette->color_count, ==, 4);
+    munit_assert_uint(image_updated->bytes_per_line, ==, image->bytes_per_line);
+    assert_same_colors(image, image_updated);
+    sail_destroy_image(image_updated);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/rgb24-to-rgba32", test_rgb24_to_rgba32, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rgba32-swizzle",  test_rgba32_swizzle,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rgba32-to-rgb24", test_rgba32_to_rgb24, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/gray8-to-rgb",    test_gray8_to_rgb,    NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/indexed",         test_indexed,         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/indexed-out-of-range", test_indexed_out_of_range, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/16bit-to-8bit",   test_16bit_to_8bit,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/update-in-place", test_update_in_place, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads",         test_threads,         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/plan",            test_plan,            NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/low-bit-threshold",      test_low_bit_threshold,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/low-bit-ordered-dither", test_low_bit_ordered_dither, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/low-bit-indexed",        test_low_bit_indexed,        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/quantized-indexed",      test_quantized_indexed,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/convert",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,449 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static const enum SailEdgeMode EDGE_MODES[] = {
+    SAIL_EDGE_MODE_CLAMP,
+    SAIL_EDGE_MODE_MIRROR,
+    SAIL_EDGE_MODE_WRAP,
+    SAIL_EDGE_MODE_ZERO,
+};
+
+static const size_t EDGE_MODES_LENGTH = sizeof(EDGE_MODES) / sizeof(EDGE_MODES[0]);
+
+static const enum SailPixelFormat PIXEL_FORMATS[] = {
+    SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+    SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_ALPHA,
+    SAIL_PIXEL_FORMAT_BPP16_RGB565,
+    SAIL_PIXEL_FORMAT_BPP24_BGR,
+    SAIL_PIXEL_FORMAT_BPP48_RGB,
+    SAIL_PIXEL_FORMAT_BPP32_RGBA,
+    SAIL_PIXEL_FORMAT_BPP64_ABGR_PREMULTIPLIED,
+};
+
+static const size_t PIXEL_FORMATS_LENGTH = sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]);
+
+static void assert_images_equal(const struct sail_image *image1, const struct sail_image *image2) {
+
+    munit_assert_uint(image1->width, ==, image2->width);
+    munit_assert_uint(image1->height, ==, image2->height);
+    munit_assert_int(image1->pixel_format, ==, image2->pixel_format);
+    munit_assert_uint(image1->bytes_per_line, ==, image2->bytes_per_line);
+    munit_assert_memory_equal((size_t)image1->bytes_per_line * image1->height, image1->pixels, image2->pixels);
+}
+
+/* Reference edge handling. Returns -1 for zeros. */
+static int reference_index(int index, int size, enum SailEdgeMode edge_mode) {
+
+    if (index >= 0 && index < size) {
+        return index;
+    }
+
+    switch (edge_mode) {
+        case SAIL_EDGE_MODE_CLAMP: {
+            return (index < 0) ? 0 : size - 1;
+        }
+        case SAIL_EDGE_MODE_MIRROR: {
+            while (index < 0 || index >= size) {
+                index = (index < 0) ? -index : 2 * (size - 1) - index;
+            }
+            return index;
+        }
+        case SAIL_EDGE_MODE_WRAP: {
+            return ((index % size) + size) % size;
+        }
+        default: {
+            return -1;
+        }
+    }
+}
+
+static unsigned reference_pixel(const struct sail_image *image, int x, int y, enum SailEdgeMode edge_mode) {
+
+    x = reference_index(x, (int)image->width, edge_mode);
+    y = reference_index(y, (int)image->height, edge_mode);
+
+    return (x < 0 || y < 0) ? 0 : ((const uint8_t *)image->pixels)[(size_t)image->bytes_per_line * y + x];
+}
+
+static MunitResult test_identity(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const double IDENTITY[] = { 0, 0, 1, 0, 0 };
+
+    for (size_t i = 0; i < PIXEL_FORMATS_LENGTH; i++) {
+        for (size_t e = 0; e < EDGE_MODES_LENGTH; e++) {
+            struct sail_image *image = sail_test_alloc_random_image(37, 13, PIXEL_FORMATS[i]);
+
+            struct sail_image *convolved;
+            munit_assert(sail_convolve_image_with_options(image, IDENTITY, 5, IDENTITY + 1, 3, EDGE_MODES[e], NULL, &convolved) == SAIL_OK);
+            assert_images_equal(convolved, image);
+            sail_destroy_image(convolved);
+
+            struct sail_image *blurred;
+            munit_assert(sail_box_blur_image_with_options(image, 0, EDGE_MODES[e], NULL, &blurred) == SAIL_OK);
+            assert_images_equal(blurred, image);
+            sail_destroy_image(blurred);
+
+            struct sail_image *sharpened;
+            munit_assert(sail_unsharp_mask_image_with_options(image, 1.5, 0, EDGE_MODES[e], NULL, &sharpened) == SAIL_OK);
+            assert_images_equal(sharpened, image);
+            sail_destroy_image(sharpened);
+
+            sail_destroy_image(image);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_flat(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Flat areas stay flat with any edge mode except zeros. */
+    for (size_t i = 0; i < PIXEL_FORMATS_LENGTH; i++) {
+        for (size_t e = 0; e < EDGE_MODES_LENGTH - 1; e++) {
+            struct sail_image *image = sail_test_alloc_image(29, 17, PIXEL_FORMATS[i]);
+
+            uint8_t pixel[8];
+            munit_rand_memory(sizeof(pixel), pixel);
+
+            unsigned bits_per_pixel;
+            munit_assert(sail_bits_per_pixel(image->pixel_format, &bits_per_pixel) == SAIL_OK);
+
+            for (size_t p = 0; p < (size_t)image->width * image->height; p++) {
+                memcpy((uint8_t *)image->pixels + p * bits_per_pixel / 8, pixel, bits_per_pixel / 8);
+            }
+
+            struct sail_image *output;
+
+            munit_assert(sail_gaussian_blur_image_with_options(image, 2.3, EDGE_MODES[e], NULL, &output) == SAIL_OK);
+            assert_images_equal(output, image);
+            sail_destroy_image(output);
+
+            munit_assert(sail_box_blur_image_with_options(image, 20, EDGE_MODES[e], NULL, &output) == SAIL_OK);
+            assert_images_equal(output, image);
+            sail_destroy_image(output);
+
+            munit_assert(sail_unsharp_mask_image_with_options(image, 1, 2, EDGE_MODES[e], NULL, &output) == SAIL_OK);
+            assert_images_equal(output, image);
+            sail_destroy_image(output);
+
+            sail_destroy_image(image);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_box_blur(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const unsigned RADIUSES[] = { 1, 2, 7, 40 };
+
+    /* Box filters round after the horizontal and vertical passes. */
+    for (size_t r = 0; r < sizeof(RADIUSES) / sizeof(RADIUSES[0]); r++) {
+        for (size_t e = 0; e < EDGE_MODES_LENGTH; e++) {
+            const int radius = (int)RADIUSES[r];
+            const unsigned size = 2 * RADIUSES[r] + 1;
+
+            struct sail_image *image = sail_test_alloc_random_image(23, 19, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+            struct sail_image *horizontal = sail_test_alloc_image(23, 19, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+            for (int y = 0; y < (int)image->height; y++) {
+                for (int x = 0; x < (int)image->width; x++) {
+                    unsigned sum = 0;
+
+                    for (int i = -radius; i <= radius; i++) {
+                        sum += reference_pixel(image, x + i, y, EDGE_MODES[e]);
+                    }
+
+                    ((uint8_t *)horizontal->pixels)[horizontal->bytes_per_line * y + x] = (uint8_t)((sum + size / 2) / size);
+                }
+            }
+
+            struct sail_image *blurred;
+            munit_assert(sail_box_blur_image_with_options(image, RADIUSES[r], EDGE_MODES[e], NULL, &blurred) == SAIL_OK);
+
+            for (int y = 0; y < (int)image->height; y++) {
+                for (int x = 0; x < (int)image->width; x++) {
+                    unsigned sum = 0;
+
+                    for (int i = -radius; i <= radius; i++) {
+                        sum += reference_pixel(horizontal, x, y + i, EDGE_MODES[e]);
+                    }
+
+                    munit_assert_uint(((uint8_t *)blurred->pixels)[blurred->bytes_per_line * y + x], ==, (sum + size / 2) / size);
+                }
+            }
+
+            sail_destroy_image(blurred);
+            sail_destroy_image(horizontal);
+            sail_destroy_image(image);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_gaussian_blur(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const double sigma = 1.7;
+    const int radius = (int)ceil(3 * sigma);
+
+    double kernel[64];
+    double kernel_sum = 0;
+
+    for (int i = -radius; i <= radius; i++) {
+        kernel[i + radius] = exp(-i * i / (2 * sigma * sigma));
+        kernel_sum += kernel[i + radius];
+    }
+
+    for (size_t e = 0; e < EDGE_MODES_LENGTH; e++) {
+        struct sail_image *image = sail_test_alloc_random_image(41, 31, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+        struct sail_image *blurred;
+        munit_assert(sail_gaussian_blur_image_with_options(image, sigma, EDGE_MODES[e], NULL, &blurred) == SAIL_OK);
+
+        for (int y = 0; y < (int)image->height; y++) {
+            for (int x = 0; x < (int)image->width; x++) {
+                double sum = 0;
+
+                for (int j = -radius; j <= radius; j++) {
+                    for (int i = -radius; i <= radius; i++) {
+                        sum += kernel[i + radius] * kernel[j + radius] * reference_pixel(image, x + i, y + j, EDGE_MODES[e]);
+                    }
+                }
+
+                const double expected = sum / (kernel_sum * kernel_sum);
+                const double actual = ((uint8_t *)blurred->pixels)[blurred->bytes_per_line * y + x];
+
+                /* The intermediate rows are rounded. */
+                munit_assert_double(fabs(actual - expected), <=, 1.5);
+            }
+        }
+
+        sail_destroy_image(blurred);
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_custom_kernel(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Shifts the image by 1 pixel left and up. */
+    static const double SHIFT[] = { 0, 0, 1 };
+
+    struct sail_image *image = sail_test_alloc_random_image(16, 9, SAIL_PIXEL_FORMAT_BPP48_RGB);
+
+    for (size_t e = 0; e < EDGE_MODES_LENGTH; e++) {
+        struct sail_image *shifted;
+        munit_assert(sail_convolve_image_with_options(image, SHIFT, 3, SHIFT, 3, EDGE_MODES[e], NULL, &shifted) == SAIL_OK);
+
+        for (unsigned y = 0; y < image->height; y++) {
+            for (unsigned x = 0; x < image->width; x++) {
+                const int source_x = reference_index((int)x + 1, (int)image->width, EDGE_MODES[e]);
+                const int source_y = reference_index((int)y + 1, (int)image->height, EDGE_MODES[e]);
+
+                const uint16_t *actual = (const uint16_t *)((uint8_t *)shifted->pixels + shifted->bytes_per_line * y) + x * 3;
+
+                if (source_x < 0 || source_y < 0) {
+                    static const uint16_t ZEROS[3] = { 0, 0, 0 };
+                    munit_assert_memory_equal(6, actual, ZEROS);
+                } else {
+                    const uint16_t *expected = (const uint16_t *)((uint8_t *)image->pixels + image->bytes_per_line * source_y) + source_x * 3;
+                    munit_assert_memory_equal(6, actual, expected);
+                }
+            }
+        }
+
+        sail_destroy_image(shifted);
+    }
+
+    /* Negative results are clamped. */
+    static const double DERIVATIVE[] = { -1, 0, 1 };
+    static const double ONE[] = { 1 };
+
+    struct sail_image *derivative;
+    munit_assert(sail_convolve_image(image, DERIVATIVE, 3, ONE, 1, &derivative) == SAIL_OK);
+
+    for (unsigned y = 0; y < image->height; y++) {
+        const uint16_t *scan = (const uint16_t *)((uint8_t *)image->pixels + image->bytes_per_line * y);
+        const uint16_t *actual = (const uint16_t *)((uint8_t *)derivative->pixels + derivative->bytes_per_line * y);
+
+        for (unsigned x = 1; x + 1 < image->width; x++) {
+            for (unsigned c = 0; c < 3; c++) {
+                const int difference = scan[(x + 1) * 3 + c] - scan[(x - 1) * 3 + c];
+                munit_assert_int(actual[x * 3 + c], ==, (difference < 0) ? 0 : difference);
+            }
+        }
+    }
+
+    sail_destroy_image(derivative);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_unsharp_mask(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* A vertical edge gets overshoots on both sides. */
+    struct sail_image *image = sail_test_alloc_image(16, 4, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    for (unsigned y = 0; y < image->height; y++) {
+        memset((uint8_t *)image->pixels + image->bytes_per_line * y, 64, 8 * 3);
+        memset((uint8_t *)image->pixels + image->bytes_per_line * y + 8 * 3, 192, 8 * 3);
+    }
+
+    struct sail_image *sharpened;
+    munit_assert(sail_unsharp_mask_image(image, 1, 1, &sharpened) == SAIL_OK);
+
+    for (unsigned y = 0; y < image->height; y++) {
+        const uint8_t *scan = (uint8_t *)sharpened->pixels + sharpened->bytes_per_line * y;
+
+        munit_assert_uint(scan[0], ==, 64);
+        munit_assert_uint(scan[7 * 3], <, 64);
+        munit_assert_uint(scan[8 * 3], >, 192);
+        munit_assert_uint(scan[15 * 3], ==, 192);
+    }
+
+    sail_destroy_image(sharpened);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    for (size_t i = 0; i < PIXEL_FORMATS_LENGTH; i++) {
+        struct sail_image *image = sail_test_alloc_random_image(517, 389, PIXEL_FORMATS[i]);
+
+        struct sail_image *single[3];
+        struct sail_image *multi[3];
+
+        for (unsigned pass = 0; pass < 2; pass++) {
+            struct sail_image **outputs = (pass == 0) ? single : multi;
+            options->threads = (pass == 0) ? 1 : 4;
+
+            munit_assert(sail_gaussian_blur_image_with_options(image, 3, SAIL_EDGE_MODE_MIRROR, options, &outputs[0]) == SAIL_OK);
+            munit_assert(sail_box_blur_image_with_options(image, 9, SAIL_EDGE_MODE_WRAP, options, &outputs[1]) == SAIL_OK);
+            munit_assert(sail_unsharp_mask_image_with_options(image, 0.8, 1.5, SAIL_EDGE_MODE_ZERO, options, &outputs[2]) == SAIL_OK);
+        }
+
+        for (unsigned o = 0; o < 3; o++) {
+            assert_images_equal(single[o], multi[o]);
+            sail_destroy_image(single[o]);
+            sail_destroy_image(multi[o]);
+        }
+
+        sail_destroy_image(image);
+    }
+
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_invalid_arguments(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const double EVEN[] = { 0.5, 0.5 };
+    static const double HUGE_KERNEL[] = { 100 };
+    static const double ONE[] = { 1 };
+
+    struct sail_image *image = sail_test_alloc_random_image(8, 8, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    struct sail_image *output = NULL;
+
+    munit_assert(sail_convolve_image(image, EVEN, 2, ONE, 1, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_convolve_image(image, ONE, 1, HUGE_KERNEL, 1, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_convolve_image(image, ONE, 1, NULL, 1, &output) == SAIL_ERROR_NULL_PTR);
+    munit_assert(sail_convolve_image_with_options(image, ONE, 1, ONE, 1, (enum SailEdgeMode)100, NULL, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_gaussian_blur_image(image, 0, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_gaussian_blur_image(image, NAN, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_box_blur_image(image, 1001, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(sail_unsharp_mask_image(image, 1, -1, &output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert(output == NULL);
+
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP24_YCBCR;
+    munit_assert(sail_box_blur_image(image, 1, &output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/identity", test_identity, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/flat", test_flat, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/box-blur", test_box_blur, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/gaussian-blur", test_gaussian_blur, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/custom-kernel", test_custom_kernel, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/unsharp-mask", test_unsharp_mask, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads", test_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/invalid-arguments", test_invalid_arguments, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/convolve",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
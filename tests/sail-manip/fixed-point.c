@@ -0,0 +1,249 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "munit.h"
+
+/*
+ * Fixed-point blending and grayscale math is compared against the floating-point formulas
+ * it replaced. Fixed-point results are rounded while the floating-point ones were truncated,
+ * so they must never differ by more than 1 (one least significant bit).
+ */
+#define TOLERANCE 1
+
+/* The floating-point reference. */
+static const double R_TO_GRAY_COEFFICIENT = 0.299;
+static const double G_TO_GRAY_COEFFICIENT = 0.587;
+static const double B_TO_GRAY_COEFFICIENT = 0.114;
+
+static double reference_blend(double c, double bg, double opacity) {
+    return opacity * c + (1 - opacity) * bg;
+}
+
+static double reference_gray(double r, double g, double b) {
+    return R_TO_GRAY_COEFFICIENT * r + G_TO_GRAY_COEFFICIENT * g + B_TO_GRAY_COEFFICIENT * b;
+}
+
+static void assert_close(unsigned actual, unsigned expected) {
+    munit_assert_uint(actual, <=, expected + TOLERANCE);
+    munit_assert_uint(actual + TOLERANCE, >=, expected);
+}
+
+static MunitResult test_rounding(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    for (uint32_t value = 0; value <= 65535; value++) {
+        munit_assert_uint32(div255_round(value), ==, (uint32_t)floor(value / 255.0 + 0.5));
+        munit_assert_uint8(narrow16_to8((uint16_t)value), ==, (uint8_t)(value / 257.0));
+    }
+
+    for (uint64_t value = 0; value <= 65535ULL * 65535; value += 65521) {
+        munit_assert_uint32(div65535_round((uint32_t)value), ==, (uint32_t)floor(value / 65535.0 + 0.5));
+    }
+
+    /* Opaque and fully transparent pixels are exact. White stays white. */
+    for (unsigned c = 0; c <= 255; c++) {
+        munit_assert_uint8(blend8((uint8_t)c, 17, 255), ==, c);
+        munit_assert_uint8(blend8(17, (uint8_t)c, 0), ==, c);
+        munit_assert_uint16(blend8_to16((uint8_t)c, 4369, 255), ==, c * 257);
+    }
+
+    munit_assert_uint32(rgb_to_gray(255, 255, 255), ==, 255);
+    munit_assert_uint32(rgb_to_gray(65535, 65535, 65535), ==, 65535);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_blend8(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Every component and alpha value with three backgrounds. */
+    struct sail_image *image = NULL;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = 256;
+    image->height         = 256;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    image->bytes_per_line = image->width * 4;
+    munit_assert(sail_malloc(image->bytes_per_line * image->height, &image->pixels) == SAIL_OK);
+
+    for (unsigned a = 0; a < 256; a++) {
+        uint8_t *scan = (uint8_t *)image->pixels + image->bytes_per_line * a;
+
+        for (unsigned c = 0; c < 256; c++) {
+            *scan++ = (uint8_t)c;
+            *scan++ = (uint8_t)(255 - c);
+            *scan++ = (uint8_t)(c * 7);
+            *scan++ = (uint8_t)a;
+        }
+    }
+
+    struct sail_conversion_options *options = NULL;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+
+    const sail_rgb24_t backgrounds[] = { { 0, 0, 0 }, { 255, 255, 255 }, { 12, 128, 250 } };
+
+    for (size_t i = 0; i < sizeof(backgrounds) / sizeof(backgrounds[0]); i++) {
+        const sail_rgb24_t bg = backgrounds[i];
+        options->background24 = bg;
+
+        struct sail_image *rgb24 = NULL;
+        struct sail_image *gray8 = NULL;
+        munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options, &rgb24) == SAIL_OK);
+        munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, options, &gray8) == SAIL_OK);
+
+        for (unsigned row = 0; row < image->height; row++) {
+            const uint8_t *scan_input = (uint8_t *)image->pixels + image->bytes_per_line * row;
+            const uint8_t *scan_rgb24 = (uint8_t *)rgb24->pixels + rgb24->bytes_per_line * row;
+            const uint8_t *scan_gray8 = (uint8_t *)gray8->pixels + gray8->bytes_per_line * row;
+
+            for (unsigned column = 0; column < image->width; column++, scan_input += 4, scan_rgb24 += 3, scan_gray8++) {
+                const double opacity = scan_input[3] / 255.0;
+                const uint8_t r = (uint8_t)reference_blend(scan_input[0], bg.component1, opacity);
+                const uint8_t g = (uint8_t)reference_blend(scan_input[1], bg.component2, opacity);
+                const uint8_t b = (uint8_t)reference_blend(scan_input[2], bg.component3, opacity);
+
+                assert_close(scan_rgb24[0], r);
+                assert_close(scan_rgb24[1], g);
+                assert_close(scan_rgb24[2], b);
+
+                /* Blending and luma errors can add up. */
+                const unsigned gray = (uint8_t)reference_gray(r, g, b);
+                munit_assert_uint(*scan_gray8, <=, gray + 2 * TOLERANCE);
+                munit_assert_uint(*scan_gray8 + 2 * TOLERANCE, >=, gray);
+            }
+        }
+
+        sail_destroy_image(gray8);
+        sail_destroy_image(rgb24);
+    }
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_blend16(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = NULL;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width          = 1024;
+    image->height         = 64;
+    image->pixel_format   = SAIL_PIXEL_FORMAT_BPP64_RGBA;
+    image->bytes_per_line = image->width * 8;
+    munit_assert(sail_malloc(image->bytes_per_line * image->height, &image->pixels) == SAIL_OK);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint16_t *scan = (uint16_t *)((uint8_t *)image->pixels + image->bytes_per_line * row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            *scan++ = (uint16_t)(column * 64 + row);
+            *scan++ = (uint16_t)(65535 - column * 64);
+            *scan++ = (uint16_t)(column * 4099);
+            *scan++ = (uint16_t)(row * 1040 + column % 16);
+        }
+    }
+
+    struct sail_conversion_options *options = NULL;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options      = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    options->background48 = (sail_rgb48_t){ 3000, 65535, 40000 };
+
+    struct sail_image *rgb48 = NULL;
+    struct sail_image *rgb24 = NULL;
+    struct sail_image *gray16 = NULL;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP48_RGB, options, &rgb48) == SAIL_OK);
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_RGB, options, &rgb24) == SAIL_OK);
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE, options, &gray16) == SAIL_OK);
+
+    const sail_rgb48_t bg = options->background48;
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint16_t *scan_input = (uint16_t *)((uint8_t *)image->pixels + image->bytes_per_line * row);
+        const uint16_t *scan_rgb48 = (uint16_t *)((uint8_t *)rgb48->pixels + rgb48->bytes_per_line * row);
+        const uint8_t *scan_rgb24 = (uint8_t *)rgb24->pixels + rgb24->bytes_per_line * row;
+        const uint16_t *scan_gray16 = (uint16_t *)((uint8_t *)gray16->pixels + gray16->bytes_per_line * row);
+
+        for (unsigned column = 0; column < image->width; column++, scan_input += 4, scan_rgb48 += 3, scan_rgb24 += 3, scan_gray16++) {
+            const double opacity = scan_input[3] / 65535.0;
+            const double r = reference_blend(scan_input[0], bg.component1, opacity);
+            const double g = reference_blend(scan_input[1], bg.component2, opacity);
+            const double b = reference_blend(scan_input[2], bg.component3, opacity);
+
+            assert_close(scan_rgb48[0], (uint16_t)r);
+            assert_close(scan_rgb48[1], (uint16_t)g);
+            assert_close(scan_rgb48[2], (uint16_t)b);
+
+            assert_close(scan_rgb24[0], (uint8_t)(r / 257.0));
+            assert_close(scan_rgb24[1], (uint8_t)(g / 257.0));
+            assert_close(scan_rgb24[2], (uint8_t)(b / 257.0));
+
+            const unsigned gray = (uint16_t)reference_gray((uint16_t)r, (uint16_t)g, (uint16_t)b);
+            munit_assert_uint(*scan_gray16, <=, gray + 2 * TOLERANCE);
+            munit_assert_uint(*scan_gray16 + 2 * TOLERANCE, >=, gray);
+        }
+    }
+
+    sail_destroy_image(gray16);
+    sail_destroy_image(rgb24);
+    sail_destroy_image(rgb48);
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/rounding", test_rounding, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/blend8",   test_blend8,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/blend16",  test_blend16,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/fixed-point",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
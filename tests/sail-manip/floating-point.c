@@ -0,0 +1,288 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static MunitResult test_half_conversions(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Every half except NaN survives the round trip through float. */
+    for (unsigned h = 0; h < 65536; h++) {
+        const float value = half_to_float((uint16_t)h);
+
+        if (isnan(value)) {
+            munit_assert(isnan(half_to_float(float_to_half(value))));
+        } else {
+            munit_assert_uint16(float_to_half(value), ==, h);
+        }
+    }
+
+    munit_assert_uint16(float_to_half(1.0f), ==, 0x3C00);
+    munit_assert_uint16(float_to_half(-2.0f), ==, 0xC000);
+    munit_assert_uint16(float_to_half(65504.0f), ==, 0x7BFF);
+    munit_assert_uint16(float_to_half(65520.0f), ==, 0x7C00);    /* Rounds to infinity. */
+    munit_assert_uint16(float_to_half(5.9604645e-8f), ==, 0x0001); /* The smallest subnormal. */
+    munit_assert_uint16(float_to_half(2.9802322e-8f), ==, 0x0000); /* Halfway rounds to even. */
+    munit_assert_uint16(float_to_half(1.0009766f), ==, 0x3C01);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_integer_round_trip(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* All 16-bit values survive BPP64-RGBA -> BPP128-RGBA-FLOAT -> BPP64-RGBA. */
+    struct sail_image *image = sail_test_alloc_image(16384, 1, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+
+    for (unsigned i = 0; i < 65536; i++) {
+        ((uint16_t *)image->pixels)[i] = (uint16_t)i;
+    }
+
+    struct sail_image *image_float;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT, &image_float) == SAIL_OK);
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image(image_float, SAIL_PIXEL_FORMAT_BPP64_RGBA, &image_output) == SAIL_OK);
+
+    for (unsigned i = 0; i < 65536; i++) {
+        munit_assert_float(((float *)image_float->pixels)[i], ==, i / 65535.0f);
+    }
+
+    munit_assert_memory_equal(65536 * sizeof(uint16_t), image_output->pixels, image->pixels);
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_float);
+    sail_destroy_image(image);
+
+    /* All 8-bit values survive BPP8-GRAYSCALE -> BPP32-GRAYSCALE-FLOAT -> BPP8-GRAYSCALE. */
+    image = sail_test_alloc_image(256, 1, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+    for (unsigned i = 0; i < 256; i++) {
+        ((uint8_t *)image->pixels)[i] = (uint8_t)i;
+    }
+
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT, &image_float) == SAIL_OK);
+    munit_assert(sail_convert_image(image_float, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, &image_output) == SAIL_OK);
+
+    munit_assert_memory_equal(256, image_output->pixels, image->pixels);
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_float);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_clamping(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const float INPUT[] = { -1.0f, 0.0f, 0.5f, 1.0f, 2.0f, NAN, INFINITY, -INFINITY };
+    static const uint16_t EXPECTED[] = { 0, 0, 32768, 65535, 65535, 0, 65535, 0 };
+
+    struct sail_image *image = sail_test_alloc_image(2, 1, SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT);
+    memcpy(image->pixels, INPUT, sizeof(INPUT));
+
+    /* The kernel and the generic path clamp the same way. */
+    struct sail_image *image_rgba64;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP64_RGBA, &image_rgba64) == SAIL_OK);
+    struct sail_image *image_bgra64;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP64_BGRA, &image_bgra64) == SAIL_OK);
+
+    const uint16_t *rgba64 = image_rgba64->pixels;
+    const uint16_t *bgra64 = image_bgra64->pixels;
+
+    for (unsigned i = 0; i < 8; i++) {
+        munit_assert_uint16(rgba64[i], ==, EXPECTED[i]);
+    }
+
+    for (unsigned pixel = 0; pixel < 2; pixel++) {
+        munit_assert_uint16(bgra64[pixel * 4 + 0], ==, EXPECTED[pixel * 4 + 2]);
+        munit_assert_uint16(bgra64[pixel * 4 + 1], ==, EXPECTED[pixel * 4 + 1]);
+        munit_assert_uint16(bgra64[pixel * 4 + 2], ==, EXPECTED[pixel * 4 + 0]);
+        munit_assert_uint16(bgra64[pixel * 4 + 3], ==, EXPECTED[pixel * 4 + 3]);
+    }
+
+    sail_destroy_image(image_bgra64);
+    sail_destroy_image(image_rgba64);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_floating_point_keeps_range(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const float INPUT[] = { 2.0f, -0.5f, 4.0f, 1.0f, 2.0f, 2.0f, 2.0f, 0.5f };
+
+    struct sail_image *image = sail_test_alloc_image(2, 1, SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT);
+    memcpy(image->pixels, INPUT, sizeof(INPUT));
+
+    /* Dropping alpha. */
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT, &image_output) == SAIL_OK);
+    {
+        const float *rgb = image_output->pixels;
+        const float expected[] = { 2.0f, -0.5f, 4.0f, 2.0f, 2.0f, 2.0f };
+
+        for (unsigned i = 0; i < 6; i++) {
+            munit_assert_float(rgb[i], ==, expected[i]);
+        }
+    }
+    sail_destroy_image(image_output);
+
+    /* Blending with a black background. */
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    options->background48 = (sail_rgb48_t){ 0, 0, 0 };
+
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP48_RGB_HALF, options, &image_output) == SAIL_OK);
+    {
+        const uint16_t *rgb = image_output->pixels;
+        const float expected[] = { 2.0f, -0.5f, 4.0f, 1.0f, 1.0f, 1.0f };
+
+        for (unsigned i = 0; i < 6; i++) {
+            munit_assert_float(half_to_float(rgb[i]), ==, expected[i]);
+        }
+    }
+    sail_destroy_image(image_output);
+    sail_destroy_conversion_options(options);
+
+    /* Luma of equal components doesn't change. */
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_GRAYSCALE_FLOAT, &image_output) == SAIL_OK);
+    munit_assert_float(((float *)image_output->pixels)[1], ==, 2.0f);
+    sail_destroy_image(image_output);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+/*
+ * Converts the floating point input to the integer output with a kernel. Then converts it to the
+ * swapped integer format with the generic path, swaps the channels back, and compares the results.
+ */
+static void assert_kernel_matches_generic(enum SailPixelFormat input_pixel_format,
+                                          enum SailPixelFormat output_pixel_format,
+                                          enum SailPixelFormat swapped_pixel_format) {
+
+    struct sail_image *image = sail_test_alloc_random_image(67, 3, input_pixel_format);
+
+    struct sail_image *image_kernel;
+    munit_assert(sail_convert_image(image, output_pixel_format, &image_kernel) == SAIL_OK);
+
+    /* Swapping the channels of integer pixel formats is exact. */
+    struct sail_image *image_swapped;
+    munit_assert(sail_convert_image(image, swapped_pixel_format, &image_swapped) == SAIL_OK);
+
+    struct sail_image *image_generic;
+    munit_assert(sail_convert_image(image_swapped, output_pixel_format, &image_generic) == SAIL_OK);
+
+    munit_assert_memory_equal((size_t)image_kernel->bytes_per_line * image_kernel->height, image_generic->pixels, image_kernel->pixels);
+
+    sail_destroy_image(image_generic);
+    sail_destroy_image(image_swapped);
+    sail_destroy_image(image_kernel);
+    sail_destroy_image(image);
+}
+
+static MunitResult test_kernels_match_generic(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const struct {
+        enum SailPixelFormat integer;
+        enum SailPixelFormat swapped;
+        enum SailPixelFormat floating_point;
+    } PAIRS[] = {
+        { SAIL_PIXEL_FORMAT_BPP24_RGB,  SAIL_PIXEL_FORMAT_BPP24_BGR,  SAIL_PIXEL_FORMAT_BPP48_RGB_HALF    },
+        { SAIL_PIXEL_FORMAT_BPP24_RGB,  SAIL_PIXEL_FORMAT_BPP24_BGR,  SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT   },
+        { SAIL_PIXEL_FORMAT_BPP48_RGB,  SAIL_PIXEL_FORMAT_BPP48_BGR,  SAIL_PIXEL_FORMAT_BPP48_RGB_HALF    },
+        { SAIL_PIXEL_FORMAT_BPP48_RGB,  SAIL_PIXEL_FORMAT_BPP48_BGR,  SAIL_PIXEL_FORMAT_BPP96_RGB_FLOAT   },
+        { SAIL_PIXEL_FORMAT_BPP32_RGBA, SAIL_PIXEL_FORMAT_BPP32_BGRA, SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF   },
+        { SAIL_PIXEL_FORMAT_BPP32_RGBA, SAIL_PIXEL_FORMAT_BPP32_BGRA, SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT },
+        { SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP64_BGRA, SAIL_PIXEL_FORMAT_BPP64_RGBA_HALF   },
+        { SAIL_PIXEL_FORMAT_BPP64_RGBA, SAIL_PIXEL_FORMAT_BPP64_BGRA, SAIL_PIXEL_FORMAT_BPP128_RGBA_FLOAT },
+    };
+
+    for (size_t i = 0; i < sizeof(PAIRS) / sizeof(PAIRS[0]); i++) {
+        /* Integer -> floating point. The swapped input goes through the generic path. */
+        struct sail_image *image = sail_test_alloc_random_image(67, 3, PAIRS[i].swapped);
+        struct sail_image *image_integer;
+        munit_assert(sail_convert_image(image, PAIRS[i].integer, &image_integer) == SAIL_OK);
+
+        struct sail_image *image_kernel;
+        munit_assert(sail_convert_image(image_integer, PAIRS[i].floating_point, &image_kernel) == SAIL_OK);
+        struct sail_image *image_generic;
+        munit_assert(sail_convert_image(image, PAIRS[i].floating_point, &image_generic) == SAIL_OK);
+
+        munit_assert_memory_equal((size_t)image_kernel->bytes_per_line * image_kernel->height, image_generic->pixels, image_kernel->pixels);
+
+        sail_destroy_image(image_generic);
+        sail_destroy_image(image_kernel);
+        sail_destroy_image(image_integer);
+        sail_destroy_image(image);
+
+        /* Floating point -> integer. The swapped output goes through the generic path. */
+        assert_kernel_matches_generic(PAIRS[i].floating_point, PAIRS[i].integer, PAIRS[i].swapped);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/half-conversions", test_half_conversions, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/integer-round-trip", test_integer_round_trip, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/clamping", test_clamping, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/floating-point-keeps-range", test_floating_point_keeps_range, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/kernels-match-generic", test_kernels_match_generic, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/floating-point",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
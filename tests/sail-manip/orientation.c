@@ -0,0 +1,342 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static const enum SailPixelFormat PIXEL_FORMATS[] = {
+    SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE,
+    SAIL_PIXEL_FORMAT_BPP16_GRAYSCALE,
+    SAIL_PIXEL_FORMAT_BPP24_RGB,
+    SAIL_PIXEL_FORMAT_BPP32_RGBA,
+    SAIL_PIXEL_FORMAT_BPP48_RGB,
+    SAIL_PIXEL_FORMAT_BPP64_RGBA,
+};
+
+static const size_t PIXEL_FORMATS_LENGTH = sizeof(PIXEL_FORMATS) / sizeof(PIXEL_FORMATS[0]);
+
+/* Square, non-square, and degenerate sizes. Tiles are 32x32. */
+static const unsigned SIZES[][2] = {
+    { 70, 45 },
+    { 45, 45 },
+    { 1,  33 },
+    { 37, 1  },
+};
+
+static const size_t SIZES_LENGTH = sizeof(SIZES) / sizeof(SIZES[0]);
+
+/* Non-square resolution to check that transposing swaps it. */
+static void attach_resolution(struct sail_image *image) {
+
+    munit_assert(sail_alloc_resolution(&image->resolution) == SAIL_OK);
+    image->resolution->unit = SAIL_RESOLUTION_UNIT_INCH;
+    image->resolution->x    = 72;
+    image->resolution->y    = 300;
+}
+
+/* Returns the input pixel displayed at (row, column) when the input is stored in the orientation. */
+static const uint8_t* reference_pixel(const struct sail_image *image, enum SailOrientation orientation,
+                                      unsigned row, unsigned column, unsigned bytes_per_pixel) {
+
+    const unsigned w = image->width;
+    const unsigned h = image->height;
+    unsigned input_row;
+    unsigned input_column;
+
+    switch (orientation) {
+        case SAIL_ORIENTATION_NORMAL:          input_row = row;             input_column = column;         break;
+        case SAIL_ORIENTATION_FLIP_HORIZONTAL: input_row = row;             input_column = w - 1 - column; break;
+        case SAIL_ORIENTATION_ROTATE_180:      input_row = h - 1 - row;     input_column = w - 1 - column; break;
+        case SAIL_ORIENTATION_FLIP_VERTICAL:   input_row = h - 1 - row;     input_column = column;         break;
+        case SAIL_ORIENTATION_TRANSPOSE:       input_row = column;          input_column = row;            break;
+        case SAIL_ORIENTATION_ROTATE_90:       input_row = h - 1 - column;  input_column = row;            break;
+        case SAIL_ORIENTATION_TRANSVERSE:      input_row = h - 1 - column;  input_column = w - 1 - row;    break;
+        case SAIL_ORIENTATION_ROTATE_270:      input_row = column;          input_column = w - 1 - row;    break;
+        default: munit_error("Unknown orientation");
+    }
+
+    return (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * input_row + (size_t)input_column * bytes_per_pixel;
+}
+
+static bool transposes(enum SailOrientation orientation) {
+
+    return orientation >= SAIL_ORIENTATION_TRANSPOSE;
+}
+
+static void assert_oriented(const struct sail_image *image, enum SailOrientation orientation, const struct sail_image *image_output) {
+
+    unsigned bits_per_pixel;
+    munit_assert(sail_bits_per_pixel(image->pixel_format, &bits_per_pixel) == SAIL_OK);
+    const unsigned bytes_per_pixel = bits_per_pixel / 8;
+
+    munit_assert(image_output->pixel_format == image->pixel_format);
+    munit_assert_uint(image_output->width,  ==, transposes(orientation) ? image->height : image->width);
+    munit_assert_uint(image_output->height, ==, transposes(orientation) ? image->width : image->height);
+    munit_assert_double(image_output->resolution->x, ==, transposes(orientation) ? image->resolution->y : image->resolution->x);
+
+    for (unsigned row = 0; row < image_output->height; row++) {
+        const uint8_t *scan = (const uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image_output->width; column++) {
+            munit_assert_memory_equal(bytes_per_pixel,
+                                      scan + (size_t)column * bytes_per_pixel,
+                                      reference_pixel(image, orientation, row, column, bytes_per_pixel));
+        }
+    }
+}
+
+static MunitResult test_orient(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    for (size_t i = 0; i < PIXEL_FORMATS_LENGTH; i++) {
+        for (size_t s = 0; s < SIZES_LENGTH; s++) {
+            struct sail_image *image = sail_test_alloc_random_image(SIZES[s][0], SIZES[s][1], PIXEL_FORMATS[i]);
+            attach_resolution(image);
+
+            for (int orientation = SAIL_ORIENTATION_NORMAL; orientation <= SAIL_ORIENTATION_ROTATE_270; orientation++) {
+                struct sail_image *image_output = NULL;
+                munit_assert(sail_copy_image(image, &image_output) == SAIL_OK);
+
+                munit_assert(sail_orient_image(image_output, (enum SailOrientation)orientation) == SAIL_OK);
+                assert_oriented(image, (enum SailOrientation)orientation, image_output);
+
+                sail_destroy_image(image_output);
+            }
+
+            sail_destroy_image(image);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_rotate(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    for (size_t i = 0; i < PIXEL_FORMATS_LENGTH; i++) {
+        for (size_t s = 0; s < SIZES_LENGTH; s++) {
+            struct sail_image *image = sail_test_alloc_random_image(SIZES[s][0], SIZES[s][1], PIXEL_FORMATS[i]);
+            attach_resolution(image);
+            struct sail_image *image_output = NULL;
+
+            munit_assert(sail_rotate_image(image, SAIL_ROTATION_90, &image_output) == SAIL_OK);
+            assert_oriented(image, SAIL_ORIENTATION_ROTATE_90, image_output);
+            sail_destroy_image(image_output);
+
+            munit_assert(sail_rotate_image(image, SAIL_ROTATION_180, &image_output) == SAIL_OK);
+            assert_oriented(image, SAIL_ORIENTATION_ROTATE_180, image_output);
+            sail_destroy_image(image_output);
+
+            munit_assert(sail_rotate_image(image, SAIL_ROTATION_270, &image_output) == SAIL_OK);
+            assert_oriented(image, SAIL_ORIENTATION_ROTATE_270, image_output);
+            sail_destroy_image(image_output);
+
+            munit_assert(sail_transpose_image(image, &image_output) == SAIL_OK);
+            assert_oriented(image, SAIL_ORIENTATION_TRANSPOSE, image_output);
+            sail_destroy_image(image_output);
+
+            sail_destroy_image(image);
+        }
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_flip(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_random_image(70, 45, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    attach_resolution(image);
+
+    static const struct {
+        int flip;
+        enum SailOrientation orientation;
+    } FLIPS[] = {
+        { SAIL_FLIP_HORIZONTALLY,                        SAIL_ORIENTATION_FLIP_HORIZONTAL },
+        { SAIL_FLIP_VERTICALLY,                          SAIL_ORIENTATION_FLIP_VERTICAL   },
+        { SAIL_FLIP_HORIZONTALLY | SAIL_FLIP_VERTICALLY, SAIL_ORIENTATION_ROTATE_180      },
+    };
+
+    for (size_t i = 0; i < sizeof(FLIPS) / sizeof(FLIPS[0]); i++) {
+        struct sail_image *image_output = NULL;
+        munit_assert(sail_copy_image(image, &image_output) == SAIL_OK);
+
+        munit_assert(sail_flip_image(image_output, FLIPS[i].flip) == SAIL_OK);
+        assert_oriented(image, FLIPS[i].orientation, image_output);
+
+        sail_destroy_image(image_output);
+    }
+
+    sail_destroy_image(image);
+
+    /* Rows of any pixel format can be flipped vertically. */
+    struct sail_image *image_indexed = sail_test_alloc_random_image(13, 5, SAIL_PIXEL_FORMAT_BPP1_INDEXED);
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 16, &image_indexed->palette) == SAIL_OK);
+    struct sail_image *image_flipped = NULL;
+    munit_assert(sail_copy_image(image_indexed, &image_flipped) == SAIL_OK);
+
+    munit_assert(sail_flip_image(image_flipped, SAIL_FLIP_VERTICALLY) == SAIL_OK);
+
+    for (unsigned row = 0; row < image_indexed->height; row++) {
+        munit_assert_memory_equal(image_indexed->bytes_per_line,
+                                  (uint8_t *)image_flipped->pixels + (size_t)image_flipped->bytes_per_line * row,
+                                  (uint8_t *)image_indexed->pixels + (size_t)image_indexed->bytes_per_line * (image_indexed->height - 1 - row));
+    }
+
+    sail_destroy_image(image_flipped);
+    sail_destroy_image(image_indexed);
+
+    return MUNIT_OK;
+}
+
+/* Builds the smallest EXIF block with a single Orientation tag. */
+static struct sail_meta_data_node* alloc_exif_orientation(unsigned orientation, bool big_endian) {
+
+    uint8_t exif[26];
+    memset(exif, 0, sizeof(exif));
+
+    if (big_endian) {
+        memcpy(exif, "MM\0*\0\0\0\x08", 8);
+        memcpy(exif + 8, "\0\x01\x01\x12\0\x03\0\0\0\x01", 10);
+        exif[18] = 0;
+        exif[19] = (uint8_t)orientation;
+    } else {
+        memcpy(exif, "II*\0\x08\0\0\0", 8);
+        memcpy(exif + 8, "\x01\0\x12\x01\x03\0\x01\0\0\0", 10);
+        exif[18] = (uint8_t)orientation;
+        exif[19] = 0;
+    }
+
+    struct sail_meta_data_node *meta_data_node = NULL;
+    munit_assert(sail_alloc_meta_data_node_from_known_data(SAIL_META_DATA_EXIF, exif, sizeof(exif), &meta_data_node) == SAIL_OK);
+
+    return meta_data_node;
+}
+
+static MunitResult test_auto_orient(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    for (int big_endian = 0; big_endian <= 1; big_endian++) {
+        for (int orientation = SAIL_ORIENTATION_NORMAL; orientation <= SAIL_ORIENTATION_ROTATE_270; orientation++) {
+            struct sail_image *image = sail_test_alloc_random_image(70, 45, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+            attach_resolution(image);
+
+            /* Comments before EXIF must be skipped. */
+            munit_assert(sail_alloc_meta_data_node_from_known_string(SAIL_META_DATA_COMMENT, "Comment", &image->meta_data_node) == SAIL_OK);
+            image->meta_data_node->next = alloc_exif_orientation((unsigned)orientation, big_endian);
+
+            enum SailOrientation found;
+            munit_assert(sail_orientation_from_meta_data(image->meta_data_node, &found) == SAIL_OK);
+            munit_assert_int(found, ==, orientation);
+
+            struct sail_image *image_output = NULL;
+            munit_assert(sail_copy_image(image, &image_output) == SAIL_OK);
+
+            munit_assert(sail_auto_orient_image(image_output) == SAIL_OK);
+            assert_oriented(image, (enum SailOrientation)orientation, image_output);
+
+            /* Orienting twice does nothing. */
+            munit_assert(sail_orientation_from_meta_data(image_output->meta_data_node, &found) == SAIL_OK);
+            munit_assert_int(found, ==, SAIL_ORIENTATION_NORMAL);
+
+            sail_destroy_image(image_output);
+            sail_destroy_image(image);
+        }
+    }
+
+    /* Vertically flipped images are flipped back before applying EXIF. */
+    for (int orientation = SAIL_ORIENTATION_NORMAL; orientation <= SAIL_ORIENTATION_ROTATE_270; orientation++) {
+        struct sail_image *image = sail_test_alloc_random_image(70, 45, SAIL_PIXEL_FORMAT_BPP24_BGR);
+        attach_resolution(image);
+        image->meta_data_node = alloc_exif_orientation((unsigned)orientation, false);
+        image->properties = SAIL_IMAGE_PROPERTY_FLIPPED_VERTICALLY;
+
+        struct sail_image *image_output = NULL;
+        munit_assert(sail_copy_image(image, &image_output) == SAIL_OK);
+        munit_assert(sail_auto_orient_image(image_output) == SAIL_OK);
+        munit_assert_int(image_output->properties & SAIL_IMAGE_PROPERTY_FLIPPED_VERTICALLY, ==, 0);
+
+        /* The expected pixels are the flipped input rows oriented with EXIF. */
+        munit_assert(sail_flip_image(image, SAIL_FLIP_VERTICALLY) == SAIL_OK);
+        assert_oriented(image, (enum SailOrientation)orientation, image_output);
+
+        sail_destroy_image(image_output);
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_errors(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_random_image(13, 5, SAIL_PIXEL_FORMAT_BPP4_INDEXED);
+    munit_assert(sail_alloc_palette_for_data(SAIL_PIXEL_FORMAT_BPP24_RGB, 16, &image->palette) == SAIL_OK);
+    struct sail_image *image_output = NULL;
+
+    munit_assert(sail_rotate_image(image, SAIL_ROTATION_90, &image_output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_transpose_image(image, &image_output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_flip_image(image, SAIL_FLIP_HORIZONTALLY) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_orient_image(image, SAIL_ORIENTATION_ROTATE_90) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_orient_image(image, (enum SailOrientation)9) == SAIL_ERROR_INVALID_ARGUMENT);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/orient",      test_orient,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/rotate",      test_rotate,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/flip",        test_flip,        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/auto-orient", test_auto_orient, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/errors",      test_errors,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/orientation",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
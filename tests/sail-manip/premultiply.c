@@ -0,0 +1,297 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+/*
+ * Premultiplying and unpremultiplying round to the nearest integer. Exact integer references
+ * are used as halves must be rounded up.
+ */
+static uint8_t reference_premultiply8(unsigned c, unsigned a) {
+    return (uint8_t)((c * a * 2 + 255) / 510);
+}
+
+static uint8_t reference_unpremultiply8(unsigned c, unsigned a) {
+    return (a == 0) ? 0 : (uint8_t)((c * 255 * 2 + a) / (a * 2));
+}
+
+static uint16_t reference_premultiply16(uint64_t c, uint64_t a) {
+    return (uint16_t)((c * a * 2 + 65535) / 131070);
+}
+
+/* Every 8-bit color component with every 8-bit alpha. Rows are alphas, columns are components. */
+static struct sail_image* alloc_all_rgba32(enum SailPixelFormat pixel_format, bool premultiplied) {
+
+    struct sail_image *image = sail_test_alloc_image(256, 256, pixel_format);
+
+    for (unsigned a = 0; a < 256; a++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * a;
+
+        for (unsigned c = 0; c < 256; c++) {
+            /* Premultiplied components never exceed alpha. */
+            const uint8_t value = (uint8_t)(premultiplied ? c * a / 255 : c);
+
+            *scan++ = value;
+            *scan++ = (uint8_t)((premultiplied ? a : 255) - value);
+            *scan++ = value;
+            *scan++ = (uint8_t)a;
+        }
+    }
+
+    return image;
+}
+
+static MunitResult test_premultiply8(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const enum SailPixelFormat OUTPUT_PIXEL_FORMATS[] = {
+        SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED,
+        SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED,
+        SAIL_PIXEL_FORMAT_BPP32_ARGB_PREMULTIPLIED,
+        SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED,
+    };
+
+    static const int R_INDEXES[] = { 0, 2, 1, 3 };
+    static const int G_INDEXES[] = { 1, 1, 2, 2 };
+    static const int A_INDEXES[] = { 3, 3, 0, 0 };
+
+    struct sail_image *image = alloc_all_rgba32(SAIL_PIXEL_FORMAT_BPP32_RGBA, false);
+
+    for (size_t i = 0; i < sizeof(OUTPUT_PIXEL_FORMATS) / sizeof(OUTPUT_PIXEL_FORMATS[0]); i++) {
+        struct sail_image *image_output;
+        munit_assert(sail_convert_image(image, OUTPUT_PIXEL_FORMATS[i], &image_output) == SAIL_OK);
+
+        for (unsigned a = 0; a < 256; a++) {
+            const uint8_t *scan = (uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * a;
+
+            for (unsigned c = 0; c < 256; c++) {
+                munit_assert_uint8(scan[R_INDEXES[i]], ==, reference_premultiply8(c, a));
+                munit_assert_uint8(scan[G_INDEXES[i]], ==, reference_premultiply8(255 - c, a));
+                munit_assert_uint8(scan[A_INDEXES[i]], ==, a);
+                scan += 4;
+            }
+        }
+
+        sail_destroy_image(image_output);
+    }
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_unpremultiply8(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_all_rgba32(SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED, true);
+
+    /* BPP32-ARGB is converted with a kernel, BPP64-RGBA and BPP24-RGB through the generic path. */
+    struct sail_image *image_argb32;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_ARGB, &image_argb32) == SAIL_OK);
+    struct sail_image *image_rgba64;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP64_RGBA, &image_rgba64) == SAIL_OK);
+
+    for (unsigned a = 0; a < 256; a++) {
+        const uint8_t *scan_input = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * a;
+        const uint8_t *scan_argb32 = (uint8_t *)image_argb32->pixels + (size_t)image_argb32->bytes_per_line * a;
+        const uint16_t *scan_rgba64 = (uint16_t *)((uint8_t *)image_rgba64->pixels + (size_t)image_rgba64->bytes_per_line * a);
+
+        for (unsigned c = 0; c < 256; c++) {
+            const uint8_t expected_r = reference_unpremultiply8(scan_input[0], a);
+            const uint8_t expected_g = reference_unpremultiply8(scan_input[1], a);
+
+            munit_assert_uint8(scan_argb32[0], ==, a);
+            munit_assert_uint8(scan_argb32[1], ==, expected_r);
+            munit_assert_uint8(scan_argb32[2], ==, expected_g);
+
+            munit_assert_uint16(scan_rgba64[0], ==, expected_r * 257);
+            munit_assert_uint16(scan_rgba64[1], ==, expected_g * 257);
+            munit_assert_uint16(scan_rgba64[3], ==, a * 257);
+
+            scan_input += 4;
+            scan_argb32 += 4;
+            scan_rgba64 += 4;
+        }
+    }
+
+    sail_destroy_image(image_rgba64);
+    sail_destroy_image(image_argb32);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_round_trip(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Premultiplied -> straight -> premultiplied gives the original pixels back. */
+    struct sail_image *image = alloc_all_rgba32(SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED, true);
+
+    struct sail_image *image_straight;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_straight) == SAIL_OK);
+    struct sail_image *image_premultiplied;
+    munit_assert(sail_convert_image(image_straight, SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED, &image_premultiplied) == SAIL_OK);
+
+    munit_assert_memory_equal((size_t)image->bytes_per_line * image->height, image_premultiplied->pixels, image->pixels);
+
+    /* Premultiplied -> premultiplied is a plain swizzle. */
+    struct sail_image *image_abgr;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_ABGR_PREMULTIPLIED, &image_abgr) == SAIL_OK);
+
+    for (size_t i = 0; i < (size_t)image->bytes_per_line * image->height; i += 4) {
+        const uint8_t *input = (uint8_t *)image->pixels + i;
+        const uint8_t *output = (uint8_t *)image_abgr->pixels + i;
+
+        munit_assert_uint8(output[0], ==, input[3]);
+        munit_assert_uint8(output[1], ==, input[0]);
+        munit_assert_uint8(output[2], ==, input[1]);
+        munit_assert_uint8(output[3], ==, input[2]);
+    }
+
+    sail_destroy_image(image_abgr);
+    sail_destroy_image(image_premultiplied);
+    sail_destroy_image(image_straight);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_opaque(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Opaque pixels are not changed by premultiplying. */
+    struct sail_image *image = sail_test_alloc_image(67, 5, SAIL_PIXEL_FORMAT_BPP24_BGR);
+    munit_rand_memory((size_t)image->bytes_per_line * image->height, image->pixels);
+
+    struct sail_image *image_expected;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_expected) == SAIL_OK);
+    struct sail_image *image_premultiplied;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA_PREMULTIPLIED, &image_premultiplied) == SAIL_OK);
+
+    munit_assert_memory_equal((size_t)image_expected->bytes_per_line * image_expected->height,
+                              image_premultiplied->pixels, image_expected->pixels);
+
+    sail_destroy_image(image_premultiplied);
+    sail_destroy_image(image_expected);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_premultiply16(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_image(1031, 7, SAIL_PIXEL_FORMAT_BPP64_ARGB);
+    munit_rand_memory((size_t)image->bytes_per_line * image->height, image->pixels);
+
+    /* Fully transparent and fully opaque pixels. */
+    memset(image->pixels, 0, 8);
+    memset((uint8_t *)image->pixels + 8, 0xFF, 8);
+
+    struct sail_image *image_premultiplied;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP64_RGBA_PREMULTIPLIED, &image_premultiplied) == SAIL_OK);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint16_t *scan_input = (uint16_t *)((uint8_t *)image->pixels + (size_t)image->bytes_per_line * row);
+        const uint16_t *scan_output = (uint16_t *)((uint8_t *)image_premultiplied->pixels + (size_t)image_premultiplied->bytes_per_line * row);
+
+        for (unsigned column = 0; column < image->width; column++) {
+            const uint16_t a = scan_input[0];
+
+            munit_assert_uint16(scan_output[0], ==, reference_premultiply16(scan_input[1], a));
+            munit_assert_uint16(scan_output[1], ==, reference_premultiply16(scan_input[2], a));
+            munit_assert_uint16(scan_output[2], ==, reference_premultiply16(scan_input[3], a));
+            munit_assert_uint16(scan_output[3], ==, a);
+
+            scan_input += 4;
+            scan_output += 4;
+        }
+    }
+
+    /* Unpremultiplying restores the components up to the precision kept by alpha. */
+    struct sail_image *image_straight;
+    munit_assert(sail_convert_image(image_premultiplied, SAIL_PIXEL_FORMAT_BPP64_ARGB, &image_straight) == SAIL_OK);
+
+    const uint16_t *input = image->pixels;
+    const uint16_t *output = image_straight->pixels;
+
+    munit_assert_uint16(output[1], ==, 0);
+    munit_assert_memory_equal(8, output + 4, input + 4);
+
+    for (size_t i = 0; i < (size_t)image->width * image->height * 4; i += 4) {
+        const uint16_t a = input[i];
+
+        munit_assert_uint16(output[i], ==, a);
+
+        if (a >= 256) {
+            for (unsigned channel = 1; channel < 4; channel++) {
+                const int difference = (int)output[i + channel] - (int)input[i + channel];
+                munit_assert_int(abs(difference), <=, 65535 / a);
+            }
+        }
+    }
+
+    sail_destroy_image(image_straight);
+    sail_destroy_image(image_premultiplied);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/premultiply8",   test_premultiply8,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/unpremultiply8", test_unpremultiply8, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/round-trip",     test_round_trip,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/opaque",         test_opaque,         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/premultiply16",  test_premultiply16,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/premultiply",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
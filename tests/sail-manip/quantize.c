@@ -0,0 +1,316 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static const enum SailDither DITHERS[] = {
+    SAIL_DITHER_NONE,
+    SAIL_DITHER_ORDERED,
+    SAIL_DITHER_FLOYD_STEINBERG,
+};
+
+static const size_t DITHERS_LENGTH = sizeof(DITHERS) / sizeof(DITHERS[0]);
+
+/* Smooth RGB gradient with a lot of colors. */
+static struct sail_image* alloc_gradient_image(unsigned width, unsigned height) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    for (unsigned row = 0; row < height; row++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < width; column++) {
+            scan[column * 3 + 0] = (uint8_t)(column * 255 / (width - 1));
+            scan[column * 3 + 1] = (uint8_t)(row * 255 / (height - 1));
+            scan[column * 3 + 2] = (uint8_t)((column + row) * 255 / (width + height - 2));
+        }
+    }
+
+    return image;
+}
+
+/* Image with the specified colors repeated. */
+static struct sail_image* alloc_image_with_colors(unsigned width, unsigned height, const uint8_t (*colors)[3], unsigned color_count) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    for (unsigned row = 0; row < height; row++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < width; column++) {
+            memcpy(scan + column * 3, colors[(row * 7 + column) % color_count], 3);
+        }
+    }
+
+    return image;
+}
+
+/* Converts the quantized image back to BPP24-RGB. */
+static struct sail_image* expand(const struct sail_image *image) {
+
+    struct sail_image *image_rgb = NULL;
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP24_RGB, &image_rgb) == SAIL_OK);
+
+    return image_rgb;
+}
+
+/*
+ * Returns the mean absolute difference of 8x8 block averages. Dithering trades per-pixel errors
+ * for accurate averages, so it's compared instead of per-pixel errors.
+ */
+static double mean_block_error(const struct sail_image *image1, const struct sail_image *image2) {
+
+    double sum = 0;
+    unsigned blocks = 0;
+
+    for (unsigned block_row = 0; block_row + 8 <= image1->height; block_row += 8) {
+        for (unsigned block_column = 0; block_column + 8 <= image1->width; block_column += 8, blocks++) {
+            for (unsigned c = 0; c < 3; c++) {
+                int sum1 = 0;
+                int sum2 = 0;
+
+                for (unsigned row = block_row; row < block_row + 8; row++) {
+                    const uint8_t *scan1 = (uint8_t *)image1->pixels + (size_t)image1->bytes_per_line * row;
+                    const uint8_t *scan2 = (uint8_t *)image2->pixels + (size_t)image2->bytes_per_line * row;
+
+                    for (unsigned column = block_column; column < block_column + 8; column++) {
+                        sum1 += scan1[column * 3 + c];
+                        sum2 += scan2[column * 3 + c];
+                    }
+                }
+
+                sum += abs(sum1 - sum2) / 64.0;
+            }
+        }
+    }
+
+    return sum / (blocks * 3);
+}
+
+static MunitResult test_exact_colors(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    static const uint8_t COLORS[][3] = {
+        { 0,   0,   0   },
+        { 255, 255, 255 },
+        { 255, 0,   0   },
+        { 1,   2,   3   },
+        { 2,   2,   3   },
+    };
+
+    static const struct {
+        enum SailPixelFormat pixel_format;
+        unsigned color_count;
+    } CASES[] = {
+        { SAIL_PIXEL_FORMAT_BPP1_INDEXED, 2 },
+        { SAIL_PIXEL_FORMAT_BPP4_INDEXED, 5 },
+        { SAIL_PIXEL_FORMAT_BPP8_INDEXED, 5 },
+    };
+
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+        struct sail_image *image = alloc_image_with_colors(37, 11, COLORS, CASES[i].color_count);
+
+        for (size_t d = 0; d < DITHERS_LENGTH; d++) {
+            struct sail_image *image_output = NULL;
+            munit_assert(sail_quantize_image(image, CASES[i].pixel_format, 0, DITHERS[d], &image_output) == SAIL_OK);
+
+            munit_assert(image_output->pixel_format == CASES[i].pixel_format);
+            munit_assert_not_null(image_output->palette);
+            munit_assert(image_output->palette->pixel_format == SAIL_PIXEL_FORMAT_BPP24_RGB);
+            munit_assert_uint(image_output->palette->color_count, ==, CASES[i].color_count);
+
+            /* Few colors are converted losslessly. */
+            struct sail_image *image_rgb = expand(image_output);
+            munit_assert_memory_equal((size_t)image->bytes_per_line * image->height, image_rgb->pixels, image->pixels);
+
+            sail_destroy_image(image_rgb);
+            sail_destroy_image(image_output);
+        }
+
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_many_colors(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_gradient_image(256, 256);
+
+    static const struct {
+        enum SailPixelFormat pixel_format;
+        unsigned max_colors;
+        double max_error;
+    } CASES[] = {
+        { SAIL_PIXEL_FORMAT_BPP8_INDEXED, 0,  4  },
+        { SAIL_PIXEL_FORMAT_BPP8_INDEXED, 64, 8  },
+        { SAIL_PIXEL_FORMAT_BPP4_INDEXED, 0,  16 },
+        { SAIL_PIXEL_FORMAT_BPP2_INDEXED, 3,  40 },
+    };
+
+    for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++) {
+        double error_without_dithering = 0;
+
+        for (size_t d = 0; d < DITHERS_LENGTH; d++) {
+            struct sail_image *image_output = NULL;
+            munit_assert(sail_quantize_image(image, CASES[i].pixel_format, CASES[i].max_colors, DITHERS[d], &image_output) == SAIL_OK);
+
+            unsigned bits_per_pixel;
+            munit_assert(sail_bits_per_pixel(CASES[i].pixel_format, &bits_per_pixel) == SAIL_OK);
+            const unsigned max_colors = (CASES[i].max_colors == 0) ? 1u << bits_per_pixel : CASES[i].max_colors;
+
+            munit_assert_uint(image_output->palette->color_count, ==, max_colors);
+
+            /* Expanding fails on out of range indexes. */
+            struct sail_image *image_rgb = expand(image_output);
+            const double error = mean_block_error(image, image_rgb);
+            munit_assert_double(error, <, CASES[i].max_error);
+
+            if (DITHERS[d] == SAIL_DITHER_NONE) {
+                error_without_dithering = error;
+            } else {
+                munit_assert_double(error, <, error_without_dithering);
+            }
+
+            sail_destroy_image(image_rgb);
+            sail_destroy_image(image_output);
+        }
+    }
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_gradient_image(1000, 700);
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    for (size_t d = 0; d < DITHERS_LENGTH; d++) {
+        struct sail_image *image_output1 = NULL;
+        options->threads = 1;
+        munit_assert(sail_quantize_image_with_options(image, SAIL_PIXEL_FORMAT_BPP8_INDEXED, 0, DITHERS[d], options, &image_output1) == SAIL_OK);
+
+        struct sail_image *image_output4 = NULL;
+        options->threads = 4;
+        munit_assert(sail_quantize_image_with_options(image, SAIL_PIXEL_FORMAT_BPP8_INDEXED, 0, DITHERS[d], options, &image_output4) == SAIL_OK);
+
+        munit_assert_memory_equal((size_t)image_output1->bytes_per_line * image_output1->height, image_output4->pixels, image_output1->pixels);
+        munit_assert_memory_equal(image_output1->palette->color_count * 3, image_output4->palette->data, image_output1->palette->data);
+
+        sail_destroy_image(image_output4);
+        sail_destroy_image(image_output1);
+    }
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_alpha(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_image(4, 1, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+    static const uint8_t PIXELS[] = { 255, 0, 0, 255,   255, 0, 0, 0,   0, 0, 255, 255,   0, 0, 255, 0 };
+    memcpy(image->pixels, PIXELS, sizeof(PIXELS));
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->options = SAIL_CONVERSION_OPTION_BLEND_ALPHA;
+    options->background24 = (sail_rgb24_t){ 0, 255, 0 };
+
+    /* Transparent pixels are blended with green. */
+    struct sail_image *image_output = NULL;
+    munit_assert(sail_quantize_image_with_options(image, SAIL_PIXEL_FORMAT_BPP2_INDEXED, 0, SAIL_DITHER_NONE, options, &image_output) == SAIL_OK);
+    munit_assert_uint(image_output->palette->color_count, ==, 3);
+
+    struct sail_image *image_rgb = expand(image_output);
+    static const uint8_t EXPECTED[] = { 255, 0, 0,   0, 255, 0,   0, 0, 255,   0, 255, 0 };
+    munit_assert_memory_equal(sizeof(EXPECTED), image_rgb->pixels, EXPECTED);
+
+    sail_destroy_image(image_rgb);
+    sail_destroy_image(image_output);
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_invalid_arguments(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = alloc_gradient_image(8, 8);
+    struct sail_image *image_output = NULL;
+
+    munit_assert(sail_quantize_image(image, SAIL_PIXEL_FORMAT_BPP24_RGB, 0, SAIL_DITHER_NONE, &image_output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_quantize_image(image, SAIL_PIXEL_FORMAT_BPP4_INDEXED, 17, SAIL_DITHER_NONE, &image_output) == SAIL_ERROR_INVALID_ARGUMENT);
+    munit_assert_null(image_output);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/exact-colors", test_exact_colors, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/many-colors", test_many_colors, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads", test_threads, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/alpha", test_alpha, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/invalid-arguments", test_invalid_arguments, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/quantize",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
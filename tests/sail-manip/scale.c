@@ -0,0 +1,257 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static const enum SailScaling ALGORITHMS[] = {
+    SAIL_SCALING_BOX,
+    SAIL_SCALING_BILINEAR,
+    SAIL_SCALING_BICUBIC,
+    SAIL_SCALING_LANCZOS3,
+};
+
+static const size_t ALGORITHMS_LENGTH = sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]);
+
+/* Fills every pixel with the same bytes. */
+static void fill_image(struct sail_image *image, const void *pixel, unsigned pixel_size) {
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            memcpy(scan + (size_t)column * pixel_size, pixel, pixel_size);
+        }
+    }
+}
+
+static void assert_image_filled(const struct sail_image *image, const void *pixel, unsigned pixel_size) {
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            munit_assert_memory_equal(pixel_size, scan + (size_t)column * pixel_size, pixel);
+        }
+    }
+}
+
+static void assert_images_equal(const struct sail_image *image1, const struct sail_image *image2) {
+
+    munit_assert_uint(image1->width, ==, image2->width);
+    munit_assert_uint(image1->height, ==, image2->height);
+    munit_assert_int(image1->pixel_format, ==, image2->pixel_format);
+
+    unsigned bits_per_pixel;
+    munit_assert(sail_bits_per_pixel(image1->pixel_format, &bits_per_pixel) == SAIL_OK);
+
+    for (unsigned row = 0; row < image1->height; row++) {
+        munit_assert_memory_equal((image1->width * bits_per_pixel + 7) / 8,
+                                  (uint8_t *)image1->pixels + (size_t)image1->bytes_per_line * row,
+                                  (uint8_t *)image2->pixels + (size_t)image2->bytes_per_line * row);
+    }
+}
+
+static MunitResult test_flat(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const uint8_t gray8[] = { 77 };
+    const uint8_t rgb24[] = { 1, 128, 255 };
+    const uint8_t rgba32[] = { 10, 20, 30, 40 };
+    const uint16_t rgb565[] = { 0xF81F };
+    const uint16_t rgba64[] = { 0, 1000, 65535, 32768 };
+
+    const struct {
+        enum SailPixelFormat pixel_format;
+        const void *pixel;
+        unsigned pixel_size;
+    } formats[] = {
+        { SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE, gray8,  sizeof(gray8)  },
+        { SAIL_PIXEL_FORMAT_BPP24_BGR,      rgb24,  sizeof(rgb24)  },
+        { SAIL_PIXEL_FORMAT_BPP32_ARGB,     rgba32, sizeof(rgba32) },
+        { SAIL_PIXEL_FORMAT_BPP16_RGB565,   rgb565, sizeof(rgb565) },
+        { SAIL_PIXEL_FORMAT_BPP64_RGBA,     rgba64, sizeof(rgba64) },
+    };
+
+    const unsigned sizes[][2] = { { 1, 1 }, { 7, 3 }, { 40, 30 }, { 123, 71 } };
+
+    /* Weights always sum up to 1, so flat images stay exactly flat. */
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+        struct sail_image *image = sail_test_alloc_image(40, 30, formats[f].pixel_format);
+        fill_image(image, formats[f].pixel, formats[f].pixel_size);
+
+        for (size_t a = 0; a < ALGORITHMS_LENGTH; a++) {
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+                struct sail_image *image_output = NULL;
+                munit_assert(sail_scale_image(image, sizes[s][0], sizes[s][1], ALGORITHMS[a], &image_output) == SAIL_OK);
+
+                munit_assert_uint(image_output->width, ==, sizes[s][0]);
+                munit_assert_uint(image_output->height, ==, sizes[s][1]);
+                munit_assert_int(image_output->pixel_format, ==, formats[f].pixel_format);
+                assert_image_filled(image_output, formats[f].pixel, formats[f].pixel_size);
+
+                sail_destroy_image(image_output);
+            }
+        }
+
+        sail_destroy_image(image);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_identity(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_random_image(33, 17, SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    /* All the filters are 1 at 0 and 0 at other integers, so the same size gives the same pixels. */
+    for (size_t a = 0; a < ALGORITHMS_LENGTH; a++) {
+        struct sail_image *image_output = NULL;
+        munit_assert(sail_scale_image(image, image->width, image->height, ALGORITHMS[a], &image_output) == SAIL_OK);
+
+        assert_images_equal(image, image_output);
+
+        sail_destroy_image(image_output);
+    }
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_box(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_image(4, 2, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+
+    const uint8_t gray8[] = {
+        0,  10, 100, 254,
+        20, 30, 100, 0,
+    };
+    memcpy(image->pixels, gray8, sizeof(gray8));
+
+    struct sail_image *image_output = NULL;
+    munit_assert(sail_scale_image(image, 2, 1, SAIL_SCALING_BOX, &image_output) == SAIL_OK);
+
+    /* Averages of 2x2 blocks rounded to the nearest. */
+    const uint8_t expected[] = { 15, 114 };
+    munit_assert_memory_equal(sizeof(expected), image_output->pixels, expected);
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_threads(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_random_image(1000, 700, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    struct sail_conversion_options *options = NULL;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    for (size_t a = 0; a < ALGORITHMS_LENGTH; a++) {
+        struct sail_image *expected = NULL;
+        munit_assert(sail_scale_image(image, 301, 997, ALGORITHMS[a], &expected) == SAIL_OK);
+
+        const unsigned threads[] = { 0, 2, 7, SAIL_THREADS_AUTO };
+
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+            options->threads = threads[t];
+
+            struct sail_image *image_output = NULL;
+            munit_assert(sail_scale_image_with_options(image, 301, 997, ALGORITHMS[a], options, &image_output) == SAIL_OK);
+
+            assert_images_equal(expected, image_output);
+
+            sail_destroy_image(image_output);
+        }
+
+        sail_destroy_image(expected);
+    }
+
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_errors(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_image(4, 4, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    memset(image->pixels, 0, (size_t)image->bytes_per_line * image->height);
+
+    struct sail_image *image_output = NULL;
+
+    munit_assert(sail_scale_image(image, 0, 4, SAIL_SCALING_BOX, &image_output) == SAIL_ERROR_INCORRECT_IMAGE_DIMENSIONS);
+    munit_assert(sail_scale_image(image, 4, 4, (enum SailScaling)100, &image_output) == SAIL_ERROR_INVALID_ARGUMENT);
+
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP32_CMYK;
+    munit_assert(sail_scale_image(image, 2, 2, SAIL_SCALING_BOX, &image_output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    munit_assert_null(image_output);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/flat",     test_flat,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/identity", test_identity, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/box",      test_box,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/threads",  test_threads,  NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/errors",   test_errors,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/scale",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
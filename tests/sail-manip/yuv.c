@@ -0,0 +1,449 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static const enum SailPixelFormat PLANAR_PIXEL_FORMATS[] = {
+    SAIL_PIXEL_FORMAT_BPP12_I420,
+    SAIL_PIXEL_FORMAT_BPP12_NV12,
+    SAIL_PIXEL_FORMAT_BPP24_YUV444P,
+};
+
+static const size_t PLANAR_PIXEL_FORMATS_LENGTH = sizeof(PLANAR_PIXEL_FORMATS) / sizeof(PLANAR_PIXEL_FORMATS[0]);
+
+/* 8-bit RGB formats are converted directly, BPP48-RGB and BPP8-GRAYSCALE go through BPP32-RGBA. */
+static const enum SailPixelFormat RGB_PIXEL_FORMATS[] = {
+    SAIL_PIXEL_FORMAT_BPP24_RGB,
+    SAIL_PIXEL_FORMAT_BPP24_BGR,
+    SAIL_PIXEL_FORMAT_BPP32_RGBA,
+    SAIL_PIXEL_FORMAT_BPP32_ABGR,
+    SAIL_PIXEL_FORMAT_BPP32_XRGB,
+    SAIL_PIXEL_FORMAT_BPP48_RGB,
+};
+
+static const size_t RGB_PIXEL_FORMATS_LENGTH = sizeof(RGB_PIXEL_FORMATS) / sizeof(RGB_PIXEL_FORMATS[0]);
+
+/* Odd sizes exercise replicated chroma, 35 pixels exercise SIMD blocks and tails. */
+static const unsigned SIZES[][2] = {
+    { 35, 9 },
+    { 16, 4 },
+    { 1,  1 },
+    { 2,  3 },
+};
+
+static const size_t SIZES_LENGTH = sizeof(SIZES) / sizeof(SIZES[0]);
+
+struct yuv_reference {
+    double kr, kg, kb;
+    double y_range, chroma_range, y_bias;
+};
+
+static struct yuv_reference yuv_reference(enum SailYuvMatrix matrix, enum SailYuvRange range) {
+
+    struct yuv_reference reference;
+
+    reference.kr = (matrix == SAIL_YUV_MATRIX_BT709) ? 0.2126 : 0.299;
+    reference.kb = (matrix == SAIL_YUV_MATRIX_BT709) ? 0.0722 : 0.114;
+    reference.kg = 1 - reference.kr - reference.kb;
+
+    reference.y_range      = (range == SAIL_YUV_RANGE_LIMITED) ? 219.0 / 255 : 1;
+    reference.chroma_range = (range == SAIL_YUV_RANGE_LIMITED) ? 224.0 / 255 : 1;
+    reference.y_bias       = (range == SAIL_YUV_RANGE_LIMITED) ? 16 : 0;
+
+    return reference;
+}
+
+static void rgb_to_yuv_reference(const struct yuv_reference *ref, double r, double g, double b, double *y, double *u, double *v) {
+
+    const double luma = ref->kr * r + ref->kg * g + ref->kb * b;
+
+    *y = luma * ref->y_range + ref->y_bias;
+    *u = (b - luma) / (2 * (1 - ref->kb)) * ref->chroma_range + 128;
+    *v = (r - luma) / (2 * (1 - ref->kr)) * ref->chroma_range + 128;
+}
+
+static double clamp255(double value) {
+
+    return (value < 0) ? 0 : (value > 255) ? 255 : value;
+}
+
+static void yuv_to_rgb_reference(const struct yuv_reference *ref, double y, double u, double v, double *r, double *g, double *b) {
+
+    const double luma = (y - ref->y_bias) / ref->y_range;
+    const double cb = (u - 128) / ref->chroma_range;
+    const double cr = (v - 128) / ref->chroma_range;
+
+    *r = clamp255(luma + 2 * (1 - ref->kr) * cr);
+    *b = clamp255(luma + 2 * (1 - ref->kb) * cb);
+    *g = clamp255(luma - 2 * ref->kb * (1 - ref->kb) / ref->kg * cb - 2 * ref->kr * (1 - ref->kr) / ref->kg * cr);
+}
+
+/* Reads an 8-bit RGB pixel through BPP32-RGBA as the generic path does. */
+static void rgb_pixel(const struct sail_image *image_rgba, unsigned row, unsigned column, double rgb[3]) {
+
+    const uint8_t *pixel = (const uint8_t *)image_rgba->pixels + (size_t)image_rgba->bytes_per_line * row + (size_t)column * 4;
+
+    rgb[0] = pixel[0];
+    rgb[1] = pixel[1];
+    rgb[2] = pixel[2];
+}
+
+/* Returns the chroma sample of the pixel. */
+static void chroma_sample(const struct sail_image *image, const struct sail_image_plane planes[], unsigned row, unsigned column,
+                          uint8_t *u, uint8_t *v) {
+
+    switch (image->pixel_format) {
+        case SAIL_PIXEL_FORMAT_BPP12_I420: {
+            *u = ((const uint8_t *)planes[1].pixels)[(size_t)planes[1].bytes_per_line * (row / 2) + column / 2];
+            *v = ((const uint8_t *)planes[2].pixels)[(size_t)planes[2].bytes_per_line * (row / 2) + column / 2];
+            break;
+        }
+        case SAIL_PIXEL_FORMAT_BPP12_NV12: {
+            const uint8_t *uv = (const uint8_t *)planes[1].pixels + (size_t)planes[1].bytes_per_line * (row / 2) + (column / 2) * 2;
+            *u = uv[0];
+            *v = uv[1];
+            break;
+        }
+        default: {
+            *u = ((const uint8_t *)planes[1].pixels)[(size_t)planes[1].bytes_per_line * row + column];
+            *v = ((const uint8_t *)planes[2].pixels)[(size_t)planes[2].bytes_per_line * row + column];
+            break;
+        }
+    }
+}
+
+static void assert_yuv_matches_reference(const struct sail_image *image_rgba, const struct sail_image *image_yuv,
+                                         const struct yuv_reference *ref) {
+
+    struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES];
+    unsigned planes_count;
+    munit_assert(sail_image_planes(image_yuv, planes, &planes_count) == SAIL_OK);
+
+    const bool subsampled = image_yuv->pixel_format != SAIL_PIXEL_FORMAT_BPP24_YUV444P;
+
+    for (unsigned row = 0; row < image_rgba->height; row++) {
+        for (unsigned column = 0; column < image_rgba->width; column++) {
+            double rgb[3];
+            rgb_pixel(image_rgba, row, column, rgb);
+
+            double y, u, v;
+            rgb_to_yuv_reference(ref, rgb[0], rgb[1], rgb[2], &y, &u, &v);
+
+            const uint8_t actual_y = ((const uint8_t *)planes[0].pixels)[(size_t)planes[0].bytes_per_line * row + column];
+            munit_assert_double(fabs(actual_y - y), <=, 1);
+
+            /* Chroma of 2x2 blocks is computed from the average color with replicated edges. */
+            if (subsampled) {
+                if (row % 2 != 0 || column % 2 != 0) {
+                    continue;
+                }
+
+                const unsigned row1 = (row + 1 < image_rgba->height) ? row + 1 : row;
+                const unsigned column1 = (column + 1 < image_rgba->width) ? column + 1 : column;
+                double sum[3] = { 0, 0, 0 };
+                double block[4][3];
+                rgb_pixel(image_rgba, row,  column,  block[0]);
+                rgb_pixel(image_rgba, row,  column1, block[1]);
+                rgb_pixel(image_rgba, row1, column,  block[2]);
+                rgb_pixel(image_rgba, row1, column1, block[3]);
+
+                for (int i = 0; i < 4; i++) {
+                    for (int c = 0; c < 3; c++) {
+                        sum[c] += block[i][c] / 4;
+                    }
+                }
+
+                rgb_to_yuv_reference(ref, sum[0], sum[1], sum[2], &y, &u, &v);
+            }
+
+            uint8_t actual_u, actual_v;
+            chroma_sample(image_yuv, planes, row, column, &actual_u, &actual_v);
+
+            munit_assert_double(fabs(actual_u - u), <=, 1.5);
+            munit_assert_double(fabs(actual_v - v), <=, 1.5);
+        }
+    }
+}
+
+static MunitResult test_to_yuv(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    for (int matrix = SAIL_YUV_MATRIX_BT601; matrix <= SAIL_YUV_MATRIX_BT709; matrix++) {
+        for (int range = SAIL_YUV_RANGE_FULL; range <= SAIL_YUV_RANGE_LIMITED; range++) {
+            options->yuv_matrix = (enum SailYuvMatrix)matrix;
+            options->yuv_range  = (enum SailYuvRange)range;
+            const struct yuv_reference ref = yuv_reference(options->yuv_matrix, options->yuv_range);
+
+            for (size_t s = 0; s < SIZES_LENGTH; s++) {
+                for (size_t i = 0; i < RGB_PIXEL_FORMATS_LENGTH; i++) {
+                    struct sail_image *image = sail_test_alloc_random_image(SIZES[s][0], SIZES[s][1], RGB_PIXEL_FORMATS[i]);
+
+                    /* The reference colors. */
+                    struct sail_image *image_rgba;
+                    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_rgba) == SAIL_OK);
+
+                    for (size_t k = 0; k < PLANAR_PIXEL_FORMATS_LENGTH; k++) {
+                        munit_assert(sail_can_convert(image->pixel_format, PLANAR_PIXEL_FORMATS[k]));
+
+                        struct sail_image *image_yuv;
+                        munit_assert(sail_convert_image_with_options(image, PLANAR_PIXEL_FORMATS[k], options, &image_yuv) == SAIL_OK);
+                        munit_assert(image_yuv->pixel_format == PLANAR_PIXEL_FORMATS[k]);
+                        munit_assert(image_yuv->bytes_per_line == image->width);
+
+                        assert_yuv_matches_reference(image_rgba, image_yuv, &ref);
+
+                        sail_destroy_image(image_yuv);
+                    }
+
+                    sail_destroy_image(image_rgba);
+                    sail_destroy_image(image);
+                }
+            }
+        }
+    }
+
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_from_yuv(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+
+    for (int matrix = SAIL_YUV_MATRIX_BT601; matrix <= SAIL_YUV_MATRIX_BT709; matrix++) {
+        for (int range = SAIL_YUV_RANGE_FULL; range <= SAIL_YUV_RANGE_LIMITED; range++) {
+            options->yuv_matrix = (enum SailYuvMatrix)matrix;
+            options->yuv_range  = (enum SailYuvRange)range;
+            const struct yuv_reference ref = yuv_reference(options->yuv_matrix, options->yuv_range);
+
+            for (size_t s = 0; s < SIZES_LENGTH; s++) {
+                for (size_t k = 0; k < PLANAR_PIXEL_FORMATS_LENGTH; k++) {
+                    struct sail_image *image_yuv = sail_test_alloc_random_image(SIZES[s][0], SIZES[s][1], PLANAR_PIXEL_FORMATS[k]);
+
+                    struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES];
+                    unsigned planes_count;
+                    munit_assert(sail_image_planes(image_yuv, planes, &planes_count) == SAIL_OK);
+
+                    for (size_t i = 0; i < RGB_PIXEL_FORMATS_LENGTH; i++) {
+                        munit_assert(sail_can_convert(PLANAR_PIXEL_FORMATS[k], RGB_PIXEL_FORMATS[i]));
+
+                        struct sail_image *image;
+                        munit_assert(sail_convert_image_with_options(image_yuv, RGB_PIXEL_FORMATS[i], options, &image) == SAIL_OK);
+
+                        struct sail_image *image_rgba;
+                        munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_rgba) == SAIL_OK);
+
+                        for (unsigned row = 0; row < image_yuv->height; row++) {
+                            for (unsigned column = 0; column < image_yuv->width; column++) {
+                                const uint8_t y = ((const uint8_t *)planes[0].pixels)[(size_t)planes[0].bytes_per_line * row + column];
+                                uint8_t u, v;
+                                chroma_sample(image_yuv, planes, row, column, &u, &v);
+
+                                double expected[3];
+                                yuv_to_rgb_reference(&ref, y, u, v, &expected[0], &expected[1], &expected[2]);
+
+                                double actual[3];
+                                rgb_pixel(image_rgba, row, column, actual);
+
+                                for (int c = 0; c < 3; c++) {
+                                    munit_assert_double(fabs(actual[c] - expected[c]), <=, 1);
+                                }
+                            }
+                        }
+
+                        sail_destroy_image(image_rgba);
+                        sail_destroy_image(image);
+                    }
+
+                    sail_destroy_image(image_yuv);
+                }
+            }
+        }
+    }
+
+    sail_destroy_conversion_options(options);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_round_trip(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_random_image(67, 5, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+
+    /* Gray pixels survive any matrix in full range exactly. */
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            if (column % 3 == 0) {
+                scan[column * 4 + 1] = scan[column * 4 + 2] = scan[column * 4];
+            }
+            scan[column * 4 + 3] = 255;
+        }
+    }
+
+    struct sail_conversion_options *options;
+    munit_assert(sail_alloc_conversion_options(&options) == SAIL_OK);
+    options->yuv_matrix = SAIL_YUV_MATRIX_BT709;
+
+    struct sail_image *image_yuv;
+    munit_assert(sail_convert_image_with_options(image, SAIL_PIXEL_FORMAT_BPP24_YUV444P, options, &image_yuv) == SAIL_OK);
+
+    struct sail_image *image_output;
+    munit_assert(sail_convert_image_with_options(image_yuv, SAIL_PIXEL_FORMAT_BPP32_BGRA, options, &image_output) == SAIL_OK);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        const uint8_t *scan = (const uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+        const uint8_t *scan_output = (const uint8_t *)image_output->pixels + (size_t)image_output->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width * 4; column++) {
+            if (column / 4 % 3 == 0) {
+                munit_assert_uint8(scan_output[column], ==, scan[column]);
+            } else {
+                munit_assert_int(abs(scan_output[column] - scan[column]), <=, 2);
+            }
+        }
+    }
+
+    sail_destroy_image(image_output);
+    sail_destroy_image(image_yuv);
+    sail_destroy_conversion_options(options);
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_planes(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image = sail_test_alloc_random_image(5, 3, SAIL_PIXEL_FORMAT_BPP12_I420);
+    image->bytes_per_line = 7;
+
+    struct sail_image_plane planes[SAIL_MAX_IMAGE_PLANES];
+    unsigned planes_count;
+    size_t pixels_size;
+
+    munit_assert(sail_image_planes(image, planes, &planes_count) == SAIL_OK);
+    munit_assert_uint(planes_count, ==, 3);
+    munit_assert_uint(planes[1].width, ==, 3);
+    munit_assert_uint(planes[1].height, ==, 2);
+    munit_assert_uint(planes[1].bytes_per_line, ==, 4);
+    munit_assert_ptr_equal(planes[1].pixels, (uint8_t *)image->pixels + 7 * 3);
+    munit_assert_ptr_equal(planes[2].pixels, (uint8_t *)image->pixels + 7 * 3 + 4 * 2);
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_assert_size(pixels_size, ==, 7 * 3 + 4 * 2 * 2);
+
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP12_NV12;
+    munit_assert(sail_image_planes(image, planes, &planes_count) == SAIL_OK);
+    munit_assert_uint(planes_count, ==, 2);
+    munit_assert_uint(planes[1].bytes_per_line, ==, 8);
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_assert_size(pixels_size, ==, 7 * 3 + 8 * 2);
+
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP24_YUV444P;
+    munit_assert(sail_image_planes(image, planes, &planes_count) == SAIL_OK);
+    munit_assert_uint(planes_count, ==, 3);
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_assert_size(pixels_size, ==, 7 * 3 * 3);
+
+    /* Packed pixel formats have a single plane. */
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;
+    munit_assert(sail_image_planes(image, planes, &planes_count) == SAIL_OK);
+    munit_assert_uint(planes_count, ==, 1);
+    munit_assert_ptr_equal(planes[0].pixels, image->pixels);
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_assert_size(pixels_size, ==, 7 * 3);
+
+    sail_destroy_image(image);
+
+    munit_assert_string_equal(sail_pixel_format_to_string(SAIL_PIXEL_FORMAT_BPP12_NV12), "BPP12-NV12");
+    munit_assert(sail_pixel_format_from_string("BPP24-YUV444P") == SAIL_PIXEL_FORMAT_BPP24_YUV444P);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_errors(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    munit_assert(!sail_can_convert(SAIL_PIXEL_FORMAT_BPP12_I420, SAIL_PIXEL_FORMAT_BPP12_NV12));
+    munit_assert(!sail_can_convert(SAIL_PIXEL_FORMAT_BPP12_I420, SAIL_PIXEL_FORMAT_BPP24_CIE_LAB));
+    munit_assert(sail_can_convert(SAIL_PIXEL_FORMAT_BPP8_INDEXED, SAIL_PIXEL_FORMAT_BPP12_I420));
+
+    struct sail_image *image = sail_test_alloc_random_image(6, 4, SAIL_PIXEL_FORMAT_BPP12_I420);
+    struct sail_image *image_output = NULL;
+
+    munit_assert(sail_update_image(image, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_convert_image(image, SAIL_PIXEL_FORMAT_BPP12_NV12, &image_output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_flip_image(image, SAIL_FLIP_VERTICALLY) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_rotate_image(image, SAIL_ROTATION_90, &image_output) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+
+    sail_destroy_image(image);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/to-yuv",     test_to_yuv,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/from-yuv",   test_from_yuv,   NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/round-trip", test_round_trip, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/planes",     test_planes,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/errors",     test_errors,     NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/yuv",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,71 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "sail-common.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+struct sail_image* sail_test_alloc_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format) {
+
+    struct sail_image *image = NULL;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+
+    image->width        = width;
+    image->height       = height;
+    image->pixel_format = pixel_format;
+    munit_assert(sail_bytes_per_line(width, pixel_format, &image->bytes_per_line) == SAIL_OK);
+
+    size_t pixels_size;
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_assert(sail_malloc(pixels_size, &image->pixels) == SAIL_OK);
+
+    return image;
+}
+
+struct sail_image* sail_test_alloc_random_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, pixel_format);
+
+    size_t pixels_size;
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_rand_memory(pixels_size, image->pixels);
+
+    return image;
+}
+
+struct sail_image* sail_test_alloc_image_from_pixels(unsigned width, unsigned height, enum SailPixelFormat pixel_format, const void *pixels) {
+
+    struct sail_image *image = sail_test_alloc_image(width, height, pixel_format);
+
+    size_t pixels_size;
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    memcpy(image->pixels, pixels, pixels_size);
+
+    return image;
+}
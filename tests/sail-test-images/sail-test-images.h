@@ -0,0 +1,51 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef SAIL_TEST_IMAGES_H
+#define SAIL_TEST_IMAGES_H
+
+#include "common.h"
+#include "export.h"
+
+struct sail_image;
+
+/*
+ * Allocates a new image with uninitialized pixels. Planar images get all their planes.
+ * Fails the running test on error.
+ */
+SAIL_EXPORT struct sail_image* sail_test_alloc_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format);
+
+/*
+ * Allocates a new image with random pixels. Fails the running test on error.
+ */
+SAIL_EXPORT struct sail_image* sail_test_alloc_random_image(unsigned width, unsigned height, enum SailPixelFormat pixel_format);
+
+/*
+ * Allocates a new image and copies sail_image_pixels_size() bytes of the specified pixels into it.
+ * Fails the running test on error.
+ */
+SAIL_EXPORT struct sail_image* sail_test_alloc_image_from_pixels(unsigned width, unsigned height, enum SailPixelFormat pixel_format, const void *pixels);
+
+#endif
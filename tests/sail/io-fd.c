@@ -0,0 +1,194 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+    #include <io.h>
+
+    #define open_for_reading(path) _open(path, _O_RDONLY | _O_BINARY)
+    #define close_fd               _close
+#else
+    #include <unistd.h>
+
+    #define open_for_reading(path) open(path, O_RDONLY)
+    #define close_fd               close
+#endif
+
+#include "sail-common.h"
+#include "sail.h"
+
+#include "munit.h"
+
+static const char *PATH = "io-fd.png";
+
+static void write_test_file(struct sail_image **image) {
+
+    struct sail_image *image_local;
+    munit_assert(sail_alloc_image(&image_local) == SAIL_OK);
+    image_local->width = 83;
+    image_local->height = 47;
+    image_local->pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;
+    munit_assert(sail_bytes_per_line(image_local->width, image_local->pixel_format, &image_local->bytes_per_line) == SAIL_OK);
+
+    const size_t pixels_size = (size_t)image_local->bytes_per_line * image_local->height;
+    munit_assert(sail_malloc(pixels_size, &image_local->pixels) == SAIL_OK);
+
+    for (size_t i = 0; i < pixels_size; i++) {
+        ((uint8_t *)image_local->pixels)[i] = (uint8_t)(i * 7 + i / 251);
+    }
+
+    munit_assert(sail_write_file(PATH, image_local) == SAIL_OK);
+
+    *image = image_local;
+}
+
+static void read_and_compare(struct sail_io *io, const struct sail_image *image_expected) {
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("png", &codec_info) == SAIL_OK);
+
+    void *state;
+    munit_assert(sail_start_reading_io(io, codec_info, &state) == SAIL_OK);
+
+    struct sail_image *image;
+    munit_assert(sail_read_next_frame(state, &image) == SAIL_OK);
+    munit_assert(sail_stop_reading(state) == SAIL_OK);
+
+    munit_assert(image->pixel_format == image_expected->pixel_format);
+    munit_assert_uint(image->bytes_per_line, ==, image_expected->bytes_per_line);
+    munit_assert_memory_equal((size_t)image->bytes_per_line * image->height, image->pixels, image_expected->pixels);
+
+    sail_destroy_image(image);
+}
+
+static MunitResult test_read(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image_source;
+    write_test_file(&image_source);
+
+    const int fd = open_for_reading(PATH);
+    munit_assert_int(fd, >=, 0);
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_fd(fd, &io) == SAIL_OK);
+    munit_assert(io->id == SAIL_FD_IO_ID);
+
+    read_and_compare(io, image_source);
+
+    sail_destroy_io(io);
+    munit_assert_int(close_fd(fd), ==, 0);
+    munit_assert_int(remove(PATH), ==, 0);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_clone(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image_source;
+    write_test_file(&image_source);
+
+    const int fd = open_for_reading(PATH);
+    munit_assert_int(fd, >=, 0);
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io_read_fd(fd, &io) == SAIL_OK);
+
+    unsigned char signature[8];
+    munit_assert(io->strict_read(io->stream, signature, sizeof(signature)) == SAIL_OK);
+
+    /* The clone starts at the same position. */
+    struct sail_io *io_clone;
+    munit_assert(sail_clone_io_fd(io, &io_clone) == SAIL_OK);
+
+    size_t offset;
+    munit_assert(io_clone->tell(io_clone->stream, &offset) == SAIL_OK);
+    munit_assert_size(offset, ==, sizeof(signature));
+
+    /* Then the positions are independent. */
+    unsigned char chunk[16];
+    unsigned char chunk_clone[16];
+    munit_assert(io_clone->strict_read(io_clone->stream, chunk_clone, sizeof(chunk_clone)) == SAIL_OK);
+    munit_assert(io->tell(io->stream, &offset) == SAIL_OK);
+    munit_assert_size(offset, ==, sizeof(signature));
+    munit_assert(io->strict_read(io->stream, chunk, sizeof(chunk)) == SAIL_OK);
+    munit_assert_memory_equal(sizeof(chunk), chunk, chunk_clone);
+
+    /* Whole images can be read through both I/O objects. */
+    munit_assert(io->seek(io->stream, 0, SEEK_SET) == SAIL_OK);
+    munit_assert(io_clone->seek(io_clone->stream, 0, SEEK_SET) == SAIL_OK);
+    read_and_compare(io_clone, image_source);
+    read_and_compare(io, image_source);
+
+    sail_destroy_io(io_clone);
+    sail_destroy_io(io);
+    munit_assert_int(close_fd(fd), ==, 0);
+    munit_assert_int(remove(PATH), ==, 0);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_clone_not_fd(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_io *io;
+    munit_assert(sail_alloc_io(&io) == SAIL_OK);
+
+    struct sail_io *io_clone;
+    munit_assert(sail_clone_io_fd(io, &io_clone) == SAIL_ERROR_INVALID_IO);
+
+    sail_destroy_io(io);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/read",         test_read,         NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/clone",        test_clone,        NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/clone-not-fd", test_clone_not_fd, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/io-fd",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
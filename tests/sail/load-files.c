@@ -0,0 +1,334 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+
+#include "sail-common.h"
+#include "sail.h"
+
+#include "munit.h"
+
+#define FILES 12
+
+/* Valid images followed by an empty file and a missing file. */
+#define PATHS (FILES + 2)
+
+static const char *PATH_TEMPLATE = "load-files-%d.png";
+static const char *EMPTY_PATH    = "load-files-empty.png";
+static const char *MISSING_PATH  = "load-files-missing.png";
+
+struct load_result {
+
+    char paths_storage[FILES][64];
+    const char *paths[PATHS];
+
+    /* The expected file contents. */
+    void *contents[FILES];
+    size_t contents_length[FILES];
+
+    unsigned calls[PATHS];
+    sail_status_t statuses[PATHS];
+    size_t lengths[PATHS];
+
+    /* Stop loading after this number of callback calls. 0 means never. */
+    unsigned stop_after;
+    unsigned total_calls;
+};
+
+#ifdef __NR_io_uring_enter
+/* Fail io_uring_enter() when it's called this number of times. 0 means never. */
+static unsigned fail_io_uring_enter_at;
+static unsigned io_uring_enter_calls;
+
+typedef long (*syscall_t)(long number, ...);
+
+/* Overrides syscall() from libc, which libsail uses to set up and enter io_uring. */
+long syscall(long number, ...) {
+
+    static syscall_t real_syscall = NULL;
+
+    if (real_syscall == NULL) {
+        real_syscall = (syscall_t)dlsym(RTLD_NEXT, "syscall");
+
+        if (real_syscall == NULL) {
+            errno = ENOSYS;
+            return -1;
+        }
+    }
+
+    /* Like libc, pass all the six system call arguments on. */
+    long args[6];
+    va_list va;
+    va_start(va, number);
+    for (int i = 0; i < 6; i++) {
+        args[i] = va_arg(va, long);
+    }
+    va_end(va);
+
+    if (number == __NR_io_uring_enter && ++io_uring_enter_calls == fail_io_uring_enter_at) {
+        /* Submit the queued reads without waiting for them, so they are in flight, and fail. */
+        real_syscall(number, args[0], args[1], 0L, 0L, NULL, 0L);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    return real_syscall(number, args[0], args[1], args[2], args[3], args[4], args[5]);
+}
+#endif
+
+static void* setup(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    void *ptr;
+    munit_assert(sail_malloc(sizeof(struct load_result), &ptr) == SAIL_OK);
+    struct load_result *load_result = ptr;
+    memset(load_result, 0, sizeof(*load_result));
+
+    for (int i = 0; i < FILES; i++) {
+        struct sail_image *image;
+        munit_assert(sail_alloc_image(&image) == SAIL_OK);
+        image->width = 16 + i * 9;
+        image->height = 8 + i * 5;
+        image->pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;
+        munit_assert(sail_bytes_per_line(image->width, image->pixel_format, &image->bytes_per_line) == SAIL_OK);
+
+        const size_t pixels_size = (size_t)image->bytes_per_line * image->height;
+        munit_assert(sail_malloc(pixels_size, &image->pixels) == SAIL_OK);
+
+        for (size_t p = 0; p < pixels_size; p++) {
+            ((uint8_t *)image->pixels)[p] = (uint8_t)(p * 13 + (size_t)i);
+        }
+
+        snprintf(load_result->paths_storage[i], sizeof(load_result->paths_storage[i]), PATH_TEMPLATE, i);
+        load_result->paths[i] = load_result->paths_storage[i];
+
+        munit_assert(sail_write_file(load_result->paths[i], image) == SAIL_OK);
+        munit_assert(sail_alloc_buffer_from_file_contents(load_result->paths[i],
+                                                          &load_result->contents[i],
+                                                          &load_result->contents_length[i]) == SAIL_OK);
+
+        sail_destroy_image(image);
+    }
+
+    FILE *fptr = fopen(EMPTY_PATH, "wb");
+    munit_assert_not_null(fptr);
+    munit_assert_int(fclose(fptr), ==, 0);
+
+    load_result->paths[FILES]     = EMPTY_PATH;
+    load_result->paths[FILES + 1] = MISSING_PATH;
+
+    return load_result;
+}
+
+static void tear_down(void *fixture) {
+
+    struct load_result *load_result = fixture;
+
+    for (int i = 0; i < FILES; i++) {
+        munit_assert_int(remove(load_result->paths[i]), ==, 0);
+        sail_free(load_result->contents[i]);
+    }
+
+    munit_assert_int(remove(EMPTY_PATH), ==, 0);
+
+    sail_free(load_result);
+}
+
+static sail_status_t on_file_loaded(size_t index, sail_status_t status, const void *buffer, size_t buffer_length, void *user_data) {
+
+    struct load_result *load_result = user_data;
+
+    munit_assert_size(index, <, PATHS);
+
+    load_result->calls[index]++;
+    load_result->statuses[index] = status;
+    load_result->lengths[index]  = buffer_length;
+
+    if (status == SAIL_OK && index < FILES) {
+        munit_assert_size(buffer_length, ==, load_result->contents_length[index]);
+        munit_assert_memory_equal(buffer_length, buffer, load_result->contents[index]);
+
+        /* Decode through memory I/O. */
+        struct sail_image *image;
+        munit_assert(sail_read_mem(buffer, buffer_length, &image) == SAIL_OK);
+        munit_assert_uint(image->width, ==, 16 + index * 9);
+        sail_destroy_image(image);
+    }
+
+    load_result->total_calls++;
+
+    if (load_result->stop_after > 0 && load_result->total_calls == load_result->stop_after) {
+        return SAIL_ERROR_NOT_IMPLEMENTED;
+    }
+
+    return SAIL_OK;
+}
+
+static void check_all_loaded(const struct load_result *load_result) {
+
+    for (int i = 0; i < FILES; i++) {
+        munit_assert_uint(load_result->calls[i], ==, 1);
+        munit_assert(load_result->statuses[i] == SAIL_OK);
+    }
+
+    munit_assert_uint(load_result->calls[FILES], ==, 1);
+    munit_assert(load_result->statuses[FILES] == SAIL_OK);
+    munit_assert_size(load_result->lengths[FILES], ==, 0);
+
+    munit_assert_uint(load_result->calls[FILES + 1], ==, 1);
+    munit_assert(load_result->statuses[FILES + 1] == SAIL_ERROR_OPEN_FILE);
+}
+
+static MunitResult test_load_files(const MunitParameter params[], void *fixture) {
+    (void)params;
+
+    struct load_result *load_result = fixture;
+
+    munit_assert(sail_load_files(load_result->paths, PATHS, NULL, on_file_loaded, load_result) == SAIL_OK);
+    check_all_loaded(load_result);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_load_files_with_threads(const MunitParameter params[], void *fixture) {
+    (void)params;
+
+    struct load_result *load_result = fixture;
+
+    struct sail_load_files_options options = { 4, 0, SAIL_LOAD_FILES_OPTION_NO_IO_URING };
+
+    munit_assert(sail_load_files(load_result->paths, PATHS, &options, on_file_loaded, load_result) == SAIL_OK);
+    check_all_loaded(load_result);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_load_files_limited(const MunitParameter params[], void *fixture) {
+    (void)params;
+
+    struct load_result *load_result = fixture;
+
+    /* Every file exceeds the limit, so the files are loaded one at a time. */
+    for (int no_io_uring = 0; no_io_uring <= 1; no_io_uring++) {
+        struct sail_load_files_options options = { 3, 1, no_io_uring ? SAIL_LOAD_FILES_OPTION_NO_IO_URING : 0 };
+
+        memset(load_result->calls, 0, sizeof(load_result->calls));
+
+        munit_assert(sail_load_files(load_result->paths, PATHS, &options, on_file_loaded, load_result) == SAIL_OK);
+        check_all_loaded(load_result);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_load_files_stop(const MunitParameter params[], void *fixture) {
+    (void)params;
+
+    struct load_result *load_result = fixture;
+
+    for (int no_io_uring = 0; no_io_uring <= 1; no_io_uring++) {
+        struct sail_load_files_options options = { 4, 0, no_io_uring ? SAIL_LOAD_FILES_OPTION_NO_IO_URING : 0 };
+
+        load_result->stop_after  = 3;
+        load_result->total_calls = 0;
+
+        munit_assert(sail_load_files(load_result->paths, PATHS, &options, on_file_loaded, load_result) == SAIL_ERROR_NOT_IMPLEMENTED);
+        munit_assert_uint(load_result->total_calls, ==, 3);
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_load_files_submit_failure(const MunitParameter params[], void *fixture) {
+    (void)params;
+
+#ifdef __NR_io_uring_enter
+    struct load_result *load_result = fixture;
+
+    struct sail_load_files_options options = { 4, 0, 0 };
+
+    /* The first call submits the first reads, the second one fails with more reads in flight. */
+    io_uring_enter_calls   = 0;
+    fail_io_uring_enter_at  = 2;
+
+    const sail_status_t status = sail_load_files(load_result->paths, PATHS, &options, on_file_loaded, load_result);
+    const unsigned calls = io_uring_enter_calls;
+
+    fail_io_uring_enter_at = 0;
+
+    if (calls == 0) {
+        return MUNIT_SKIP;
+    }
+
+    munit_assert(status == SAIL_ERROR_READ_FILE);
+
+    /* The reads in flight are cancelled and reaped before their buffers are freed. */
+    munit_assert_uint(calls, >, 2);
+
+    /* Loading works afterwards. */
+    memset(load_result->calls, 0, sizeof(load_result->calls));
+    munit_assert(sail_load_files(load_result->paths, PATHS, &options, on_file_loaded, load_result) == SAIL_OK);
+    check_all_loaded(load_result);
+
+    return MUNIT_OK;
+#else
+    (void)fixture;
+
+    return MUNIT_SKIP;
+#endif
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/load-files",              test_load_files,                setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/load-files-with-threads", test_load_files_with_threads,   setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/load-files-limited",      test_load_files_limited,        setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/load-files-stop",         test_load_files_stop,           setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/submit-failure",          test_load_files_submit_failure, setup, tear_down, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/load-files",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,139 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+#include "sail.h"
+
+#include "munit.h"
+
+/* Writes a 16x8 JPEG with the EXIF orientation into the buffer. */
+static size_t write_jpeg_with_orientation(void *buffer, size_t buffer_length, enum SailOrientation orientation) {
+
+    struct sail_image *image;
+    munit_assert(sail_alloc_image(&image) == SAIL_OK);
+    image->width = 16;
+    image->height = 8;
+    image->pixel_format = SAIL_PIXEL_FORMAT_BPP24_RGB;
+    munit_assert(sail_bytes_per_line(image->width, image->pixel_format, &image->bytes_per_line) == SAIL_OK);
+    munit_assert(sail_malloc((size_t)image->bytes_per_line * image->height, &image->pixels) == SAIL_OK);
+    memset(image->pixels, 128, (size_t)image->bytes_per_line * image->height);
+
+    /* Little-endian TIFF header and the first IFD with a single Orientation tag. */
+    const uint8_t exif[26] = {
+        'I', 'I', 0x2A, 0, 8, 0, 0, 0,
+        1, 0,
+        0x12, 0x01, 3, 0, 1, 0, 0, 0, (uint8_t)orientation, 0, 0, 0,
+        0, 0, 0, 0,
+    };
+    munit_assert(sail_alloc_meta_data_node_from_known_data(SAIL_META_DATA_EXIF, exif, sizeof(exif), &image->meta_data_node) == SAIL_OK);
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("jpg", &codec_info) == SAIL_OK);
+
+    struct sail_write_options *write_options;
+    munit_assert(sail_alloc_write_options_from_features(codec_info->write_features, &write_options) == SAIL_OK);
+    write_options->io_options |= SAIL_IO_OPTION_META_DATA;
+
+    void *state;
+    size_t written;
+    munit_assert(sail_start_writing_mem_with_options(buffer, buffer_length, codec_info, write_options, &state) == SAIL_OK);
+    munit_assert(sail_write_next_frame(state, image) == SAIL_OK);
+    munit_assert(sail_stop_writing_with_written(state, &written) == SAIL_OK);
+
+    sail_destroy_write_options(write_options);
+    sail_destroy_image(image);
+
+    return written;
+}
+
+static struct sail_image* read_mem_with_io_options(const void *buffer, size_t buffer_length, int io_options) {
+
+    struct sail_read_options *read_options;
+    munit_assert(sail_alloc_read_options(&read_options) == SAIL_OK);
+    read_options->io_options = io_options;
+
+    void *state;
+    munit_assert(sail_start_reading_mem_with_options(buffer, buffer_length, NULL, read_options, &state) == SAIL_OK);
+    sail_destroy_read_options(read_options);
+
+    struct sail_image *image;
+    munit_assert(sail_read_next_frame(state, &image) == SAIL_OK);
+    munit_assert(sail_stop_reading(state) == SAIL_OK);
+
+    return image;
+}
+
+static MunitResult test_auto_orient(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    const size_t buffer_length = 64 * 1024;
+    void *buffer;
+    munit_assert(sail_malloc(buffer_length, &buffer) == SAIL_OK);
+
+    const size_t written = write_jpeg_with_orientation(buffer, buffer_length, SAIL_ORIENTATION_ROTATE_90);
+
+    /* EXIF is preserved without auto-orientation. */
+    struct sail_image *image = read_mem_with_io_options(buffer, written, SAIL_IO_OPTION_META_DATA);
+    enum SailOrientation orientation;
+    munit_assert(sail_orientation_from_meta_data(image->meta_data_node, &orientation) == SAIL_OK);
+    munit_assert_int(orientation, ==, SAIL_ORIENTATION_ROTATE_90);
+    munit_assert_uint(image->width, ==, 16);
+    munit_assert_uint(image->height, ==, 8);
+    sail_destroy_image(image);
+
+    image = read_mem_with_io_options(buffer, written, SAIL_IO_OPTION_META_DATA | SAIL_IO_OPTION_AUTO_ORIENT);
+    munit_assert(sail_orientation_from_meta_data(image->meta_data_node, &orientation) == SAIL_OK);
+    munit_assert_int(orientation, ==, SAIL_ORIENTATION_NORMAL);
+    munit_assert_uint(image->width, ==, 8);
+    munit_assert_uint(image->height, ==, 16);
+    sail_destroy_image(image);
+
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/auto-orient", test_auto_orient, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/read-auto-orient",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,137 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail.h"
+
+#include "sail-comparators.h"
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static MunitResult test_read_large_file(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Noise doesn't compress, so the file is large enough to be memory-mapped. */
+    struct sail_image *image_source = sail_test_alloc_random_image(256, 192, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    const char *path = "read-large-file.png";
+    munit_assert(sail_write_file(path, image_source) == SAIL_OK);
+
+    void *buffer;
+    size_t buffer_length;
+    munit_assert(sail_alloc_buffer_from_file_contents(path, &buffer, &buffer_length) == SAIL_OK);
+    munit_assert_size(buffer_length, >=, SAIL_MMAP_IO_MIN_FILE_SIZE);
+
+    struct sail_image *image_file;
+    munit_assert(sail_read_file(path, &image_file) == SAIL_OK);
+
+    struct sail_image *image_mem;
+    munit_assert(sail_read_mem(buffer, buffer_length, &image_mem) == SAIL_OK);
+
+    munit_assert(sail_compare_images_equal(image_file, image_mem) == SAIL_OK);
+
+    munit_assert(image_file->pixel_format == SAIL_PIXEL_FORMAT_BPP24_RGB);
+    for (unsigned row = 0; row < image_source->height; row++) {
+        munit_assert_memory_equal(image_source->bytes_per_line,
+                                  (const uint8_t *)image_file->pixels + (size_t)image_file->bytes_per_line * row,
+                                  (const uint8_t *)image_source->pixels + (size_t)image_source->bytes_per_line * row);
+    }
+
+    /* Probing reads only the beginning of the file. */
+    struct sail_image *image_probed;
+    munit_assert(sail_probe_file(path, &image_probed, NULL) == SAIL_OK);
+    munit_assert_uint(image_probed->width, ==, image_source->width);
+    munit_assert_uint(image_probed->height, ==, image_source->height);
+
+    munit_assert_int(remove(path), ==, 0);
+
+    sail_destroy_image(image_probed);
+    sail_destroy_image(image_mem);
+    sail_destroy_image(image_file);
+    sail_free(buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+/* JPEG reads memory-mapped files without copying them into its own buffer. */
+static MunitResult test_read_large_jpeg_file(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image_source = sail_test_alloc_random_image(512, 384, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    const char *path = "read-large-file.jpg";
+    munit_assert(sail_write_file(path, image_source) == SAIL_OK);
+
+    void *buffer;
+    size_t buffer_length;
+    munit_assert(sail_alloc_buffer_from_file_contents(path, &buffer, &buffer_length) == SAIL_OK);
+    munit_assert_size(buffer_length, >=, SAIL_MMAP_IO_MIN_FILE_SIZE);
+
+    struct sail_image *image_file;
+    munit_assert(sail_read_file(path, &image_file) == SAIL_OK);
+
+    struct sail_image *image_mem;
+    munit_assert(sail_read_mem(buffer, buffer_length, &image_mem) == SAIL_OK);
+
+    munit_assert(sail_compare_images_equal(image_file, image_mem) == SAIL_OK);
+    munit_assert_uint(image_file->width, ==, image_source->width);
+    munit_assert_uint(image_file->height, ==, image_source->height);
+
+    munit_assert_int(remove(path), ==, 0);
+
+    sail_destroy_image(image_mem);
+    sail_destroy_image(image_file);
+    sail_free(buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/large-file",      test_read_large_file,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/large-jpeg-file", test_read_large_jpeg_file, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/read-file",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
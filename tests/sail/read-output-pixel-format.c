@@ -0,0 +1,429 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+#include "sail.h"
+
+#include "munit.h"
+
+#include "test-images.h"
+
+/* Reads the first frame of the buffer converting it to the output pixel format with the conversion options while reading. */
+static struct sail_image* read_mem_converting_with_options(const void *buffer, size_t buffer_length,
+                                                           enum SailPixelFormat output_pixel_format,
+                                                           const struct sail_conversion_options *conversion_options) {
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_by_magic_number_from_mem(buffer, buffer_length, &codec_info) == SAIL_OK);
+
+    struct sail_read_options *read_options;
+    munit_assert(sail_alloc_read_options_from_features(codec_info->read_features, &read_options) == SAIL_OK);
+    read_options->output_pixel_format = output_pixel_format;
+
+    if (conversion_options != NULL) {
+        read_options->yuv_matrix = conversion_options->yuv_matrix;
+        read_options->yuv_range  = conversion_options->yuv_range;
+    }
+
+    void *state;
+    munit_assert(sail_start_reading_mem_with_options(buffer, buffer_length, codec_info, read_options, &state) == SAIL_OK);
+    sail_destroy_read_options(read_options);
+
+    if (conversion_options != NULL) {
+        munit_assert(sail_set_reading_conversion_options(state, conversion_options) == SAIL_OK);
+    }
+
+    struct sail_image *image;
+    munit_assert(sail_read_next_frame(state, &image) == SAIL_OK);
+    munit_assert(sail_stop_reading(state) == SAIL_OK);
+
+    return image;
+}
+
+/* Reads the first frame of the buffer converting it to the output pixel format while reading. */
+static struct sail_image* read_mem_converting(const void *buffer, size_t buffer_length,
+                                              enum SailPixelFormat output_pixel_format) {
+
+    return read_mem_converting_with_options(buffer, buffer_length, output_pixel_format, NULL /* conversion options */);
+}
+
+/* Checks that the image read with conversion matches the native image converted afterwards with the same conversion options. */
+static void assert_converted_while_reading_with_options(const struct sail_image *image_native, const void *buffer, size_t buffer_length,
+                                                        enum SailPixelFormat output_pixel_format,
+                                                        const struct sail_conversion_options *conversion_options) {
+
+    struct sail_image *image_expected;
+    munit_assert(sail_convert_image_with_options(image_native, output_pixel_format, conversion_options, &image_expected) == SAIL_OK);
+
+    struct sail_image *image = read_mem_converting_with_options(buffer, buffer_length, output_pixel_format, conversion_options);
+
+    munit_assert(image->pixel_format == output_pixel_format);
+    munit_assert(image->width == image_expected->width);
+    munit_assert(image->height == image_expected->height);
+    munit_assert(image->bytes_per_line == image_expected->bytes_per_line);
+
+    munit_assert(sail_check_image_valid(image) == SAIL_OK);
+
+    size_t pixels_size;
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+    munit_assert_memory_equal(pixels_size, image->pixels, image_expected->pixels);
+
+    /* Indexed outputs get the same palette, and other outputs drop the input palette. */
+    if (image_expected->palette == NULL) {
+        munit_assert_null(image->palette);
+    } else {
+        munit_assert_not_null(image->palette);
+        munit_assert(image->palette->pixel_format == image_expected->palette->pixel_format);
+        munit_assert(image->palette->color_count == image_expected->palette->color_count);
+
+        unsigned bits_per_pixel;
+        munit_assert(sail_bits_per_pixel(image->palette->pixel_format, &bits_per_pixel) == SAIL_OK);
+        munit_assert_memory_equal((size_t)image->palette->color_count * bits_per_pixel / 8,
+                                  image->palette->data, image_expected->palette->data);
+    }
+
+    sail_destroy_image(image);
+    sail_destroy_image(image_expected);
+}
+
+/* Checks that the image read with conversion matches the native image converted afterwards. */
+static void assert_converted_while_reading(const struct sail_image *image_native, const void *buffer, size_t buffer_length,
+                                           enum SailPixelFormat output_pixel_format) {
+
+    assert_converted_while_reading_with_options(image_native, buffer, buffer_length, output_pixel_format, NULL /* conversion options */);
+}
+
+static MunitResult test_read_grow(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    void *buffer;
+    size_t buffer_length;
+    munit_assert(sail_alloc_buffer_from_file_contents(path, &buffer, &buffer_length) == SAIL_OK);
+
+    struct sail_image *image_native;
+    munit_assert(sail_read_mem(buffer, buffer_length, &image_native) == SAIL_OK);
+
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP24_RGB);
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP32_BGRA);
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP64_RGBA);
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP12_NV12);
+
+    /* The native pixel format is not converted at all. */
+    struct sail_image *image = read_mem_converting(buffer, buffer_length, image_native->pixel_format);
+    munit_assert(image->pixel_format == image_native->pixel_format);
+    munit_assert_memory_equal((size_t)image->bytes_per_line * image->height, image->pixels, image_native->pixels);
+    sail_destroy_image(image);
+
+    sail_destroy_image(image_native);
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_read_indexed(const MunitParameter params[], void *user_data) {
+    (void)user_data;
+
+    const char *path = munit_parameters_get(params, "path");
+
+    void *buffer;
+    size_t buffer_length;
+    munit_assert(sail_alloc_buffer_from_file_contents(path, &buffer, &buffer_length) == SAIL_OK);
+
+    struct sail_image *image_native;
+    munit_assert(sail_read_mem(buffer, buffer_length, &image_native) == SAIL_OK);
+
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP1_INDEXED);
+    assert_converted_while_reading(image_native, buffer, buffer_length, SAIL_PIXEL_FORMAT_BPP2_INDEXED);
+
+    sail_destroy_image(image_native);
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_read_shrink(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Build an RGBA image with a gradient and a varying alpha channel. */
+    struct sail_image *image_source;
+    munit_assert(sail_alloc_image(&image_source) == SAIL_OK);
+    image_source->width = 37;
+    image_source->height = 11;
+    image_source->pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    munit_assert(sail_bytes_per_line(image_source->width, image_source->pixel_format, &image_source->bytes_per_line) == SAIL_OK);
+    munit_assert(sail_malloc((size_t)image_source->bytes_per_line * image_source->height, &image_source->pixels) == SAIL_OK);
+
+    for (unsigned row = 0; row < image_source->height; row++) {
+        uint8_t *scan = (uint8_t *)image_source->pixels + (size_t)image_source->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image_source->width; column++) {
+            *scan++ = (uint8_t)(column * 7);
+            *scan++ = (uint8_t)(row * 23);
+            *scan++ = (uint8_t)(column * row);
+            *scan++ = (uint8_t)(255 - column * 5);
+        }
+    }
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("png", &codec_info) == SAIL_OK);
+
+    const size_t buffer_length = 64 * 1024;
+    void *buffer;
+    munit_assert(sail_malloc(buffer_length, &buffer) == SAIL_OK);
+
+    void *state;
+    size_t written;
+    munit_assert(sail_start_writing_mem_with_options(buffer, buffer_length, codec_info, NULL, &state) == SAIL_OK);
+    munit_assert(sail_write_next_frame(state, image_source) == SAIL_OK);
+    munit_assert(sail_stop_writing_with_written(state, &written) == SAIL_OK);
+
+    struct sail_image *image_native;
+    munit_assert(sail_read_mem(buffer, written, &image_native) == SAIL_OK);
+    munit_assert(image_native->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+
+    assert_converted_while_reading(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP8_GRAYSCALE);
+    assert_converted_while_reading(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP24_BGR);
+    assert_converted_while_reading(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP32_ARGB);
+
+    sail_destroy_image(image_native);
+    sail_free(buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_read_bands(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Large enough to be converted in multiple bands. */
+    struct sail_image *image_source;
+    munit_assert(sail_alloc_image(&image_source) == SAIL_OK);
+    image_source->width = 1000;
+    image_source->height = 1003;
+    image_source->pixel_format = SAIL_PIXEL_FORMAT_BPP32_RGBA;
+    munit_assert(sail_bytes_per_line(image_source->width, image_source->pixel_format, &image_source->bytes_per_line) == SAIL_OK);
+    munit_assert(sail_malloc((size_t)image_source->bytes_per_line * image_source->height, &image_source->pixels) == SAIL_OK);
+
+    for (unsigned row = 0; row < image_source->height; row++) {
+        uint8_t *scan = (uint8_t *)image_source->pixels + (size_t)image_source->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image_source->width; column++) {
+            *scan++ = (uint8_t)(column / 4);
+            *scan++ = (uint8_t)(row / 4);
+            *scan++ = (uint8_t)((column + row) / 8);
+            *scan++ = 255;
+        }
+    }
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("png", &codec_info) == SAIL_OK);
+
+    void *buffer;
+    void *state;
+    size_t written;
+    munit_assert(sail_start_writing_growing_mem(0, codec_info, &buffer, &state) == SAIL_OK);
+    munit_assert(sail_write_next_frame(state, image_source) == SAIL_OK);
+    munit_assert(sail_stop_writing_with_written(state, &written) == SAIL_OK);
+
+    struct sail_image *image_native;
+    munit_assert(sail_read_mem(buffer, written, &image_native) == SAIL_OK);
+
+    /* Dithering patterns continue across bands with any number of threads. */
+    struct sail_conversion_options *conversion_options;
+    munit_assert(sail_alloc_conversion_options(&conversion_options) == SAIL_OK);
+    conversion_options->dither = SAIL_DITHER_ORDERED;
+
+    const unsigned threads[] = { 1, 3, SAIL_THREADS_AUTO };
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+        conversion_options->threads = threads[t];
+
+        assert_converted_while_reading_with_options(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP1_GRAYSCALE, conversion_options);
+        assert_converted_while_reading_with_options(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP4_INDEXED, conversion_options);
+        assert_converted_while_reading_with_options(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP24_BGR, conversion_options);
+        assert_converted_while_reading_with_options(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP64_RGBA, conversion_options);
+    }
+
+    sail_destroy_conversion_options(conversion_options);
+    sail_destroy_image(image_native);
+    sail_free(buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_read_planar(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* Build a YCbCr image with smooth gradients, JPEG subsamples its chroma 2x2 by default. */
+    struct sail_image *image_source;
+    munit_assert(sail_alloc_image(&image_source) == SAIL_OK);
+    image_source->width = 37;
+    image_source->height = 11;
+    image_source->pixel_format = SAIL_PIXEL_FORMAT_BPP24_YCBCR;
+    munit_assert(sail_bytes_per_line(image_source->width, image_source->pixel_format, &image_source->bytes_per_line) == SAIL_OK);
+    munit_assert(sail_malloc((size_t)image_source->bytes_per_line * image_source->height, &image_source->pixels) == SAIL_OK);
+
+    for (unsigned row = 0; row < image_source->height; row++) {
+        uint8_t *scan = (uint8_t *)image_source->pixels + (size_t)image_source->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image_source->width; column++) {
+            *scan++ = (uint8_t)(64 + column * 3);
+            *scan++ = (uint8_t)(112 + row * 3);
+            *scan++ = (uint8_t)(144 - column);
+        }
+    }
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("jpeg", &codec_info) == SAIL_OK);
+
+    const size_t buffer_length = 64 * 1024;
+    void *buffer;
+    munit_assert(sail_malloc(buffer_length, &buffer) == SAIL_OK);
+
+    void *state;
+    size_t written;
+    munit_assert(sail_start_writing_mem_with_options(buffer, buffer_length, codec_info, NULL, &state) == SAIL_OK);
+    munit_assert(sail_write_next_frame(state, image_source) == SAIL_OK);
+    munit_assert(sail_stop_writing_with_written(state, &written) == SAIL_OK);
+
+    struct sail_image *image_native;
+    munit_assert(sail_read_mem(buffer, written, &image_native) == SAIL_OK);
+
+    /* Matching sampling is decoded straight into the planes, so only rounding differs from converting RGB. */
+    struct sail_image *image_expected;
+    munit_assert(sail_convert_image(image_native, SAIL_PIXEL_FORMAT_BPP12_I420, &image_expected) == SAIL_OK);
+
+    struct sail_image *image = read_mem_converting(buffer, written, SAIL_PIXEL_FORMAT_BPP12_I420);
+    munit_assert(image->pixel_format == SAIL_PIXEL_FORMAT_BPP12_I420);
+    munit_assert(image->width == image_expected->width);
+    munit_assert(image->height == image_expected->height);
+    munit_assert(image->bytes_per_line == image_expected->bytes_per_line);
+
+    size_t pixels_size;
+    munit_assert(sail_image_pixels_size(image, &pixels_size) == SAIL_OK);
+
+    for (size_t i = 0; i < pixels_size; i++) {
+        const int difference = ((const uint8_t *)image->pixels)[i] - ((const uint8_t *)image_expected->pixels)[i];
+        munit_assert_int(difference, >=, -2);
+        munit_assert_int(difference, <=, 2);
+    }
+
+    /* Default conversion options keep decoding straight into the planes. */
+    struct sail_conversion_options *conversion_options;
+    munit_assert(sail_alloc_conversion_options(&conversion_options) == SAIL_OK);
+
+    struct sail_image *image_raw = read_mem_converting_with_options(buffer, written, SAIL_PIXEL_FORMAT_BPP12_I420, conversion_options);
+    munit_assert_memory_equal(pixels_size, image_raw->pixels, image->pixels);
+    sail_destroy_image(image_raw);
+
+    /* Other ranges are converted from RGB. */
+    conversion_options->yuv_range = SAIL_YUV_RANGE_LIMITED;
+
+    struct sail_image *image_limited;
+    munit_assert(sail_convert_image_with_options(image_native, SAIL_PIXEL_FORMAT_BPP12_I420, conversion_options, &image_limited) == SAIL_OK);
+
+    image_raw = read_mem_converting_with_options(buffer, written, SAIL_PIXEL_FORMAT_BPP12_I420, conversion_options);
+    munit_assert_memory_equal(pixels_size, image_raw->pixels, image_limited->pixels);
+    sail_destroy_image(image_raw);
+    sail_destroy_image(image_limited);
+
+    sail_destroy_conversion_options(conversion_options);
+
+    sail_destroy_image(image);
+    sail_destroy_image(image_expected);
+
+    /* Other planar layouts are converted from RGB. */
+    assert_converted_while_reading(image_native, buffer, written, SAIL_PIXEL_FORMAT_BPP24_YUV444P);
+
+    sail_destroy_image(image_native);
+    sail_free(buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_read_unsupported(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    void *buffer;
+    size_t buffer_length;
+    munit_assert(sail_alloc_buffer_from_file_contents(SAIL_TEST_IMAGES[0], &buffer, &buffer_length) == SAIL_OK);
+
+    struct sail_read_options *read_options;
+    munit_assert(sail_alloc_read_options(&read_options) == SAIL_OK);
+    read_options->output_pixel_format = SAIL_PIXEL_FORMAT_BPP24_CIE_LAB;
+
+    void *state;
+    munit_assert(sail_start_reading_mem_with_options(buffer, buffer_length, NULL, read_options, &state) == SAIL_OK);
+    sail_destroy_read_options(read_options);
+
+    struct sail_image *image;
+    munit_assert(sail_read_next_frame(state, &image) == SAIL_ERROR_UNSUPPORTED_PIXEL_FORMAT);
+    munit_assert(sail_stop_reading(state) == SAIL_OK);
+
+    sail_free(buffer);
+
+    return MUNIT_OK;
+}
+
+static MunitParameterEnum test_params[] = {
+    { (char *)"path", (char **)SAIL_TEST_IMAGES },
+    { NULL, NULL },
+};
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/grow",        test_read_grow,        NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/indexed",     test_read_indexed,     NULL, NULL, MUNIT_TEST_OPTION_NONE, test_params },
+    { (char *)"/shrink",      test_read_shrink,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/bands",       test_read_bands,       NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/planar",      test_read_planar,      NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+    { (char *)"/unsupported", test_read_unsupported, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/read-output-pixel-format",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,118 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+
+#include "sail-common.h"
+#include "sail.h"
+
+#include "sail-test-images.h"
+
+#include "munit.h"
+
+static struct sail_image* alloc_gradient_image(void) {
+
+    struct sail_image *image = sail_test_alloc_image(97, 61, SAIL_PIXEL_FORMAT_BPP24_RGB);
+
+    for (unsigned row = 0; row < image->height; row++) {
+        uint8_t *scan = (uint8_t *)image->pixels + (size_t)image->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image->width; column++) {
+            *scan++ = (uint8_t)(column * 3);
+            *scan++ = (uint8_t)(row * 5 + column);
+            *scan++ = (uint8_t)(column * row);
+        }
+    }
+
+    return image;
+}
+
+static MunitResult test_write_growing_mem(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    struct sail_image *image_source = alloc_gradient_image();
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("png", &codec_info) == SAIL_OK);
+
+    /* Write into a fixed buffer large enough for sure. */
+    const size_t fixed_buffer_length = 256 * 1024;
+    void *fixed_buffer;
+    munit_assert(sail_malloc(fixed_buffer_length, &fixed_buffer) == SAIL_OK);
+
+    void *state;
+    size_t fixed_written;
+    munit_assert(sail_start_writing_mem(fixed_buffer, fixed_buffer_length, codec_info, &state) == SAIL_OK);
+    munit_assert(sail_write_next_frame(state, image_source) == SAIL_OK);
+    munit_assert(sail_stop_writing_with_written(state, &fixed_written) == SAIL_OK);
+
+    /* A tiny initial size makes the buffer grow many times. */
+    const size_t initial_sizes[] = { 0, 1, 100, 1024 * 1024 };
+
+    for (size_t i = 0; i < sizeof(initial_sizes) / sizeof(initial_sizes[0]); i++) {
+        void *buffer = NULL;
+        size_t written;
+        munit_assert(sail_start_writing_growing_mem(initial_sizes[i], codec_info, &buffer, &state) == SAIL_OK);
+        munit_assert(sail_write_next_frame(state, image_source) == SAIL_OK);
+        munit_assert(sail_stop_writing_with_written(state, &written) == SAIL_OK);
+
+        munit_assert_not_null(buffer);
+        munit_assert_size(written, ==, fixed_written);
+        munit_assert_memory_equal(written, buffer, fixed_buffer);
+
+        struct sail_image *image_read;
+        munit_assert(sail_read_mem(buffer, written, &image_read) == SAIL_OK);
+        munit_assert(image_read->pixel_format == image_source->pixel_format);
+        munit_assert_uint(image_read->bytes_per_line, ==, image_source->bytes_per_line);
+        munit_assert_memory_equal((size_t)image_read->bytes_per_line * image_read->height, image_read->pixels, image_source->pixels);
+
+        sail_destroy_image(image_read);
+        sail_free(buffer);
+    }
+
+    sail_free(fixed_buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/growing-mem", test_write_growing_mem, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/write-growing-mem",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}
@@ -0,0 +1,111 @@
+/*  This file is part of SAIL (https://github.com/smoked-herring/sail)
+
+    Copyright (c) 2021 Dmitry Baryshev
+
+    The MIT License
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+*/
+
+#include <stdint.h>
+
+#include "sail-common.h"
+#include "sail-manip.h"
+#include "sail.h"
+
+#include "munit.h"
+
+static MunitResult test_write_unpremultiplied(const MunitParameter params[], void *user_data) {
+    (void)params;
+    (void)user_data;
+
+    /* PNG supports only straight alpha, so the premultiplied image gets unpremultiplied while writing. */
+    struct sail_image *image_source;
+    munit_assert(sail_alloc_image(&image_source) == SAIL_OK);
+    image_source->width = 37;
+    image_source->height = 11;
+    image_source->pixel_format = SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED;
+    munit_assert(sail_bytes_per_line(image_source->width, image_source->pixel_format, &image_source->bytes_per_line) == SAIL_OK);
+    munit_assert(sail_malloc((size_t)image_source->bytes_per_line * image_source->height, &image_source->pixels) == SAIL_OK);
+
+    for (unsigned row = 0; row < image_source->height; row++) {
+        uint8_t *scan = (uint8_t *)image_source->pixels + (size_t)image_source->bytes_per_line * row;
+
+        for (unsigned column = 0; column < image_source->width; column++) {
+            const unsigned a = 255 - column * 7;
+
+            *scan++ = (uint8_t)(column * row % (a + 1));
+            *scan++ = (uint8_t)(row * 23 % (a + 1));
+            *scan++ = (uint8_t)(column * 5 % (a + 1));
+            *scan++ = (uint8_t)a;
+        }
+    }
+
+    const struct sail_codec_info *codec_info;
+    munit_assert(sail_codec_info_from_extension("png", &codec_info) == SAIL_OK);
+
+    const size_t buffer_length = 64 * 1024;
+    void *buffer;
+    munit_assert(sail_malloc(buffer_length, &buffer) == SAIL_OK);
+
+    void *state;
+    size_t written;
+    munit_assert(sail_start_writing_mem_with_options(buffer, buffer_length, codec_info, NULL, &state) == SAIL_OK);
+    munit_assert(sail_write_next_frame(state, image_source) == SAIL_OK);
+    munit_assert(sail_stop_writing_with_written(state, &written) == SAIL_OK);
+
+    /* The source image is not touched. */
+    munit_assert(image_source->pixel_format == SAIL_PIXEL_FORMAT_BPP32_BGRA_PREMULTIPLIED);
+
+    /* PNG stores BGRA pixels as RGBA. */
+    struct sail_image *image_expected;
+    munit_assert(sail_convert_image(image_source, SAIL_PIXEL_FORMAT_BPP32_RGBA, &image_expected) == SAIL_OK);
+
+    struct sail_image *image_read;
+    munit_assert(sail_read_mem(buffer, written, &image_read) == SAIL_OK);
+    munit_assert(image_read->pixel_format == SAIL_PIXEL_FORMAT_BPP32_RGBA);
+    munit_assert(image_read->bytes_per_line == image_expected->bytes_per_line);
+
+    munit_assert_memory_equal((size_t)image_read->bytes_per_line * image_read->height, image_read->pixels, image_expected->pixels);
+
+    sail_destroy_image(image_read);
+    sail_destroy_image(image_expected);
+    sail_free(buffer);
+    sail_destroy_image(image_source);
+
+    return MUNIT_OK;
+}
+
+static MunitTest test_suite_tests[] = {
+    { (char *)"/unpremultiplied", test_write_unpremultiplied, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+static const MunitSuite test_suite = {
+    (char *)"/write-premultiplied",
+    test_suite_tests,
+    NULL,
+    1,
+    MUNIT_SUITE_OPTION_NONE
+};
+
+int main(int argc, char *argv[MUNIT_ARRAY_PARAM(argc + 1)]) {
+    return munit_suite_main(&test_suite, NULL, argc, argv);
+}